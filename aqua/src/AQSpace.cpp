@@ -12,6 +12,16 @@
 #include <limits>
 #include <unordered_map>
 
+#include <omega-common/multithread.h>
+
+// Per-body sweeps fan out over the shared TaskScheduler once a space holds at
+// least this many bodies; below it the dispatch overhead outweighs the work.
+// The grain keeps each task's slice large enough to amortize the hand-off.
+namespace {
+constexpr std::size_t kParallelBodyThreshold = 512;
+constexpr std::size_t kParallelBodyGrain     = 128;
+}
+
 // Phase 3 narrowphase entry point — implemented in AQNarrowphase.cpp. The
 // declaration lives here (and not in a public header) because the dispatch
 // is an internal seam: callers consume `AQContactManifold` via
@@ -518,8 +528,13 @@ void AQSpace::stepInternal(float dt) {
         }
     }
 
-    for (auto &body : impl->bodies) {
-        if (body->impl->type == AQBodyType::Static) continue;
+    // Velocity half-step. Each body reads only its own state plus the shared
+    // gravity, so large scenes fan the sweep out over OmegaCommon's shared
+    // work-stealing scheduler. Per-body arithmetic is unchanged, so results
+    // stay bit-identical to the serial sweep (determinism contract).
+    auto stepVelocity = [&](std::size_t i) {
+        auto &body = impl->bodies[i];
+        if (body->impl->type == AQBodyType::Static) return;
         auto &s = body->impl->s;
 #ifndef NDEBUG
         // Make a too-coarse sub-step for the scene's angular rates loud rather
@@ -544,6 +559,12 @@ void AQSpace::stepInternal(float dt) {
         }
 #endif
         AQStepBodyVelocity(s, impl->gravity, dt);
+    };
+    if (impl->bodies.size() >= kParallelBodyThreshold) {
+        OmegaCommon::parallelFor<std::size_t>(0, impl->bodies.size(), kParallelBodyGrain,
+                                              stepVelocity);
+    } else {
+        for (std::size_t i = 0; i < impl->bodies.size(); ++i) stepVelocity(i);
     }
 
     // Phase 3 — contact solver (operates on the now-predicted velocities).
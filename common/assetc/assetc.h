@@ -2,6 +2,8 @@
 #include <type_traits>
 
 #include "omega-common/assets.h"
+#include "omega-common/compression.h"
+#include "omega-common/crypto.h"
 
 #ifndef OMEGAWTK_ASSETC_ASSETC_H
 #define OMEGAWTK_ASSETC_ASSETC_H
@@ -22,9 +24,11 @@ enum class AssetEntryFlags : std::uint32_t {
   None = 0,
   Compressed = 1U << 0,
   Encrypted = 1U << 1,
+  ChunkedEncryption = 1U << 2,
 };
 
 using AssetType = OmegaCommon::AssetType;
+using CompressionCodec = OmegaCommon::CompressionCodec;
 
 #pragma pack(push, 1)
 
@@ -50,8 +54,66 @@ struct AssetEntry {
   std::uint8_t entryHash[32] = {};
 };
 
+/// Compressed entries store their payload as independently decodable chunks
+/// so the runtime can decode them in parallel, or one at a time while
+/// streaming. Layout: CompressedPayloadHeader, then chunkCount little-endian
+/// u32 stored chunk sizes, then the chunk data back to back. Every chunk but
+/// the last decodes to chunkSize bytes. A chunk whose stored size equals its
+/// decoded size is kept uncompressed.
+struct CompressedPayloadHeader {
+  std::uint8_t codec = static_cast<std::uint8_t>(CompressionCodec::None);
+  std::uint8_t reserved[3] = {};
+  std::uint32_t chunkSize = 0;
+  std::uint32_t chunkCount = 0;
+};
+
+/// Encrypted entries flagged ChunkedEncryption seal their stored payload
+/// (compressed or not) as a sequence of AES-256-GCM chunks, so the runtime
+/// can decrypt and authenticate one chunk at a time. Layout:
+/// EncryptedPayloadHeader, then per chunk its ciphertext followed by its
+/// 16-byte tag. Every chunk but the last holds chunkSize plaintext bytes;
+/// an empty payload is still sealed as one empty chunk. Chunk nonces and AAD
+/// come from chunkNonce() and chunkAad().
+struct EncryptedPayloadHeader {
+  std::uint32_t chunkSize = 0;
+  std::uint32_t chunkCount = 0;
+};
+
 #pragma pack(pop)
 
+inline constexpr std::uint32_t DefaultCompressionChunkSize = 256U * 1024U;
+inline constexpr std::uint32_t DefaultEncryptionChunkSize = 64U * 1024U;
+inline constexpr std::uint32_t EncryptionTagSize = 16U;
+
+/// The entry nonce with @p chunkIndex XORed big-endian into its last four
+/// bytes, giving every chunk of an entry a distinct nonce.
+inline OmegaCommon::Nonce chunkNonce(const OmegaCommon::Nonce &entryNonce,
+                                     std::uint32_t chunkIndex) {
+  OmegaCommon::Nonce nonce = entryNonce;
+  auto size = OmegaCommon::Nonce::NonceSize;
+  nonce.bytes[size - 4] ^= static_cast<std::uint8_t>(chunkIndex >> 24);
+  nonce.bytes[size - 3] ^= static_cast<std::uint8_t>(chunkIndex >> 16);
+  nonce.bytes[size - 2] ^= static_cast<std::uint8_t>(chunkIndex >> 8);
+  nonce.bytes[size - 1] ^= static_cast<std::uint8_t>(chunkIndex);
+  return nonce;
+}
+
+/// The entry AAD followed by the chunk index and count, so chunks cannot be
+/// reordered, dropped or spliced in from another entry.
+inline OmegaCommon::Vector<std::uint8_t> chunkAad(const OmegaCommon::Vector<std::uint8_t> &entryAad,
+                                                  std::uint32_t chunkIndex,
+                                                  std::uint32_t chunkCount) {
+  OmegaCommon::Vector<std::uint8_t> aad;
+  aad.reserve(entryAad.size() + sizeof(chunkIndex) + sizeof(chunkCount));
+  aad.insert(aad.end(), entryAad.begin(), entryAad.end());
+  for (auto value : {chunkIndex, chunkCount}) {
+    for (unsigned shift = 0; shift < 32; shift += 8) {
+      aad.push_back(static_cast<std::uint8_t>(value >> shift));
+    }
+  }
+  return aad;
+}
+
 constexpr bool hasBundleMagic(const std::uint8_t magic[4]) {
   return magic[0] == BundleMagic[0] && magic[1] == BundleMagic[1] &&
          magic[2] == BundleMagic[2] && magic[3] == BundleMagic[3];
@@ -59,8 +121,12 @@ constexpr bool hasBundleMagic(const std::uint8_t magic[4]) {
 
 static_assert(sizeof(BundleHeader) == 64, "Bundle header layout changed.");
 static_assert(sizeof(AssetEntry) == 68, "Bundle asset entry layout changed.");
+static_assert(sizeof(CompressedPayloadHeader) == 12, "Compressed payload header layout changed.");
+static_assert(sizeof(EncryptedPayloadHeader) == 8, "Encrypted payload header layout changed.");
 static_assert(std::is_standard_layout_v<BundleHeader>);
 static_assert(std::is_standard_layout_v<AssetEntry>);
+static_assert(std::is_standard_layout_v<CompressedPayloadHeader>);
+static_assert(std::is_standard_layout_v<EncryptedPayloadHeader>);
 
 }
 
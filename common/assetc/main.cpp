@@ -1,22 +1,27 @@
 #include "assetc.h"
 
 #include "omega-common/cli.h"
+#include "omega-common/compression.h"
 #include "omega-common/crypto.h"
 #include "omega-common/json.h"
+#include "omega-common/multithread.h"
 
 #include <algorithm>
 #include <array>
+#include <chrono>
 #include <cstdlib>
 #include <cctype>
 #include <cstdint>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <sstream>
 #include <unordered_map>
 
 namespace {
 
+using OmegaCommon::AeadContext;
 using OmegaCommon::ArrayRef;
 using OmegaCommon::DigestAlgorithm;
 using OmegaCommon::EncryptionKey;
@@ -34,6 +39,9 @@ constexpr const char *ProgramName = "omega-assetc";
 constexpr const char *AssetTypesConfigFileName = "AssetTypes.json";
 constexpr const char *AssetTypesConfigEnvVar = "OMEGA_ASSET_TYPES_JSON";
 constexpr const char *EncryptionNonceLabel = "omega-assetc:entry-nonce:v1";
+constexpr const char *KeyIdLabel = "omega-assetc:key-id:v1";
+constexpr const char *InputCacheMagic = "omega-assetc-inputs 2";
+constexpr size_t CopyBufferSize = 1024U * 1024U;
 
 struct CompilerOptions {
   bool help = false;
@@ -43,6 +51,9 @@ struct CompilerOptions {
   bool sign = true;
   bool verbose = false;
   bool keyPassphrase = false;
+  bool incremental = false;
+  String codec = "lz4";
+  String jobs;
   String outputFile;
   String appId;
   String keyFile;
@@ -64,10 +75,19 @@ struct CompiledAsset {
   String declaredPath;
   String bundleName;
   assetc::AssetType type = assetc::AssetType::Raw;
+  std::uint64_t sourceSize = 0;
+  std::int64_t sourceModified = 0;
+  /// Only held between reading and compressing/encrypting; storedBytes is
+  /// what ends up in the bundle.
   Vector<std::uint8_t> rawBytes;
   Vector<std::uint8_t> storedBytes;
+  std::uint64_t rawSize = 0;
+  std::uint64_t storedSize = 0;
   std::array<std::uint8_t, 32> entryHash {};
   std::uint32_t flags = static_cast<std::uint32_t>(assetc::AssetEntryFlags::None);
+  /// Set when the stored bytes are copied from the previous bundle's data
+  /// region (--incremental) instead of storedBytes.
+  Optional<std::uint64_t> previousDataOffset;
 };
 
 using TypeOverrideMap = std::unordered_map<String, assetc::AssetType>;
@@ -285,27 +305,131 @@ Result<Nonce, String> deriveEntryNonce(const EncryptionKey &key,
   return Result<Nonce, String>::ok(std::move(nonce.value()));
 }
 
+/// Splits the raw bytes into independently compressed chunks (see
+/// assetc::CompressedPayloadHeader). Assets that do not shrink stay stored
+/// uncompressed.
+Result<void *, String> compressCompiledAsset(CompiledAsset &asset,
+                                             assetc::CompressionCodec codec) {
+  if (asset.rawBytes.empty()) {
+    return Result<void *, String>::ok(nullptr);
+  }
+
+  auto chunkSize = static_cast<size_t>(assetc::DefaultCompressionChunkSize);
+  auto chunkCount = (asset.rawBytes.size() + chunkSize - 1) / chunkSize;
+  if (chunkCount > std::numeric_limits<std::uint32_t>::max()) {
+    return Result<void *, String>::err("Asset is too large to compress: " + asset.bundleName);
+  }
+
+  assetc::CompressedPayloadHeader header {};
+  header.codec = static_cast<std::uint8_t>(codec);
+  header.chunkSize = assetc::DefaultCompressionChunkSize;
+  header.chunkCount = static_cast<std::uint32_t>(chunkCount);
+
+  Vector<std::uint32_t> chunkSizes;
+  Vector<std::uint8_t> chunkData;
+  chunkSizes.reserve(chunkCount);
+  for (size_t offset = 0; offset < asset.rawBytes.size(); offset += chunkSize) {
+    auto length = std::min(chunkSize, asset.rawBytes.size() - offset);
+    auto *chunkBegin = asset.rawBytes.data() + offset;
+    auto compressed = OmegaCommon::compressBlock(
+        codec, OmegaCommon::makeArrayRef(chunkBegin, chunkBegin + length));
+    if (compressed.isErr()) {
+      return Result<void *, String>::err("While compressing \"" + asset.bundleName +
+                                         "\": " + compressed.error());
+    }
+
+    // A chunk that did not shrink is stored raw; the reader recognises it by
+    // its stored size matching the decoded size.
+    if (compressed.value().size() >= length) {
+      chunkData.insert(chunkData.end(), chunkBegin, chunkBegin + length);
+      chunkSizes.push_back(static_cast<std::uint32_t>(length));
+    } else {
+      chunkData.insert(chunkData.end(), compressed.value().begin(), compressed.value().end());
+      chunkSizes.push_back(static_cast<std::uint32_t>(compressed.value().size()));
+    }
+  }
+
+  auto payloadSize = sizeof(header) + chunkSizes.size() * sizeof(std::uint32_t) + chunkData.size();
+  if (payloadSize >= asset.rawBytes.size()) {
+    return Result<void *, String>::ok(nullptr);
+  }
+
+  Vector<std::uint8_t> payload;
+  payload.reserve(payloadSize);
+  appendScalarBytes(payload, header);
+  for (auto size : chunkSizes) {
+    appendScalarBytes(payload, size);
+  }
+  payload.insert(payload.end(), chunkData.begin(), chunkData.end());
+
+  asset.storedBytes = std::move(payload);
+  asset.flags |= static_cast<std::uint32_t>(assetc::AssetEntryFlags::Compressed);
+  return Result<void *, String>::ok(nullptr);
+}
+
+/// Encrypts the stored bytes as a sequence of GCM chunks (see
+/// assetc::EncryptedPayloadHeader), so compressed entries are compressed
+/// first and then encrypted, and the runtime can stream either kind.
 Result<void *, String> encryptCompiledAsset(CompiledAsset &asset,
                                             const EncryptionKey &key) {
-  asset.flags |= static_cast<std::uint32_t>(assetc::AssetEntryFlags::Encrypted);
+  asset.flags |= static_cast<std::uint32_t>(assetc::AssetEntryFlags::Encrypted) |
+                 static_cast<std::uint32_t>(assetc::AssetEntryFlags::ChunkedEncryption);
 
-  auto aad = buildEntryAad(asset.bundleName, asset.type, asset.rawBytes.size(), asset.flags);
+  auto aad = buildEntryAad(asset.bundleName, asset.type, asset.rawSize, asset.flags);
   auto nonce = deriveEntryNonce(key, asset.entryHash, asset.bundleName);
   if (nonce.isErr()) {
     return Result<void *, String>::err("While encrypting \"" + asset.bundleName +
                                        "\": " + nonce.error());
   }
 
-  auto encrypted = OmegaCommon::encrypt(key, nonce.value(), asset.rawBytes.data(),
-                                        asset.rawBytes.size(), aad.data(), aad.size());
-  if (encrypted.isErr()) {
+  auto chunkSize = static_cast<size_t>(assetc::DefaultEncryptionChunkSize);
+  auto chunkCount = std::max<size_t>(1, (asset.storedBytes.size() + chunkSize - 1) / chunkSize);
+  if (chunkCount > std::numeric_limits<std::uint32_t>::max()) {
+    return Result<void *, String>::err("Asset is too large to encrypt: " + asset.bundleName);
+  }
+
+  assetc::EncryptedPayloadHeader header {};
+  header.chunkSize = assetc::DefaultEncryptionChunkSize;
+  header.chunkCount = static_cast<std::uint32_t>(chunkCount);
+
+  // One keyed context for every chunk; each chunk only re-arms the nonce.
+  auto aead = AeadContext::create(key);
+  if (aead.isErr()) {
     return Result<void *, String>::err("While encrypting \"" + asset.bundleName +
-                                       "\": " + encrypted.error().message);
+                                       "\": " + aead.error().message);
+  }
+
+  Vector<std::uint8_t> payload;
+  payload.reserve(sizeof(header) + asset.storedBytes.size() +
+                  chunkCount * assetc::EncryptionTagSize);
+  appendScalarBytes(payload, header);
+  for (size_t idx = 0; idx < chunkCount; ++idx) {
+    auto offset = idx * chunkSize;
+    auto length = std::min(chunkSize, asset.storedBytes.size() - offset);
+    auto chunkIndex = static_cast<std::uint32_t>(idx);
+    auto aadForChunk = assetc::chunkAad(aad, chunkIndex, header.chunkCount);
+
+    // Encrypt straight into the payload, then append the chunk's tag.
+    auto ciphertextStart = payload.size();
+    payload.resize(ciphertextStart + length);
+    std::array<std::uint8_t, assetc::EncryptionTagSize> tag {};
+    auto sealed = aead.value().beginEncrypt(assetc::chunkNonce(nonce.value(), chunkIndex),
+                                            aadForChunk.data(), aadForChunk.size());
+    if (sealed.isOk()) {
+      sealed = aead.value().update(asset.storedBytes.data() + offset, length,
+                                   payload.data() + ciphertextStart);
+    }
+    if (sealed.isOk()) {
+      sealed = aead.value().finishEncrypt(tag);
+    }
+    if (sealed.isErr()) {
+      return Result<void *, String>::err("While encrypting \"" + asset.bundleName +
+                                         "\": " + sealed.error().message);
+    }
+    payload.insert(payload.end(), tag.begin(), tag.end());
   }
 
-  asset.storedBytes = std::move(encrypted.value().ciphertext);
-  asset.storedBytes.insert(asset.storedBytes.end(), encrypted.value().tag.begin(),
-                           encrypted.value().tag.end());
+  asset.storedBytes = std::move(payload);
   return Result<void *, String>::ok(nullptr);
 }
 
@@ -748,7 +872,10 @@ Optional<assetc::AssetType> findOverrideType(const TypeOverrideMap &overrides,
   return std::nullopt;
 }
 
-Result<CompiledAsset, String> compileAsset(const InputSpec &input,
+/// Resolves everything about an input that does not need its contents:
+/// bundle name, asset type, and the size and modification time the
+/// incremental cache is keyed on.
+Result<CompiledAsset, String> prepareAsset(const InputSpec &input,
                                            const TypeOverrideMap &typeOverrides,
                                            const Vector<String> &stripPrefixes,
                                            const AssetTypeConfig &assetTypeConfig) {
@@ -762,21 +889,45 @@ Result<CompiledAsset, String> compileAsset(const InputSpec &input,
                                               "\" became empty after strip-prefix processing.");
   }
 
-  if (!fs::exists(asset.sourcePath) || !fs::is_regular_file(asset.sourcePath)) {
+  std::error_code ec;
+  if (!fs::is_regular_file(asset.sourcePath, ec)) {
     return Result<CompiledAsset, String>::err("Input asset does not exist: " +
                                               asset.sourcePath.string());
   }
 
+  auto size = fs::file_size(asset.sourcePath, ec);
+  auto modified = ec ? fs::file_time_type {} : fs::last_write_time(asset.sourcePath, ec);
+  if (ec) {
+    return Result<CompiledAsset, String>::err("Failed to stat asset file: " +
+                                              asset.sourcePath.string());
+  }
+  asset.sourceSize = static_cast<std::uint64_t>(size);
+  asset.sourceModified = static_cast<std::int64_t>(modified.time_since_epoch().count());
+
+  auto overrideType =
+      findOverrideType(typeOverrides, input.declaredPath, asset.bundleName);
+  if (input.explicitType.has_value()) {
+    asset.type = *input.explicitType;
+  } else if (overrideType.has_value()) {
+    asset.type = *overrideType;
+  } else {
+    asset.type = inferAssetType(asset.sourcePath, assetTypeConfig);
+  }
+
+  return Result<CompiledAsset, String>::ok(std::move(asset));
+}
+
+Result<void *, String> readAsset(CompiledAsset &asset) {
   std::ifstream in(asset.sourcePath, std::ios::binary | std::ios::ate);
   if (!in.is_open()) {
-    return Result<CompiledAsset, String>::err("Failed to open asset file: " +
-                                              asset.sourcePath.string());
+    return Result<void *, String>::err("Failed to open asset file: " +
+                                       asset.sourcePath.string());
   }
 
   auto size = in.tellg();
   if (size < 0) {
-    return Result<CompiledAsset, String>::err("Failed to measure asset file: " +
-                                              asset.sourcePath.string());
+    return Result<void *, String>::err("Failed to measure asset file: " +
+                                       asset.sourcePath.string());
   }
 
   in.seekg(0, std::ios::beg);
@@ -786,132 +937,497 @@ Result<CompiledAsset, String> compileAsset(const InputSpec &input,
   }
 
   if (in.bad()) {
-    return Result<CompiledAsset, String>::err("Failed to read asset file: " +
-                                              asset.sourcePath.string());
-  }
-
-  auto overrideType =
-      findOverrideType(typeOverrides, input.declaredPath, asset.bundleName);
-  if (input.explicitType.has_value()) {
-    asset.type = *input.explicitType;
-  } else if (overrideType.has_value()) {
-    asset.type = *overrideType;
-  } else {
-    asset.type = inferAssetType(asset.sourcePath, assetTypeConfig);
+    return Result<void *, String>::err("Failed to read asset file: " +
+                                       asset.sourcePath.string());
   }
 
   auto hashResult = sha256(asset.rawBytes);
   if (hashResult.isErr()) {
-    return Result<CompiledAsset, String>::err("While hashing \"" + input.declaredPath +
-                                              "\": " + hashResult.error());
+    return Result<void *, String>::err("While hashing \"" + asset.declaredPath +
+                                       "\": " + hashResult.error());
   }
   asset.entryHash = hashResult.value();
-  asset.storedBytes = asset.rawBytes;
-
-  return Result<CompiledAsset, String>::ok(std::move(asset));
+  asset.rawSize = static_cast<std::uint64_t>(asset.rawBytes.size());
+  return Result<void *, String>::ok(nullptr);
 }
 
-template <typename T>
-void appendStructBytes(Vector<std::uint8_t> &out, const T &value) {
-  auto ptr = reinterpret_cast<const std::uint8_t *>(std::addressof(value));
-  out.insert(out.end(), ptr, ptr + sizeof(T));
+/// Writes a v2 bundle one entry at a time. Payloads stream into
+/// "<output>.tmp" as they are appended, so only the assets in flight are
+/// ever held in memory; finish() fills in the header and entry table and
+/// renames the file over the output. The output is left untouched on any
+/// failure.
+class BundleWriter {
+  fs::path outputPath_;
+  fs::path tempPath_;
+  std::fstream out_;
+  Vector<assetc::AssetEntry> entries_;
+  Vector<std::uint8_t> stringTable_;
+  std::uint64_t dataRegionOffset_ = 0;
+  std::uint64_t dataRegionSize_ = 0;
+  size_t appended_ = 0;
+  bool committed_ = false;
+
+  Result<void *, String> beginEntry(const CompiledAsset &asset, std::uint64_t storedSize) {
+    if (appended_ >= entries_.size()) {
+      return Result<void *, String>::err("More assets written than the bundle was opened with.");
+    }
+    auto &entry = entries_[appended_++];
+    entry.assetType = static_cast<std::uint16_t>(asset.type);
+    entry.dataOffset = dataRegionSize_;
+    entry.rawSize = asset.rawSize;
+    entry.storedSize = storedSize;
+    entry.flags = asset.flags;
+    std::copy(asset.entryHash.begin(), asset.entryHash.end(), entry.entryHash);
+    dataRegionSize_ += storedSize;
+    return Result<void *, String>::ok(nullptr);
+  }
+
+  Result<void *, String> writeFailed() {
+    return Result<void *, String>::err("Failed while writing output file: " +
+                                       tempPath_.string());
+  }
+
+public:
+  BundleWriter() = default;
+  BundleWriter(const BundleWriter &) = delete;
+  BundleWriter &operator=(const BundleWriter &) = delete;
+
+  ~BundleWriter() {
+    if (!committed_ && !tempPath_.empty()) {
+      out_.close();
+      std::error_code ec;
+      fs::remove(tempPath_, ec);
+    }
+  }
+
+  /// Names (and so the string table and entry count) are known before any
+  /// payload is compiled; the space for the header, entries and string table
+  /// is reserved up front.
+  Result<void *, String> open(const fs::path &outputPath,
+                              const Vector<CompiledAsset> &assets) {
+    outputPath_ = outputPath;
+    tempPath_ = fs::path(outputPath.string() + ".tmp");
+
+    entries_.assign(assets.size(), assetc::AssetEntry {});
+    for (size_t i = 0; i < assets.size(); ++i) {
+      const auto &name = assets[i].bundleName;
+      entries_[i].nameOffset = static_cast<std::uint32_t>(stringTable_.size());
+      entries_[i].nameLength = static_cast<std::uint16_t>(name.size());
+      stringTable_.insert(stringTable_.end(), name.begin(), name.end());
+      stringTable_.push_back(0);
+    }
+    dataRegionOffset_ =
+        sizeof(assetc::BundleHeader) +
+        (sizeof(assetc::AssetEntry) * static_cast<std::uint64_t>(entries_.size())) +
+        static_cast<std::uint64_t>(stringTable_.size());
+
+    out_.open(tempPath_, std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc);
+    if (!out_.is_open()) {
+      return Result<void *, String>::err("Failed to open output file: " + tempPath_.string());
+    }
+    Vector<char> placeholder(static_cast<size_t>(dataRegionOffset_), 0);
+    out_.write(placeholder.data(), static_cast<std::streamsize>(placeholder.size()));
+    if (!out_.good()) {
+      return writeFailed();
+    }
+    return Result<void *, String>::ok(nullptr);
+  }
+
+  /// Appends the next entry from its compiled storedBytes.
+  Result<void *, String> append(const CompiledAsset &asset) {
+    auto begun = beginEntry(asset, static_cast<std::uint64_t>(asset.storedBytes.size()));
+    if (begun.isErr()) {
+      return begun;
+    }
+    if (!asset.storedBytes.empty()) {
+      out_.write(reinterpret_cast<const char *>(asset.storedBytes.data()),
+                 static_cast<std::streamsize>(asset.storedBytes.size()));
+    }
+    return out_.good() ? Result<void *, String>::ok(nullptr) : writeFailed();
+  }
+
+  /// Appends the next entry by copying @p storedSize bytes of an earlier
+  /// bundle from @p source, starting at @p offset.
+  Result<void *, String> appendCopy(const CompiledAsset &asset, std::istream &source,
+                                    std::uint64_t offset, std::uint64_t storedSize) {
+    auto begun = beginEntry(asset, storedSize);
+    if (begun.isErr()) {
+      return begun;
+    }
+    source.clear();
+    source.seekg(static_cast<std::streamoff>(offset), std::ios::beg);
+    Vector<char> buffer(static_cast<size_t>(std::min<std::uint64_t>(CopyBufferSize, storedSize)));
+    for (std::uint64_t left = storedSize; left > 0;) {
+      auto length = static_cast<std::streamsize>(std::min<std::uint64_t>(buffer.size(), left));
+      if (!source.read(buffer.data(), length)) {
+        return Result<void *, String>::err("Failed to read \"" + asset.bundleName +
+                                           "\" from the previous bundle.");
+      }
+      out_.write(buffer.data(), length);
+      left -= static_cast<std::uint64_t>(length);
+    }
+    return out_.good() ? Result<void *, String>::ok(nullptr) : writeFailed();
+  }
+
+  /// Fills in the header and entry table and replaces the output file. The
+  /// bundle hash covers the entries, string table and data region in that
+  /// order, so the data region is read back from the file to hash it.
+  Result<void *, String> finish(const CompilerOptions &options) {
+    if (appended_ != entries_.size()) {
+      return Result<void *, String>::err("Bundle closed before every asset was written.");
+    }
+
+    assetc::BundleHeader header {};
+    header.version = assetc::BundleVersion;
+    header.entryCount = static_cast<std::uint32_t>(entries_.size());
+    header.stringTableSize = static_cast<std::uint32_t>(stringTable_.size());
+    header.dataRegionOffset = dataRegionOffset_;
+    header.dataRegionSize = dataRegionSize_;
+    header.flags = static_cast<std::uint16_t>(assetc::BundleFlags::None);
+    if (options.sign) {
+      header.flags |= static_cast<std::uint16_t>(assetc::BundleFlags::Signed);
+    }
+    if (options.encrypt) {
+      header.flags |= static_cast<std::uint16_t>(assetc::BundleFlags::Encrypted);
+    }
+    for (const auto &entry : entries_) {
+      if ((entry.flags & static_cast<std::uint32_t>(assetc::AssetEntryFlags::Compressed)) != 0) {
+        header.flags |= static_cast<std::uint16_t>(assetc::BundleFlags::Compressed);
+        break;
+      }
+    }
+
+    out_.flush();
+    if (options.sign) {
+      auto context = OmegaCommon::DigestContext::create(DigestAlgorithm::SHA256);
+      if (context.isErr()) {
+        return Result<void *, String>::err("Failed to compute bundle hash: " +
+                                           context.error().message);
+      }
+      auto &hash = context.value();
+      hash.update(reinterpret_cast<const std::uint8_t *>(entries_.data()),
+                  entries_.size() * sizeof(assetc::AssetEntry));
+      hash.update(stringTable_.data(), stringTable_.size());
+
+      out_.seekg(static_cast<std::streamoff>(dataRegionOffset_), std::ios::beg);
+      Vector<std::uint8_t> buffer(CopyBufferSize);
+      for (std::uint64_t left = dataRegionSize_; left > 0;) {
+        auto length = static_cast<size_t>(std::min<std::uint64_t>(buffer.size(), left));
+        if (!out_.read(reinterpret_cast<char *>(buffer.data()), static_cast<std::streamsize>(length))) {
+          return Result<void *, String>::err("Failed to read back output file: " +
+                                             tempPath_.string());
+        }
+        hash.update(buffer.data(), length);
+        left -= length;
+      }
+
+      auto digestResult = hash.finish();
+      if (digestResult.isErr() || digestResult.value().bytes.size() != sizeof(header.bundleHash)) {
+        return Result<void *, String>::err("Failed to compute bundle hash: " +
+                                           (digestResult.isErr() ? digestResult.error().message
+                                                                 : String("unexpected digest length")));
+      }
+      std::copy(digestResult.value().bytes.begin(), digestResult.value().bytes.end(),
+                header.bundleHash);
+    }
+
+    out_.seekp(0, std::ios::beg);
+    out_.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    if (!entries_.empty()) {
+      out_.write(reinterpret_cast<const char *>(entries_.data()),
+                 static_cast<std::streamsize>(entries_.size() * sizeof(assetc::AssetEntry)));
+    }
+    if (!stringTable_.empty()) {
+      out_.write(reinterpret_cast<const char *>(stringTable_.data()),
+                 static_cast<std::streamsize>(stringTable_.size()));
+    }
+    out_.close();
+    if (out_.fail()) {
+      return writeFailed();
+    }
+
+    std::error_code ec;
+    fs::rename(tempPath_, outputPath_, ec);
+    if (ec) {
+      return Result<void *, String>::err("Failed to replace output file " +
+                                         outputPath_.string() + ": " + ec.message());
+    }
+    committed_ = true;
+    return Result<void *, String>::ok(nullptr);
+  }
+};
+
+/// Per-input record kept next to the bundle in "<output>.inputs" for
+/// --incremental builds.
+struct InputRecord {
+  String sourcePath;
+  std::uint64_t size = 0;
+  std::int64_t modified = 0;
+};
+
+struct InputCache {
+  /// Everything besides the input that decides an entry's stored bytes; a
+  /// cache recorded under different settings is ignored.
+  String settings;
+  /// File-clock time at which the build that wrote the cache started, before
+  /// it statted or read any input.
+  std::int64_t started = 0;
+  std::unordered_map<String, InputRecord> records;
+};
+
+String inputCachePath(const fs::path &bundlePath) {
+  return bundlePath.string() + ".inputs";
 }
 
-void appendBytes(Vector<std::uint8_t> &out, const Vector<std::uint8_t> &bytes) {
-  out.insert(out.end(), bytes.begin(), bytes.end());
+/// Identifies the key without revealing it, so a bundle rebuilt with a
+/// different key never reuses entries sealed with the old one.
+Result<String, String> encryptionKeyId(const EncryptionKey &key) {
+  Vector<std::uint8_t> input(KeyIdLabel, KeyIdLabel + std::char_traits<char>::length(KeyIdLabel));
+  input.insert(input.end(), key.data(), key.data() + key.size());
+  auto hashResult = sha256(input);
+  OmegaCommon::secureZero(input.data(), input.size());
+  if (hashResult.isErr()) {
+    return Result<String, String>::err(hashResult.error());
+  }
+  return Result<String, String>::ok(bytesToHex(hashResult.value().data(), 16));
 }
 
-Result<void *, String> writeBundleV2(const CompilerOptions &options,
-                                     const Vector<CompiledAsset> &assets) {
-  Vector<assetc::AssetEntry> entries;
-  entries.reserve(assets.size());
+String buildSettingsKey(const CompilerOptions &options, StrRef keyId) {
+  std::ostringstream out;
+  out << "compress=" << (options.compress ? toLowerCopy(options.codec) : String("none"))
+      << "/" << assetc::DefaultCompressionChunkSize << ";encrypt="
+      << (options.encrypt ? String(keyId.data(), keyId.size()) : String("none")) << "/"
+      << assetc::DefaultEncryptionChunkSize;
+  return out.str();
+}
 
-  Vector<std::uint8_t> stringTable;
-  Vector<std::uint8_t> dataRegion;
+/// Missing or malformed caches read as empty: the build just starts over.
+InputCache readInputCache(const fs::path &path) {
+  InputCache cache;
+  std::ifstream in(path, std::ios::binary);
+  String line;
+  if (!in.is_open() || !std::getline(in, line) || line != InputCacheMagic) {
+    return cache;
+  }
+  if (!std::getline(in, line) || line.rfind("settings ", 0) != 0) {
+    return cache;
+  }
+  cache.settings = line.substr(9);
+  if (!std::getline(in, line) || line.rfind("started ", 0) != 0) {
+    return InputCache {};
+  }
+  cache.started = std::strtoll(line.c_str() + 8, nullptr, 10);
+
+  while (std::getline(in, line)) {
+    // <modified>\t<size>\t<bundle name>\t<source path>
+    Vector<String> fields;
+    size_t start = 0;
+    for (size_t tab; fields.size() < 3 && (tab = line.find('\t', start)) != String::npos; start = tab + 1) {
+      fields.push_back(line.substr(start, tab - start));
+    }
+    if (fields.size() != 3) {
+      return InputCache {};
+    }
+    InputRecord record;
+    record.sourcePath = line.substr(start);
+    char *end = nullptr;
+    record.modified = std::strtoll(fields[0].c_str(), &end, 10);
+    record.size = std::strtoull(fields[1].c_str(), &end, 10);
+    cache.records[fields[2]] = std::move(record);
+  }
+  return cache;
+}
 
-  std::uint64_t currentOffset = 0;
-  for (const auto &asset : assets) {
-    assetc::AssetEntry entry {};
-    entry.nameOffset = static_cast<std::uint32_t>(stringTable.size());
-    entry.nameLength = static_cast<std::uint16_t>(asset.bundleName.size());
-    entry.assetType = static_cast<std::uint16_t>(asset.type);
-    entry.dataOffset = currentOffset;
-    entry.rawSize = static_cast<std::uint64_t>(asset.rawBytes.size());
-    entry.storedSize = static_cast<std::uint64_t>(asset.storedBytes.size());
-    entry.flags = asset.flags;
-    std::copy(asset.entryHash.begin(), asset.entryHash.end(), entry.entryHash);
+Result<void *, String> writeInputCache(const fs::path &path, const String &settings,
+                                       std::int64_t started, const Vector<CompiledAsset> &assets) {
+  auto tempPath = fs::path(path.string() + ".tmp");
+  {
+    std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+      return Result<void *, String>::err("Failed to write input cache: " + tempPath.string());
+    }
+    out << InputCacheMagic << "\n"
+        << "settings " << settings << "\n"
+        << "started " << started << "\n";
+    for (const auto &asset : assets) {
+      out << asset.sourceModified << "\t" << asset.sourceSize << "\t" << asset.bundleName
+          << "\t" << asset.sourcePath.string() << "\n";
+    }
+    if (!out.good()) {
+      return Result<void *, String>::err("Failed while writing input cache: " +
+                                         tempPath.string());
+    }
+  }
+  std::error_code ec;
+  fs::rename(tempPath, path, ec);
+  if (ec) {
+    return Result<void *, String>::err("Failed to replace input cache " + path.string() +
+                                       ": " + ec.message());
+  }
+  return Result<void *, String>::ok(nullptr);
+}
 
-    stringTable.insert(stringTable.end(), asset.bundleName.begin(), asset.bundleName.end());
-    stringTable.push_back(0);
+/// The bundle an --incremental build replaces, opened for copying entries.
+struct PreviousBundle {
+  std::ifstream in;
+  std::uint64_t dataRegionOffset = 0;
+  std::unordered_map<String, assetc::AssetEntry> entries;
+};
 
-    appendBytes(dataRegion, asset.storedBytes);
-    currentOffset += entry.storedSize;
-    entries.push_back(entry);
+Result<void *, String> readPreviousBundle(const fs::path &path, PreviousBundle &bundle) {
+  bundle.in.open(path, std::ios::binary);
+  if (!bundle.in.is_open()) {
+    return Result<void *, String>::err("no previous bundle at " + path.string());
   }
 
+  std::error_code ec;
+  auto fileSize = static_cast<std::uint64_t>(fs::file_size(path, ec));
   assetc::BundleHeader header {};
-  header.version = assetc::BundleVersion;
-  header.entryCount = static_cast<std::uint32_t>(entries.size());
-  header.stringTableSize = static_cast<std::uint32_t>(stringTable.size());
-  header.dataRegionOffset =
-      sizeof(assetc::BundleHeader) +
-      (sizeof(assetc::AssetEntry) * static_cast<std::uint64_t>(entries.size())) +
-      static_cast<std::uint64_t>(stringTable.size());
-  header.dataRegionSize = static_cast<std::uint64_t>(dataRegion.size());
-  header.flags = static_cast<std::uint16_t>(assetc::BundleFlags::None);
-  if (options.sign) {
-    header.flags |= static_cast<std::uint16_t>(assetc::BundleFlags::Signed);
+  if (ec || !bundle.in.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+      !assetc::hasBundleMagic(header.magic) || header.version != assetc::BundleVersion) {
+    return Result<void *, String>::err("previous bundle is not a v2 bundle");
   }
-  if (options.encrypt) {
-    header.flags |= static_cast<std::uint16_t>(assetc::BundleFlags::Encrypted);
+
+  auto tableSize = sizeof(assetc::AssetEntry) * static_cast<std::uint64_t>(header.entryCount) +
+                   header.stringTableSize;
+  if (header.dataRegionOffset != sizeof(header) + tableSize ||
+      header.dataRegionOffset + header.dataRegionSize != fileSize) {
+    return Result<void *, String>::err("previous bundle layout is inconsistent");
   }
 
-  if (options.sign) {
-    Vector<std::uint8_t> hashInput;
-    hashInput.reserve(entries.size() * sizeof(assetc::AssetEntry) +
-                      stringTable.size() + dataRegion.size());
+  Vector<assetc::AssetEntry> entries(header.entryCount);
+  Vector<char> names(header.stringTableSize);
+  if (!entries.empty() &&
+      !bundle.in.read(reinterpret_cast<char *>(entries.data()),
+                      static_cast<std::streamsize>(entries.size() * sizeof(assetc::AssetEntry)))) {
+    return Result<void *, String>::err("previous bundle entry table is truncated");
+  }
+  if (!names.empty() && !bundle.in.read(names.data(), static_cast<std::streamsize>(names.size()))) {
+    return Result<void *, String>::err("previous bundle string table is truncated");
+  }
 
-    for (const auto &entry : entries) {
-      appendStructBytes(hashInput, entry);
+  for (const auto &entry : entries) {
+    if (static_cast<std::uint64_t>(entry.nameOffset) + entry.nameLength > names.size() ||
+        entry.dataOffset + entry.storedSize > header.dataRegionSize) {
+      return Result<void *, String>::err("previous bundle has an out-of-range entry");
     }
-    appendBytes(hashInput, stringTable);
-    appendBytes(hashInput, dataRegion);
+    bundle.entries[String(names.data() + entry.nameOffset, entry.nameLength)] = entry;
+  }
+  bundle.dataRegionOffset = header.dataRegionOffset;
+  return Result<void *, String>::ok(nullptr);
+}
 
-    auto hashResult = sha256(hashInput);
-    if (hashResult.isErr()) {
-      return Result<void *, String>::err("Failed to compute bundle hash: " +
-                                         hashResult.error());
+/// Shared, read-only state for the compile tasks.
+struct CompileContext {
+  Optional<assetc::CompressionCodec> codec;
+  const EncryptionKey *key = nullptr;
+  /// Empty unless --incremental found a previous bundle built with the same
+  /// settings.
+  const std::unordered_map<String, assetc::AssetEntry> *previousEntries = nullptr;
+  const InputCache *inputCache = nullptr;
+};
+
+void reuseEntry(CompiledAsset &asset, const assetc::AssetEntry &entry) {
+  std::copy(std::begin(entry.entryHash), std::end(entry.entryHash), asset.entryHash.begin());
+  asset.rawSize = entry.rawSize;
+  asset.storedSize = entry.storedSize;
+  asset.flags = entry.flags;
+  asset.previousDataOffset = entry.dataOffset;
+  asset.rawBytes = {};
+}
+
+/// Whether the cache's size and modification time for an input still vouch
+/// for its contents. They only do when the recorded time is older than the
+/// start of the build that recorded it, by more than the coarsest timestamp
+/// granularity in use (FAT's two seconds): an input written in the same tick
+/// as that build read it could have changed without its time moving, so it
+/// is hashed instead.
+bool inputUnchanged(const InputCache &cache, const InputRecord &record, const CompiledAsset &asset) {
+  const auto slack = std::chrono::duration_cast<fs::file_time_type::duration>(std::chrono::seconds(2));
+  return record.sourcePath == asset.sourcePath.string() && record.size == asset.sourceSize &&
+         record.modified == asset.sourceModified && record.modified < cache.started - slack.count();
+}
+
+/// Reads, hashes, compresses and encrypts one prepared asset. Runs on a
+/// worker thread. With --incremental, an asset the cache vouches for (see
+/// inputUnchanged) is taken from the previous bundle without reading it, and
+/// one whose contents hash the same is taken from it without recompressing or
+/// re-encrypting.
+Result<CompiledAsset, String> buildAsset(CompiledAsset asset, const CompileContext &context) {
+  const assetc::AssetEntry *previous = nullptr;
+  if (context.previousEntries != nullptr) {
+    auto it = context.previousEntries->find(asset.bundleName);
+    if (it != context.previousEntries->end() &&
+        it->second.assetType == static_cast<std::uint16_t>(asset.type)) {
+      previous = &it->second;
     }
+  }
 
-    std::copy(hashResult.value().begin(), hashResult.value().end(),
-              header.bundleHash);
+  if (previous != nullptr && context.inputCache != nullptr) {
+    auto record = context.inputCache->records.find(asset.bundleName);
+    if (record != context.inputCache->records.end() &&
+        inputUnchanged(*context.inputCache, record->second, asset) &&
+        previous->rawSize == asset.sourceSize) {
+      reuseEntry(asset, *previous);
+      return Result<CompiledAsset, String>::ok(std::move(asset));
+    }
   }
 
-  std::ofstream out(options.outputFile, std::ios::binary | std::ios::trunc);
-  if (!out.is_open()) {
-    return Result<void *, String>::err("Failed to open output file: " + options.outputFile);
+  auto read = readAsset(asset);
+  if (read.isErr()) {
+    return Result<CompiledAsset, String>::err(read.error());
   }
 
-  out.write(reinterpret_cast<const char *>(&header), sizeof(header));
-  if (!entries.empty()) {
-    out.write(reinterpret_cast<const char *>(entries.data()),
-              static_cast<std::streamsize>(entries.size() * sizeof(assetc::AssetEntry)));
+  if (previous != nullptr && previous->rawSize == asset.rawSize &&
+      std::equal(asset.entryHash.begin(), asset.entryHash.end(), std::begin(previous->entryHash))) {
+    reuseEntry(asset, *previous);
+    return Result<CompiledAsset, String>::ok(std::move(asset));
   }
-  if (!stringTable.empty()) {
-    out.write(reinterpret_cast<const char *>(stringTable.data()),
-              static_cast<std::streamsize>(stringTable.size()));
+
+  if (context.codec.has_value()) {
+    auto compressed = compressCompiledAsset(asset, *context.codec);
+    if (compressed.isErr()) {
+      return Result<CompiledAsset, String>::err(compressed.error());
+    }
   }
-  if (!dataRegion.empty()) {
-    out.write(reinterpret_cast<const char *>(dataRegion.data()),
-              static_cast<std::streamsize>(dataRegion.size()));
+  if ((asset.flags & static_cast<std::uint32_t>(assetc::AssetEntryFlags::Compressed)) == 0) {
+    asset.storedBytes = std::move(asset.rawBytes);
   }
+  asset.rawBytes = {};
 
-  if (!out.good()) {
-    return Result<void *, String>::err("Failed while writing output file: " +
-                                       options.outputFile);
+  if (context.key != nullptr) {
+    auto encrypted = encryptCompiledAsset(asset, *context.key);
+    if (encrypted.isErr()) {
+      return Result<CompiledAsset, String>::err(encrypted.error());
+    }
   }
+  asset.storedSize = static_cast<std::uint64_t>(asset.storedBytes.size());
+  return Result<CompiledAsset, String>::ok(std::move(asset));
+}
 
-  return Result<void *, String>::ok(nullptr);
+Result<assetc::CompressionCodec, String> parseCodec(StrRef value) {
+  auto codec = toLowerCopy(value);
+  if (codec == "lz4") {
+    return Result<assetc::CompressionCodec, String>::ok(assetc::CompressionCodec::LZ4);
+  }
+  if (codec == "zstd") {
+    return Result<assetc::CompressionCodec, String>::ok(assetc::CompressionCodec::Zstd);
+  }
+  return Result<assetc::CompressionCodec, String>::err(
+      "Unsupported --codec value: " + codec + ". Expected lz4 or zstd.");
+}
+
+Result<unsigned, String> parseJobs(const String &value) {
+  if (value.empty()) {
+    return Result<unsigned, String>::ok(0U);
+  }
+  char *end = nullptr;
+  auto jobs = std::strtoul(value.c_str(), &end, 10);
+  if (end == value.c_str() || *end != '\0' || jobs == 0 || jobs > 1024) {
+    return Result<unsigned, String>::err("Invalid --jobs value: " + value +
+                                         ". Expected a positive thread count.");
+  }
+  return Result<unsigned, String>::ok(static_cast<unsigned>(jobs));
 }
 
 void printHelp(const OmegaCommon::Argv::Parser &parser) {
@@ -923,15 +1439,24 @@ void printHelp(const OmegaCommon::Argv::Parser &parser) {
             << "  Bundles are signed and encrypted by default.\n"
             << "  When no --key-file is provided, " << ProgramName
             << " will create or reuse a companion key file at <output>.key.\n"
-            << "  --compress is reserved for a later phase and currently returns an error.\n";
+            << "  --compress stores assets as independently decodable "
+            << (assetc::DefaultCompressionChunkSize / 1024) << " KiB chunks; assets that do not\n"
+            << "  shrink are stored uncompressed.\n"
+            << "  Assets are compiled in parallel (--jobs) and streamed into the bundle in\n"
+            << "  input order, so the output does not depend on the thread count.\n"
+            << "  --incremental records input sizes and modification times in <output>.inputs\n"
+            << "  and copies unchanged entries from the existing bundle instead of recompiling.\n";
 }
 
 void printVerboseAsset(const CompiledAsset &asset) {
   std::cout << "  " << asset.bundleName << "\n"
             << "    source: " << asset.sourcePath.string() << "\n"
             << "    type: " << OmegaCommon::assetTypeName(asset.type) << "\n"
-            << "    raw size: " << asset.rawBytes.size() << " bytes\n"
-            << "    stored size: " << asset.storedBytes.size() << " bytes\n";
+            << "    raw size: " << asset.rawSize << " bytes\n"
+            << "    stored size: " << asset.storedSize << " bytes\n";
+  if (asset.previousDataOffset.has_value()) {
+    std::cout << "    reused from previous bundle\n";
+  }
 }
 
 Result<void *, String> validateOptions(const CompilerOptions &options) {
@@ -940,8 +1465,10 @@ Result<void *, String> validateOptions(const CompilerOptions &options) {
   }
 
   if (options.compress) {
-    return Result<void *, String>::err(
-        "Compression is planned for a later asset pipeline phase and is not implemented yet.");
+    auto codec = parseCodec(options.codec);
+    if (codec.isErr()) {
+      return Result<void *, String>::err(codec.error());
+    }
   }
 
   if (options.keyPassphrase) {
@@ -949,6 +1476,11 @@ Result<void *, String> validateOptions(const CompilerOptions &options) {
         "Passphrase-derived bundle keys are not implemented yet. Use --key-file or the default companion key file.");
   }
 
+  auto jobs = parseJobs(options.jobs);
+  if (jobs.isErr()) {
+    return Result<void *, String>::err(jobs.error());
+  }
+
   if (options.manifestFile.empty() && options.inputs.empty()) {
     return Result<void *, String>::err(
         "No input files were provided. Use positional inputs or --manifest.");
@@ -972,7 +1504,9 @@ int main(int argc, char *const argv[]) {
                    "Application identifier reserved for signing/encryption phases.");
   parser.addOption(options.appId, "application-id", {}, "id",
                    "Backward-compatible alias for --app-id.");
-  parser.addFlag(options.compress, "compress", {}, "Enable compression (not implemented yet).");
+  parser.addFlag(options.compress, "compress", {}, "Store assets as chunked compressed payloads.");
+  parser.addOption(options.codec, "codec", {}, "lz4|zstd",
+                   "Compression codec used with --compress (default lz4).");
   parser.addFlag(options.encrypt, "encrypt", {}, "Enable encryption (enabled by default).");
   parser.addFlag(options.noEncrypt, "no-encrypt", {},
                  "Disable encryption (encryption is on by default).");
@@ -989,6 +1523,10 @@ int main(int argc, char *const argv[]) {
                    "Read asset entries from a manifest file.");
   parser.addOption(options.assetTypesFile, "asset-types", {}, "file",
                    "Asset type JSON config path. Defaults to AssetTypes.json.");
+  parser.addOption(options.jobs, "jobs", "j", "count",
+                   "Assets compiled in parallel (default: one per hardware thread).");
+  parser.addFlag(options.incremental, "incremental", {},
+                 "Reuse unchanged entries from the existing output bundle.");
   parser.addFlag(options.verbose, "verbose", "v",
                  "Print per-asset details while compiling.");
   parser.addPositional(options.inputs, "inputs", "Input asset files.", false);
@@ -1054,39 +1592,32 @@ int main(int argc, char *const argv[]) {
     encryptionKey = std::move(resolvedKey.value());
   }
 
+  // Taken before any input is statted; see inputUnchanged.
+  const auto buildStarted =
+      static_cast<std::int64_t>(fs::file_time_type::clock::now().time_since_epoch().count());
   Vector<CompiledAsset> assets;
   assets.reserve(gatheredInputs.value().size());
   std::unordered_map<String, String> seenAssetNames;
 
   for (const auto &input : gatheredInputs.value()) {
-    auto compiled = compileAsset(input, typeOverrides.value(), stripPrefixes,
+    auto prepared = prepareAsset(input, typeOverrides.value(), stripPrefixes,
                                  assetTypeConfig.value());
-    if (compiled.isErr()) {
-      std::cerr << ProgramName << ": error: " << compiled.error() << std::endl;
+    if (prepared.isErr()) {
+      std::cerr << ProgramName << ": error: " << prepared.error() << std::endl;
       return 1;
     }
 
-    auto existing = seenAssetNames.find(compiled.value().bundleName);
+    auto existing = seenAssetNames.find(prepared.value().bundleName);
     if (existing != seenAssetNames.end()) {
       std::cerr << ProgramName << ": error: Duplicate asset name \""
-                << compiled.value().bundleName << "\" from \""
-                << compiled.value().declaredPath << "\" and \"" << existing->second
+                << prepared.value().bundleName << "\" from \""
+                << prepared.value().declaredPath << "\" and \"" << existing->second
                 << "\"." << std::endl;
       return 1;
     }
 
-    seenAssetNames[compiled.value().bundleName] = compiled.value().declaredPath;
-    if (options.encrypt) {
-      auto encrypted = encryptCompiledAsset(compiled.value(), *encryptionKey);
-      if (encrypted.isErr()) {
-        std::cerr << ProgramName << ": error: " << encrypted.error() << std::endl;
-        return 1;
-      }
-    }
-    if (options.verbose) {
-      printVerboseAsset(compiled.value());
-    }
-    assets.push_back(std::move(compiled.value()));
+    seenAssetNames[prepared.value().bundleName] = prepared.value().declaredPath;
+    assets.push_back(std::move(prepared.value()));
   }
 
   auto outputPath = fs::path(options.outputFile);
@@ -1100,12 +1631,125 @@ int main(int argc, char *const argv[]) {
     }
   }
 
-  auto writeResult = writeBundleV2(options, assets);
+  String keyId;
+  if (encryptionKey.has_value()) {
+    auto id = encryptionKeyId(*encryptionKey);
+    if (id.isErr()) {
+      std::cerr << ProgramName << ": error: " << id.error() << std::endl;
+      return 1;
+    }
+    keyId = std::move(id.value());
+  }
+  auto settings = buildSettingsKey(options, keyId);
+  auto cachePath = fs::path(inputCachePath(outputPath));
+
+  CompileContext context {};
+  if (options.compress) {
+    context.codec = parseCodec(options.codec).value();
+  }
+  context.key = encryptionKey.has_value() ? &*encryptionKey : nullptr;
+
+  InputCache inputCache;
+  PreviousBundle previous;
+  if (options.incremental) {
+    inputCache = readInputCache(cachePath);
+    if (inputCache.settings != settings) {
+      if (options.verbose) {
+        std::cout << "No input cache for these settings; compiling every asset." << std::endl;
+      }
+    } else {
+      auto opened = readPreviousBundle(outputPath, previous);
+      if (opened.isErr()) {
+        if (options.verbose) {
+          std::cout << "Not reusing the previous bundle: " << opened.error() << std::endl;
+        }
+      } else {
+        context.previousEntries = &previous.entries;
+        context.inputCache = &inputCache;
+      }
+    }
+  } else {
+    // A full build leaves no cache behind that could describe another bundle.
+    std::error_code ec;
+    fs::remove(cachePath, ec);
+  }
+
+  BundleWriter writer;
+  auto opened = writer.open(outputPath, assets);
+  if (opened.isErr()) {
+    std::cerr << ProgramName << ": error: " << opened.error() << std::endl;
+    return 1;
+  }
+
+  // Declared after everything the tasks reference: its destructor drains
+  // any tasks still queued when an error returns early.
+  OmegaCommon::TaskScheduler scheduler(parseJobs(options.jobs).value());
+
+  // Keep a bounded window of assets in flight so memory stays proportional
+  // to the thread count rather than the bundle size.
+  size_t window = std::max<size_t>(2, scheduler.workerCount() * 2U);
+  Vector<OmegaCommon::Async<Result<CompiledAsset, String>>> pending;
+  pending.reserve(assets.size());
+  auto launch = [&](size_t index) {
+    pending.push_back(scheduler.async([&assets, &context, index]() {
+      return buildAsset(assets[index], context);
+    }));
+  };
+  for (size_t i = 0; i < std::min(window, assets.size()); ++i) {
+    launch(i);
+  }
+
+  size_t reusedCount = 0;
+  for (size_t i = 0; i < assets.size(); ++i) {
+    auto compiled = std::move(pending[i].get());
+    if (i + window < assets.size()) {
+      launch(i + window);
+    }
+    if (compiled.isErr()) {
+      std::cerr << ProgramName << ": error: " << compiled.error() << std::endl;
+      return 1;
+    }
+
+    auto &asset = compiled.value();
+    auto written = asset.previousDataOffset.has_value()
+                       ? writer.appendCopy(asset, previous.in,
+                                           previous.dataRegionOffset + *asset.previousDataOffset,
+                                           asset.storedSize)
+                       : writer.append(asset);
+    if (written.isErr()) {
+      std::cerr << ProgramName << ": error: " << written.error() << std::endl;
+      return 1;
+    }
+    if (asset.previousDataOffset.has_value()) {
+      ++reusedCount;
+    }
+    if (options.verbose) {
+      printVerboseAsset(asset);
+    }
+    // Only the metadata is kept for the input cache.
+    asset.storedBytes = {};
+    assets[i] = std::move(asset);
+  }
+
+  // The previous bundle has to be closed before it can be replaced on Windows.
+  previous.in.close();
+  auto writeResult = writer.finish(options);
   if (writeResult.isErr()) {
     std::cerr << ProgramName << ": error: " << writeResult.error() << std::endl;
     return 1;
   }
 
+  if (options.incremental) {
+    auto cached = writeInputCache(cachePath, settings, buildStarted, assets);
+    if (cached.isErr()) {
+      std::cerr << ProgramName << ": error: " << cached.error() << std::endl;
+      return 1;
+    }
+    std::cout << ProgramName << ": reused " << reusedCount << " of " << assets.size()
+              << " asset" << (assets.size() == 1 ? "" : "s") << " from the previous bundle"
+              << std::endl;
+  }
+
   std::cout << ProgramName << ": wrote " << assets.size() << " asset"
             << (assets.size() == 1 ? "" : "s") << " to " << options.outputFile
             << " (bundle v2 format)"
@@ -87,6 +87,54 @@ bool verifyEntryOrder(const Vector<AssetInfo> &entries,
   return true;
 }
 
+/// prefetch() must hand back exactly what load() returns, in request order,
+/// with repeated names sharing a result and missing names failing alone.
+bool verifyPrefetch(const AssetBundle &bundle, const Vector<ExpectedAsset> &expected) {
+  Vector<String> names;
+  for (auto it = expected.rbegin(); it != expected.rend(); ++it) {
+    names.push_back(it->name);
+  }
+  names.push_back("Missing/Asset.txt");
+  names.push_back(expected.front().name);
+
+  auto pending = bundle.prefetch(names);
+  if (!expect(pending.size() == names.size(), "prefetch() returned the wrong number of results.")) {
+    return false;
+  }
+
+  for (size_t i = 0; i < names.size(); ++i) {
+    auto &result = pending[i].get();
+    if (names[i] == "Missing/Asset.txt") {
+      if (!expect(result.isErr(), "prefetch() should fail for missing assets.")) {
+        return false;
+      }
+      continue;
+    }
+    if (result.isErr()) {
+      std::cerr << "omega-assetbundle-verifier: error: " << result.error() << std::endl;
+      return false;
+    }
+    auto loaded = bundle.load(names[i]);
+    if (!expect(loaded.isOk() && loaded.value() == result.value(),
+                "prefetch() bytes differ from load() bytes for " + names[i] + ".")) {
+      return false;
+    }
+  }
+
+  auto single = bundle.loadAsync(expected.front().name);
+  return expect(single.get().isOk(), "loadAsync() failed for " + String(expected.front().name) + ".");
+}
+
+/// verify() must accept every entry of an intact bundle.
+bool verifyAllHashes(const AssetBundle &bundle) {
+  auto result = bundle.verify();
+  if (result.isErr()) {
+    std::cerr << "omega-assetbundle-verifier: error: " << result.error() << std::endl;
+    return false;
+  }
+  return true;
+}
+
 bool verifyBundle(const String &bundlePath) {
   auto openResult = AssetBundle::open(Path(bundlePath));
   if (openResult.isErr()) {
@@ -144,31 +192,43 @@ bool verifyBundle(const String &bundlePath) {
       return false;
     }
 
+    // Encrypted and compressed entries stream too. Only bundles encrypted as
+    // a single block by older bundlers may refuse.
     auto streamResult = bundle.stream(asset.name);
     if (streamResult.isErr()) {
-      // Encrypted/compressed entries must be rejected cleanly. The existing
-      // signed+encrypted bundle exercises this branch.
       const auto &message = streamResult.error();
-      if (!expect(message.find("encrypted") != String::npos ||
-                      message.find("compressed") != String::npos,
+      if (!expect(message.find("encrypted as a single block") != String::npos,
                   "Unexpected stream() error for " + String(asset.name) + ": " + message)) {
         return false;
       }
-    } else {
-      auto &stream = *streamResult.value();
-      String streamed((std::istreambuf_iterator<char>(stream)),
-                       std::istreambuf_iterator<char>());
-      if (!expect(!stream.bad(),
-                  "stream() reported a bad state while reading " + String(asset.name) + ".")) {
-        return false;
-      }
-      if (!expect(streamed == loaded,
-                  "stream() bytes differ from load() bytes for " + String(asset.name) + ".")) {
-        return false;
-      }
+      continue;
+    }
+
+    auto &stream = *streamResult.value();
+    String streamed((std::istreambuf_iterator<char>(stream)),
+                     std::istreambuf_iterator<char>());
+    if (!expect(!stream.bad(),
+                "stream() reported a bad state while reading " + String(asset.name) + ".")) {
+      return false;
+    }
+    if (!expect(streamed == loaded,
+                "stream() bytes differ from load() bytes for " + String(asset.name) + ".")) {
+      return false;
+    }
+
+    stream.clear();
+    stream.seekg(static_cast<std::streamoff>(expectedSize / 2), std::ios::beg);
+    String tail((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+    if (!expect(!stream.bad() && tail == loaded.substr(expectedSize / 2),
+                "stream() returned wrong bytes after seeking in " + String(asset.name) + ".")) {
+      return false;
     }
   }
 
+  if (!verifyPrefetch(bundle, expected) || !verifyAllHashes(bundle)) {
+    return false;
+  }
+
   auto textResult = bundle.loadText("Config/AppConfig.json");
   if (textResult.isErr()) {
     std::cerr << "omega-assetbundle-verifier: error: " << textResult.error()
@@ -191,6 +251,70 @@ bool verifyBundle(const String &bundlePath) {
   return expect(missing.isErr(), "load() should fail for missing assets.");
 }
 
+bool verifyMappedBundle(const String &bundlePath) {
+  auto openResult = AssetBundle::openMapped(Path(bundlePath));
+  if (openResult.isErr()) {
+    std::cerr << "omega-assetbundle-verifier: error: " << openResult.error()
+              << std::endl;
+    return false;
+  }
+
+  auto bundle = std::move(openResult.value());
+  auto expected = expectedAssets();
+
+  // Verify up front so the in-place batch hashes every borrowable entry.
+  if (!expect(bundle.isMapped(), "openMapped() returned an unmapped bundle.") ||
+      !verifyEntryOrder(bundle.entries(), expected) || !verifyAllHashes(bundle)) {
+    return false;
+  }
+
+  for (const auto &asset : expected) {
+    auto bytesResult = bundle.load(asset.name);
+    if (bytesResult.isErr()) {
+      std::cerr << "omega-assetbundle-verifier: error: " << bytesResult.error()
+                << std::endl;
+      return false;
+    }
+
+    auto loaded = String(bytesResult.value().begin(), bytesResult.value().end());
+    if (!expect(loaded == asset.contents,
+                "Mapped load() payload mismatch for " + String(asset.name) + ".")) {
+      return false;
+    }
+
+    auto borrowResult = bundle.borrow(asset.name);
+    if (borrowResult.isErr()) {
+      // Encrypted/compressed entries cannot be borrowed in place.
+      const auto &message = borrowResult.error();
+      if (!expect(message.find("encrypted") != String::npos ||
+                      message.find("compressed") != String::npos,
+                  "Unexpected borrow() error for " + String(asset.name) + ": " + message)) {
+        return false;
+      }
+      continue;
+    }
+
+    auto view = borrowResult.value();
+    String borrowed(reinterpret_cast<const char *>(view.data()), view.size());
+    if (!expect(borrowed == loaded,
+                "borrow() bytes differ from load() bytes for " + String(asset.name) + ".")) {
+      return false;
+    }
+  }
+
+  if (!verifyPrefetch(bundle, expected)) {
+    return false;
+  }
+
+  AssetBundle streamed;
+  auto unmapped = AssetBundle::open(Path(bundlePath));
+  if (unmapped.isOk()) {
+    streamed = std::move(unmapped.value());
+  }
+  return expect(streamed.borrow("Config/AppConfig.json").isErr(),
+                "borrow() should require a mapped bundle.");
+}
+
 } // namespace
 
 int main(int argc, char **argv) {
@@ -200,5 +324,5 @@ int main(int argc, char **argv) {
     return 2;
   }
 
-  return verifyBundle(argv[1]) ? 0 : 1;
+  return verifyBundle(argv[1]) && verifyMappedBundle(argv[1]) ? 0 : 1;
 }
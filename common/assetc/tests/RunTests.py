@@ -1,6 +1,7 @@
 #!/usr/bin/env python3
 import argparse
 import filecmp
+import os
 import shutil
 import subprocess
 import tempfile
@@ -168,6 +169,55 @@ class AssetCIntegrationTests(unittest.TestCase):
         ]
         return self._run(args, cwd=self.cfg.suite_dir)
 
+    def _run_assetc_compressed(
+        self, output_path: Path, codec: str, encrypt: bool
+    ) -> subprocess.CompletedProcess[str]:
+        args = [
+            str(self.cfg.omega_assetc),
+            "--asset-types",
+            str(self.cfg.asset_types),
+            "--manifest",
+            str(self.manifest_file),
+            "--strip-prefix",
+            "DemoAssets",
+            "--type",
+            "Materials/Hero.asset=material",
+            "--compress",
+            "--codec",
+            codec,
+            "--sign",
+            "--output",
+            str(output_path),
+        ]
+        if not encrypt:
+            args.insert(-3, "--no-encrypt")
+        return self._run(args, cwd=self.cfg.suite_dir)
+
+    def _run_assetc_in(
+        self, suite_dir: Path, output_path: Path, extra_args: list[str]
+    ) -> subprocess.CompletedProcess[str]:
+        args = [
+            str(self.cfg.omega_assetc),
+            "--asset-types",
+            str(self.cfg.asset_types),
+            "--manifest",
+            str(suite_dir / "DemoAssets.manifest"),
+            "--strip-prefix",
+            "DemoAssets",
+            "--type",
+            "Materials/Hero.asset=material",
+            *extra_args,
+            "--output",
+            str(output_path),
+        ]
+        return self._run(args, cwd=suite_dir)
+
+    def _copy_demo_assets(self) -> Path:
+        suite_copy = self.work_dir / "suite"
+        shutil.copytree(self.cfg.suite_dir / "DemoAssets", suite_copy / "DemoAssets")
+        shutil.copyfile(self.manifest_file, suite_copy / "DemoAssets.manifest")
+        return suite_copy
+
     def _require_golden_fixture(self) -> None:
         if not self.golden_fixture_available:
             self.skipTest(
@@ -263,6 +313,24 @@ class AssetCIntegrationTests(unittest.TestCase):
             ),
         )
 
+    def test_encrypted_bundle_rejects_tampered_chunk(self) -> None:
+        output_path = self.work_dir / "TamperedChunkDemoAssetsV2.pak"
+        proc = self._run_assetc_with_default_key(output_path)
+        self.assertEqual(
+            proc.returncode,
+            0,
+            msg=f"omega-assetc failed to produce encrypted bundle\nSTDOUT:\n{proc.stdout}\nSTDERR:\n{proc.stderr}",
+        )
+
+        # The last byte belongs to the GCM tag of the final chunk.
+        payload = bytearray(output_path.read_bytes())
+        payload[-1] ^= 0x01
+        output_path.write_bytes(payload)
+
+        verify_proc = self._run_verifier(output_path)
+        self.assertNotEqual(verify_proc.returncode, 0, "Tampered encrypted chunk unexpectedly verified.")
+        self.assertIn("tampered", verify_proc.stderr.lower())
+
     def test_unencrypted_bundle_streams_round_trip(self) -> None:
         output_path = self.work_dir / "UnencryptedDemoAssetsV2.pak"
         proc = self._run_assetc_unencrypted(output_path)
@@ -287,6 +355,111 @@ class AssetCIntegrationTests(unittest.TestCase):
             ),
         )
 
+    def test_compressed_bundles_round_trip(self) -> None:
+        for codec in ("lz4", "zstd"):
+            for encrypt in (False, True):
+                with self.subTest(codec=codec, encrypt=encrypt):
+                    suffix = "Encrypted" if encrypt else "Plain"
+                    output_path = self.work_dir / f"Compressed{codec.upper()}{suffix}.pak"
+                    proc = self._run_assetc_compressed(output_path, codec, encrypt)
+                    self.assertEqual(
+                        proc.returncode,
+                        0,
+                        msg=f"omega-assetc --compress --codec {codec} failed\nSTDOUT:\n{proc.stdout}\nSTDERR:\n{proc.stderr}",
+                    )
+
+                    verify_proc = self._run_verifier(output_path)
+                    self.assertEqual(
+                        verify_proc.returncode,
+                        0,
+                        msg=(
+                            f"Verifier failed for {codec} compressed bundle\n"
+                            f"STDOUT:\n{verify_proc.stdout}\nSTDERR:\n{verify_proc.stderr}"
+                        ),
+                    )
+
+    def test_bundle_does_not_depend_on_job_count(self) -> None:
+        outputs = []
+        for jobs in ("1", "4"):
+            output_path = self.work_dir / f"Jobs{jobs}.pak"
+            proc = self._run_assetc_in(
+                self.cfg.suite_dir,
+                output_path,
+                ["--compress", "--codec", "zstd", "--key-file", str(self.work_dir / "jobs.key"), "--jobs", jobs],
+            )
+            self.assertEqual(
+                proc.returncode,
+                0,
+                msg=f"omega-assetc --jobs {jobs} failed\nSTDOUT:\n{proc.stdout}\nSTDERR:\n{proc.stderr}",
+            )
+            outputs.append(output_path.read_bytes())
+        self.assertEqual(outputs[0], outputs[1], "Bundle contents changed with --jobs.")
+
+    def test_incremental_build_reuses_unchanged_assets(self) -> None:
+        suite_copy = self._copy_demo_assets()
+        output_path = self.work_dir / "Incremental.pak"
+        args = ["--compress", "--codec", "lz4", "--incremental"]
+
+        first = self._run_assetc_in(suite_copy, output_path, args)
+        self.assertEqual(first.returncode, 0, msg=f"STDOUT:\n{first.stdout}\nSTDERR:\n{first.stderr}")
+        self.assertIn("reused 0 of 4 assets", first.stdout)
+        self.assertTrue(Path(str(output_path) + ".inputs").exists(), "Input cache was not written.")
+        first_bytes = output_path.read_bytes()
+
+        second = self._run_assetc_in(suite_copy, output_path, args)
+        self.assertEqual(second.returncode, 0, msg=f"STDOUT:\n{second.stdout}\nSTDERR:\n{second.stderr}")
+        self.assertIn("reused 4 of 4 assets", second.stdout)
+        self.assertEqual(output_path.read_bytes(), first_bytes, "No-op incremental build changed the bundle.")
+
+        verify_proc = self._run_verifier(output_path)
+        self.assertEqual(
+            verify_proc.returncode,
+            0,
+            msg=f"Verifier failed for incremental bundle\nSTDOUT:\n{verify_proc.stdout}\nSTDERR:\n{verify_proc.stderr}",
+        )
+
+        scene = suite_copy / "DemoAssets" / "Worlds" / "Intro.scene"
+        scene.write_bytes(scene.read_bytes() + b"\n// edited\n")
+        third = self._run_assetc_in(suite_copy, output_path, args)
+        self.assertEqual(third.returncode, 0, msg=f"STDOUT:\n{third.stdout}\nSTDERR:\n{third.stderr}")
+        self.assertIn("reused 3 of 4 assets", third.stdout)
+
+        # An edit that keeps both the size and the modification time right
+        # after a build is still caught: the cache does not vouch for inputs
+        # written that close to the build that recorded them.
+        recorded_ns = scene.stat().st_mtime_ns
+        scene.write_bytes(scene.read_bytes().replace(b"// edited", b"// EDITED"))
+        os.utime(scene, ns=(scene.stat().st_atime_ns, recorded_ns))
+        fourth = self._run_assetc_in(suite_copy, output_path, args)
+        self.assertEqual(fourth.returncode, 0, msg=f"STDOUT:\n{fourth.stdout}\nSTDERR:\n{fourth.stderr}")
+        self.assertIn("reused 3 of 4 assets", fourth.stdout)
+
+        # The verifier checks against the pristine DemoAssets, so the edited
+        # bundle is checked against a full rebuild instead.
+        full_path = self.work_dir / "Full.pak"
+        shutil.copyfile(Path(str(output_path) + ".key"), Path(str(full_path) + ".key"))
+        full = self._run_assetc_in(suite_copy, full_path, ["--compress", "--codec", "lz4"])
+        self.assertEqual(full.returncode, 0, msg=f"STDOUT:\n{full.stdout}\nSTDERR:\n{full.stderr}")
+        self.assertEqual(full_path.read_bytes(), output_path.read_bytes())
+
+    def test_incremental_build_ignores_cache_from_other_settings(self) -> None:
+        suite_copy = self._copy_demo_assets()
+        output_path = self.work_dir / "Settings.pak"
+        first = self._run_assetc_in(suite_copy, output_path, ["--no-encrypt", "--incremental"])
+        self.assertEqual(first.returncode, 0, msg=f"STDOUT:\n{first.stdout}\nSTDERR:\n{first.stderr}")
+
+        second = self._run_assetc_in(suite_copy, output_path, ["--incremental"])
+        self.assertEqual(second.returncode, 0, msg=f"STDOUT:\n{second.stdout}\nSTDERR:\n{second.stderr}")
+        self.assertIn("reused 0 of 4 assets", second.stdout)
+        verify_proc = self._run_verifier(output_path)
+        self.assertEqual(verify_proc.returncode, 0, msg=verify_proc.stderr)
+
+    def test_assetc_rejects_unknown_codec(self) -> None:
+        output_path = self.work_dir / "UnknownCodec.pak"
+        proc = self._run_assetc_compressed(output_path, "brotli", False)
+        self.assertNotEqual(proc.returncode, 0, "omega-assetc accepted an unknown codec.")
+        self.assertIn("unsupported --codec value", proc.stderr.lower())
+
     def test_assetbundle_rejects_legacy_like_bundle(self) -> None:
         legacy_like_bundle = self.work_dir / "LegacyLike.pak"
         legacy_like_bundle.write_bytes((1).to_bytes(4, byteorder="little", signed=False))
@@ -1,4 +1,5 @@
 #include "omega-common/fs.h"
+#include "omega-common/multithread.h"
 
 #include <cstdint>
 #include <istream>
@@ -49,18 +50,62 @@ namespace OmegaCommon {
       static Result<AssetBundle, String> open(FS::Path path);
       static Result<AssetBundle, String> open(FS::Path path, ArrayRef<std::uint8_t> key);
 
+      /// Opens @p path as a read-only memory mapping. The header, entry table
+      /// and string table are parsed straight from the mapping, and payloads
+      /// are served from it: @c borrow hands out views with no copy, and
+      /// @c load copies once instead of reading through a stream.
+      static Result<AssetBundle, String> openMapped(FS::Path path);
+      static Result<AssetBundle, String> openMapped(FS::Path path, ArrayRef<std::uint8_t> key);
+
+      OMEGA_NODISCARD bool isMapped() const;
+
       OMEGA_NODISCARD size_t entryCount() const;
       OMEGA_NODISCARD Optional<AssetInfo> info(StrRef name) const;
       OMEGA_NODISCARD bool contains(StrRef name) const;
       OMEGA_NODISCARD Vector<AssetInfo> entries() const;
 
-      OMEGA_NODISCARD Result<Vector<std::uint8_t>, String> load(StrRef name) const;
+      /// Outcome of one load, as returned by @c load and delivered by @c prefetch.
+      using LoadResult = Result<Vector<std::uint8_t>, String>;
+
+      OMEGA_NODISCARD LoadResult load(StrRef name) const;
       OMEGA_NODISCARD Result<String, String> loadText(StrRef name) const;
 
-      /// Returns an input stream over the raw stored bytes of @p name.
+      /// Loads every entry in @p names as one batch on the shared TaskScheduler
+      /// and returns one Async per name, in the same order. Entries are read in
+      /// file-offset order with neighbouring payloads merged into one read, and
+      /// each entry is decrypted, decompressed and verified on a worker as soon
+      /// as its bytes arrive, while the next read is in flight. Destroying the
+      /// bundle waits for its outstanding batches.
+      OMEGA_NODISCARD Vector<Async<LoadResult>> prefetch(const Vector<String> &names) const;
+
+      /// Single-entry form of @c prefetch.
+      OMEGA_NODISCARD Async<LoadResult> loadAsync(StrRef name) const;
+
+      /// Returns a view of @p name's bytes directly inside the file mapping,
+      /// e.g. to hand a texture or mesh to a GPU upload without a staging copy.
+      /// The view stays valid for the lifetime of the bundle. The entry hash is
+      /// verified on the first borrow of each entry. Only available on bundles
+      /// opened with @c openMapped, and only for entries stored uncompressed
+      /// and unencrypted — use @c load for the rest.
+      OMEGA_NODISCARD Result<Span<const std::uint8_t>, String> borrow(StrRef name) const;
+
+      /// Checks the stored hash of every entry that has one. On a mapped
+      /// bundle the entries @c borrow can serve are hashed in place as one
+      /// batch spread over the shared TaskScheduler, and count as verified for
+      /// later borrows; every other entry is decoded one at a time, which
+      /// checks its hash (and authenticates it, if encrypted) as @c load does.
+      /// Fails naming an entry that does not match.
+      OMEGA_NODISCARD Result<void *, String> verify() const;
+
+      /// Returns an input stream over the decoded bytes of @p name.
       /// The stream owns its own file handle; it may outlive the bundle and
-      /// be read independently from other streams. Encrypted or compressed
-      /// entries are rejected — use @c load instead.
+      /// be read independently from other streams. Compressed entries are
+      /// decoded, and encrypted entries decrypted and authenticated, one chunk
+      /// at a time as the stream is read, so memory stays bounded by the chunk
+      /// size. Reading such an entry front to back also checks its hash before
+      /// the last chunk is handed out; a failed check sets badbit. Entries
+      /// encrypted as a single block by older bundlers are rejected — use
+      /// @c load instead.
       OMEGA_NODISCARD Result<UniqueHandle<std::istream>, String> stream(StrRef name) const;
   };
   
@@ -0,0 +1,40 @@
+#include "utils.h"
+
+#include <cstdint>
+
+#ifndef OMEGA_COMMON_COMPRESSION_H
+#define OMEGA_COMMON_COMPRESSION_H
+
+namespace OmegaCommon {
+
+    /// @brief Block codecs available to bundle and cache formats. Values are serialized.
+    enum class CompressionCodec : std::uint8_t {
+        None = 0,
+        LZ4 = 1,
+        Zstd = 2,
+    };
+
+    OMEGACOMMON_EXPORT const char *compressionCodecName(CompressionCodec codec);
+
+    /// @brief Worst-case compressed size of @p srcSize bytes, for sizing output buffers.
+    OMEGACOMMON_EXPORT size_t compressBound(CompressionCodec codec, size_t srcSize);
+
+    /// @brief Compresses one self-contained block.
+    /// @paragraph
+    /// @p level selects the codec's speed/ratio trade-off (LZ4: values above 0 use LZ4HC,
+    /// Zstd: the zstd level); 0 picks the codec default.
+    OMEGACOMMON_EXPORT Result<Vector<std::uint8_t>, String> compressBlock(CompressionCodec codec,
+                                                                      ArrayRef<std::uint8_t> src,
+                                                                      int level = 0);
+
+    /// @brief Decompresses one block produced by compressBlock into @p dst.
+    /// @paragraph
+    /// The block must decode to exactly @p dstSize bytes; anything else is reported as corruption.
+    /// Safe to call concurrently on distinct blocks.
+    OMEGACOMMON_EXPORT Result<void *, String> decompressBlock(CompressionCodec codec,
+                                                            const std::uint8_t *src, size_t srcSize,
+                                                            std::uint8_t *dst, size_t dstSize);
+
+}
+
+#endif
@@ -36,6 +36,41 @@ namespace OmegaCommon {
 
     OMEGACOMMON_EXPORT bool constantTimeEquals(ArrayRef<std::uint8_t> a, ArrayRef<std::uint8_t> b);
 
+    struct DigestContextImpl;
+
+    /// Incremental digest for data that arrives in pieces. finish() yields the
+    /// digest and leaves the context ready for the next message, so one context
+    /// can hash any number of messages without being recreated.
+    class OMEGACOMMON_EXPORT DigestContext {
+        std::unique_ptr<DigestContextImpl> impl_;
+        explicit DigestContext(std::unique_ptr<DigestContextImpl> impl);
+    public:
+        ~DigestContext();
+        DigestContext(const DigestContext &) = delete;
+        DigestContext &operator=(const DigestContext &) = delete;
+        DigestContext(DigestContext &&) noexcept;
+        DigestContext &operator=(DigestContext &&) noexcept;
+
+        static Result<DigestContext, CryptoError> create(DigestAlgorithm alg);
+        Result<void *, CryptoError> update(const std::uint8_t *data, size_t len);
+        Result<DigestResult, CryptoError> finish();
+        /// Discards any data passed to update() since the last finish().
+        Result<void *, CryptoError> reset();
+    };
+
+    /// Hashes every buffer in @p buffers on its own and returns the digests in
+    /// the same order. Buffers are spread over TaskScheduler::shared(), each
+    /// worker reusing one digest context; small batches run on the caller.
+    OMEGACOMMON_EXPORT Result<Vector<DigestResult>, CryptoError> digestAll(
+        DigestAlgorithm alg, const Vector<ArrayRef<std::uint8_t>> &buffers);
+
+    /// Hashes @p buffers as digestAll() does and compares each result against
+    /// the digest at the same index of @p expected in constant time. Returns the
+    /// indices that did not match, in ascending order; empty means all passed.
+    OMEGACOMMON_EXPORT Result<Vector<size_t>, CryptoError> verifyDigests(
+        DigestAlgorithm alg, const Vector<ArrayRef<std::uint8_t>> &buffers,
+        const Vector<DigestResult> &expected);
+
     // ==== Secure Memory ====
 
     /// Zeroes memory securely (not optimized away). Backed by OPENSSL_cleanse.
@@ -107,6 +142,60 @@ namespace OmegaCommon {
         const EncryptedData &enc,
         const std::uint8_t *aad = nullptr, size_t aadLen = 0);
 
+    /// AES-256-GCM decrypt of @p ciphertextLen bytes into @p out, which must hold
+    /// as many bytes and may alias @p ciphertext. Nothing written to @p out may
+    /// be trusted if authentication fails.
+    OMEGACOMMON_EXPORT Result<void *, CryptoError> decryptInto(
+        const EncryptionKey &key, const Nonce &nonce,
+        const std::uint8_t *ciphertext, size_t ciphertextLen,
+        const std::array<std::uint8_t, 16> &tag, std::uint8_t *out,
+        const std::uint8_t *aad = nullptr, size_t aadLen = 0);
+
+    struct AeadContextImpl;
+
+    /// AES-256-GCM bound to one key. The key schedule is set up once by create()
+    /// and each message only re-arms the nonce, so sealing or opening many
+    /// messages under one key (e.g. the chunks of an asset) skips the per-call
+    /// setup of encrypt() / decryptInto(). A message is begin*(), any number of
+    /// update() calls, then the matching finish*(). Not safe to share between
+    /// threads; give each thread its own context.
+    class OMEGACOMMON_EXPORT AeadContext {
+        std::unique_ptr<AeadContextImpl> impl_;
+        explicit AeadContext(std::unique_ptr<AeadContextImpl> impl);
+    public:
+        ~AeadContext();
+        AeadContext(const AeadContext &) = delete;
+        AeadContext &operator=(const AeadContext &) = delete;
+        AeadContext(AeadContext &&) noexcept;
+        AeadContext &operator=(AeadContext &&) noexcept;
+
+        static Result<AeadContext, CryptoError> create(const EncryptionKey &key);
+
+        /// Starts a message. The AAD, if any, is given here, before any update().
+        Result<void *, CryptoError> beginEncrypt(const Nonce &nonce,
+            const std::uint8_t *aad = nullptr, size_t aadLen = 0);
+        Result<void *, CryptoError> beginDecrypt(const Nonce &nonce,
+            const std::uint8_t *aad = nullptr, size_t aadLen = 0);
+
+        /// Encrypts or decrypts the next @p len bytes of the current message
+        /// into @p out, which must hold as many bytes and may alias @p in.
+        Result<void *, CryptoError> update(const std::uint8_t *in, size_t len, std::uint8_t *out);
+
+        Result<void *, CryptoError> finishEncrypt(std::array<std::uint8_t, 16> &tag);
+        /// Fails if @p tag does not authenticate the message; nothing update()
+        /// produced for it may then be trusted.
+        Result<void *, CryptoError> finishDecrypt(const std::array<std::uint8_t, 16> &tag);
+
+        /// Whole-message forms, equivalent to encrypt() and decryptInto().
+        Result<EncryptedData, CryptoError> seal(const Nonce &nonce,
+            const std::uint8_t *plaintext, size_t plaintextLen,
+            const std::uint8_t *aad = nullptr, size_t aadLen = 0);
+        Result<void *, CryptoError> openInto(const Nonce &nonce,
+            const std::uint8_t *ciphertext, size_t ciphertextLen,
+            const std::array<std::uint8_t, 16> &tag, std::uint8_t *out,
+            const std::uint8_t *aad = nullptr, size_t aadLen = 0);
+    };
+
     // ==== Key Derivation ====
 
     /// HKDF (RFC 5869) extract-and-expand. Salt and info may be nullptr.
@@ -1,8 +1,15 @@
 #include "utils.h"
+#include <chrono>
 #include <ctime>
 #include <tuple>
 #include <array>
 #include <memory>
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <ostream>
+#include <streambuf>
+#include <utility>
 
 #ifndef OMEGA_COMMON_FORMAT_H
 #define OMEGA_COMMON_FORMAT_H
@@ -22,6 +29,65 @@ namespace OmegaCommon {
         virtual void log(LogLevel level, StrRef message) = 0;
     };
 
+    /**
+     @brief A LogSink that moves formatting and I/O off the logging thread.
+     @paragraph
+     log() copies the message into a lock-free ring owned by the calling thread and returns
+     without taking a lock or touching a stream. A background writer thread drains every
+     ring in batches and writes `[LEVEL] message` lines to a file, to stdout/stderr (Warn and
+     Error go to stderr, as with the default sink), or forwards them to another LogSink.
+     Messages from one thread keep their order; messages from different threads are
+     interleaved per batch. When a thread's ring is full, the overflow policy either drops
+     the message (counted, and reported in the output) or waits for the writer to make room.
+    */
+    class OMEGACOMMON_EXPORT AsyncLogSink : public LogSink {
+    public:
+        enum class Overflow : int {
+            /// Discard the message; the writer later logs how many were lost.
+            Drop,
+            /// Spin until the writer frees space (never loses messages).
+            Block
+        };
+
+        struct Options {
+            /// Ring bytes per logging thread, rounded up to a power of two.
+            /// Messages longer than half a ring are truncated.
+            size_t ringSize = 64 * 1024;
+            Overflow overflow = Overflow::Drop;
+            /// Append to this file instead of writing to stdout/stderr.
+            OmegaCommon::String filePath;
+            /// Hand drained messages to this sink (on the writer thread)
+            /// instead of writing text. Takes precedence over filePath.
+            std::shared_ptr<LogSink> target;
+            /// Prefix each line with the wall-clock time the message was logged.
+            bool timestamps = false;
+            /// Longest the writer sleeps before polling the rings again.
+            std::chrono::milliseconds pollInterval {5};
+        };
+
+        static Result<std::shared_ptr<AsyncLogSink>,OmegaCommon::String> create();
+
+        /// Fails when `options.filePath` cannot be opened for appending.
+        static Result<std::shared_ptr<AsyncLogSink>,OmegaCommon::String> create(Options options);
+
+        void log(LogLevel level, StrRef message) override;
+
+        /// Block until every message logged (on any thread) before the call
+        /// has been written out. Must not be called from the target sink.
+        void flush();
+
+        /// Messages discarded under Overflow::Drop so far.
+        OMEGA_NODISCARD size_t droppedCount() const;
+
+        /// Drains all rings, then stops the writer thread.
+        ~AsyncLogSink() override;
+
+    private:
+        struct Impl;
+        std::unique_ptr<Impl> impl;
+        explicit AsyncLogSink(std::unique_ptr<Impl> impl);
+    };
+
     template<typename T>
     struct FormatProvider;
 
@@ -114,21 +180,254 @@ namespace OmegaCommon {
         return new ObjectFormatProvider<Ty>(std::forward<T>(object));
     };
 
+    template<class _Providers,size_t ..._Idx>
+    std::array<ObjectFormatProviderBase *,sizeof...(_Idx)> _formatProviderArray(_Providers & providers,std::index_sequence<_Idx...>){
+        return {{&std::get<_Idx>(providers)...}};
+    }
+
+    /// Formats a runtime format string. The argument providers live on the
+    /// stack; prefer the OMEGA_FMT overload when the format is a literal.
     template<class ..._Args>
      OmegaCommon::String fmtString(const char *fmt,_Args && ...args){
         std::ostringstream out;
-//        auto t_args = std::make_tuple(std::forward<_Args>(args)...);
-        std::array<ObjectFormatProviderBase *,sizeof...(args)> arrayArgs = {buildFormatProvider(std::forward<_Args>(args))...};
+        std::tuple<ObjectFormatProvider<std::decay_t<_Args>>...> providers {std::forward<_Args>(args)...};
+        auto arrayArgs = _formatProviderArray(providers,std::index_sequence_for<_Args...>{});
         Formatter * formatter = createFormatter(fmt,out);
         format(formatter,{arrayArgs.data(),arrayArgs.data() + arrayArgs.size()});
         freeFormatter(formatter);
-        for(auto a : arrayArgs){
-            delete a;
-        }
-        
         return out.str();
     };
 
+    /// @name Compile-time format strings
+    /// `OMEGA_FMT("...")` wraps a string literal in a unique type whose
+    /// placeholders (`@0`..`@9`, `@{n}`, `@@`, same grammar as the runtime
+    /// Formatter) are parsed at compile time. Formatting then walks the parsed
+    /// pieces with no further scanning, packs arguments as a tuple of
+    /// references, and appends straight into a caller-owned String, so a
+    /// reused buffer formats without allocating. A placeholder naming a
+    /// missing argument is a compile error.
+    /// @{
+
+    struct FormatPiece {
+        /// Literal text [begin,begin+length) of the format string.
+        size_t begin = 0;
+        size_t length = 0;
+        /// Argument to insert after the literal, or NoArg.
+        size_t arg = 0;
+        static constexpr size_t NoArg = ~size_t(0);
+    };
+
+    template<size_t N>
+    struct FormatSpec {
+        std::array<FormatPiece,N> pieces {};
+        /// One past the largest argument index referenced (0 when none).
+        size_t argCount = 0;
+    };
+
+    /// Base of every OMEGA_FMT type.
+    struct FormatStringBase {};
+
+    template<class T>
+    using _is_format_string = std::is_base_of<FormatStringBase,T>;
+
+    constexpr size_t _formatLength(const char *str){
+        size_t n = 0;
+        while(str[n] != '\0'){
+            ++n;
+        }
+        return n;
+    }
+
+    constexpr bool _formatIsDigit(char c){
+        return c >= '0' && c <= '9';
+    }
+
+    /// Scan one placeholder at str[i] (which is '@'). Sets `arg` (NoArg for a
+    /// literal '@') and returns the number of characters consumed.
+    constexpr size_t _scanFormatPlaceholder(const char *str,size_t n,size_t i,size_t & arg){
+        arg = FormatPiece::NoArg;
+        if(i + 1 >= n){
+            return 1;
+        }
+        char next = str[i + 1];
+        if(next == '@'){
+            return 2;
+        }
+        if(_formatIsDigit(next)){
+            arg = size_t(next - '0');
+            return 2;
+        }
+        if(next == '{'){
+            size_t j = i + 2;
+            size_t idx = 0;
+            while(j < n && _formatIsDigit(str[j])){
+                idx = idx * 10 + size_t(str[j] - '0');
+                ++j;
+            }
+            if(j > i + 2 && j < n && str[j] == '}'){
+                arg = idx;
+                return j + 1 - i;
+            }
+        }
+        return 1;
+    }
+
+    /// Visit the format as (literal, arg) pieces. "@@" yields a piece whose
+    /// literal is the first '@'; an unmatched '@' stays in the literal run.
+    template<class _Fn>
+    constexpr void _walkFormat(const char *str,_Fn && fn){
+        size_t n = _formatLength(str);
+        size_t begin = 0;
+        size_t i = 0;
+        while(i < n){
+            if(str[i] != '@'){
+                ++i;
+                continue;
+            }
+            size_t arg = FormatPiece::NoArg;
+            size_t consumed = _scanFormatPlaceholder(str,n,i,arg);
+            if(arg != FormatPiece::NoArg){
+                fn(begin,i - begin,arg);
+                begin = i + consumed;
+            }
+            else if(consumed == 2){
+                fn(begin,i + 1 - begin,FormatPiece::NoArg);
+                begin = i + 2;
+            }
+            i += consumed;
+        }
+        if(begin < n){
+            fn(begin,n - begin,FormatPiece::NoArg);
+        }
+    }
+
+    struct _FormatPieceCounter {
+        size_t * count;
+        constexpr void operator()(size_t,size_t,size_t) const { ++*count; }
+    };
+
+    template<size_t N>
+    struct _FormatPieceWriter {
+        FormatSpec<N> * spec;
+        size_t * next;
+        constexpr void operator()(size_t begin,size_t length,size_t arg) const {
+            FormatPiece & piece = spec->pieces[(*next)++];
+            piece.begin = begin;
+            piece.length = length;
+            piece.arg = arg;
+            if(arg != FormatPiece::NoArg && arg + 1 > spec->argCount){
+                spec->argCount = arg + 1;
+            }
+        }
+    };
+
+    constexpr size_t _countFormatPieces(const char *str){
+        size_t count = 0;
+        _walkFormat(str,_FormatPieceCounter{&count});
+        return count;
+    }
+
+    template<size_t N>
+    constexpr FormatSpec<N> _parseFormat(const char *str){
+        FormatSpec<N> spec {};
+        size_t next = 0;
+        _walkFormat(str,_FormatPieceWriter<N>{&spec,&next});
+        return spec;
+    }
+
+    template<class _Fmt>
+    struct _FormatSpecOf {
+        static constexpr size_t count = _countFormatPieces(_Fmt::value());
+        static constexpr FormatSpec<count> spec = _parseFormat<count>(_Fmt::value());
+    };
+
+    /// streambuf that appends to a String; backs the FormatProvider fallback.
+    class _StringAppendBuf : public std::streambuf {
+        OmegaCommon::String & out;
+    protected:
+        int_type overflow(int_type c) override {
+            if(!traits_type::eq_int_type(c,traits_type::eof())){
+                out.push_back(traits_type::to_char_type(c));
+            }
+            return traits_type::not_eof(c);
+        }
+        std::streamsize xsputn(const char *s,std::streamsize n) override {
+            out.append(s,static_cast<size_t>(n));
+            return n;
+        }
+    public:
+        explicit _StringAppendBuf(OmegaCommon::String & out):out(out){}
+    };
+
+    template<class T>
+    void _formatArg(OmegaCommon::String & out,const T & value){
+        if constexpr (std::is_same_v<T,bool>){
+            out.append(value ? "true" : "false");
+        }
+        else if constexpr (std::is_same_v<T,char>){
+            out.push_back(value);
+        }
+        else if constexpr (std::is_integral_v<T>){
+            char digits[24];
+            auto result = std::to_chars(digits,digits + sizeof(digits),value);
+            out.append(digits,static_cast<size_t>(result.ptr - digits));
+        }
+        else if constexpr (std::is_floating_point_v<T>){
+            char digits[32];
+            int n = std::snprintf(digits,sizeof(digits),"%g",static_cast<double>(value));
+            if(n > 0){
+                out.append(digits,std::min(static_cast<size_t>(n),sizeof(digits) - 1));
+            }
+        }
+        else if constexpr (std::is_convertible_v<const T &,StrRef>){
+            StrRef str = value;
+            if(str.data() != nullptr){
+                out.append(str.data(),str.size());
+            }
+        }
+        else {
+            _StringAppendBuf buf(out);
+            std::ostream os(&buf);
+            FormatProvider<T>::format(os,const_cast<T &>(value));
+        }
+    }
+
+    template<class _Fmt,class _Tuple,size_t ..._Idx>
+    void _formatPieces(OmegaCommon::String & out,const _Tuple & args,std::index_sequence<_Idx...>){
+        (void)args;
+        auto piece = [&](auto idx){
+            constexpr FormatPiece p = _FormatSpecOf<_Fmt>::spec.pieces[decltype(idx)::value];
+            out.append(_Fmt::value() + p.begin,p.length);
+            if constexpr (p.arg != FormatPiece::NoArg){
+                _formatArg(out,std::get<p.arg>(args));
+            }
+        };
+        (void)piece;
+        (piece(std::integral_constant<size_t,_Idx>{}),...);
+    }
+
+    /// Append `fmt` with `args` substituted to `out`.
+    template<class _Fmt,class ..._Args,std::enable_if_t<_is_format_string<_Fmt>::value,int> = 0>
+    void formatTo(OmegaCommon::String & out,_Fmt,const _Args & ...args){
+        using Spec = _FormatSpecOf<_Fmt>;
+        static_assert(Spec::spec.argCount <= sizeof...(_Args),"Format placeholder index exceeds argument count");
+        _formatPieces<_Fmt>(out,std::forward_as_tuple(args...),std::make_index_sequence<Spec::count>{});
+    }
+
+    template<class _Fmt,class ..._Args,std::enable_if_t<_is_format_string<_Fmt>::value,int> = 0>
+    OmegaCommon::String fmtString(_Fmt fmt,const _Args & ...args){
+        OmegaCommon::String out;
+        formatTo(out,fmt,args...);
+        return out;
+    }
+
+    /// @}
+
+    /// Borrow this thread's reusable log buffer (cleared). Returns nullptr
+    /// when it is already borrowed, i.e. a sink is logging from inside log().
+    OMEGACOMMON_EXPORT OmegaCommon::String * acquireLogBuffer();
+    OMEGACOMMON_EXPORT void releaseLogBuffer();
+
     template<class ..._Args>
     void Log(LogLevel level, const char *fmt,_Args && ...args){
         if(!shouldLog(level)){
@@ -138,31 +437,60 @@ namespace OmegaCommon {
         logMessage(level,message);
     }
 
-    template<class ..._Args>
-    void LogDebug(const char *fmt,_Args && ...args){
+    template<class _Fmt,class ..._Args,std::enable_if_t<_is_format_string<_Fmt>::value,int> = 0>
+    void Log(LogLevel level,_Fmt fmt,const _Args & ...args){
+        if(!shouldLog(level)){
+            return;
+        }
+        struct Lease {
+            OmegaCommon::String *buffer = acquireLogBuffer();
+            ~Lease(){
+                if(buffer != nullptr){
+                    releaseLogBuffer();
+                }
+            }
+        } lease;
+        OmegaCommon::String nested;
+        OmegaCommon::String & out = lease.buffer != nullptr ? *lease.buffer : nested;
+        formatTo(out,fmt,args...);
+        logMessage(level,out);
+    }
+
+    template<class _Fmt,class ..._Args>
+    void LogDebug(_Fmt fmt,_Args && ...args){
         Log(LogLevel::Debug,fmt,std::forward<_Args>(args)...);
     }
 
-    template<class ..._Args>
-    void LogInfo(const char *fmt,_Args && ...args){
+    template<class _Fmt,class ..._Args>
+    void LogInfo(_Fmt fmt,_Args && ...args){
         Log(LogLevel::Info,fmt,std::forward<_Args>(args)...);
     }
 
-    template<class ..._Args>
-    void LogWarn(const char *fmt,_Args && ...args){
+    template<class _Fmt,class ..._Args>
+    void LogWarn(_Fmt fmt,_Args && ...args){
         Log(LogLevel::Warn,fmt,std::forward<_Args>(args)...);
     }
 
-    template<class ..._Args>
-    void LogError(const char *fmt,_Args && ...args){
+    template<class _Fmt,class ..._Args>
+    void LogError(_Fmt fmt,_Args && ...args){
         Log(LogLevel::Error,fmt,std::forward<_Args>(args)...);
     }
 
-    template<class ..._Args>
-    void LogV(const char *fmt,_Args && ...args){
+    template<class _Fmt,class ..._Args>
+    void LogV(_Fmt fmt,_Args && ...args){
         LogInfo(fmt,std::forward<_Args>(args)...);
     }
     
 };
 
+/// Compile-time parsed format string; see OmegaCommon::formatTo.
+/// e.g. `OmegaCommon::LogDebug(OMEGA_FMT("frame @0 took @1 ms"),frame,ms);`
+#define OMEGA_FMT(str) \
+    ([](){ \
+        struct _OmegaFmt : ::OmegaCommon::FormatStringBase { \
+            static constexpr const char *value(){ return str; } \
+        }; \
+        return _OmegaFmt{}; \
+    }())
+
 #endif
@@ -183,6 +183,30 @@ namespace OmegaCommon::FS {
 
         OMEGACOMMON_EXPORT StatusCode changeCWD(Path newPath);
 
+        // -- Memory mapping --
+
+        /// @brief A read-only memory mapping of an entire file.
+        /// @paragraph
+        /// Pages are faulted in from the page cache on demand, so borrowing a region costs no copy.
+        /// Views into the mapping must not outlive the MappedFile. An empty file maps to an empty view.
+        class OMEGACOMMON_EXPORT MappedFile {
+            const std::uint8_t *_data = nullptr;
+            size_t _size = 0;
+            void *handle = nullptr;
+            MappedFile() = default;
+        public:
+            MappedFile(const MappedFile &) = delete;
+            MappedFile & operator=(const MappedFile &) = delete;
+
+            static Result<UniqueHandle<MappedFile>, StatusCode> open(Path path);
+
+            const std::uint8_t *data() const { return _data; }
+            size_t size() const { return _size; }
+            Span<const std::uint8_t> bytes() const { return {_data, _size}; }
+
+            ~MappedFile();
+        };
+
         // -- Process / executable location --
 
         /// @brief Absolute path to the currently-running executable,
@@ -3,12 +3,16 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <functional>
+#include <istream>
+#include <memory>
 #include <string>
 #include <utility>
 
 #include "omega-common/utils.h"
 #include "omega-common/fs.h"
 #include "omega-common/assets.h"
+#include "omega-common/multithread.h"
 
 // Img is its own split binary (OmegaCommonImg); its public symbols are
 // exported with OMEGACOMMON_IMG_EXPORT, gated on OMEGACOMMON_IMG__BUILD__.
@@ -38,7 +42,8 @@ namespace OmegaCommon::Img {
         RGB,
         RGBA,
         Pallete,
-        Unknown
+        Unknown,
+        BGRA
     };
 
     enum class AlphaFormat : std::uint8_t {
@@ -54,6 +59,38 @@ namespace OmegaCommon::Img {
         JPEG
     };
 
+    /// Output pixel layout requested from a decoder. All forced layouts are 8 bits per channel.
+    enum class PixelFormat : std::uint8_t {
+        Native, /// Whatever the codec produces (RGBA for JPEG and TIFF, RGB or RGBA for PNG).
+        RGBA8,
+        BGRA8,
+        RGB8    /// Alpha, if any, is dropped.
+    };
+
+    /// Rectangle in source image pixels, measured from the top-left corner.
+    struct Region {
+        std::uint32_t x = 0;
+        std::uint32_t y = 0;
+        std::uint32_t width = 0;
+        std::uint32_t height = 0;
+    };
+
+    /// Controls how much of an image is decoded and into what layout, so a
+    /// thumbnail of a large photo never materializes the full-resolution pixels.
+    struct DecodeOptions {
+        /// Decode only this part of the image. Clamped to the image bounds; an
+        /// empty intersection fails the decode.
+        Optional<Region> region;
+        /// Smallest acceptable output size in pixels (0 = no constraint on that
+        /// axis). The image (or region) is reduced by the largest factor that
+        /// keeps the result at least this large: JPEG uses libjpeg-turbo DCT
+        /// scaling, and any remaining whole factor is box-filtered. Aspect ratio
+        /// is preserved, so the result may exceed the target on one axis.
+        std::uint32_t targetWidth = 0;
+        std::uint32_t targetHeight = 0;
+        PixelFormat pixelFormat = PixelFormat::Native;
+    };
+
     struct Header {
         std::uint32_t width = 0;
         std::uint32_t height = 0;
@@ -190,10 +227,172 @@ namespace OmegaCommon::Img {
         OMEGA_NODISCARD bool empty() const noexcept { return pixels.empty(); }
     };
 
+    /// Row order of a caller-provided destination buffer.
+    enum class RowOrder : std::uint8_t {
+        BottomUp, /// First row in memory is the bottom of the image (BitmapImage's layout).
+        TopDown   /// First row in memory is the top (typical for GPU staging buffers).
+    };
+
+    /// Rows an IncrementalDecoder has just made valid in its output.
+    struct DecodeProgress {
+        std::uint32_t firstRow = 0;  /// First output row, counted from the top.
+        std::uint32_t rowCount = 0;
+        /// Progressive JPEG scans and Adam7 PNG passes refine the whole image
+        /// repeatedly; each refinement reports increasing pass numbers. 0 for
+        /// sequential images.
+        unsigned pass = 0;
+        bool finalPass = false;       /// These rows hold their final pixels.
+    };
+
+    /// @brief Decodes an image from chunks of encoded data as they arrive.
+    /// @paragraph
+    /// Feed bytes from a network response or an asset stream; rows are decoded
+    /// as soon as the data for them is present and reported through the rows
+    /// callback, so a partially downloaded image can be shown (and uploaded)
+    /// progressively. DecodeOptions apply as for the one-shot loaders.
+    /// @paragraph
+    /// Output goes into a caller-provided buffer (for example a mapped GPU
+    /// staging buffer) when setDestination() is called from the header
+    /// callback, or otherwise into storage the decoder allocates and
+    /// takeImage() returns. PNG and JPEG decode incrementally. TIFF needs random
+    /// access, so it buffers its input and decodes in finish().
+    class OMEGACOMMON_IMG_EXPORT IncrementalDecoder {
+    public:
+        enum class State : std::uint8_t {
+            NeedHeader, /// Not enough data yet to know the dimensions.
+            Decoding,   /// header() is valid; more data is needed to complete.
+            Complete    /// Every row holds its final pixels.
+        };
+
+        using HeaderCallback = std::function<void(const Header &)>;
+        using RowsCallback = std::function<void(const DecodeProgress &)>;
+
+        static std::unique_ptr<IncrementalDecoder> create(Format format, const DecodeOptions & options = {});
+
+        /// Called once, from feed() or finish(), when the output header is
+        /// known and before any rows are written.
+        void setHeaderCallback(HeaderCallback callback) { headerCallback_ = std::move(callback); }
+        void setRowsCallback(RowsCallback callback) { rowsCallback_ = std::move(callback); }
+
+        /// Write output into @p data instead of decoder-owned storage. Valid
+        /// only from the header callback; @p stride must hold a row of
+        /// `header().stride` bytes and @p size all `header().height` rows.
+        Result<void *, std::string> setDestination(Byte * data, std::size_t size, std::size_t stride,
+                                                   RowOrder order = RowOrder::BottomUp);
+
+        /// Decode as far as @p data allows. The bytes are copied as needed;
+        /// the caller may reuse the buffer once this returns.
+        virtual Result<State, std::string> feed(const Byte * data, std::size_t size) = 0;
+        /// Read @p in to its end in chunks, feeding each (e.g. AssetBundle::stream).
+        Result<State, std::string> feed(std::istream & in);
+        /// No more data will arrive. Fails if the image is truncated.
+        virtual Result<State, std::string> finish() = 0;
+
+        State state() const { return state_; }
+        /// Output header (after DecodeOptions); valid once past NeedHeader.
+        const Header & header() const { return header_; }
+        /// The decoded image when no destination was set. Empty otherwise, or
+        /// before the first rows.
+        BitmapImage takeImage();
+
+        virtual ~IncrementalDecoder() = default;
+
+    protected:
+        IncrementalDecoder() = default;
+
+        State state_ = State::NeedHeader;
+        Header header_{};
+        HeaderCallback headerCallback_;
+        RowsCallback rowsCallback_;
+        Byte * destination_ = nullptr;
+        std::size_t destinationStride_ = 0;
+        RowOrder destinationOrder_ = RowOrder::BottomUp;
+        bool inHeaderCallback_ = false;
+        BitmapImage image_;
+    };
+
+    /// Decoded images are stored bottom row first (`header.stride` bytes per row).
+    /// The `options` overloads decode a region, a reduced size or a forced
+    /// pixel layout; `header` describes the output, not the source.
     OMEGACOMMON_IMG_EXPORT Result<BitmapImage, std::string> loadFromFile(FS::Path path);
+    OMEGACOMMON_IMG_EXPORT Result<BitmapImage, std::string> loadFromFile(FS::Path path, const DecodeOptions & options);
     OMEGACOMMON_IMG_EXPORT Result<BitmapImage, std::string> loadFromAssets(AssetBundle & bundle, FS::Path path);
+    OMEGACOMMON_IMG_EXPORT Result<BitmapImage, std::string> loadFromAssets(AssetBundle & bundle, FS::Path path, const DecodeOptions & options);
     OMEGACOMMON_IMG_EXPORT Result<BitmapImage, std::string> loadFromBuffer(Byte * bufferData, std::size_t bufferSize, Format f);
+    OMEGACOMMON_IMG_EXPORT Result<BitmapImage, std::string> loadFromBuffer(Byte * bufferData, std::size_t bufferSize, Format f, const DecodeOptions & options);
     OMEGACOMMON_IMG_EXPORT Result<BitmapImage, std::string> loadFromURL(StrRef url, Format format);
+    OMEGACOMMON_IMG_EXPORT Result<BitmapImage, std::string> loadFromURL(StrRef url, Format format, const DecodeOptions & options);
+
+    /// One image for decodeBatch().
+    struct DecodeRequest {
+        enum class Source : std::uint8_t {
+            File,
+            Asset,
+            Buffer /// Encoded bytes the caller keeps alive until the result is ready.
+        };
+        Source source = Source::File;
+        /// File or asset path.
+        String path;
+        AssetBundle * bundle = nullptr;
+        const Byte * data = nullptr;
+        std::size_t size = 0;
+        /// Required for buffers; files and assets default to their extension.
+        Optional<Format> format;
+        DecodeOptions options;
+
+        static DecodeRequest fromFile(String path, const DecodeOptions & options = {});
+        static DecodeRequest fromAsset(AssetBundle & bundle, String path, const DecodeOptions & options = {});
+        static DecodeRequest fromBuffer(const Byte * data, std::size_t size, Format format, const DecodeOptions & options = {});
+    };
+
+    using DecodeResult = Result<BitmapImage, std::string>;
+
+    /// @brief Decodes every request in parallel on @p scheduler.
+    /// @paragraph
+    /// Returns one Async per request, in request order; each is fulfilled as
+    /// soon as its own image is done, so `onReady` sees results in completion
+    /// order while `get()` waits for that one image. Workers keep their codec
+    /// contexts (turbojpeg handles and row/staging buffers) between images
+    /// instead of recreating them for every decode.
+    OMEGACOMMON_IMG_EXPORT Vector<Async<DecodeResult>> decodeBatch(const Vector<DecodeRequest> & requests,
+                                                                   TaskScheduler & scheduler);
+    /// Same as above, on TaskScheduler::shared().
+    OMEGACOMMON_IMG_EXPORT Vector<Async<DecodeResult>> decodeBatch(const Vector<DecodeRequest> & requests);
+
+    /// @name Pixel conversion
+    /// Row kernels for turning decoded pixels into the layouts textures and
+    /// the compositor consume. They are vectorized with SSE2/AVX2 on x86 and
+    /// NEON on ARM, with a scalar fallback, and produce identical results on
+    /// every path. @p count is in pixels (samples for narrow16To8) and unless
+    /// noted @p src and @p dst may be the same buffer but must not otherwise
+    /// overlap. Alpha is the last channel of every 4-channel layout.
+    /// @{
+
+    /// RGBA <-> BGRA (the operation is its own inverse).
+    OMEGACOMMON_IMG_EXPORT void swizzleRGBAToBGRA(const Byte * src, Byte * dst, std::size_t count);
+    /// RGB to RGBA with opaque alpha. @p src and @p dst must not overlap.
+    OMEGACOMMON_IMG_EXPORT void expandRGBToRGBA(const Byte * src, Byte * dst, std::size_t count);
+    /// Multiply colour by alpha, rounding to nearest.
+    OMEGACOMMON_IMG_EXPORT void premultiplyAlpha(const Byte * src, Byte * dst, std::size_t count);
+    /// Inverse of premultiplyAlpha (rounded, clamped to 255). Pixels with zero
+    /// alpha become transparent black.
+    OMEGACOMMON_IMG_EXPORT void unpremultiplyAlpha(const Byte * src, Byte * dst, std::size_t count);
+    /// 16-bit samples (native byte order) to 8 bits, rounding to nearest.
+    /// @p dst may not overlap @p src.
+    OMEGACOMMON_IMG_EXPORT void narrow16To8(const std::uint16_t * src, Byte * dst, std::size_t count);
+    /// Gray to opaque RGBA. @p src and @p dst must not overlap.
+    OMEGACOMMON_IMG_EXPORT void expandGrayToRGBA(const Byte * src, Byte * dst, std::size_t count);
+    /// Gray + alpha to RGBA. @p src and @p dst must not overlap.
+    OMEGACOMMON_IMG_EXPORT void expandGrayAlphaToRGBA(const Byte * src, Byte * dst, std::size_t count);
+    /// sRGB-encoded RGBA to linear float RGBA in [0, 1]; alpha is only rescaled.
+    OMEGACOMMON_IMG_EXPORT void srgbToLinear(const Byte * src, float * dst, std::size_t count);
+
+    /// Copy of @p image in another 8-bit layout: @p format is RGB, RGBA or
+    /// BGRA, and @p alpha Straight or Premultipled (ignored for RGB). Row
+    /// order is kept.
+    OMEGACOMMON_IMG_EXPORT Result<BitmapImage, std::string> convertImage(const BitmapImage & image, ColorFormat format,
+                                                                         AlphaFormat alpha);
+    /// @}
 
 }
 
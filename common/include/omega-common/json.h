@@ -1,7 +1,9 @@
 #include "utils.h"
 #include <cstddef>
+#include <cstdint>
 #include <initializer_list>
 #include <istream>
+#include <memory>
 #include <sstream>
 #include <type_traits>
 
@@ -62,6 +64,7 @@ namespace OmegaCommon {
         friend class JSONSerializer;
         friend class JSONReader;
         friend class RapidJSONBridge;
+        friend class JSONValue;
     public:
         typedef std::remove_pointer_t<decltype(data.map)>::iterator map_iterator;
 
@@ -255,9 +258,330 @@ namespace OmegaCommon {
     typedef Map<String,JSON> JSONMap;
     typedef Vector<JSON> JSONArray;
 
+    class JSONDocument;
+
+    /**
+     @brief A read-only handle to one node of a JSONDocument.
+     @paragraph
+     Mirrors the query half of the JSON API (type tests, as* accessors, find/at/contains/size),
+     so code that only reads a tree can take either form. A handle is two words and copies freely;
+     it stays valid for as long as the JSONDocument it came from, and strings are views into that
+     document's buffer rather than copies.
+    */
+    class OMEGACOMMON_EXPORT JSONValue {
+        const JSONDocument *doc = nullptr;
+        std::uint32_t index = 0;
+        friend class JSONDocument;
+        JSONValue(const JSONDocument *doc,std::uint32_t index);
+    public:
+        /// An invalid handle; only valid() may be called on it.
+        JSONValue() = default;
+
+        OMEGA_NODISCARD bool valid() const;
+
+        OMEGA_NODISCARD bool isString() const;
+
+        OMEGA_NODISCARD bool isArray() const;
+
+        OMEGA_NODISCARD bool isNumber() const;
+
+        OMEGA_NODISCARD bool isInt() const;
+
+        OMEGA_NODISCARD bool isReal() const;
+
+        OMEGA_NODISCARD bool isMap() const;
+
+        OMEGA_NODISCARD bool isNull() const;
+
+        OMEGA_NODISCARD bool isBool() const;
+
+        /// View of this String node's bytes inside the document buffer.
+        OMEGA_NODISCARD StrRef asString() const;
+
+        OMEGA_NODISCARD long long asInt() const;
+
+        OMEGA_NODISCARD double asDouble() const;
+
+        OMEGA_NODISCARD float asFloat() const;
+
+        OMEGA_NODISCARD bool asBool() const;
+
+        /// Number of members (Map) or elements (Array).
+        OMEGA_NODISCARD size_t size() const;
+
+        OMEGA_NODISCARD bool empty() const;
+
+        /// Element @p idx of an Array node.
+        JSONValue operator[](size_t idx) const;
+
+        /// Map member lookup. Asserts the key is present.
+        JSONValue operator[](StrRef key) const;
+
+        /// Key of member @p idx of a Map node, in document order.
+        OMEGA_NODISCARD StrRef keyAt(size_t idx) const;
+
+        /// Value of member @p idx of a Map node, in document order.
+        OMEGA_NODISCARD JSONValue valueAt(size_t idx) const;
+
+        /// True when this Map node holds `key`.
+        OMEGA_NODISCARD bool contains(StrRef key) const;
+
+        /// Find a Map member by key (first match in document order), or an
+        /// invalid handle when absent.
+        OMEGA_NODISCARD JSONValue find(StrRef key) const;
+
+        /// Access a Map member by key. Asserts the key is present.
+        OMEGA_NODISCARD JSONValue at(StrRef key) const;
+
+        /// Deep-copy this subtree into an owning JSON tree.
+        OMEGA_NODISCARD JSON toJSON() const;
+    };
+
+    /**
+     @brief An immutable JSON tree parsed in place into a flat node array.
+     @paragraph
+     JSON::TryParse allocates every String, Array and Map node separately, which dominates
+     parse time on large manifests. A JSONDocument instead takes ownership of the source
+     buffer, lets the parser unescape strings inside it, and stores every node in one
+     contiguous array with each container's children laid out next to each other.
+     Reading it costs no allocation per node; use JSONValue::toJSON() on the subtrees that
+     need to become mutable.
+    */
+    class OMEGACOMMON_EXPORT JSONDocument {
+        friend class JSONValue;
+        friend class JSONDocumentBuilder;
+    public:
+        /// One node of the tree (16 bytes).
+        struct Node {
+            enum Kind : std::uint8_t {
+                String,
+                Array,
+                Map,
+                Number,
+                Boolean,
+                Null
+            };
+            Kind kind = Null;
+            bool real = false;
+            /// String: byte length. Array: element count. Map: member count.
+            std::uint32_t length = 0;
+            union {
+                long long i = 0;
+                double d;
+                bool b;
+                /// String: byte offset into the buffer. Array/Map: index of the
+                /// first child node (Map children alternate key, value).
+                std::uint32_t first;
+            };
+        };
+    private:
+        OmegaCommon::String buffer;
+        Vector<Node> nodes;
+        std::uint32_t rootIndex = 0;
+    public:
+        JSONDocument() = default;
+
+        /// Parse `source` in place. Pass an rvalue to hand the buffer over
+        /// without copying it. Returns the RapidJSON error and byte offset on
+        /// malformed input.
+        static Result<JSONDocument,OmegaCommon::String> parse(OmegaCommon::String source);
+
+        /// Read the whole stream into a buffer, then parse it in place.
+        static Result<JSONDocument,OmegaCommon::String> parse(std::istream & in);
+
+        /// The root value (invalid for a default-constructed document).
+        OMEGA_NODISCARD JSONValue root() const;
+
+        /// Total number of nodes, keys included.
+        OMEGA_NODISCARD size_t nodeCount() const;
+    };
+
+    /**
+     @brief Receives JSON parse events from JSONReader::parse.
+     @paragraph
+     Every callback returns true to continue; returning false stops the parse, which
+     then reports an error. Strings and keys are only valid for the duration of the call.
+    */
+    class OMEGACOMMON_EXPORT JSONEventHandler {
+    public:
+        virtual bool onNull() = 0;
+        virtual bool onBool(bool b) = 0;
+        virtual bool onInt(long long v) = 0;
+        virtual bool onReal(double v) = 0;
+        virtual bool onString(StrRef str) = 0;
+        virtual bool onKey(StrRef key) = 0;
+        virtual bool onStartObject() = 0;
+        virtual bool onEndObject(size_t memberCount) = 0;
+        virtual bool onStartArray() = 0;
+        virtual bool onEndArray(size_t elementCount) = 0;
+        virtual ~JSONEventHandler() = default;
+    };
+
+    /**
+     @brief A pull parser that walks JSON text one event at a time without building a tree.
+     @paragraph
+     Each call to next() consumes exactly one token. Memory use is bounded by the nesting
+     depth and the longest string, so arbitrarily large scene or animation files can be
+     read in constant space. Typical use:
+     @code
+     reader.next();                                  // StartObject
+     while(reader.next() == JSONReader::Key){
+         if(reader.string() == "frames"){ reader.next(); ...; }
+         else { reader.next(); reader.skipValue(); }
+     }
+     @endcode
+    */
+    class OMEGACOMMON_EXPORT JSONReader {
+    public:
+        enum Event : int {
+            None,
+            StartObject,
+            EndObject,
+            StartArray,
+            EndArray,
+            Key,
+            String,
+            Int,
+            Real,
+            Bool,
+            Null,
+            /// The document has been fully consumed.
+            End,
+            /// Malformed input; see error().
+            Error
+        };
+    private:
+        struct Impl;
+        std::unique_ptr<Impl> impl;
+    public:
+        /// Read from `source`, which must outlive the reader.
+        explicit JSONReader(StrRef source);
+
+        /// Read from `in`, which must outlive the reader.
+        explicit JSONReader(std::istream & in);
+
+        JSONReader(JSONReader && other) noexcept;
+        JSONReader & operator=(JSONReader && other) noexcept;
+        ~JSONReader();
+
+        /// Advance to the next event and return it. Sticks at End or Error.
+        Event next();
+
+        /// The event most recently returned by next() (None before the first call).
+        OMEGA_NODISCARD Event current() const;
+
+        /// Number of containers open around the current event.
+        OMEGA_NODISCARD size_t depth() const;
+
+        /// Text of the current Key or String event. Valid until the next call to next().
+        OMEGA_NODISCARD StrRef string() const;
+
+        /// Value of the current Int event (a Real is truncated).
+        OMEGA_NODISCARD long long asInt() const;
+
+        /// Value of the current Real event (an Int is widened).
+        OMEGA_NODISCARD double asDouble() const;
+
+        /// Value of the current Bool event.
+        OMEGA_NODISCARD bool asBool() const;
+
+        /// Member or element count of the current EndObject/EndArray event.
+        OMEGA_NODISCARD size_t count() const;
+
+        /// RapidJSON description and byte offset once next() has returned Error.
+        OMEGA_NODISCARD const OmegaCommon::String & error() const;
+
+        /// Materialize the value that starts at the current event into a JSON
+        /// tree, leaving the reader on that value's last event.
+        Result<JSON,OmegaCommon::String> readValue();
+
+        /// Skip the value that starts at the current event, leaving the reader
+        /// on that value's last event. False on malformed input.
+        bool skipValue();
+
+        /// Deserialize the value at the current event into `v` via
+        /// `v.fromJSONReader(*this)` (see JSONConvertible). Errors with the
+        /// reader's message on malformed input.
+        template<class T>
+        Result<void *,OmegaCommon::String> into(T & v) {
+            return v.fromJSONReader(*this);
+        }
+
+        /// @name Push parsing
+        /// Feed every event of a document to `handler` in one pass.
+        /// @{
+        static Result<void *,OmegaCommon::String> parse(StrRef source,JSONEventHandler & handler);
+
+        static Result<void *,OmegaCommon::String> parse(std::istream & in,JSONEventHandler & handler);
+        /// @}
+    };
+
+    /**
+     @brief Writes JSON text to a stream as it is produced.
+     @paragraph
+     Output goes through a fixed 4 KiB buffer, so memory stays bounded regardless of document
+     size; only the open-container stack grows with nesting. Calls must form a well-formed
+     document (a key before every object member, balanced start/end); misuse asserts.
+    */
+    class OMEGACOMMON_EXPORT JSONWriter {
+        struct Impl;
+        std::unique_ptr<Impl> impl;
+    public:
+        /// Write to `out`, which must outlive the writer. `pretty` indents and
+        /// adds newlines, as in JSON::serialize.
+        explicit JSONWriter(std::ostream & out,bool pretty = false);
+
+        JSONWriter(JSONWriter && other) noexcept;
+        JSONWriter & operator=(JSONWriter && other) noexcept;
+
+        /// Flushes any buffered output.
+        ~JSONWriter();
+
+        void startObject();
+
+        void endObject();
+
+        void startArray();
+
+        void endArray();
+
+        void key(StrRef name);
+
+        void value(StrRef str);
+
+        void value(const char *str);
+
+        void value(const OmegaCommon::String & str);
+
+        void value(long long v);
+
+        void value(int v);
+
+        void value(double v);
+
+        void value(bool b);
+
+        void value(std::nullptr_t);
+
+        /// Write a whole JSON tree as the next value.
+        void value(const JSON & json);
+
+        /// True once a complete top-level value has been written.
+        OMEGA_NODISCARD bool complete() const;
+
+        /// Push buffered output to the stream and flush it.
+        void flush();
+    };
+
     struct OMEGACOMMON_EXPORT JSONConvertible {
         virtual void toJSON(JSON & j) = 0;
         virtual void fromJSON(JSON & j) = 0;
+        /// Deserialize from the value at `reader`'s current event. The default
+        /// materializes that value and calls fromJSON(); override it to read
+        /// the events directly. Must leave the reader on the value's last event,
+        /// and return an error (the reader's, if it failed) on malformed input.
+        virtual Result<void *,String> fromJSONReader(JSONReader & reader);
+        virtual ~JSONConvertible() = default;
     };
 
     #define IJSONConvertible public ::OmegaCommon::JSONConvertible
@@ -4,6 +4,7 @@
 #define OMEGA_COMMON_MULTITHREAD_H
 
 #include "utils.h"
+#include <cstdint>
 #include <condition_variable>
 #include <mutex>
 #include <thread>
@@ -11,6 +12,10 @@
 #include <vector>
 #include <utility>
 #include <memory>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <type_traits>
 
 #include <cassert>
 
@@ -18,97 +23,253 @@ namespace OmegaCommon {
     using Thread = std::thread;
     using Mutex = std::mutex;
 
+    class TaskScheduler;
+
+    template<class T>
+    class Promise;
+
+    namespace detail {
+
+        /// @brief Blocks the calling thread while @p word still holds @p expected.
+        /// @paragraph
+        /// Futex-style: may return spuriously, so callers re-check their condition in a loop.
+        /// Maps to futex on Linux/Android, WaitOnAddress on Windows and a hashed parking lot elsewhere.
+        OMEGACOMMON_EXPORT void atomicWait(const std::atomic<std::uint32_t> & word,std::uint32_t expected);
+
+        /// @brief Wakes every thread blocked in atomicWait on @p word.
+        OMEGACOMMON_EXPORT void atomicWakeAll(const std::atomic<std::uint32_t> & word);
+
+        struct ContinuationNode {
+            std::function<void()> run;
+            ContinuationNode *next = nullptr;
+        };
+
+        /// @brief The single allocation behind a Promise and all of its Asyncs.
+        /// @paragraph
+        /// Readiness is one atomic word, so a ready value is observed without taking a lock.
+        /// Continuations are pushed onto a lock-free stack that set() closes and then drains
+        /// in registration order.
+        template<class T>
+        struct AsyncState {
+            enum : std::uint32_t { Pending = 0, Setting = 1, Ready = 2 };
+
+            std::atomic<std::uint32_t> status {Pending};
+            std::atomic<std::uint32_t> waiters {0};
+            std::atomic<ContinuationNode *> continuations {nullptr};
+            Optional<T> value;
+
+            static ContinuationNode *closed(){
+                return reinterpret_cast<ContinuationNode *>(std::uintptr_t(1));
+            }
+
+            bool ready() const {
+                return status.load(std::memory_order_acquire) == Ready;
+            }
+
+            void wait(){
+                if(ready()){
+                    return;
+                }
+                waiters.fetch_add(1);
+                std::uint32_t current;
+                while((current = status.load()) != Ready){
+                    atomicWait(status,current);
+                }
+                waiters.fetch_sub(1);
+            }
+
+            template<class U>
+            bool set(U && v){
+                std::uint32_t expected = Pending;
+                if(!status.compare_exchange_strong(expected,Setting,std::memory_order_acquire)){
+                    return false;
+                }
+                value.emplace(std::forward<U>(v));
+                status.store(Ready);
+                if(waiters.load() > 0){
+                    atomicWakeAll(status);
+                }
+                runContinuations(continuations.exchange(closed(),std::memory_order_acq_rel));
+                return true;
+            }
+
+            void onReady(std::function<void()> continuation){
+                auto *node = new ContinuationNode{std::move(continuation),nullptr};
+                ContinuationNode *head = continuations.load(std::memory_order_acquire);
+                while(head != closed()){
+                    node->next = head;
+                    if(continuations.compare_exchange_weak(head,node,std::memory_order_release,std::memory_order_acquire)){
+                        return;
+                    }
+                }
+                node->run();
+                delete node;
+            }
+
+            static void runContinuations(ContinuationNode *head){
+                // The stack holds the newest registration first; reverse it so
+                // continuations fire in the order they were attached.
+                ContinuationNode *ordered = nullptr;
+                while(head != nullptr){
+                    ContinuationNode *next = head->next;
+                    head->next = ordered;
+                    ordered = head;
+                    head = next;
+                }
+                while(ordered != nullptr){
+                    ContinuationNode *next = ordered->next;
+                    ordered->run();
+                    delete ordered;
+                    ordered = next;
+                }
+            }
+
+            ~AsyncState(){
+                ContinuationNode *head = continuations.load(std::memory_order_acquire);
+                if(head == closed()){
+                    return;
+                }
+                while(head != nullptr){
+                    ContinuationNode *next = head->next;
+                    delete head;
+                    head = next;
+                }
+            }
+        };
+
+    }
+
+    /**
+     * @brief The consumer side of a Promise.
+     * @paragraph
+     * Copies share one state. ready() and get() on a fulfilled value are a single atomic load;
+     * get() on a pending value blocks with a futex-style wait rather than a mutex/condition pair.
+     */
     template<class T>
     class Async {
-        std::shared_ptr<bool> hasValue;
-        std::shared_ptr<Mutex> mutex;
-        std::shared_ptr<std::condition_variable> condition;
-        std::shared_ptr<T> _val;
+        std::shared_ptr<detail::AsyncState<T>> state;
 
         template<class Ty>
         friend class Promise;
 
-    public:
-        explicit Async(std::shared_ptr<bool> hasValue,
-                       std::shared_ptr<Mutex> mutex,
-                       std::shared_ptr<std::condition_variable> condition,
-                       std::shared_ptr<T> _val):
-        hasValue(hasValue),
-        mutex(mutex),
-        condition(condition),
-        _val(_val){
+        explicit Async(std::shared_ptr<detail::AsyncState<T>> state):state(std::move(state)){
 
         }
-        bool ready(){
-            std::lock_guard<Mutex> lk(*mutex);
-            return *hasValue;
+
+    public:
+        bool ready() const {
+            return state->ready();
         }
         T & get(){
-            std::unique_lock<Mutex> lk(*mutex);
-            condition->wait(lk,[this](){
-                return *hasValue;
+            state->wait();
+            return *state->value;
+        }
+
+        /// @brief Runs @p continuation with the value once it is set, or immediately if it already is.
+        /// @paragraph
+        /// The continuation runs inline on the thread that fulfills the Promise, so it should
+        /// be short; use then() to move real work onto a TaskScheduler.
+        /// It does not keep this Async alive, so it never forms a reference cycle with the state.
+        void onReady(std::function<void(T &)> continuation){
+            detail::AsyncState<T> *s = state.get();
+            state->onReady([s,continuation = std::move(continuation)](){
+                continuation(*s->value);
             });
-            return *_val;
         }
+
+        /// @brief Chains @p func onto this value without blocking a thread.
+        /// @paragraph
+        /// Once the value is set, @p func is invoked with a copy of it as a task on @p scheduler.
+        /// The returned Async is fulfilled with the result of @p func.
+        template<class FnT>
+        auto then(TaskScheduler & scheduler,FnT && func) -> Async<std::invoke_result_t<FnT,T &>>;
+
+        /// @brief Chains @p func onto this value using the shared TaskScheduler.
+        template<class FnT>
+        auto then(FnT && func) -> Async<std::invoke_result_t<FnT,T &>>;
+
         ~Async() = default;
     };
 
     template<class T>
     class Promise {
-
-        std::shared_ptr<Mutex>  mutex;
-        std::shared_ptr<bool> hasValue;
-        std::shared_ptr<std::condition_variable> condition;
-        std::shared_ptr<T> val;
+        std::shared_ptr<detail::AsyncState<T>> state;
     public:
-        Promise():mutex(std::make_shared<Mutex>()),
-                  hasValue(std::make_shared<bool>(false)),
-                  condition(std::make_shared<std::condition_variable>()),
-                  val(std::make_shared<T>()){
+        Promise():state(std::make_shared<detail::AsyncState<T>>()){
 
         };
         Promise(const Promise &) = delete;
         Promise(Promise && prom):
-                mutex(prom.mutex),
-                hasValue(prom.hasValue),
-                condition(prom.condition),
-                val(prom.val){
+                state(prom.state){
             
         }
         Async<T> async(){
-            return Async<T>{hasValue,mutex,condition,val};
+            return Async<T>{state};
         };
+        /// Fulfills the promise. Only the first call has any effect.
         void set(const T & v){
-           bool wake = false;
-           {
-               std::lock_guard<Mutex> lk(*mutex);
-               if(!(*hasValue)){
-                *val = v;
-                *hasValue = true;
-                wake = true;
-               }
-           }
-           if(wake){
-               condition->notify_all();
-           }
+            state->set(v);
         }
         void set(T && v){
-            bool wake = false;
-            {
-                std::lock_guard<Mutex> lk(*mutex);
-                if(!(*hasValue)){
-                    *val = std::move(v);
-                    *hasValue = true;
-                    wake = true;
-                }
-            }
-            if(wake){
-                condition->notify_all();
-            }
+            state->set(std::move(v));
         }
         ~Promise() = default;
     };
 
+    /**
+     * @brief Returns an Async fulfilled with every input's value, in input order, once all are ready.
+     * @paragraph
+     * Completion is driven by the inputs' continuations; no thread blocks while waiting.
+     */
+    template<class T>
+    Async<Vector<T>> whenAll(Vector<Async<T>> inputs){
+        struct Join {
+            Promise<Vector<T>> promise;
+            Vector<Optional<T>> values;
+            std::atomic<size_t> remaining;
+            explicit Join(size_t count):values(count),remaining(count){}
+        };
+        auto join = std::make_shared<Join>(inputs.size());
+        auto result = join->promise.async();
+        if(inputs.empty()){
+            join->promise.set(Vector<T>{});
+            return result;
+        }
+        for(size_t idx = 0;idx < inputs.size();idx++){
+            inputs[idx].onReady([join,idx](T & value){
+                join->values[idx].emplace(value);
+                if(join->remaining.fetch_sub(1,std::memory_order_acq_rel) != 1){
+                    return;
+                }
+                Vector<T> values;
+                values.reserve(join->values.size());
+                for(auto & v : join->values){
+                    values.push_back(std::move(*v));
+                }
+                join->promise.set(std::move(values));
+            });
+        }
+        return result;
+    }
+
+    /**
+     * @brief Returns an Async fulfilled with the index and value of the first input to become ready.
+     * @paragraph
+     * @p inputs must not be empty.
+     */
+    template<class T>
+    Async<std::pair<size_t,T>> whenAny(Vector<Async<T>> inputs){
+        assert(!inputs.empty() && "whenAny requires at least one input");
+        auto promise = std::make_shared<Promise<std::pair<size_t,T>>>();
+        auto result = promise->async();
+        for(size_t idx = 0;idx < inputs.size();idx++){
+            inputs[idx].onReady([promise,idx](T & value){
+                promise->set(std::make_pair(idx,value));
+            });
+        }
+        return result;
+    }
+
     class OMEGACOMMON_EXPORT Semaphore {
         struct Impl;
         std::unique_ptr<Impl> impl;
@@ -168,14 +329,231 @@ namespace OmegaCommon {
         ~ChildProcess();
     };
     /**
-     * @brief Assignable thread farm designed for completing multithreaded tasks.
-     * 
+     * @brief Fixed-size, per-core work-stealing task scheduler.
+     * @paragraph
+     * Each worker thread owns a task deque. A worker pops its own most recently pushed task first
+     * (keeping nested work cache-hot) and, when its deque runs dry, takes work submitted from outside
+     * the pool before stealing the oldest task from another worker. Tasks submitted from a worker land
+     * on that worker's deque; tasks submitted from any other thread land on a shared injection queue.
+     *
+     * Tasks must not throw. A thread that waits on scheduled work (TaskGroup::wait, parallelFor) helps
+     * execute pending tasks instead of idling, so nested parallelism cannot starve the pool.
      */
-    class OMEGACOMMON_EXPORT WorkerFarm {
-        std::vector<Thread> farm;
+    class OMEGACOMMON_EXPORT TaskScheduler {
+        struct Impl;
+        std::unique_ptr<Impl> impl;
+    public:
+        using Task = std::function<void()>;
+
+        /// @param workerCount Number of worker threads. Zero selects one per hardware thread.
+        explicit TaskScheduler(unsigned workerCount = 0);
+        TaskScheduler(const TaskScheduler &) = delete;
+        TaskScheduler & operator=(const TaskScheduler &) = delete;
+        TaskScheduler(TaskScheduler &&) = delete;
+        TaskScheduler & operator=(TaskScheduler &&) = delete;
+
+        /// @brief The process-wide scheduler, created on first use with one worker per hardware thread.
+        static TaskScheduler & shared();
+
+        OMEGA_NODISCARD unsigned workerCount() const;
+
+        /// @brief Returns true when called from one of this scheduler's worker threads.
+        OMEGA_NODISCARD bool isWorkerThread() const;
+
+        /// @brief Queues @p task for execution on a worker thread.
+        void submit(Task task);
+
+        /// @brief Runs one pending task on the calling thread.
+        /// @returns true if a task was run, false if no work was available.
+        bool runPendingTask();
+
+        /// @brief Runs @p func on a worker thread and returns an Async fulfilled with its result.
+        template<class FnT>
+        auto async(FnT && func) -> Async<std::invoke_result_t<FnT>>;
+
+        /// Drains every queued task, then joins the workers.
+        ~TaskScheduler();
+    };
+
+    /**
+     * @brief A set of tasks that can be waited on together.
+     * @paragraph
+     * The destructor waits for every task started through run().
+     */
+    class OMEGACOMMON_EXPORT TaskGroup {
+        TaskScheduler & scheduler;
+        std::atomic<size_t> pending;
         std::mutex mutex;
+        std::condition_variable condition;
+
+        void finishTask();
+    public:
+        explicit TaskGroup(TaskScheduler & scheduler = TaskScheduler::shared());
+        TaskGroup(const TaskGroup &) = delete;
+        TaskGroup & operator=(const TaskGroup &) = delete;
+        TaskGroup(TaskGroup &&) = delete;
+        TaskGroup & operator=(TaskGroup &&) = delete;
+
+        template<class FnT>
+        void run(FnT && func){
+            pending.fetch_add(1,std::memory_order_relaxed);
+            scheduler.submit([this,task = std::forward<FnT>(func)]() mutable {
+                task();
+                finishTask();
+            });
+        }
+
+        /// @brief Blocks until every task in the group has finished, running pending tasks meanwhile.
+        void wait();
+
+        ~TaskGroup();
+    };
+
+    /**
+     * @brief Invokes @p func(i) for every i in [begin,end), splitting the range into chunks of at
+     * least @p grain indices that run in parallel on @p scheduler.
+     * @paragraph
+     * The calling thread executes one chunk itself and returns once every index has been visited.
+     * Ranges no larger than @p grain (or a single-worker scheduler) run inline.
+     */
+    template<class IndexT,class FnT>
+    void parallelFor(IndexT begin,IndexT end,IndexT grain,FnT && func,
+                     TaskScheduler & scheduler = TaskScheduler::shared()){
+        static_assert(std::is_integral_v<IndexT>,"parallelFor requires an integral index type");
+        if(end <= begin){
+            return;
+        }
+        if(grain < 1){
+            grain = 1;
+        }
+        const IndexT count = end - begin;
+        if(count <= grain || scheduler.workerCount() < 2){
+            for(IndexT i = begin;i < end;++i){
+                func(i);
+            }
+            return;
+        }
+        // Oversubscribe the workers a little so stealing can even out uneven chunks.
+        const IndexT maxChunks = static_cast<IndexT>(scheduler.workerCount() * 4);
+        IndexT chunks = static_cast<IndexT>((count + grain - 1) / grain);
+        if(chunks > maxChunks){
+            chunks = maxChunks;
+        }
+        const IndexT chunkSize = static_cast<IndexT>((count + chunks - 1) / chunks);
+
+        TaskGroup group(scheduler);
+        IndexT chunkBegin = begin;
+        while(end - chunkBegin > chunkSize){
+            const IndexT chunkEnd = static_cast<IndexT>(chunkBegin + chunkSize);
+            group.run([&func,chunkBegin,chunkEnd](){
+                for(IndexT i = chunkBegin;i < chunkEnd;++i){
+                    func(i);
+                }
+            });
+            chunkBegin = chunkEnd;
+        }
+        for(IndexT i = chunkBegin;i < end;++i){
+            func(i);
+        }
+        group.wait();
+    }
+
+    /**
+     * @brief Parallel reduction over [begin,end).
+     * @paragraph
+     * @p rangeFunc(chunkBegin,chunkEnd,identity) reduces one chunk to a partial result; partials are
+     * then folded left-to-right with @p combine in index order, so the result is deterministic for a
+     * given @p grain and worker count even when @p combine is not associative in floating point.
+     */
+    template<class IndexT,class T,class RangeFnT,class CombineFnT>
+    T parallelReduce(IndexT begin,IndexT end,IndexT grain,T identity,RangeFnT && rangeFunc,CombineFnT && combine,
+                     TaskScheduler & scheduler = TaskScheduler::shared()){
+        static_assert(std::is_integral_v<IndexT>,"parallelReduce requires an integral index type");
+        if(end <= begin){
+            return identity;
+        }
+        if(grain < 1){
+            grain = 1;
+        }
+        const IndexT count = end - begin;
+        if(count <= grain || scheduler.workerCount() < 2){
+            return rangeFunc(begin,end,identity);
+        }
+        const IndexT maxChunks = static_cast<IndexT>(scheduler.workerCount() * 4);
+        IndexT chunks = static_cast<IndexT>((count + grain - 1) / grain);
+        if(chunks > maxChunks){
+            chunks = maxChunks;
+        }
+        const IndexT chunkSize = static_cast<IndexT>((count + chunks - 1) / chunks);
+
+        std::vector<Optional<T>> partials(static_cast<size_t>(chunks));
+        {
+            TaskGroup group(scheduler);
+            size_t slot = 0;
+            for(IndexT chunkBegin = begin;chunkBegin < end;chunkBegin = static_cast<IndexT>(chunkBegin + chunkSize),++slot){
+                const IndexT chunkEnd = (end - chunkBegin > chunkSize) ? static_cast<IndexT>(chunkBegin + chunkSize) : end;
+                group.run([&rangeFunc,&partials,&identity,slot,chunkBegin,chunkEnd](){
+                    partials[slot].emplace(rangeFunc(chunkBegin,chunkEnd,identity));
+                });
+            }
+            group.wait();
+        }
+
+        T result = identity;
+        for(auto & partial : partials){
+            if(partial.has_value()){
+                result = combine(std::move(result),std::move(*partial));
+            }
+        }
+        return result;
+    }
+
+    template<class FnT>
+    auto TaskScheduler::async(FnT && func) -> Async<std::invoke_result_t<FnT>> {
+        using R = std::invoke_result_t<FnT>;
+        auto promise = std::make_shared<Promise<R>>();
+        auto result = promise->async();
+        submit([promise,task = std::forward<FnT>(func)]() mutable {
+            promise->set(task());
+        });
+        return result;
+    }
+
+    template<class T>
+    template<class FnT>
+    auto Async<T>::then(TaskScheduler & scheduler,FnT && func) -> Async<std::invoke_result_t<FnT,T &>> {
+        using R = std::invoke_result_t<FnT,T &>;
+        auto promise = std::make_shared<Promise<R>>();
+        auto result = promise->async();
+        auto task = std::make_shared<std::decay_t<FnT>>(std::forward<FnT>(func));
+        // Capturing this Async here would let the state own itself through its own
+        // continuation, so the task gets a copy of the value instead.
+        onReady([&scheduler,promise,task](T & value){
+            scheduler.submit([promise,task,value]() mutable {
+                promise->set((*task)(value));
+            });
+        });
+        return result;
+    }
+
+    template<class T>
+    template<class FnT>
+    auto Async<T>::then(FnT && func) -> Async<std::invoke_result_t<FnT,T &>> {
+        return then(TaskScheduler::shared(),std::forward<FnT>(func));
+    }
+
+    /**
+     * @brief Assignable job farm designed for completing multithreaded tasks.
+     * @paragraph
+     * Jobs run on the shared TaskScheduler rather than on a dedicated thread each, so scheduling is
+     * cheap and the number of OS threads stays bounded. Jobs must not block waiting on one another.
+     * The destructor waits for every scheduled job to finish.
+     */
+    class OMEGACOMMON_EXPORT WorkerFarm {
+        TaskGroup group;
     public:
         WorkerFarm() = default;
+        explicit WorkerFarm(TaskScheduler & scheduler):group(scheduler){}
         WorkerFarm(const WorkerFarm &) = delete;
         WorkerFarm & operator=(const WorkerFarm &) = delete;
         WorkerFarm(WorkerFarm &&) = delete;
@@ -183,22 +561,17 @@ namespace OmegaCommon {
 
         template<class FnT,typename ...Args>
         void scheduleJob(FnT && func,Args && ...args){
-            std::lock_guard<std::mutex> guard(mutex);
-            farm.emplace_back(std::forward<FnT>(func),std::forward<Args>(args)...);
+            group.run([job = std::bind(std::forward<FnT>(func),std::forward<Args>(args)...)]() mutable {
+                job();
+            });
         }
 
-        ~WorkerFarm(){
-            std::vector<Thread> pending;
-            {
-                std::lock_guard<std::mutex> guard(mutex);
-                pending.swap(farm);
-            }
-            for(auto &thread : pending){
-                if(thread.joinable()){
-                    thread.join();
-                }
-            }
+        /// @brief Blocks until every job scheduled so far has finished.
+        void wait(){
+            group.wait();
         }
+
+        ~WorkerFarm() = default;
     };
 
 };
@@ -1,7 +1,10 @@
 #include "utils.h"
+#include "multithread.h"
 
+#include <cctype>
 #include <cstdint>
 #include <future>
+#include <istream>
 
 #ifndef OMEGA_COMMON_NET_H
 #define OMEGA_COMMON_NET_H
@@ -18,11 +21,29 @@ namespace OmegaCommon {
         Options
     };
 
+    /// Byte range of a resource (RFC 9110 `Range: bytes=`). Used to resume an
+    /// interrupted download or to fetch one resource as parallel pieces.
+    struct HttpByteRange {
+        std::uint64_t offset = 0;
+        std::uint64_t length = 0; /// 0 = through the end of the resource.
+
+        /// The range in `first-last` form, without the `bytes=` unit.
+        String spec() const {
+            String out = std::to_string(offset) + "-";
+            if (length > 0)
+                out += std::to_string(offset + length - 1);
+            return out;
+        }
+    };
+
     struct HttpRequestDescriptor {
         StrRef url;
         HttpMethod method = HttpMethod::Get;
         String body;
         Vector<std::pair<String, String>> headers;
+        /// Request only part of the resource. Servers that honor it answer 206
+        /// with a Content-Range header; others answer 200 with the whole body.
+        Optional<HttpByteRange> range;
     };
 
     struct HttpResponse {
@@ -38,6 +59,55 @@ namespace OmegaCommon {
         bool ok() const {
             return statusCode >= 200 && statusCode < 300;
         }
+
+        /// The first header named @p name (case-insensitive), if any.
+        const String *header(StrRef name) const {
+            for (const auto &h : headers) {
+                if (h.first.size() != name.size())
+                    continue;
+                size_t i = 0;
+                while (i < name.size() &&
+                       std::tolower((unsigned char)h.first[i]) == std::tolower((unsigned char)name.data()[i]))
+                    ++i;
+                if (i == name.size())
+                    return &h.second;
+            }
+            return nullptr;
+        }
+    };
+
+    /// What an HttpBodySink wants after taking a chunk.
+    enum class HttpSinkStatus {
+        Continue, /// Keep delivering.
+        Pause,    /// Stop delivering until HttpStream::resume(). Nothing is lost.
+        Abort     /// Cancel the transfer.
+    };
+
+    /// Receives a response body as it arrives instead of buffering it whole.
+    /// Callbacks run on the client's transfer thread, one at a time and in
+    /// order; keep them short and never block waiting for the reader.
+    class OMEGACOMMON_EXPORT HttpBodySink {
+    public:
+        /// Status and headers, delivered once before the first chunk.
+        virtual void onResponse(int /*statusCode*/, const Vector<std::pair<String, String>> & /*headers*/) {}
+        /// One chunk of the body. The pointer is only valid during the call.
+        virtual HttpSinkStatus onData(const std::uint8_t *data, size_t size) = 0;
+        /// The transfer ended. The response carries status and headers but no
+        /// body; statusCode is 0 if the transfer failed or was cancelled.
+        virtual void onComplete(const HttpResponse & /*response*/) {}
+        virtual ~HttpBodySink() = default;
+    };
+
+    /// Handle on a streaming request started by HttpClientContext::makeStreamingRequest.
+    class OMEGACOMMON_EXPORT HttpStream {
+    public:
+        /// Continue delivery after the sink returned HttpSinkStatus::Pause. Any thread.
+        virtual void resume() = 0;
+        /// Stop the transfer. The sink still receives onComplete. Any thread.
+        virtual void cancel() = 0;
+        /// Resolves with the final status and headers (no body).
+        virtual Async<HttpResponse> completion() = 0;
+        virtual ~HttpStream() = default;
     };
 
     /// TLS configuration for HTTP clients. PEM strings allow any key type.
@@ -48,11 +118,48 @@ namespace OmegaCommon {
         bool verifyPeer = true; /// Verify the server's certificate chain and hostname.
     };
 
-    class OMEGACOMMON_EXPORT HttpClientContext {
+    /// Connection-level tuning for HTTP clients. Backends apply what their
+    /// transport supports and ignore the rest.
+    struct HttpClientOptions {
+        /// Transfers in flight at once. Further requests wait, in submission
+        /// order, for a running transfer to finish.
+        unsigned maxConcurrentRequests = 16;
+        /// Open connections per host (0 = unlimited). Multiplexed HTTP/2
+        /// requests share a single connection.
+        unsigned maxConnectionsPerHost = 6;
+        /// Negotiate HTTP/2 over TLS and multiplex concurrent requests to the
+        /// same host onto one connection.
+        bool http2 = true;
+    };
+
+    class OMEGACOMMON_EXPORT HttpClientContext : public std::enable_shared_from_this<HttpClientContext> {
     public:
         static std::shared_ptr<HttpClientContext> Create();
         static std::shared_ptr<HttpClientContext> Create(HttpTlsConfig config);
+        static std::shared_ptr<HttpClientContext> Create(HttpTlsConfig config,HttpClientOptions options);
         virtual std::future<HttpResponse> makeRequest(HttpRequestDescriptor descriptor) = 0;
+        /// @brief Issues the request without blocking the caller.
+        /// @paragraph
+        /// The descriptor (including the url) is copied, so its storage need not outlive the call.
+        /// The context keeps itself alive until the response is delivered.
+        /// Compose the result with Async::then, whenAll or whenAny.
+        virtual Async<HttpResponse> makeRequestAsync(HttpRequestDescriptor descriptor);
+        /// @brief Issues the request and hands the body to @p sink chunk by chunk.
+        /// @paragraph
+        /// Memory use is bounded by what the sink keeps: when it returns Pause the
+        /// transfer stops reading from the socket, so TCP flow control throttles
+        /// the server until HttpStream::resume(). Combine with
+        /// HttpRequestDescriptor::range to resume downloads or split them into
+        /// parallel ranges.
+        virtual std::shared_ptr<HttpStream> makeStreamingRequest(HttpRequestDescriptor descriptor,
+                                                                 std::shared_ptr<HttpBodySink> sink);
+        /// @brief Streams the response body through a std::istream.
+        /// @paragraph
+        /// At most about @p bufferSize bytes are held between the network and the
+        /// reader; reads block until data arrives. The stream reports EOF at the
+        /// end of the body and sets badbit if the transfer fails. Destroying the
+        /// stream cancels the transfer.
+        std::unique_ptr<std::istream> openStream(HttpRequestDescriptor descriptor,size_t bufferSize = 1024 * 1024);
         virtual ~HttpClientContext() = default;
     };
 
@@ -11,7 +11,9 @@ namespace OmegaCommon {
         Multiline       = 1u << 1,
         DotAll          = 1u << 2,
         Utf             = 1u << 3,
-        Anchored        = 1u << 4
+        Anchored        = 1u << 4,
+        /// Skip JIT compilation (smaller memory footprint for patterns used once).
+        NoJit           = 1u << 5
     };
 
     inline unsigned operator|(RegexOption a, RegexOption b) {
@@ -41,8 +43,33 @@ namespace OmegaCommon {
         const RegexCapture & group(size_t index) const;
     };
 
+    /// A match as seen by Regex::scanAll(). It reads straight from the
+    /// matcher's buffers, so it (and any StrRef taken from it) is only valid
+    /// inside the callback; call toMatch() to keep a copy.
+    class OMEGACOMMON_EXPORT RegexMatchView {
+        StrRef input;
+        const size_t *ovector;
+        size_t pairs;
+    public:
+        RegexMatchView(StrRef input, const size_t *ovector, size_t pairs);
+
+        RegexCapture fullMatch() const;
+        /// Number of capture groups, not counting the full match.
+        size_t captureCount() const { return pairs - 1; }
+        /// Capture group @p index (0-based, as in RegexMatch::group()).
+        /// Groups that did not participate are empty at offset 0.
+        RegexCapture group(size_t index) const;
+        RegexMatch toMatch() const;
+    };
+
     struct RegexImpl;
 
+    /// Compiled PCRE2 pattern. Patterns are JIT-compiled where the platform
+    /// supports it, falling back to the interpreter otherwise.
+    ///
+    /// A Regex is immutable once compiled and may be shared between threads
+    /// without copies or locks. Match buffers and JIT stacks come from small
+    /// per-thread pools, so repeated searches do not allocate.
     class OMEGACOMMON_EXPORT Regex {
         RegexImpl *impl = nullptr;
 
@@ -62,6 +89,15 @@ namespace OmegaCommon {
         Vector<RegexMatch> findAll(StrRef input) const;
         Result<String, RegexError> replace(StrRef input, StrRef replacement) const;
         Vector<String> split(StrRef input) const;
+
+        /// Calls @p onMatch for each successive non-overlapping match in
+        /// @p input, stopping early when it returns false. Unlike findAll()
+        /// nothing is collected, so large inputs scan in constant memory.
+        /// @returns The number of matches passed to @p onMatch.
+        size_t scanAll(StrRef input, const std::function<bool(const RegexMatchView &)> & onMatch) const;
+
+        /// True when matching runs JIT-compiled code.
+        bool isJitCompiled() const;
     };
 
     OMEGACOMMON_EXPORT String regexEscape(StrRef input);
@@ -28,6 +28,13 @@ namespace OmegaCommon {
 
         static UniString fromUTF8(const char * utf8);
         static UniString fromUTF32(const Unicode32Char * utf32, std::int32_t length);
+        /// Copy `length` UTF-16 code units verbatim (no validation).
+        static UniString fromUTF16(const UnicodeChar * utf16, std::int32_t length);
+
+        /// The code units `[start, start + length)`, clamped to the
+        /// string. Copies UTF-16 directly — no round-trip through
+        /// UTF-8 or UTF-32, so surrogate pairs survive intact.
+        UniString substr(std::int32_t start, std::int32_t length) const;
 
         /// Encode the contents as a UTF-8 byte string. Round-trips with
         /// fromUTF8. Returns an empty string on an encoding error.
@@ -186,6 +193,122 @@ namespace OmegaCommon {
         std::unique_ptr<Impl> impl_;
     };
 
+    /**
+     * Immutable text plus its cached segmentation. Copies share one
+     * buffer, and the line-break, word-break and per-paragraph BiDi
+     * analyses each run at most once per buffer — lazily, on first
+     * query, from whichever thread asks first. Every accessor is
+     * const and safe to call concurrently, unlike `BreakIterator`
+     * and `BidiParagraph`, which own a mutable ICU cursor.
+     *
+     * The text keeps the encoding it was created with. A UTF-8
+     * buffer is segmented through an ICU `UText` over the original
+     * bytes, so no UTF-16 copy is made; all offsets it reports are
+     * byte offsets. A UTF-16 buffer reports UTF-16 code-unit offsets,
+     * matching `UniString`.
+     *
+     * Paragraphs are the ranges between mandatory line breaks, the
+     * same split the WTK text layout engine uses for its lines.
+     * Paragraphs containing no right-to-left characters or explicit
+     * RTL controls skip ICU's BiDi pass entirely and report a single
+     * LTR run.
+     */
+    class OMEGACOMMON_EXPORT TextBuffer {
+    public:
+        enum class Encoding {
+            UTF8,
+            UTF16
+        };
+
+        /// One line-break opportunity. `offset` is the position after
+        /// the break (ICU convention); position 0 is never reported.
+        struct LineBoundary {
+            std::int32_t offset    = 0;
+            bool         mandatory = false;
+        };
+
+        /// A run of text between mandatory breaks. `[start, end)` is
+        /// the paragraph text without its trailing break character(s);
+        /// `next` is where the following paragraph starts. `runs` are
+        /// its BiDi visual runs in visual order, with `logicalStart`
+        /// relative to `start` (as if a `BidiParagraph` had been
+        /// built over just this paragraph). Empty paragraphs have no
+        /// runs.
+        struct Paragraph {
+            std::int32_t start = 0;
+            std::int32_t end   = 0;
+            std::int32_t next  = 0;
+            Vector<BidiParagraph::VisualRun> runs;
+        };
+
+        /// An empty buffer.
+        TextBuffer();
+
+        static TextBuffer fromUTF8(StrRef utf8);
+        static TextBuffer fromUTF16(const UniString & text);
+
+        Encoding encoding() const;
+        /// Length in code units of `encoding()`.
+        std::int32_t length() const;
+        /// The text bytes for a UTF-8 buffer, otherwise `nullptr`.
+        const char * utf8Data() const;
+        /// The text for a UTF-16 buffer, otherwise `nullptr`.
+        const UnicodeChar * utf16Data() const;
+
+        /// Hash of the encoding and contents. Equal text yields equal
+        /// keys; `TextAnalysisCache` buckets by it.
+        std::uint64_t key() const;
+        /// True when both buffers hold the same code units in the
+        /// same encoding.
+        bool sameText(const TextBuffer & other) const;
+
+        /// Every line-break opportunity, in increasing offset order.
+        const Vector<LineBoundary> & lineBoundaries() const;
+        /// Word boundaries, in increasing offset order (excluding 0).
+        const Vector<std::int32_t> & wordBoundaries() const;
+        /// Paragraphs in logical order. Non-empty text always has at
+        /// least one paragraph.
+        const Vector<Paragraph> & paragraphs() const;
+
+    private:
+        struct Impl;
+        std::shared_ptr<Impl> impl_;
+        explicit TextBuffer(std::shared_ptr<Impl> impl);
+    };
+
+    /**
+     * A bounded, thread-safe map from text to its shared
+     * `TextBuffer`. Text layout asks this cache for the buffer of
+     * every string it lays out; unchanged text comes back with its
+     * break and BiDi analysis already done, so re-laying out a view
+     * does not re-run ICU. Least-recently-used entries are evicted
+     * once `capacity` buffers are held.
+     */
+    class OMEGACOMMON_EXPORT TextAnalysisCache {
+    public:
+        explicit TextAnalysisCache(std::size_t capacity = 256);
+        ~TextAnalysisCache();
+
+        TextAnalysisCache(const TextAnalysisCache &) = delete;
+        TextAnalysisCache & operator=(const TextAnalysisCache &) = delete;
+
+        /// The process-wide cache used by the WTK text layout engine.
+        static TextAnalysisCache & shared();
+
+        /// The cached buffer for `text`, creating it on a miss.
+        TextBuffer lookup(const UniString & text);
+        /// The cached buffer for UTF-8 `text`, creating it on a miss.
+        /// Never transcodes.
+        TextBuffer lookup(StrRef utf8);
+
+        std::size_t size() const;
+        void clear();
+
+    private:
+        struct Impl;
+        std::unique_ptr<Impl> impl_;
+    };
+
 }
 
 #endif
@@ -133,7 +133,7 @@ namespace OmegaCommon {
     public:
         typedef unsigned size_type;
     private:
-        const size_type _len = 0;
+        size_type _len = 0;
         using SELF = StrRefBase<CharTY>;
     public:
         using const_iterator = const CharTY *;
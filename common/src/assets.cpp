@@ -1,13 +1,17 @@
 #include "omega-common/assets.h"
 
 #include "omega-common/utils.h"
+#include "omega-common/compression.h"
 #include "omega-common/crypto.h"
+#include "omega-common/multithread.h"
 
 #include "../assetc/assetc.h"
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cctype>
+#include <cstring>
 #include <istream>
 #include <limits>
 #include <streambuf>
@@ -259,6 +263,13 @@ struct AssetBundle::Impl {
     Vector<std::uint8_t> key;
     Vector<RuntimeAssetEntry> entries;
     MapVec<String, size_t> entryIndex;
+    /// Set by openMapped(); payloads are then served from the mapping.
+    UniqueHandle<FS::MappedFile> mapping;
+    /// Per-entry flag recording that borrow() has already checked the hash.
+    std::unique_ptr<std::atomic<bool>[]> borrowVerified;
+    /// Reads and decodes started by prefetch(). Declared last so destruction
+    /// waits for them before anything they use is torn down.
+    TaskGroup prefetchTasks;
 };
 
 namespace {
@@ -273,7 +284,7 @@ Result<void *, String> indexEntry(AssetBundle::Impl &impl, RuntimeAssetEntry &&e
     return Result<void *, String>::ok(nullptr);
 }
 
-Result<void *, String> loadBundleV2Metadata(std::ifstream &in, AssetBundle::Impl &impl) {
+Result<void *, String> loadBundleV2Metadata(std::istream &in, AssetBundle::Impl &impl) {
     assetc::BundleHeader header {};
     if(!readExact(in, reinterpret_cast<char *>(&header), sizeof(header))) {
         return Result<void *, String>::err("Failed to read bundle header.");
@@ -446,58 +457,854 @@ private:
     char buffer_[4096];
 };
 
+/// Read-only streambuf over bytes that are already in memory, so the header
+/// parser can run unchanged against a file mapping.
+class ByteViewStreambuf : public std::streambuf {
+public:
+    explicit ByteViewStreambuf(Span<const std::uint8_t> bytes) {
+        auto *begin = reinterpret_cast<char *>(const_cast<std::uint8_t *>(bytes.data()));
+        setg(begin, begin, begin + bytes.size());
+    }
+};
+
+/// Chunk table of a compressed entry (see assetc::CompressedPayloadHeader),
+/// with stored sizes turned into offsets relative to the payload start.
+struct ChunkLayout {
+    assetc::CompressionCodec codec = assetc::CompressionCodec::None;
+    std::uint64_t chunkSize = 0;
+    std::uint64_t rawSize = 0;
+    Vector<std::uint64_t> offsets;
+
+    size_t chunkCount() const {
+        return offsets.empty() ? 0 : offsets.size() - 1;
+    }
+
+    std::uint64_t chunkRawSize(size_t idx) const {
+        return std::min(chunkSize, rawSize - static_cast<std::uint64_t>(idx) * chunkSize);
+    }
+
+    std::uint64_t chunkStoredSize(size_t idx) const {
+        return offsets[idx + 1] - offsets[idx];
+    }
+
+    /// Chunks that did not shrink are stored as-is.
+    assetc::CompressionCodec chunkCodec(size_t idx) const {
+        return chunkStoredSize(idx) == chunkRawSize(idx) ? assetc::CompressionCodec::None : codec;
+    }
+};
+
+constexpr std::uint64_t ChunkHeaderSize = sizeof(assetc::CompressedPayloadHeader);
+
+std::uint64_t chunkTableSize(const assetc::CompressedPayloadHeader &header) {
+    return ChunkHeaderSize + static_cast<std::uint64_t>(header.chunkCount) * sizeof(std::uint32_t);
+}
+
+/// Validates @p header against the entry and builds offsets from the stored
+/// chunk sizes at @p sizes. @p payloadSize is the full compressed payload.
+Result<ChunkLayout, String> parseChunkLayout(const assetc::CompressedPayloadHeader &header,
+                                             const std::uint8_t *sizes,
+                                             std::uint64_t payloadSize,
+                                             const RuntimeAssetEntry &entry) {
+    using ResultT = Result<ChunkLayout, String>;
+
+    ChunkLayout layout {};
+    layout.codec = static_cast<assetc::CompressionCodec>(header.codec);
+    layout.chunkSize = header.chunkSize;
+    layout.rawSize = entry.rawSize;
+
+    if(layout.codec != assetc::CompressionCodec::LZ4 &&
+       layout.codec != assetc::CompressionCodec::Zstd) {
+        return ResultT::err("Compressed asset uses an unknown codec: " + entry.name);
+    }
+
+    std::uint64_t expectedChunks =
+        layout.chunkSize == 0 ? 0 : (entry.rawSize + layout.chunkSize - 1) / layout.chunkSize;
+    if(layout.chunkSize == 0 || header.chunkCount != expectedChunks) {
+        return ResultT::err("Compressed asset has an inconsistent chunk table: " + entry.name);
+    }
+
+    auto tableSize = chunkTableSize(header);
+    if(tableSize > payloadSize) {
+        return ResultT::err("Compressed asset chunk table is truncated: " + entry.name);
+    }
+
+    layout.offsets.resize(static_cast<size_t>(header.chunkCount) + 1);
+    layout.offsets[0] = tableSize;
+    for(size_t idx = 0; idx < header.chunkCount; ++idx) {
+        std::uint32_t storedSize = 0;
+        std::memcpy(&storedSize, sizes + idx * sizeof(std::uint32_t), sizeof(storedSize));
+        layout.offsets[idx + 1] = layout.offsets[idx] + storedSize;
+    }
+
+    if(layout.offsets.back() != payloadSize) {
+        return ResultT::err("Compressed asset chunk sizes do not match its payload: " + entry.name);
+    }
+
+    return ResultT::ok(std::move(layout));
+}
+
+Result<ChunkLayout, String> parseChunkLayout(const std::uint8_t *payload,
+                                             std::uint64_t payloadSize,
+                                             const RuntimeAssetEntry &entry) {
+    if(payloadSize < ChunkHeaderSize) {
+        return Result<ChunkLayout, String>::err(
+            "Compressed asset payload is truncated: " + entry.name);
+    }
+
+    assetc::CompressedPayloadHeader header {};
+    std::memcpy(&header, payload, sizeof(header));
+    if(chunkTableSize(header) > payloadSize) {
+        return Result<ChunkLayout, String>::err(
+            "Compressed asset chunk table is truncated: " + entry.name);
+    }
+    return parseChunkLayout(header, payload + ChunkHeaderSize, payloadSize, entry);
+}
+
+/// Random-access reader over the stored payload of one entry.
+class PayloadSource {
+public:
+    virtual ~PayloadSource() = default;
+
+    virtual std::uint64_t size() const = 0;
+
+    /// Copies [offset, offset + len) of the payload into @p dst.
+    virtual bool read(std::uint64_t offset, std::uint8_t *dst, size_t len) = 0;
+
+    /// Direct pointer to [offset, offset + len) when the payload is already in
+    /// memory, nullptr otherwise.
+    virtual const std::uint8_t *view(std::uint64_t offset, size_t len) {
+        (void)offset;
+        (void)len;
+        return nullptr;
+    }
+};
+
+class FilePayloadSource : public PayloadSource {
+public:
+    FilePayloadSource(std::ifstream file, std::streamoff start, std::uint64_t size)
+        : file_(std::move(file)), start_(start), size_(size) {
+    }
+
+    std::uint64_t size() const override {
+        return size_;
+    }
+
+    bool read(std::uint64_t offset, std::uint8_t *dst, size_t len) override {
+        if(offset > size_ || len > size_ - offset) {
+            return false;
+        }
+        file_.clear();
+        file_.seekg(start_ + static_cast<std::streamoff>(offset), std::ios::beg);
+        return readExact(file_, reinterpret_cast<char *>(dst), static_cast<std::streamsize>(len));
+    }
+
+private:
+    std::ifstream file_;
+    std::streamoff start_;
+    std::uint64_t size_;
+};
+
+class MemoryPayloadSource : public PayloadSource {
+public:
+    MemoryPayloadSource(const std::uint8_t *data, std::uint64_t size) : data_(data), size_(size) {
+    }
+
+    std::uint64_t size() const override {
+        return size_;
+    }
+
+    bool read(std::uint64_t offset, std::uint8_t *dst, size_t len) override {
+        auto *src = view(offset, len);
+        if(src == nullptr) {
+            return false;
+        }
+        std::memcpy(dst, src, len);
+        return true;
+    }
+
+    const std::uint8_t *view(std::uint64_t offset, size_t len) override {
+        if(offset > size_ || len > size_ - offset) {
+            return nullptr;
+        }
+        return data_ + offset;
+    }
+
+private:
+    const std::uint8_t *data_;
+    std::uint64_t size_;
+};
+
+/// Reads the chunk table from the start of @p source.
+Result<ChunkLayout, String> readChunkLayout(PayloadSource &source, const RuntimeAssetEntry &entry) {
+    using ResultT = Result<ChunkLayout, String>;
+
+    assetc::CompressedPayloadHeader header {};
+    if(source.size() < ChunkHeaderSize ||
+       !source.read(0, reinterpret_cast<std::uint8_t *>(&header), sizeof(header))) {
+        return ResultT::err("Compressed asset payload is truncated: " + entry.name);
+    }
+
+    auto tableSize = chunkTableSize(header);
+    if(tableSize > source.size()) {
+        return ResultT::err("Compressed asset chunk table is truncated: " + entry.name);
+    }
+
+    Vector<std::uint8_t> sizes(static_cast<size_t>(tableSize - ChunkHeaderSize));
+    if(!source.read(ChunkHeaderSize, sizes.data(), sizes.size())) {
+        return ResultT::err("Failed to read compressed asset chunk table: " + entry.name);
+    }
+    return parseChunkLayout(header, sizes.data(), source.size(), entry);
+}
+
+/// Decodes every chunk of @p payload into a rawSize buffer. Chunks are
+/// independent, so they decode in parallel on the shared scheduler.
+Result<Vector<std::uint8_t>, String> decodeChunkedPayload(const std::uint8_t *payload,
+                                                          std::uint64_t payloadSize,
+                                                          const RuntimeAssetEntry &entry) {
+    using ResultT = Result<Vector<std::uint8_t>, String>;
+
+    auto layoutResult = parseChunkLayout(payload, payloadSize, entry);
+    if(layoutResult.isErr()) {
+        return ResultT::err(layoutResult.error());
+    }
+    const auto &layout = layoutResult.value();
+
+    size_t rawSize = 0;
+    if(!toSizeT(entry.rawSize, rawSize)) {
+        return ResultT::err("Asset payload is too large to load.");
+    }
+
+    Vector<std::uint8_t> out(rawSize);
+    Vector<Optional<String>> errors(layout.chunkCount());
+    parallelFor<size_t>(0, layout.chunkCount(), 1, [&](size_t idx) {
+        auto decoded = decompressBlock(layout.chunkCodec(idx),
+                                       payload + layout.offsets[idx],
+                                       static_cast<size_t>(layout.chunkStoredSize(idx)),
+                                       out.data() + idx * layout.chunkSize,
+                                       static_cast<size_t>(layout.chunkRawSize(idx)));
+        if(decoded.isErr()) {
+            errors[idx] = decoded.error();
+        }
+    });
+
+    for(auto &error : errors) {
+        if(error.has_value()) {
+            return ResultT::err("While decompressing \"" + entry.name + "\": " + *error);
+        }
+    }
+    return ResultT::ok(std::move(out));
+}
+
+bool entryHashMatches(const RuntimeAssetEntry &entry, Vector<std::uint8_t> &digestBytes) {
+    auto expected = entry.entryHash;
+    return constantTimeEquals(makeArrayRef(digestBytes.data(), digestBytes.data() + digestBytes.size()),
+                              makeArrayRef(expected.data(), expected.data() + expected.size()));
+}
+
+/// Keyed AEAD context, base nonce and AAD of one encrypted entry. The
+/// context is set up once and reused for every chunk of the entry.
+struct EntryCipher {
+    AeadContext aead;
+    Nonce nonce;
+    Vector<std::uint8_t> aad;
+};
+
+Result<EntryCipher, String> makeEntryCipher(const AssetBundle::Impl &impl,
+                                            const RuntimeAssetEntry &entry) {
+    using ResultT = Result<EntryCipher, String>;
+
+    if(impl.key.size() != EncryptionKey::KeySize) {
+        return ResultT::err("Encrypted asset bundle requires a 32-byte key.");
+    }
+
+    auto key = EncryptionKey::fromBytes(impl.key.data(), impl.key.size());
+    if(key.isErr()) {
+        return ResultT::err("Failed to load bundle key: " + key.error().message);
+    }
+
+    auto nonce = deriveEntryNonce(key.value(), entry.entryHash, entry.name);
+    if(nonce.isErr()) {
+        return ResultT::err("While decrypting \"" + entry.name + "\": " + nonce.error());
+    }
+
+    auto aead = AeadContext::create(key.value());
+    if(aead.isErr()) {
+        return ResultT::err("While decrypting \"" + entry.name + "\": " + aead.error().message);
+    }
+
+    return ResultT::ok(EntryCipher {std::move(aead.value()), nonce.value(),
+                                    buildEntryAad(entry.name, entry.type, entry.rawSize, entry.flags)});
+}
+
+constexpr std::uint64_t EncryptedHeaderSize = sizeof(assetc::EncryptedPayloadHeader);
+
+/// Chunk table of an entry sealed as assetc::EncryptedPayloadHeader describes.
+struct EncryptionLayout {
+    std::uint64_t chunkSize = 0;
+    std::uint32_t chunkCount = 0;
+    /// Size once decrypted: the compressed payload for compressed entries,
+    /// the raw bytes otherwise.
+    std::uint64_t plainSize = 0;
+
+    std::uint64_t chunkPlainSize(size_t idx) const {
+        return std::min(chunkSize, plainSize - static_cast<std::uint64_t>(idx) * chunkSize);
+    }
+
+    std::uint64_t chunkOffset(size_t idx) const {
+        return EncryptedHeaderSize +
+               static_cast<std::uint64_t>(idx) * (chunkSize + assetc::EncryptionTagSize);
+    }
+};
+
+Result<EncryptionLayout, String> readEncryptionLayout(PayloadSource &stored,
+                                                      const RuntimeAssetEntry &entry) {
+    using ResultT = Result<EncryptionLayout, String>;
+
+    assetc::EncryptedPayloadHeader header {};
+    if(stored.size() < EncryptedHeaderSize ||
+       !stored.read(0, reinterpret_cast<std::uint8_t *>(&header), sizeof(header))) {
+        return ResultT::err("Encrypted asset payload is truncated: " + entry.name);
+    }
+
+    auto overhead = EncryptedHeaderSize +
+                    static_cast<std::uint64_t>(header.chunkCount) * assetc::EncryptionTagSize;
+    if(header.chunkSize == 0 || header.chunkCount == 0 || overhead > stored.size()) {
+        return ResultT::err("Encrypted asset payload is truncated: " + entry.name);
+    }
+
+    EncryptionLayout layout {};
+    layout.chunkSize = header.chunkSize;
+    layout.chunkCount = header.chunkCount;
+    layout.plainSize = stored.size() - overhead;
+
+    auto expectedChunks = std::max<std::uint64_t>(
+        1, (layout.plainSize + layout.chunkSize - 1) / layout.chunkSize);
+    if(expectedChunks != header.chunkCount) {
+        return ResultT::err("Encrypted asset has an inconsistent chunk table: " + entry.name);
+    }
+    return ResultT::ok(layout);
+}
+
+/// Decrypted view of a chunked AEAD payload. Each chunk is authenticated
+/// before any of its bytes are handed out; one decrypted chunk is cached for
+/// read() calls that land in it.
+class DecryptingPayloadSource : public PayloadSource {
+public:
+    DecryptingPayloadSource(UniqueHandle<PayloadSource> stored,
+                            EncryptionLayout layout,
+                            EntryCipher cipher,
+                            String name)
+        : stored_(std::move(stored)),
+          layout_(layout),
+          cipher_(std::move(cipher)),
+          name_(std::move(name)) {
+    }
+
+    const EncryptionLayout &layout() const {
+        return layout_;
+    }
+
+    const String &error() const {
+        return error_;
+    }
+
+    std::uint64_t size() const override {
+        return layout_.plainSize;
+    }
+
+    /// Decrypts chunk @p idx into @p out, which must hold chunkPlainSize(idx) bytes.
+    bool decryptChunk(size_t idx, std::uint8_t *out) {
+        auto offset = layout_.chunkOffset(idx);
+        auto length = static_cast<size_t>(layout_.chunkPlainSize(idx));
+        const std::uint8_t *ciphertext = stored_->view(offset, length);
+        if(ciphertext == nullptr) {
+            // Read the ciphertext straight into the output and decrypt in place.
+            if(!stored_->read(offset, out, length)) {
+                error_ = "Failed to read encrypted asset payload: " + name_;
+                return false;
+            }
+            ciphertext = out;
+        }
+
+        std::array<std::uint8_t, assetc::EncryptionTagSize> tag {};
+        if(!stored_->read(offset + length, tag.data(), tag.size())) {
+            error_ = "Failed to read encrypted asset payload: " + name_;
+            return false;
+        }
+
+        auto chunkIndex = static_cast<std::uint32_t>(idx);
+        auto aad = assetc::chunkAad(cipher_.aad, chunkIndex, layout_.chunkCount);
+        auto decrypted = cipher_.aead.openInto(assetc::chunkNonce(cipher_.nonce, chunkIndex),
+                                               ciphertext, length, tag, out, aad.data(), aad.size());
+        if(decrypted.isErr()) {
+            error_ = "While decrypting \"" + name_ + "\": " + decrypted.error().message;
+            return false;
+        }
+        return true;
+    }
+
+    bool read(std::uint64_t offset, std::uint8_t *dst, size_t len) override {
+        if(offset > layout_.plainSize || len > layout_.plainSize - offset) {
+            return false;
+        }
+        while(len > 0) {
+            auto idx = static_cast<size_t>(offset / layout_.chunkSize);
+            if(!cachedChunk_.has_value() || *cachedChunk_ != idx) {
+                cachedChunk_.reset();
+                cache_.resize(static_cast<size_t>(layout_.chunkPlainSize(idx)));
+                if(!decryptChunk(idx, cache_.data())) {
+                    return false;
+                }
+                cachedChunk_ = idx;
+            }
+            auto within = static_cast<size_t>(offset - static_cast<std::uint64_t>(idx) * layout_.chunkSize);
+            auto count = std::min(len, cache_.size() - within);
+            std::memcpy(dst, cache_.data() + within, count);
+            dst += count;
+            offset += count;
+            len -= count;
+        }
+        return true;
+    }
+
+private:
+    UniqueHandle<PayloadSource> stored_;
+    EncryptionLayout layout_;
+    EntryCipher cipher_;
+    String name_;
+    String error_;
+    Optional<size_t> cachedChunk_;
+    Vector<std::uint8_t> cache_;
+};
+
+/// Opens the stored payload of @p entry. Streams must outlive the bundle, so
+/// they pass @p useMapping = false and always get their own file handle.
+Result<UniqueHandle<PayloadSource>, String> openStoredSource(const AssetBundle::Impl &impl,
+                                                             const RuntimeAssetEntry &entry,
+                                                             bool useMapping) {
+    using ResultT = Result<UniqueHandle<PayloadSource>, String>;
+
+    if(useMapping && impl.mapping != nullptr) {
+        // Entry ranges were checked against the mapping size at open time.
+        return ResultT::ok(UniqueHandle<PayloadSource>(
+            new MemoryPayloadSource(impl.mapping->data() + entry.fileOffset, entry.storedSize)));
+    }
+
+    std::streamoff start = 0;
+    if(!toStreamOffset(entry.fileOffset, start)) {
+        return ResultT::err("Asset payload offset is too large to read.");
+    }
+
+    std::ifstream file(impl.bundlePath, std::ios::binary | std::ios::in);
+    if(!file.is_open()) {
+        return ResultT::err("Failed to open asset bundle: " + impl.bundlePath);
+    }
+    return ResultT::ok(UniqueHandle<PayloadSource>(
+        new FilePayloadSource(std::move(file), start, entry.storedSize)));
+}
+
+Result<UniqueHandle<DecryptingPayloadSource>, String> makeDecryptingSource(
+        const AssetBundle::Impl &impl, const RuntimeAssetEntry &entry, UniqueHandle<PayloadSource> stored) {
+    using ResultT = Result<UniqueHandle<DecryptingPayloadSource>, String>;
+
+    auto cipher = makeEntryCipher(impl, entry);
+    if(cipher.isErr()) {
+        return ResultT::err(cipher.error());
+    }
+
+    auto layout = readEncryptionLayout(*stored, entry);
+    if(layout.isErr()) {
+        return ResultT::err(layout.error());
+    }
+
+    return ResultT::ok(UniqueHandle<DecryptingPayloadSource>(new DecryptingPayloadSource(
+        std::move(stored), layout.value(), std::move(cipher.value()), entry.name)));
+}
+
+Result<UniqueHandle<DecryptingPayloadSource>, String> openDecryptingSource(
+        const AssetBundle::Impl &impl, const RuntimeAssetEntry &entry, bool useMapping) {
+    auto stored = openStoredSource(impl, entry, useMapping);
+    if(stored.isErr()) {
+        return Result<UniqueHandle<DecryptingPayloadSource>, String>::err(stored.error());
+    }
+    return makeDecryptingSource(impl, entry, std::move(stored.value()));
+}
+
+/// Serves an entry's decoded bytes one chunk at a time, so memory stays
+/// bounded by the chunk size however large the asset is. Chunks read in
+/// order from the start are hashed as they are produced, and the last one is
+/// only handed out once the whole entry matched its hash. Failures set badbit
+/// on the owning stream so they cannot be mistaken for end of file.
+class ChunkedEntryStreambuf : public std::streambuf {
+public:
+    ChunkedEntryStreambuf(const RuntimeAssetEntry &entry, std::uint64_t chunkSize, size_t chunkCount)
+        : entry_(entry),
+          chunkSize_(chunkSize),
+          chunkCount_(chunkCount) {
+        if(entry_.hasHash) {
+            auto context = DigestContext::create(DigestAlgorithm::SHA256);
+            if(context.isOk()) {
+                hasher_.emplace(std::move(context.value()));
+            } else {
+                failed_ = true;
+            }
+        }
+    }
+
+    void setOwner(std::ios *owner) {
+        owner_ = owner;
+        if(failed_) {
+            owner_->setstate(std::ios::badbit);
+        }
+    }
+
+protected:
+    /// Decodes chunk @p idx into @p out.
+    virtual bool produceChunk(size_t idx, Vector<char> &out) = 0;
+
+    int_type underflow() override {
+        if(gptr() < egptr()) {
+            return traits_type::to_int_type(*gptr());
+        }
+        while(!failed_ && nextChunk_ < chunkCount_) {
+            if(!loadChunk(nextChunk_)) {
+                return traits_type::eof();
+            }
+            if(gptr() < egptr()) {
+                return traits_type::to_int_type(*gptr());
+            }
+        }
+        return traits_type::eof();
+    }
+
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+                     std::ios_base::openmode which) override {
+        if(failed_ || (which & std::ios_base::in) == 0) {
+            return pos_type(off_type(-1));
+        }
+        auto size = static_cast<std::streamoff>(entry_.rawSize);
+        std::streamoff consumed = (eback() == nullptr) ? 0 : (gptr() - eback());
+        std::streamoff currentPos = bufferStartPos_ + consumed;
+        std::streamoff newPos = 0;
+        if(dir == std::ios_base::beg) {
+            newPos = static_cast<std::streamoff>(off);
+        } else if(dir == std::ios_base::cur) {
+            newPos = currentPos + static_cast<std::streamoff>(off);
+        } else if(dir == std::ios_base::end) {
+            newPos = size + static_cast<std::streamoff>(off);
+        } else {
+            return pos_type(off_type(-1));
+        }
+        if(newPos < 0 || newPos > size) {
+            return pos_type(off_type(-1));
+        }
+        if(newPos == currentPos) {
+            return pos_type(newPos);
+        }
+
+        auto chunk = static_cast<size_t>(static_cast<std::uint64_t>(newPos) / chunkSize_);
+        setg(nullptr, nullptr, nullptr);
+        bufferStartPos_ = newPos;
+        nextChunk_ = chunk;
+        if(newPos < size) {
+            if(!loadChunk(chunk)) {
+                return pos_type(off_type(-1));
+            }
+            gbump(static_cast<int>(newPos - bufferStartPos_));
+        }
+        return pos_type(newPos);
+    }
+
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override {
+        return seekoff(off_type(pos), std::ios_base::beg, which);
+    }
+
+private:
+    bool loadChunk(size_t idx) {
+        auto expectedSize = std::min(chunkSize_, entry_.rawSize - static_cast<std::uint64_t>(idx) * chunkSize_);
+        if(!produceChunk(idx, decoded_) || decoded_.size() != expectedSize) {
+            return fail();
+        }
+
+        // Chunks revisited after a seek are not hashed again, and a forward
+        // seek past unread chunks leaves the entry hash unchecked.
+        if(hasher_.has_value() && idx == hashedChunks_) {
+            auto *bytes = reinterpret_cast<const std::uint8_t *>(decoded_.data());
+            if(hasher_->update(bytes, decoded_.size()).isErr()) {
+                return fail();
+            }
+            if(++hashedChunks_ == chunkCount_) {
+                auto digestResult = hasher_->finish();
+                if(digestResult.isErr() || !entryHashMatches(entry_, digestResult.value().bytes)) {
+                    return fail();
+                }
+            }
+        }
+
+        bufferStartPos_ = static_cast<std::streamoff>(static_cast<std::uint64_t>(idx) * chunkSize_);
+        nextChunk_ = idx + 1;
+        setg(decoded_.data(), decoded_.data(), decoded_.data() + decoded_.size());
+        return true;
+    }
+
+    bool fail() {
+        failed_ = true;
+        setg(nullptr, nullptr, nullptr);
+        if(owner_ != nullptr) {
+            owner_->setstate(std::ios::badbit);
+        }
+        return false;
+    }
+
+    RuntimeAssetEntry entry_;
+    std::uint64_t chunkSize_;
+    size_t chunkCount_;
+    Optional<DigestContext> hasher_;
+    size_t hashedChunks_ = 0;
+    std::ios *owner_ = nullptr;
+    bool failed_ = false;
+    size_t nextChunk_ = 0;
+    std::streamoff bufferStartPos_ = 0;
+    Vector<char> decoded_;
+};
+
+/// Decompresses a compressed entry chunk by chunk. @p source is the file, or
+/// a DecryptingPayloadSource when the entry is also encrypted.
+class CompressedEntryStreambuf : public ChunkedEntryStreambuf {
+public:
+    CompressedEntryStreambuf(const RuntimeAssetEntry &entry,
+                             UniqueHandle<PayloadSource> source,
+                             ChunkLayout layout)
+        : ChunkedEntryStreambuf(entry, layout.chunkSize, layout.chunkCount()),
+          source_(std::move(source)),
+          layout_(std::move(layout)) {
+    }
+
+protected:
+    bool produceChunk(size_t idx, Vector<char> &out) override {
+        auto storedSize = static_cast<size_t>(layout_.chunkStoredSize(idx));
+        auto rawSize = static_cast<size_t>(layout_.chunkRawSize(idx));
+        stored_.resize(storedSize);
+        out.resize(rawSize);
+        if(!source_->read(layout_.offsets[idx], stored_.data(), storedSize)) {
+            return false;
+        }
+        auto decoded = decompressBlock(layout_.chunkCodec(idx), stored_.data(), storedSize,
+                                       reinterpret_cast<std::uint8_t *>(out.data()), rawSize);
+        return decoded.isOk();
+    }
+
+private:
+    UniqueHandle<PayloadSource> source_;
+    ChunkLayout layout_;
+    Vector<std::uint8_t> stored_;
+};
+
+/// Decrypts an uncompressed encrypted entry chunk by chunk.
+class DecryptedEntryStreambuf : public ChunkedEntryStreambuf {
+public:
+    DecryptedEntryStreambuf(const RuntimeAssetEntry &entry,
+                            UniqueHandle<DecryptingPayloadSource> source)
+        : ChunkedEntryStreambuf(entry, source->layout().chunkSize, source->layout().chunkCount),
+          source_(std::move(source)) {
+    }
+
+protected:
+    bool produceChunk(size_t idx, Vector<char> &out) override {
+        out.resize(static_cast<size_t>(source_->layout().chunkPlainSize(idx)));
+        return source_->decryptChunk(idx, reinterpret_cast<std::uint8_t *>(out.data()));
+    }
+
+private:
+    UniqueHandle<DecryptingPayloadSource> source_;
+};
+
 class SliceIstream : public std::istream {
 public:
-    explicit SliceIstream(UniqueHandle<SliceStreambuf> buf)
+    SliceIstream(UniqueHandle<std::streambuf> buf, bool ok)
         : std::istream(buf.get()), buf_(std::move(buf)) {
-        if(!buf_->ok()) {
+        if(!ok) {
             setstate(std::ios::failbit);
         }
     }
 
 private:
-    UniqueHandle<SliceStreambuf> buf_;
+    UniqueHandle<std::streambuf> buf_;
 };
 
-Result<Vector<std::uint8_t>, String> readStoredBytes(const AssetBundle::Impl &impl,
-                                                     const RuntimeAssetEntry &entry) {
-    std::ifstream in(impl.bundlePath, std::ios::binary | std::ios::in);
-    if(!in.is_open()) {
-        return Result<Vector<std::uint8_t>, String>::err("Failed to open asset bundle: " +
-                                                         impl.bundlePath);
+/// Final check shared by every load() path: size and SHA-256 of the decoded bytes.
+Result<Vector<std::uint8_t>, String> verifyEntryBytes(const RuntimeAssetEntry &entry,
+                                                      Vector<std::uint8_t> bytes) {
+    if(bytes.size() != entry.rawSize) {
+        return Result<Vector<std::uint8_t>, String>::err(
+            "Decoded asset size does not match its entry: " + entry.name);
     }
 
-    std::streamoff offset = 0;
-    if(!toStreamOffset(entry.fileOffset, offset)) {
-        return Result<Vector<std::uint8_t>, String>::err(
-            "Asset payload offset is too large to read.");
+    if(entry.hasHash) {
+        auto hashResult = sha256(bytes);
+        if(hashResult.isErr()) {
+            return Result<Vector<std::uint8_t>, String>::err(
+                "While verifying \"" + entry.name + "\": " + hashResult.error());
+        }
+
+        auto expected = entry.entryHash;
+        if(!constantTimeEquals(makeArrayRef(hashResult.value().data(),
+                                           hashResult.value().data() + hashResult.value().size()),
+                               makeArrayRef(expected.data(), expected.data() + expected.size()))) {
+            return Result<Vector<std::uint8_t>, String>::err(
+                "Asset entry hash verification failed: " + entry.name);
+        }
+    }
+
+    return Result<Vector<std::uint8_t>, String>::ok(std::move(bytes));
+}
+
+/// decodeEntry() for chunked-AEAD entries. Uncompressed entries are decrypted
+/// straight into the result and hashed chunk by chunk in the same pass;
+/// compressed ones are decrypted into their compressed payload first.
+Result<Vector<std::uint8_t>, String> decodeChunkedEncryptedEntry(const AssetBundle::Impl &impl,
+                                                                 const RuntimeAssetEntry &entry,
+                                                                 UniqueHandle<PayloadSource> stored) {
+    using ResultT = Result<Vector<std::uint8_t>, String>;
+
+    auto decrypting = makeDecryptingSource(impl, entry, std::move(stored));
+    if(decrypting.isErr()) {
+        return ResultT::err(decrypting.error());
     }
+    auto &source = *decrypting.value();
+    const auto &layout = source.layout();
 
-    in.seekg(offset, std::ios::beg);
-    if(!in.good()) {
-        return Result<Vector<std::uint8_t>, String>::err("Failed to seek to asset payload: " +
-                                                         entry.name);
+    size_t plainSize = 0;
+    if(!toSizeT(layout.plainSize, plainSize)) {
+        return ResultT::err("Asset payload is too large to load.");
+    }
+
+    auto isCompressed =
+        (entry.flags & static_cast<std::uint32_t>(assetc::AssetEntryFlags::Compressed)) != 0;
+    if(!isCompressed && layout.plainSize != entry.rawSize) {
+        return ResultT::err("Decoded asset size does not match its entry: " + entry.name);
+    }
+
+    Optional<DigestContext> hasher;
+    if(!isCompressed && entry.hasHash) {
+        auto context = DigestContext::create(DigestAlgorithm::SHA256);
+        if(context.isErr()) {
+            return ResultT::err("While verifying \"" + entry.name + "\": " +
+                                context.error().message);
+        }
+        hasher.emplace(std::move(context.value()));
+    }
+
+    Vector<std::uint8_t> plain(plainSize);
+    for(size_t idx = 0; idx < layout.chunkCount; ++idx) {
+        auto *chunk = plain.data() + idx * layout.chunkSize;
+        auto chunkSize = static_cast<size_t>(layout.chunkPlainSize(idx));
+        if(!source.decryptChunk(idx, chunk)) {
+            return ResultT::err(source.error());
+        }
+        if(hasher.has_value() && hasher->update(chunk, chunkSize).isErr()) {
+            return ResultT::err("While verifying \"" + entry.name + "\": SHA-256 update failed.");
+        }
+    }
+
+    if(isCompressed) {
+        auto decoded = decodeChunkedPayload(plain.data(), plain.size(), entry);
+        if(decoded.isErr()) {
+            return decoded;
+        }
+        return verifyEntryBytes(entry, std::move(decoded.value()));
+    }
+
+    if(hasher.has_value()) {
+        auto digestResult = hasher->finish();
+        if(digestResult.isErr()) {
+            return ResultT::err("While verifying \"" + entry.name + "\": " +
+                                digestResult.error().message);
+        }
+        if(!entryHashMatches(entry, digestResult.value().bytes)) {
+            return ResultT::err("Asset entry hash verification failed: " + entry.name);
+        }
+    }
+    return ResultT::ok(std::move(plain));
+}
+
+/// Turns an entry's stored payload into its verified raw bytes, decrypting
+/// and decompressing as its flags require. Shared by load() and prefetch().
+Result<Vector<std::uint8_t>, String> decodeEntry(const AssetBundle::Impl &impl,
+                                                 const RuntimeAssetEntry &entry,
+                                                 UniqueHandle<PayloadSource> stored) {
+    using ResultT = Result<Vector<std::uint8_t>, String>;
+
+    auto isCompressed =
+        (entry.flags & static_cast<std::uint32_t>(assetc::AssetEntryFlags::Compressed)) != 0;
+    auto isEncrypted =
+        (entry.flags & static_cast<std::uint32_t>(assetc::AssetEntryFlags::Encrypted)) != 0;
+    auto isChunkedEncryption =
+        (entry.flags & static_cast<std::uint32_t>(assetc::AssetEntryFlags::ChunkedEncryption)) != 0;
+
+    if(isEncrypted && isChunkedEncryption) {
+        return decodeChunkedEncryptedEntry(impl, entry, std::move(stored));
     }
 
     size_t storedSize = 0;
     if(!toSizeT(entry.storedSize, storedSize)) {
-        return Result<Vector<std::uint8_t>, String>::err("Asset payload is too large to load.");
+        return ResultT::err("Asset payload is too large to load.");
+    }
+
+    const std::uint8_t *view = stored->view(0, storedSize);
+    if(isCompressed && !isEncrypted && view != nullptr) {
+        // Decode straight out of memory; the compressed bytes are never copied.
+        auto decoded = decodeChunkedPayload(view, storedSize, entry);
+        if(decoded.isErr()) {
+            return decoded;
+        }
+        return verifyEntryBytes(entry, std::move(decoded.value()));
     }
 
     Vector<std::uint8_t> bytes;
-    bytes.resize(storedSize);
-    if(!bytes.empty()) {
-        std::streamsize readSize = 0;
-        if(!toStreamSize(entry.storedSize, readSize)) {
-            return Result<Vector<std::uint8_t>, String>::err("Asset payload is too large to load.");
+    if(view != nullptr) {
+        bytes.assign(view, view + storedSize);
+    } else {
+        bytes.resize(storedSize);
+        if(!stored->read(0, bytes.data(), storedSize)) {
+            return ResultT::err("Failed to read asset payload: " + entry.name);
+        }
+    }
+
+    if(isEncrypted) {
+        // Whole-payload GCM, as written before chunked encryption existed.
+        if(bytes.size() < 16) {
+            return ResultT::err("Encrypted asset payload is truncated: " + entry.name);
         }
-        if(!readExact(in, reinterpret_cast<char *>(bytes.data()), readSize)) {
-            return Result<Vector<std::uint8_t>, String>::err("Failed to read asset payload: " +
-                                                             entry.name);
+
+        auto cipher = makeEntryCipher(impl, entry);
+        if(cipher.isErr()) {
+            return ResultT::err(cipher.error());
+        }
+
+        // Split the trailing GCM tag off and decrypt in place.
+        std::array<std::uint8_t, 16> tag {};
+        std::copy(bytes.end() - 16, bytes.end(), tag.begin());
+        bytes.resize(bytes.size() - 16);
+
+        auto &aad = cipher.value().aad;
+        auto decrypted = cipher.value().aead.openInto(cipher.value().nonce, bytes.data(), bytes.size(),
+                                                      tag, bytes.data(), aad.data(), aad.size());
+        if(decrypted.isErr()) {
+            return ResultT::err("While decrypting \"" + entry.name + "\": " +
+                                decrypted.error().message);
         }
     }
 
-    return Result<Vector<std::uint8_t>, String>::ok(std::move(bytes));
+    if(isCompressed) {
+        auto decoded = decodeChunkedPayload(bytes.data(), bytes.size(), entry);
+        if(decoded.isErr()) {
+            return decoded;
+        }
+        bytes = std::move(decoded.value());
+    }
+
+    return verifyEntryBytes(entry, std::move(bytes));
 }
 
 Result<AssetBundle::Impl *, String> openBundleImpl(FS::Path path, ArrayRef<std::uint8_t> key) {
@@ -537,6 +1344,56 @@ Result<AssetBundle::Impl *, String> openBundleImpl(FS::Path path, ArrayRef<std::
     return Result<AssetBundle::Impl *, String>::ok(impl);
 }
 
+Result<AssetBundle::Impl *, String> openMappedBundleImpl(FS::Path path, ArrayRef<std::uint8_t> key) {
+    auto bundlePath = path.absPath();
+    auto mapped = FS::MappedFile::open(path);
+    if(mapped.isErr()) {
+        return Result<AssetBundle::Impl *, String>::err("Failed to map asset bundle: " + bundlePath);
+    }
+
+    auto *impl = new AssetBundle::Impl();
+    impl->bundlePath = bundlePath;
+    impl->key.assign(key.begin(), key.end());
+    impl->mapping = std::move(mapped.value());
+
+    auto bytes = impl->mapping->bytes();
+    if(bytes.size() < sizeof(assetc::BundleMagic)) {
+        delete impl;
+        return Result<AssetBundle::Impl *, String>::err("Failed to read asset bundle header.");
+    }
+
+    if(!assetc::hasBundleMagic(bytes.data())) {
+        delete impl;
+        return Result<AssetBundle::Impl *, String>::err(
+            "Unsupported legacy asset bundle format. Rebuild this bundle with omega-assetc.");
+    }
+
+    ByteViewStreambuf headerBuf(bytes);
+    std::istream in(&headerBuf);
+    Result<void *, String> loadResult = loadBundleV2Metadata(in, *impl);
+    if(loadResult.isErr()) {
+        auto error = loadResult.error();
+        delete impl;
+        return Result<AssetBundle::Impl *, String>::err(std::move(error));
+    }
+
+    for(const auto &entry : impl->entries) {
+        if(entry.fileOffset > bytes.size() || entry.storedSize > bytes.size() - entry.fileOffset) {
+            auto name = entry.name;
+            delete impl;
+            return Result<AssetBundle::Impl *, String>::err(
+                "Asset payload extends past the end of the bundle file: " + name);
+        }
+    }
+
+    impl->borrowVerified.reset(new std::atomic<bool>[impl->entries.size()]);
+    for(size_t idx = 0; idx < impl->entries.size(); ++idx) {
+        impl->borrowVerified[idx].store(!impl->entries[idx].hasHash, std::memory_order_relaxed);
+    }
+
+    return Result<AssetBundle::Impl *, String>::ok(impl);
+}
+
 } // namespace
 
 const char *assetTypeName(AssetType type) {
@@ -614,6 +1471,32 @@ Result<AssetBundle, String> AssetBundle::open(FS::Path path, ArrayRef<std::uint8
     return Result<AssetBundle, String>::ok(AssetBundle(openResult.value()));
 }
 
+Result<AssetBundle, String> AssetBundle::openMapped(FS::Path path) {
+    Vector<std::uint8_t> emptyKey;
+    auto openResult = openMappedBundleImpl(path, emptyKey);
+    if(openResult.isErr()) {
+        return Result<AssetBundle, String>::err(openResult.error());
+    }
+    return Result<AssetBundle, String>::ok(AssetBundle(openResult.value()));
+}
+
+Result<AssetBundle, String> AssetBundle::openMapped(FS::Path path, ArrayRef<std::uint8_t> key) {
+    if(key.size() != 32) {
+        return Result<AssetBundle, String>::err(
+            "Asset bundle keys must be exactly 32 bytes.");
+    }
+
+    auto openResult = openMappedBundleImpl(path, key);
+    if(openResult.isErr()) {
+        return Result<AssetBundle, String>::err(openResult.error());
+    }
+    return Result<AssetBundle, String>::ok(AssetBundle(openResult.value()));
+}
+
+bool AssetBundle::isMapped() const {
+    return impl != nullptr && impl->mapping != nullptr;
+}
+
 size_t AssetBundle::entryCount() const {
     if(impl == nullptr) {
         return 0;
@@ -672,81 +1555,279 @@ Result<Vector<std::uint8_t>, String> AssetBundle::load(StrRef name) const {
     }
 
     auto &entry = impl->entries[it->second];
-    auto isCompressed =
-        (entry.flags & static_cast<std::uint32_t>(assetc::AssetEntryFlags::Compressed)) != 0;
-    auto isEncrypted =
-        (entry.flags & static_cast<std::uint32_t>(assetc::AssetEntryFlags::Encrypted)) != 0;
-
-    if(isCompressed) {
-        return Result<Vector<std::uint8_t>, String>::err(
-            "Compressed asset bundles are not implemented yet.");
+    auto stored = openStoredSource(*impl, entry, true);
+    if(stored.isErr()) {
+        return Result<Vector<std::uint8_t>, String>::err(stored.error());
     }
+    return decodeEntry(*impl, entry, std::move(stored.value()));
+}
 
-    auto bytesResult = readStoredBytes(*impl, entry);
-    if(bytesResult.isErr()) {
-        return bytesResult;
+namespace {
+
+/// Entries at most this far apart are fetched with one read; the bytes
+/// between them are read and dropped.
+constexpr std::uint64_t PrefetchGapLimit = 64U * 1024U;
+/// Caps one coalesced read, so decoding starts before a large batch is read.
+constexpr std::uint64_t PrefetchReadLimit = 8U * 1024U * 1024U;
+
+/// One coalesced read covering [begin, end) of the bundle file.
+struct PrefetchRead {
+    std::uint64_t begin = 0;
+    std::uint64_t end = 0;
+    Vector<size_t> entries;
+};
+
+Async<AssetBundle::LoadResult> readyLoadResult(AssetBundle::LoadResult result) {
+    Promise<AssetBundle::LoadResult> promise;
+    promise.set(std::move(result));
+    return promise.async();
+}
+
+}
+
+Vector<Async<AssetBundle::LoadResult>> AssetBundle::prefetch(const Vector<String> &names) const {
+    using Promises = Vector<Promise<LoadResult>>;
+
+    Vector<Async<LoadResult>> out;
+    out.reserve(names.size());
+    if(impl == nullptr) {
+        for(size_t idx = 0; idx < names.size(); ++idx) {
+            out.push_back(readyLoadResult(LoadResult::err("Asset bundle is not open.")));
+        }
+        return out;
     }
 
-    auto bytes = std::move(bytesResult.value());
-    if(isEncrypted) {
-        if(impl->key.size() != EncryptionKey::KeySize) {
-            return Result<Vector<std::uint8_t>, String>::err(
-                "Encrypted asset bundle requires a 32-byte key.");
+    // One promise per distinct entry; repeated names share it.
+    MapVec<size_t, size_t> slotOfEntry;
+    Vector<size_t> slotEntries;
+    Vector<Optional<size_t>> slotOfName(names.size());
+    for(size_t idx = 0; idx < names.size(); ++idx) {
+        auto it = impl->entryIndex.find(names[idx]);
+        if(it == impl->entryIndex.end()) {
+            continue;
         }
+        auto inserted = slotOfEntry.emplace(it->second, slotEntries.size());
+        if(inserted.second) {
+            slotEntries.push_back(it->second);
+        }
+        slotOfName[idx] = inserted.first->second;
+    }
 
-        if(bytes.size() < 16) {
-            return Result<Vector<std::uint8_t>, String>::err(
-                "Encrypted asset payload is truncated: " + entry.name);
+    auto promises = std::make_shared<Promises>(slotEntries.size());
+    for(size_t idx = 0; idx < names.size(); ++idx) {
+        if(slotOfName[idx].has_value()) {
+            out.push_back((*promises)[*slotOfName[idx]].async());
+        } else {
+            out.push_back(readyLoadResult(LoadResult::err("Asset not found: " + names[idx])));
         }
+    }
 
-        auto key = EncryptionKey::fromBytes(impl->key.data(), impl->key.size());
-        if(key.isErr()) {
-            return Result<Vector<std::uint8_t>, String>::err(
-                "Failed to load bundle key: " + key.error().message);
+    Vector<size_t> order(slotEntries.size());
+    for(size_t slot = 0; slot < order.size(); ++slot) {
+        order[slot] = slot;
+    }
+    std::sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+        return impl->entries[slotEntries[lhs]].fileOffset < impl->entries[slotEntries[rhs]].fileOffset;
+    });
+
+    Impl *bundle = impl;
+    if(bundle->mapping != nullptr) {
+        // Nothing to read up front: decode each entry straight from the
+        // mapping, in file order so page-ins stay sequential.
+        for(auto slot : order) {
+            auto entryIndex = slotEntries[slot];
+            bundle->prefetchTasks.run([bundle, promises, slot, entryIndex]() {
+                const auto &entry = bundle->entries[entryIndex];
+                auto stored = openStoredSource(*bundle, entry, true);
+                (*promises)[slot].set(stored.isErr()
+                                          ? LoadResult::err(stored.error())
+                                          : decodeEntry(*bundle, entry, std::move(stored.value())));
+            });
         }
+        return out;
+    }
 
-        auto nonce = deriveEntryNonce(key.value(), entry.entryHash, entry.name);
-        if(nonce.isErr()) {
-            return Result<Vector<std::uint8_t>, String>::err(
-                "While decrypting \"" + entry.name + "\": " + nonce.error());
+    Vector<PrefetchRead> reads;
+    Vector<Vector<size_t>> readSlots;
+    for(auto slot : order) {
+        const auto &entry = bundle->entries[slotEntries[slot]];
+        auto begin = entry.fileOffset;
+        auto end = entry.fileOffset + entry.storedSize;
+        if(!reads.empty() && begin <= reads.back().end + PrefetchGapLimit &&
+           std::max(end, reads.back().end) - reads.back().begin <= PrefetchReadLimit) {
+            reads.back().end = std::max(end, reads.back().end);
+            reads.back().entries.push_back(slot);
+            continue;
         }
+        PrefetchRead read {};
+        read.begin = begin;
+        read.end = end;
+        read.entries.push_back(slot);
+        reads.push_back(std::move(read));
+    }
+
+    // A single task walks the reads in order; every entry is handed to its own
+    // decode task as soon as its read lands, so the next read overlaps decoding.
+    bundle->prefetchTasks.run([bundle, promises, slotEntries = std::move(slotEntries),
+                               reads = std::move(reads)]() {
+        std::ifstream in(bundle->bundlePath, std::ios::binary | std::ios::in);
+        for(const auto &read : reads) {
+            auto buffer = std::make_shared<Vector<std::uint8_t>>();
+            std::streamoff start = 0;
+            size_t length = 0;
+            bool ok = in.is_open() && toStreamOffset(read.begin, start) &&
+                      toSizeT(read.end - read.begin, length);
+            if(ok) {
+                buffer->resize(length);
+                in.clear();
+                in.seekg(start, std::ios::beg);
+                ok = readExact(in, reinterpret_cast<char *>(buffer->data()),
+                               static_cast<std::streamsize>(length));
+            }
+
+            for(auto slot : read.entries) {
+                auto entryIndex = slotEntries[slot];
+                if(!ok) {
+                    (*promises)[slot].set(LoadResult::err(
+                        "Failed to read asset payload: " + bundle->entries[entryIndex].name));
+                    continue;
+                }
+                auto readBegin = read.begin;
+                bundle->prefetchTasks.run([bundle, promises, buffer, readBegin, slot, entryIndex]() {
+                    const auto &entry = bundle->entries[entryIndex];
+                    UniqueHandle<PayloadSource> stored(new MemoryPayloadSource(
+                        buffer->data() + (entry.fileOffset - readBegin), entry.storedSize));
+                    (*promises)[slot].set(decodeEntry(*bundle, entry, std::move(stored)));
+                });
+            }
+        }
+    });
+    return out;
+}
 
-        EncryptedData encrypted {};
-        encrypted.ciphertext.assign(bytes.begin(), bytes.end() - 16);
-        std::copy(bytes.end() - 16, bytes.end(), encrypted.tag.begin());
+Async<AssetBundle::LoadResult> AssetBundle::loadAsync(StrRef name) const {
+    Vector<String> names;
+    names.push_back(stringFromRef(name));
+    return prefetch(names).front();
+}
 
-        auto aad = buildEntryAad(entry.name, entry.type, entry.rawSize, entry.flags);
-        auto decrypted = decrypt(key.value(), nonce.value(), encrypted, aad.data(), aad.size());
-        if(decrypted.isErr()) {
-            return Result<Vector<std::uint8_t>, String>::err(
-                "While decrypting \"" + entry.name + "\": " + decrypted.error().message);
-        }
+Result<Span<const std::uint8_t>, String> AssetBundle::borrow(StrRef name) const {
+    using ResultT = Result<Span<const std::uint8_t>, String>;
 
-        bytes = std::move(decrypted.value());
+    if(impl == nullptr) {
+        return ResultT::err("Asset bundle is not open.");
     }
 
-    if(bytes.size() != entry.rawSize) {
-        return Result<Vector<std::uint8_t>, String>::err(
+    if(impl->mapping == nullptr) {
+        return ResultT::err("borrow() requires a bundle opened with openMapped().");
+    }
+
+    auto it = impl->entryIndex.find(stringFromRef(name));
+    if(it == impl->entryIndex.end()) {
+        return ResultT::err("Asset not found: " + stringFromRef(name));
+    }
+
+    auto &entry = impl->entries[it->second];
+    auto isCompressed =
+        (entry.flags & static_cast<std::uint32_t>(assetc::AssetEntryFlags::Compressed)) != 0;
+    auto isEncrypted =
+        (entry.flags & static_cast<std::uint32_t>(assetc::AssetEntryFlags::Encrypted)) != 0;
+
+    if(isCompressed || isEncrypted) {
+        return ResultT::err(
+            "borrowing encrypted/compressed entries is not possible; use load(): " + entry.name);
+    }
+
+    if(entry.storedSize != entry.rawSize) {
+        return ResultT::err(
             "Asset entry requires decoding that is not implemented yet: " + entry.name);
     }
 
-    if(entry.hasHash) {
-        auto hashResult = sha256(bytes);
+    Span<const std::uint8_t> view(impl->mapping->data() + entry.fileOffset,
+                                  static_cast<size_t>(entry.storedSize));
+
+    auto &verified = impl->borrowVerified[it->second];
+    if(!verified.load(std::memory_order_acquire)) {
+        // ArrayRef only reads through its pointer; the mapping itself is PROT_READ.
+        auto *viewBegin = const_cast<std::uint8_t *>(view.data());
+        auto hashResult = sha256(makeArrayRef(viewBegin, viewBegin + view.size()));
         if(hashResult.isErr()) {
-            return Result<Vector<std::uint8_t>, String>::err(
-                "While verifying \"" + entry.name + "\": " + hashResult.error());
+            return ResultT::err("While verifying \"" + entry.name + "\": " + hashResult.error());
         }
 
         if(!constantTimeEquals(makeArrayRef(hashResult.value().data(),
                                            hashResult.value().data() + hashResult.value().size()),
                                makeArrayRef(entry.entryHash.data(),
                                             entry.entryHash.data() + entry.entryHash.size()))) {
-            return Result<Vector<std::uint8_t>, String>::err(
-                "Asset entry hash verification failed: " + entry.name);
+            return ResultT::err("Asset entry hash verification failed: " + entry.name);
         }
+        verified.store(true, std::memory_order_release);
     }
 
-    return Result<Vector<std::uint8_t>, String>::ok(std::move(bytes));
+    return ResultT::ok(view);
+}
+
+Result<void *, String> AssetBundle::verify() const {
+    using ResultT = Result<void *, String>;
+
+    if(impl == nullptr) {
+        return ResultT::err("Asset bundle is not open.");
+    }
+
+    // Entries borrow() can serve are hashed straight out of the mapping.
+    Vector<size_t> inPlace;
+    Vector<ArrayRef<std::uint8_t>> views;
+    Vector<DigestResult> expected;
+    for(size_t idx = 0; idx < impl->entries.size(); ++idx) {
+        auto &entry = impl->entries[idx];
+        if(!entry.hasHash) {
+            continue;
+        }
+        auto isCompressed =
+            (entry.flags & static_cast<std::uint32_t>(assetc::AssetEntryFlags::Compressed)) != 0;
+        auto isEncrypted =
+            (entry.flags & static_cast<std::uint32_t>(assetc::AssetEntryFlags::Encrypted)) != 0;
+        if(impl->mapping != nullptr && !isCompressed && !isEncrypted &&
+           entry.storedSize == entry.rawSize) {
+            if(impl->borrowVerified[idx].load(std::memory_order_acquire)) {
+                continue;
+            }
+            // ArrayRef only reads through its pointer; the mapping itself is PROT_READ.
+            auto *begin = const_cast<std::uint8_t *>(impl->mapping->data() + entry.fileOffset);
+            inPlace.push_back(idx);
+            views.push_back(makeArrayRef(begin, begin + static_cast<size_t>(entry.storedSize)));
+            DigestResult digestBytes;
+            digestBytes.bytes.assign(entry.entryHash.begin(), entry.entryHash.end());
+            expected.push_back(std::move(digestBytes));
+            continue;
+        }
+
+        auto stored = openStoredSource(*impl, entry, true);
+        if(stored.isErr()) {
+            return ResultT::err(stored.error());
+        }
+        auto decoded = decodeEntry(*impl, entry, std::move(stored.value()));
+        if(decoded.isErr()) {
+            return ResultT::err(decoded.error());
+        }
+    }
+
+    if(views.empty()) {
+        return ResultT::ok(nullptr);
+    }
+
+    auto mismatched = verifyDigests(DigestAlgorithm::SHA256, views, expected);
+    if(mismatched.isErr()) {
+        return ResultT::err("While verifying asset bundle: " + mismatched.error().message);
+    }
+    if(!mismatched.value().empty()) {
+        return ResultT::err("Asset entry hash verification failed: " +
+                            impl->entries[inPlace[mismatched.value().front()]].name);
+    }
+    for(auto idx : inPlace) {
+        impl->borrowVerified[idx].store(true, std::memory_order_release);
+    }
+    return ResultT::ok(nullptr);
 }
 
 Result<UniqueHandle<std::istream>, String> AssetBundle::stream(StrRef name) const {
@@ -766,10 +1847,13 @@ Result<UniqueHandle<std::istream>, String> AssetBundle::stream(StrRef name) cons
         (entry.flags & static_cast<std::uint32_t>(assetc::AssetEntryFlags::Compressed)) != 0;
     auto isEncrypted =
         (entry.flags & static_cast<std::uint32_t>(assetc::AssetEntryFlags::Encrypted)) != 0;
+    auto isChunkedEncryption =
+        (entry.flags & static_cast<std::uint32_t>(assetc::AssetEntryFlags::ChunkedEncryption)) != 0;
 
-    if(isCompressed || isEncrypted) {
+    if(isEncrypted && !isChunkedEncryption) {
         return ResultT::err(
-            "streaming encrypted/compressed entries not yet supported; use load(): " + entry.name);
+            "Asset entry is encrypted as a single block and cannot be streamed; "
+            "use load() or rebuild the bundle: " + entry.name);
     }
 
     std::streamoff sliceStart = 0;
@@ -781,13 +1865,51 @@ Result<UniqueHandle<std::istream>, String> AssetBundle::stream(StrRef name) cons
         return ResultT::err("Asset payload is too large to stream.");
     }
 
+    if(isCompressed || isEncrypted) {
+        UniqueHandle<PayloadSource> source;
+        UniqueHandle<ChunkedEntryStreambuf> buf;
+        if(isEncrypted) {
+            auto decrypting = openDecryptingSource(*impl, entry, false);
+            if(decrypting.isErr()) {
+                return ResultT::err(decrypting.error());
+            }
+            if(isCompressed) {
+                source = std::move(decrypting.value());
+            } else if(decrypting.value()->size() != entry.rawSize) {
+                return ResultT::err("Decoded asset size does not match its entry: " + entry.name);
+            } else {
+                buf.reset(new DecryptedEntryStreambuf(entry, std::move(decrypting.value())));
+            }
+        } else {
+            auto stored = openStoredSource(*impl, entry, false);
+            if(stored.isErr()) {
+                return ResultT::err(stored.error());
+            }
+            source = std::move(stored.value());
+        }
+
+        if(isCompressed) {
+            auto layout = readChunkLayout(*source, entry);
+            if(layout.isErr()) {
+                return ResultT::err(layout.error());
+            }
+            buf.reset(new CompressedEntryStreambuf(entry, std::move(source),
+                                                   std::move(layout.value())));
+        }
+
+        auto *chunked = buf.get();
+        UniqueHandle<std::istream> stream(new SliceIstream(std::move(buf), true));
+        chunked->setOwner(stream.get());
+        return ResultT::ok(std::move(stream));
+    }
+
     auto buf = std::unique_ptr<SliceStreambuf>(
         new SliceStreambuf(impl->bundlePath, sliceStart, sliceSize));
     if(!buf->ok()) {
         return ResultT::err("Failed to open asset bundle for streaming: " + impl->bundlePath);
     }
 
-    UniqueHandle<std::istream> stream(new SliceIstream(std::move(buf)));
+    UniqueHandle<std::istream> stream(new SliceIstream(std::move(buf), true));
     return ResultT::ok(std::move(stream));
 }
 
@@ -812,19 +1934,45 @@ Result<String, String> AssetBundle::loadText(StrRef name) const {
 OmegaCommon::Map<OmegaCommon::String, AssetLibrary::AssetBuffer> AssetLibrary::assets_res;
 
 void AssetLibrary::loadAssetFile(OmegaCommon::FS::Path &path) {
-    auto bundleResult = AssetBundle::open(path);
-    if(bundleResult.isErr()) {
-        return;
+    Vector<AssetInfo> entries;
+    Vector<Async<AssetBundle::LoadResult>> pending;
+    {
+        auto bundleResult = AssetBundle::open(path);
+        if(bundleResult.isErr()) {
+            return;
+        }
+
+        // One batched prefetch: reads are coalesced in file order and entries
+        // decrypt and verify on the shared scheduler; only the registry
+        // insertion below runs serially.
+        auto bundle = std::move(bundleResult.value());
+        entries = bundle.entries();
+        Vector<String> names;
+        names.reserve(entries.size());
+        for(const auto &entry : entries) {
+            names.push_back(entry.name);
+        }
+        pending = bundle.prefetch(names);
+        // Closing the bundle waits on its prefetch TaskGroup, which runs queued
+        // reads and decodes on this thread instead of parking it, so every
+        // Async below is already fulfilled.
+    }
+
+    Vector<Optional<Vector<std::uint8_t>>> loaded(entries.size());
+    for(size_t idx = 0; idx < entries.size(); ++idx) {
+        auto &bytesResult = pending[idx].get();
+        if(bytesResult.isOk()) {
+            loaded[idx] = std::move(bytesResult.value());
+        }
     }
 
-    auto bundle = std::move(bundleResult.value());
-    for(const auto &entry : bundle.entries()) {
-        auto bytesResult = bundle.load(entry.name);
-        if(bytesResult.isErr()) {
+    for(size_t idx = 0; idx < entries.size(); ++idx) {
+        const auto &entry = entries[idx];
+        if(!loaded[idx].has_value()) {
             continue;
         }
 
-        auto bytes = std::move(bytesResult.value());
+        auto bytes = std::move(*loaded[idx]);
         auto *data = new Byte[bytes.size()];
         if(!bytes.empty()) {
             std::copy(bytes.begin(), bytes.end(), data);
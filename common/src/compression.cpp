@@ -0,0 +1,133 @@
+#include "omega-common/compression.h"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+
+#include <lz4.h>
+#include <lz4hc.h>
+#include <zstd.h>
+
+namespace OmegaCommon {
+
+    namespace {
+
+        bool fitsInt(size_t value){
+            return value <= static_cast<size_t>(std::numeric_limits<int>::max());
+        }
+
+        /// Zstd contexts are costly to create; keep one of each per thread.
+        ZSTD_CCtx *threadCompressContext(){
+            thread_local std::unique_ptr<ZSTD_CCtx,size_t (*)(ZSTD_CCtx *)> ctx(ZSTD_createCCtx(),ZSTD_freeCCtx);
+            return ctx.get();
+        }
+
+        ZSTD_DCtx *threadDecompressContext(){
+            thread_local std::unique_ptr<ZSTD_DCtx,size_t (*)(ZSTD_DCtx *)> ctx(ZSTD_createDCtx(),ZSTD_freeDCtx);
+            return ctx.get();
+        }
+
+    }
+
+    const char *compressionCodecName(CompressionCodec codec){
+        switch(codec){
+            case CompressionCodec::None:
+                return "none";
+            case CompressionCodec::LZ4:
+                return "lz4";
+            case CompressionCodec::Zstd:
+                return "zstd";
+        }
+        return "unknown";
+    }
+
+    size_t compressBound(CompressionCodec codec,size_t srcSize){
+        switch(codec){
+            case CompressionCodec::None:
+                return srcSize;
+            case CompressionCodec::LZ4:
+                return fitsInt(srcSize) ? static_cast<size_t>(LZ4_compressBound(static_cast<int>(srcSize))) : 0;
+            case CompressionCodec::Zstd:
+                return ZSTD_compressBound(srcSize);
+        }
+        return 0;
+    }
+
+    Result<Vector<std::uint8_t>, String> compressBlock(CompressionCodec codec,ArrayRef<std::uint8_t> src,int level){
+        using ResultT = Result<Vector<std::uint8_t>, String>;
+        const size_t srcSize = src.size();
+        Vector<std::uint8_t> out(compressBound(codec,srcSize));
+        if(out.empty() && srcSize > 0){
+            return ResultT::err("Block is too large for " + String(compressionCodecName(codec)) + ".");
+        }
+
+        switch(codec){
+            case CompressionCodec::None: {
+                out.assign(src.begin(),src.end());
+                return ResultT::ok(std::move(out));
+            }
+            case CompressionCodec::LZ4: {
+                auto *in = reinterpret_cast<const char *>(src.begin());
+                auto *dst = reinterpret_cast<char *>(out.data());
+                int written = level > 0
+                    ? LZ4_compress_HC(in,dst,static_cast<int>(srcSize),static_cast<int>(out.size()),level)
+                    : LZ4_compress_default(in,dst,static_cast<int>(srcSize),static_cast<int>(out.size()));
+                if(written <= 0 && srcSize > 0){
+                    return ResultT::err("LZ4 compression failed.");
+                }
+                out.resize(static_cast<size_t>(written));
+                return ResultT::ok(std::move(out));
+            }
+            case CompressionCodec::Zstd: {
+                size_t written = ZSTD_compressCCtx(threadCompressContext(),out.data(),out.size(),
+                                                   src.begin(),srcSize,
+                                                   level == 0 ? ZSTD_CLEVEL_DEFAULT : level);
+                if(ZSTD_isError(written)){
+                    return ResultT::err(String("Zstd compression failed: ") + ZSTD_getErrorName(written));
+                }
+                out.resize(written);
+                return ResultT::ok(std::move(out));
+            }
+        }
+        return ResultT::err("Unknown compression codec.");
+    }
+
+    Result<void *, String> decompressBlock(CompressionCodec codec,
+                                           const std::uint8_t *src,size_t srcSize,
+                                           std::uint8_t *dst,size_t dstSize){
+        using ResultT = Result<void *, String>;
+        switch(codec){
+            case CompressionCodec::None: {
+                if(srcSize != dstSize){
+                    return ResultT::err("Stored block size does not match its decoded size.");
+                }
+                std::copy(src,src + srcSize,dst);
+                return ResultT::ok(nullptr);
+            }
+            case CompressionCodec::LZ4: {
+                if(!fitsInt(srcSize) || !fitsInt(dstSize)){
+                    return ResultT::err("Block is too large for LZ4.");
+                }
+                int decoded = LZ4_decompress_safe(reinterpret_cast<const char *>(src),
+                                                  reinterpret_cast<char *>(dst),
+                                                  static_cast<int>(srcSize),static_cast<int>(dstSize));
+                if(decoded < 0 || static_cast<size_t>(decoded) != dstSize){
+                    return ResultT::err("LZ4 block is corrupt.");
+                }
+                return ResultT::ok(nullptr);
+            }
+            case CompressionCodec::Zstd: {
+                size_t decoded = ZSTD_decompressDCtx(threadDecompressContext(),dst,dstSize,src,srcSize);
+                if(ZSTD_isError(decoded)){
+                    return ResultT::err(String("Zstd block is corrupt: ") + ZSTD_getErrorName(decoded));
+                }
+                if(decoded != dstSize){
+                    return ResultT::err("Zstd block decoded to an unexpected size.");
+                }
+                return ResultT::ok(nullptr);
+            }
+        }
+        return ResultT::err("Unknown compression codec.");
+    }
+
+}
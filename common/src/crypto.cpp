@@ -11,6 +11,8 @@
 #include <openssl/ssl.h>
 #include <openssl/bn.h>
 
+#include <algorithm>
+#include <climits>
 #include <ctime>
 #include <cstring>
 
@@ -21,6 +23,7 @@
 #endif
 
 #include "omega-common/crypto.h"
+#include "omega-common/multithread.h"
 
 namespace OmegaCommon {
 
@@ -38,14 +41,24 @@ namespace OmegaCommon {
         return err;
     }
 
+    // Fetched once per process. The EVP_sha256()-style handles are resolved
+    // through the provider again on every init, and re-initialising a context
+    // with the digest it already holds reuses its state instead of rebuilding it.
     static const EVP_MD *digestMD(DigestAlgorithm alg) {
+        static const EVP_MD *sha256 = EVP_MD_fetch(nullptr, "SHA256", nullptr);
+        static const EVP_MD *sha512 = EVP_MD_fetch(nullptr, "SHA512", nullptr);
         switch (alg) {
-            case DigestAlgorithm::SHA256: return EVP_sha256();
-            case DigestAlgorithm::SHA512: return EVP_sha512();
+            case DigestAlgorithm::SHA256: return sha256 ? sha256 : EVP_sha256();
+            case DigestAlgorithm::SHA512: return sha512 ? sha512 : EVP_sha512();
         }
         return EVP_sha256();
     }
 
+    static const EVP_CIPHER *aes256gcm() {
+        static const EVP_CIPHER *cipher = EVP_CIPHER_fetch(nullptr, "AES-256-GCM", nullptr);
+        return cipher ? cipher : EVP_aes_256_gcm();
+    }
+
     static const char *digestName(DigestAlgorithm alg) {
         switch (alg) {
             case DigestAlgorithm::SHA256: return "SHA256";
@@ -88,7 +101,7 @@ namespace OmegaCommon {
     }
 
     // ================================================================
-    // Core Crypto (Phase 5 — unchanged)
+    // Core Crypto (Phase 5)
     // ================================================================
 
     Result<Vector<std::uint8_t>, CryptoError> randomBytes(size_t n) {
@@ -98,66 +111,44 @@ namespace OmegaCommon {
         return Result<Vector<std::uint8_t>, CryptoError>::ok(std::move(buf));
     }
 
-    Result<DigestResult, CryptoError> digest(DigestAlgorithm alg, ArrayRef<std::uint8_t> data) {
-        EVP_MD_CTX *ctx = EVP_MD_CTX_new();
-        if (!ctx)
-            return Result<DigestResult, CryptoError>::err(lastOpenSSLError());
+    /// Per-thread contexts behind the one-shot digest() overloads and
+    /// digestAll(), one per algorithm, so a call only re-arms a context.
+    struct ThreadDigestContexts {
+        EVP_MD_CTX *ctx[2] = {nullptr, nullptr};
+        ~ThreadDigestContexts() {
+            for (auto *c : ctx)
+                if (c) EVP_MD_CTX_free(c);
+        }
+    };
 
-        const EVP_MD *md = digestMD(alg);
+    static Result<DigestResult, CryptoError> digestBytes(DigestAlgorithm alg, const void *data, size_t len) {
+        thread_local ThreadDigestContexts contexts;
+        EVP_MD_CTX *&ctx = contexts.ctx[alg == DigestAlgorithm::SHA512 ? 1 : 0];
+        if (!ctx && !(ctx = EVP_MD_CTX_new()))
+            return Result<DigestResult, CryptoError>::err(lastOpenSSLError());
 
-        if (EVP_DigestInit_ex(ctx, md, nullptr) != 1) {
-            EVP_MD_CTX_free(ctx);
+        if (EVP_DigestInit_ex(ctx, digestMD(alg), nullptr) != 1)
             return Result<DigestResult, CryptoError>::err(lastOpenSSLError());
-        }
 
-        if (EVP_DigestUpdate(ctx, data.begin(), data.size()) != 1) {
-            EVP_MD_CTX_free(ctx);
+        if (len > 0 && EVP_DigestUpdate(ctx, data, len) != 1)
             return Result<DigestResult, CryptoError>::err(lastOpenSSLError());
-        }
 
         unsigned char out[EVP_MAX_MD_SIZE];
         unsigned int outLen = 0;
-        if (EVP_DigestFinal_ex(ctx, out, &outLen) != 1) {
-            EVP_MD_CTX_free(ctx);
+        if (EVP_DigestFinal_ex(ctx, out, &outLen) != 1)
             return Result<DigestResult, CryptoError>::err(lastOpenSSLError());
-        }
-
-        EVP_MD_CTX_free(ctx);
 
         DigestResult result;
         result.bytes.assign(out, out + outLen);
         return Result<DigestResult, CryptoError>::ok(std::move(result));
     }
 
-    Result<DigestResult, CryptoError> digest(DigestAlgorithm alg, StrRef text) {
-        EVP_MD_CTX *ctx = EVP_MD_CTX_new();
-        if (!ctx)
-            return Result<DigestResult, CryptoError>::err(lastOpenSSLError());
-
-        const EVP_MD *md = digestMD(alg);
-
-        if (EVP_DigestInit_ex(ctx, md, nullptr) != 1) {
-            EVP_MD_CTX_free(ctx);
-            return Result<DigestResult, CryptoError>::err(lastOpenSSLError());
-        }
-
-        if (EVP_DigestUpdate(ctx, text.data(), text.size()) != 1) {
-            EVP_MD_CTX_free(ctx);
-            return Result<DigestResult, CryptoError>::err(lastOpenSSLError());
-        }
-
-        unsigned char out[EVP_MAX_MD_SIZE];
-        unsigned int outLen = 0;
-        if (EVP_DigestFinal_ex(ctx, out, &outLen) != 1) {
-            EVP_MD_CTX_free(ctx);
-            return Result<DigestResult, CryptoError>::err(lastOpenSSLError());
-        }
-
-        EVP_MD_CTX_free(ctx);
+    Result<DigestResult, CryptoError> digest(DigestAlgorithm alg, ArrayRef<std::uint8_t> data) {
+        return digestBytes(alg, data.begin(), data.size());
+    }
 
-        DigestResult result;
-        result.bytes.assign(out, out + outLen);
-        return Result<DigestResult, CryptoError>::ok(std::move(result));
+    Result<DigestResult, CryptoError> digest(DigestAlgorithm alg, StrRef text) {
+        return digestBytes(alg, text.data(), text.size());
     }
 
     Result<Vector<std::uint8_t>, CryptoError> hmac(DigestAlgorithm alg, ArrayRef<std::uint8_t> key, ArrayRef<std::uint8_t> data) {
@@ -210,6 +201,121 @@ namespace OmegaCommon {
         return CRYPTO_memcmp(a.begin(), b.begin(), a.size()) == 0;
     }
 
+    // ================================================================
+    // DigestContext
+    // ================================================================
+
+    struct DigestContextImpl {
+        EVP_MD_CTX *ctx = nullptr;
+        const EVP_MD *md = nullptr;
+        ~DigestContextImpl() { if (ctx) EVP_MD_CTX_free(ctx); }
+    };
+
+    DigestContext::DigestContext(std::unique_ptr<DigestContextImpl> impl) : impl_(std::move(impl)) {}
+    DigestContext::~DigestContext() = default;
+    DigestContext::DigestContext(DigestContext &&) noexcept = default;
+    DigestContext &DigestContext::operator=(DigestContext &&) noexcept = default;
+
+    Result<DigestContext, CryptoError> DigestContext::create(DigestAlgorithm alg) {
+        auto impl = std::make_unique<DigestContextImpl>();
+        impl->ctx = EVP_MD_CTX_new();
+        if (!impl->ctx)
+            return Result<DigestContext, CryptoError>::err(lastOpenSSLError());
+
+        impl->md = digestMD(alg);
+        if (EVP_DigestInit_ex(impl->ctx, impl->md, nullptr) != 1)
+            return Result<DigestContext, CryptoError>::err(lastOpenSSLError());
+
+        return Result<DigestContext, CryptoError>::ok(DigestContext(std::move(impl)));
+    }
+
+    Result<void *, CryptoError> DigestContext::update(const std::uint8_t *data, size_t len) {
+        if (len > 0 && EVP_DigestUpdate(impl_->ctx, data, len) != 1)
+            return Result<void *, CryptoError>::err(lastOpenSSLError());
+        return Result<void *, CryptoError>::ok(nullptr);
+    }
+
+    Result<DigestResult, CryptoError> DigestContext::finish() {
+        unsigned char out[EVP_MAX_MD_SIZE];
+        unsigned int outLen = 0;
+        if (EVP_DigestFinal_ex(impl_->ctx, out, &outLen) != 1)
+            return Result<DigestResult, CryptoError>::err(lastOpenSSLError());
+
+        // Re-arm for the next message; EVP_MD_CTX keeps its allocation.
+        if (EVP_DigestInit_ex(impl_->ctx, impl_->md, nullptr) != 1)
+            return Result<DigestResult, CryptoError>::err(lastOpenSSLError());
+
+        DigestResult result;
+        result.bytes.assign(out, out + outLen);
+        return Result<DigestResult, CryptoError>::ok(std::move(result));
+    }
+
+    Result<void *, CryptoError> DigestContext::reset() {
+        if (EVP_DigestInit_ex(impl_->ctx, impl_->md, nullptr) != 1)
+            return Result<void *, CryptoError>::err(lastOpenSSLError());
+        return Result<void *, CryptoError>::ok(nullptr);
+    }
+
+    // ================================================================
+    // Batch Digests
+    // ================================================================
+
+    /// Buffers per digestAll() task: enough, at the batch's average buffer
+    /// size, that scheduling stays small next to hashing. A batch under one
+    /// task's worth of bytes runs on the caller.
+    static size_t batchGrain(const Vector<ArrayRef<std::uint8_t>> &buffers) {
+        constexpr size_t TargetBytesPerTask = 256 * 1024;
+        size_t total = 0;
+        for (const auto &buffer : buffers)
+            total += buffer.size();
+        if (total < TargetBytesPerTask)
+            return std::max<size_t>(buffers.size(), 1);
+        return std::max<size_t>(1, buffers.size() * TargetBytesPerTask / total);
+    }
+
+    Result<Vector<DigestResult>, CryptoError> digestAll(
+        DigestAlgorithm alg, const Vector<ArrayRef<std::uint8_t>> &buffers)
+    {
+        Vector<DigestResult> results(buffers.size());
+        Vector<Optional<CryptoError>> errors(buffers.size());
+        parallelFor<size_t>(0, buffers.size(), batchGrain(buffers), [&](size_t idx) {
+            auto hashed = digestBytes(alg, buffers[idx].begin(), buffers[idx].size());
+            if (hashed.isOk())
+                results[idx] = std::move(hashed.value());
+            else
+                errors[idx] = std::move(hashed.error());
+        });
+
+        for (auto &error : errors) {
+            if (error.has_value())
+                return Result<Vector<DigestResult>, CryptoError>::err(std::move(*error));
+        }
+        return Result<Vector<DigestResult>, CryptoError>::ok(std::move(results));
+    }
+
+    Result<Vector<size_t>, CryptoError> verifyDigests(
+        DigestAlgorithm alg, const Vector<ArrayRef<std::uint8_t>> &buffers,
+        const Vector<DigestResult> &expected)
+    {
+        if (expected.size() != buffers.size())
+            return Result<Vector<size_t>, CryptoError>::err(
+                CryptoError{-1, "verifyDigests needs one expected digest per buffer"});
+
+        auto digests = digestAll(alg, buffers);
+        if (digests.isErr())
+            return Result<Vector<size_t>, CryptoError>::err(std::move(digests.error()));
+
+        Vector<size_t> mismatched;
+        for (size_t idx = 0; idx < buffers.size(); ++idx) {
+            const auto &actual = digests.value()[idx].bytes;
+            const auto &wanted = expected[idx].bytes;
+            if (actual.size() != wanted.size() ||
+                CRYPTO_memcmp(actual.data(), wanted.data(), actual.size()) != 0)
+                mismatched.push_back(idx);
+        }
+        return Result<Vector<size_t>, CryptoError>::ok(std::move(mismatched));
+    }
+
     // ================================================================
     // Secure Memory
     // ================================================================
@@ -264,121 +370,184 @@ namespace OmegaCommon {
     // AES-256-GCM Encrypt / Decrypt
     // ================================================================
 
-    Result<EncryptedData, CryptoError> encrypt(
-        const EncryptionKey &key, const Nonce &nonce,
-        const std::uint8_t *plaintext, size_t plaintextLen,
-        const std::uint8_t *aad, size_t aadLen)
-    {
-        EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
-        if (!ctx)
-            return Result<EncryptedData, CryptoError>::err(lastOpenSSLError());
+    struct AeadContextImpl {
+        enum class Mode { Idle, Encrypt, Decrypt };
+        EVP_CIPHER_CTX *ctx = nullptr;
+        Mode mode = Mode::Idle;
+        ~AeadContextImpl() { if (ctx) EVP_CIPHER_CTX_free(ctx); }
+    };
 
-        if (EVP_EncryptInit_ex(ctx, EVP_aes_256_gcm(), nullptr, nullptr, nullptr) != 1) {
-            EVP_CIPHER_CTX_free(ctx);
-            return Result<EncryptedData, CryptoError>::err(lastOpenSSLError());
-        }
+    AeadContext::AeadContext(std::unique_ptr<AeadContextImpl> impl) : impl_(std::move(impl)) {}
+    AeadContext::~AeadContext() = default;
+    AeadContext::AeadContext(AeadContext &&) noexcept = default;
+    AeadContext &AeadContext::operator=(AeadContext &&) noexcept = default;
 
-        if (EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_IVLEN, static_cast<int>(Nonce::NonceSize), nullptr) != 1) {
-            EVP_CIPHER_CTX_free(ctx);
-            return Result<EncryptedData, CryptoError>::err(lastOpenSSLError());
-        }
+    Result<AeadContext, CryptoError> AeadContext::create(const EncryptionKey &key) {
+        auto impl = std::make_unique<AeadContextImpl>();
+        impl->ctx = EVP_CIPHER_CTX_new();
+        if (!impl->ctx)
+            return Result<AeadContext, CryptoError>::err(lastOpenSSLError());
 
-        if (EVP_EncryptInit_ex(ctx, nullptr, nullptr, key.data(), nonce.bytes.data()) != 1) {
-            EVP_CIPHER_CTX_free(ctx);
-            return Result<EncryptedData, CryptoError>::err(lastOpenSSLError());
-        }
+        if (EVP_CipherInit_ex(impl->ctx, aes256gcm(), nullptr, nullptr, nullptr, 1) != 1)
+            return Result<AeadContext, CryptoError>::err(lastOpenSSLError());
 
-        int tmpLen = 0;
+        if (EVP_CIPHER_CTX_ctrl(impl->ctx, EVP_CTRL_GCM_SET_IVLEN, static_cast<int>(Nonce::NonceSize), nullptr) != 1)
+            return Result<AeadContext, CryptoError>::err(lastOpenSSLError());
 
-        if (aad && aadLen > 0) {
-            if (EVP_EncryptUpdate(ctx, nullptr, &tmpLen, aad, static_cast<int>(aadLen)) != 1) {
-                EVP_CIPHER_CTX_free(ctx);
-                return Result<EncryptedData, CryptoError>::err(lastOpenSSLError());
-            }
-        }
+        // Key only: the schedule stays in the context and begin*() supplies the IV.
+        if (EVP_CipherInit_ex(impl->ctx, nullptr, nullptr, key.data(), nullptr, -1) != 1)
+            return Result<AeadContext, CryptoError>::err(lastOpenSSLError());
 
-        EncryptedData out;
-        out.ciphertext.resize(plaintextLen);
+        return Result<AeadContext, CryptoError>::ok(AeadContext(std::move(impl)));
+    }
 
-        if (EVP_EncryptUpdate(ctx, out.ciphertext.data(), &tmpLen, plaintext, static_cast<int>(plaintextLen)) != 1) {
-            EVP_CIPHER_CTX_free(ctx);
-            return Result<EncryptedData, CryptoError>::err(lastOpenSSLError());
-        }
-        int ciphertextLen = tmpLen;
+    static Result<void *, CryptoError> beginMessage(AeadContextImpl &impl, int enc, const Nonce &nonce,
+                                                    const std::uint8_t *aad, size_t aadLen) {
+        impl.mode = AeadContextImpl::Mode::Idle;
+        if (EVP_CipherInit_ex(impl.ctx, nullptr, nullptr, nullptr, nonce.bytes.data(), enc) != 1)
+            return Result<void *, CryptoError>::err(lastOpenSSLError());
 
-        if (EVP_EncryptFinal_ex(ctx, out.ciphertext.data() + ciphertextLen, &tmpLen) != 1) {
-            EVP_CIPHER_CTX_free(ctx);
-            return Result<EncryptedData, CryptoError>::err(lastOpenSSLError());
+        int tmpLen = 0;
+        if (aad && aadLen > 0) {
+            if (aadLen > static_cast<size_t>(INT_MAX) ||
+                EVP_CipherUpdate(impl.ctx, nullptr, &tmpLen, aad, static_cast<int>(aadLen)) != 1)
+                return Result<void *, CryptoError>::err(lastOpenSSLError());
         }
-        ciphertextLen += tmpLen;
-        out.ciphertext.resize(static_cast<size_t>(ciphertextLen));
 
-        if (EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_GET_TAG, 16, out.tag.data()) != 1) {
-            EVP_CIPHER_CTX_free(ctx);
-            return Result<EncryptedData, CryptoError>::err(lastOpenSSLError());
-        }
+        impl.mode = enc ? AeadContextImpl::Mode::Encrypt : AeadContextImpl::Mode::Decrypt;
+        return Result<void *, CryptoError>::ok(nullptr);
+    }
 
-        EVP_CIPHER_CTX_free(ctx);
-        return Result<EncryptedData, CryptoError>::ok(std::move(out));
+    Result<void *, CryptoError> AeadContext::beginEncrypt(const Nonce &nonce, const std::uint8_t *aad, size_t aadLen) {
+        return beginMessage(*impl_, 1, nonce, aad, aadLen);
     }
 
-    Result<Vector<std::uint8_t>, CryptoError> decrypt(
-        const EncryptionKey &key, const Nonce &nonce,
-        const EncryptedData &enc,
-        const std::uint8_t *aad, size_t aadLen)
-    {
-        EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
-        if (!ctx)
-            return Result<Vector<std::uint8_t>, CryptoError>::err(lastOpenSSLError());
+    Result<void *, CryptoError> AeadContext::beginDecrypt(const Nonce &nonce, const std::uint8_t *aad, size_t aadLen) {
+        return beginMessage(*impl_, 0, nonce, aad, aadLen);
+    }
 
-        if (EVP_DecryptInit_ex(ctx, EVP_aes_256_gcm(), nullptr, nullptr, nullptr) != 1) {
-            EVP_CIPHER_CTX_free(ctx);
-            return Result<Vector<std::uint8_t>, CryptoError>::err(lastOpenSSLError());
+    Result<void *, CryptoError> AeadContext::update(const std::uint8_t *in, size_t len, std::uint8_t *out) {
+        if (impl_->mode == AeadContextImpl::Mode::Idle)
+            return Result<void *, CryptoError>::err(CryptoError{-1, "AeadContext::update called outside a message"});
+
+        // EVP takes int lengths; GCM is a stream mode, so slices of a large
+        // buffer produce exactly as many bytes as they consume.
+        constexpr size_t MaxSlice = size_t(1) << 30;
+        while (len > 0) {
+            size_t slice = std::min(len, MaxSlice);
+            int tmpLen = 0;
+            if (EVP_CipherUpdate(impl_->ctx, out, &tmpLen, in, static_cast<int>(slice)) != 1) {
+                impl_->mode = AeadContextImpl::Mode::Idle;
+                return Result<void *, CryptoError>::err(lastOpenSSLError());
+            }
+            in += slice;
+            out += slice;
+            len -= slice;
         }
+        return Result<void *, CryptoError>::ok(nullptr);
+    }
 
-        if (EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_IVLEN, static_cast<int>(Nonce::NonceSize), nullptr) != 1) {
-            EVP_CIPHER_CTX_free(ctx);
-            return Result<Vector<std::uint8_t>, CryptoError>::err(lastOpenSSLError());
-        }
+    Result<void *, CryptoError> AeadContext::finishEncrypt(std::array<std::uint8_t, 16> &tag) {
+        if (impl_->mode != AeadContextImpl::Mode::Encrypt)
+            return Result<void *, CryptoError>::err(CryptoError{-1, "AeadContext::finishEncrypt called without beginEncrypt"});
+        impl_->mode = AeadContextImpl::Mode::Idle;
 
-        if (EVP_DecryptInit_ex(ctx, nullptr, nullptr, key.data(), nonce.bytes.data()) != 1) {
-            EVP_CIPHER_CTX_free(ctx);
-            return Result<Vector<std::uint8_t>, CryptoError>::err(lastOpenSSLError());
-        }
+        unsigned char unused[16];
+        int tmpLen = 0;
+        if (EVP_CipherFinal_ex(impl_->ctx, unused, &tmpLen) != 1)
+            return Result<void *, CryptoError>::err(lastOpenSSLError());
 
+        if (EVP_CIPHER_CTX_ctrl(impl_->ctx, EVP_CTRL_GCM_GET_TAG, 16, tag.data()) != 1)
+            return Result<void *, CryptoError>::err(lastOpenSSLError());
+        return Result<void *, CryptoError>::ok(nullptr);
+    }
+
+    Result<void *, CryptoError> AeadContext::finishDecrypt(const std::array<std::uint8_t, 16> &tag) {
+        if (impl_->mode != AeadContextImpl::Mode::Decrypt)
+            return Result<void *, CryptoError>::err(CryptoError{-1, "AeadContext::finishDecrypt called without beginDecrypt"});
+        impl_->mode = AeadContextImpl::Mode::Idle;
+
+        if (EVP_CIPHER_CTX_ctrl(impl_->ctx, EVP_CTRL_GCM_SET_TAG, 16,
+                const_cast<std::uint8_t *>(tag.data())) != 1)
+            return Result<void *, CryptoError>::err(lastOpenSSLError());
+
+        // GCM is a stream mode: update() already produced every byte and
+        // Final only checks the tag.
+        unsigned char unused[16];
         int tmpLen = 0;
+        if (EVP_CipherFinal_ex(impl_->ctx, unused, &tmpLen) != 1)
+            return Result<void *, CryptoError>::err(
+                CryptoError{-1, "GCM authentication failed: ciphertext or AAD has been tampered with"});
+        return Result<void *, CryptoError>::ok(nullptr);
+    }
 
-        if (aad && aadLen > 0) {
-            if (EVP_DecryptUpdate(ctx, nullptr, &tmpLen, aad, static_cast<int>(aadLen)) != 1) {
-                EVP_CIPHER_CTX_free(ctx);
-                return Result<Vector<std::uint8_t>, CryptoError>::err(lastOpenSSLError());
-            }
-        }
+    Result<EncryptedData, CryptoError> AeadContext::seal(const Nonce &nonce,
+        const std::uint8_t *plaintext, size_t plaintextLen,
+        const std::uint8_t *aad, size_t aadLen)
+    {
+        auto begun = beginEncrypt(nonce, aad, aadLen);
+        if (begun.isErr())
+            return Result<EncryptedData, CryptoError>::err(std::move(begun.error()));
 
-        Vector<std::uint8_t> out(enc.ciphertext.size());
+        EncryptedData out;
+        out.ciphertext.resize(plaintextLen);
+        auto updated = update(plaintext, plaintextLen, out.ciphertext.data());
+        if (updated.isErr())
+            return Result<EncryptedData, CryptoError>::err(std::move(updated.error()));
 
-        if (EVP_DecryptUpdate(ctx, out.data(), &tmpLen,
-                enc.ciphertext.data(), static_cast<int>(enc.ciphertext.size())) != 1) {
-            EVP_CIPHER_CTX_free(ctx);
-            return Result<Vector<std::uint8_t>, CryptoError>::err(lastOpenSSLError());
-        }
-        int plaintextLen = tmpLen;
+        auto finished = finishEncrypt(out.tag);
+        if (finished.isErr())
+            return Result<EncryptedData, CryptoError>::err(std::move(finished.error()));
+        return Result<EncryptedData, CryptoError>::ok(std::move(out));
+    }
 
-        if (EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_TAG, 16,
-                const_cast<std::uint8_t *>(enc.tag.data())) != 1) {
-            EVP_CIPHER_CTX_free(ctx);
-            return Result<Vector<std::uint8_t>, CryptoError>::err(lastOpenSSLError());
-        }
+    Result<void *, CryptoError> AeadContext::openInto(const Nonce &nonce,
+        const std::uint8_t *ciphertext, size_t ciphertextLen,
+        const std::array<std::uint8_t, 16> &tag, std::uint8_t *out,
+        const std::uint8_t *aad, size_t aadLen)
+    {
+        auto begun = beginDecrypt(nonce, aad, aadLen);
+        if (begun.isErr())
+            return begun;
+        auto updated = update(ciphertext, ciphertextLen, out);
+        if (updated.isErr())
+            return updated;
+        return finishDecrypt(tag);
+    }
 
-        if (EVP_DecryptFinal_ex(ctx, out.data() + plaintextLen, &tmpLen) != 1) {
-            EVP_CIPHER_CTX_free(ctx);
-            return Result<Vector<std::uint8_t>, CryptoError>::err(
-                CryptoError{-1, "GCM authentication failed: ciphertext or AAD has been tampered with"});
-        }
-        plaintextLen += tmpLen;
-        out.resize(static_cast<size_t>(plaintextLen));
+    Result<EncryptedData, CryptoError> encrypt(
+        const EncryptionKey &key, const Nonce &nonce,
+        const std::uint8_t *plaintext, size_t plaintextLen,
+        const std::uint8_t *aad, size_t aadLen)
+    {
+        auto context = AeadContext::create(key);
+        if (context.isErr())
+            return Result<EncryptedData, CryptoError>::err(std::move(context.error()));
+        return context.value().seal(nonce, plaintext, plaintextLen, aad, aadLen);
+    }
 
-        EVP_CIPHER_CTX_free(ctx);
+    Result<void *, CryptoError> decryptInto(
+        const EncryptionKey &key, const Nonce &nonce,
+        const std::uint8_t *ciphertext, size_t ciphertextLen,
+        const std::array<std::uint8_t, 16> &tag, std::uint8_t *out,
+        const std::uint8_t *aad, size_t aadLen)
+    {
+        auto context = AeadContext::create(key);
+        if (context.isErr())
+            return Result<void *, CryptoError>::err(std::move(context.error()));
+        return context.value().openInto(nonce, ciphertext, ciphertextLen, tag, out, aad, aadLen);
+    }
+
+    Result<Vector<std::uint8_t>, CryptoError> decrypt(
+        const EncryptionKey &key, const Nonce &nonce,
+        const EncryptedData &enc,
+        const std::uint8_t *aad, size_t aadLen)
+    {
+        Vector<std::uint8_t> out(enc.ciphertext.size());
+        auto result = decryptInto(key, nonce, enc.ciphertext.data(), enc.ciphertext.size(),
+                                  enc.tag, out.data(), aad, aadLen);
+        if (result.isErr())
+            return Result<Vector<std::uint8_t>, CryptoError>::err(std::move(result.error()));
         return Result<Vector<std::uint8_t>, CryptoError>::ok(std::move(out));
     }
 
@@ -1,7 +1,14 @@
 #include "omega-common/format.h"
+#include <atomic>
+#include <memory>
+#include <algorithm>
 #include <cassert>
 #include <cctype>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
 #include <mutex>
+#include <thread>
 
 namespace OmegaCommon {
 
@@ -23,7 +30,9 @@ namespace OmegaCommon {
 
         struct LogState {
             std::mutex mutex;
-            LogLevel minimumLevel = LogLevel::Info;
+            /// Atomic so the filter check in Log() never takes the mutex;
+            /// filtered-out calls cost one relaxed load.
+            std::atomic<int> minimumLevel {static_cast<int>(LogLevel::Info)};
             std::shared_ptr<LogSink> sink = std::make_shared<StdIOLogSink>();
         };
 
@@ -32,6 +41,9 @@ namespace OmegaCommon {
             return state;
         }
 
+        thread_local OmegaCommon::String logBuffer;
+        thread_local bool logBufferBorrowed = false;
+
     } // namespace
 
     class Formatter {
@@ -161,31 +173,38 @@ namespace OmegaCommon {
     }
 
     void setLogMinimumLevel(LogLevel level) {
-        auto & state = globalLogState();
-        std::lock_guard<std::mutex> lock(state.mutex);
-        state.minimumLevel = level;
+        globalLogState().minimumLevel.store(static_cast<int>(level),std::memory_order_relaxed);
     }
 
     LogLevel getLogMinimumLevel() {
-        auto & state = globalLogState();
-        std::lock_guard<std::mutex> lock(state.mutex);
-        return state.minimumLevel;
+        return static_cast<LogLevel>(globalLogState().minimumLevel.load(std::memory_order_relaxed));
     }
 
     bool shouldLog(LogLevel level) {
-        auto & state = globalLogState();
-        std::lock_guard<std::mutex> lock(state.mutex);
-        return static_cast<int>(level) >= static_cast<int>(state.minimumLevel);
+        return static_cast<int>(level) >= globalLogState().minimumLevel.load(std::memory_order_relaxed);
+    }
+
+    OmegaCommon::String * acquireLogBuffer() {
+        if(logBufferBorrowed){
+            return nullptr;
+        }
+        logBufferBorrowed = true;
+        logBuffer.clear();
+        return std::addressof(logBuffer);
+    }
+
+    void releaseLogBuffer() {
+        logBufferBorrowed = false;
     }
 
     void logMessage(LogLevel level, StrRef message) {
+        if(!shouldLog(level)){
+            return;
+        }
         std::shared_ptr<LogSink> sink;
         {
             auto & state = globalLogState();
             std::lock_guard<std::mutex> lock(state.mutex);
-            if(static_cast<int>(level) < static_cast<int>(state.minimumLevel)){
-                return;
-            }
             sink = state.sink;
         }
 
@@ -194,4 +213,338 @@ namespace OmegaCommon {
         }
     }
 
+    namespace {
+
+        /// Header in front of every record in a LogRing. `size` covers header,
+        /// message and padding to 8 bytes. A `length` of PaddingRecord marks
+        /// filler up to the end of the ring; only its first 8 bytes are written,
+        /// which always fit because every record is 8-byte aligned.
+        struct LogRecordHeader {
+            std::uint32_t size;
+            std::uint32_t length;
+            std::int64_t time;
+            std::int32_t level;
+            std::uint32_t reserved;
+        };
+
+        constexpr std::uint32_t PaddingRecord = 0xFFFFFFFFu;
+
+        /// Single-producer/single-consumer byte ring: the owning thread writes
+        /// records, the sink's writer thread reads them. `head` and `tail`
+        /// count bytes ever consumed/produced, so `tail - head` is the fill.
+        struct LogRing {
+            std::unique_ptr<char[]> bytes;
+            size_t capacity;
+            alignas(64) std::atomic<size_t> head {0};
+            alignas(64) std::atomic<size_t> tail {0};
+            /// Set when the producing thread exits; the writer frees the ring
+            /// once it is empty.
+            std::atomic<bool> orphaned {false};
+            /// Set when the sink is destroyed; threads drop it from their cache.
+            std::atomic<bool> closed {false};
+
+            explicit LogRing(size_t capacity):bytes(new char[capacity]),capacity(capacity){
+
+            }
+        };
+
+        /// Each thread's rings, one per AsyncLogSink it has logged to.
+        struct ThreadLogRings {
+            Vector<std::pair<std::uint64_t,std::shared_ptr<LogRing>>> rings;
+            ~ThreadLogRings(){
+                for(auto & entry : rings){
+                    entry.second->orphaned.store(true,std::memory_order_release);
+                }
+            }
+        };
+
+        thread_local ThreadLogRings threadLogRings;
+
+        std::atomic<std::uint64_t> nextAsyncLogSinkId {1};
+
+        std::int64_t logTimestampNow(){
+            return std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+
+        /// Appends "[hh:mm:ss.mmmZ] " (UTC) for a millisecond timestamp.
+        void appendLogTimestamp(OmegaCommon::String & out,std::int64_t millis){
+            auto dayMillis = static_cast<long long>(millis % 86400000);
+            char text[24];
+            int n = std::snprintf(text,sizeof(text),"[%02lld:%02lld:%02lld.%03lldZ] ",
+                                  dayMillis / 3600000,(dayMillis / 60000) % 60,
+                                  (dayMillis / 1000) % 60,dayMillis % 1000);
+            if(n > 0){
+                out.append(text,std::min(static_cast<size_t>(n),sizeof(text) - 1));
+            }
+        }
+
+    } // namespace
+
+    struct AsyncLogSink::Impl {
+        Options options;
+        std::uint64_t id = nextAsyncLogSinkId.fetch_add(1,std::memory_order_relaxed);
+        std::FILE *file = nullptr;
+
+        std::mutex registryMutex;
+        Vector<std::shared_ptr<LogRing>> added;
+        std::atomic<bool> hasAdded {false};
+
+        std::atomic<size_t> dropped {0};
+
+        std::mutex wakeMutex;
+        std::condition_variable wake;
+        std::condition_variable passDone;
+        std::atomic<bool> sleeping {false};
+        bool stopping = false;
+        std::uint64_t passes = 0;
+        std::uint64_t flushUntil = 0;
+
+        /// Writer-thread state.
+        Vector<std::shared_ptr<LogRing>> rings;
+        size_t droppedReported = 0;
+        OmegaCommon::String outBatch;
+        OmegaCommon::String errBatch;
+
+        std::thread writer;
+
+        LogRing & ringForThisThread(){
+            auto & cache = threadLogRings.rings;
+            for(auto & entry : cache){
+                if(entry.first == id){
+                    return *entry.second;
+                }
+            }
+            cache.erase(std::remove_if(cache.begin(),cache.end(),[](const auto & entry){
+                return entry.second->closed.load(std::memory_order_acquire);
+            }),cache.end());
+            auto ring = std::make_shared<LogRing>(options.ringSize);
+            cache.emplace_back(id,ring);
+            {
+                std::lock_guard<std::mutex> lk(registryMutex);
+                added.push_back(ring);
+            }
+            hasAdded.store(true,std::memory_order_release);
+            return *ring;
+        }
+
+        void wakeWriter(){
+            if(sleeping.load(std::memory_order_relaxed)){
+                wake.notify_one();
+            }
+        }
+
+        void push(LogLevel level,StrRef message){
+            LogRing & ring = ringForThisThread();
+            const size_t maxLength = ring.capacity / 2 - sizeof(LogRecordHeader);
+            const size_t length = std::min<size_t>(message.size(),maxLength);
+            const size_t need = (sizeof(LogRecordHeader) + length + 7) & ~size_t(7);
+            const std::int64_t time = logTimestampNow();
+            while(true){
+                size_t tail = ring.tail.load(std::memory_order_relaxed);
+                const size_t head = ring.head.load(std::memory_order_acquire);
+                size_t offset = tail & (ring.capacity - 1);
+                const size_t contiguous = ring.capacity - offset;
+                const size_t filler = contiguous < need ? contiguous : 0;
+                if(ring.capacity - (tail - head) >= need + filler){
+                    if(filler != 0){
+                        const std::uint32_t marker[2] = {static_cast<std::uint32_t>(filler),PaddingRecord};
+                        std::memcpy(ring.bytes.get() + offset,marker,sizeof(marker));
+                        tail += filler;
+                        offset = 0;
+                    }
+                    LogRecordHeader header {};
+                    header.size = static_cast<std::uint32_t>(need);
+                    header.length = static_cast<std::uint32_t>(length);
+                    header.time = time;
+                    header.level = static_cast<std::int32_t>(level);
+                    std::memcpy(ring.bytes.get() + offset,&header,sizeof(header));
+                    if(length != 0){
+                        std::memcpy(ring.bytes.get() + offset + sizeof(header),message.data(),length);
+                    }
+                    ring.tail.store(tail + need,std::memory_order_release);
+                    wakeWriter();
+                    return;
+                }
+                if(options.overflow == Overflow::Drop){
+                    dropped.fetch_add(1,std::memory_order_relaxed);
+                    return;
+                }
+                wake.notify_one();
+                std::this_thread::yield();
+            }
+        }
+
+        void emit(LogLevel level,std::int64_t time,StrRef message){
+            if(options.target){
+                options.target->log(level,message);
+                return;
+            }
+            bool toErr = file == nullptr && (level == LogLevel::Warn || level == LogLevel::Error);
+            auto & batch = toErr ? errBatch : outBatch;
+            if(options.timestamps){
+                appendLogTimestamp(batch,time);
+            }
+            batch.push_back('[');
+            batch.append(logLevelName(level));
+            batch.append("] ");
+            batch.append(message.data(),message.size());
+            batch.push_back('\n');
+        }
+
+        bool drain(LogRing & ring){
+            size_t head = ring.head.load(std::memory_order_relaxed);
+            const size_t tail = ring.tail.load(std::memory_order_acquire);
+            if(head == tail){
+                return false;
+            }
+            while(head != tail){
+                const char *at = ring.bytes.get() + (head & (ring.capacity - 1));
+                std::uint32_t prefix[2];
+                std::memcpy(prefix,at,sizeof(prefix));
+                if(prefix[1] != PaddingRecord){
+                    LogRecordHeader header;
+                    std::memcpy(&header,at,sizeof(header));
+                    emit(static_cast<LogLevel>(header.level),header.time,
+                         StrRef(at + sizeof(header),header.length));
+                }
+                head += prefix[0];
+            }
+            ring.head.store(head,std::memory_order_release);
+            return true;
+        }
+
+        void writeBatch(OmegaCommon::String & batch,std::FILE *stream){
+            if(batch.empty()){
+                return;
+            }
+            std::fwrite(batch.data(),1,batch.size(),stream);
+            std::fflush(stream);
+            batch.clear();
+        }
+
+        /// One pass over every ring. Returns true when anything was written.
+        bool drainAll(){
+            if(hasAdded.exchange(false,std::memory_order_acquire)){
+                std::lock_guard<std::mutex> lk(registryMutex);
+                for(auto & ring : added){
+                    rings.push_back(std::move(ring));
+                }
+                added.clear();
+            }
+            bool wrote = false;
+            for(auto & ring : rings){
+                wrote = drain(*ring) || wrote;
+            }
+            rings.erase(std::remove_if(rings.begin(),rings.end(),[](const std::shared_ptr<LogRing> & ring){
+                return ring->orphaned.load(std::memory_order_acquire) &&
+                       ring->head.load(std::memory_order_relaxed) == ring->tail.load(std::memory_order_acquire);
+            }),rings.end());
+            size_t droppedNow = dropped.load(std::memory_order_relaxed);
+            if(droppedNow != droppedReported){
+                emit(LogLevel::Warn,logTimestampNow(),
+                     fmtString(OMEGA_FMT("AsyncLogSink dropped @0 message(s): ring full"),droppedNow - droppedReported));
+                droppedReported = droppedNow;
+                wrote = true;
+            }
+            writeBatch(outBatch,file != nullptr ? file : stdout);
+            writeBatch(errBatch,stderr);
+            return wrote;
+        }
+
+        void run(){
+            while(true){
+                bool stop;
+                {
+                    std::lock_guard<std::mutex> lk(wakeMutex);
+                    stop = stopping;
+                }
+                bool wrote = drainAll();
+                {
+                    std::lock_guard<std::mutex> lk(wakeMutex);
+                    ++passes;
+                }
+                passDone.notify_all();
+                if(stop && !wrote){
+                    break;
+                }
+                if(!wrote){
+                    std::unique_lock<std::mutex> lk(wakeMutex);
+                    sleeping.store(true,std::memory_order_relaxed);
+                    wake.wait_for(lk,options.pollInterval,[this](){
+                        return stopping || passes < flushUntil;
+                    });
+                    sleeping.store(false,std::memory_order_relaxed);
+                }
+            }
+        }
+    };
+
+    Result<std::shared_ptr<AsyncLogSink>,OmegaCommon::String> AsyncLogSink::create(){
+        return create(Options());
+    }
+
+    Result<std::shared_ptr<AsyncLogSink>,OmegaCommon::String> AsyncLogSink::create(Options options){
+        using SinkResult = Result<std::shared_ptr<AsyncLogSink>,OmegaCommon::String>;
+        size_t ringSize = 256;
+        while(ringSize < options.ringSize){
+            ringSize <<= 1;
+        }
+        options.ringSize = ringSize;
+        auto impl = std::make_unique<Impl>();
+        if(!options.target && !options.filePath.empty()){
+            impl->file = std::fopen(options.filePath.c_str(),"ab");
+            if(impl->file == nullptr){
+                return SinkResult::err("AsyncLogSink: cannot open " + options.filePath + " for appending");
+            }
+        }
+        impl->options = std::move(options);
+        Impl *state = impl.get();
+        impl->writer = std::thread([state](){
+            state->run();
+        });
+        return SinkResult::ok(std::shared_ptr<AsyncLogSink>(new AsyncLogSink(std::move(impl))));
+    }
+
+    AsyncLogSink::AsyncLogSink(std::unique_ptr<Impl> impl):impl(std::move(impl)){
+
+    }
+
+    void AsyncLogSink::log(LogLevel level, StrRef message) {
+        impl->push(level,message);
+    }
+
+    void AsyncLogSink::flush() {
+        std::unique_lock<std::mutex> lk(impl->wakeMutex);
+        // A pass that starts after this point sees every record already
+        // published; the one in progress (if any) may have started earlier.
+        const std::uint64_t target = impl->passes + 2;
+        impl->flushUntil = std::max(impl->flushUntil,target);
+        impl->wake.notify_one();
+        impl->passDone.wait(lk,[this,target](){
+            return impl->passes >= target;
+        });
+    }
+
+    size_t AsyncLogSink::droppedCount() const {
+        return impl->dropped.load(std::memory_order_relaxed);
+    }
+
+    AsyncLogSink::~AsyncLogSink() {
+        {
+            std::lock_guard<std::mutex> lk(impl->wakeMutex);
+            impl->stopping = true;
+        }
+        impl->wake.notify_one();
+        if(impl->writer.joinable()){
+            impl->writer.join();
+        }
+        for(auto & ring : impl->rings){
+            ring->closed.store(true,std::memory_order_release);
+        }
+        if(impl->file != nullptr){
+            std::fclose(impl->file);
+        }
+    }
+
 } // namespace OmegaCommon
@@ -2,7 +2,10 @@
 #include "omega-common/net.h"
 #include "omega-common/assets.h"
 
+#include <algorithm>
+#include <cstring>
 #include <fstream>
+#include <limits>
 #include <memory>
 #include <sstream>
 
@@ -62,30 +65,413 @@ namespace {
     std::shared_ptr<HttpClientContext> http_client;
 }
 
+namespace {
+
+    struct Rgba {
+        Byte r, g, b, a;
+    };
+
+    inline Rgba loadPixel(const Byte * p, ColorFormat format) {
+        switch (format) {
+            case ColorFormat::RGB:
+                return {p[0], p[1], p[2], 255};
+            case ColorFormat::BGRA:
+                return {p[2], p[1], p[0], p[3]};
+            default:
+                return {p[0], p[1], p[2], p[3]};
+        }
+    }
+
+    inline void storePixel(Byte * p, ColorFormat format, Rgba px) {
+        switch (format) {
+            case ColorFormat::RGB:
+                p[0] = px.r; p[1] = px.g; p[2] = px.b;
+                break;
+            case ColorFormat::BGRA:
+                p[0] = px.b; p[1] = px.g; p[2] = px.r; p[3] = px.a;
+                break;
+            default:
+                p[0] = px.r; p[1] = px.g; p[2] = px.b; p[3] = px.a;
+                break;
+        }
+    }
+
+}
+
+int DecodeTarget::channelsOf(ColorFormat format) {
+    switch (format) {
+        case ColorFormat::RGB:
+            return 3;
+        case ColorFormat::RGBA:
+        case ColorFormat::BGRA:
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+ColorFormat DecodeTarget::formatFor(PixelFormat requested, ColorFormat native) {
+    switch (requested) {
+        case PixelFormat::RGBA8:
+            return ColorFormat::RGBA;
+        case PixelFormat::BGRA8:
+            return ColorFormat::BGRA;
+        case PixelFormat::RGB8:
+            return ColorFormat::RGB;
+        default:
+            return native;
+    }
+}
+
+std::uint32_t DecodeTarget::reductionFor(std::uint32_t size, std::uint32_t target) {
+    if (target == 0) {
+        return std::numeric_limits<std::uint32_t>::max();
+    }
+    return std::max<std::uint32_t>(1, size / target);
+}
+
+DecodeTarget::DecodeTarget(const DecodeOptions & options, std::uint32_t width, std::uint32_t height,
+                           ColorFormat format, AlphaFormat alpha)
+    : srcWidth(width), srcFormat(format), srcAlpha(alpha),
+      dstFormat(formatFor(options.pixelFormat, format)) {
+    if (channelsOf(srcFormat) == 0 || channelsOf(dstFormat) == 0 || width == 0 || height == 0) {
+        return;
+    }
+    region = Region{0, 0, width, height};
+    if (options.region) {
+        const Region & r = *options.region;
+        if (r.x >= width || r.y >= height || r.width == 0 || r.height == 0) {
+            return;
+        }
+        region = Region{r.x, r.y, std::min(r.width, width - r.x), std::min(r.height, height - r.y)};
+    }
+
+    factor = std::min(reductionFor(region.width, options.targetWidth),
+                      reductionFor(region.height, options.targetHeight));
+    if (factor == std::numeric_limits<std::uint32_t>::max()) {
+        factor = 1;
+    }
+    outWidth = (region.width + factor - 1) / factor;
+    outHeight = (region.height + factor - 1) / factor;
+
+    if (!passthrough()) {
+        scratch.resize(static_cast<std::size_t>(srcWidth) * static_cast<std::size_t>(channelsOf(srcFormat)));
+        if (factor > 1) {
+            sums.assign(static_cast<std::size_t>(outWidth) * 4, 0);
+        }
+    }
+    valid = true;
+}
+
+bool DecodeTarget::passthrough() const {
+    return factor == 1 && region.x == 0 && region.width == srcWidth && dstFormat == srcFormat;
+}
+
+void DecodeTarget::setDestination(Byte * data, std::size_t stride, bool topDown) {
+    dst = data;
+    dstStride = stride;
+    dstTopDown = topDown;
+}
+
+Byte * DecodeTarget::outputRow(std::uint32_t outRow) {
+    if (dst == nullptr) {
+        dstStride = static_cast<std::size_t>(outWidth) * static_cast<std::size_t>(channelsOf(dstFormat));
+        pixels = PixelStorage::allocate(dstStride * outHeight);
+        dst = pixels.data();
+    }
+    const std::uint32_t memoryRow = dstTopDown ? outRow : outHeight - 1 - outRow;
+    return dst + static_cast<std::size_t>(memoryRow) * dstStride;
+}
+
+void DecodeTarget::beginPass() {
+    rowsDone = 0;
+    rowsInBlock = 0;
+    std::fill(sums.begin(), sums.end(), 0);
+}
+
+Byte * DecodeTarget::rowBuffer(std::uint32_t y) {
+    if (passthrough()) {
+        return outputRow(y - region.y);
+    }
+    return scratch.data();
+}
+
+void DecodeTarget::pushRow(std::uint32_t y, const Byte * row) {
+    if (y < region.y || y >= region.y + region.height) {
+        return;
+    }
+    Byte * buffer = rowBuffer(y);
+    std::memcpy(buffer, row, static_cast<std::size_t>(srcWidth) * static_cast<std::size_t>(channelsOf(srcFormat)));
+    pushRow(y);
+}
+
+void DecodeTarget::pushRow(std::uint32_t y) {
+    if (y < region.y || y >= region.y + region.height) {
+        return;
+    }
+    if (passthrough()) {
+        rowsDone = y - region.y + 1;
+        return;
+    }
+    const auto srcChannels = static_cast<std::size_t>(channelsOf(srcFormat));
+    const Byte * src = scratch.data() + region.x * srcChannels;
+    const std::uint32_t localRow = y - region.y;
+
+    if (factor == 1) {
+        convertPixels(src, srcFormat, outputRow(localRow), dstFormat, outWidth);
+        rowsDone = localRow + 1;
+        return;
+    }
+
+    // Colour is weighted by alpha so transparent pixels do not bleed into
+    // their neighbours.
+    for (std::uint32_t i = 0; i < region.width; i++) {
+        const Rgba px = loadPixel(src + i * srcChannels, srcFormat);
+        std::uint64_t * sum = sums.data() + static_cast<std::size_t>(i / factor) * 4;
+        sum[0] += std::uint64_t(px.r) * px.a;
+        sum[1] += std::uint64_t(px.g) * px.a;
+        sum[2] += std::uint64_t(px.b) * px.a;
+        sum[3] += px.a;
+    }
+    rowsInBlock++;
+    if (rowsInBlock == factor || localRow + 1 == region.height) {
+        emitBlock(localRow / factor);
+    }
+}
+
+void DecodeTarget::emitBlock(std::uint32_t outRow) {
+    const auto dstChannels = static_cast<std::size_t>(channelsOf(dstFormat));
+    Byte * out = outputRow(outRow);
+    for (std::uint32_t o = 0; o < outWidth; o++) {
+        std::uint64_t * sum = sums.data() + static_cast<std::size_t>(o) * 4;
+        const std::uint64_t blockWidth = std::min<std::uint64_t>(factor, region.width - o * factor);
+        const std::uint64_t count = blockWidth * rowsInBlock;
+        Rgba px{0, 0, 0, 0};
+        if (sum[3] > 0) {
+            px.r = static_cast<Byte>((sum[0] + sum[3] / 2) / sum[3]);
+            px.g = static_cast<Byte>((sum[1] + sum[3] / 2) / sum[3]);
+            px.b = static_cast<Byte>((sum[2] + sum[3] / 2) / sum[3]);
+            px.a = static_cast<Byte>((sum[3] + count / 2) / count);
+        }
+        storePixel(out + o * dstChannels, dstFormat, px);
+        sum[0] = sum[1] = sum[2] = sum[3] = 0;
+    }
+    rowsInBlock = 0;
+    rowsDone = outRow + 1;
+}
+
+Header DecodeTarget::outputHeader(const Header & base) const {
+    const int dstChannels = channelsOf(dstFormat);
+    Header header = base;
+    header.width = outWidth;
+    header.height = outHeight;
+    header.channels = dstChannels;
+    header.bitDepth = 8;
+    header.color_format = dstFormat;
+    header.alpha_format = (dstChannels == 4 && channelsOf(srcFormat) == 4) ? srcAlpha : AlphaFormat::Ignore;
+    header.stride = static_cast<std::size_t>(outWidth) * static_cast<std::size_t>(dstChannels);
+    return header;
+}
+
+void DecodeTarget::finish(BitmapImage & img, const Header & base) {
+    if (dst == nullptr && outHeight > 0) {
+        outputRow(0);
+    }
+    img.pixels = std::move(pixels);
+    img.header = outputHeader(base);
+}
+
 // Defined in PngCodec.cpp / JpegCodec.cpp / TiffCodec.cpp:
-std::unique_ptr<ImgCodec> getPngCodec(std::istream & in, BitmapImage * img);
-std::unique_ptr<ImgCodec> getJpegCodec(std::istream & in, BitmapImage * img);
-std::unique_ptr<ImgCodec> getTiffCodec(std::istream & in, BitmapImage * img);
+std::unique_ptr<ImgCodec> getPngCodec(std::istream & in, BitmapImage * img, const DecodeOptions & options);
+std::unique_ptr<ImgCodec> getJpegCodec(std::istream & in, BitmapImage * img, const DecodeOptions & options);
+std::unique_ptr<ImgCodec> getTiffCodec(std::istream & in, BitmapImage * img, const DecodeOptions & options);
 
-static std::unique_ptr<ImgCodec> obtainCodecForImageFormat(Format & format, std::istream & in, BitmapImage * img) {
+static std::unique_ptr<ImgCodec> obtainCodecForImageFormat(Format & format, std::istream & in, BitmapImage * img,
+                                                           const DecodeOptions & options) {
     switch (format) {
         case Format::PNG:
-            return getPngCodec(in, img);
+            return getPngCodec(in, img, options);
         case Format::TIFF:
-            return getTiffCodec(in, img);
+            return getTiffCodec(in, img, options);
         case Format::JPEG:
-            return getJpegCodec(in, img);
+            return getJpegCodec(in, img, options);
         default:
             return nullptr;
     }
 }
 
+Result<void *, std::string> IncrementalDecoder::setDestination(Byte * data, std::size_t size, std::size_t stride,
+                                                              RowOrder order) {
+    if (!inHeaderCallback_) {
+        return Result<void *, std::string>::err(std::string("Destination can only be set from the header callback"));
+    }
+    if (data == nullptr || stride < header_.stride ||
+        (header_.height > 0 && size < stride * (header_.height - 1) + header_.stride)) {
+        return Result<void *, std::string>::err(std::string("Destination buffer too small for the decoded image"));
+    }
+    destination_ = data;
+    destinationStride_ = stride;
+    destinationOrder_ = order;
+    return Result<void *, std::string>::ok(data);
+}
+
+Result<IncrementalDecoder::State, std::string> IncrementalDecoder::feed(std::istream & in) {
+    Vector<Byte> chunk(64 * 1024);
+    while (in.read(reinterpret_cast<char *>(chunk.data()), static_cast<std::streamsize>(chunk.size())) ||
+           in.gcount() > 0) {
+        auto res = feed(chunk.data(), static_cast<std::size_t>(in.gcount()));
+        if (res.isErr() || res.value() == State::Complete) {
+            return res;
+        }
+    }
+    if (in.bad()) {
+        return Result<State, std::string>::err(std::string("Failed to read image stream"));
+    }
+    return Result<State, std::string>::ok(state_);
+}
+
+BitmapImage IncrementalDecoder::takeImage() {
+    return std::move(image_);
+}
+
+bool IncrementalDecoderBase::beginOutput(const DecodeOptions & effective, std::uint32_t width, std::uint32_t height,
+                                         ColorFormat format, AlphaFormat alpha, const Header & base) {
+    target = std::make_unique<DecodeTarget>(effective, width, height, format, alpha);
+    if (!target->ok()) {
+        return false;
+    }
+    header_ = target->outputHeader(base);
+    state_ = State::Decoding;
+    if (headerCallback_) {
+        inHeaderCallback_ = true;
+        headerCallback_(header_);
+        inHeaderCallback_ = false;
+    }
+    if (destination_ != nullptr) {
+        target->setDestination(destination_, destinationStride_, destinationOrder_ == RowOrder::TopDown);
+    }
+    return true;
+}
+
+void IncrementalDecoderBase::beginPass(unsigned number) {
+    pass = number;
+    reportedRows = 0;
+    target->beginPass();
+}
+
+void IncrementalDecoderBase::reportRows(bool finalPass) {
+    const std::uint32_t done = target->completedRows();
+    if (done > reportedRows && rowsCallback_) {
+        DecodeProgress progress;
+        progress.firstRow = reportedRows;
+        progress.rowCount = done - reportedRows;
+        progress.pass = pass;
+        progress.finalPass = finalPass;
+        rowsCallback_(progress);
+    }
+    reportedRows = std::max(reportedRows, done);
+}
+
+void IncrementalDecoderBase::complete(const Header & base) {
+    reportRows(true);
+    target->finish(image_, base);
+    header_ = image_.header;
+    state_ = State::Complete;
+}
+
+Result<IncrementalDecoder::State, std::string> IncrementalDecoderBase::fail(std::string message) {
+    image_.pixels.reset();
+    target.reset();
+    return Result<State, std::string>::err(std::move(message));
+}
+
+namespace {
+
+    /// Formats that need random access: collect everything, decode in finish().
+    class BufferedIncrementalDecoder : public IncrementalDecoderBase {
+        Format format;
+        Vector<Byte> data;
+    public:
+        BufferedIncrementalDecoder(Format format, const DecodeOptions & options)
+            : IncrementalDecoderBase(options), format(format) {}
+
+        Result<State, std::string> feed(const Byte * bytes, std::size_t size) override {
+            if (state_ == State::Complete) {
+                return Result<State, std::string>::ok(state_);
+            }
+            data.insert(data.end(), bytes, bytes + size);
+            return Result<State, std::string>::ok(state_);
+        }
+
+        Result<State, std::string> finish() override {
+            if (state_ == State::Complete) {
+                return Result<State, std::string>::ok(state_);
+            }
+            auto decoded = loadFromBuffer(data.data(), data.size(), format, options);
+            Vector<Byte>().swap(data);
+            if (decoded.isErr()) {
+                return fail(decoded.error());
+            }
+            BitmapImage & img = decoded.value();
+            DecodeOptions asDecoded;
+            const ColorFormat decodedFormat = img.header.color_format;
+            if (!beginOutput(asDecoded, img.header.width, img.header.height, decodedFormat,
+                             img.header.alpha_format, img.header)) {
+                return fail("Unsupported decoded pixel layout");
+            }
+            if (destination_ == nullptr) {
+                // Keep the one-shot decoder's buffer as the output.
+                image_ = std::move(img);
+                header_ = image_.header;
+                state_ = State::Complete;
+                if (rowsCallback_) {
+                    DecodeProgress progress;
+                    progress.rowCount = header_.height;
+                    progress.finalPass = true;
+                    rowsCallback_(progress);
+                }
+                return Result<State, std::string>::ok(state_);
+            }
+            // Rows come out of the one-shot decoder bottom-up.
+            for (std::uint32_t y = 0; y < img.header.height; y++) {
+                target->pushRow(y, img.data() + static_cast<std::size_t>(img.header.height - 1 - y) * img.header.stride);
+            }
+            complete(img.header);
+            return Result<State, std::string>::ok(state_);
+        }
+    };
+
+}
+
+std::unique_ptr<IncrementalDecoder> IncrementalDecoder::create(Format format, const DecodeOptions & options) {
+    switch (format) {
+        case Format::PNG:
+            return makePngIncrementalDecoder(options);
+        case Format::JPEG:
+            return makeJpegIncrementalDecoder(options);
+        default:
+            return std::make_unique<BufferedIncrementalDecoder>(format, options);
+    }
+}
+
+static Result<BitmapImage, std::string> loadFileAs(FS::Path & path, Format format, const DecodeOptions & options);
+static Result<BitmapImage, std::string> loadAssetAs(AssetBundle & bundle, FS::Path & path, Format format,
+                                                    const DecodeOptions & options);
+
 Result<BitmapImage, std::string> loadFromAssets(AssetBundle & bundle, FS::Path path) {
+    return loadFromAssets(bundle, path, DecodeOptions{});
+}
+
+Result<BitmapImage, std::string> loadFromAssets(AssetBundle & bundle, FS::Path path, const DecodeOptions & options) {
     auto format = imageFormatForExtension(path.ext());
     if (!format.has_value()) {
         return Result<BitmapImage, std::string>::err(std::string("Unsupported image asset format"));
     }
+    return loadAssetAs(bundle, path, *format, options);
+}
 
+static Result<BitmapImage, std::string> loadAssetAs(AssetBundle & bundle, FS::Path & path, Format format,
+                                                    const DecodeOptions & options) {
     auto assetInfo = bundle.info(path.str());
     if (!assetInfo.has_value()) {
         return Result<BitmapImage, std::string>::err(std::string("Failed to Load Image from Assets"));
@@ -106,15 +492,22 @@ Result<BitmapImage, std::string> loadFromAssets(AssetBundle & bundle, FS::Path p
         return Result<BitmapImage, std::string>::err(std::string("Failed to Load Image from Assets"));
     }
 
-    return loadFromBuffer(bytes.data(), bytes.size(), *format);
+    return loadFromBuffer(bytes.data(), bytes.size(), format, options);
 }
 
 Result<BitmapImage, std::string> loadFromFile(FS::Path path) {
+    return loadFromFile(path, DecodeOptions{});
+}
+
+Result<BitmapImage, std::string> loadFromFile(FS::Path path, const DecodeOptions & options) {
     auto format = imageFormatForExtension(path.ext());
     if (!format.has_value()) {
         return Result<BitmapImage, std::string>::err(std::string("Unsupported image file format"));
     }
+    return loadFileAs(path, *format, options);
+}
 
+static Result<BitmapImage, std::string> loadFileAs(FS::Path & path, Format format, const DecodeOptions & options) {
     BitmapImage img{};
     auto os_corrected_path = path.absPath();
     std::ifstream in(os_corrected_path, std::ios::binary);
@@ -122,7 +515,7 @@ Result<BitmapImage, std::string> loadFromFile(FS::Path path) {
         return Result<BitmapImage, std::string>::err(std::string("Failed to Load Image from File"));
     }
 
-    std::unique_ptr<ImgCodec> codec = obtainCodecForImageFormat(*format, in, &img);
+    std::unique_ptr<ImgCodec> codec = obtainCodecForImageFormat(format, in, &img, options);
     if (!codec) {
         return Result<BitmapImage, std::string>::err(std::string("Failed to Load Image from File"));
     }
@@ -134,21 +527,29 @@ Result<BitmapImage, std::string> loadFromFile(FS::Path path) {
 }
 
 Result<BitmapImage, std::string> loadFromURL(StrRef url, Format format) {
+    return loadFromURL(url, format, DecodeOptions{});
+}
+
+Result<BitmapImage, std::string> loadFromURL(StrRef url, Format format, const DecodeOptions & options) {
     if (!http_client) {
         http_client = HttpClientContext::Create();
     }
     auto resp = http_client->makeRequest({url}).get();
-    return loadFromBuffer((Byte *)resp.body.data(), resp.body.size(), format);
+    return loadFromBuffer((Byte *)resp.body.data(), resp.body.size(), format, options);
 }
 
 Result<BitmapImage, std::string> loadFromBuffer(Byte * bufferData, std::size_t bufferSize, Format f) {
+    return loadFromBuffer(bufferData, bufferSize, f, DecodeOptions{});
+}
+
+Result<BitmapImage, std::string> loadFromBuffer(Byte * bufferData, std::size_t bufferSize, Format f, const DecodeOptions & options) {
     if (bufferData == nullptr || bufferSize == 0) {
         return Result<BitmapImage, std::string>::err(std::string("Empty image buffer"));
     }
     BitmapImage img{};
     ImgBuffer imgBuffer{bufferData, bufferData + bufferSize};
     std::istream in(&imgBuffer);
-    std::unique_ptr<ImgCodec> codec = obtainCodecForImageFormat(f, in, &img);
+    std::unique_ptr<ImgCodec> codec = obtainCodecForImageFormat(f, in, &img, options);
     if (!codec) {
         return Result<BitmapImage, std::string>::err(std::string("Unsupported image format"));
     }
@@ -159,4 +560,67 @@ Result<BitmapImage, std::string> loadFromBuffer(Byte * bufferData, std::size_t b
     return Result<BitmapImage, std::string>::ok(std::move(img));
 }
 
+DecodeRequest DecodeRequest::fromFile(String path, const DecodeOptions & options) {
+    DecodeRequest request;
+    request.source = Source::File;
+    request.path = std::move(path);
+    request.options = options;
+    return request;
+}
+
+DecodeRequest DecodeRequest::fromAsset(AssetBundle & bundle, String path, const DecodeOptions & options) {
+    DecodeRequest request;
+    request.source = Source::Asset;
+    request.bundle = &bundle;
+    request.path = std::move(path);
+    request.options = options;
+    return request;
+}
+
+DecodeRequest DecodeRequest::fromBuffer(const Byte * data, std::size_t size, Format format, const DecodeOptions & options) {
+    DecodeRequest request;
+    request.source = Source::Buffer;
+    request.data = data;
+    request.size = size;
+    request.format = format;
+    request.options = options;
+    return request;
+}
+
+static DecodeResult decodeRequest(const DecodeRequest & request) {
+    if (request.source == DecodeRequest::Source::Buffer) {
+        if (!request.format) {
+            return DecodeResult::err(std::string("Buffer decode requests need a format"));
+        }
+        return loadFromBuffer(const_cast<Byte *>(request.data), request.size, *request.format, request.options);
+    }
+    FS::Path path(request.path);
+    auto format = request.format ? request.format : imageFormatForExtension(path.ext());
+    if (!format) {
+        return DecodeResult::err(std::string("Unsupported image format"));
+    }
+    if (request.source == DecodeRequest::Source::Asset) {
+        if (request.bundle == nullptr) {
+            return DecodeResult::err(std::string("Asset decode requests need a bundle"));
+        }
+        return loadAssetAs(*request.bundle, path, *format, request.options);
+    }
+    return loadFileAs(path, *format, request.options);
+}
+
+Vector<Async<DecodeResult>> decodeBatch(const Vector<DecodeRequest> & requests, TaskScheduler & scheduler) {
+    Vector<Async<DecodeResult>> results;
+    results.reserve(requests.size());
+    for (const auto & request : requests) {
+        results.push_back(scheduler.async([request]() {
+            return decodeRequest(request);
+        }));
+    }
+    return results;
+}
+
+Vector<Async<DecodeResult>> decodeBatch(const Vector<DecodeRequest> & requests) {
+    return decodeBatch(requests, TaskScheduler::shared());
+}
+
 }
@@ -4,6 +4,8 @@
 #include "omega-common/img.h"
 
 #include <istream>
+#include <memory>
+#include <vector>
 
 namespace OmegaCommon::Img {
 
@@ -19,16 +21,128 @@ namespace OmegaCommon::Img {
 #define DEFAULT_SCREEN_GAMMA 2.2
 #endif
 
+    /// Per-thread scratch buffers survive between decodes so a pool worker
+    /// running a batch does not reallocate them for every image. Anything that
+    /// grew past this is released once the decode finishes.
+    constexpr std::size_t kRetainedScratchBytes = 16 * 1024 * 1024;
+
+    template<class T>
+    inline void trimScratch(Vector<T> & buffer) {
+        if (buffer.capacity() * sizeof(T) > kRetainedScratchBytes) {
+            Vector<T>().swap(buffer);
+        }
+    }
+
     class ImgCodec {
     protected:
         std::istream & in;
         BitmapImage * storage;
+        const DecodeOptions & options;
     public:
         virtual void readToStorage() = 0;
-        ImgCodec(std::istream & _in, BitmapImage * res) : in(_in), storage(res) {};
+        ImgCodec(std::istream & _in, BitmapImage * res, const DecodeOptions & _options) : in(_in), storage(res), options(_options) {};
         virtual ~ImgCodec() {};
     };
 
+    /// Applies DecodeOptions to 8-bit RGB/RGBA/BGRA rows arriving top to bottom:
+    /// crops to the region, box-filters by a whole reduction factor, converts the
+    /// layout, and writes the result bottom row first into its own storage (or
+    /// into a destination set before the first row). Only the region's rows
+    /// need to be pushed.
+    class DecodeTarget {
+        std::uint32_t srcWidth;
+        ColorFormat srcFormat;
+        AlphaFormat srcAlpha;
+        Region region;
+        std::uint32_t factor = 1;
+        ColorFormat dstFormat;
+        std::uint32_t outWidth = 0;
+        std::uint32_t outHeight = 0;
+        PixelStorage pixels;
+        Byte * dst = nullptr;
+        std::size_t dstStride = 0;
+        bool dstTopDown = false;
+        Vector<Byte> scratch;
+        /// Per output pixel of the row being filtered: alpha-weighted colour sums and alpha sum.
+        Vector<std::uint64_t> sums;
+        std::uint32_t rowsInBlock = 0;
+        std::uint32_t rowsDone = 0;
+        bool valid = false;
+
+        Byte * outputRow(std::uint32_t outRow);
+        void emitBlock(std::uint32_t outRow);
+    public:
+        /// @p format must be RGB, RGBA or BGRA.
+        DecodeTarget(const DecodeOptions & options, std::uint32_t width, std::uint32_t height,
+                     ColorFormat format, AlphaFormat alpha);
+
+        /// Reduction factor that keeps @p size at least @p target (0 = unconstrained).
+        static std::uint32_t reductionFor(std::uint32_t size, std::uint32_t target);
+        static int channelsOf(ColorFormat format);
+        static ColorFormat formatFor(PixelFormat requested, ColorFormat native);
+
+        /// False if the region misses the image or the layout is unsupported.
+        bool ok() const { return valid; }
+        std::uint32_t firstRow() const { return region.y; }
+        std::uint32_t endRow() const { return region.y + region.height; }
+        /// Rows map 1:1 onto the output (no column crop, reduction or layout
+        /// change), so rowBuffer() points straight into it.
+        bool passthrough() const;
+
+        /// Where the decoder should write source row @p y (top-down, full source
+        /// width). Points straight into the output when no processing is needed.
+        Byte * rowBuffer(std::uint32_t y);
+        /// Consume the row written into rowBuffer(@p y). Rows must arrive in order.
+        void pushRow(std::uint32_t y);
+        /// Copy source row @p y from @p row, then push it.
+        void pushRow(std::uint32_t y, const Byte * row);
+
+        /// Write output rows at @p stride into @p data instead of allocating.
+        void setDestination(Byte * data, std::size_t stride, bool topDown);
+        /// Output rows (from the top) written so far in this pass.
+        std::uint32_t completedRows() const { return rowsDone; }
+        /// Start over from the region's first row, e.g. for another progressive pass.
+        void beginPass();
+
+        /// The output header. @p base supplies the source header fields that
+        /// survive decoding (compression, interlace).
+        Header outputHeader(const Header & base) const;
+        /// Move the output into @p img (which gets no pixels if a destination was set).
+        void finish(BitmapImage & img, const Header & base);
+    };
+
+    /// State shared by the per-format IncrementalDecoder implementations: the
+    /// DecodeTarget, the caller's destination and progress reporting.
+    class IncrementalDecoderBase : public IncrementalDecoder {
+    protected:
+        DecodeOptions options;
+        std::unique_ptr<DecodeTarget> target;
+        unsigned pass = 0;
+        std::uint32_t reportedRows = 0;
+
+        explicit IncrementalDecoderBase(const DecodeOptions & options) : options(options) {}
+
+        /// Create the target for rows of the given source layout, announce the
+        /// header and bind the destination. False if the options cannot apply.
+        bool beginOutput(const DecodeOptions & effective, std::uint32_t width, std::uint32_t height,
+                         ColorFormat format, AlphaFormat alpha, const Header & base);
+        /// Start refinement pass @p number over the whole output.
+        void beginPass(unsigned number);
+        /// Report rows the target completed since the last report.
+        void reportRows(bool finalPass);
+        /// All rows are final: report them and hand over decoder-owned output.
+        void complete(const Header & base);
+        Result<State, std::string> fail(std::string message);
+    };
+
+    /// Convert @p count pixels between the 8-bit RGB, RGBA and BGRA layouts
+    /// with the vector kernels (PixelConvert.cpp). In place only between the
+    /// 4-channel layouts.
+    void convertPixels(const Byte * src, ColorFormat from, Byte * dst, ColorFormat to, std::size_t count);
+
+    std::unique_ptr<IncrementalDecoder> makePngIncrementalDecoder(const DecodeOptions & options);
+    std::unique_ptr<IncrementalDecoder> makeJpegIncrementalDecoder(const DecodeOptions & options);
+
 }
 
 #endif
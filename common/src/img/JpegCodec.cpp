@@ -1,11 +1,53 @@
 #include "ImgCodecPriv.h"
 
+#include <algorithm>
+#include <csetjmp>
+#include <cstdio>
 #include <memory>
 
 #include <turbojpeg.h>
+#include <jpeglib.h>
 
 namespace OmegaCommon::Img {
 
+    /// turbojpeg handles and the compressed-data staging buffer of the calling
+    /// thread, created on first use and kept until the thread exits.
+    struct TurboJpegContext {
+        tjhandle decompressor = nullptr;
+        tjhandle transformer = nullptr;
+        Vector<Byte> encoded;
+        /// Decompressed rows that still need cropping, reduction or conversion.
+        Vector<Byte> decoded;
+
+        static TurboJpegContext & current() {
+            static thread_local TurboJpegContext context;
+            return context;
+        }
+
+        tjhandle getDecompressor() {
+            if (decompressor == nullptr) {
+                decompressor = tjInitDecompress();
+            }
+            return decompressor;
+        }
+
+        tjhandle getTransformer() {
+            if (transformer == nullptr) {
+                transformer = tjInitTransform();
+            }
+            return transformer;
+        }
+
+        ~TurboJpegContext() {
+            if (decompressor != nullptr) {
+                tjDestroy(decompressor);
+            }
+            if (transformer != nullptr) {
+                tjDestroy(transformer);
+            }
+        }
+    };
+
     class JPEGCodec : public ImgCodec {
         typedef unsigned char tjByte;
         bool load_jpeg_from_file() {
@@ -17,50 +59,157 @@ namespace OmegaCommon::Img {
             }
             std::size_t len = static_cast<std::size_t>(endPos);
 
-            auto dataBuf = std::make_unique<tjByte[]>(len);
-            in.read(reinterpret_cast<char *>(dataBuf.get()), static_cast<std::streamsize>(len));
-            if (static_cast<std::size_t>(in.gcount()) != len) {
-                return false;
+            TurboJpegContext & context = TurboJpegContext::current();
+            context.encoded.resize(len);
+            in.read(reinterpret_cast<char *>(context.encoded.data()), static_cast<std::streamsize>(len));
+            bool rc = static_cast<std::size_t>(in.gcount()) == len;
+
+            auto decomp = context.getDecompressor();
+            rc = rc && decomp != nullptr && decode(context, decomp, context.encoded.data(), static_cast<unsigned long>(len));
+            trimScratch(context.encoded);
+            return rc;
+        }
+
+        static int pixelFormatFor(ColorFormat format) {
+            switch (format) {
+                case ColorFormat::BGRA:
+                    return TJPF_BGRA;
+                case ColorFormat::RGB:
+                    return TJPF_RGB;
+                default:
+                    return TJPF_RGBA;
             }
+        }
 
-            auto decomp = tjInitDecompress();
-            if (decomp == nullptr) {
-                return false;
+        /// Smallest DCT scaling factor (at most 1/1) that keeps a @p width x
+        /// @p height region at least as large as the requested target.
+        tjscalingfactor scalingFor(int width, int height) const {
+            tjscalingfactor best{1, 1};
+            if (options.targetWidth == 0 && options.targetHeight == 0) {
+                return best;
+            }
+            int count = 0;
+            tjscalingfactor * factors = tjGetScalingFactors(&count);
+            for (int i = 0; factors != nullptr && i < count; i++) {
+                const tjscalingfactor sf = factors[i];
+                if (sf.num > sf.denom) {
+                    continue;
+                }
+                const int w = TJSCALED(width, sf);
+                const int h = TJSCALED(height, sf);
+                if ((options.targetWidth != 0 && w < static_cast<int>(options.targetWidth)) ||
+                    (options.targetHeight != 0 && h < static_cast<int>(options.targetHeight))) {
+                    continue;
+                }
+                if (w < TJSCALED(width, best)) {
+                    best = sf;
+                }
             }
+            return best;
+        }
 
+        bool decode(TurboJpegContext & context, tjhandle decomp, tjByte * jpeg, unsigned long jpegSize) {
             int w = 0, h = 0;
             int samp = 0;
             int colorspace = 0;
-            if (tjDecompressHeader3(decomp, dataBuf.get(), static_cast<unsigned long>(len), &w, &h, &samp, &colorspace) != 0) {
-                tjDestroy(decomp);
+            if (tjDecompressHeader3(decomp, jpeg, jpegSize, &w, &h, &samp, &colorspace) != 0 || w <= 0 || h <= 0) {
                 return false;
             }
 
-            const std::size_t stride = static_cast<std::size_t>(w) * 4;
-            const std::size_t pixelBytes = stride * static_cast<std::size_t>(h);
-            PixelStorage pixels = PixelStorage::allocate(pixelBytes);
-            if (tjDecompress2(decomp, dataBuf.get(), static_cast<unsigned long>(len),
-                              pixels.data(), w, static_cast<int>(stride), h,
-                              TJPF_RGBA, TJFLAG_BOTTOMUP | TJFLAG_ACCURATEDCT) != 0) {
-                tjDestroy(decomp);
-                return false;
+            Region region{0, 0, static_cast<std::uint32_t>(w), static_cast<std::uint32_t>(h)};
+            if (options.region) {
+                const Region & r = *options.region;
+                if (r.x >= region.width || r.y >= region.height || r.width == 0 || r.height == 0) {
+                    return false;
+                }
+                region = Region{r.x, r.y, std::min(r.width, region.width - r.x), std::min(r.height, region.height - r.y)};
             }
 
-            tjDestroy(decomp);
+            // Crop losslessly to the iMCU blocks covering the region so only
+            // those are entropy-decoded and IDCT'd; the sub-block remainder is
+            // trimmed after decompression.
+            tjByte * cropped = nullptr;
+            unsigned long croppedSize = 0;
+            std::uint32_t residualX = region.x;
+            std::uint32_t residualY = region.y;
+            const bool wholeImage = region.width == static_cast<std::uint32_t>(w) &&
+                                    region.height == static_cast<std::uint32_t>(h);
+            if (!wholeImage && samp >= 0 && samp < TJ_NUMSAMP) {
+                const auto mcuW = static_cast<std::uint32_t>(tjMCUWidth[samp]);
+                const auto mcuH = static_cast<std::uint32_t>(tjMCUHeight[samp]);
+                tjtransform xform{};
+                xform.r.x = static_cast<int>(region.x / mcuW * mcuW);
+                xform.r.y = static_cast<int>(region.y / mcuH * mcuH);
+                xform.r.w = static_cast<int>(region.x + region.width) - xform.r.x;
+                xform.r.h = static_cast<int>(region.y + region.height) - xform.r.y;
+                xform.op = TJXOP_NONE;
+                xform.options = TJXOPT_CROP;
+                tjhandle transformer = context.getTransformer();
+                const bool transformed = transformer != nullptr &&
+                    tjTransform(transformer, jpeg, jpegSize, 1, &cropped, &croppedSize, &xform, 0) == 0 &&
+                    tjDecompressHeader3(decomp, cropped, croppedSize, &w, &h, &samp, &colorspace) == 0;
+                if (transformed) {
+                    jpeg = cropped;
+                    jpegSize = croppedSize;
+                    residualX = region.x - static_cast<std::uint32_t>(xform.r.x);
+                    residualY = region.y - static_cast<std::uint32_t>(xform.r.y);
+                } else {
+                    // Progressive or otherwise untransformable: decode whole.
+                    tjFree(cropped);
+                    cropped = nullptr;
+                }
+            }
+
+            const tjscalingfactor sf = scalingFor(static_cast<int>(region.width), static_cast<int>(region.height));
+            const int scaledW = TJSCALED(w, sf);
+            const int scaledH = TJSCALED(h, sf);
+
+            // What is left after cropping and DCT scaling: the sub-block
+            // remainder of the region and any further whole-factor reduction.
+            DecodeOptions rest;
+            Region scaledRegion{};
+            scaledRegion.x = static_cast<std::uint32_t>(static_cast<std::uint64_t>(residualX) * sf.num / sf.denom);
+            scaledRegion.y = static_cast<std::uint32_t>(static_cast<std::uint64_t>(residualY) * sf.num / sf.denom);
+            scaledRegion.width = static_cast<std::uint32_t>(TJSCALED(static_cast<int>(region.width), sf));
+            scaledRegion.height = static_cast<std::uint32_t>(TJSCALED(static_cast<int>(region.height), sf));
+            rest.region = scaledRegion;
+            rest.targetWidth = options.targetWidth;
+            rest.targetHeight = options.targetHeight;
+
+            const ColorFormat format = DecodeTarget::formatFor(options.pixelFormat, ColorFormat::RGBA);
+            const int channels = DecodeTarget::channelsOf(format);
+            DecodeTarget target(rest, static_cast<std::uint32_t>(scaledW), static_cast<std::uint32_t>(scaledH),
+                                format, AlphaFormat::Ignore);
+            bool rc = target.ok();
+            if (rc) {
+                const std::size_t stride = static_cast<std::size_t>(scaledW) * static_cast<std::size_t>(channels);
+                if (target.passthrough() && target.firstRow() == 0 && target.endRow() == static_cast<std::uint32_t>(scaledH)) {
+                    // Straight into the output, bottom row first.
+                    rc = tjDecompress2(decomp, jpeg, jpegSize, target.rowBuffer(target.endRow() - 1), scaledW,
+                                       static_cast<int>(stride), scaledH, pixelFormatFor(format),
+                                       TJFLAG_BOTTOMUP | TJFLAG_ACCURATEDCT) == 0;
+                } else {
+                    Vector<Byte> & scaled = context.decoded;
+                    scaled.resize(stride * static_cast<std::size_t>(scaledH));
+                    rc = tjDecompress2(decomp, jpeg, jpegSize, scaled.data(), scaledW, static_cast<int>(stride),
+                                       scaledH, pixelFormatFor(format), TJFLAG_ACCURATEDCT) == 0;
+                    for (std::uint32_t y = target.firstRow(); rc && y < target.endRow(); y++) {
+                        target.pushRow(y, scaled.data() + stride * y);
+                    }
+                    trimScratch(scaled);
+                }
+            }
+            if (cropped != nullptr) {
+                tjFree(cropped);
+            }
+            if (!rc) {
+                return false;
+            }
 
             Header header{};
-            header.width = static_cast<std::uint32_t>(w);
-            header.height = static_cast<std::uint32_t>(h);
-            header.channels = 4;
-            header.bitDepth = 8;
             header.compression_method = 0;
             header.interlace_type = 0;
-            header.color_format = ColorFormat::RGBA;
-            header.alpha_format = AlphaFormat::Ignore;
-            header.stride = stride;
-
-            storage->pixels = std::move(pixels);
-            storage->header = header;
+            target.finish(*storage, header);
             storage->sRGB = false;
             storage->hasGamma = false;
             storage->gamma = 0.0;
@@ -72,11 +221,322 @@ namespace OmegaCommon::Img {
                 storage->pixels.reset();
             }
         }
-        JPEGCodec(std::istream & stream, BitmapImage * res) : ImgCodec(stream, res) {}
+        JPEGCodec(std::istream & stream, BitmapImage * res, const DecodeOptions & options) : ImgCodec(stream, res, options) {}
+    };
+
+    /// Push-mode decoder on the libjpeg API (built into the turbojpeg archive)
+    /// with a suspending data source. Sequential images produce rows as their
+    /// data arrives. Progressive and other multi-scan images run in
+    /// buffered-image mode: every completed scan is shown over the whole
+    /// image as a new pass, and the last one is final.
+    class JpegIncrementalDecoder : public IncrementalDecoderBase {
+        struct ErrorManager {
+            jpeg_error_mgr base;
+            std::jmp_buf jump;
+            char message[JMSG_LENGTH_MAX];
+        };
+
+        enum class Stage : std::uint8_t {
+            Header,
+            StartDecompress,
+            Scanlines,
+            Absorb,
+            StartOutput,
+            OutputScanlines,
+            FinishOutput,
+            Done
+        };
+
+        jpeg_decompress_struct cinfo{};
+        ErrorManager jerr{};
+        jpeg_source_mgr source{};
+        bool created = false;
+        Stage stage = Stage::Header;
+        /// Bytes not yet consumed by libjpeg; source points into it.
+        Vector<Byte> input;
+        std::size_t skipPending = 0;
+        Vector<Byte> scanline;
+        std::uint32_t endScanline = 0;
+        int displayScan = 0;
+        bool newScan = false;
+        bool finalOutput = false;
+
+        static void onError(j_common_ptr common) {
+            auto * err = reinterpret_cast<ErrorManager *>(common->err);
+            (*common->err->format_message)(common, err->message);
+            std::longjmp(err->jump, 1);
+        }
+
+        static void onMessage(j_common_ptr) {}
+
+        static void initSource(j_decompress_ptr) {}
+        static void termSource(j_decompress_ptr) {}
+
+        /// Out of data: suspend until the next feed().
+        static boolean fillInput(j_decompress_ptr) {
+            return FALSE;
+        }
+
+        static void skipInput(j_decompress_ptr info, long count) {
+            if (count <= 0) {
+                return;
+            }
+            auto * self = static_cast<JpegIncrementalDecoder *>(info->client_data);
+            const auto n = static_cast<std::size_t>(count);
+            if (n <= info->src->bytes_in_buffer) {
+                info->src->next_input_byte += n;
+                info->src->bytes_in_buffer -= n;
+            } else {
+                self->skipPending += n - info->src->bytes_in_buffer;
+                info->src->next_input_byte += info->src->bytes_in_buffer;
+                info->src->bytes_in_buffer = 0;
+            }
+        }
+
+        /// Drop what libjpeg consumed (and any pending skip), then append @p data.
+        void append(const Byte * data, std::size_t size) {
+            if (source.next_input_byte != nullptr) {
+                input.erase(input.begin(), input.begin() + (source.next_input_byte - input.data()));
+            }
+            const std::size_t skipped = std::min(skipPending, size);
+            skipPending -= skipped;
+            input.insert(input.end(), data + skipped, data + size);
+            source.next_input_byte = input.data();
+            source.bytes_in_buffer = input.size();
+        }
+
+        J_COLOR_SPACE colorSpaceFor(ColorFormat format) const {
+            switch (format) {
+                case ColorFormat::BGRA:
+                    return JCS_EXT_BGRA;
+                case ColorFormat::RGB:
+                    return JCS_RGB;
+                default:
+                    return JCS_EXT_RGBA;
+            }
+        }
+
+        /// Set up scaling and the target once the header is in. False if the
+        /// options cannot apply.
+        bool beginImage() {
+            Region region{0, 0, cinfo.image_width, cinfo.image_height};
+            if (options.region) {
+                const Region & r = *options.region;
+                if (r.x >= region.width || r.y >= region.height || r.width == 0 || r.height == 0) {
+                    return false;
+                }
+                region = Region{r.x, r.y, std::min(r.width, region.width - r.x), std::min(r.height, region.height - r.y)};
+            }
+
+            // Smallest DCT scaling (n/8, at most 1/1) that keeps the region at
+            // least as large as the requested target.
+            unsigned scale = 8;
+            const bool targeted = options.targetWidth != 0 || options.targetHeight != 0;
+            for (unsigned n = 1; targeted && n < 8; n++) {
+                const std::uint64_t w = (static_cast<std::uint64_t>(region.width) * n + 7) / 8;
+                const std::uint64_t h = (static_cast<std::uint64_t>(region.height) * n + 7) / 8;
+                if ((options.targetWidth == 0 || w >= options.targetWidth) &&
+                    (options.targetHeight == 0 || h >= options.targetHeight)) {
+                    scale = n;
+                    break;
+                }
+            }
+
+            const ColorFormat format = DecodeTarget::formatFor(options.pixelFormat, ColorFormat::RGBA);
+            cinfo.out_color_space = colorSpaceFor(format);
+            cinfo.scale_num = scale;
+            cinfo.scale_denom = 8;
+            cinfo.dct_method = JDCT_ISLOW;
+            cinfo.buffered_image = jpeg_has_multiple_scans(&cinfo);
+            jpeg_calc_output_dimensions(&cinfo);
+
+            DecodeOptions rest;
+            Region scaledRegion{};
+            scaledRegion.x = static_cast<std::uint32_t>(static_cast<std::uint64_t>(region.x) * scale / 8);
+            scaledRegion.y = static_cast<std::uint32_t>(static_cast<std::uint64_t>(region.y) * scale / 8);
+            scaledRegion.width = static_cast<std::uint32_t>((static_cast<std::uint64_t>(region.width) * scale + 7) / 8);
+            scaledRegion.height = static_cast<std::uint32_t>((static_cast<std::uint64_t>(region.height) * scale + 7) / 8);
+            rest.region = scaledRegion;
+            rest.targetWidth = options.targetWidth;
+            rest.targetHeight = options.targetHeight;
+            rest.pixelFormat = options.pixelFormat;
+
+            Header base{};
+            if (!beginOutput(rest, cinfo.output_width, cinfo.output_height, format, AlphaFormat::Ignore, base)) {
+                return false;
+            }
+            scanline.resize(static_cast<std::size_t>(cinfo.output_width) *
+                            static_cast<std::size_t>(DecodeTarget::channelsOf(format)));
+            endScanline = target->endRow();
+            image_.sRGB = false;
+            image_.hasGamma = false;
+            image_.gamma = 0.0;
+            return true;
+        }
+
+        /// Read scanlines until the region's last row or until data runs out.
+        bool readRows() {
+            JSAMPROW row = scanline.data();
+            while (cinfo.output_scanline < endScanline) {
+                if (jpeg_read_scanlines(&cinfo, &row, 1) == 0) {
+                    return false;
+                }
+                target->pushRow(cinfo.output_scanline - 1, scanline.data());
+            }
+            return true;
+        }
+
+        /// Advance as far as the buffered input allows. Runs under setjmp.
+        void run() {
+            while (true) {
+                switch (stage) {
+                    case Stage::Header:
+                        if (jpeg_read_header(&cinfo, TRUE) == JPEG_SUSPENDED) {
+                            return;
+                        }
+                        if (!beginImage()) {
+                            std::snprintf(jerr.message, sizeof(jerr.message), "Unsupported JPEG decode options");
+                            std::longjmp(jerr.jump, 1);
+                        }
+                        stage = Stage::StartDecompress;
+                        break;
+                    case Stage::StartDecompress:
+                        if (!jpeg_start_decompress(&cinfo)) {
+                            return;
+                        }
+                        stage = cinfo.buffered_image ? Stage::Absorb : Stage::Scanlines;
+                        break;
+                    case Stage::Scanlines: {
+                        const bool done = readRows();
+                        reportRows(true);
+                        if (!done) {
+                            return;
+                        }
+                        complete(Header{});
+                        stage = Stage::Done;
+                        return;
+                    }
+                    case Stage::Absorb: {
+                        int status = JPEG_SUSPENDED;
+                        do {
+                            status = jpeg_consume_input(&cinfo);
+                            if (status == JPEG_SCAN_COMPLETED) {
+                                newScan = true;
+                                displayScan = cinfo.input_scan_number;
+                            }
+                        } while (status != JPEG_SUSPENDED && status != JPEG_REACHED_EOI);
+                        if (status == JPEG_REACHED_EOI) {
+                            displayScan = cinfo.input_scan_number;
+                        } else if (!newScan) {
+                            return;
+                        }
+                        stage = Stage::StartOutput;
+                        break;
+                    }
+                    case Stage::StartOutput:
+                        finalOutput = jpeg_input_complete(&cinfo) != 0;
+                        if (!jpeg_start_output(&cinfo, displayScan)) {
+                            return;
+                        }
+                        newScan = false;
+                        beginPass(pass + 1);
+                        stage = Stage::OutputScanlines;
+                        break;
+                    case Stage::OutputScanlines: {
+                        const bool done = readRows();
+                        reportRows(finalOutput);
+                        if (!done) {
+                            return;
+                        }
+                        if (finalOutput) {
+                            complete(Header{});
+                            stage = Stage::Done;
+                            return;
+                        }
+                        stage = Stage::FinishOutput;
+                        break;
+                    }
+                    case Stage::FinishOutput:
+                        if (!jpeg_finish_output(&cinfo)) {
+                            return;
+                        }
+                        stage = Stage::Absorb;
+                        break;
+                    case Stage::Done:
+                        return;
+                }
+            }
+        }
+
+        void destroy() {
+            if (created) {
+                jpeg_destroy_decompress(&cinfo);
+                created = false;
+            }
+            Vector<Byte>().swap(input);
+        }
+
+        Result<State, std::string> step(const Byte * data, std::size_t size) {
+            if (setjmp(jerr.jump)) {
+                std::string message(jerr.message);
+                destroy();
+                stage = Stage::Done;
+                return fail(std::move(message));
+            }
+            if (!created) {
+                cinfo.err = jpeg_std_error(&jerr.base);
+                jerr.base.error_exit = onError;
+                jerr.base.output_message = onMessage;
+                jpeg_create_decompress(&cinfo);
+                created = true;
+                cinfo.client_data = this;
+                source.init_source = initSource;
+                source.fill_input_buffer = fillInput;
+                source.skip_input_data = skipInput;
+                source.resync_to_restart = jpeg_resync_to_restart;
+                source.term_source = termSource;
+                cinfo.src = &source;
+            }
+            append(data, size);
+            run();
+            if (state_ == State::Complete) {
+                destroy();
+            }
+            return Result<State, std::string>::ok(state_);
+        }
+    public:
+        explicit JpegIncrementalDecoder(const DecodeOptions & options) : IncrementalDecoderBase(options) {}
+
+        Result<State, std::string> feed(const Byte * data, std::size_t size) override {
+            if (state_ == State::Complete) {
+                return Result<State, std::string>::ok(state_);
+            }
+            if (stage == Stage::Done) {
+                return Result<State, std::string>::err(std::string("JPEG decoder failed"));
+            }
+            return step(data, size);
+        }
+
+        Result<State, std::string> finish() override {
+            if (state_ == State::Complete) {
+                return Result<State, std::string>::ok(state_);
+            }
+            destroy();
+            stage = Stage::Done;
+            return fail("Truncated JPEG data");
+        }
+
+        ~JpegIncrementalDecoder() override {
+            destroy();
+        }
     };
 
-    std::unique_ptr<ImgCodec> getJpegCodec(std::istream & in, BitmapImage * img) {
-        return std::make_unique<JPEGCodec>(in, img);
+    std::unique_ptr<ImgCodec> getJpegCodec(std::istream & in, BitmapImage * img, const DecodeOptions & options) {
+        return std::make_unique<JPEGCodec>(in, img, options);
+    }
+
+    std::unique_ptr<IncrementalDecoder> makeJpegIncrementalDecoder(const DecodeOptions & options) {
+        return std::make_unique<JpegIncrementalDecoder>(options);
     }
 
 }
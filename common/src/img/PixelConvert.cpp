@@ -0,0 +1,629 @@
+#include "ImgCodecPriv.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__)) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OMEGA_IMG_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define OMEGA_IMG_AVX2
+#else
+#define OMEGA_IMG_AVX2 __attribute__((target("avx2")))
+#endif
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define OMEGA_IMG_NEON 1
+#include <arm_neon.h>
+#if defined(__aarch64__) || defined(_M_ARM64)
+#define OMEGA_IMG_NEON64 1
+#endif
+#endif
+
+namespace OmegaCommon::Img {
+
+namespace {
+
+    // Scalar kernels. They define the exact results; every vector kernel
+    // below matches them bit for bit and leaves its tail to them.
+
+    /// Round-to-nearest x / 255 for x in [0, 255 * 255].
+    inline Byte div255(unsigned x) {
+        x += 128;
+        return static_cast<Byte>((x + (x >> 8)) >> 8);
+    }
+
+    void swizzleScalar(const Byte * src, Byte * dst, std::size_t count) {
+        for (std::size_t i = 0; i < count; i++, src += 4, dst += 4) {
+            const Byte r = src[0], g = src[1], b = src[2], a = src[3];
+            dst[0] = b; dst[1] = g; dst[2] = r; dst[3] = a;
+        }
+    }
+
+    void expandRGBScalar(const Byte * src, Byte * dst, std::size_t count) {
+        for (std::size_t i = 0; i < count; i++, src += 3, dst += 4) {
+            dst[0] = src[0]; dst[1] = src[1]; dst[2] = src[2]; dst[3] = 0xFF;
+        }
+    }
+
+    void premultiplyScalar(const Byte * src, Byte * dst, std::size_t count) {
+        for (std::size_t i = 0; i < count; i++, src += 4, dst += 4) {
+            const unsigned a = src[3];
+            dst[0] = div255(src[0] * a);
+            dst[1] = div255(src[1] * a);
+            dst[2] = div255(src[2] * a);
+            dst[3] = static_cast<Byte>(a);
+        }
+    }
+
+    void unpremultiplyScalar(const Byte * src, Byte * dst, std::size_t count) {
+        for (std::size_t i = 0; i < count; i++, src += 4, dst += 4) {
+            const unsigned a = src[3];
+            if (a == 0) {
+                dst[0] = dst[1] = dst[2] = dst[3] = 0;
+                continue;
+            }
+            for (int c = 0; c < 3; c++) {
+                dst[c] = static_cast<Byte>(std::min(255u, (src[c] * 255u + a / 2) / a));
+            }
+            dst[3] = static_cast<Byte>(a);
+        }
+    }
+
+    void narrowScalar(const std::uint16_t * src, Byte * dst, std::size_t count) {
+        // (v * 255 + 32767) / 65535, in the form the vector kernels use.
+        for (std::size_t i = 0; i < count; i++) {
+            const std::uint32_t high = (static_cast<std::uint32_t>(src[i]) * 0xFF01u) >> 16;
+            dst[i] = static_cast<Byte>((high + 128) >> 8);
+        }
+    }
+
+    void expandGrayScalar(const Byte * src, Byte * dst, std::size_t count) {
+        for (std::size_t i = 0; i < count; i++, dst += 4) {
+            dst[0] = dst[1] = dst[2] = src[i];
+            dst[3] = 0xFF;
+        }
+    }
+
+    void expandGrayAlphaScalar(const Byte * src, Byte * dst, std::size_t count) {
+        for (std::size_t i = 0; i < count; i++, src += 2, dst += 4) {
+            dst[0] = dst[1] = dst[2] = src[0];
+            dst[3] = src[1];
+        }
+    }
+
+    /// sRGB transfer function, decoded once for every 8-bit value. A table
+    /// lookup beats evaluating pow() in any vector width.
+    const float * srgbTable() {
+        static const auto table = []() {
+            std::array<float, 256> values{};
+            for (int i = 0; i < 256; i++) {
+                const double c = i / 255.0;
+                values[i] = static_cast<float>(c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4));
+            }
+            return values;
+        }();
+        return table.data();
+    }
+
+#if defined(OMEGA_IMG_X86)
+
+    bool hasAvx2() {
+        static const bool supported = []() {
+#if defined(OMEGA_IMG_NO_AVX2)
+            return false;
+#elif defined(_MSC_VER) && !defined(__clang__)
+            int info[4];
+            __cpuid(info, 1);
+            const bool osxsave = (info[2] & (1 << 27)) != 0;
+            if (!osxsave || (_xgetbv(0) & 0x6) != 0x6) {
+                return false;
+            }
+            __cpuidex(info, 7, 0);
+            return (info[1] & (1 << 5)) != 0;
+#else
+            return __builtin_cpu_supports("avx2") != 0;
+#endif
+        }();
+        return supported;
+    }
+
+    // SSE2 is the x86-64 baseline. Each kernel handles whole blocks and
+    // returns how many pixels it converted.
+
+    std::size_t swizzleSse2(const Byte * src, Byte * dst, std::size_t count) {
+        const __m128i ag = _mm_set1_epi32(static_cast<int>(0xFF00FF00u));
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 4));
+            const __m128i rb = _mm_andnot_si128(ag, x);
+            const __m128i br = _mm_or_si128(_mm_slli_epi32(rb, 16), _mm_srli_epi32(rb, 16));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4), _mm_or_si128(_mm_and_si128(ag, x), br));
+        }
+        return i;
+    }
+
+    inline __m128i premultiplyLanes(__m128i px, __m128i colorMask, __m128i alphaOne) {
+        __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(px, 0xFF), 0xFF);
+        a = _mm_or_si128(_mm_and_si128(a, colorMask), alphaOne);
+        __m128i t = _mm_add_epi16(_mm_mullo_epi16(px, a), _mm_set1_epi16(128));
+        return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+    }
+
+    std::size_t premultiplySse2(const Byte * src, Byte * dst, std::size_t count) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i colorMask = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+        const __m128i alphaOne = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 4));
+            const __m128i lo = premultiplyLanes(_mm_unpacklo_epi8(x, zero), colorMask, alphaOne);
+            const __m128i hi = premultiplyLanes(_mm_unpackhi_epi8(x, zero), colorMask, alphaOne);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4), _mm_packus_epi16(lo, hi));
+        }
+        return i;
+    }
+
+    /// One pixel as four int32 lanes.
+    inline __m128i unpremultiplyPixel(__m128i px) {
+        const __m128 f = _mm_cvtepi32_ps(px);
+        const __m128 a = _mm_shuffle_ps(f, f, 0xFF);
+        // 0/0 and c/0 are masked out below; min() turns NaN into 255 first.
+        __m128 q = _mm_div_ps(_mm_mul_ps(f, _mm_set1_ps(255.0f)), a);
+        q = _mm_min_ps(_mm_add_ps(q, _mm_set1_ps(0.5f)), _mm_set1_ps(255.0f));
+        __m128i out = _mm_cvttps_epi32(q);
+        const __m128i alphaLane = _mm_set_epi32(-1, 0, 0, 0);
+        out = _mm_or_si128(_mm_andnot_si128(alphaLane, out), _mm_and_si128(alphaLane, px));
+        return _mm_andnot_si128(_mm_castps_si128(_mm_cmpeq_ps(a, _mm_setzero_ps())), out);
+    }
+
+    std::size_t unpremultiplySse2(const Byte * src, Byte * dst, std::size_t count) {
+        const __m128i zero = _mm_setzero_si128();
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 4));
+            const __m128i lo = _mm_unpacklo_epi8(x, zero);
+            const __m128i hi = _mm_unpackhi_epi8(x, zero);
+            const __m128i p0 = unpremultiplyPixel(_mm_unpacklo_epi16(lo, zero));
+            const __m128i p1 = unpremultiplyPixel(_mm_unpackhi_epi16(lo, zero));
+            const __m128i p2 = unpremultiplyPixel(_mm_unpacklo_epi16(hi, zero));
+            const __m128i p3 = unpremultiplyPixel(_mm_unpackhi_epi16(hi, zero));
+            const __m128i packed = _mm_packus_epi16(_mm_packs_epi32(p0, p1), _mm_packs_epi32(p2, p3));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4), packed);
+        }
+        return i;
+    }
+
+    std::size_t narrowSse2(const std::uint16_t * src, Byte * dst, std::size_t count) {
+        const __m128i scale = _mm_set1_epi16(static_cast<short>(0xFF01));
+        const __m128i half = _mm_set1_epi16(128);
+        std::size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 8));
+            a = _mm_srli_epi16(_mm_add_epi16(_mm_mulhi_epu16(a, scale), half), 8);
+            b = _mm_srli_epi16(_mm_add_epi16(_mm_mulhi_epu16(b, scale), half), 8);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_packus_epi16(a, b));
+        }
+        return i;
+    }
+
+    std::size_t expandGraySse2(const Byte * src, Byte * dst, std::size_t count) {
+        const __m128i opaque = _mm_set1_epi8(static_cast<char>(0xFF));
+        std::size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            const __m128i g = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+            const __m128i ggLo = _mm_unpacklo_epi8(g, g);
+            const __m128i ggHi = _mm_unpackhi_epi8(g, g);
+            const __m128i gaLo = _mm_unpacklo_epi8(g, opaque);
+            const __m128i gaHi = _mm_unpackhi_epi8(g, opaque);
+            auto * out = reinterpret_cast<__m128i *>(dst + i * 4);
+            _mm_storeu_si128(out, _mm_unpacklo_epi16(ggLo, gaLo));
+            _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(ggLo, gaLo));
+            _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(ggHi, gaHi));
+            _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(ggHi, gaHi));
+        }
+        return i;
+    }
+
+    std::size_t expandGrayAlphaSse2(const Byte * src, Byte * dst, std::size_t count) {
+        const __m128i low = _mm_set1_epi16(0x00FF);
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            const __m128i ga = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 2));
+            const __m128i g = _mm_and_si128(ga, low);
+            const __m128i gg = _mm_or_si128(g, _mm_slli_epi16(g, 8));
+            auto * out = reinterpret_cast<__m128i *>(dst + i * 4);
+            _mm_storeu_si128(out, _mm_unpacklo_epi16(gg, ga));
+            _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(gg, ga));
+        }
+        return i;
+    }
+
+    // AVX2 kernels, chosen at run time.
+
+    OMEGA_IMG_AVX2 std::size_t swizzleAvx2(const Byte * src, Byte * dst, std::size_t count) {
+        const __m256i order = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+                                               2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i * 4));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i * 4), _mm256_shuffle_epi8(x, order));
+        }
+        return i;
+    }
+
+    OMEGA_IMG_AVX2 std::size_t expandRGBAvx2(const Byte * src, Byte * dst, std::size_t count) {
+        const __m128i order = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+        const __m128i opaque = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+        std::size_t i = 0;
+        // Each 16-byte load uses 12 bytes; stop while the load stays in bounds.
+        for (; i + 6 <= count; i += 4) {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 3));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4), _mm_or_si128(_mm_shuffle_epi8(x, order), opaque));
+        }
+        return i;
+    }
+
+    OMEGA_IMG_AVX2 std::size_t premultiplyAvx2(const Byte * src, Byte * dst, std::size_t count) {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i colorMask = _mm256_set_epi16(0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1);
+        const __m256i alphaOne = _mm256_set_epi16(255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0);
+        const __m256i half = _mm256_set1_epi16(128);
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i * 4));
+            __m256i halves[2] = {_mm256_unpacklo_epi8(x, zero), _mm256_unpackhi_epi8(x, zero)};
+            for (auto & px : halves) {
+                __m256i a = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(px, 0xFF), 0xFF);
+                a = _mm256_or_si256(_mm256_and_si256(a, colorMask), alphaOne);
+                const __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(px, a), half);
+                px = _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+            }
+            // unpack and pack both work per 128-bit lane, so pixel order is kept.
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i * 4), _mm256_packus_epi16(halves[0], halves[1]));
+        }
+        return i;
+    }
+
+    OMEGA_IMG_AVX2 std::size_t unpremultiplyAvx2(const Byte * src, Byte * dst, std::size_t count) {
+        const __m256 scale = _mm256_set1_ps(255.0f);
+        const __m256 half = _mm256_set1_ps(0.5f);
+        const __m256i alphaLane = _mm256_set_epi32(-1, 0, 0, 0, -1, 0, 0, 0);
+        std::size_t i = 0;
+        for (; i + 2 <= count; i += 2) {
+            std::uint64_t bytes;
+            std::memcpy(&bytes, src + i * 4, sizeof(bytes));
+            const __m256i px = _mm256_cvtepu8_epi32(_mm_cvtsi64_si128(static_cast<long long>(bytes)));
+            const __m256 f = _mm256_cvtepi32_ps(px);
+            const __m256 a = _mm256_permute_ps(f, 0xFF);
+            __m256 q = _mm256_div_ps(_mm256_mul_ps(f, scale), a);
+            q = _mm256_min_ps(_mm256_add_ps(q, half), scale);
+            __m256i out = _mm256_cvttps_epi32(q);
+            out = _mm256_blendv_epi8(out, px, alphaLane);
+            out = _mm256_andnot_si256(_mm256_castps_si256(_mm256_cmp_ps(a, _mm256_setzero_ps(), _CMP_EQ_OQ)), out);
+            const __m128i words = _mm_packs_epi32(_mm256_castsi256_si128(out), _mm256_extracti128_si256(out, 1));
+            const long long packed = _mm_cvtsi128_si64(_mm_packus_epi16(words, words));
+            std::memcpy(dst + i * 4, &packed, sizeof(packed));
+        }
+        return i;
+    }
+
+    OMEGA_IMG_AVX2 std::size_t narrowAvx2(const std::uint16_t * src, Byte * dst, std::size_t count) {
+        const __m256i scale = _mm256_set1_epi16(static_cast<short>(0xFF01));
+        const __m256i half = _mm256_set1_epi16(128);
+        std::size_t i = 0;
+        for (; i + 32 <= count; i += 32) {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i + 16));
+            a = _mm256_srli_epi16(_mm256_add_epi16(_mm256_mulhi_epu16(a, scale), half), 8);
+            b = _mm256_srli_epi16(_mm256_add_epi16(_mm256_mulhi_epu16(b, scale), half), 8);
+            // packus interleaves the 128-bit lanes of a and b; put them back in order.
+            const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), packed);
+        }
+        return i;
+    }
+
+    OMEGA_IMG_AVX2 std::size_t expandGrayAvx2(const Byte * src, Byte * dst, std::size_t count) {
+        const __m256i spread = _mm256_set1_epi32(0x010101);
+        const __m256i opaque = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            std::uint64_t bytes;
+            std::memcpy(&bytes, src + i, sizeof(bytes));
+            const __m256i g = _mm256_cvtepu8_epi32(_mm_cvtsi64_si128(static_cast<long long>(bytes)));
+            const __m256i out = _mm256_or_si256(_mm256_mullo_epi32(g, spread), opaque);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i * 4), out);
+        }
+        return i;
+    }
+
+    OMEGA_IMG_AVX2 std::size_t expandGrayAlphaAvx2(const Byte * src, Byte * dst, std::size_t count) {
+        const __m256i order = _mm256_setr_epi8(0, 0, 0, 1, 2, 2, 2, 3, 4, 4, 4, 5, 6, 6, 6, 7,
+                                               0, 0, 0, 1, 2, 2, 2, 3, 4, 4, 4, 5, 6, 6, 6, 7);
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            const __m128i ga = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 2));
+            // Pixels 0-3 in the low lane, 4-7 in the high lane.
+            const __m256i both = _mm256_inserti128_si256(_mm256_castsi128_si256(ga), _mm_srli_si128(ga, 8), 1);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i * 4), _mm256_shuffle_epi8(both, order));
+        }
+        return i;
+    }
+
+#elif defined(OMEGA_IMG_NEON)
+
+    std::size_t swizzleNeon(const Byte * src, Byte * dst, std::size_t count) {
+        std::size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            uint8x16x4_t px = vld4q_u8(src + i * 4);
+            const uint8x16_t r = px.val[0];
+            px.val[0] = px.val[2];
+            px.val[2] = r;
+            vst4q_u8(dst + i * 4, px);
+        }
+        return i;
+    }
+
+    std::size_t expandRGBNeon(const Byte * src, Byte * dst, std::size_t count) {
+        std::size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            const uint8x16x3_t rgb = vld3q_u8(src + i * 3);
+            uint8x16x4_t px;
+            px.val[0] = rgb.val[0];
+            px.val[1] = rgb.val[1];
+            px.val[2] = rgb.val[2];
+            px.val[3] = vdupq_n_u8(0xFF);
+            vst4q_u8(dst + i * 4, px);
+        }
+        return i;
+    }
+
+    inline uint8x8_t premultiplyChannel(uint8x8_t c, uint8x8_t a) {
+        const uint16x8_t t = vaddq_u16(vmull_u8(c, a), vdupq_n_u16(128));
+        return vaddhn_u16(t, vshrq_n_u16(t, 8));
+    }
+
+    std::size_t premultiplyNeon(const Byte * src, Byte * dst, std::size_t count) {
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            uint8x8x4_t px = vld4_u8(src + i * 4);
+            px.val[0] = premultiplyChannel(px.val[0], px.val[3]);
+            px.val[1] = premultiplyChannel(px.val[1], px.val[3]);
+            px.val[2] = premultiplyChannel(px.val[2], px.val[3]);
+            vst4_u8(dst + i * 4, px);
+        }
+        return i;
+    }
+
+#if defined(OMEGA_IMG_NEON64)
+    std::size_t unpremultiplyNeon(const Byte * src, Byte * dst, std::size_t count) {
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            const uint8x16_t x = vld1q_u8(src + i * 4);
+            const uint16x8_t halves[2] = {vmovl_u8(vget_low_u8(x)), vmovl_u8(vget_high_u8(x))};
+            uint16x4_t words[4];
+            for (int p = 0; p < 4; p++) {
+                const uint32x4_t px = vmovl_u16(p % 2 == 0 ? vget_low_u16(halves[p / 2]) : vget_high_u16(halves[p / 2]));
+                const float32x4_t f = vcvtq_f32_u32(px);
+                const float32x4_t a = vdupq_laneq_f32(f, 3);
+                float32x4_t q = vdivq_f32(vmulq_n_f32(f, 255.0f), a);
+                q = vminq_f32(vaddq_f32(q, vdupq_n_f32(0.5f)), vdupq_n_f32(255.0f));
+                uint32x4_t out = vsetq_lane_u32(vgetq_lane_u32(px, 3), vcvtq_u32_f32(q), 3);
+                out = vbicq_u32(out, vceqq_f32(a, vdupq_n_f32(0.0f)));
+                words[p] = vmovn_u32(out);
+            }
+            const uint8x8_t lo = vmovn_u16(vcombine_u16(words[0], words[1]));
+            const uint8x8_t hi = vmovn_u16(vcombine_u16(words[2], words[3]));
+            vst1q_u8(dst + i * 4, vcombine_u8(lo, hi));
+        }
+        return i;
+    }
+#endif
+
+    std::size_t narrowNeon(const std::uint16_t * src, Byte * dst, std::size_t count) {
+        const uint16x4_t scale = vdup_n_u16(0xFF01);
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            const uint16x8_t v = vld1q_u16(src + i);
+            const uint16x4_t lo = vshrn_n_u32(vmull_u16(vget_low_u16(v), scale), 16);
+            const uint16x4_t hi = vshrn_n_u32(vmull_u16(vget_high_u16(v), scale), 16);
+            const uint16x8_t high = vaddq_u16(vcombine_u16(lo, hi), vdupq_n_u16(128));
+            vst1_u8(dst + i, vshrn_n_u16(high, 8));
+        }
+        return i;
+    }
+
+    std::size_t expandGrayNeon(const Byte * src, Byte * dst, std::size_t count) {
+        std::size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            const uint8x16_t g = vld1q_u8(src + i);
+            uint8x16x4_t px;
+            px.val[0] = px.val[1] = px.val[2] = g;
+            px.val[3] = vdupq_n_u8(0xFF);
+            vst4q_u8(dst + i * 4, px);
+        }
+        return i;
+    }
+
+    std::size_t expandGrayAlphaNeon(const Byte * src, Byte * dst, std::size_t count) {
+        std::size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            const uint8x16x2_t ga = vld2q_u8(src + i * 2);
+            uint8x16x4_t px;
+            px.val[0] = px.val[1] = px.val[2] = ga.val[0];
+            px.val[3] = ga.val[1];
+            vst4q_u8(dst + i * 4, px);
+        }
+        return i;
+    }
+
+#endif
+
+}
+
+void swizzleRGBAToBGRA(const Byte * src, Byte * dst, std::size_t count) {
+    std::size_t done = 0;
+#if defined(OMEGA_IMG_X86)
+    done = hasAvx2() ? swizzleAvx2(src, dst, count) : swizzleSse2(src, dst, count);
+#elif defined(OMEGA_IMG_NEON)
+    done = swizzleNeon(src, dst, count);
+#endif
+    swizzleScalar(src + done * 4, dst + done * 4, count - done);
+}
+
+void expandRGBToRGBA(const Byte * src, Byte * dst, std::size_t count) {
+    std::size_t done = 0;
+#if defined(OMEGA_IMG_X86)
+    // Without SSSE3's byte shuffle there is no fast SSE2 form of this one.
+    done = hasAvx2() ? expandRGBAvx2(src, dst, count) : 0;
+#elif defined(OMEGA_IMG_NEON)
+    done = expandRGBNeon(src, dst, count);
+#endif
+    expandRGBScalar(src + done * 3, dst + done * 4, count - done);
+}
+
+void premultiplyAlpha(const Byte * src, Byte * dst, std::size_t count) {
+    std::size_t done = 0;
+#if defined(OMEGA_IMG_X86)
+    done = hasAvx2() ? premultiplyAvx2(src, dst, count) : premultiplySse2(src, dst, count);
+#elif defined(OMEGA_IMG_NEON)
+    done = premultiplyNeon(src, dst, count);
+#endif
+    premultiplyScalar(src + done * 4, dst + done * 4, count - done);
+}
+
+void unpremultiplyAlpha(const Byte * src, Byte * dst, std::size_t count) {
+    std::size_t done = 0;
+#if defined(OMEGA_IMG_X86)
+    done = hasAvx2() ? unpremultiplyAvx2(src, dst, count) : unpremultiplySse2(src, dst, count);
+#elif defined(OMEGA_IMG_NEON64)
+    done = unpremultiplyNeon(src, dst, count);
+#endif
+    unpremultiplyScalar(src + done * 4, dst + done * 4, count - done);
+}
+
+void narrow16To8(const std::uint16_t * src, Byte * dst, std::size_t count) {
+    std::size_t done = 0;
+#if defined(OMEGA_IMG_X86)
+    done = hasAvx2() ? narrowAvx2(src, dst, count) : narrowSse2(src, dst, count);
+#elif defined(OMEGA_IMG_NEON)
+    done = narrowNeon(src, dst, count);
+#endif
+    narrowScalar(src + done, dst + done, count - done);
+}
+
+void expandGrayToRGBA(const Byte * src, Byte * dst, std::size_t count) {
+    std::size_t done = 0;
+#if defined(OMEGA_IMG_X86)
+    done = hasAvx2() ? expandGrayAvx2(src, dst, count) : expandGraySse2(src, dst, count);
+#elif defined(OMEGA_IMG_NEON)
+    done = expandGrayNeon(src, dst, count);
+#endif
+    expandGrayScalar(src + done, dst + done * 4, count - done);
+}
+
+void expandGrayAlphaToRGBA(const Byte * src, Byte * dst, std::size_t count) {
+    std::size_t done = 0;
+#if defined(OMEGA_IMG_X86)
+    done = hasAvx2() ? expandGrayAlphaAvx2(src, dst, count) : expandGrayAlphaSse2(src, dst, count);
+#elif defined(OMEGA_IMG_NEON)
+    done = expandGrayAlphaNeon(src, dst, count);
+#endif
+    expandGrayAlphaScalar(src + done * 2, dst + done * 4, count - done);
+}
+
+void srgbToLinear(const Byte * src, float * dst, std::size_t count) {
+    const float * table = srgbTable();
+    for (std::size_t i = 0; i < count; i++, src += 4, dst += 4) {
+        dst[0] = table[src[0]];
+        dst[1] = table[src[1]];
+        dst[2] = table[src[2]];
+        dst[3] = src[3] * (1.0f / 255.0f);
+    }
+}
+
+void convertPixels(const Byte * src, ColorFormat from, Byte * dst, ColorFormat to, std::size_t count) {
+    if (from == to) {
+        if (src != dst) {
+            std::memcpy(dst, src, count * static_cast<std::size_t>(DecodeTarget::channelsOf(from)));
+        }
+        return;
+    }
+    if (from == ColorFormat::RGB) {
+        expandRGBToRGBA(src, dst, count);
+        if (to == ColorFormat::BGRA) {
+            swizzleRGBAToBGRA(dst, dst, count);
+        }
+        return;
+    }
+    if (to == ColorFormat::RGB) {
+        const int r = from == ColorFormat::BGRA ? 2 : 0;
+        for (std::size_t i = 0; i < count; i++, src += 4, dst += 3) {
+            dst[0] = src[r];
+            dst[1] = src[1];
+            dst[2] = src[2 - r];
+        }
+        return;
+    }
+    swizzleRGBAToBGRA(src, dst, count);
+}
+
+Result<BitmapImage, std::string> convertImage(const BitmapImage & image, ColorFormat format, AlphaFormat alpha) {
+    const Header & src = image.header;
+    const int srcChannels = DecodeTarget::channelsOf(src.color_format);
+    const int dstChannels = DecodeTarget::channelsOf(format);
+    if (image.empty() || src.bitDepth != 8 || srcChannels == 0 || src.channels != srcChannels) {
+        return Result<BitmapImage, std::string>::err(std::string("Only 8-bit RGB, RGBA and BGRA images can be converted"));
+    }
+    if (dstChannels == 0 || (dstChannels == 4 && alpha != AlphaFormat::Straight && alpha != AlphaFormat::Premultipled)) {
+        return Result<BitmapImage, std::string>::err(std::string("Unsupported target pixel layout"));
+    }
+    if (src.stride < static_cast<std::size_t>(src.width) * srcChannels ||
+        image.byteSize() < src.stride * src.height) {
+        return Result<BitmapImage, std::string>::err(std::string("Image buffer is smaller than its header"));
+    }
+
+    // Alpha math only applies when the source carries real alpha.
+    const bool hasAlpha = srcChannels == 4 &&
+                          (src.alpha_format == AlphaFormat::Straight || src.alpha_format == AlphaFormat::Premultipled);
+    const bool srcPremultiplied = hasAlpha && src.alpha_format == AlphaFormat::Premultipled;
+    const bool unpremultiply = srcPremultiplied && (dstChannels == 3 || alpha == AlphaFormat::Straight);
+    const bool premultiply = hasAlpha && !srcPremultiplied && dstChannels == 4 && alpha == AlphaFormat::Premultipled;
+
+    BitmapImage out;
+    out.profile = image.profile;
+    out.sRGB = image.sRGB;
+    out.hasGamma = image.hasGamma;
+    out.gamma = image.gamma;
+    out.header = src;
+    out.header.color_format = format;
+    out.header.channels = dstChannels;
+    out.header.stride = static_cast<std::size_t>(src.width) * static_cast<std::size_t>(dstChannels);
+    out.header.alpha_format = dstChannels == 4 && hasAlpha ? alpha : AlphaFormat::Ignore;
+    out.pixels = PixelStorage::allocate(out.header.stride * src.height);
+
+    Vector<Byte> straight(unpremultiply && dstChannels == 3 ? static_cast<std::size_t>(src.width) * 4 : 0);
+    for (std::uint32_t y = 0; y < src.height; y++) {
+        const Byte * in = image.data() + src.stride * y;
+        Byte * row = out.data() + out.header.stride * y;
+        if (unpremultiply && dstChannels == 3) {
+            unpremultiplyAlpha(in, straight.data(), src.width);
+            convertPixels(straight.data(), src.color_format, row, format, src.width);
+            continue;
+        }
+        convertPixels(in, src.color_format, row, format, src.width);
+        if (unpremultiply) {
+            unpremultiplyAlpha(row, row, src.width);
+        } else if (premultiply) {
+            premultiplyAlpha(row, row, src.width);
+        }
+    }
+    return Result<BitmapImage, std::string>::ok(std::move(out));
+}
+
+}
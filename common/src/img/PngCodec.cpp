@@ -1,31 +1,34 @@
 #include "ImgCodecPriv.h"
 
+#include <algorithm>
+#include <cstring>
 #include <memory>
 
 #include <png.h>
 
 namespace OmegaCommon::Img {
 
-    class PNGCodec : public ImgCodec {
+    #define SIG_SIZE 8
+
+    /// Row layout of a PNG once its read transforms are set up.
+    struct PngLayout {
+        Header header;
+        Profile profile;
+        int passes = 1;
+        std::size_t rowBytes = 0;
+        ColorFormat format = ColorFormat::Unknown;
+        AlphaFormat alpha = AlphaFormat::Unknown;
+    };
+
+    /// Header, colour-management and expansion transforms shared by the
+    /// one-shot codec and the incremental decoder.
+    class PngTransforms {
         int srgb_intent;
         int num_palette;
         png_colorp palette;
-        static void userReadData(png_structp png_ptr, png_bytep data, png_size_t length) {
-            png_voidp stream = png_get_io_ptr(png_ptr);
-            ((std::istream *)stream)->read((char *)data, std::streamsize(length));
-        }
-        #define SIG_SIZE 8
-        bool validate_signature() {
-
-            png_byte sig[SIG_SIZE];
-
-            in.read((char *)sig, SIG_SIZE);
-            if (!in.good()) {
-                return false;
-            }
-
-            return png_sig_cmp(sig, 0, SIG_SIZE) == 0;
-        }
+        BitmapImage * storage;
+    public:
+        explicit PngTransforms(BitmapImage * storage) : storage(storage) {}
 
         Header read_header(png_structp png_ptr, png_infop info_ptr) {
             ColorFormat colorFormat;
@@ -71,11 +74,20 @@ namespace OmegaCommon::Img {
                     break;
                 }
                 case PNG_COLOR_TYPE_GRAY: {
+                    if (bitDepth < 8) {
+                        png_set_expand_gray_1_2_4_to_8(png_ptr);
+                    }
                     png_set_gray_to_rgb(png_ptr);
                     colorFormat = ColorFormat::RGB;
                     alphaFormat = AlphaFormat::Ignore;
                     break;
                 }
+                case PNG_COLOR_TYPE_GRAY_ALPHA: {
+                    png_set_gray_to_rgb(png_ptr);
+                    colorFormat = ColorFormat::RGBA;
+                    alphaFormat = AlphaFormat::Straight;
+                    break;
+                }
                 case PNG_COLOR_TYPE_PALETTE: {
                     png_get_PLTE(png_ptr, info_ptr, &palette, &num_palette);
                     png_set_palette_to_rgb(png_ptr);
@@ -112,97 +124,174 @@ namespace OmegaCommon::Img {
             return {};
         }
 
-
-        bool load_png_from_file() {
-            if (validate_signature()) {
-                png_structp png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
-                if (!png_ptr) {
-                    return false;
+        /// Call once the info chunks are read. False if the transformed rows
+        /// are not 8-bit RGB or RGBA.
+        bool configure(png_structp png_ptr, png_infop info_ptr, PngLayout & layout) {
+            /// Set Info!
+            layout.header = read_header(png_ptr, info_ptr);
+            layout.profile = read_profile(png_ptr, info_ptr);
+            /// Gamma Chunk!
+            double file_gamma;
+            if (png_get_gAMA(png_ptr, info_ptr, &file_gamma) == PNG_INFO_gAMA) {
+                storage->hasGamma = true;
+                storage->gamma = file_gamma;
+                if (!storage->sRGB) {
+                    png_set_gamma(png_ptr, DEFAULT_SCREEN_GAMMA, file_gamma);
                 }
-
-                png_infop info_ptr = png_create_info_struct(png_ptr);
-                if (!info_ptr) {
-                    png_destroy_read_struct(&png_ptr, 0, 0);
-                    return false;
+            } else {
+                storage->hasGamma = false;
+            }
+            png_bytep trans_alpha;
+            int num_trans;
+            png_color_16p trans_color;
+            png_get_tRNS(png_ptr, info_ptr, &trans_alpha, &num_trans, &trans_color);
+
+            /// If SRGB colorspace is used!
+            if (storage->sRGB) {
+                if (png_get_valid(png_ptr, info_ptr, PNG_INFO_cHRM) && png_get_valid(png_ptr, info_ptr, PNG_INFO_gAMA)) {
+                    png_set_sRGB_gAMA_and_cHRM(png_ptr, info_ptr, srgb_intent);
+                    storage->hasGamma = false;
+                } else {
+                    png_set_sRGB(png_ptr, info_ptr, srgb_intent);
                 }
+                storage->sRGB = false;
+            }
 
-                png_bytep * rowPtrs = NULL;
-                PixelStorage pixels;
+            layout.passes = png_set_interlace_handling(png_ptr);
+            /// Row layout after the transforms above (palette and gray
+            /// expansion, tRNS to alpha, 16-bit strip).
+            png_read_update_info(png_ptr, info_ptr);
+            const int channels = png_get_channels(png_ptr, info_ptr);
+            layout.rowBytes = png_get_rowbytes(png_ptr, info_ptr);
+            if (png_get_bit_depth(png_ptr, info_ptr) != 8 || (channels != 3 && channels != 4)) {
+                return false;
+            }
+            layout.format = channels == 4 ? ColorFormat::RGBA : ColorFormat::RGB;
+            layout.alpha = channels == 4 ? AlphaFormat::Straight : AlphaFormat::Ignore;
+            return true;
+        }
+    };
 
-                if (setjmp(png_jmpbuf(png_ptr))) {
+    class PNGCodec : public ImgCodec {
+        PngTransforms transforms;
+        static void userReadData(png_structp png_ptr, png_bytep data, png_size_t length) {
+            png_voidp stream = png_get_io_ptr(png_ptr);
+            ((std::istream *)stream)->read((char *)data, std::streamsize(length));
+        }
+        bool validate_signature() {
 
-                    png_destroy_read_struct(&png_ptr, &info_ptr, 0);
-                    if (rowPtrs != NULL) delete[] rowPtrs;
-                    // `pixels` frees its buffer (if any) on scope exit.
+            png_byte sig[SIG_SIZE];
 
-                    return false;
-                }
+            in.read((char *)sig, SIG_SIZE);
+            if (!in.good()) {
+                return false;
+            }
 
-                png_set_read_fn(png_ptr, (png_voidp)&in, userReadData);
+            return png_sig_cmp(sig, 0, SIG_SIZE) == 0;
+        }
 
-                png_set_sig_bytes(png_ptr, SIG_SIZE);
+        /// Row buffers of the calling thread, reused across decodes. libpng read
+        /// structs cannot be reset, so they are still created per image.
+        struct RowScratch {
+            Vector<Byte> rows;
+            Vector<png_bytep> rowPtrs;
 
-                png_read_info(png_ptr, info_ptr);
-                /// Set Info!
-                auto header = read_header(png_ptr, info_ptr);
-                auto profile = read_profile(png_ptr, info_ptr);
-                /// Gamma Chunk!
-                double file_gamma;
-                if (png_get_gAMA(png_ptr, info_ptr, &file_gamma) == PNG_INFO_gAMA) {
-                    storage->hasGamma = true;
-                    storage->gamma = file_gamma;
-                    if (!storage->sRGB) {
-                        png_set_gamma(png_ptr, DEFAULT_SCREEN_GAMMA, file_gamma);
-                    }
-                } else {
-                    storage->hasGamma = false;
-                }
-                png_bytep trans_alpha;
-                int num_trans;
-                png_color_16p trans_color;
-                png_get_tRNS(png_ptr, info_ptr, &trans_alpha, &num_trans, &trans_color);
+            static RowScratch & current() {
+                static thread_local RowScratch scratch;
+                return scratch;
+            }
+        };
 
-                /// If SRGB colorspace is used!
-                if (storage->sRGB) {
-                    if (png_get_valid(png_ptr, info_ptr, PNG_INFO_cHRM) && png_get_valid(png_ptr, info_ptr, PNG_INFO_gAMA)) {
-                        png_set_sRGB_gAMA_and_cHRM(png_ptr, info_ptr, srgb_intent);
-                        storage->hasGamma = false;
-                    } else {
-                        png_set_sRGB(png_ptr, info_ptr, srgb_intent);
-                    }
-                    storage->sRGB = false;
-                }
+        /// Everything the decode allocates, owned by the frame that calls
+        /// setjmp so a libpng error unwinding through longjmp cannot leak it.
+        struct DecodeState {
+            std::unique_ptr<DecodeTarget> target;
+            RowScratch & scratch = RowScratch::current();
 
-                const std::size_t totalBytes =
-                    (static_cast<std::size_t>(header.width) * header.height *
-                     header.bitDepth * header.channels) / 8;
-                rowPtrs = new png_bytep[header.height];
-                pixels = PixelStorage::allocate(totalBytes);
-                Byte * data = pixels.data();
-                unsigned int stride = (header.width * header.bitDepth * header.channels) / 8;
+            ~DecodeState() {
+                trimScratch(scratch.rows);
+                trimScratch(scratch.rowPtrs);
+            }
+        };
 
-                for (std::size_t i = 0; i < header.height; i++) {
-                    png_uint_32 ptr = (header.height - i - 1) * stride;
-                    /// Read from top to bottom!
-                    rowPtrs[header.height - 1 - i] = (png_bytep)data + ptr;
-                }
+        bool decode(png_structp png_ptr, png_infop info_ptr, DecodeState & state) {
+            png_set_read_fn(png_ptr, (png_voidp)&in, userReadData);
+
+            png_set_sig_bytes(png_ptr, SIG_SIZE);
 
-                png_read_image(png_ptr, rowPtrs);
+            png_read_info(png_ptr, info_ptr);
+            PngLayout layout;
+            if (!transforms.configure(png_ptr, info_ptr, layout)) {
+                return false;
+            }
+            const Header & header = layout.header;
+            const int passes = layout.passes;
+            const std::size_t rowBytes = layout.rowBytes;
+            state.target = std::make_unique<DecodeTarget>(options, header.width, header.height, layout.format, layout.alpha);
+            DecodeTarget & target = *state.target;
+            if (!target.ok()) {
+                return false;
+            }
 
+            if (passes > 1) {
+                // Interlaced rows are only final after the last pass.
+                state.scratch.rows.resize(rowBytes * header.height);
+                state.scratch.rowPtrs.resize(header.height);
+                for (std::uint32_t y = 0; y < header.height; y++) {
+                    state.scratch.rowPtrs[y] = state.scratch.rows.data() + rowBytes * y;
+                }
+                png_read_image(png_ptr, state.scratch.rowPtrs.data());
+                for (std::uint32_t y = target.firstRow(); y < target.endRow(); y++) {
+                    target.pushRow(y, state.scratch.rowPtrs[y]);
+                }
                 png_read_end(png_ptr, info_ptr);
+            } else {
+                // One row at a time: rows above the region are decoded into a
+                // throwaway buffer and decoding stops after its last row.
+                state.scratch.rows.resize(rowBytes);
+                for (std::uint32_t y = 0; y < target.endRow(); y++) {
+                    const bool wanted = y >= target.firstRow();
+                    png_read_row(png_ptr, wanted ? target.rowBuffer(y) : state.scratch.rows.data(), nullptr);
+                    if (wanted) {
+                        target.pushRow(y);
+                    }
+                }
+                if (target.endRow() == header.height) {
+                    png_read_end(png_ptr, info_ptr);
+                }
+            }
 
-                delete[] rowPtrs;
-                png_destroy_read_struct(&png_ptr, &info_ptr, (png_infopp)0);
+            target.finish(*storage, header);
+            storage->profile = layout.profile;
+            return true;
+        }
+
+        bool load_png_from_file() {
+            if (!validate_signature()) {
+                return false;
+            }
+            png_structp png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+            if (!png_ptr) {
+                return false;
+            }
 
-                storage->pixels = std::move(pixels);
-                storage->header = header;
-                storage->profile = profile;
+            png_infop info_ptr = png_create_info_struct(png_ptr);
+            if (!info_ptr) {
+                png_destroy_read_struct(&png_ptr, 0, 0);
+                return false;
+            }
 
-                return true;
+            DecodeState state;
 
-            } else {
+            if (setjmp(png_jmpbuf(png_ptr))) {
+                png_destroy_read_struct(&png_ptr, &info_ptr, 0);
+                // `state` frees its buffers on scope exit.
                 return false;
             }
+
+            const bool rc = decode(png_ptr, info_ptr, state);
+            png_destroy_read_struct(&png_ptr, &info_ptr, (png_infopp)0);
+            return rc;
         }
     public:
         void readToStorage() override {
@@ -210,12 +299,184 @@ namespace OmegaCommon::Img {
                 storage->pixels.reset();
             }
         }
-        PNGCodec(std::istream & stream, BitmapImage * res) : ImgCodec(stream, res) {}
+        PNGCodec(std::istream & stream, BitmapImage * res, const DecodeOptions & options) : ImgCodec(stream, res, options), transforms(res) {}
         ~PNGCodec() {}
     };
 
-    std::unique_ptr<ImgCodec> getPngCodec(std::istream & in, BitmapImage * img) {
-        return std::make_unique<PNGCodec>(in, img);
+    /// Push-mode decoder on libpng's progressive reader. Sequential rows go to
+    /// the target as they decode; an Adam7 image is kept whole and re-shown
+    /// after each pass with the pixels not yet decoded filled from the
+    /// nearest decoded one above and to the left.
+    class PngIncrementalDecoder : public IncrementalDecoderBase {
+        png_structp png_ptr = nullptr;
+        png_infop info_ptr = nullptr;
+        PngTransforms transforms;
+        PngLayout layout;
+        /// Adam7 only: every row of the source, combined across passes.
+        Vector<Byte> interlaced;
+        Vector<Byte> display;
+        int currentPass = 0;
+        std::string error;
+
+        static void onError(png_structp png, png_const_charp message) {
+            auto * self = static_cast<PngIncrementalDecoder *>(png_get_error_ptr(png));
+            self->error = message;
+            png_longjmp(png, 1);
+        }
+
+        static void onInfo(png_structp png, png_infop info) {
+            auto * self = static_cast<PngIncrementalDecoder *>(png_get_progressive_ptr(png));
+            if (!self->beginImage(info)) {
+                png_error(png, "Unsupported PNG layout or decode options");
+            }
+        }
+
+        static void onRow(png_structp png, png_bytep row, png_uint_32 rowNumber, int passNumber) {
+            auto * self = static_cast<PngIncrementalDecoder *>(png_get_progressive_ptr(png));
+            self->row(row, rowNumber, passNumber);
+        }
+
+        static void onEnd(png_structp png, png_infop) {
+            auto * self = static_cast<PngIncrementalDecoder *>(png_get_progressive_ptr(png));
+            self->end();
+        }
+
+        bool beginImage(png_infop info) {
+            if (!transforms.configure(png_ptr, info, layout)) {
+                return false;
+            }
+            if (layout.passes > 1) {
+                interlaced.assign(layout.rowBytes * layout.header.height, 0);
+                display.resize(layout.rowBytes);
+            }
+            image_.profile = layout.profile;
+            return beginOutput(options, layout.header.width, layout.header.height, layout.format, layout.alpha,
+                               layout.header);
+        }
+
+        void row(png_bytep data, png_uint_32 y, int passNumber) {
+            if (state_ == State::Complete) {
+                return;
+            }
+            if (layout.passes == 1) {
+                if (data == nullptr) {
+                    return;
+                }
+                target->pushRow(y, data);
+                // Rows below the region are not needed.
+                if (y + 1 >= target->endRow()) {
+                    complete(layout.header);
+                } else {
+                    reportRows(true);
+                }
+                return;
+            }
+            if (passNumber != currentPass) {
+                // Every row of the earlier passes has arrived.
+                showPasses(passNumber);
+                currentPass = passNumber;
+            }
+            png_progressive_combine_row(png_ptr, interlaced.data() + layout.rowBytes * y, data);
+        }
+
+        /// Show the image as of the first @p passesDone Adam7 passes.
+        void showPasses(int passesDone) {
+            static const std::uint32_t blockWidth[] = {8, 4, 4, 2, 2, 1, 1};
+            static const std::uint32_t blockHeight[] = {8, 8, 4, 4, 2, 2, 1};
+            const std::uint32_t w = blockWidth[passesDone - 1];
+            const std::uint32_t h = blockHeight[passesDone - 1];
+            const std::size_t channels = layout.format == ColorFormat::RGBA ? 4 : 3;
+            beginPass(static_cast<unsigned>(passesDone));
+            for (std::uint32_t y = target->firstRow(); y < target->endRow(); y++) {
+                const Byte * source = interlaced.data() + layout.rowBytes * (y & ~(h - 1));
+                if (w == 1) {
+                    target->pushRow(y, source);
+                    continue;
+                }
+                for (std::uint32_t x = 0; x < layout.header.width; x++) {
+                    std::memcpy(display.data() + x * channels, source + (x & ~(w - 1)) * channels, channels);
+                }
+                target->pushRow(y, display.data());
+            }
+            reportRows(passesDone == 7);
+        }
+
+        void end() {
+            if (state_ == State::Complete) {
+                return;
+            }
+            if (layout.passes > 1) {
+                beginPass(7);
+                for (std::uint32_t y = target->firstRow(); y < target->endRow(); y++) {
+                    target->pushRow(y, interlaced.data() + layout.rowBytes * y);
+                }
+                Vector<Byte>().swap(interlaced);
+            }
+            complete(layout.header);
+        }
+
+        void destroy() {
+            if (png_ptr != nullptr) {
+                png_destroy_read_struct(&png_ptr, &info_ptr, nullptr);
+                png_ptr = nullptr;
+                info_ptr = nullptr;
+            }
+        }
+    public:
+        explicit PngIncrementalDecoder(const DecodeOptions & options)
+            : IncrementalDecoderBase(options), transforms(&image_) {
+            png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, this, onError, nullptr);
+            if (png_ptr != nullptr) {
+                info_ptr = png_create_info_struct(png_ptr);
+            }
+            if (info_ptr == nullptr) {
+                destroy();
+                error = "Failed to create PNG decoder";
+                return;
+            }
+            png_set_progressive_read_fn(png_ptr, this, onInfo, onRow, onEnd);
+        }
+
+        Result<State, std::string> feed(const Byte * data, std::size_t size) override {
+            if (state_ == State::Complete) {
+                return Result<State, std::string>::ok(state_);
+            }
+            if (png_ptr == nullptr) {
+                return Result<State, std::string>::err(error);
+            }
+            if (setjmp(png_jmpbuf(png_ptr))) {
+                destroy();
+                return fail(error);
+            }
+            png_process_data(png_ptr, info_ptr, const_cast<Byte *>(data), size);
+            if (state_ == State::Complete) {
+                destroy();
+            }
+            return Result<State, std::string>::ok(state_);
+        }
+
+        Result<State, std::string> finish() override {
+            if (state_ == State::Complete) {
+                return Result<State, std::string>::ok(state_);
+            }
+            if (png_ptr == nullptr) {
+                return Result<State, std::string>::err(error);
+            }
+            destroy();
+            return fail("Truncated PNG data");
+        }
+
+        ~PngIncrementalDecoder() override {
+            destroy();
+        }
+    };
+
+    std::unique_ptr<ImgCodec> getPngCodec(std::istream & in, BitmapImage * img, const DecodeOptions & options) {
+        return std::make_unique<PNGCodec>(in, img, options);
+    }
+
+    std::unique_ptr<IncrementalDecoder> makePngIncrementalDecoder(const DecodeOptions & options) {
+        return std::make_unique<PngIncrementalDecoder>(options);
     }
 
 }
@@ -115,9 +115,13 @@ namespace OmegaCommon::Img {
 
             const std::size_t pixelCount = static_cast<std::size_t>(width) * static_cast<std::size_t>(height);
             const std::size_t bufferBytes = pixelCount * sizeof(std::uint32_t);
-            std::uint32_t * buffer = (std::uint32_t *)_TIFFmalloc(bufferBytes);
-            if (buffer != nullptr) {
-                if (TIFFReadRGBAImage(tiff, width, height, buffer, 0)) {
+            const bool asDecoded = !options.region && options.targetWidth == 0 && options.targetHeight == 0 &&
+                                   DecodeTarget::formatFor(options.pixelFormat, ColorFormat::RGBA) == ColorFormat::RGBA;
+            if (asDecoded) {
+                std::uint32_t * buffer = (std::uint32_t *)_TIFFmalloc(bufferBytes);
+                if (buffer != nullptr && !TIFFReadRGBAImage(tiff, width, height, buffer, 0)) {
+                    _TIFFfree(buffer);
+                } else if (buffer != nullptr) {
                     // Adopt the libtiff allocation with its matching free
                     // function so the destructor frees it correctly. Before
                     // this, GTE's BitmapImageOwner used `delete[]` on TIFF
@@ -127,25 +131,44 @@ namespace OmegaCommon::Img {
                         reinterpret_cast<Byte *>(buffer), bufferBytes, &tiffFree);
                     storage->header = header;
                     rc = true;
-                } else {
-                    _TIFFfree(buffer);
                 }
+            } else {
+                // The raster is only an intermediate here, so it comes from
+                // the calling thread's reusable scratch.
+                Vector<std::uint32_t> & raster = rasterScratch();
+                raster.resize(pixelCount);
+                DecodeTarget target(options, width, height, ColorFormat::RGBA, AlphaFormat::Straight);
+                if (pixelCount > 0 && target.ok() && TIFFReadRGBAImage(tiff, width, height, raster.data(), 0)) {
+                    // libtiff's RGBA raster starts at the bottom row; the
+                    // target expects rows top-down.
+                    for (std::uint32_t y = target.firstRow(); y < target.endRow(); y++) {
+                        const std::size_t rasterRow = static_cast<std::size_t>(height - 1 - y);
+                        target.pushRow(y, reinterpret_cast<const Byte *>(raster.data() + rasterRow * width));
+                    }
+                    target.finish(*storage, header);
+                    rc = true;
+                }
+                trimScratch(raster);
             }
             TIFFClose(tiff);
             return rc;
         }
         static void tiffFree(Byte * p) { _TIFFfree(p); }
+        static Vector<std::uint32_t> & rasterScratch() {
+            static thread_local Vector<std::uint32_t> raster;
+            return raster;
+        }
     public:
         void readToStorage() override {
             if (!load_tiff_from_file()) {
                 storage->pixels.reset();
             }
         }
-        TiffCodec(std::istream & stream, BitmapImage * res) : ImgCodec(stream, res) {}
+        TiffCodec(std::istream & stream, BitmapImage * res, const DecodeOptions & options) : ImgCodec(stream, res, options) {}
     };
 
-    std::unique_ptr<ImgCodec> getTiffCodec(std::istream & in, BitmapImage * img) {
-        return std::make_unique<TiffCodec>(in, img);
+    std::unique_ptr<ImgCodec> getTiffCodec(std::istream & in, BitmapImage * img, const DecodeOptions & options) {
+        return std::make_unique<TiffCodec>(in, img, options);
     }
 
 }
@@ -1,30 +1,33 @@
 #include "omega-common/json.h"
 
-#include <rapidjson/document.h>
+#include <rapidjson/encodedstream.h>
 #include <rapidjson/error/en.h>
 #include <rapidjson/istreamwrapper.h>
+#include <rapidjson/memorystream.h>
 #include <rapidjson/ostreamwrapper.h>
 #include <rapidjson/prettywriter.h>
+#include <rapidjson/reader.h>
 #include <rapidjson/writer.h>
 
 #include <cassert>
 #include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <iterator>
 #include <limits>
 #include <sstream>
 
 namespace OmegaCommon {
 
 class RapidJSONBridge {
-  using Document = rapidjson::Document;
-  using Value = rapidjson::Value;
-
-  static String errorMessage(const Document &document) {
-    return String(rapidjson::GetParseError_En(document.GetParseError())) +
-           " at offset " + std::to_string(document.GetErrorOffset());
+  static Map<OmegaCommon::String, JSON> &mapOf(JSON &json) {
+    return *json.data.map;
   }
 
+  static Vector<JSON> &arrayOf(JSON &json) { return *json.data.array; }
+
+public:
   template <typename Writer>
   static void writeNode(JSON &json, Writer &writer) {
     if (json.type == JSON::MAP) {
@@ -72,90 +75,100 @@ class RapidJSONBridge {
     writer.Null();
   }
 
-public:
-  static JSON fromRapid(const Value &value) {
-    if (value.IsObject()) {
-      JSON json {};
-      json.type = JSON::MAP;
-      json.data = JSON::Data(JSON::MAP);
-      json.data.map = new Map<String, JSON>();
-      for (auto it = value.MemberBegin(); it != value.MemberEnd(); ++it) {
-        String key(it->name.GetString(), it->name.GetStringLength());
-        json.data.map->insert(std::make_pair(std::move(key), fromRapid(it->value)));
-      }
-      return json;
+  /// SAX handler that builds the JSON tree directly from parser events, so a
+  /// parse allocates each node once instead of building a rapidjson::Document
+  /// and then copying it. Finished values wait on a stack until their parent
+  /// closes; object keys wait on a parallel stack.
+  class TreeBuilder
+      : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, TreeBuilder> {
+    Vector<JSON> values;
+    Vector<OmegaCommon::String> keys;
+
+    bool push(JSON value) {
+      values.push_back(std::move(value));
+      return true;
     }
 
-    if (value.IsArray()) {
-      JSON json {};
-      json.type = JSON::ARRAY;
-      json.data = JSON::Data(JSON::ARRAY);
-      json.data.array = new Vector<JSON>();
-      json.data.array->reserve(value.Size());
-      for (auto it = value.Begin(); it != value.End(); ++it) {
-        json.data.array->push_back(fromRapid(*it));
+  public:
+    bool Null() { return push(JSON(nullptr)); }
+    bool Bool(bool b) { return push(JSON(b)); }
+    bool Int(int v) { return push(JSON(static_cast<long long>(v))); }
+    bool Uint(unsigned v) { return push(JSON(static_cast<long long>(v))); }
+    bool Int64(int64_t v) { return push(JSON(static_cast<long long>(v))); }
+    bool Uint64(uint64_t v) {
+      // Unsigned values above the signed-64 range cannot fit a long long;
+      // keep them as reals rather than wrapping to a negative integer.
+      if (v <= static_cast<uint64_t>(std::numeric_limits<long long>::max())) {
+        return push(JSON(static_cast<long long>(v)));
       }
-      return json;
+      return push(JSON(static_cast<double>(v)));
     }
-
-    if (value.IsString()) {
-      return JSON(String(value.GetString(), value.GetStringLength()));
+    bool Double(double v) { return push(JSON(v)); }
+    bool String(const char *str, rapidjson::SizeType length, bool) {
+      return push(JSON(OmegaCommon::String(str, length)));
     }
-
-    if (value.IsBool()) {
-      return JSON(value.GetBool());
+    bool Key(const char *str, rapidjson::SizeType length, bool) {
+      keys.emplace_back(str, length);
+      return true;
     }
-
-    if (value.IsNumber()) {
-      if (value.IsInt()) {
-        return JSON(static_cast<long long>(value.GetInt()));
+    bool StartObject() { return true; }
+    bool StartArray() { return true; }
+
+    bool EndObject(rapidjson::SizeType memberCount) {
+      JSON json = JSON::Object();
+      auto valueBase = values.end() - memberCount;
+      auto keyBase = keys.end() - memberCount;
+      for (rapidjson::SizeType i = 0; i < memberCount; ++i) {
+        // insert() keeps the first of any duplicate keys, as before.
+        mapOf(json).insert(
+            std::make_pair(std::move(keyBase[i]), std::move(valueBase[i])));
       }
-      if (value.IsUint()) {
-        return JSON(static_cast<long long>(value.GetUint()));
-      }
-      if (value.IsInt64()) {
-        return JSON(static_cast<long long>(value.GetInt64()));
-      }
-      if (value.IsUint64()) {
-        // Unsigned values above the signed-64 range cannot fit a long long;
-        // keep them as reals rather than wrapping to a negative integer.
-        uint64_t u = value.GetUint64();
-        if (u <= static_cast<uint64_t>(std::numeric_limits<long long>::max())) {
-          return JSON(static_cast<long long>(u));
-        }
-        return JSON(static_cast<double>(u));
-      }
-      return JSON(value.GetDouble());
+      values.erase(valueBase, values.end());
+      keys.erase(keyBase, keys.end());
+      return push(std::move(json));
     }
 
-    if (value.IsNull()) {
-      return JSON(nullptr);
+    bool EndArray(rapidjson::SizeType elementCount) {
+      JSON json = JSON::Array();
+      auto base = values.end() - elementCount;
+      arrayOf(json).assign(std::make_move_iterator(base),
+                              std::make_move_iterator(values.end()));
+      values.erase(base, values.end());
+      return push(std::move(json));
     }
 
-    // Unreachable: a successfully-parsed RapidJSON value is always one of the
-    // types handled above (malformed input is rejected before fromRapid runs).
-    // Guard loudly in debug; fall back to an explicit null in release.
-    assert(false && "Unsupported RapidJSON value type");
-    return JSON(nullptr);
+    JSON take() {
+      assert(values.size() == 1 && keys.empty());
+      return std::move(values.back());
+    }
+  };
+
+  template <unsigned Flags, typename Stream>
+  static Result<JSON, OmegaCommon::String> parseStream(Stream &stream) {
+    rapidjson::Reader reader;
+    TreeBuilder builder;
+    rapidjson::ParseResult result = reader.Parse<Flags>(stream, builder);
+    if (result.IsError()) {
+      return Result<JSON, OmegaCommon::String>::err(errorMessage(result));
+    }
+    return Result<JSON, OmegaCommon::String>::ok(builder.take());
   }
 
-  static Result<JSON, String> parse(const String &source) {
-    Document document;
-    document.Parse(source.c_str(), source.size());
-    if (document.HasParseError()) {
-      return Result<JSON, String>::err(errorMessage(document));
-    }
-    return Result<JSON, String>::ok(fromRapid(document));
+  static String errorMessage(const rapidjson::ParseResult &result) {
+    return String(rapidjson::GetParseError_En(result.Code())) + " at offset " +
+           std::to_string(result.Offset());
+  }
+
+  static Result<JSON, String> parse(StrRef source) {
+    rapidjson::MemoryStream memory(source.data(), source.size());
+    rapidjson::EncodedInputStream<rapidjson::UTF8<>, rapidjson::MemoryStream>
+        stream(memory);
+    return parseStream<rapidjson::kParseDefaultFlags>(stream);
   }
 
   static Result<JSON, String> parse(std::istream &in) {
     rapidjson::IStreamWrapper wrapper(in);
-    Document document;
-    document.ParseStream(wrapper);
-    if (document.HasParseError()) {
-      return Result<JSON, String>::err(errorMessage(document));
-    }
-    return Result<JSON, String>::ok(fromRapid(document));
+    return parseStream<rapidjson::kParseDefaultFlags>(wrapper);
   }
 
   static void serialize(JSON &json, std::ostream &out, bool pretty) {
@@ -244,7 +257,7 @@ bool JSON::asBool() const {
 }
 
 Result<JSON, String> JSON::TryParse(StrRef source) {
-  return RapidJSONBridge::parse(String(source.begin(), source.end()));
+  return RapidJSONBridge::parse(source);
 }
 
 Result<JSON, String> JSON::TryParse(std::istream &in) {
@@ -476,6 +489,741 @@ JSON JSON::Array() {
   return j;
 }
 
+/// SAX handler for JSONDocument::parse. Under kParseInsituFlag every string
+/// the reader reports already lives (unescaped) in the document buffer, so a
+/// String node only records its offset and length. Finished nodes wait on a
+/// stack until their parent closes, then move into `nodes` as one contiguous
+/// run of children.
+class JSONDocumentBuilder
+    : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>,
+                                          JSONDocumentBuilder> {
+  using Node = JSONDocument::Node;
+
+  const char *base;
+  Vector<Node> &nodes;
+  Vector<Node> pending;
+  bool overflow = false;
+
+  bool push(const Node &node) {
+    pending.push_back(node);
+    return true;
+  }
+
+  bool pushInt(long long v) {
+    Node node;
+    node.kind = Node::Number;
+    node.i = v;
+    return push(node);
+  }
+
+  bool close(Node::Kind kind, size_t childCount, rapidjson::SizeType length) {
+    if (nodes.size() + childCount >= std::numeric_limits<std::uint32_t>::max()) {
+      overflow = true;
+      return false;
+    }
+    Node node;
+    node.kind = kind;
+    node.length = length;
+    node.first = static_cast<std::uint32_t>(nodes.size());
+    auto children = pending.end() - static_cast<std::ptrdiff_t>(childCount);
+    nodes.insert(nodes.end(), children, pending.end());
+    pending.erase(children, pending.end());
+    return push(node);
+  }
+
+public:
+  JSONDocumentBuilder(const char *base, Vector<Node> &nodes)
+      : base(base), nodes(nodes) {}
+
+  bool Null() { return push(Node()); }
+  bool Bool(bool b) {
+    Node node;
+    node.kind = Node::Boolean;
+    node.b = b;
+    return push(node);
+  }
+  bool Int(int v) { return pushInt(v); }
+  bool Uint(unsigned v) { return pushInt(v); }
+  bool Int64(int64_t v) { return pushInt(v); }
+  bool Uint64(uint64_t v) {
+    if (v <= static_cast<uint64_t>(std::numeric_limits<long long>::max())) {
+      return pushInt(static_cast<long long>(v));
+    }
+    return Double(static_cast<double>(v));
+  }
+  bool Double(double v) {
+    Node node;
+    node.kind = Node::Number;
+    node.real = true;
+    node.d = v;
+    return push(node);
+  }
+  bool String(const char *str, rapidjson::SizeType length, bool) {
+    Node node;
+    node.kind = Node::String;
+    node.length = length;
+    node.first = static_cast<std::uint32_t>(str - base);
+    return push(node);
+  }
+  bool Key(const char *str, rapidjson::SizeType length, bool copy) {
+    return String(str, length, copy);
+  }
+  bool StartObject() { return true; }
+  bool StartArray() { return true; }
+  bool EndObject(rapidjson::SizeType memberCount) {
+    return close(Node::Map, size_t(memberCount) * 2, memberCount);
+  }
+  bool EndArray(rapidjson::SizeType elementCount) {
+    return close(Node::Array, elementCount, elementCount);
+  }
+
+  bool overflowed() const { return overflow; }
+
+  Node root() const {
+    assert(pending.size() == 1);
+    return pending.back();
+  }
+};
+
+Result<JSONDocument, String> JSONDocument::parse(String source) {
+  using DocumentResult = Result<JSONDocument, String>;
+  if (source.size() >= std::numeric_limits<std::uint32_t>::max()) {
+    return DocumentResult::err("JSON document larger than 4 GiB");
+  }
+  JSONDocument document;
+  document.buffer = std::move(source);
+  JSONDocumentBuilder builder(document.buffer.data(), document.nodes);
+  rapidjson::InsituStringStream stream(&document.buffer[0]);
+  rapidjson::Reader reader;
+  rapidjson::ParseResult result =
+      reader.Parse<rapidjson::kParseInsituFlag>(stream, builder);
+  if (builder.overflowed()) {
+    return DocumentResult::err("JSON document has too many nodes");
+  }
+  if (result.IsError()) {
+    return DocumentResult::err(RapidJSONBridge::errorMessage(result));
+  }
+  document.nodes.push_back(builder.root());
+  document.rootIndex = static_cast<std::uint32_t>(document.nodes.size() - 1);
+  return DocumentResult::ok(std::move(document));
+}
+
+Result<JSONDocument, String> JSONDocument::parse(std::istream &in) {
+  String source{std::istreambuf_iterator<char>(in),
+                std::istreambuf_iterator<char>()};
+  return parse(std::move(source));
+}
+
+JSONValue JSONDocument::root() const {
+  if (nodes.empty()) {
+    return {};
+  }
+  return {this, rootIndex};
+}
+
+size_t JSONDocument::nodeCount() const { return nodes.size(); }
+
+JSONValue::JSONValue(const JSONDocument *doc, std::uint32_t index)
+    : doc(doc), index(index) {}
+
+bool JSONValue::valid() const { return doc != nullptr; }
+
+bool JSONValue::isString() const {
+  return doc->nodes[index].kind == JSONDocument::Node::String;
+}
+
+bool JSONValue::isArray() const {
+  return doc->nodes[index].kind == JSONDocument::Node::Array;
+}
+
+bool JSONValue::isMap() const {
+  return doc->nodes[index].kind == JSONDocument::Node::Map;
+}
+
+bool JSONValue::isNumber() const {
+  return doc->nodes[index].kind == JSONDocument::Node::Number;
+}
+
+bool JSONValue::isInt() const { return isNumber() && !doc->nodes[index].real; }
+
+bool JSONValue::isReal() const { return isNumber() && doc->nodes[index].real; }
+
+bool JSONValue::isNull() const {
+  return doc->nodes[index].kind == JSONDocument::Node::Null;
+}
+
+bool JSONValue::isBool() const {
+  return doc->nodes[index].kind == JSONDocument::Node::Boolean;
+}
+
+StrRef JSONValue::asString() const {
+  assert(isString());
+  const auto &node = doc->nodes[index];
+  return {doc->buffer.data() + node.first, node.length};
+}
+
+long long JSONValue::asInt() const {
+  assert(isNumber());
+  const auto &node = doc->nodes[index];
+  return node.real ? static_cast<long long>(node.d) : node.i;
+}
+
+double JSONValue::asDouble() const {
+  assert(isNumber());
+  const auto &node = doc->nodes[index];
+  return node.real ? node.d : static_cast<double>(node.i);
+}
+
+float JSONValue::asFloat() const { return static_cast<float>(asDouble()); }
+
+bool JSONValue::asBool() const {
+  assert(isBool());
+  return doc->nodes[index].b;
+}
+
+size_t JSONValue::size() const {
+  assert((isMap() || isArray()) && "size requires a Map or Array");
+  return doc->nodes[index].length;
+}
+
+bool JSONValue::empty() const { return size() == 0; }
+
+JSONValue JSONValue::operator[](size_t idx) const {
+  assert(isArray() && "index requires an Array");
+  assert(idx < size() && "JSONValue index out of range");
+  return {doc, doc->nodes[index].first + static_cast<std::uint32_t>(idx)};
+}
+
+JSONValue JSONValue::operator[](StrRef key) const { return at(key); }
+
+StrRef JSONValue::keyAt(size_t idx) const {
+  assert(isMap() && "keyAt requires a Map");
+  assert(idx < size() && "JSONValue member index out of range");
+  return JSONValue(doc, doc->nodes[index].first +
+                            static_cast<std::uint32_t>(idx * 2))
+      .asString();
+}
+
+JSONValue JSONValue::valueAt(size_t idx) const {
+  assert(isMap() && "valueAt requires a Map");
+  assert(idx < size() && "JSONValue member index out of range");
+  return {doc,
+          doc->nodes[index].first + static_cast<std::uint32_t>(idx * 2 + 1)};
+}
+
+JSONValue JSONValue::find(StrRef key) const {
+  assert(isMap() && "find requires a Map");
+  const auto &node = doc->nodes[index];
+  for (std::uint32_t i = 0; i < node.length; ++i) {
+    const auto &name = doc->nodes[node.first + i * 2];
+    if (name.length == key.size() &&
+        std::memcmp(doc->buffer.data() + name.first, key.data(), key.size()) ==
+            0) {
+      return {doc, node.first + i * 2 + 1};
+    }
+  }
+  return {};
+}
+
+bool JSONValue::contains(StrRef key) const { return find(key).valid(); }
+
+JSONValue JSONValue::at(StrRef key) const {
+  JSONValue value = find(key);
+  assert(value.valid() && "JSONValue::at key not present");
+  return value;
+}
+
+JSON JSONValue::toJSON() const {
+  const auto &node = doc->nodes[index];
+  switch (node.kind) {
+  case JSONDocument::Node::String: {
+    StrRef str = asString();
+    return JSON(String(str.begin(), str.end()));
+  }
+  case JSONDocument::Node::Array: {
+    JSON json = JSON::Array();
+    json.data.array->reserve(node.length);
+    for (size_t i = 0; i < node.length; ++i) {
+      json.data.array->push_back((*this)[i].toJSON());
+    }
+    return json;
+  }
+  case JSONDocument::Node::Map: {
+    JSON json = JSON::Object();
+    for (size_t i = 0; i < node.length; ++i) {
+      StrRef key = keyAt(i);
+      json.data.map->insert(
+          std::make_pair(String(key.begin(), key.end()), valueAt(i).toJSON()));
+    }
+    return json;
+  }
+  case JSONDocument::Node::Number:
+    return node.real ? JSON(node.d) : JSON(node.i);
+  case JSONDocument::Node::Boolean:
+    return JSON(node.b);
+  case JSONDocument::Node::Null:
+  default:
+    return JSON(nullptr);
+  }
+}
+
+/// Records the single event each RapidJSON IterativeParseNext call produces.
+/// Strings are copied because the reader's own copy only lives for the
+/// callback; `text` keeps its capacity, so steady-state reads do not allocate.
+class JSONEventRecorder
+    : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>,
+                                          JSONEventRecorder> {
+  bool record(JSONReader::Event e) {
+    event = e;
+    return true;
+  }
+
+  bool integer(long long v) {
+    i = v;
+    return record(JSONReader::Int);
+  }
+
+public:
+  JSONReader::Event event = JSONReader::None;
+  OmegaCommon::String text;
+  long long i = 0;
+  double d = 0.0;
+  bool b = false;
+  size_t count = 0;
+
+  bool Null() { return record(JSONReader::Null); }
+  bool Bool(bool v) {
+    b = v;
+    return record(JSONReader::Bool);
+  }
+  bool Int(int v) { return integer(v); }
+  bool Uint(unsigned v) { return integer(v); }
+  bool Int64(int64_t v) { return integer(v); }
+  bool Uint64(uint64_t v) {
+    if (v <= static_cast<uint64_t>(std::numeric_limits<long long>::max())) {
+      return integer(static_cast<long long>(v));
+    }
+    return Double(static_cast<double>(v));
+  }
+  bool Double(double v) {
+    d = v;
+    return record(JSONReader::Real);
+  }
+  bool String(const char *str, rapidjson::SizeType length, bool) {
+    text.assign(str, length);
+    return record(JSONReader::String);
+  }
+  bool Key(const char *str, rapidjson::SizeType length, bool) {
+    text.assign(str, length);
+    return record(JSONReader::Key);
+  }
+  bool StartObject() { return record(JSONReader::StartObject); }
+  bool EndObject(rapidjson::SizeType memberCount) {
+    count = memberCount;
+    return record(JSONReader::EndObject);
+  }
+  bool StartArray() { return record(JSONReader::StartArray); }
+  bool EndArray(rapidjson::SizeType elementCount) {
+    count = elementCount;
+    return record(JSONReader::EndArray);
+  }
+};
+
+struct JSONReader::Impl {
+  rapidjson::MemoryStream memory;
+  rapidjson::EncodedInputStream<rapidjson::UTF8<>, rapidjson::MemoryStream>
+      encoded;
+  std::unique_ptr<rapidjson::IStreamWrapper> wrapper;
+  rapidjson::Reader reader;
+  JSONEventRecorder recorder;
+  size_t depth = 0;
+  bool opened = false;
+  OmegaCommon::String error;
+
+  Impl(const char *data, size_t size) : memory(data, size), encoded(memory) {
+    reader.IterativeParseInit();
+  }
+
+  explicit Impl(std::istream &in)
+      : memory(nullptr, 0), encoded(memory),
+        wrapper(new rapidjson::IStreamWrapper(in)) {
+    reader.IterativeParseInit();
+  }
+
+  bool step() {
+    if (wrapper) {
+      return reader.IterativeParseNext<rapidjson::kParseDefaultFlags>(*wrapper,
+                                                                      recorder);
+    }
+    return reader.IterativeParseNext<rapidjson::kParseDefaultFlags>(encoded,
+                                                                    recorder);
+  }
+};
+
+JSONReader::JSONReader(StrRef source)
+    : impl(new Impl(source.data(), source.size())) {}
+
+JSONReader::JSONReader(std::istream &in) : impl(new Impl(in)) {}
+
+JSONReader::JSONReader(JSONReader &&other) noexcept = default;
+
+JSONReader &JSONReader::operator=(JSONReader &&other) noexcept = default;
+
+JSONReader::~JSONReader() = default;
+
+JSONReader::Event JSONReader::next() {
+  Impl &state = *impl;
+  Event &event = state.recorder.event;
+  if (event == End || event == Error) {
+    return event;
+  }
+  if (state.opened) {
+    ++state.depth;
+    state.opened = false;
+  }
+  if (state.reader.IterativeParseComplete()) {
+    return event = End;
+  }
+  if (!state.step()) {
+    state.error = RapidJSONBridge::errorMessage(rapidjson::ParseResult(
+        state.reader.GetParseErrorCode(), state.reader.GetErrorOffset()));
+    return event = Error;
+  }
+  if (event == StartObject || event == StartArray) {
+    state.opened = true;
+  } else if (event == EndObject || event == EndArray) {
+    --state.depth;
+  }
+  return event;
+}
+
+JSONReader::Event JSONReader::current() const { return impl->recorder.event; }
+
+size_t JSONReader::depth() const { return impl->depth; }
+
+StrRef JSONReader::string() const {
+  assert((current() == Key || current() == String) &&
+         "string() requires a Key or String event");
+  return impl->recorder.text;
+}
+
+long long JSONReader::asInt() const {
+  assert((current() == Int || current() == Real) &&
+         "asInt() requires a number event");
+  return current() == Real ? static_cast<long long>(impl->recorder.d)
+                           : impl->recorder.i;
+}
+
+double JSONReader::asDouble() const {
+  assert((current() == Int || current() == Real) &&
+         "asDouble() requires a number event");
+  return current() == Int ? static_cast<double>(impl->recorder.i)
+                          : impl->recorder.d;
+}
+
+bool JSONReader::asBool() const {
+  assert(current() == Bool && "asBool() requires a Bool event");
+  return impl->recorder.b;
+}
+
+size_t JSONReader::count() const {
+  assert((current() == EndObject || current() == EndArray) &&
+         "count() requires an EndObject or EndArray event");
+  return impl->recorder.count;
+}
+
+const String &JSONReader::error() const { return impl->error; }
+
+namespace {
+
+bool startsValue(JSONReader::Event event) {
+  return event != JSONReader::None && event != JSONReader::Key &&
+         event != JSONReader::EndObject && event != JSONReader::EndArray &&
+         event != JSONReader::End && event != JSONReader::Error;
+}
+
+/// Walk the value starting at the reader's current event, handing each event
+/// to `visit`, and stop on its last event. False on malformed input.
+template <typename Visit> bool walkValue(JSONReader &reader, Visit &&visit) {
+  if (!startsValue(reader.current())) {
+    return false;
+  }
+  const size_t base = reader.depth();
+  JSONReader::Event event = reader.current();
+  while (true) {
+    visit(event);
+    bool closes = event != JSONReader::StartObject &&
+                  event != JSONReader::StartArray &&
+                  event != JSONReader::Key;
+    if (closes && reader.depth() == base) {
+      return true;
+    }
+    event = reader.next();
+    if (event == JSONReader::End || event == JSONReader::Error) {
+      return false;
+    }
+  }
+}
+
+} // namespace
+
+Result<JSON, String> JSONReader::readValue() {
+  using ValueResult = Result<JSON, OmegaCommon::String>;
+  RapidJSONBridge::TreeBuilder builder;
+  const JSONEventRecorder &recorder = impl->recorder;
+  bool ok = walkValue(*this, [&](Event event) {
+    auto length = static_cast<rapidjson::SizeType>(recorder.text.size());
+    switch (event) {
+    case StartObject:
+      builder.StartObject();
+      break;
+    case EndObject:
+      builder.EndObject(static_cast<rapidjson::SizeType>(recorder.count));
+      break;
+    case StartArray:
+      builder.StartArray();
+      break;
+    case EndArray:
+      builder.EndArray(static_cast<rapidjson::SizeType>(recorder.count));
+      break;
+    case Key:
+      builder.Key(recorder.text.data(), length, true);
+      break;
+    case String:
+      builder.String(recorder.text.data(), length, true);
+      break;
+    case Int:
+      builder.Int64(recorder.i);
+      break;
+    case Real:
+      builder.Double(recorder.d);
+      break;
+    case Bool:
+      builder.Bool(recorder.b);
+      break;
+    default:
+      builder.Null();
+      break;
+    }
+  });
+  if (!ok) {
+    return ValueResult::err(current() == Error
+                                ? error()
+                                : "JSONReader is not positioned on a value");
+  }
+  return ValueResult::ok(builder.take());
+}
+
+bool JSONReader::skipValue() {
+  return walkValue(*this, [](Event) {});
+}
+
+/// Forwards RapidJSON SAX callbacks to a JSONEventHandler.
+class JSONEventAdapter
+    : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, JSONEventAdapter> {
+  JSONEventHandler &handler;
+
+public:
+  explicit JSONEventAdapter(JSONEventHandler &handler) : handler(handler) {}
+
+  bool Null() { return handler.onNull(); }
+  bool Bool(bool b) { return handler.onBool(b); }
+  bool Int(int v) { return handler.onInt(v); }
+  bool Uint(unsigned v) { return handler.onInt(v); }
+  bool Int64(int64_t v) { return handler.onInt(v); }
+  bool Uint64(uint64_t v) {
+    if (v <= static_cast<uint64_t>(std::numeric_limits<long long>::max())) {
+      return handler.onInt(static_cast<long long>(v));
+    }
+    return handler.onReal(static_cast<double>(v));
+  }
+  bool Double(double v) { return handler.onReal(v); }
+  bool String(const char *str, rapidjson::SizeType length, bool) {
+    return handler.onString(StrRef(str, length));
+  }
+  bool Key(const char *str, rapidjson::SizeType length, bool) {
+    return handler.onKey(StrRef(str, length));
+  }
+  bool StartObject() { return handler.onStartObject(); }
+  bool EndObject(rapidjson::SizeType memberCount) {
+    return handler.onEndObject(memberCount);
+  }
+  bool StartArray() { return handler.onStartArray(); }
+  bool EndArray(rapidjson::SizeType elementCount) {
+    return handler.onEndArray(elementCount);
+  }
+};
+
+template <typename Stream>
+static Result<void *, String> pushParse(Stream &stream,
+                                        JSONEventHandler &handler) {
+  rapidjson::Reader reader;
+  JSONEventAdapter adapter(handler);
+  rapidjson::ParseResult result =
+      reader.Parse<rapidjson::kParseDefaultFlags>(stream, adapter);
+  if (result.IsError()) {
+    return Result<void *, String>::err(RapidJSONBridge::errorMessage(result));
+  }
+  return Result<void *, String>::ok(nullptr);
+}
+
+Result<void *, String> JSONReader::parse(StrRef source,
+                                         JSONEventHandler &handler) {
+  rapidjson::MemoryStream memory(source.data(), source.size());
+  rapidjson::EncodedInputStream<rapidjson::UTF8<>, rapidjson::MemoryStream>
+      stream(memory);
+  return pushParse(stream, handler);
+}
+
+Result<void *, String> JSONReader::parse(std::istream &in,
+                                         JSONEventHandler &handler) {
+  rapidjson::IStreamWrapper wrapper(in);
+  return pushParse(wrapper, handler);
+}
+
+Result<void *, String> JSONConvertible::fromJSONReader(JSONReader &reader) {
+  auto value = reader.readValue();
+  if (value.isErr()) {
+    return Result<void *, String>::err(value.error());
+  }
+  fromJSON(value.value());
+  return Result<void *, String>::ok(nullptr);
+}
+
+/// Output stream for JSONWriter: a fixed buffer drained into the std::ostream
+/// whenever it fills, so a document of any size is written in constant space.
+class BufferedOStream {
+  std::ostream &out;
+  char buffer[4096];
+  size_t used = 0;
+
+public:
+  typedef char Ch;
+
+  explicit BufferedOStream(std::ostream &out) : out(out) {}
+
+  void Put(char c) {
+    if (used == sizeof(buffer)) {
+      Flush();
+    }
+    buffer[used++] = c;
+  }
+
+  void Flush() {
+    if (used != 0) {
+      out.write(buffer, static_cast<std::streamsize>(used));
+      used = 0;
+    }
+  }
+};
+
+struct JSONWriter::Impl {
+  std::ostream &out;
+  BufferedOStream stream;
+  bool pretty;
+  rapidjson::Writer<BufferedOStream> compact;
+  rapidjson::PrettyWriter<BufferedOStream> indented;
+
+  Impl(std::ostream &out, bool pretty)
+      : out(out), stream(out), pretty(pretty), compact(stream),
+        indented(stream) {}
+
+  template <typename F> void apply(F &&f) {
+    if (pretty) {
+      f(indented);
+    } else {
+      f(compact);
+    }
+  }
+};
+
+JSONWriter::JSONWriter(std::ostream &out, bool pretty)
+    : impl(new Impl(out, pretty)) {}
+
+JSONWriter::JSONWriter(JSONWriter &&other) noexcept = default;
+
+JSONWriter &JSONWriter::operator=(JSONWriter &&other) noexcept {
+  if (this != &other) {
+    if (impl) {
+      impl->stream.Flush();
+    }
+    impl = std::move(other.impl);
+  }
+  return *this;
+}
+
+JSONWriter::~JSONWriter() {
+  if (impl) {
+    impl->stream.Flush();
+  }
+}
+
+void JSONWriter::startObject() {
+  impl->apply([](auto &w) { w.StartObject(); });
+}
+
+void JSONWriter::endObject() {
+  impl->apply([](auto &w) { w.EndObject(); });
+}
+
+void JSONWriter::startArray() {
+  impl->apply([](auto &w) { w.StartArray(); });
+}
+
+void JSONWriter::endArray() {
+  impl->apply([](auto &w) { w.EndArray(); });
+}
+
+void JSONWriter::key(StrRef name) {
+  impl->apply([&](auto &w) {
+    w.Key(name.data(), static_cast<rapidjson::SizeType>(name.size()));
+  });
+}
+
+void JSONWriter::value(StrRef str) {
+  impl->apply([&](auto &w) {
+    w.String(str.data(), static_cast<rapidjson::SizeType>(str.size()));
+  });
+}
+
+void JSONWriter::value(const char *str) { value(StrRef(str)); }
+
+void JSONWriter::value(const String &str) { value(StrRef(str)); }
+
+void JSONWriter::value(long long v) {
+  impl->apply([&](auto &w) { w.Int64(v); });
+}
+
+void JSONWriter::value(int v) { value(static_cast<long long>(v)); }
+
+void JSONWriter::value(double v) {
+  impl->apply([&](auto &w) { w.Double(v); });
+}
+
+void JSONWriter::value(bool b) {
+  impl->apply([&](auto &w) { w.Bool(b); });
+}
+
+void JSONWriter::value(std::nullptr_t) {
+  impl->apply([](auto &w) { w.Null(); });
+}
+
+void JSONWriter::value(const JSON &json) {
+  impl->apply([&](auto &w) {
+    RapidJSONBridge::writeNode(const_cast<JSON &>(json), w);
+  });
+}
+
+bool JSONWriter::complete() const {
+  return impl->pretty ? impl->indented.IsComplete()
+                      : impl->compact.IsComplete();
+}
+
+void JSONWriter::flush() {
+  impl->stream.Flush();
+  impl->out.flush();
+}
+
 std::istream &operator>>(std::istream &in, JSON &json) {
   json = JSON::parse(in);
   return in;
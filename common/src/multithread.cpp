@@ -0,0 +1,209 @@
+#include "omega-common/multithread.h"
+
+#include <algorithm>
+#include <deque>
+
+namespace OmegaCommon {
+
+    namespace {
+
+        struct TaskQueue {
+            std::mutex mutex;
+            std::deque<TaskScheduler::Task> tasks;
+        };
+
+        /// Set on every worker thread; lets submit() route nested work onto the
+        /// submitting worker's own deque.
+        thread_local const void *currentScheduler = nullptr;
+        thread_local unsigned currentWorkerIndex = 0;
+
+    }
+
+    struct TaskScheduler::Impl {
+        std::vector<std::unique_ptr<TaskQueue>> queues;
+        TaskQueue injector;
+        std::vector<Thread> workers;
+
+        std::mutex sleepMutex;
+        std::condition_variable sleepCondition;
+        std::atomic<size_t> queued {0};
+        std::atomic<bool> stopping {false};
+
+        explicit Impl(unsigned workerCount){
+            queues.reserve(workerCount);
+            for(unsigned i = 0;i < workerCount;i++){
+                queues.push_back(std::make_unique<TaskQueue>());
+            }
+        }
+
+        bool isWorker() const {
+            return currentScheduler == this;
+        }
+
+        void push(Task task){
+            TaskQueue & queue = isWorker() ? *queues[currentWorkerIndex] : injector;
+            {
+                std::lock_guard<std::mutex> lk(queue.mutex);
+                queue.tasks.push_back(std::move(task));
+            }
+            queued.fetch_add(1,std::memory_order_release);
+            {
+                // Taken (and dropped) so a worker between its predicate check and
+                // its wait cannot miss this wake-up.
+                std::lock_guard<std::mutex> lk(sleepMutex);
+            }
+            sleepCondition.notify_one();
+        }
+
+        static bool popBack(TaskQueue & queue,Task & out){
+            std::lock_guard<std::mutex> lk(queue.mutex);
+            if(queue.tasks.empty()){
+                return false;
+            }
+            out = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+            return true;
+        }
+
+        static bool popFront(TaskQueue & queue,Task & out){
+            std::lock_guard<std::mutex> lk(queue.mutex);
+            if(queue.tasks.empty()){
+                return false;
+            }
+            out = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            return true;
+        }
+
+        /// Own deque (LIFO), then the injection queue, then steal (FIFO) from
+        /// the other workers starting just past @p self.
+        bool take(Task & out){
+            if(queued.load(std::memory_order_acquire) == 0){
+                return false;
+            }
+            const bool worker = isWorker();
+            const unsigned self = worker ? currentWorkerIndex : 0;
+            bool found = (worker && popBack(*queues[self],out)) || popFront(injector,out);
+            const auto count = static_cast<unsigned>(queues.size());
+            for(unsigned i = 0;!found && i < count;i++){
+                const unsigned victim = (self + i + (worker ? 1 : 0)) % count;
+                if(worker && victim == self){
+                    continue;
+                }
+                found = popFront(*queues[victim],out);
+            }
+            if(found){
+                queued.fetch_sub(1,std::memory_order_acq_rel);
+            }
+            return found;
+        }
+
+        void workerMain(unsigned index){
+            currentScheduler = this;
+            currentWorkerIndex = index;
+            while(true){
+                Task task;
+                if(take(task)){
+                    task();
+                    continue;
+                }
+                std::unique_lock<std::mutex> lk(sleepMutex);
+                sleepCondition.wait(lk,[this](){
+                    return stopping.load(std::memory_order_acquire) ||
+                           queued.load(std::memory_order_acquire) > 0;
+                });
+                if(stopping.load(std::memory_order_acquire) &&
+                   queued.load(std::memory_order_acquire) == 0){
+                    break;
+                }
+            }
+            currentScheduler = nullptr;
+        }
+    };
+
+    TaskScheduler::TaskScheduler(unsigned workerCount){
+        if(workerCount == 0){
+            workerCount = std::max(1u,std::thread::hardware_concurrency());
+        }
+        impl = std::make_unique<Impl>(workerCount);
+        impl->workers.reserve(workerCount);
+        for(unsigned i = 0;i < workerCount;i++){
+            impl->workers.emplace_back([this,i](){
+                impl->workerMain(i);
+            });
+        }
+    }
+
+    TaskScheduler & TaskScheduler::shared(){
+        static TaskScheduler scheduler;
+        return scheduler;
+    }
+
+    unsigned TaskScheduler::workerCount() const {
+        return static_cast<unsigned>(impl->workers.size());
+    }
+
+    bool TaskScheduler::isWorkerThread() const {
+        return impl->isWorker();
+    }
+
+    void TaskScheduler::submit(Task task){
+        impl->push(std::move(task));
+    }
+
+    bool TaskScheduler::runPendingTask(){
+        Task task;
+        if(!impl->take(task)){
+            return false;
+        }
+        task();
+        return true;
+    }
+
+    TaskScheduler::~TaskScheduler(){
+        {
+            std::lock_guard<std::mutex> lk(impl->sleepMutex);
+            impl->stopping.store(true,std::memory_order_release);
+        }
+        impl->sleepCondition.notify_all();
+        for(auto & worker : impl->workers){
+            if(worker.joinable()){
+                worker.join();
+            }
+        }
+    }
+
+    TaskGroup::TaskGroup(TaskScheduler & scheduler):scheduler(scheduler),pending(0){
+
+    }
+
+    void TaskGroup::finishTask(){
+        // Decrement and notify under the lock: wait() re-acquires it before
+        // returning, so the group cannot be destroyed while this still touches it.
+        std::lock_guard<std::mutex> lk(mutex);
+        if(pending.fetch_sub(1,std::memory_order_acq_rel) == 1){
+            condition.notify_all();
+        }
+    }
+
+    void TaskGroup::wait(){
+        while(pending.load(std::memory_order_acquire) > 0){
+            if(scheduler.runPendingTask()){
+                continue;
+            }
+            // Nothing to help with: the group's remaining tasks are running on
+            // other threads. The timeout re-checks the queues in case one of
+            // them spawns more work this thread could pick up.
+            std::unique_lock<std::mutex> lk(mutex);
+            condition.wait_for(lk,std::chrono::milliseconds(1),[this](){
+                return pending.load(std::memory_order_acquire) == 0;
+            });
+        }
+        std::lock_guard<std::mutex> lk(mutex);
+    }
+
+    TaskGroup::~TaskGroup(){
+        wait();
+    }
+
+}
@@ -0,0 +1,328 @@
+#include "omega-common/net.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <streambuf>
+#include <thread>
+
+namespace OmegaCommon {
+
+    namespace {
+
+        /// Threads for backends whose makeRequest blocks until the response is
+        /// in. A blocked request must not hold a TaskScheduler worker (that
+        /// starves parallelFor and decode work), so these run outside the
+        /// compute pool: a thread is started whenever none is idle, and idle
+        /// ones exit after a while.
+        class BlockingIoThreads {
+            static constexpr auto IdleTimeout = std::chrono::seconds(30);
+
+            std::mutex mutex;
+            std::condition_variable available;
+            std::deque<std::function<void()>> queue;
+            unsigned idle = 0;
+
+            void run(){
+                std::unique_lock<std::mutex> lk(mutex);
+                while(true){
+                    ++idle;
+                    const bool woke = available.wait_for(lk,IdleTimeout,[&]{ return !queue.empty(); });
+                    --idle;
+                    if(!woke){
+                        return;
+                    }
+                    auto job = std::move(queue.front());
+                    queue.pop_front();
+                    lk.unlock();
+                    job();
+                    lk.lock();
+                }
+            }
+
+        public:
+            /// Never destroyed: detached threads may still be parked in run()
+            /// while static destructors run.
+            static BlockingIoThreads & shared(){
+                static auto *threads = new BlockingIoThreads();
+                return *threads;
+            }
+
+            void submit(std::function<void()> job){
+                std::lock_guard<std::mutex> lk(mutex);
+                queue.push_back(std::move(job));
+                if(idle >= queue.size()){
+                    available.notify_one();
+                    return;
+                }
+                std::thread([this]{ run(); }).detach();
+            }
+        };
+
+    }
+
+    /// Fallback for backends without a native completion path. Backends that
+    /// have one (curl's event loop, WinHTTP's status callback) override this.
+    Async<HttpResponse> HttpClientContext::makeRequestAsync(HttpRequestDescriptor descriptor) {
+        auto self = shared_from_this();
+        auto promise = std::make_shared<Promise<HttpResponse>>();
+        auto result = promise->async();
+        // The url is a view into the caller's storage; own a copy until the job runs.
+        auto url = std::make_shared<String>(descriptor.url.data(),descriptor.url.size());
+        descriptor.url = StrRef(url->data(),(StrRef::size_type)url->size());
+        BlockingIoThreads::shared().submit([self,promise,url,descriptor = std::move(descriptor)]() mutable {
+            promise->set(self->makeRequest(std::move(descriptor)).get());
+        });
+        return result;
+    }
+
+    namespace {
+
+        /// Fallback for backends without native streaming: buffers the whole
+        /// response, then feeds it to the sink in chunks, honoring Pause.
+        class BufferedHttpStream : public HttpStream,
+                                   public std::enable_shared_from_this<BufferedHttpStream> {
+            static constexpr size_t ChunkSize = 64 * 1024;
+
+            std::shared_ptr<HttpBodySink> sink;
+            Promise<HttpResponse> finished;
+            Async<HttpResponse> finishedAsync;
+
+            std::mutex mutex;
+            HttpResponse response;
+            size_t delivered = 0;
+            bool arrived = false;
+            bool delivering = false;
+            bool paused = false;
+            /// resume() raced ahead of the Pause it answers.
+            bool resumeEarly = false;
+            bool cancelled = false;
+            bool done = false;
+
+            void finish(HttpResponse summary){
+                summary.body.clear();
+                sink->onComplete(summary);
+                finished.set(std::move(summary));
+            }
+
+            /// Runs on whichever thread delivered the response or resumed the stream.
+            void deliver(){
+                while(true){
+                    const std::uint8_t *data = nullptr;
+                    size_t size = 0;
+                    HttpResponse summary;
+                    {
+                        std::lock_guard<std::mutex> lk(mutex);
+                        if(done || paused || !arrived){
+                            delivering = false;
+                            return;
+                        }
+                        if(!cancelled && delivered < response.body.size()){
+                            data = response.body.data() + delivered;
+                            size = std::min(ChunkSize,response.body.size() - delivered);
+                        }
+                        else {
+                            done = true;
+                            summary.statusCode = cancelled ? 0 : response.statusCode;
+                            summary.headers = response.headers;
+                        }
+                    }
+                    if(data == nullptr){
+                        finish(std::move(summary));
+                        return;
+                    }
+                    HttpSinkStatus status = sink->onData(data,size);
+                    std::lock_guard<std::mutex> lk(mutex);
+                    delivered += size;
+                    if(status == HttpSinkStatus::Abort){
+                        cancelled = true;
+                    }
+                    else if(status == HttpSinkStatus::Pause){
+                        paused = !resumeEarly;
+                        resumeEarly = false;
+                    }
+                }
+            }
+
+            void kick(){
+                {
+                    std::lock_guard<std::mutex> lk(mutex);
+                    if(delivering){
+                        return;
+                    }
+                    delivering = true;
+                }
+                deliver();
+            }
+
+        public:
+            explicit BufferedHttpStream(std::shared_ptr<HttpBodySink> sink)
+                :sink(std::move(sink)),finishedAsync(finished.async()){
+
+            }
+
+            void start(Async<HttpResponse> pending){
+                auto self = shared_from_this();
+                pending.onReady([self](HttpResponse & value){
+                    {
+                        std::lock_guard<std::mutex> lk(self->mutex);
+                        self->response = std::move(value);
+                        self->arrived = true;
+                    }
+                    self->sink->onResponse(self->response.statusCode,self->response.headers);
+                    self->kick();
+                });
+            }
+
+            void resume() override {
+                {
+                    std::lock_guard<std::mutex> lk(mutex);
+                    if(!paused){
+                        // The sink may have returned Pause and already been
+                        // drained before this stream recorded it.
+                        resumeEarly = delivering;
+                        return;
+                    }
+                    paused = false;
+                }
+                // Deliver off the caller's thread: it may be a reader holding its
+                // own locks.
+                auto self = shared_from_this();
+                TaskScheduler::shared().submit([self](){ self->kick(); });
+            }
+
+            void cancel() override {
+                {
+                    std::lock_guard<std::mutex> lk(mutex);
+                    cancelled = true;
+                    paused = false;
+                }
+                auto self = shared_from_this();
+                TaskScheduler::shared().submit([self](){ self->kick(); });
+            }
+
+            Async<HttpResponse> completion() override {
+                return finishedAsync;
+            }
+        };
+
+        /// Bounded hand-off between a streaming transfer and a blocking reader.
+        /// The sink pauses the transfer once @c limit bytes are queued; the reader
+        /// resumes it after draining below half of that.
+        class HttpBodyStreamBuf : public std::streambuf {
+        public:
+            class Sink : public HttpBodySink {
+            public:
+                std::mutex mutex;
+                std::condition_variable ready;
+                std::deque<Vector<std::uint8_t>> chunks;
+                size_t queued = 0;
+                size_t limit;
+                bool paused = false;
+                bool finished = false;
+                bool failed = false;
+
+                explicit Sink(size_t limit):limit(std::max<size_t>(limit,1)){
+
+                }
+
+                HttpSinkStatus onData(const std::uint8_t *data,size_t size) override {
+                    std::lock_guard<std::mutex> lk(mutex);
+                    chunks.emplace_back(data,data + size);
+                    queued += size;
+                    ready.notify_one();
+                    if(queued >= limit){
+                        paused = true;
+                        return HttpSinkStatus::Pause;
+                    }
+                    return HttpSinkStatus::Continue;
+                }
+
+                void onComplete(const HttpResponse & response) override {
+                    std::lock_guard<std::mutex> lk(mutex);
+                    finished = true;
+                    failed = response.statusCode == 0;
+                    ready.notify_one();
+                }
+            };
+
+        private:
+            std::shared_ptr<Sink> sink;
+            std::shared_ptr<HttpStream> stream;
+            std::ios & owner;
+            Vector<std::uint8_t> current;
+
+        protected:
+            int_type underflow() override {
+                if(gptr() < egptr()){
+                    return traits_type::to_int_type(*gptr());
+                }
+                bool wake = false;
+                {
+                    std::unique_lock<std::mutex> lk(sink->mutex);
+                    sink->ready.wait(lk,[this](){
+                        return !sink->chunks.empty() || sink->finished;
+                    });
+                    if(sink->chunks.empty()){
+                        if(sink->failed){
+                            owner.setstate(std::ios::badbit);
+                        }
+                        return traits_type::eof();
+                    }
+                    current = std::move(sink->chunks.front());
+                    sink->chunks.pop_front();
+                    sink->queued -= current.size();
+                    if(sink->paused && sink->queued <= sink->limit / 2){
+                        sink->paused = false;
+                        wake = true;
+                    }
+                }
+                if(wake){
+                    stream->resume();
+                }
+                char *begin = reinterpret_cast<char *>(current.data());
+                setg(begin,begin,begin + current.size());
+                return traits_type::to_int_type(*gptr());
+            }
+
+        public:
+            /// @p owner is the stream reading from this buffer; it gets badbit
+            /// when the transfer fails.
+            HttpBodyStreamBuf(std::shared_ptr<Sink> sink,std::shared_ptr<HttpStream> stream,std::ios & owner)
+                :sink(std::move(sink)),stream(std::move(stream)),owner(owner){
+
+            }
+
+            ~HttpBodyStreamBuf() override {
+                stream->cancel();
+            }
+        };
+
+        class HttpBodyStream : public std::istream {
+            HttpBodyStreamBuf buffer;
+        public:
+            HttpBodyStream(std::shared_ptr<HttpBodyStreamBuf::Sink> sink,std::shared_ptr<HttpStream> stream)
+                :std::istream(nullptr),buffer(std::move(sink),std::move(stream),*this){
+                rdbuf(&buffer);
+            }
+        };
+
+    }
+
+    std::shared_ptr<HttpStream> HttpClientContext::makeStreamingRequest(HttpRequestDescriptor descriptor,
+                                                                        std::shared_ptr<HttpBodySink> sink) {
+        auto stream = std::make_shared<BufferedHttpStream>(std::move(sink));
+        stream->start(makeRequestAsync(std::move(descriptor)));
+        return stream;
+    }
+
+    std::unique_ptr<std::istream> HttpClientContext::openStream(HttpRequestDescriptor descriptor,size_t bufferSize) {
+        auto sink = std::make_shared<HttpBodyStreamBuf::Sink>(bufferSize);
+        auto stream = makeStreamingRequest(std::move(descriptor),sink);
+        return std::make_unique<HttpBodyStream>(std::move(sink),std::move(stream));
+    }
+
+}
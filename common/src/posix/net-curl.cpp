@@ -1,12 +1,27 @@
 #include <curl/curl.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cstdio>
 #include <cstdlib>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 #include <unistd.h>
+#include <fcntl.h>
 #include <sys/stat.h>
 
 #include "omega-common/net.h"
 
+// curl_multi_poll (7.66) and curl_multi_wakeup (7.68) let the event loop sleep
+// until a socket or another thread wakes it. Older libcurl gets the same
+// behavior from curl_multi_wait plus a self-pipe.
+#if LIBCURL_VERSION_NUM >= 0x074400
+#define OMEGACOMMON_CURL_MULTI_WAKEUP 1
+#endif
+
 namespace OmegaCommon {
 
     static struct CurlGlobalInit {
@@ -62,32 +77,124 @@ namespace OmegaCommon {
         }
     };
 
-    class CURLHttpClientContext : public HttpClientContext {
+    /// Requests from other threads to a streaming transfer. Applied by the
+    /// loop thread, which alone may pause, unpause or remove easy handles.
+    struct CurlStreamControl {
+        std::atomic<bool> resumeRequested{false};
+        std::atomic<bool> cancelRequested{false};
+    };
+
+    /// One request in flight on a CurlEventLoop: the copied descriptor, its
+    /// easy handle, the response being collected, and where to deliver it.
+    struct CurlTransfer {
+        String url;
+        HttpMethod method = HttpMethod::Get;
+        String body;
+        Vector<std::pair<String, String>> headers;
+        Optional<HttpByteRange> range;
+        std::function<void(HttpResponse)> complete;
+
+        /// Streaming mode: the body goes to @c sink instead of @c responseBody.
+        std::shared_ptr<HttpBodySink> sink;
+        std::shared_ptr<CurlStreamControl> control;
+        bool sinkHasResponse = false;
+        bool paused = false;
+
+        CURL *easy = nullptr;
+        struct curl_slist *headerList = nullptr;
+        Vector<std::uint8_t> responseBody;
+        Vector<std::pair<String, String>> responseHeaders;
+
+        void deliverResponseHead() {
+            if (sinkHasResponse)
+                return;
+            sinkHasResponse = true;
+            long code = 0;
+            curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &code);
+            sink->onResponse((int)code, responseHeaders);
+        }
+    };
+
+    /// Drives every transfer of one client context from a single thread on a
+    /// curl multi handle. Connections, the DNS cache and TLS sessions persist
+    /// across requests (the multi handle pools connections, the share handle
+    /// holds DNS and TLS session state), and easy handles are recycled, so
+    /// repeat requests to a host skip the TCP and TLS handshakes. Owned jointly
+    /// by the context and the loop thread, so the context may be released from
+    /// a completion running on that thread.
+    class CurlEventLoop {
         HttpTlsConfig tlsConfig_;
         TempPemFile caTempFile_;
         TempPemFile certTempFile_;
         TempPemFile keyTempFile_;
+        HttpClientOptions options_;
+
+        CURLM *multi_ = nullptr;
+        CURLSH *share_ = nullptr;
 
-        struct TransferState {
-            Vector<std::uint8_t> body;
-            Vector<std::pair<String, String>> responseHeaders;
-        };
+        std::mutex queueMutex_;
+        std::deque<std::unique_ptr<CurlTransfer>> submitted_;
+        bool stopping_ = false;
+
+        /// Loop-thread state.
+        std::deque<std::unique_ptr<CurlTransfer>> waiting_;
+        std::unordered_map<CURL *, std::unique_ptr<CurlTransfer>> running_;
+        Vector<CURL *> idleHandles_;
+
+        /// Set when some stream asked to resume or cancel.
+        std::atomic<bool> controlPending_{false};
+
+        std::thread thread_;
+
+#if !defined(OMEGACOMMON_CURL_MULTI_WAKEUP)
+        /// Read end is polled alongside curl's sockets; wake() writes to it.
+        int wakePipe_[2] = {-1, -1};
+#endif
+
+        /// Largest body pre-reserved from Content-Length; beyond it the
+        /// buffer grows as data arrives.
+        static constexpr curl_off_t MaxReserve = 64 * 1024 * 1024;
 
         static size_t writeCallback(char *ptr, size_t size, size_t nmemb, void *userdata) {
             size_t bytes = size * nmemb;
-            auto *state = static_cast<TransferState *>(userdata);
-            state->body.insert(state->body.end(), ptr, ptr + bytes);
+            auto *transfer = static_cast<CurlTransfer *>(userdata);
+            if (transfer->sink) {
+                // A chunk offered while paused is kept by curl and offered
+                // again after unpausing.
+                if (transfer->paused)
+                    return CURL_WRITEFUNC_PAUSE;
+                transfer->deliverResponseHead();
+                HttpSinkStatus status = transfer->sink->onData(reinterpret_cast<const std::uint8_t *>(ptr), bytes);
+                if (status == HttpSinkStatus::Abort)
+                    return 0;
+                if (status == HttpSinkStatus::Pause)
+                    transfer->paused = true;
+                return bytes;
+            }
+            if (transfer->responseBody.empty() && transfer->responseBody.capacity() == 0) {
+                curl_off_t length = -1;
+                curl_easy_getinfo(transfer->easy, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &length);
+                if (length > 0)
+                    transfer->responseBody.reserve((size_t)std::min(length, MaxReserve));
+            }
+            transfer->responseBody.insert(transfer->responseBody.end(), ptr, ptr + bytes);
             return bytes;
         }
 
         static size_t headerCallback(char *buffer, size_t size, size_t nitems, void *userdata) {
             size_t bytes = size * nitems;
-            auto *state = static_cast<TransferState *>(userdata);
+            auto *transfer = static_cast<CurlTransfer *>(userdata);
             String line(buffer, bytes);
             while (!line.empty() && (line.back() == '\r' || line.back() == '\n'))
                 line.pop_back();
-            if (line.empty() || line.rfind("HTTP/", 0) == 0)
+            if (line.empty())
                 return bytes;
+            if (line.rfind("HTTP/", 0) == 0) {
+                // A new status line (after a 100-continue or redirect) starts
+                // a fresh header block.
+                transfer->responseHeaders.clear();
+                return bytes;
+            }
             auto colon = line.find(':');
             if (colon != String::npos) {
                 String key = line.substr(0, colon);
@@ -97,7 +204,7 @@ namespace OmegaCommon {
                     value = value.substr(start);
                 else
                     value.clear();
-                state->responseHeaders.push_back({std::move(key), std::move(value)});
+                transfer->responseHeaders.push_back({std::move(key), std::move(value)});
             }
             return bytes;
         }
@@ -118,33 +225,38 @@ namespace OmegaCommon {
                 curl_easy_setopt(curl, CURLOPT_SSLKEY, keyTempFile_.path());
         }
 
-    public:
-        CURLHttpClientContext() = default;
-
-        explicit CURLHttpClientContext(HttpTlsConfig config)
-            : tlsConfig_(std::move(config))
-        {
-            if (!tlsConfig_.caBundlePem.empty())
-                caTempFile_ = TempPemFile(tlsConfig_.caBundlePem);
-            if (!tlsConfig_.clientCertPem.empty())
-                certTempFile_ = TempPemFile(tlsConfig_.clientCertPem);
-            if (!tlsConfig_.clientKeyPem.empty())
-                keyTempFile_ = TempPemFile(tlsConfig_.clientKeyPem);
+        CURL *acquireHandle() {
+            if (idleHandles_.empty())
+                return curl_easy_init();
+            CURL *curl = idleHandles_.back();
+            idleHandles_.pop_back();
+            // Clears options only; live connections and caches are kept.
+            curl_easy_reset(curl);
+            return curl;
         }
 
-        std::future<HttpResponse> makeRequest(HttpRequestDescriptor descriptor) override {
-            std::promise<HttpResponse> promise;
-            auto future = promise.get_future();
+        void releaseHandle(CURL *curl) {
+            if (idleHandles_.size() < options_.maxConcurrentRequests)
+                idleHandles_.push_back(curl);
+            else
+                curl_easy_cleanup(curl);
+        }
 
-            CURL *curl = curl_easy_init();
-            if (!curl) {
-                promise.set_value(HttpResponse{});
-                return future;
+        void configure(CurlTransfer &transfer) {
+            CURL *curl = transfer.easy;
+            curl_easy_setopt(curl, CURLOPT_URL, transfer.url.c_str());
+            curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+            curl_easy_setopt(curl, CURLOPT_SHARE, share_);
+
+            if (options_.http2) {
+                curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_2TLS);
+                // Prefer waiting for a multiplexable connection over opening another.
+                curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);
+            } else {
+                curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_1_1);
             }
 
-            curl_easy_setopt(curl, CURLOPT_URL, descriptor.url.data());
-
-            switch (descriptor.method) {
+            switch (transfer.method) {
                 case HttpMethod::Get:
                     break;
                 case HttpMethod::Post:
@@ -167,47 +279,384 @@ namespace OmegaCommon {
                     break;
             }
 
-            if (!descriptor.body.empty()) {
-                curl_easy_setopt(curl, CURLOPT_POSTFIELDS, descriptor.body.data());
-                curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, (long)descriptor.body.size());
+            if (!transfer.body.empty()) {
+                curl_easy_setopt(curl, CURLOPT_POSTFIELDS, transfer.body.data());
+                curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, (curl_off_t)transfer.body.size());
             }
 
-            struct curl_slist *headerList = nullptr;
-            for (const auto &h : descriptor.headers) {
+            for (const auto &h : transfer.headers) {
                 String headerLine = h.first + ": " + h.second;
-                headerList = curl_slist_append(headerList, headerLine.c_str());
+                transfer.headerList = curl_slist_append(transfer.headerList, headerLine.c_str());
+            }
+            if (transfer.headerList)
+                curl_easy_setopt(curl, CURLOPT_HTTPHEADER, transfer.headerList);
+
+            if (transfer.range) {
+                String spec = transfer.range->spec();
+                // Copied by curl.
+                curl_easy_setopt(curl, CURLOPT_RANGE, spec.c_str());
             }
-            if (headerList)
-                curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headerList);
 
-            TransferState state;
             curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
-            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &state);
+            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &transfer);
             curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, headerCallback);
-            curl_easy_setopt(curl, CURLOPT_HEADERDATA, &state);
+            curl_easy_setopt(curl, CURLOPT_HEADERDATA, &transfer);
 
             applyTlsConfig(curl);
+        }
 
-            CURLcode res = curl_easy_perform(curl);
+        void startWaiting() {
+            while (!waiting_.empty() && running_.size() < options_.maxConcurrentRequests) {
+                std::unique_ptr<CurlTransfer> transfer = std::move(waiting_.front());
+                waiting_.pop_front();
+                if (transfer->control && transfer->control->cancelRequested.load()) {
+                    fail(*transfer);
+                    continue;
+                }
+                transfer->easy = acquireHandle();
+                if (!transfer->easy) {
+                    fail(*transfer);
+                    continue;
+                }
+                configure(*transfer);
+                CURL *curl = transfer->easy;
+                if (curl_multi_add_handle(multi_, curl) != CURLM_OK) {
+                    finish(std::move(transfer), CURLE_FAILED_INIT);
+                    continue;
+                }
+                running_.emplace(curl, std::move(transfer));
+            }
+        }
 
+        /// Deliver an empty (failed) response for a transfer that never ran.
+        static void fail(CurlTransfer &transfer) {
             HttpResponse response;
-            if (res == CURLE_OK) {
+            if (transfer.sink)
+                transfer.sink->onComplete(response);
+            transfer.complete(std::move(response));
+        }
+
+        /// Detach the transfer's handle and deliver its response. `complete`
+        /// may release the last reference to the owning context.
+        void finish(std::unique_ptr<CurlTransfer> transfer, CURLcode result) {
+            CURL *curl = transfer->easy;
+            HttpResponse response;
+            if (result == CURLE_OK) {
+                if (transfer->sink)
+                    transfer->deliverResponseHead();
                 long code = 0;
                 curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &code);
                 response.statusCode = (int)code;
-                response.body = std::move(state.body);
-                response.headers = std::move(state.responseHeaders);
+                response.body = std::move(transfer->responseBody);
+                response.headers = std::move(transfer->responseHeaders);
+            }
+            if (transfer->headerList) {
+                curl_slist_free_all(transfer->headerList);
+                transfer->headerList = nullptr;
+            }
+            releaseHandle(curl);
+            transfer->easy = nullptr;
+            if (transfer->sink)
+                transfer->sink->onComplete(response);
+            transfer->complete(std::move(response));
+        }
+
+        /// Apply resume and cancel requests from streaming handles.
+        void applyControls() {
+            // A cancelled transfer still waiting for a slot never started, so
+            // it fails right away instead of when a slot frees up.
+            for (auto it = waiting_.begin(); it != waiting_.end();) {
+                if ((*it)->control && (*it)->control->cancelRequested.load()) {
+                    std::unique_ptr<CurlTransfer> transfer = std::move(*it);
+                    it = waiting_.erase(it);
+                    fail(*transfer);
+                } else {
+                    ++it;
+                }
             }
 
-            if (headerList)
-                curl_slist_free_all(headerList);
-            curl_easy_cleanup(curl);
+            Vector<CURL *> cancelled;
+            for (auto &entry : running_) {
+                CurlTransfer &transfer = *entry.second;
+                if (!transfer.control)
+                    continue;
+                if (transfer.control->cancelRequested.load()) {
+                    cancelled.push_back(entry.first);
+                    continue;
+                }
+                if (transfer.control->resumeRequested.exchange(false) && transfer.paused) {
+                    // Unpausing may re-enter writeCallback, which can pause again.
+                    transfer.paused = false;
+                    curl_easy_pause(entry.first, CURLPAUSE_CONT);
+                }
+            }
+            for (CURL *curl : cancelled) {
+                auto it = running_.find(curl);
+                std::unique_ptr<CurlTransfer> transfer = std::move(it->second);
+                running_.erase(it);
+                curl_multi_remove_handle(multi_, curl);
+                finish(std::move(transfer), CURLE_ABORTED_BY_CALLBACK);
+            }
+        }
+
+        void collectFinished() {
+            int remaining = 0;
+            while (CURLMsg *msg = curl_multi_info_read(multi_, &remaining)) {
+                if (msg->msg != CURLMSG_DONE)
+                    continue;
+                CURL *curl = msg->easy_handle;
+                CURLcode result = msg->data.result;
+                auto it = running_.find(curl);
+                if (it == running_.end())
+                    continue;
+                std::unique_ptr<CurlTransfer> transfer = std::move(it->second);
+                running_.erase(it);
+                curl_multi_remove_handle(multi_, curl);
+                finish(std::move(transfer), result);
+            }
+        }
 
-            promise.set_value(std::move(response));
+        void run() {
+            while (true) {
+                {
+                    std::lock_guard<std::mutex> lk(queueMutex_);
+                    if (stopping_)
+                        break;
+                    while (!submitted_.empty()) {
+                        waiting_.push_back(std::move(submitted_.front()));
+                        submitted_.pop_front();
+                    }
+                }
+                if (controlPending_.exchange(false))
+                    applyControls();
+                startWaiting();
+                int active = 0;
+                curl_multi_perform(multi_, &active);
+                collectFinished();
+                // Finished transfers may have freed slots for waiting ones.
+                if (!waiting_.empty() && running_.size() < options_.maxConcurrentRequests)
+                    continue;
+                waitForActivity();
+            }
+
+            // Stopped: fail whatever has not completed.
+            for (auto &entry : running_) {
+                curl_multi_remove_handle(multi_, entry.first);
+                finish(std::move(entry.second), CURLE_ABORTED_BY_CALLBACK);
+            }
+            running_.clear();
+            {
+                std::lock_guard<std::mutex> lk(queueMutex_);
+                while (!submitted_.empty()) {
+                    waiting_.push_back(std::move(submitted_.front()));
+                    submitted_.pop_front();
+                }
+            }
+            for (auto &transfer : waiting_)
+                fail(*transfer);
+            waiting_.clear();
+        }
+
+        /// Sleep until a socket is ready, wake() is called or a second passes.
+        void waitForActivity() {
+#if defined(OMEGACOMMON_CURL_MULTI_WAKEUP)
+            curl_multi_poll(multi_, nullptr, 0, 1000, nullptr);
+#else
+            struct curl_waitfd wakeFd = {wakePipe_[0], CURL_WAIT_POLLIN, 0};
+            curl_multi_wait(multi_, &wakeFd, 1, 1000, nullptr);
+            if (wakeFd.revents != 0) {
+                char drain[64];
+                while (read(wakePipe_[0], drain, sizeof(drain)) > 0) {
+                }
+            }
+#endif
+        }
+
+        /// Interrupt waitForActivity. Any thread.
+        void wake() {
+#if defined(OMEGACOMMON_CURL_MULTI_WAKEUP)
+            curl_multi_wakeup(multi_);
+#else
+            const char byte = 1;
+            // A full pipe already holds a pending wake-up.
+            ssize_t written = write(wakePipe_[1], &byte, 1);
+            (void)written;
+#endif
+        }
+
+    public:
+        CurlEventLoop(HttpTlsConfig config, HttpClientOptions options)
+            : tlsConfig_(std::move(config)), options_(options)
+        {
+            if (options_.maxConcurrentRequests == 0)
+                options_.maxConcurrentRequests = 1;
+            if (!tlsConfig_.caBundlePem.empty())
+                caTempFile_ = TempPemFile(tlsConfig_.caBundlePem);
+            if (!tlsConfig_.clientCertPem.empty())
+                certTempFile_ = TempPemFile(tlsConfig_.clientCertPem);
+            if (!tlsConfig_.clientKeyPem.empty())
+                keyTempFile_ = TempPemFile(tlsConfig_.clientKeyPem);
+
+            multi_ = curl_multi_init();
+            curl_multi_setopt(multi_, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+            curl_multi_setopt(multi_, CURLMOPT_MAX_HOST_CONNECTIONS, (long)options_.maxConnectionsPerHost);
+
+            // Only the loop thread touches the share handle, so it needs no
+            // lock callbacks.
+            share_ = curl_share_init();
+            curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+            curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+
+#if !defined(OMEGACOMMON_CURL_MULTI_WAKEUP)
+            if (pipe(wakePipe_) == 0) {
+                for (int fd : wakePipe_)
+                    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+            }
+#endif
+        }
+
+        static void start(const std::shared_ptr<CurlEventLoop> &loop) {
+            loop->thread_ = std::thread([loop]() { loop->run(); });
+        }
+
+        void submit(std::unique_ptr<CurlTransfer> transfer) {
+            {
+                std::lock_guard<std::mutex> lk(queueMutex_);
+                if (!stopping_) {
+                    submitted_.push_back(std::move(transfer));
+                }
+            }
+            if (transfer) {
+                fail(*transfer);
+                return;
+            }
+            wake();
+        }
+
+        /// Wake the loop to apply a CurlStreamControl request. Any thread.
+        void poke() {
+            controlPending_.store(true);
+            wake();
+        }
+
+        /// Stop the loop, failing unfinished transfers. Joins unless called
+        /// from the loop thread itself (a completion dropped the context), in
+        /// which case the thread finishes on its own.
+        void shutdown() {
+            {
+                std::lock_guard<std::mutex> lk(queueMutex_);
+                stopping_ = true;
+            }
+            wake();
+            if (std::this_thread::get_id() == thread_.get_id())
+                thread_.detach();
+            else if (thread_.joinable())
+                thread_.join();
+        }
+
+        ~CurlEventLoop() {
+            for (CURL *curl : idleHandles_)
+                curl_easy_cleanup(curl);
+            curl_multi_cleanup(multi_);
+            curl_share_cleanup(share_);
+#if !defined(OMEGACOMMON_CURL_MULTI_WAKEUP)
+            for (int fd : wakePipe_)
+                if (fd >= 0)
+                    close(fd);
+#endif
+        }
+    };
+
+    class CurlHttpStream : public HttpStream {
+        std::weak_ptr<CurlEventLoop> loop_;
+        std::shared_ptr<CurlStreamControl> control_;
+        Async<HttpResponse> completion_;
+
+    public:
+        CurlHttpStream(std::weak_ptr<CurlEventLoop> loop, std::shared_ptr<CurlStreamControl> control,
+                       Async<HttpResponse> completion)
+            : loop_(std::move(loop)), control_(std::move(control)), completion_(std::move(completion)) {}
+
+        void resume() override {
+            control_->resumeRequested.store(true);
+            if (auto loop = loop_.lock())
+                loop->poke();
+        }
+
+        void cancel() override {
+            control_->cancelRequested.store(true);
+            if (auto loop = loop_.lock())
+                loop->poke();
+        }
+
+        Async<HttpResponse> completion() override {
+            return completion_;
+        }
+    };
+
+    class CURLHttpClientContext : public HttpClientContext {
+        std::shared_ptr<CurlEventLoop> loop_;
+
+        void submit(HttpRequestDescriptor descriptor, std::function<void(HttpResponse)> complete,
+                    std::shared_ptr<HttpBodySink> sink = nullptr,
+                    std::shared_ptr<CurlStreamControl> control = nullptr) {
+            auto transfer = std::make_unique<CurlTransfer>();
+            transfer->url.assign(descriptor.url.data(), descriptor.url.size());
+            transfer->method = descriptor.method;
+            transfer->body = std::move(descriptor.body);
+            transfer->headers = std::move(descriptor.headers);
+            transfer->range = descriptor.range;
+            transfer->sink = std::move(sink);
+            transfer->control = std::move(control);
+            // Holding the context keeps the loop running until delivery.
+            transfer->complete = [self = shared_from_this(), complete = std::move(complete)](HttpResponse response) mutable {
+                complete(std::move(response));
+            };
+            loop_->submit(std::move(transfer));
+        }
+
+    public:
+        explicit CURLHttpClientContext(HttpTlsConfig config = {}, HttpClientOptions options = {})
+            : loop_(std::make_shared<CurlEventLoop>(std::move(config), options))
+        {
+            CurlEventLoop::start(loop_);
+        }
+
+        std::future<HttpResponse> makeRequest(HttpRequestDescriptor descriptor) override {
+            auto promise = std::make_shared<std::promise<HttpResponse>>();
+            auto future = promise->get_future();
+            submit(std::move(descriptor), [promise](HttpResponse response) {
+                promise->set_value(std::move(response));
+            });
             return future;
         }
 
-        ~CURLHttpClientContext() override = default;
+        /// Completes on the loop thread without occupying a scheduler worker.
+        Async<HttpResponse> makeRequestAsync(HttpRequestDescriptor descriptor) override {
+            auto promise = std::make_shared<Promise<HttpResponse>>();
+            auto result = promise->async();
+            submit(std::move(descriptor), [promise](HttpResponse response) {
+                promise->set(std::move(response));
+            });
+            return result;
+        }
+
+        /// Pausing stops reading the socket, so the server is throttled by TCP
+        /// (or HTTP/2 stream) flow control rather than buffered here.
+        std::shared_ptr<HttpStream> makeStreamingRequest(HttpRequestDescriptor descriptor,
+                                                         std::shared_ptr<HttpBodySink> sink) override {
+            auto promise = std::make_shared<Promise<HttpResponse>>();
+            auto control = std::make_shared<CurlStreamControl>();
+            auto stream = std::make_shared<CurlHttpStream>(loop_, control, promise->async());
+            submit(std::move(descriptor), [promise](HttpResponse response) {
+                promise->set(std::move(response));
+            }, std::move(sink), std::move(control));
+            return stream;
+        }
+
+        ~CURLHttpClientContext() override {
+            loop_->shutdown();
+        }
     };
 
     std::shared_ptr<HttpClientContext> HttpClientContext::Create() {
@@ -217,4 +666,8 @@ namespace OmegaCommon {
     std::shared_ptr<HttpClientContext> HttpClientContext::Create(HttpTlsConfig config) {
         return std::make_shared<CURLHttpClientContext>(std::move(config));
     }
+
+    std::shared_ptr<HttpClientContext> HttpClientContext::Create(HttpTlsConfig config, HttpClientOptions options) {
+        return std::make_shared<CURLHttpClientContext>(std::move(config), options);
+    }
 }
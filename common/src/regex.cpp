@@ -3,13 +3,102 @@
 
 #include "omega-common/regex.h"
 
+#include <mutex>
+
 namespace OmegaCommon {
 
+    namespace {
+
+        constexpr PCRE2_SIZE JitStackStartSize = 32 * 1024;
+        constexpr PCRE2_SIZE JitStackMaxSize = 1024 * 1024;
+        constexpr size_t PooledMatchDataLimit = 8;
+
+        /// Matching state owned by each thread and shared by every Regex it
+        /// runs: a match context carrying a JIT stack large enough for deep
+        /// patterns, and a free list of match-data blocks. Keeping it per
+        /// thread is what lets one compiled Regex serve many threads.
+        struct ThreadMatchState {
+            pcre2_match_context *context = nullptr;
+            pcre2_jit_stack *jitStack = nullptr;
+            Vector<pcre2_match_data *> freeMatchData;
+
+            ThreadMatchState() {
+                context = pcre2_match_context_create(nullptr);
+                jitStack = pcre2_jit_stack_create(JitStackStartSize, JitStackMaxSize, nullptr);
+                if (context && jitStack)
+                    pcre2_jit_stack_assign(context, nullptr, jitStack);
+            }
+
+            ~ThreadMatchState() {
+                for (auto *matchData : freeMatchData)
+                    pcre2_match_data_free(matchData);
+                if (jitStack)
+                    pcre2_jit_stack_free(jitStack);
+                if (context)
+                    pcre2_match_context_free(context);
+            }
+        };
+
+        ThreadMatchState & threadMatchState() {
+            thread_local ThreadMatchState state;
+            return state;
+        }
+
+        /// Match data on loan from the calling thread's pool. Leases nest, so
+        /// a scanAll() callback can run other searches on the same thread.
+        class PooledMatchData {
+            pcre2_match_data *matchData = nullptr;
+        public:
+            explicit PooledMatchData(uint32_t pairs) {
+                auto & pool = threadMatchState().freeMatchData;
+                while (!pool.empty()) {
+                    auto *candidate = pool.back();
+                    pool.pop_back();
+                    if (pcre2_get_ovector_count(candidate) >= pairs) {
+                        matchData = candidate;
+                        return;
+                    }
+                    pcre2_match_data_free(candidate);
+                }
+                matchData = pcre2_match_data_create(pairs, nullptr);
+            }
+
+            PooledMatchData(const PooledMatchData &) = delete;
+            PooledMatchData & operator=(const PooledMatchData &) = delete;
+
+            ~PooledMatchData() {
+                auto & pool = threadMatchState().freeMatchData;
+                if (pool.size() < PooledMatchDataLimit)
+                    pool.push_back(matchData);
+                else
+                    pcre2_match_data_free(matchData);
+            }
+
+            pcre2_match_data *get() const { return matchData; }
+        };
+
+    }
+
     struct RegexImpl {
-        pcre2_code *code;
+        pcre2_code *code = nullptr;
+        String pattern;
+        uint32_t flags = 0;
+        /// Ovector pairs: the full match plus every capture group.
+        uint32_t pairs = 1;
+        bool jit = false;
+        bool utf = false;
+
+        /// The pattern anchored at both ends, for matches(). JIT cannot honour
+        /// PCRE2_ANCHORED passed at match time, so it gets its own compile,
+        /// made on first use.
+        std::once_flag wholeOnce;
+        pcre2_code *wholeCode = nullptr;
+
         ~RegexImpl() {
             if (code)
                 pcre2_code_free(code);
+            if (wholeCode)
+                pcre2_code_free(wholeCode);
         }
     };
 
@@ -19,6 +108,33 @@ namespace OmegaCommon {
         return captures.at(index);
     }
 
+    // --- RegexMatchView ---
+
+    RegexMatchView::RegexMatchView(StrRef input, const size_t *ovector, size_t pairs)
+        : input(input), ovector(ovector), pairs(pairs) {}
+
+    RegexCapture RegexMatchView::fullMatch() const {
+        return {ovector[0], ovector[1],
+                StrRef(input.data() + ovector[0], (StrRef::size_type)(ovector[1] - ovector[0]))};
+    }
+
+    RegexCapture RegexMatchView::group(size_t index) const {
+        size_t pair = index + 1;
+        if (pair >= pairs || ovector[2 * pair] == PCRE2_UNSET)
+            return {0, 0, StrRef()};
+        size_t s = ovector[2 * pair];
+        size_t e = ovector[2 * pair + 1];
+        return {s, e, StrRef(input.data() + s, (StrRef::size_type)(e - s))};
+    }
+
+    RegexMatch RegexMatchView::toMatch() const {
+        RegexMatch match{fullMatch(), {}};
+        match.captures.reserve(captureCount());
+        for (size_t i = 0; i < captureCount(); ++i)
+            match.captures.push_back(group(i));
+        return match;
+    }
+
     // --- Regex lifecycle ---
 
     Regex::Regex(RegexImpl *p) : impl(p) {}
@@ -65,6 +181,25 @@ namespace OmegaCommon {
         return "Unknown PCRE2 error";
     }
 
+    static RegexError makeError(int code) {
+        RegexError err;
+        err.code = code;
+        err.offset = 0;
+        err.message = pcre2ErrorMessage(code);
+        return err;
+    }
+
+    static int runMatch(const pcre2_code *code, StrRef input, size_t offset, pcre2_match_data *matchData) {
+        return pcre2_match(
+            code,
+            reinterpret_cast<PCRE2_SPTR>(input.data()),
+            input.size(),
+            offset,
+            0,
+            matchData,
+            threadMatchState().context);
+    }
+
     static RegexMatch buildMatch(StrRef input, pcre2_match_data *matchData, uint32_t captureCount) {
         PCRE2_SIZE *ovector = pcre2_get_ovector_pointer(matchData);
 
@@ -87,6 +222,40 @@ namespace OmegaCommon {
         return RegexMatch{std::move(full), std::move(caps)};
     }
 
+    /// Runs @p onMatch(matchData, rc) for each successive non-overlapping
+    /// match until it returns false. After an empty match the scan resumes one
+    /// character (one code point in UTF mode) further on.
+    template<class FnT>
+    static size_t forEachMatch(const RegexImpl & impl, StrRef input, FnT && onMatch) {
+        PooledMatchData matchData(impl.pairs);
+        size_t count = 0;
+        size_t offset = 0;
+
+        while (offset <= input.size()) {
+            int rc = runMatch(impl.code, input, offset, matchData.get());
+            if (rc < 0)
+                break;
+
+            ++count;
+            if (!onMatch(matchData.get(), rc))
+                break;
+
+            PCRE2_SIZE *ovector = pcre2_get_ovector_pointer(matchData.get());
+            size_t matchStart = ovector[0];
+            size_t matchEnd = ovector[1];
+            if (matchEnd > matchStart) {
+                offset = matchEnd;
+                continue;
+            }
+            offset = matchEnd + 1;
+            if (impl.utf) {
+                while (offset < input.size() && (static_cast<unsigned char>(input.data()[offset]) & 0xC0) == 0x80)
+                    ++offset;
+            }
+        }
+        return count;
+    }
+
     // --- Regex API ---
 
     Result<Regex, RegexError> Regex::compile(StrRef pattern, unsigned options) {
@@ -110,27 +279,59 @@ namespace OmegaCommon {
             return Result<Regex, RegexError>::err(std::move(err));
         }
 
-        return Result<Regex, RegexError>::ok(Regex(new RegexImpl{code}));
+        auto *impl = new RegexImpl;
+        impl->code = code;
+        impl->pattern = String(pattern.data(), pattern.size());
+        impl->flags = pcre2Opts;
+        impl->utf = (pcre2Opts & PCRE2_UTF) != 0;
+
+        uint32_t captureCount = 0;
+        pcre2_pattern_info(code, PCRE2_INFO_CAPTURECOUNT, &captureCount);
+        impl->pairs = captureCount + 1;
+
+        // Platforms without JIT support (or with W^X restrictions) report an
+        // error here and keep using the interpreter.
+        if (!(options & static_cast<unsigned>(RegexOption::NoJit)))
+            impl->jit = pcre2_jit_compile(code, PCRE2_JIT_COMPLETE) == 0;
+
+        return Result<Regex, RegexError>::ok(Regex(impl));
+    }
+
+    bool Regex::isJitCompiled() const {
+        return impl->jit;
     }
 
     bool Regex::matches(StrRef input) const {
-        pcre2_match_data *matchData = pcre2_match_data_create_from_pattern(impl->code, nullptr);
+        std::call_once(impl->wholeOnce, [this]() {
+            int errorCode;
+            PCRE2_SIZE errorOffset;
+            impl->wholeCode = pcre2_compile(
+                reinterpret_cast<PCRE2_SPTR>(impl->pattern.data()),
+                impl->pattern.size(),
+                impl->flags | PCRE2_ANCHORED | PCRE2_ENDANCHORED,
+                &errorCode,
+                &errorOffset,
+                nullptr);
+            if (impl->wholeCode && impl->jit)
+                pcre2_jit_compile(impl->wholeCode, PCRE2_JIT_COMPLETE);
+        });
+
+        PooledMatchData matchData(impl->pairs);
+        if (impl->wholeCode)
+            return runMatch(impl->wholeCode, input, 0, matchData.get()) >= 0;
+
         int rc = pcre2_match(
             impl->code,
             reinterpret_cast<PCRE2_SPTR>(input.data()),
             input.size(),
             0,
             PCRE2_ANCHORED,
-            matchData,
-            nullptr);
-
-        bool result = false;
-        if (rc >= 0) {
-            PCRE2_SIZE *ovector = pcre2_get_ovector_pointer(matchData);
-            result = (ovector[0] == 0 && ovector[1] == input.size());
-        }
-        pcre2_match_data_free(matchData);
-        return result;
+            matchData.get(),
+            threadMatchState().context);
+        if (rc < 0)
+            return false;
+        PCRE2_SIZE *ovector = pcre2_get_ovector_pointer(matchData.get());
+        return ovector[0] == 0 && ovector[1] == input.size();
     }
 
     Optional<RegexMatch> Regex::search(StrRef input) const {
@@ -138,155 +339,80 @@ namespace OmegaCommon {
     }
 
     Optional<RegexMatch> Regex::searchFrom(StrRef input, size_t startOffset) const {
-        pcre2_match_data *matchData = pcre2_match_data_create_from_pattern(impl->code, nullptr);
-        int rc = pcre2_match(
-            impl->code,
-            reinterpret_cast<PCRE2_SPTR>(input.data()),
-            input.size(),
-            startOffset,
-            0,
-            matchData,
-            nullptr);
-
-        if (rc < 0) {
-            pcre2_match_data_free(matchData);
+        PooledMatchData matchData(impl->pairs);
+        int rc = runMatch(impl->code, input, startOffset, matchData.get());
+        if (rc < 0)
             return {};
-        }
 
         uint32_t captureCount = (rc == 0)
-            ? pcre2_get_ovector_count(matchData)
+            ? pcre2_get_ovector_count(matchData.get())
             : (uint32_t)rc;
-
-        RegexMatch match = buildMatch(input, matchData, captureCount);
-        pcre2_match_data_free(matchData);
-        return match;
+        return buildMatch(input, matchData.get(), captureCount);
     }
 
     Vector<RegexMatch> Regex::findAll(StrRef input) const {
         Vector<RegexMatch> results;
-        size_t offset = 0;
-
-        while (offset <= input.size()) {
-            pcre2_match_data *matchData = pcre2_match_data_create_from_pattern(impl->code, nullptr);
-            int rc = pcre2_match(
-                impl->code,
-                reinterpret_cast<PCRE2_SPTR>(input.data()),
-                input.size(),
-                offset,
-                0,
-                matchData,
-                nullptr);
-
-            if (rc < 0) {
-                pcre2_match_data_free(matchData);
-                break;
-            }
-
+        forEachMatch(*impl, input, [&](pcre2_match_data *matchData, int rc) {
             uint32_t captureCount = (rc == 0)
                 ? pcre2_get_ovector_count(matchData)
                 : (uint32_t)rc;
-
-            RegexMatch match = buildMatch(input, matchData, captureCount);
-            pcre2_match_data_free(matchData);
-
-            size_t matchEnd = match.fullMatch.end;
-            results.push_back(std::move(match));
-
-            // Advance past empty matches to avoid infinite loop
-            if (matchEnd == offset)
-                offset++;
-            else
-                offset = matchEnd;
-        }
+            results.push_back(buildMatch(input, matchData, captureCount));
+            return true;
+        });
         return results;
     }
 
+    size_t Regex::scanAll(StrRef input, const std::function<bool(const RegexMatchView &)> & onMatch) const {
+        return forEachMatch(*impl, input, [&](pcre2_match_data *matchData, int) {
+            return onMatch(RegexMatchView(input, pcre2_get_ovector_pointer(matchData), impl->pairs));
+        });
+    }
+
     Result<String, RegexError> Regex::replace(StrRef input, StrRef replacement) const {
-        // First call to determine output length
-        PCRE2_SIZE outLen = 0;
-        int rc = pcre2_substitute(
-            impl->code,
-            reinterpret_cast<PCRE2_SPTR>(input.data()),
-            input.size(),
-            0,
-            PCRE2_SUBSTITUTE_GLOBAL | PCRE2_SUBSTITUTE_OVERFLOW_LENGTH,
-            nullptr,
-            nullptr,
-            reinterpret_cast<PCRE2_SPTR>(replacement.data()),
-            replacement.size(),
-            nullptr,
-            &outLen);
-
-        if (rc != PCRE2_ERROR_NOMEMORY && rc < 0) {
-            RegexError err;
-            err.code = rc;
-            err.offset = 0;
-            err.message = pcre2ErrorMessage(rc);
-            return Result<String, RegexError>::err(std::move(err));
-        }
+        PooledMatchData matchData(impl->pairs);
+        auto substitute = [&](uint32_t options, PCRE2_UCHAR *out, PCRE2_SIZE *outLen) {
+            return pcre2_substitute(
+                impl->code,
+                reinterpret_cast<PCRE2_SPTR>(input.data()),
+                input.size(),
+                0,
+                PCRE2_SUBSTITUTE_GLOBAL | options,
+                matchData.get(),
+                threadMatchState().context,
+                reinterpret_cast<PCRE2_SPTR>(replacement.data()),
+                replacement.size(),
+                out,
+                outLen);
+        };
 
-        // Allocate output buffer and perform substitution
-        Vector<PCRE2_UCHAR> outBuf(outLen);
-        PCRE2_SIZE finalLen = outLen;
-        rc = pcre2_substitute(
-            impl->code,
-            reinterpret_cast<PCRE2_SPTR>(input.data()),
-            input.size(),
-            0,
-            PCRE2_SUBSTITUTE_GLOBAL,
-            nullptr,
-            nullptr,
-            reinterpret_cast<PCRE2_SPTR>(replacement.data()),
-            replacement.size(),
-            outBuf.data(),
-            &finalLen);
-
-        if (rc < 0) {
-            RegexError err;
-            err.code = rc;
-            err.offset = 0;
-            err.message = pcre2ErrorMessage(rc);
-            return Result<String, RegexError>::err(std::move(err));
+        // Most substitutions fit a buffer a little larger than the input, so
+        // try that first and only size exactly on overflow.
+        Vector<PCRE2_UCHAR> outBuf(input.size() + replacement.size() + 64);
+        PCRE2_SIZE outLen = outBuf.size();
+        int rc = substitute(PCRE2_SUBSTITUTE_OVERFLOW_LENGTH, outBuf.data(), &outLen);
+        if (rc == PCRE2_ERROR_NOMEMORY) {
+            outBuf.resize(outLen);
+            rc = substitute(0, outBuf.data(), &outLen);
         }
 
+        if (rc < 0)
+            return Result<String, RegexError>::err(makeError(rc));
+
         return Result<String, RegexError>::ok(
-            String(reinterpret_cast<const char *>(outBuf.data()), finalLen));
+            String(reinterpret_cast<const char *>(outBuf.data()), outLen));
     }
 
     Vector<String> Regex::split(StrRef input) const {
         Vector<String> parts;
         size_t lastEnd = 0;
 
-        pcre2_match_data *matchData = pcre2_match_data_create_from_pattern(impl->code, nullptr);
-        size_t offset = 0;
-
-        while (offset <= input.size()) {
-            int rc = pcre2_match(
-                impl->code,
-                reinterpret_cast<PCRE2_SPTR>(input.data()),
-                input.size(),
-                offset,
-                0,
-                matchData,
-                nullptr);
-
-            if (rc < 0)
-                break;
-
+        forEachMatch(*impl, input, [&](pcre2_match_data *matchData, int) {
             PCRE2_SIZE *ovector = pcre2_get_ovector_pointer(matchData);
-            size_t matchStart = ovector[0];
-            size_t matchEnd = ovector[1];
-
-            parts.push_back(String(input.data() + lastEnd, matchStart - lastEnd));
-            lastEnd = matchEnd;
-
-            if (matchEnd == offset)
-                offset++;
-            else
-                offset = matchEnd;
-        }
+            parts.push_back(String(input.data() + lastEnd, ovector[0] - lastEnd));
+            lastEnd = ovector[1];
+            return true;
+        });
 
-        pcre2_match_data_free(matchData);
         parts.push_back(String(input.data() + lastEnd, input.size() - lastEnd));
         return parts;
     }
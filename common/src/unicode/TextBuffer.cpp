@@ -0,0 +1,448 @@
+// Shared, immutable text with cached ICU segmentation, plus the
+// process-wide `TextAnalysisCache` in front of it.
+//
+// `BreakIterator` and `BidiParagraph` copy the text and rebuild their
+// ICU objects on every construction, which the WTK layout engine used
+// to do for every paragraph on every layout pass. A `TextBuffer` does
+// that work once per distinct string: the analyses are computed on
+// first query under a `std::call_once` and then only read. Break
+// iterators are cloned once per thread and re-pointed at each buffer
+// through `UText`, which also lets UTF-8 text be segmented in place.
+
+#include "omega-common/unicode.h"
+
+#include <unicode/brkiter.h>
+#include <unicode/locid.h>
+#include <unicode/ubidi.h>
+#include <unicode/utext.h>
+#include <unicode/utf16.h>
+#include <unicode/utf8.h>
+
+#include <algorithm>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace OmegaCommon {
+
+    namespace {
+
+        /// The text itself, in whichever encoding it arrived.
+        struct TextStorage {
+            TextBuffer::Encoding encoding = TextBuffer::Encoding::UTF16;
+            std::string utf8;
+            std::u16string utf16;
+
+            std::int32_t length() const {
+                return encoding == TextBuffer::Encoding::UTF8
+                    ? static_cast<std::int32_t>(utf8.size())
+                    : static_cast<std::int32_t>(utf16.size());
+            }
+        };
+
+        std::uint64_t hashBytes(const void * data, std::size_t size, std::uint64_t seed){
+            // FNV-1a; fast enough to run on every layout call, which is
+            // what the cache lookup does.
+            std::uint64_t h = seed;
+            const auto * p = static_cast<const unsigned char *>(data);
+            for(std::size_t i = 0; i < size; ++i){
+                h ^= p[i];
+                h *= 0x100000001b3ull;
+            }
+            return h;
+        }
+
+        std::uint64_t computeKey(const TextBuffer::Encoding encoding, const void * data, std::size_t size){
+            const std::uint64_t seed = encoding == TextBuffer::Encoding::UTF8
+                ? 0xcbf29ce484222325ull
+                : 0x84222325cbf29ce4ull;
+            return hashBytes(data, size, seed);
+        }
+
+        // One cloned iterator per thread and type. Creating an ICU
+        // break iterator loads and compiles rule data; re-pointing an
+        // existing one with `setText` is cheap.
+        icu::BreakIterator * threadIterator(BreakIterator::Type type){
+            thread_local std::unique_ptr<icu::BreakIterator> line;
+            thread_local std::unique_ptr<icu::BreakIterator> word;
+            auto & slot = (type == BreakIterator::Type::Word) ? word : line;
+            if(slot == nullptr){
+                UErrorCode err = U_ZERO_ERROR;
+                icu::BreakIterator * raw = (type == BreakIterator::Type::Word)
+                    ? icu::BreakIterator::createWordInstance(icu::Locale::getDefault(), err)
+                    : icu::BreakIterator::createLineInstance(icu::Locale::getDefault(), err);
+                if(U_FAILURE(err)){
+                    delete raw;
+                    return nullptr;
+                }
+                slot.reset(raw);
+            }
+            return slot.get();
+        }
+
+        // Walk every boundary after 0. `onBoundary(offset, ruleStatus)`
+        // gets native offsets — bytes for UTF-8 text.
+        template<typename Fn>
+        void walkBoundaries(const TextStorage & storage, BreakIterator::Type type, Fn && onBoundary){
+            if(storage.length() == 0) return;
+            icu::BreakIterator * iter = threadIterator(type);
+            if(iter == nullptr) return;
+
+            UErrorCode err = U_ZERO_ERROR;
+            UText * text = (storage.encoding == TextBuffer::Encoding::UTF8)
+                ? utext_openUTF8(nullptr, storage.utf8.data(), static_cast<int64_t>(storage.utf8.size()), &err)
+                : utext_openUChars(nullptr, reinterpret_cast<const UChar *>(storage.utf16.data()),
+                                   static_cast<int64_t>(storage.utf16.size()), &err);
+            if(U_FAILURE(err)){
+                utext_close(text);
+                return;
+            }
+            // The iterator shallow-clones the UText, so ours can be
+            // closed straight away; the buffer itself outlives the walk.
+            iter->setText(text, err);
+            utext_close(text);
+            if(U_FAILURE(err)) return;
+
+            (void)iter->first();
+            std::int32_t pos;
+            while((pos = iter->next()) != icu::BreakIterator::DONE){
+                onBoundary(pos, iter->getRuleStatus());
+            }
+        }
+
+        // Conservative test for code points that can make a paragraph
+        // anything other than a single LTR run under UBIDI_DEFAULT_LTR:
+        // strong R / AL letters, Arabic digits, and the explicit RTL
+        // embedding / override / isolate controls.
+        bool mayNeedBidi(UChar32 c){
+            if(c < 0x0590) return false;
+            return (c <= 0x08FF)
+                || c == 0x200F
+                || c == 0x202B || c == 0x202E
+                || c == 0x2067 || c == 0x2068
+                || (c >= 0xFB1D && c <= 0xFDFF)
+                || (c >= 0xFE70 && c <= 0xFEFF)
+                || (c >= 0x10800 && c <= 0x10FFF)
+                || (c >= 0x1E800 && c <= 0x1EFFF);
+        }
+
+        bool isParagraphBreak(UChar32 c){
+            return c == u'\n' || c == u'\r' || c == 0x2028 || c == 0x2029;
+        }
+
+        // Strip the trailing mandatory break (and the CR of a CRLF)
+        // from `[start, end)`. ICU places the boundary after the break
+        // character, so it sits at the end of every paragraph but the
+        // last.
+        std::int32_t trimTrailingBreak(const TextStorage & storage, std::int32_t start, std::int32_t end){
+            if(end <= start) return end;
+            UChar32 c;
+            std::int32_t prev = end;
+            if(storage.encoding == TextBuffer::Encoding::UTF8){
+                const auto * s = reinterpret_cast<const uint8_t *>(storage.utf8.data());
+                U8_PREV(s, start, prev, c);
+            }
+            else {
+                const auto * s = reinterpret_cast<const UChar *>(storage.utf16.data());
+                U16_PREV(s, start, prev, c);
+            }
+            if(!isParagraphBreak(c)) return end;
+            if(c == u'\n' && prev - 1 >= start){
+                const bool cr = (storage.encoding == TextBuffer::Encoding::UTF8)
+                    ? storage.utf8[static_cast<std::size_t>(prev - 1)] == '\r'
+                    : storage.utf16[static_cast<std::size_t>(prev - 1)] == u'\r';
+                if(cr) return prev - 1;
+            }
+            return prev;
+        }
+
+        // Resolve one paragraph's visual runs. `bidi` is reused across
+        // paragraphs of the same buffer. For UTF-8 text the paragraph
+        // is transcoded into `scratch` (the only place a UTF-16 copy is
+        // made, and only for paragraphs that actually contain RTL), and
+        // run offsets are mapped back to bytes.
+        void resolveRuns(const TextStorage & storage,
+                         TextBuffer::Paragraph & para,
+                         UBiDi *& bidi,
+                         std::vector<UChar> & scratch,
+                         std::vector<std::int32_t> & toNative){
+            const std::int32_t len = para.end - para.start;
+            if(len <= 0) return;
+
+            bool needsBidi = false;
+            const UChar * units = nullptr;
+            std::int32_t unitCount = 0;
+            toNative.clear();
+            if(storage.encoding == TextBuffer::Encoding::UTF8){
+                const auto * s = reinterpret_cast<const uint8_t *>(storage.utf8.data()) + para.start;
+                for(std::int32_t i = 0; i < len && !needsBidi;){
+                    UChar32 c;
+                    U8_NEXT(s, i, len, c);
+                    needsBidi = mayNeedBidi(c);
+                }
+                if(needsBidi){
+                    scratch.clear();
+                    for(std::int32_t i = 0; i < len;){
+                        const std::int32_t at = i;
+                        UChar32 c;
+                        U8_NEXT(s, i, len, c);
+                        if(c < 0) c = 0xFFFD;
+                        if(U16_LENGTH(c) == 2){
+                            scratch.push_back(U16_LEAD(c));
+                            toNative.push_back(at);
+                            scratch.push_back(U16_TRAIL(c));
+                            toNative.push_back(at);
+                        }
+                        else {
+                            scratch.push_back(static_cast<UChar>(c));
+                            toNative.push_back(at);
+                        }
+                    }
+                    toNative.push_back(len);
+                    units = scratch.data();
+                    unitCount = static_cast<std::int32_t>(scratch.size());
+                }
+            }
+            else {
+                units = reinterpret_cast<const UChar *>(storage.utf16.data()) + para.start;
+                unitCount = len;
+                for(std::int32_t i = 0; i < len && !needsBidi;){
+                    UChar32 c;
+                    U16_NEXT(units, i, len, c);
+                    needsBidi = mayNeedBidi(c);
+                }
+            }
+
+            if(!needsBidi){
+                para.runs.push_back({0, len, false});
+                return;
+            }
+
+            if(bidi == nullptr){
+                bidi = ubidi_open();
+                if(bidi == nullptr) return;
+            }
+            UErrorCode err = U_ZERO_ERROR;
+            ubidi_setPara(bidi, units, unitCount, UBIDI_DEFAULT_LTR, nullptr, &err);
+            if(U_FAILURE(err)) return;
+            const std::int32_t count = ubidi_countRuns(bidi, &err);
+            if(U_FAILURE(err)) return;
+
+            para.runs.reserve(static_cast<std::size_t>(count));
+            for(std::int32_t r = 0; r < count; ++r){
+                std::int32_t logicalStart = 0;
+                std::int32_t length = 0;
+                const UBiDiDirection dir = ubidi_getVisualRun(bidi, r, &logicalStart, &length);
+                if(length <= 0) continue;
+                BidiParagraph::VisualRun run;
+                run.rightToLeft = (dir == UBIDI_RTL);
+                if(toNative.empty()){
+                    run.logicalStart = logicalStart;
+                    run.length       = length;
+                }
+                else {
+                    run.logicalStart = toNative[static_cast<std::size_t>(logicalStart)];
+                    run.length       = toNative[static_cast<std::size_t>(logicalStart + length)] - run.logicalStart;
+                }
+                para.runs.push_back(run);
+            }
+        }
+
+    }
+
+    struct TextBuffer::Impl {
+        TextStorage text;
+        std::uint64_t key = 0;
+
+        std::once_flag lineOnce;
+        std::once_flag wordOnce;
+        std::once_flag paragraphOnce;
+        Vector<LineBoundary> lineBoundaries;
+        Vector<std::int32_t> wordBoundaries;
+        Vector<Paragraph> paragraphs;
+    };
+
+    // --- TextBuffer ---
+
+    TextBuffer::TextBuffer() : impl_(std::make_shared<Impl>()) {}
+
+    TextBuffer::TextBuffer(std::shared_ptr<Impl> impl) : impl_(std::move(impl)) {}
+
+    TextBuffer TextBuffer::fromUTF8(StrRef utf8){
+        auto impl = std::make_shared<Impl>();
+        impl->text.encoding = Encoding::UTF8;
+        if(utf8.data() != nullptr && utf8.size() > 0){
+            impl->text.utf8.assign(utf8.data(), utf8.size());
+        }
+        impl->key = computeKey(impl->text.encoding, impl->text.utf8.data(), impl->text.utf8.size());
+        return TextBuffer(std::move(impl));
+    }
+
+    TextBuffer TextBuffer::fromUTF16(const UniString & text){
+        auto impl = std::make_shared<Impl>();
+        impl->text.encoding = Encoding::UTF16;
+        if(text.getBuffer() != nullptr && text.length() > 0){
+            impl->text.utf16.assign(text.getBuffer(), static_cast<std::size_t>(text.length()));
+        }
+        impl->key = computeKey(impl->text.encoding, impl->text.utf16.data(), impl->text.utf16.size() * sizeof(char16_t));
+        return TextBuffer(std::move(impl));
+    }
+
+    TextBuffer::Encoding TextBuffer::encoding() const {
+        return impl_->text.encoding;
+    }
+
+    std::int32_t TextBuffer::length() const {
+        return impl_->text.length();
+    }
+
+    const char * TextBuffer::utf8Data() const {
+        return impl_->text.encoding == Encoding::UTF8 ? impl_->text.utf8.data() : nullptr;
+    }
+
+    const UnicodeChar * TextBuffer::utf16Data() const {
+        return impl_->text.encoding == Encoding::UTF16 ? impl_->text.utf16.data() : nullptr;
+    }
+
+    std::uint64_t TextBuffer::key() const {
+        return impl_->key;
+    }
+
+    bool TextBuffer::sameText(const TextBuffer & other) const {
+        if(impl_ == other.impl_) return true;
+        if(impl_->key != other.impl_->key || impl_->text.encoding != other.impl_->text.encoding) return false;
+        return impl_->text.encoding == Encoding::UTF8
+            ? impl_->text.utf8 == other.impl_->text.utf8
+            : impl_->text.utf16 == other.impl_->text.utf16;
+    }
+
+    const Vector<TextBuffer::LineBoundary> & TextBuffer::lineBoundaries() const {
+        Impl & impl = *impl_;
+        std::call_once(impl.lineOnce, [&impl](){
+            walkBoundaries(impl.text, BreakIterator::Type::Line, [&impl](std::int32_t pos, std::int32_t status){
+                impl.lineBoundaries.push_back({pos, status >= UBRK_LINE_HARD && status < UBRK_LINE_HARD_LIMIT});
+            });
+        });
+        return impl.lineBoundaries;
+    }
+
+    const Vector<std::int32_t> & TextBuffer::wordBoundaries() const {
+        Impl & impl = *impl_;
+        std::call_once(impl.wordOnce, [&impl](){
+            walkBoundaries(impl.text, BreakIterator::Type::Word, [&impl](std::int32_t pos, std::int32_t){
+                impl.wordBoundaries.push_back(pos);
+            });
+        });
+        return impl.wordBoundaries;
+    }
+
+    const Vector<TextBuffer::Paragraph> & TextBuffer::paragraphs() const {
+        const auto & boundaries = lineBoundaries();
+        Impl & impl = *impl_;
+        std::call_once(impl.paragraphOnce, [&impl, &boundaries](){
+            const std::int32_t length = impl.text.length();
+            if(length == 0) return;
+
+            std::int32_t segStart = 0;
+            auto addParagraph = [&impl](std::int32_t start, std::int32_t next){
+                Paragraph para;
+                para.start = start;
+                para.end   = trimTrailingBreak(impl.text, start, next);
+                para.next  = next;
+                impl.paragraphs.push_back(std::move(para));
+            };
+            for(const auto & b : boundaries){
+                if(b.mandatory){
+                    addParagraph(segStart, b.offset);
+                    segStart = b.offset;
+                }
+            }
+            if(segStart < length || impl.paragraphs.empty()){
+                addParagraph(segStart, length);
+            }
+
+            UBiDi * bidi = nullptr;
+            std::vector<UChar> scratch;
+            std::vector<std::int32_t> toNative;
+            for(auto & para : impl.paragraphs){
+                resolveRuns(impl.text, para, bidi, scratch, toNative);
+            }
+            if(bidi != nullptr){
+                ubidi_close(bidi);
+            }
+        });
+        return impl.paragraphs;
+    }
+
+    // --- TextAnalysisCache ---
+
+    struct TextAnalysisCache::Impl {
+        std::mutex mutex;
+        std::size_t capacity = 0;
+        /// Most recently used at the front.
+        std::list<TextBuffer> lru;
+        std::unordered_multimap<std::uint64_t, std::list<TextBuffer>::iterator> index;
+
+        TextBuffer insertOrFind(TextBuffer && candidate){
+            std::lock_guard<std::mutex> lock(mutex);
+            auto range = index.equal_range(candidate.key());
+            for(auto it = range.first; it != range.second; ++it){
+                if(it->second->sameText(candidate)){
+                    lru.splice(lru.begin(), lru, it->second);
+                    return *it->second;
+                }
+            }
+            if(capacity == 0){
+                return std::move(candidate);
+            }
+            while(lru.size() >= capacity){
+                auto victim = std::prev(lru.end());
+                auto victims = index.equal_range(victim->key());
+                for(auto it = victims.first; it != victims.second; ++it){
+                    if(it->second == victim){
+                        index.erase(it);
+                        break;
+                    }
+                }
+                lru.erase(victim);
+            }
+            lru.push_front(std::move(candidate));
+            index.emplace(lru.front().key(), lru.begin());
+            return lru.front();
+        }
+    };
+
+    TextAnalysisCache::TextAnalysisCache(std::size_t capacity)
+        : impl_(std::make_unique<Impl>()) {
+        impl_->capacity = capacity;
+    }
+
+    TextAnalysisCache::~TextAnalysisCache() = default;
+
+    TextAnalysisCache & TextAnalysisCache::shared(){
+        static TextAnalysisCache cache;
+        return cache;
+    }
+
+    TextBuffer TextAnalysisCache::lookup(const UniString & text){
+        return impl_->insertOrFind(TextBuffer::fromUTF16(text));
+    }
+
+    TextBuffer TextAnalysisCache::lookup(StrRef utf8){
+        return impl_->insertOrFind(TextBuffer::fromUTF8(utf8));
+    }
+
+    std::size_t TextAnalysisCache::size() const {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        return impl_->lru.size();
+    }
+
+    void TextAnalysisCache::clear(){
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        impl_->index.clear();
+        impl_->lru.clear();
+    }
+
+}
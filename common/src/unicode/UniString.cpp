@@ -2,6 +2,7 @@
 
 #include <unicode/ustring.h>
 
+#include <algorithm>
 #include <cstring>
 #include <vector>
 
@@ -84,6 +85,22 @@ UniString UniString::fromUTF32(const Unicode32Char * utf32, std::int32_t length)
     return UniString(utf16FromUChars(buffer.data(),utf16Length));
 }
 
+UniString UniString::fromUTF16(const UnicodeChar * utf16, std::int32_t length){
+    if(utf16 == nullptr || length <= 0){
+        return {};
+    }
+    return UniString(std::u16string(utf16,static_cast<size_t>(length)));
+}
+
+UniString UniString::substr(std::int32_t start, std::int32_t length) const {
+    const auto size = static_cast<std::int32_t>(data_.size());
+    if(start < 0 || start >= size || length <= 0){
+        return {};
+    }
+    length = std::min(length,size - start);
+    return UniString(data_.substr(static_cast<size_t>(start),static_cast<size_t>(length)));
+}
+
 String UniString::toUTF8() const {
     if(data_.empty()){
         return {};
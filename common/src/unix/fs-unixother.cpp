@@ -6,6 +6,8 @@
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
 #include <cstring>
 
 
@@ -171,4 +173,37 @@ namespace OmegaCommon::FS {
 			closedir(dir);
 		}
 	}
+
+	Result<UniqueHandle<MappedFile>, StatusCode> MappedFile::open(Path path){
+		using ResultT = Result<UniqueHandle<MappedFile>, StatusCode>;
+		auto p = path.absPath();
+		int fd = ::open(p.c_str(),O_RDONLY);
+		if(fd == -1){
+			return ResultT::err(Failed);
+		}
+		struct stat st {};
+		if(fstat(fd,&st) == -1){
+			::close(fd);
+			return ResultT::err(Failed);
+		}
+		UniqueHandle<MappedFile> file(new MappedFile());
+		file->_size = static_cast<size_t>(st.st_size);
+		if(file->_size > 0){
+			void *addr = mmap(nullptr,file->_size,PROT_READ,MAP_SHARED,fd,0);
+			if(addr == MAP_FAILED){
+				::close(fd);
+				return ResultT::err(Failed);
+			}
+			file->_data = static_cast<const std::uint8_t *>(addr);
+		}
+		// The mapping holds its own reference to the file.
+		::close(fd);
+		return ResultT::ok(std::move(file));
+	}
+
+	MappedFile::~MappedFile(){
+		if(_data != nullptr){
+			munmap(const_cast<std::uint8_t *>(_data),_size);
+		}
+	}
 }
@@ -13,8 +13,64 @@
 #include <sys/stat.h>
 #endif
 
+#if defined(__linux__)
+#include <climits>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
 namespace OmegaCommon {
 
+#if !defined(__linux__)
+
+    namespace {
+
+        /// Parking lot for atomicWait: waiters hash onto a bucket by address,
+        /// since Darwin and the BSDs expose no portable futex.
+        struct ParkingBucket {
+            std::mutex mutex;
+            std::condition_variable condition;
+        };
+
+        ParkingBucket & parkingBucketFor(const void *addr){
+            static ParkingBucket buckets[64];
+            auto key = reinterpret_cast<std::uintptr_t>(addr);
+            return buckets[(key >> 4) % 64];
+        }
+
+    }
+
+    void detail::atomicWait(const std::atomic<std::uint32_t> &word, std::uint32_t expected) {
+        auto & bucket = parkingBucketFor(&word);
+        std::unique_lock<std::mutex> lk(bucket.mutex);
+        if(word.load() == expected){
+            bucket.condition.wait(lk);
+        }
+    }
+
+    void detail::atomicWakeAll(const std::atomic<std::uint32_t> &word) {
+        auto & bucket = parkingBucketFor(&word);
+        {
+            std::lock_guard<std::mutex> lk(bucket.mutex);
+        }
+        bucket.condition.notify_all();
+    }
+
+#else
+
+    static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t),
+                  "futex needs a plain 32-bit word");
+
+    void detail::atomicWait(const std::atomic<std::uint32_t> &word, std::uint32_t expected) {
+        syscall(SYS_futex,reinterpret_cast<const std::uint32_t *>(&word),FUTEX_WAIT_PRIVATE,expected,nullptr,nullptr,0);
+    }
+
+    void detail::atomicWakeAll(const std::atomic<std::uint32_t> &word) {
+        syscall(SYS_futex,reinterpret_cast<const std::uint32_t *>(&word),FUTEX_WAKE_PRIVATE,INT_MAX,nullptr,nullptr,0);
+    }
+
+#endif
+
 #if defined(__APPLE__)
 
     struct Semaphore::Impl {
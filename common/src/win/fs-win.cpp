@@ -175,4 +175,47 @@ namespace OmegaCommon::FS {
     DirectoryIterator::~DirectoryIterator(){
         FindClose(dirp);
     }
+
+    Result<UniqueHandle<MappedFile>, StatusCode> MappedFile::open(Path path){
+        using ResultT = Result<UniqueHandle<MappedFile>, StatusCode>;
+        auto p = path.absPath();
+        HANDLE file = CreateFileA(p.c_str(),GENERIC_READ,FILE_SHARE_READ,NULL,OPEN_EXISTING,FILE_ATTRIBUTE_NORMAL,NULL);
+        if(file == INVALID_HANDLE_VALUE){
+            return ResultT::err(Failed);
+        }
+        LARGE_INTEGER fileSize;
+        if(!GetFileSizeEx(file,&fileSize)){
+            CloseHandle(file);
+            return ResultT::err(Failed);
+        }
+        UniqueHandle<MappedFile> mapped(new MappedFile());
+        mapped->_size = (size_t)fileSize.QuadPart;
+        if(mapped->_size > 0){
+            HANDLE mapping = CreateFileMappingA(file,NULL,PAGE_READONLY,0,0,NULL);
+            if(mapping == NULL){
+                CloseHandle(file);
+                return ResultT::err(Failed);
+            }
+            void *view = MapViewOfFile(mapping,FILE_MAP_READ,0,0,0);
+            if(view == NULL){
+                CloseHandle(mapping);
+                CloseHandle(file);
+                return ResultT::err(Failed);
+            }
+            mapped->_data = (const std::uint8_t *)view;
+            mapped->handle = mapping;
+        }
+        // The view keeps the file mapping object (and through it the file) alive.
+        CloseHandle(file);
+        return ResultT::ok(std::move(mapped));
+    }
+
+    MappedFile::~MappedFile(){
+        if(_data != nullptr){
+            UnmapViewOfFile(_data);
+        }
+        if(handle != nullptr){
+            CloseHandle((HANDLE)handle);
+        }
+    }
 };
\ No newline at end of file
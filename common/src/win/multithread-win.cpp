@@ -2,8 +2,18 @@
 
 #include <Windows.h>
 
+#pragma comment(lib,"Synchronization.lib")
+
 namespace OmegaCommon {
 
+    void detail::atomicWait(const std::atomic<std::uint32_t> &word, std::uint32_t expected) {
+        WaitOnAddress((volatile VOID *)&word,&expected,sizeof(expected),INFINITE);
+    }
+
+    void detail::atomicWakeAll(const std::atomic<std::uint32_t> &word) {
+        WakeByAddressAll((PVOID)&word);
+    }
+
     struct Semaphore::Impl {
         HANDLE sem = nullptr;
 
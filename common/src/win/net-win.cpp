@@ -7,39 +7,165 @@
 
 namespace OmegaCommon {
 
-    class WinHTTPHttpClientContext : public HttpClientContext {
-        HINTERNET hSession;
-        HttpTlsConfig tlsConfig_;
-    public:
-        WinHTTPHttpClientContext() {
-            hSession = WinHttpOpen(L"OmegaCommon",
-                                   WINHTTP_ACCESS_TYPE_AUTOMATIC_PROXY,
-                                   WINHTTP_NO_PROXY_NAME,
-                                   WINHTTP_NO_PROXY_BYPASS,
-                                   0);
+    namespace {
+
+        std::wstring toWide(const char *data, size_t size) {
+            int wideLen = MultiByteToWideChar(CP_UTF8, 0, data, (int)size, nullptr, 0);
+            std::wstring wide(wideLen, L'\0');
+            if (wideLen > 0)
+                MultiByteToWideChar(CP_UTF8, 0, data, (int)size, &wide[0], wideLen);
+            return wide;
         }
 
-        explicit WinHTTPHttpClientContext(HttpTlsConfig config)
-            : WinHTTPHttpClientContext()
-        {
-            tlsConfig_ = std::move(config);
+        String toUtf8(const wchar_t *data, size_t size) {
+            int len = WideCharToMultiByte(CP_UTF8, 0, data, (int)size, nullptr, 0, nullptr, nullptr);
+            String out(len, '\0');
+            if (len > 0)
+                WideCharToMultiByte(CP_UTF8, 0, data, (int)size, &out[0], len, nullptr, nullptr);
+            return out;
         }
 
-        std::future<HttpResponse> makeRequest(HttpRequestDescriptor descriptor) override {
-            std::promise<HttpResponse> promise;
-            auto future = promise.get_future();
+        /// One request in flight on the async session. WinHTTP drives it from
+        /// its own thread pool through statusCallback(); nothing blocks while
+        /// the request waits on the network. Owned by the request handle:
+        /// deleted when WinHTTP reports that handle closing.
+        struct WinHttpTransfer {
+            std::shared_ptr<HttpClientContext> owner;
+            HINTERNET hConnect = nullptr;
+            HINTERNET hRequest = nullptr;
+            /// Must outlive WinHttpSendRequest's completion.
+            String body;
             HttpResponse response;
+            Vector<std::uint8_t> chunk;
+            std::function<void(HttpResponse)> complete;
+            bool delivered = false;
+
+            /// Hands the response over exactly once, then releases the handles.
+            /// @p failed reports a transport error as statusCode 0.
+            void finish(bool failed) {
+                if (delivered)
+                    return;
+                delivered = true;
+                if (failed)
+                    response = HttpResponse{};
+                auto done = std::move(complete);
+                done(std::move(response));
+                HINTERNET connect = hConnect;
+                hConnect = nullptr;
+                if (connect)
+                    WinHttpCloseHandle(connect);
+                // The last callback for this handle (HANDLE_CLOSING) deletes us.
+                WinHttpCloseHandle(hRequest);
+            }
+
+            void readHeaders() {
+                DWORD statusCode = 0;
+                DWORD statusSize = sizeof(statusCode);
+                WinHttpQueryHeaders(hRequest,
+                                     WINHTTP_QUERY_STATUS_CODE | WINHTTP_QUERY_FLAG_NUMBER,
+                                     WINHTTP_HEADER_NAME_BY_INDEX, &statusCode, &statusSize,
+                                     WINHTTP_NO_HEADER_INDEX);
+                response.statusCode = (int)statusCode;
+
+                DWORD headerBufSize = 0;
+                WinHttpQueryHeaders(hRequest, WINHTTP_QUERY_RAW_HEADERS_CRLF,
+                                     WINHTTP_HEADER_NAME_BY_INDEX, nullptr, &headerBufSize,
+                                     WINHTTP_NO_HEADER_INDEX);
+                if (GetLastError() != ERROR_INSUFFICIENT_BUFFER || headerBufSize == 0)
+                    return;
+                std::wstring headerBuf(headerBufSize / sizeof(wchar_t), L'\0');
+                if (!WinHttpQueryHeaders(hRequest, WINHTTP_QUERY_RAW_HEADERS_CRLF,
+                                          WINHTTP_HEADER_NAME_BY_INDEX, &headerBuf[0],
+                                          &headerBufSize, WINHTTP_NO_HEADER_INDEX))
+                    return;
+                size_t pos = 0;
+                while (pos < headerBuf.size()) {
+                    size_t eol = headerBuf.find(L"\r\n", pos);
+                    if (eol == std::wstring::npos) eol = headerBuf.size();
+                    std::wstring hdrLine(headerBuf, pos, eol - pos);
+                    pos = eol + 2;
+                    if (hdrLine.empty() || hdrLine.find(L"HTTP/") == 0)
+                        continue;
+                    auto colon = hdrLine.find(L':');
+                    if (colon == std::wstring::npos)
+                        continue;
+                    String key = toUtf8(hdrLine.c_str(), colon);
+                    auto valStart = hdrLine.find_first_not_of(L" \t", colon + 1);
+                    String value;
+                    if (valStart != std::wstring::npos)
+                        value = toUtf8(hdrLine.c_str() + valStart, hdrLine.size() - valStart);
+                    response.headers.push_back({std::move(key), std::move(value)});
+                }
+            }
+
+            /// Asks for the next piece of the body; DATA_AVAILABLE answers.
+            void queryData() {
+                if (!WinHttpQueryDataAvailable(hRequest, nullptr))
+                    finish(true);
+            }
 
+            static void CALLBACK statusCallback(HINTERNET, DWORD_PTR context, DWORD status,
+                                                LPVOID info, DWORD infoLength) {
+                auto *transfer = reinterpret_cast<WinHttpTransfer *>(context);
+                if (!transfer)
+                    return;
+                switch (status) {
+                    case WINHTTP_CALLBACK_STATUS_SENDREQUEST_COMPLETE:
+                        if (!WinHttpReceiveResponse(transfer->hRequest, nullptr))
+                            transfer->finish(true);
+                        break;
+                    case WINHTTP_CALLBACK_STATUS_HEADERS_AVAILABLE:
+                        transfer->readHeaders();
+                        transfer->queryData();
+                        break;
+                    case WINHTTP_CALLBACK_STATUS_DATA_AVAILABLE: {
+                        DWORD available = *reinterpret_cast<DWORD *>(info);
+                        if (available == 0) {
+                            transfer->finish(false);
+                            break;
+                        }
+                        transfer->chunk.resize(available);
+                        if (!WinHttpReadData(transfer->hRequest, transfer->chunk.data(), available, nullptr))
+                            transfer->finish(true);
+                        break;
+                    }
+                    case WINHTTP_CALLBACK_STATUS_READ_COMPLETE: {
+                        if (infoLength == 0) {
+                            transfer->finish(false);
+                            break;
+                        }
+                        auto *bytes = reinterpret_cast<const std::uint8_t *>(info);
+                        transfer->response.body.insert(transfer->response.body.end(), bytes, bytes + infoLength);
+                        transfer->queryData();
+                        break;
+                    }
+                    case WINHTTP_CALLBACK_STATUS_REQUEST_ERROR:
+                        transfer->finish(true);
+                        break;
+                    case WINHTTP_CALLBACK_STATUS_HANDLE_CLOSING:
+                        delete transfer;
+                        break;
+                    default:
+                        break;
+                }
+            }
+        };
+
+    }
+
+    class WinHTTPHttpClientContext : public HttpClientContext {
+        HINTERNET hSession;
+        HttpTlsConfig tlsConfig_;
+
+        /// Starts @p descriptor on the async session; @p complete runs once on
+        /// a WinHTTP pool thread (or here, if the request never got going).
+        void submit(HttpRequestDescriptor descriptor, std::function<void(HttpResponse)> complete) {
             if (!hSession) {
-                promise.set_value(std::move(response));
-                return future;
+                complete(HttpResponse{});
+                return;
             }
 
-            int wideLen = MultiByteToWideChar(CP_UTF8, 0, descriptor.url.data(),
-                                               (int)descriptor.url.size(), nullptr, 0);
-            std::wstring urlWide(wideLen, L'\0');
-            MultiByteToWideChar(CP_UTF8, 0, descriptor.url.data(),
-                                 (int)descriptor.url.size(), &urlWide[0], wideLen);
+            std::wstring urlWide = toWide(descriptor.url.data(), descriptor.url.size());
 
             URL_COMPONENTS urlComp = {};
             urlComp.dwStructSize = sizeof(urlComp);
@@ -49,8 +175,8 @@ namespace OmegaCommon {
             urlComp.dwExtraInfoLength = (DWORD)-1;
 
             if (!WinHttpCrackUrl(urlWide.c_str(), (DWORD)urlWide.size(), 0, &urlComp)) {
-                promise.set_value(std::move(response));
-                return future;
+                complete(HttpResponse{});
+                return;
             }
 
             std::wstring hostName(urlComp.lpszHostName, urlComp.dwHostNameLength);
@@ -60,8 +186,8 @@ namespace OmegaCommon {
 
             HINTERNET hConnect = WinHttpConnect(hSession, hostName.c_str(), urlComp.nPort, 0);
             if (!hConnect) {
-                promise.set_value(std::move(response));
-                return future;
+                complete(HttpResponse{});
+                return;
             }
 
             const wchar_t *method = L"GET";
@@ -81,17 +207,17 @@ namespace OmegaCommon {
                                                      WINHTTP_DEFAULT_ACCEPT_TYPES, flags);
             if (!hRequest) {
                 WinHttpCloseHandle(hConnect);
-                promise.set_value(std::move(response));
-                return future;
+                complete(HttpResponse{});
+                return;
             }
 
-            for (const auto &h : descriptor.headers) {
+            auto requestHeaders = descriptor.headers;
+            if (descriptor.range)
+                requestHeaders.push_back({"Range", "bytes=" + descriptor.range->spec()});
+
+            for (const auto &h : requestHeaders) {
                 String line = h.first + ": " + h.second;
-                int hdrWideLen = MultiByteToWideChar(CP_UTF8, 0, line.c_str(),
-                                                      (int)line.size(), nullptr, 0);
-                std::wstring hdrWide(hdrWideLen, L'\0');
-                MultiByteToWideChar(CP_UTF8, 0, line.c_str(), (int)line.size(),
-                                     &hdrWide[0], hdrWideLen);
+                std::wstring hdrWide = toWide(line.c_str(), line.size());
                 WinHttpAddRequestHeaders(hRequest, hdrWide.c_str(), (DWORD)hdrWide.size(),
                                           WINHTTP_ADDREQ_FLAG_ADD);
             }
@@ -105,91 +231,68 @@ namespace OmegaCommon {
                                  &secFlags, sizeof(secFlags));
             }
 
+            auto *transfer = new WinHttpTransfer();
+            // Holding the context keeps the session open until delivery.
+            transfer->owner = shared_from_this();
+            transfer->hConnect = hConnect;
+            transfer->hRequest = hRequest;
+            transfer->body = std::move(descriptor.body);
+            transfer->complete = std::move(complete);
+
+            // Set the context up front so HANDLE_CLOSING finds the transfer even
+            // if WinHttpSendRequest fails before taking its own context value.
+            DWORD_PTR context = (DWORD_PTR)transfer;
+            WinHttpSetOption(hRequest, WINHTTP_OPTION_CONTEXT_VALUE, &context, sizeof(context));
+            WinHttpSetStatusCallback(hRequest, &WinHttpTransfer::statusCallback,
+                                     WINHTTP_CALLBACK_FLAG_ALL_COMPLETIONS | WINHTTP_CALLBACK_FLAG_HANDLES, 0);
+
             LPVOID bodyPtr = WINHTTP_NO_REQUEST_DATA;
             DWORD bodyLen = 0;
-            if (!descriptor.body.empty()) {
-                bodyPtr = (LPVOID)descriptor.body.data();
-                bodyLen = (DWORD)descriptor.body.size();
+            if (!transfer->body.empty()) {
+                bodyPtr = (LPVOID)transfer->body.data();
+                bodyLen = (DWORD)transfer->body.size();
             }
 
-            BOOL sent = WinHttpSendRequest(hRequest, WINHTTP_NO_ADDITIONAL_HEADERS, 0,
-                                            bodyPtr, bodyLen, bodyLen, 0);
-            if (sent)
-                sent = WinHttpReceiveResponse(hRequest, nullptr);
-
-            if (sent) {
-                DWORD statusCode = 0;
-                DWORD statusSize = sizeof(statusCode);
-                WinHttpQueryHeaders(hRequest,
-                                     WINHTTP_QUERY_STATUS_CODE | WINHTTP_QUERY_FLAG_NUMBER,
-                                     WINHTTP_HEADER_NAME_BY_INDEX, &statusCode, &statusSize,
-                                     WINHTTP_NO_HEADER_INDEX);
-                response.statusCode = (int)statusCode;
-
-                DWORD headerBufSize = 0;
-                WinHttpQueryHeaders(hRequest, WINHTTP_QUERY_RAW_HEADERS_CRLF,
-                                     WINHTTP_HEADER_NAME_BY_INDEX, nullptr, &headerBufSize,
-                                     WINHTTP_NO_HEADER_INDEX);
-                if (GetLastError() == ERROR_INSUFFICIENT_BUFFER && headerBufSize > 0) {
-                    std::wstring headerBuf(headerBufSize / sizeof(wchar_t), L'\0');
-                    if (WinHttpQueryHeaders(hRequest, WINHTTP_QUERY_RAW_HEADERS_CRLF,
-                                             WINHTTP_HEADER_NAME_BY_INDEX, &headerBuf[0],
-                                             &headerBufSize, WINHTTP_NO_HEADER_INDEX)) {
-                        size_t pos = 0;
-                        while (pos < headerBuf.size()) {
-                            size_t eol = headerBuf.find(L"\r\n", pos);
-                            if (eol == std::wstring::npos) eol = headerBuf.size();
-                            std::wstring hdrLine(headerBuf, pos, eol - pos);
-                            pos = eol + 2;
-                            if (hdrLine.empty() || hdrLine.find(L"HTTP/") == 0)
-                                continue;
-                            auto colon = hdrLine.find(L':');
-                            if (colon != std::wstring::npos) {
-                                int keyLen = WideCharToMultiByte(CP_UTF8, 0, hdrLine.c_str(),
-                                                                  (int)colon, nullptr, 0,
-                                                                  nullptr, nullptr);
-                                String key(keyLen, '\0');
-                                WideCharToMultiByte(CP_UTF8, 0, hdrLine.c_str(), (int)colon,
-                                                     &key[0], keyLen, nullptr, nullptr);
-
-                                auto valStart = hdrLine.find_first_not_of(L" \t", colon + 1);
-                                String value;
-                                if (valStart != std::wstring::npos) {
-                                    int valLen = WideCharToMultiByte(
-                                        CP_UTF8, 0, hdrLine.c_str() + valStart,
-                                        (int)(hdrLine.size() - valStart),
-                                        nullptr, 0, nullptr, nullptr);
-                                    value.resize(valLen);
-                                    WideCharToMultiByte(
-                                        CP_UTF8, 0, hdrLine.c_str() + valStart,
-                                        (int)(hdrLine.size() - valStart),
-                                        &value[0], valLen, nullptr, nullptr);
-                                }
-                                response.headers.push_back({std::move(key), std::move(value)});
-                            }
-                        }
-                    }
-                }
+            if (!WinHttpSendRequest(hRequest, WINHTTP_NO_ADDITIONAL_HEADERS, 0,
+                                     bodyPtr, bodyLen, bodyLen, context))
+                transfer->finish(true);
+        }
 
-                DWORD bytesAvailable = 0;
-                while (WinHttpQueryDataAvailable(hRequest, &bytesAvailable) && bytesAvailable > 0) {
-                    size_t prevSize = response.body.size();
-                    response.body.resize(prevSize + bytesAvailable);
-                    DWORD bytesRead = 0;
-                    WinHttpReadData(hRequest, response.body.data() + prevSize,
-                                     bytesAvailable, &bytesRead);
-                    response.body.resize(prevSize + bytesRead);
-                    bytesAvailable = 0;
-                }
-            }
+    public:
+        WinHTTPHttpClientContext() {
+            hSession = WinHttpOpen(L"OmegaCommon",
+                                   WINHTTP_ACCESS_TYPE_AUTOMATIC_PROXY,
+                                   WINHTTP_NO_PROXY_NAME,
+                                   WINHTTP_NO_PROXY_BYPASS,
+                                   WINHTTP_FLAG_ASYNC);
+        }
 
-            WinHttpCloseHandle(hRequest);
-            WinHttpCloseHandle(hConnect);
+        explicit WinHTTPHttpClientContext(HttpTlsConfig config)
+            : WinHTTPHttpClientContext()
+        {
+            tlsConfig_ = std::move(config);
+        }
 
-            promise.set_value(std::move(response));
+        std::future<HttpResponse> makeRequest(HttpRequestDescriptor descriptor) override {
+            auto promise = std::make_shared<std::promise<HttpResponse>>();
+            auto future = promise->get_future();
+            submit(std::move(descriptor), [promise](HttpResponse response) {
+                promise->set_value(std::move(response));
+            });
             return future;
         }
 
+        /// Completes from WinHTTP's status callback without occupying a
+        /// scheduler worker.
+        Async<HttpResponse> makeRequestAsync(HttpRequestDescriptor descriptor) override {
+            auto promise = std::make_shared<Promise<HttpResponse>>();
+            auto result = promise->async();
+            submit(std::move(descriptor), [promise](HttpResponse response) {
+                promise->set(std::move(response));
+            });
+            return result;
+        }
+
         ~WinHTTPHttpClientContext() override {
             if (hSession)
                 WinHttpCloseHandle(hSession);
@@ -203,4 +306,10 @@ namespace OmegaCommon {
     std::shared_ptr<HttpClientContext> HttpClientContext::Create(HttpTlsConfig config) {
         return std::make_shared<WinHTTPHttpClientContext>(std::move(config));
     }
+
+    std::shared_ptr<HttpClientContext> HttpClientContext::Create(HttpTlsConfig config, HttpClientOptions) {
+        // WinHTTP pools connections per session and negotiates HTTP/2 itself;
+        // every request runs on the async session's callbacks.
+        return std::make_shared<WinHTTPHttpClientContext>(std::move(config));
+    }
 }
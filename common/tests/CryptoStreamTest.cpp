@@ -0,0 +1,256 @@
+// CryptoStreamTest — verification for the reusable digest / AEAD contexts
+// and the batch digest API in crypto.h. Covers streaming digests agreeing
+// with one-shot digest(), DigestContext::reset, one AeadContext sealing and
+// opening many messages interchangeably with encrypt() / decrypt(), in-place
+// and piecewise updates, tamper detection, misuse outside a message, and
+// digestAll() / verifyDigests() matching serial results from several threads.
+
+#include "omega-common/crypto.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using OmegaCommon::AeadContext;
+using OmegaCommon::DigestAlgorithm;
+using OmegaCommon::DigestContext;
+using OmegaCommon::DigestResult;
+using OmegaCommon::EncryptionKey;
+using OmegaCommon::Nonce;
+using OmegaCommon::Vector;
+
+static int g_failures = 0;
+
+static void check(bool cond, const char *what) {
+  if (cond) {
+    std::cout << "  ok: " << what << "\n";
+  } else {
+    std::cerr << "  FAIL: " << what << "\n";
+    ++g_failures;
+  }
+}
+
+static Vector<std::uint8_t> patternBytes(size_t size, unsigned seed) {
+  Vector<std::uint8_t> bytes(size);
+  for (size_t i = 0; i < size; ++i) {
+    bytes[i] = static_cast<std::uint8_t>((i * 131 + seed * 7) ^ (i >> 5));
+  }
+  return bytes;
+}
+
+static OmegaCommon::ArrayRef<std::uint8_t> view(Vector<std::uint8_t> &bytes) {
+  return OmegaCommon::makeArrayRef(bytes.data(), bytes.data() + bytes.size());
+}
+
+static Nonce nonceFor(std::uint8_t tagByte) {
+  std::uint8_t raw[Nonce::NonceSize] = {};
+  raw[0] = tagByte;
+  return Nonce::fromBytes(raw, sizeof(raw)).value();
+}
+
+static void testStreamingDigest() {
+  std::cout << "[DigestContext agrees with digest()]\n";
+  auto data = patternBytes(100000, 1);
+  auto oneShot = OmegaCommon::digest(DigestAlgorithm::SHA256, view(data));
+  auto context = DigestContext::create(DigestAlgorithm::SHA256);
+  if (!oneShot.isOk() || !context.isOk()) {
+    check(false, "digest and context are available");
+    return;
+  }
+
+  auto &hasher = context.value();
+  for (size_t offset = 0; offset < data.size(); offset += 7777) {
+    (void)hasher.update(data.data() + offset, std::min<size_t>(7777, data.size() - offset));
+  }
+  auto streamed = hasher.finish();
+  check(streamed.isOk() && streamed.value().bytes == oneShot.value().bytes, "uneven pieces hash like one buffer");
+
+  auto again = hasher.update(data.data(), data.size()).isOk() ? hasher.finish() : streamed;
+  check(again.isOk() && again.value().bytes == oneShot.value().bytes, "finish re-arms for the next message");
+
+  (void)hasher.update(reinterpret_cast<const std::uint8_t *>("garbage"), 7);
+  check(hasher.reset().isOk(), "reset succeeds");
+  (void)hasher.update(data.data(), data.size());
+  auto afterReset = hasher.finish();
+  check(afterReset.isOk() && afterReset.value().bytes == oneShot.value().bytes, "reset discards pending input");
+
+  auto text = OmegaCommon::digest(DigestAlgorithm::SHA512, OmegaCommon::StrRef("abc"));
+  check(text.isOk() && text.value().hex().substr(0, 16) == "ddaf35a193617aba", "SHA-512 of 'abc' matches the known vector");
+  auto empty = OmegaCommon::digest(DigestAlgorithm::SHA256, OmegaCommon::StrRef(""));
+  check(empty.isOk() && empty.value().hex().substr(0, 16) == "e3b0c44298fc1c14", "SHA-256 of '' matches the known vector");
+}
+
+static void testAeadReuse() {
+  std::cout << "[one AeadContext for many messages]\n";
+  auto key = EncryptionKey::generate();
+  if (!key.isOk()) {
+    check(false, "key generation");
+    return;
+  }
+  auto context = AeadContext::create(key.value());
+  if (!context.isOk()) {
+    check(false, "AeadContext::create");
+    return;
+  }
+  auto &aead = context.value();
+  const std::uint8_t aad[] = {'h', 'd', 'r'};
+
+  bool sealedMatches = true;
+  bool openedByDecrypt = true;
+  for (std::uint8_t msg = 0; msg < 6; ++msg) {
+    auto plain = patternBytes(1000 + msg * 333, msg);
+    auto sealed = aead.seal(nonceFor(msg), plain.data(), plain.size(), aad, sizeof(aad));
+    auto reference = OmegaCommon::encrypt(key.value(), nonceFor(msg), plain.data(), plain.size(), aad, sizeof(aad));
+    sealedMatches = sealedMatches && sealed.isOk() && reference.isOk() &&
+                    sealed.value().ciphertext == reference.value().ciphertext &&
+                    sealed.value().tag == reference.value().tag;
+    if (sealed.isOk()) {
+      auto opened = OmegaCommon::decrypt(key.value(), nonceFor(msg), sealed.value(), aad, sizeof(aad));
+      openedByDecrypt = openedByDecrypt && opened.isOk() && opened.value() == plain;
+    }
+  }
+  check(sealedMatches, "seal() matches encrypt() message after message");
+  check(openedByDecrypt, "decrypt() opens what the context sealed");
+
+  // Piecewise encryption in place, then decryption through the same context.
+  auto plain = patternBytes(50000, 9);
+  auto buffer = plain;
+  std::array<std::uint8_t, 16> tag {};
+  bool streamed = aead.beginEncrypt(nonceFor(42), aad, sizeof(aad)).isOk();
+  for (size_t offset = 0; streamed && offset < buffer.size(); offset += 4096) {
+    auto len = std::min<size_t>(4096, buffer.size() - offset);
+    streamed = aead.update(buffer.data() + offset, len, buffer.data() + offset).isOk();
+  }
+  streamed = streamed && aead.finishEncrypt(tag).isOk();
+  auto whole = aead.seal(nonceFor(42), plain.data(), plain.size(), aad, sizeof(aad));
+  check(streamed && whole.isOk() && whole.value().ciphertext == buffer && whole.value().tag == tag,
+        "in-place pieces equal one whole-message seal");
+
+  auto opened = aead.openInto(nonceFor(42), buffer.data(), buffer.size(), tag, buffer.data(), aad, sizeof(aad));
+  check(opened.isOk() && buffer == plain, "openInto decrypts in place");
+
+  auto reference = OmegaCommon::encrypt(key.value(), nonceFor(7), plain.data(), plain.size());
+  if (reference.isOk()) {
+    Vector<std::uint8_t> out(plain.size());
+    auto viaContext = aead.openInto(nonceFor(7), reference.value().ciphertext.data(),
+                                    reference.value().ciphertext.size(), reference.value().tag, out.data());
+    check(viaContext.isOk() && out == plain, "context opens encrypt() output without AAD");
+  }
+}
+
+static void testAeadTamper() {
+  std::cout << "[tampering and misuse are rejected]\n";
+  auto key = EncryptionKey::generate();
+  if (!key.isOk()) {
+    check(false, "key generation");
+    return;
+  }
+  auto context = AeadContext::create(key.value());
+  if (!context.isOk()) {
+    check(false, "AeadContext::create");
+    return;
+  }
+  auto &aead = context.value();
+  auto plain = patternBytes(256, 3);
+  const std::uint8_t aad[] = {1, 2, 3, 4};
+  auto sealed = aead.seal(nonceFor(1), plain.data(), plain.size(), aad, sizeof(aad));
+  if (!sealed.isOk()) {
+    check(false, "seal");
+    return;
+  }
+
+  Vector<std::uint8_t> out(plain.size());
+  auto flipped = sealed.value().ciphertext;
+  flipped[100] ^= 0x01;
+  check(aead.openInto(nonceFor(1), flipped.data(), flipped.size(), sealed.value().tag, out.data(), aad, sizeof(aad)).isErr(),
+        "flipped ciphertext bit fails authentication");
+
+  const std::uint8_t otherAad[] = {1, 2, 3, 5};
+  check(aead.openInto(nonceFor(1), sealed.value().ciphertext.data(), plain.size(), sealed.value().tag, out.data(),
+                      otherAad, sizeof(otherAad)).isErr(),
+        "different AAD fails authentication");
+  check(aead.openInto(nonceFor(2), sealed.value().ciphertext.data(), plain.size(), sealed.value().tag, out.data(),
+                      aad, sizeof(aad)).isErr(),
+        "different nonce fails authentication");
+
+  auto good = aead.openInto(nonceFor(1), sealed.value().ciphertext.data(), plain.size(), sealed.value().tag,
+                            out.data(), aad, sizeof(aad));
+  check(good.isOk() && out == plain, "context still opens valid messages after failures");
+
+  std::array<std::uint8_t, 16> tag {};
+  check(aead.update(plain.data(), plain.size(), out.data()).isErr(), "update outside a message is an error");
+  check(aead.finishEncrypt(tag).isErr(), "finishEncrypt without beginEncrypt is an error");
+}
+
+static void testBatchDigests() {
+  std::cout << "[digestAll / verifyDigests]\n";
+  std::vector<Vector<std::uint8_t>> storage;
+  for (unsigned i = 0; i < 64; ++i) {
+    storage.push_back(patternBytes((i % 5 == 0) ? 0 : 4096 + i * 997, i));
+  }
+  Vector<OmegaCommon::ArrayRef<std::uint8_t>> buffers;
+  for (auto &bytes : storage) {
+    buffers.push_back(view(bytes));
+  }
+
+  auto batch = OmegaCommon::digestAll(DigestAlgorithm::SHA256, buffers);
+  bool serialMatches = batch.isOk() && batch.value().size() == storage.size();
+  for (size_t i = 0; serialMatches && i < storage.size(); ++i) {
+    auto serial = OmegaCommon::digest(DigestAlgorithm::SHA256, buffers[i]);
+    serialMatches = serial.isOk() && serial.value().bytes == batch.value()[i].bytes;
+  }
+  check(serialMatches, "batch digests equal serial digests, in order");
+
+  auto small = OmegaCommon::digestAll(DigestAlgorithm::SHA512, Vector<OmegaCommon::ArrayRef<std::uint8_t>>{buffers[1]});
+  check(small.isOk() && small.value().size() == 1 && small.value()[0].bytes.size() == 64, "single small buffer runs inline");
+
+  if (!batch.isOk()) {
+    return;
+  }
+  auto expected = batch.value();
+  auto allGood = OmegaCommon::verifyDigests(DigestAlgorithm::SHA256, buffers, expected);
+  check(allGood.isOk() && allGood.value().empty(), "untouched buffers all verify");
+
+  storage[17][2000] ^= 0x80;
+  expected[40].bytes[0] ^= 0x01;
+  auto flagged = OmegaCommon::verifyDigests(DigestAlgorithm::SHA256, buffers, expected);
+  check(flagged.isOk() && flagged.value() == Vector<size_t>{17, 40}, "corrupted buffer and wrong digest are reported");
+
+  expected.pop_back();
+  check(OmegaCommon::verifyDigests(DigestAlgorithm::SHA256, buffers, expected).isErr(),
+        "mismatched expected count is an error");
+
+  std::atomic<int> wrong{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&]() {
+      for (int iter = 0; iter < 5; ++iter) {
+        auto again = OmegaCommon::digestAll(DigestAlgorithm::SHA256, buffers);
+        if (!again.isOk() || again.value()[3].bytes != batch.value()[3].bytes) {
+          wrong.fetch_add(1);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  check(wrong.load() == 0, "concurrent batches agree");
+}
+
+int main() {
+  testStreamingDigest();
+  testAeadReuse();
+  testAeadTamper();
+  testBatchDigests();
+
+  if (g_failures == 0) {
+    std::cout << "\nCryptoStreamTest: ALL CHECKS PASSED\n";
+    return 0;
+  }
+  std::cerr << "\nCryptoStreamTest: " << g_failures << " CHECK(S) FAILED\n";
+  return 1;
+}
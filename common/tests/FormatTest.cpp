@@ -0,0 +1,142 @@
+// FormatTest — verification for OMEGA_FMT compile-time format strings. Every
+// placeholder form (@N, @{N}, @@, stray and trailing @, malformed @{) must
+// produce exactly what the runtime Formatter produces; formatTo appends into a
+// reused buffer; FormatProvider types still format through the fallback; and
+// Log() honours the level filter, reaches the sink, and survives a sink that
+// logs from inside log().
+
+#include "omega-common/format.h"
+
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using OmegaCommon::LogLevel;
+using OmegaCommon::String;
+using OmegaCommon::StrRef;
+
+static int g_failures = 0;
+
+static void check(bool cond, const char *what) {
+  if (cond) {
+    std::cout << "  ok: " << what << "\n";
+  } else {
+    std::cerr << "  FAIL: " << what << "\n";
+    ++g_failures;
+  }
+}
+
+struct Widget {
+  OMEGACOMMON_CLASS("Widget")
+};
+
+static void testMatchesRuntime() {
+  std::cout << "[OMEGA_FMT: same output as the runtime Formatter]\n";
+#define SAME(fmt, ...)                                                          \
+  check(OmegaCommon::fmtString(OMEGA_FMT(fmt), __VA_ARGS__) ==                  \
+            OmegaCommon::fmtString(fmt, __VA_ARGS__),                           \
+        fmt)
+  SAME("plain @0 and @1", 7, std::string("two"));
+  SAME("@{1}-@{0}-@{10}", 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10);
+  SAME("escaped @@0 literal", 1);
+  SAME("stray @x, brace @{y}, open @{12", 1);
+  SAME("trailing @", 1);
+  SAME("@0@0@0", 'c');
+  SAME("@0", -123456789);
+#undef SAME
+  check(OmegaCommon::fmtString(OMEGA_FMT("no placeholders")) == "no placeholders",
+        "format without arguments");
+  check(OmegaCommon::fmtString(OMEGA_FMT("")) == "", "empty format");
+}
+
+static void testArgumentKinds() {
+  std::cout << "[OMEGA_FMT: argument kinds]\n";
+  String s = "str";
+  StrRef ref(s);
+  unsigned long long big = 18446744073709551615ull;
+  check(OmegaCommon::fmtString(OMEGA_FMT("@0|@1|@2|@3"), s, ref, "lit", big) ==
+            "str|str|lit|18446744073709551615",
+        "strings, StrRef, literals, unsigned 64-bit");
+  check(OmegaCommon::fmtString(OMEGA_FMT("@0 @1 @2"), 0.5, true, 2.0f) ==
+            "0.5 true 2",
+        "floating point and bool");
+  Widget w;
+  check(OmegaCommon::fmtString(OMEGA_FMT("[@0]"), w) ==
+            OmegaCommon::fmtString("[@0]", w),
+        "FormatProvider fallback matches the runtime path");
+}
+
+static void testFormatTo() {
+  std::cout << "[formatTo: appends into a reused buffer]\n";
+  String buffer;
+  buffer.reserve(128);
+  const char *data = buffer.data();
+  for (int i = 0; i < 100; ++i) {
+    buffer.clear();
+    OmegaCommon::formatTo(buffer, OMEGA_FMT("frame @0 took @1 ms"), i, i * 2);
+  }
+  check(buffer == "frame 99 took 198 ms", "last message formatted");
+  check(buffer.data() == data, "buffer never reallocated");
+  OmegaCommon::formatTo(buffer, OMEGA_FMT("!"));
+  check(buffer == "frame 99 took 198 ms!", "formatTo appends");
+}
+
+struct CaptureSink : OmegaCommon::LogSink {
+  std::vector<std::pair<LogLevel, String>> messages;
+  bool nest = false;
+  void log(LogLevel level, StrRef message) override {
+    messages.emplace_back(level, String(message.begin(), message.end()));
+    if (nest) {
+      nest = false;
+      OmegaCommon::LogError(OMEGA_FMT("nested @0"), 1);
+    }
+  }
+};
+
+static void testLog() {
+  std::cout << "[Log: filtering, sink delivery, nested logging]\n";
+  auto sink = std::make_shared<CaptureSink>();
+  OmegaCommon::setLogSink(sink);
+  OmegaCommon::setLogMinimumLevel(LogLevel::Warn);
+
+  OmegaCommon::LogDebug(OMEGA_FMT("hidden @0"), 1);
+  OmegaCommon::LogInfo("hidden @0", 2);
+  check(sink->messages.empty(), "messages below the minimum level are dropped");
+  check(!OmegaCommon::shouldLog(LogLevel::Info) &&
+            OmegaCommon::shouldLog(LogLevel::Error),
+        "shouldLog follows the minimum level");
+
+  OmegaCommon::LogWarn(OMEGA_FMT("shown @0"), 3);
+  OmegaCommon::LogError("runtime @0", 4);
+  check(sink->messages.size() == 2, "messages at or above the level arrive");
+  check(sink->messages.size() == 2 && sink->messages[0].second == "shown 3" &&
+            sink->messages[1].second == "runtime 4",
+        "both format paths reach the sink");
+
+  sink->messages.clear();
+  sink->nest = true;
+  OmegaCommon::LogWarn(OMEGA_FMT("outer @0"), 5);
+  check(sink->messages.size() == 2, "sink logged from inside log()");
+  check(sink->messages.size() == 2 && sink->messages[0].second == "outer 5" &&
+            sink->messages[1].second == "nested 1",
+        "nested message does not clobber the outer one");
+
+  OmegaCommon::setLogSink(nullptr);
+  OmegaCommon::setLogMinimumLevel(LogLevel::Info);
+}
+
+int main() {
+  testMatchesRuntime();
+  testArgumentKinds();
+  testFormatTo();
+  testLog();
+
+  if (g_failures == 0) {
+    std::cout << "\nFormatTest: ALL CHECKS PASSED\n";
+    return 0;
+  }
+  std::cerr << "\nFormatTest: " << g_failures << " CHECK(S) FAILED\n";
+  return 1;
+}
@@ -0,0 +1,636 @@
+// HttpClientTest — verification for the curl multi event-loop HTTP client.
+// Runs a small keep-alive HTTP/1.1 server on loopback and checks that
+// concurrent requests complete with the right bodies, that repeat requests
+// reuse pooled connections, that maxConcurrentRequests bounds the transfers
+// in flight, and that makeRequestAsync composes with whenAll without
+// occupying a scheduler worker per request, including for backends whose
+// makeRequest blocks. Also covers streaming bodies (sink pause/resume, abort,
+// cancel of running and queued transfers, openStream) and byte-range requests.
+
+#include "omega-common/net.h"
+#include "omega-common/multithread.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using OmegaCommon::HttpClientContext;
+using OmegaCommon::HttpClientOptions;
+using OmegaCommon::HttpResponse;
+
+static int g_failures = 0;
+
+static void check(bool cond, const char *what) {
+  if (cond) {
+    std::cout << "  ok: " << what << "\n";
+  } else {
+    std::cerr << "  FAIL: " << what << "\n";
+    ++g_failures;
+  }
+}
+
+static unsigned char blobByte(size_t i) {
+  return static_cast<unsigned char>((i * 7) % 251);
+}
+
+/// Echoes the request path as the body. Paths starting with /slow hold the
+/// response for 50 ms so overlapping transfers can be observed. /blob/<n>
+/// serves n pattern bytes (see blobByte) and honors `Range: bytes=a-b`.
+class LoopbackServer {
+  int listenFd_ = -1;
+  unsigned short port_ = 0;
+  std::thread acceptThread_;
+  std::mutex mutex_;
+  std::vector<std::thread> connections_;
+  std::vector<int> fds_;
+  std::atomic<bool> stopping_{false};
+
+  void serve(int fd) {
+    std::string pending;
+    char buf[4096];
+    while (!stopping_.load()) {
+      size_t end = pending.find("\r\n\r\n");
+      if (end == std::string::npos) {
+        ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0) {
+          break;
+        }
+        pending.append(buf, static_cast<size_t>(n));
+        continue;
+      }
+      std::string head = pending.substr(0, end);
+      pending.erase(0, end + 4);
+      size_t pathBegin = head.find(' ') + 1;
+      std::string path = head.substr(pathBegin, head.find(' ', pathBegin) - pathBegin);
+
+      int now = inFlight.fetch_add(1) + 1;
+      int seen = maxInFlight.load();
+      while (now > seen && !maxInFlight.compare_exchange_weak(seen, now)) {
+      }
+      if (path.rfind("/slow", 0) == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      }
+      inFlight.fetch_sub(1);
+      requests.fetch_add(1);
+
+      std::string response;
+      if (path.rfind("/blob/", 0) == 0) {
+        response = blobResponse(head, std::stoul(path.substr(6)));
+      } else {
+        response = "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nX-Path: " + path +
+                   "\r\nContent-Length: " + std::to_string(path.size()) + "\r\n\r\n" + path;
+      }
+      if (::send(fd, response.data(), response.size(), MSG_NOSIGNAL) < 0) {
+        break;
+      }
+    }
+  }
+
+  static std::string blobResponse(const std::string &head, size_t total) {
+    size_t first = 0;
+    size_t last = total - 1;
+    bool partial = false;
+    size_t range = head.find("Range: bytes=");
+    if (range != std::string::npos) {
+      size_t spec = range + 13;
+      size_t dash = head.find('-', spec);
+      size_t eol = head.find("\r\n", spec);
+      first = std::stoul(head.substr(spec, dash - spec));
+      std::string tail = head.substr(dash + 1, eol == std::string::npos ? std::string::npos : eol - dash - 1);
+      if (!tail.empty()) {
+        last = std::min(last, static_cast<size_t>(std::stoul(tail)));
+      }
+      partial = true;
+    }
+    std::string body(last - first + 1, '\0');
+    for (size_t i = first; i <= last; ++i) {
+      body[i - first] = static_cast<char>(blobByte(i));
+    }
+    std::string out = partial ? "HTTP/1.1 206 Partial Content\r\n" : "HTTP/1.1 200 OK\r\n";
+    if (partial) {
+      out += "Content-Range: bytes " + std::to_string(first) + "-" + std::to_string(last) + "/" +
+             std::to_string(total) + "\r\n";
+    }
+    out += "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n";
+    return out + body;
+  }
+
+public:
+  std::atomic<int> connectionsAccepted{0};
+  std::atomic<int> requests{0};
+  std::atomic<int> inFlight{0};
+  std::atomic<int> maxInFlight{0};
+
+  bool start() {
+    listenFd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (listenFd_ < 0) {
+      return false;
+    }
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    if (::bind(listenFd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 ||
+        ::listen(listenFd_, 64) != 0) {
+      return false;
+    }
+    socklen_t len = sizeof(addr);
+    ::getsockname(listenFd_, reinterpret_cast<sockaddr *>(&addr), &len);
+    port_ = ntohs(addr.sin_port);
+    acceptThread_ = std::thread([this]() {
+      while (true) {
+        int fd = ::accept(listenFd_, nullptr, nullptr);
+        if (fd < 0 || stopping_.load()) {
+          if (fd >= 0) {
+            ::close(fd);
+          }
+          break;
+        }
+        connectionsAccepted.fetch_add(1);
+        std::lock_guard<std::mutex> lk(mutex_);
+        fds_.push_back(fd);
+        connections_.emplace_back([this, fd]() { serve(fd); });
+      }
+    });
+    return true;
+  }
+
+  std::string url(const std::string &path) const {
+    return "http://127.0.0.1:" + std::to_string(port_) + path;
+  }
+
+  void resetCounters() {
+    connectionsAccepted.store(0);
+    requests.store(0);
+    maxInFlight.store(0);
+  }
+
+  ~LoopbackServer() {
+    stopping_.store(true);
+    if (listenFd_ >= 0) {
+      ::shutdown(listenFd_, SHUT_RDWR);
+      ::close(listenFd_);
+    }
+    if (acceptThread_.joinable()) {
+      acceptThread_.join();
+    }
+    std::lock_guard<std::mutex> lk(mutex_);
+    for (int fd : fds_) {
+      ::shutdown(fd, SHUT_RDWR);
+    }
+    for (auto &t : connections_) {
+      t.join();
+    }
+    for (int fd : fds_) {
+      ::close(fd);
+    }
+  }
+};
+
+static std::string bodyOf(const HttpResponse &response) {
+  return std::string(response.body.begin(), response.body.end());
+}
+
+/// A GET of @p url with every other field at its default. The descriptor views
+/// @p url, which must outlive the call it is passed to.
+static OmegaCommon::HttpRequestDescriptor requestFor(const std::string &url) {
+  OmegaCommon::HttpRequestDescriptor request;
+  request.url = url;
+  return request;
+}
+
+static void testConcurrentRequests(LoopbackServer &server) {
+  std::cout << "[makeRequest: concurrent requests complete on one event loop]\n";
+  server.resetCounters();
+  HttpClientOptions options;
+  options.maxConcurrentRequests = 8;
+  options.maxConnectionsPerHost = 8;
+  auto client = HttpClientContext::Create({}, options);
+
+  std::vector<std::string> paths;
+  std::vector<std::string> urls;
+  std::vector<std::future<HttpResponse>> futures;
+  for (int i = 0; i < 16; ++i) {
+    paths.push_back("/slow/" + std::to_string(i));
+    urls.push_back(server.url(paths.back()));
+  }
+  auto start = std::chrono::steady_clock::now();
+  for (auto &url : urls) {
+    futures.push_back(client->makeRequest(requestFor(url)));
+  }
+  bool allOk = true;
+  bool headersOk = true;
+  for (size_t i = 0; i < futures.size(); ++i) {
+    HttpResponse response = futures[i].get();
+    allOk = allOk && response.statusCode == 200 && bodyOf(response) == paths[i];
+    bool found = false;
+    for (auto &h : response.headers) {
+      found = found || (h.first == "X-Path" && h.second == paths[i]);
+    }
+    headersOk = headersOk && found;
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  check(allOk, "every response has status 200 and its own body");
+  check(headersOk, "response headers are parsed per transfer");
+  check(server.maxInFlight.load() > 1, "requests overlap on the server");
+  check(elapsed < std::chrono::milliseconds(16 * 50), "16 slow requests finish faster than serially");
+  check(server.maxInFlight.load() <= 8, "no more than maxConcurrentRequests in flight");
+}
+
+static void testConnectionReuse(LoopbackServer &server) {
+  std::cout << "[makeRequest: sequential requests reuse the pooled connection]\n";
+  server.resetCounters();
+  auto client = HttpClientContext::Create();
+  std::string url = server.url("/fast");
+  bool allOk = true;
+  for (int i = 0; i < 10; ++i) {
+    HttpResponse response = client->makeRequest(requestFor(url)).get();
+    allOk = allOk && response.statusCode == 200 && bodyOf(response) == "/fast";
+  }
+  check(allOk, "10 sequential requests succeed");
+  check(server.requests.load() == 10, "server saw 10 requests");
+  check(server.connectionsAccepted.load() == 1, "all 10 requests used one connection");
+}
+
+static void testConcurrencyLimit(LoopbackServer &server) {
+  std::cout << "[HttpClientOptions: maxConcurrentRequests queues the rest]\n";
+  server.resetCounters();
+  HttpClientOptions options;
+  options.maxConcurrentRequests = 2;
+  auto client = HttpClientContext::Create({}, options);
+  std::vector<std::string> urls;
+  for (int i = 0; i < 8; ++i) {
+    urls.push_back(server.url("/slow/limit/" + std::to_string(i)));
+  }
+  std::vector<std::future<HttpResponse>> futures;
+  for (auto &url : urls) {
+    futures.push_back(client->makeRequest(requestFor(url)));
+  }
+  bool allOk = true;
+  for (auto &f : futures) {
+    allOk = allOk && f.get().statusCode == 200;
+  }
+  check(allOk, "queued requests all complete");
+  check(server.maxInFlight.load() <= 2, "at most 2 requests in flight");
+  check(server.connectionsAccepted.load() <= 2, "idle connections are reused by queued requests");
+}
+
+static void testAsyncRequests(LoopbackServer &server) {
+  std::cout << "[makeRequestAsync: completes from the event loop, composes with whenAll]\n";
+  server.resetCounters();
+  auto client = HttpClientContext::Create();
+  std::vector<std::string> urls;
+  OmegaCommon::Vector<OmegaCommon::Async<HttpResponse>> pending;
+  for (int i = 0; i < 6; ++i) {
+    urls.push_back(server.url("/async/" + std::to_string(i)));
+  }
+  for (auto &url : urls) {
+    pending.push_back(client->makeRequestAsync(requestFor(url)));
+  }
+  auto all = OmegaCommon::whenAll(pending);
+  auto &responses = all.get();
+  bool inOrder = responses.size() == 6;
+  for (size_t i = 0; inOrder && i < responses.size(); ++i) {
+    inOrder = bodyOf(responses[i]) == "/async/" + std::to_string(i);
+  }
+  check(inOrder, "whenAll yields responses in request order");
+
+  std::atomic<bool> delivered{false};
+  {
+    auto scoped = HttpClientContext::Create();
+    scoped->makeRequestAsync(requestFor(server.url("/slow/outlive"))).onReady([&delivered](HttpResponse &r) {
+      delivered.store(r.statusCode == 200);
+    });
+  }
+  for (int i = 0; i < 200 && !delivered.load(); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  check(delivered.load(), "in-flight request keeps its client alive until delivery");
+}
+
+static bool matchesBlob(const std::vector<unsigned char> &data, size_t offset) {
+  for (size_t i = 0; i < data.size(); ++i) {
+    if (data[i] != blobByte(offset + i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Collects the body, pausing after every @c pauseEvery bytes.
+class CollectingSink : public OmegaCommon::HttpBodySink {
+public:
+  std::mutex mutex;
+  std::vector<unsigned char> data;
+  int status = -1;
+  int completeStatus = -1;
+  int pauses = 0;
+  bool pausedNow = false;
+  int deliveredWhilePaused = 0;
+  size_t pauseEvery = 0;
+  size_t sincePause = 0;
+  size_t abortAfter = 0;
+
+  void onResponse(int statusCode,
+                  const OmegaCommon::Vector<std::pair<OmegaCommon::String, OmegaCommon::String>> &) override {
+    std::lock_guard<std::mutex> lk(mutex);
+    status = statusCode;
+  }
+
+  OmegaCommon::HttpSinkStatus onData(const std::uint8_t *bytes, size_t size) override {
+    std::lock_guard<std::mutex> lk(mutex);
+    deliveredWhilePaused += pausedNow ? 1 : 0;
+    data.insert(data.end(), bytes, bytes + size);
+    if (abortAfter > 0 && data.size() >= abortAfter) {
+      return OmegaCommon::HttpSinkStatus::Abort;
+    }
+    sincePause += size;
+    if (pauseEvery > 0 && sincePause >= pauseEvery) {
+      sincePause = 0;
+      pausedNow = true;
+      ++pauses;
+      return OmegaCommon::HttpSinkStatus::Pause;
+    }
+    return OmegaCommon::HttpSinkStatus::Continue;
+  }
+
+  void onComplete(const HttpResponse &response) override {
+    std::lock_guard<std::mutex> lk(mutex);
+    completeStatus = response.statusCode;
+  }
+
+  bool takePaused() {
+    std::lock_guard<std::mutex> lk(mutex);
+    bool was = pausedNow;
+    pausedNow = false;
+    return was;
+  }
+};
+
+static void testStreamingSink(LoopbackServer &server) {
+  std::cout << "[makeStreamingRequest: chunks reach the sink, Pause holds delivery]\n";
+  auto client = HttpClientContext::Create();
+  const size_t total = 2 * 1024 * 1024;
+  std::string url = server.url("/blob/" + std::to_string(total));
+  auto sink = std::make_shared<CollectingSink>();
+  sink->pauseEvery = 256 * 1024;
+  auto stream = client->makeStreamingRequest(requestFor(url), sink);
+  auto done = stream->completion();
+  while (!done.ready()) {
+    if (sink->takePaused()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      stream->resume();
+    } else {
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+  }
+  check(done.get().statusCode == 200 && done.get().body.empty(), "completion carries status, no body");
+  check(sink->status == 200 && sink->completeStatus == 200, "sink saw the response head and completion");
+  check(sink->data.size() == total && matchesBlob(sink->data, 0), "all bytes arrived in order");
+  check(sink->pauses >= 4, "the sink paused the transfer repeatedly");
+  check(sink->deliveredWhilePaused == 0, "no data delivered while paused");
+
+  std::cout << "[makeStreamingRequest: Abort and cancel() end the transfer]\n";
+  auto aborting = std::make_shared<CollectingSink>();
+  aborting->abortAfter = 1;
+  auto aborted = client->makeStreamingRequest(requestFor(url), aborting);
+  check(aborted->completion().get().statusCode == 0, "Abort fails the transfer");
+  check(aborting->completeStatus == 0, "sink is told about the abort");
+
+  auto holding = std::make_shared<CollectingSink>();
+  holding->pauseEvery = 1;
+  auto cancelled = client->makeStreamingRequest(requestFor(url), holding);
+  while (!holding->takePaused()) {
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+  }
+  cancelled->cancel();
+  check(cancelled->completion().get().statusCode == 0, "cancel() ends a paused transfer");
+  check(holding->data.size() < total, "a cancelled transfer stops early");
+}
+
+static void testCancelWaiting(LoopbackServer &server) {
+  std::cout << "[makeStreamingRequest: cancel() drops a transfer still waiting for a slot]\n";
+  HttpClientOptions options;
+  options.maxConcurrentRequests = 1;
+  auto client = HttpClientContext::Create({}, options);
+  std::string url = server.url("/blob/" + std::to_string(1024 * 1024));
+  auto request = requestFor(url);
+
+  auto holding = std::make_shared<CollectingSink>();
+  holding->pauseEvery = 1;
+  auto running = client->makeStreamingRequest(request, holding);
+  while (!holding->takePaused()) {
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+  }
+  auto queuedSink = std::make_shared<CollectingSink>();
+  auto queued = client->makeStreamingRequest(request, queuedSink);
+  queued->cancel();
+  auto done = queued->completion();
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+  while (!done.ready() && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  check(done.ready() && done.get().statusCode == 0, "the queued transfer fails while the slot is still held");
+  check(queuedSink->completeStatus == 0 && queuedSink->data.empty(), "its sink is told without receiving data");
+  running->cancel();
+  check(running->completion().get().statusCode == 0, "the running transfer is unaffected until cancelled");
+}
+
+static void testOpenStream(LoopbackServer &server) {
+  std::cout << "[openStream: bounded istream over the body]\n";
+  auto client = HttpClientContext::Create();
+  const size_t total = 3 * 1024 * 1024 + 17;
+  auto in = client->openStream(requestFor(server.url("/blob/" + std::to_string(total))), 64 * 1024);
+  std::vector<unsigned char> data;
+  char buf[10000];
+  while (in->read(buf, sizeof(buf)) || in->gcount() > 0) {
+    data.insert(data.end(), buf, buf + in->gcount());
+  }
+  check(data.size() == total && matchesBlob(data, 0), "istream yields the whole body");
+  check(in->eof() && !in->bad(), "clean EOF at the end of the body");
+
+  auto failing = client->openStream(requestFor("http://127.0.0.1:1/unreachable"));
+  failing->get();
+  check(failing->bad(), "a failed transfer sets badbit");
+
+  auto abandoned = client->openStream(requestFor(server.url("/blob/" + std::to_string(total))), 16 * 1024);
+  abandoned->read(buf, 100);
+  abandoned.reset();
+  check(true, "dropping a half-read stream cancels without hanging");
+}
+
+/// Implements only makeRequest, so streaming goes through the buffered
+/// fallback in HttpClientContext.
+class CannedClient : public HttpClientContext {
+public:
+  std::future<HttpResponse> makeRequest(OmegaCommon::HttpRequestDescriptor) override {
+    std::promise<HttpResponse> promise;
+    HttpResponse response;
+    response.statusCode = 200;
+    for (size_t i = 0; i < 300000; ++i) {
+      response.body.push_back(blobByte(i));
+    }
+    promise.set_value(std::move(response));
+    return promise.get_future();
+  }
+};
+
+static void testBufferedFallback() {
+  std::cout << "[makeStreamingRequest: buffered fallback honors Pause]\n";
+  auto client = std::make_shared<CannedClient>();
+  auto sink = std::make_shared<CollectingSink>();
+  sink->pauseEvery = 1;
+  auto stream = client->makeStreamingRequest(requestFor("canned"), sink);
+  auto done = stream->completion();
+  while (!done.ready()) {
+    if (sink->takePaused()) {
+      stream->resume();
+    } else {
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+  }
+  check(sink->data.size() == 300000 && matchesBlob(sink->data, 0), "fallback delivers the whole body");
+  check(sink->pauses >= 4 && sink->deliveredWhilePaused == 0, "fallback stops while paused");
+
+  auto in = client->openStream(requestFor("canned"), 4096);
+  std::vector<unsigned char> data((std::istreambuf_iterator<char>(*in)), std::istreambuf_iterator<char>());
+  check(data.size() == 300000 && matchesBlob(data, 0), "openStream works over the fallback");
+}
+
+/// A synchronous backend, like WinHTTP before it went async: makeRequest
+/// blocks its caller until the gate opens.
+class GatedClient : public HttpClientContext {
+public:
+  std::mutex mutex;
+  std::condition_variable opened;
+  bool open = false;
+  std::atomic<unsigned> blocked{0};
+
+  std::future<HttpResponse> makeRequest(OmegaCommon::HttpRequestDescriptor) override {
+    ++blocked;
+    std::unique_lock<std::mutex> lk(mutex);
+    opened.wait(lk, [&] { return open; });
+    std::promise<HttpResponse> promise;
+    HttpResponse response;
+    response.statusCode = 200;
+    promise.set_value(std::move(response));
+    return promise.get_future();
+  }
+};
+
+static void testBlockingFallback() {
+  std::cout << "[makeRequestAsync: blocking backends stay off the scheduler]\n";
+  auto client = std::make_shared<GatedClient>();
+  auto &scheduler = OmegaCommon::TaskScheduler::shared();
+  const unsigned count = scheduler.workerCount() + 2;
+  OmegaCommon::Vector<OmegaCommon::Async<HttpResponse>> pending;
+  for (unsigned i = 0; i < count; ++i) {
+    OmegaCommon::HttpRequestDescriptor descriptor;
+    descriptor.url = "blocking";
+    pending.push_back(client->makeRequestAsync(descriptor));
+  }
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (client->blocked.load() < count && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  check(client->blocked.load() == count, "every blocking request is in flight at once");
+
+  auto compute = scheduler.async([] { return 42; });
+  while (!compute.ready() && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  check(compute.ready(), "compute work still runs while more requests than workers block");
+
+  {
+    std::lock_guard<std::mutex> lk(client->mutex);
+    client->open = true;
+  }
+  client->opened.notify_all();
+  auto all = OmegaCommon::whenAll(pending);
+  bool allOk = true;
+  for (auto &r : all.get()) {
+    allOk = allOk && r.statusCode == 200;
+  }
+  check(allOk, "blocked requests complete once the backend answers");
+}
+
+static void testByteRanges(LoopbackServer &server) {
+  std::cout << "[HttpByteRange: partial and parallel range requests]\n";
+  auto client = HttpClientContext::Create();
+  const size_t total = 1000000;
+  std::string url = server.url("/blob/" + std::to_string(total));
+
+  auto partial = requestFor(url);
+  partial.range = OmegaCommon::HttpByteRange{1000, 500};
+  HttpResponse response = client->makeRequest(partial).get();
+  const OmegaCommon::String *contentRange = response.header("content-range");
+  check(response.statusCode == 206 && response.body.size() == 500 &&
+            matchesBlob(std::vector<unsigned char>(response.body.begin(), response.body.end()), 1000),
+        "206 with the requested 500 bytes");
+  check(contentRange != nullptr && *contentRange == "bytes 1000-1499/1000000",
+        "Content-Range is found case-insensitively");
+
+  auto resume = requestFor(url);
+  resume.range = OmegaCommon::HttpByteRange{total - 10, 0};
+  check(client->makeRequest(resume).get().body.size() == 10, "open-ended range resumes to the end");
+
+  const size_t parts = 4;
+  const size_t part = total / parts;
+  OmegaCommon::Vector<OmegaCommon::Async<HttpResponse>> pending;
+  for (size_t i = 0; i < parts; ++i) {
+    auto piece = requestFor(url);
+    piece.range = OmegaCommon::HttpByteRange{i * part, i + 1 == parts ? 0 : part};
+    pending.push_back(client->makeRequestAsync(piece));
+  }
+  auto all = OmegaCommon::whenAll(pending);
+  std::vector<unsigned char> joined;
+  for (auto &r : all.get()) {
+    joined.insert(joined.end(), r.body.begin(), r.body.end());
+  }
+  check(joined.size() == total && matchesBlob(joined, 0), "parallel ranges reassemble the resource");
+}
+
+static void testConnectionFailure() {
+  std::cout << "[makeRequest: transport failure yields status 0]\n";
+  auto client = HttpClientContext::Create();
+  HttpResponse response = client->makeRequest(requestFor("http://127.0.0.1:1/unreachable")).get();
+  check(response.statusCode == 0 && response.body.empty(), "refused connection reports status 0");
+}
+
+int main() {
+  LoopbackServer server;
+  if (!server.start()) {
+    std::cerr << "HttpClientTest: could not open a loopback socket\n";
+    return 1;
+  }
+  testConcurrentRequests(server);
+  testConnectionReuse(server);
+  testConcurrencyLimit(server);
+  testAsyncRequests(server);
+  testStreamingSink(server);
+  testCancelWaiting(server);
+  testOpenStream(server);
+  testBufferedFallback();
+  testBlockingFallback();
+  testByteRanges(server);
+  testConnectionFailure();
+
+  if (g_failures == 0) {
+    std::cout << "\nHttpClientTest: ALL CHECKS PASSED\n";
+    return 0;
+  }
+  std::cerr << "\nHttpClientTest: " << g_failures << " CHECK(S) FAILED\n";
+  return 1;
+}
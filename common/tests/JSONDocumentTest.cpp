@@ -0,0 +1,146 @@
+// JSONDocumentTest — verification for the in-situ, flat-array JSONDocument and
+// its JSONValue view. Covers scalar and container reads through the view,
+// escaped strings decoded in place, document-order member access, find/at/
+// contains over Map nodes, toJSON() materialization matching JSON::TryParse,
+// parse errors, moving a document (short-string buffers included), and the
+// SAX-built JSON::TryParse keeping first-wins duplicate keys.
+
+#include "omega-common/json.h"
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+
+using OmegaCommon::JSON;
+using OmegaCommon::JSONDocument;
+using OmegaCommon::JSONValue;
+using OmegaCommon::String;
+
+static int g_failures = 0;
+
+static void check(bool cond, const char *what) {
+  if (cond) {
+    std::cout << "  ok: " << what << "\n";
+  } else {
+    std::cerr << "  FAIL: " << what << "\n";
+    ++g_failures;
+  }
+}
+
+static const char *kManifest =
+    R"({"name":"omega","version":3,"scale":0.5,"enabled":true,"parent":null,)"
+    R"("tags":["core","gfx"],"path":"a\\b\n\"c\"",)"
+    R"("assets":[{"id":1,"file":"x.png"},{"id":2,"file":"y.png"}],"big":18446744073709551615})";
+
+static void testReads() {
+  std::cout << "[view: scalars and containers read through JSONValue]\n";
+  auto result = JSONDocument::parse(String(kManifest));
+  check(result.isOk(), "manifest parses");
+  if (!result.isOk()) {
+    return;
+  }
+  const JSONDocument &doc = result.value();
+  JSONValue root = doc.root();
+  check(root.valid() && root.isMap(), "root is a Map");
+  check(root.size() == 9, "root has 9 members");
+  check(root["name"].asString() == "omega", "string member");
+  check(root["version"].isInt() && root["version"].asInt() == 3, "integer member");
+  check(root["scale"].isReal() && root["scale"].asDouble() == 0.5, "real member");
+  check(root["enabled"].isBool() && root["enabled"].asBool(), "bool member");
+  check(root["parent"].isNull(), "null member");
+  check(root["path"].asString() == "a\\b\n\"c\"", "escapes decoded in place");
+  check(root["big"].isReal(), "uint64 above long long range reads as real");
+
+  JSONValue tags = root["tags"];
+  check(tags.isArray() && tags.size() == 2, "array member has 2 elements");
+  check(tags[0].asString() == "core" && tags[1].asString() == "gfx",
+        "array elements in order");
+
+  JSONValue assets = root.at("assets");
+  check(assets[1]["file"].asString() == "y.png", "nested Map inside Array");
+  check(root.keyAt(0) == "name" && root.valueAt(1).asInt() == 3,
+        "keyAt/valueAt follow document order");
+  check(!root.find("missing").valid() && !root.contains("missing"),
+        "find/contains on an absent key");
+  check(root.contains("assets"), "contains on a present key");
+}
+
+static void testToJSON() {
+  std::cout << "[toJSON: materialized tree matches JSON::TryParse]\n";
+  auto doc = JSONDocument::parse(String(kManifest));
+  auto tree = JSON::TryParse(kManifest);
+  check(doc.isOk() && tree.isOk(), "both parsers accept the manifest");
+  if (!doc.isOk() || !tree.isOk()) {
+    return;
+  }
+  JSON copy = doc.value().root().toJSON();
+  check(JSON::serialize(copy, false) == JSON::serialize(tree.value(), false),
+        "serialized forms are identical");
+  JSON assets = doc.value().root()["assets"].toJSON();
+  check(assets.isArray() && assets.size() == 2, "subtree materializes alone");
+}
+
+static void testErrorsAndScalars() {
+  std::cout << "[parse: errors, scalar roots, streams]\n";
+  auto bad = JSONDocument::parse(String(R"({"a":1,)"));
+  check(bad.isErr(), "malformed input is an error");
+  check(bad.isErr() && bad.error().find("offset") != String::npos,
+        "error names the byte offset");
+  check(JSONDocument::parse(String("")).isErr(), "empty input is an error");
+
+  auto scalar = JSONDocument::parse(String("42"));
+  check(scalar.isOk() && scalar.value().root().asInt() == 42, "scalar root");
+  check(scalar.isOk() && scalar.value().nodeCount() == 1, "scalar root is one node");
+
+  std::istringstream in(R"([[],{},[1,[2,[3]]]])");
+  auto nested = JSONDocument::parse(in);
+  check(nested.isOk(), "stream input parses");
+  if (nested.isOk()) {
+    JSONValue root = nested.value().root();
+    check(root[0].empty() && root[1].empty(), "empty containers");
+    check(root[2][1][1][0].asInt() == 3, "deep nesting keeps child ranges");
+  }
+
+  check(!JSONDocument().root().valid(), "default document has no root");
+}
+
+static void testMove() {
+  std::cout << "[move: views stay correct after the document moves]\n";
+  // Short enough to sit in the String's inline buffer, so moving the
+  // document moves the bytes too.
+  auto result = JSONDocument::parse(String(R"({"k":"v"})"));
+  check(result.isOk(), "short document parses");
+  if (!result.isOk()) {
+    return;
+  }
+  JSONDocument moved = std::move(result.value());
+  check(moved.root()["k"].asString() == "v", "string view after move");
+}
+
+static void testDuplicateKeys() {
+  std::cout << "[duplicates: first member wins in both forms]\n";
+  const char *text = R"({"a":1,"a":2})";
+  auto tree = JSON::TryParse(text);
+  check(tree.isOk() && tree.value()["a"].asInt() == 1, "JSON keeps the first");
+  auto doc = JSONDocument::parse(String(text));
+  check(doc.isOk() && doc.value().root()["a"].asInt() == 1,
+        "JSONDocument finds the first");
+  check(doc.isOk() && doc.value().root().size() == 2,
+        "JSONDocument keeps both members");
+}
+
+int main() {
+  testReads();
+  testToJSON();
+  testErrorsAndScalars();
+  testMove();
+  testDuplicateKeys();
+
+  if (g_failures == 0) {
+    std::cout << "\nJSONDocumentTest: ALL CHECKS PASSED\n";
+    return 0;
+  }
+  std::cerr << "\nJSONDocumentTest: " << g_failures << " CHECK(S) FAILED\n";
+  return 1;
+}
@@ -0,0 +1,315 @@
+// JSONStreamTest — verification for the streaming JSON surfaces: the JSONReader
+// pull parser (event order, depth tracking, readValue/skipValue, errors), push
+// parsing into a JSONEventHandler (including a handler aborting the parse),
+// JSONWriter output (compact form matches JSON::serialize, documents larger
+// than its buffer), and JSONConvertible types read straight off the reader.
+
+#include "omega-common/json.h"
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using OmegaCommon::JSON;
+using OmegaCommon::JSONReader;
+using OmegaCommon::JSONWriter;
+using OmegaCommon::Result;
+using OmegaCommon::StrRef;
+using OmegaCommon::String;
+
+static int g_failures = 0;
+
+static void check(bool cond, const char *what) {
+  if (cond) {
+    std::cout << "  ok: " << what << "\n";
+  } else {
+    std::cerr << "  FAIL: " << what << "\n";
+    ++g_failures;
+  }
+}
+
+static void testPullEvents() {
+  std::cout << "[JSONReader: one event per next(), depth follows nesting]\n";
+  String text = R"({"a":[1,2.5,"s"],"b":{"c":true},"d":null})";
+  JSONReader reader{StrRef(text)};
+  check(reader.current() == JSONReader::None, "no event before next()");
+
+  std::vector<JSONReader::Event> events;
+  std::vector<size_t> depths;
+  while (true) {
+    auto event = reader.next();
+    if (event == JSONReader::End || event == JSONReader::Error) {
+      break;
+    }
+    events.push_back(event);
+    depths.push_back(reader.depth());
+  }
+  using E = JSONReader;
+  std::vector<JSONReader::Event> expected = {
+      E::StartObject, E::Key,       E::StartArray, E::Int,  E::Real,
+      E::String,      E::EndArray,  E::Key,        E::StartObject,
+      E::Key,         E::Bool,      E::EndObject,  E::Key,  E::Null,
+      E::EndObject};
+  check(events == expected, "event sequence matches the document");
+  std::vector<size_t> expectedDepths = {0, 1, 1, 2, 2, 2, 1, 1, 1, 2, 2, 1, 1, 1, 0};
+  check(depths == expectedDepths, "depth counts enclosing containers");
+  check(reader.current() == JSONReader::End, "reader ends at End");
+  check(reader.next() == JSONReader::End, "End is sticky");
+}
+
+static void testReadAndSkip() {
+  std::cout << "[JSONReader: readValue/skipValue consume one value]\n";
+  std::istringstream in(
+      R"({"skip":{"deep":[1,[2,3],{"x":4}]},"keep":{"name":"omega","n":7},"after":5})");
+  JSONReader reader(in);
+  check(reader.next() == JSONReader::StartObject, "stream reader starts an object");
+
+  check(reader.next() == JSONReader::Key && reader.string() == "skip", "first key");
+  reader.next();
+  check(reader.skipValue(), "skipValue succeeds");
+  check(reader.current() == JSONReader::EndObject && reader.depth() == 1,
+        "skipValue stops on the value's last event");
+
+  check(reader.next() == JSONReader::Key && reader.string() == "keep", "second key");
+  reader.next();
+  auto keep = reader.readValue();
+  check(keep.isOk() && keep.value().isMap(), "readValue builds a Map");
+  check(keep.isOk() && keep.value()["name"].asString() == "omega" &&
+            keep.value()["n"].asInt() == 7,
+        "materialized members are intact");
+
+  check(reader.next() == JSONReader::Key && reader.string() == "after", "third key");
+  reader.next();
+  auto scalar = reader.readValue();
+  check(scalar.isOk() && scalar.value().asInt() == 5, "readValue on a scalar");
+  check(reader.next() == JSONReader::EndObject && reader.count() == 3,
+        "EndObject reports the member count");
+
+  JSONReader onKey{StrRef(R"({"k":1})")};
+  onKey.next();
+  onKey.next();
+  check(onKey.readValue().isErr(), "readValue on a Key is an error");
+}
+
+static void testErrors() {
+  std::cout << "[JSONReader: malformed input]\n";
+  JSONReader reader{StrRef(R"([1,2,)")};
+  JSONReader::Event event;
+  do {
+    event = reader.next();
+  } while (event != JSONReader::End && event != JSONReader::Error);
+  check(event == JSONReader::Error, "truncated array ends in Error");
+  check(reader.error().find("offset") != String::npos, "error names the offset");
+  check(reader.next() == JSONReader::Error, "Error is sticky");
+
+  JSONReader truncated{StrRef(R"({"a":[1,2)")};
+  truncated.next();
+  truncated.next();
+  truncated.next();
+  auto value = truncated.readValue();
+  check(value.isErr(), "readValue over truncated input is an error");
+}
+
+struct Counter : OmegaCommon::JSONEventHandler {
+  int scalars = 0;
+  int keys = 0;
+  size_t maxDepth = 0;
+  size_t depth = 0;
+  int stopAfter = -1;
+
+  bool scalar() {
+    ++scalars;
+    return stopAfter < 0 || scalars < stopAfter;
+  }
+  bool onNull() override { return scalar(); }
+  bool onBool(bool) override { return scalar(); }
+  bool onInt(long long) override { return scalar(); }
+  bool onReal(double) override { return scalar(); }
+  bool onString(StrRef) override { return scalar(); }
+  bool onKey(StrRef) override {
+    ++keys;
+    return true;
+  }
+  bool onStartObject() override {
+    maxDepth = std::max(maxDepth, ++depth);
+    return true;
+  }
+  bool onEndObject(size_t) override {
+    --depth;
+    return true;
+  }
+  bool onStartArray() override {
+    maxDepth = std::max(maxDepth, ++depth);
+    return true;
+  }
+  bool onEndArray(size_t) override {
+    --depth;
+    return true;
+  }
+};
+
+static void testPushParse() {
+  std::cout << "[JSONReader::parse: events into a handler]\n";
+  const char *text = R"({"a":[1,2,{"b":"c"}],"d":false})";
+  Counter counter;
+  auto result = JSONReader::parse(StrRef(text), counter);
+  check(result.isOk(), "push parse succeeds");
+  check(counter.scalars == 4 && counter.keys == 3, "every scalar and key seen");
+  check(counter.maxDepth == 3 && counter.depth == 0, "containers balanced");
+
+  Counter stopper;
+  stopper.stopAfter = 2;
+  check(JSONReader::parse(StrRef(text), stopper).isErr(),
+        "returning false aborts with an error");
+  check(stopper.scalars == 2, "no events after the abort");
+
+  std::istringstream in("[1,");
+  Counter streamed;
+  check(JSONReader::parse(in, streamed).isErr(), "stream push parse reports errors");
+}
+
+static void testWriter() {
+  std::cout << "[JSONWriter: incremental output]\n";
+  std::ostringstream out;
+  {
+    JSONWriter writer(out);
+    writer.startObject();
+    writer.key("name");
+    writer.value("omega");
+    writer.key("count");
+    writer.value(3);
+    writer.key("flags");
+    writer.startArray();
+    writer.value(true);
+    writer.value(nullptr);
+    writer.endArray();
+    writer.key("tree");
+    writer.value(JSON::parse(String(R"({"x":1})")));
+    writer.endObject();
+    check(writer.complete(), "complete after the top-level value closes");
+  }
+  JSON expected = JSON::parse(
+      String(R"({"name":"omega","count":3,"flags":[true,null],"tree":{"x":1}})"));
+  JSON written = JSON::parse(out.str());
+  check(JSON::serialize(written, false) == JSON::serialize(expected, false),
+        "written document parses back to the same tree");
+  check(out.str().find('\n') == String::npos, "compact by default");
+
+  std::ostringstream big;
+  JSONWriter writer(big);
+  writer.startArray();
+  for (int i = 0; i < 5000; ++i) {
+    writer.value(String("entry-") + std::to_string(i));
+  }
+  writer.endArray();
+  writer.flush();
+  JSON parsed = JSON::parse(big.str());
+  check(big.str().size() > 4096, "document larger than the writer buffer");
+  check(parsed.isArray() && parsed.size() == 5000 &&
+            parsed.asVector()[4999].asString() == "entry-4999",
+        "all buffered output reaches the stream");
+}
+
+// Reads its fields straight from the event stream.
+struct Frame : IJSONConvertible {
+  int index = 0;
+  double time = 0.0;
+
+  void toJSON(JSON &j) override {
+    j = JSON::Object();
+    j["index"] = JSON(index);
+    j["time"] = JSON(time);
+  }
+
+  void fromJSON(JSON &j) override {
+    index = static_cast<int>(j["index"].asInt());
+    time = j["time"].asDouble();
+  }
+
+  Result<void *, String> fromJSONReader(JSONReader &reader) override {
+    while (reader.next() == JSONReader::Key) {
+      String key = reader.string();
+      reader.next();
+      if (key == "index") {
+        index = static_cast<int>(reader.asInt());
+      } else if (key == "time") {
+        time = reader.asDouble();
+      } else if (!reader.skipValue()) {
+        break;
+      }
+    }
+    if (reader.current() == JSONReader::Error) {
+      return Result<void *, String>::err(reader.error());
+    }
+    return Result<void *, String>::ok(nullptr);
+  }
+};
+
+// Relies on the default fromJSONReader (materialize, then fromJSON).
+struct Tag : IJSONConvertible {
+  String name;
+
+  void toJSON(JSON &j) override { j = JSON(name); }
+
+  void fromJSON(JSON &j) override { name = j.asString(); }
+};
+
+static void testConvertible() {
+  std::cout << "[JSONConvertible: deserialize from the event stream]\n";
+  String text =
+      R"({"frames":[{"index":0,"time":0.0},{"index":1,"extra":[1,2],"time":0.5}],"tag":"walk"})";
+  JSONReader reader{StrRef(text)};
+  std::vector<Frame> frames;
+  Tag tag;
+  reader.next();
+  while (reader.next() == JSONReader::Key) {
+    String key = reader.string();
+    reader.next();
+    if (key == "frames") {
+      while (reader.next() == JSONReader::StartObject) {
+        Frame frame;
+        check(reader.into(frame).isOk(), "frame deserialized");
+        frames.push_back(frame);
+      }
+    } else if (key == "tag") {
+      check(reader.into(tag).isOk(), "tag deserialized");
+    }
+  }
+  check(reader.current() == JSONReader::EndObject, "walked the whole document");
+  check(frames.size() == 2, "two frames read");
+  check(frames.size() == 2 && frames[1].index == 1 && frames[1].time == 0.5,
+        "overridden fromJSONReader skips unknown members");
+  check(tag.name == "walk", "default fromJSONReader goes through fromJSON");
+
+  JSONReader truncated{StrRef(R"({"tag":["walk",)")};
+  truncated.next();
+  truncated.next();
+  truncated.next();
+  Tag partial;
+  auto tagResult = truncated.into(partial);
+  check(tagResult.isErr() && tagResult.error() == truncated.error(),
+        "default fromJSONReader reports the reader's error");
+
+  JSONReader brokenFrame{StrRef(R"({"index":1,"extra":[1,)")};
+  brokenFrame.next();
+  Frame frame;
+  check(brokenFrame.into(frame).isErr(),
+        "overridden fromJSONReader reports malformed input");
+}
+
+int main() {
+  testPullEvents();
+  testReadAndSkip();
+  testErrors();
+  testPushParse();
+  testWriter();
+  testConvertible();
+
+  if (g_failures == 0) {
+    std::cout << "\nJSONStreamTest: ALL CHECKS PASSED\n";
+    return 0;
+  }
+  std::cerr << "\nJSONStreamTest: " << g_failures << " CHECK(S) FAILED\n";
+  return 1;
+}
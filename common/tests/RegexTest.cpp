@@ -0,0 +1,192 @@
+// RegexTest — verification for the JIT-compiled, shareable Regex. Covers
+// agreement between JIT and interpreted matching, scanAll() early stop and
+// capture views, empty-match stepping (one code point in UTF mode), regex use
+// nested inside a scanAll() callback (pooled match data must not be shared),
+// whole-input matches(), replace/split, and one Regex used from many threads.
+
+#include "omega-common/regex.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using OmegaCommon::Regex;
+using OmegaCommon::RegexMatchView;
+using OmegaCommon::RegexOption;
+
+static int g_failures = 0;
+
+static void check(bool cond, const char *what) {
+  if (cond) {
+    std::cout << "  ok: " << what << "\n";
+  } else {
+    std::cerr << "  FAIL: " << what << "\n";
+    ++g_failures;
+  }
+}
+
+static std::string str(OmegaCommon::StrRef ref) {
+  return std::string(ref.data(), ref.size());
+}
+
+static Regex compileOrDie(const char *pattern, unsigned options = 0) {
+  auto result = Regex::compile(pattern, options);
+  if (!result.isOk()) {
+    std::cerr << "  FAIL: compile " << pattern << ": " << result.error().message << "\n";
+    std::exit(1);
+  }
+  return std::move(result.value());
+}
+
+static void testJitAgreement() {
+  std::cout << "[JIT and interpreter return the same matches]\n";
+  Regex jit = compileOrDie(R"((\w+)@(\w+)\.com)");
+  Regex interp = compileOrDie(R"((\w+)@(\w+)\.com)", static_cast<unsigned>(RegexOption::NoJit));
+  check(!interp.isJitCompiled(), "NoJit keeps the interpreter");
+
+  const std::string text = "mail ann@example.com, bob@test.com and nobody@nowhere.org";
+  auto a = jit.findAll(text);
+  auto b = interp.findAll(text);
+  bool same = a.size() == b.size() && a.size() == 2;
+  for (size_t i = 0; same && i < a.size(); ++i) {
+    same = a[i].fullMatch.start == b[i].fullMatch.start &&
+           a[i].fullMatch.end == b[i].fullMatch.end &&
+           str(a[i].group(0).matched) == str(b[i].group(0).matched) &&
+           str(a[i].group(1).matched) == str(b[i].group(1).matched);
+  }
+  check(same, "two matches with identical spans and captures");
+  check(a.size() == 2 && str(a[1].group(1).matched) == "test", "second domain capture is 'test'");
+}
+
+static void testScanAll() {
+  std::cout << "[scanAll: views, early stop, match count]\n";
+  Regex digits = compileOrDie(R"((\d)(\d)?)");
+  const std::string text = "a1 b23 c4 d56 e7";
+
+  std::vector<std::string> seen;
+  size_t count = digits.scanAll(text, [&](const RegexMatchView &m) {
+    seen.push_back(str(m.fullMatch().matched));
+    return true;
+  });
+  check(count == 5 && seen.size() == 5, "visits all five matches");
+  check(seen.size() == 5 && seen[1] == "23" && seen[4] == "7", "full-match text is correct");
+
+  size_t stopped = digits.scanAll(text, [&](const RegexMatchView &) { return false; });
+  check(stopped == 1, "returning false stops after the first match");
+
+  bool unsetEmpty = false;
+  bool countsGroups = false;
+  digits.scanAll("9", [&](const RegexMatchView &m) {
+    countsGroups = m.captureCount() == 2;
+    unsetEmpty = m.group(1).matched.size() == 0 && m.group(1).start == 0;
+    auto kept = m.toMatch();
+    countsGroups = countsGroups && kept.captures.size() == 2 && str(kept.group(0).matched) == "9";
+    return true;
+  });
+  check(countsGroups, "view reports every capture group");
+  check(unsetEmpty, "non-participating group is empty");
+}
+
+static void testEmptyMatches() {
+  std::cout << "[empty matches advance by one character]\n";
+  Regex lookahead = compileOrDie("(?=b)");
+  check(lookahead.findAll("abab").size() == 2, "zero-width match is reported once per position");
+
+  Regex empty = compileOrDie("x*", static_cast<unsigned>(RegexOption::Utf));
+  // "é" is two bytes; stepping by code point gives one empty match per
+  // character plus one at the end, and never splits the sequence.
+  bool splitSequence = false;
+  size_t count = empty.scanAll("a\xC3\xA9" "b", [&](const RegexMatchView &m) {
+    splitSequence = splitSequence || m.fullMatch().start == 2;
+    return true;
+  });
+  check(count == 4 && !splitSequence, "UTF mode steps over multi-byte characters");
+}
+
+static void testNestedUse() {
+  std::cout << "[regex use inside a scanAll callback]\n";
+  Regex words = compileOrDie(R"(\w+)");
+  Regex vowels = compileOrDie("[aeiou]");
+  size_t outerStart = 0;
+  bool spansIntact = true;
+  int vowelTotal = 0;
+  words.scanAll("banana split sundae", [&](const RegexMatchView &m) {
+    auto word = m.fullMatch();
+    vowelTotal += static_cast<int>(vowels.findAll(word.matched).size());
+    // The outer view must still describe the same match after the inner
+    // search has run on this thread.
+    spansIntact = spansIntact && m.fullMatch().start == word.start && word.start >= outerStart;
+    outerStart = word.end;
+    return true;
+  });
+  check(vowelTotal == 7, "inner searches see their own results");
+  check(spansIntact, "outer match survives nested searches");
+}
+
+static void testMatchesAndEdits() {
+  std::cout << "[matches, replace, split]\n";
+  Regex alt = compileOrDie("a|ab");
+  check(alt.matches("ab"), "matches() tries alternatives against the whole input");
+  check(!alt.matches("abc"), "matches() rejects a prefix match");
+  check(compileOrDie(R"(\d+)").matches("2024"), "digits match whole string");
+
+  auto replaced = compileOrDie(R"((\w+)=(\w+))").replace("a=1, b=2", "$2:$1");
+  check(replaced.isOk() && replaced.value() == "1:a, 2:b", "replace swaps captures");
+
+  std::string longInput(1000, 'x');
+  auto grown = compileOrDie("x").replace(longInput, "yy");
+  check(grown.isOk() && grown.value().size() == 2000, "replace grows past the first buffer guess");
+
+  auto parts = compileOrDie(R"(\s*,\s*)").split("a , b,c");
+  check(parts.size() == 3 && parts[0] == "a" && parts[2] == "c", "split on separator");
+}
+
+static void testConcurrentUse() {
+  std::cout << "[one Regex shared by several threads]\n";
+  Regex pair = compileOrDie(R"((\w)(\d))");
+  std::string text;
+  for (int i = 0; i < 200; ++i) {
+    text += "k" + std::to_string(i % 10) + " ";
+  }
+
+  std::atomic<int> wrong{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&]() {
+      for (int iter = 0; iter < 50; ++iter) {
+        size_t count = pair.scanAll(text, [&](const RegexMatchView &m) {
+          if (str(m.group(0).matched) != "k") {
+            wrong.fetch_add(1);
+          }
+          return true;
+        });
+        if (count != 200 || !pair.matches("k7")) {
+          wrong.fetch_add(1);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  check(wrong.load() == 0, "every thread sees every match");
+}
+
+int main() {
+  testJitAgreement();
+  testScanAll();
+  testEmptyMatches();
+  testNestedUse();
+  testMatchesAndEdits();
+  testConcurrentUse();
+
+  if (g_failures == 0) {
+    std::cout << "\nRegexTest: ALL CHECKS PASSED\n";
+    return 0;
+  }
+  std::cerr << "\nRegexTest: " << g_failures << " CHECK(S) FAILED\n";
+  return 1;
+}
@@ -0,0 +1,215 @@
+// TaskSchedulerTest — verification for the work-stealing TaskScheduler that
+// replaces WorkerFarm's thread-per-job model. Covers task submission from
+// outside the pool, nested TaskGroups (waiters must help run work instead of
+// deadlocking), parallelFor coverage, parallelReduce's deterministic fold
+// order, Async continuations, the lock-free Promise state (first set wins,
+// continuation order, cross-thread wake-up), whenAll/whenAny, and WorkerFarm
+// on top of the pool.
+
+#include "omega-common/multithread.h"
+
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+using OmegaCommon::TaskGroup;
+using OmegaCommon::TaskScheduler;
+
+static int g_failures = 0;
+
+static void check(bool cond, const char *what) {
+  if (cond) {
+    std::cout << "  ok: " << what << "\n";
+  } else {
+    std::cerr << "  FAIL: " << what << "\n";
+    ++g_failures;
+  }
+}
+
+static void testTaskGroup() {
+  std::cout << "[TaskGroup: every task runs before wait() returns]\n";
+  TaskScheduler scheduler(4);
+  std::atomic<int> counter{0};
+  {
+    TaskGroup group(scheduler);
+    for (int i = 0; i < 1000; ++i) {
+      group.run([&counter]() { counter.fetch_add(1); });
+    }
+    group.wait();
+    check(counter.load() == 1000, "1000 tasks ran");
+  }
+  check(scheduler.workerCount() == 4, "worker count is fixed at construction");
+}
+
+static void testNestedGroups() {
+  std::cout << "[TaskGroup: nested groups on a single worker do not deadlock]\n";
+  TaskScheduler scheduler(1);
+  std::atomic<int> counter{0};
+  TaskGroup outer(scheduler);
+  for (int i = 0; i < 8; ++i) {
+    outer.run([&scheduler, &counter]() {
+      TaskGroup inner(scheduler);
+      for (int j = 0; j < 8; ++j) {
+        inner.run([&counter]() { counter.fetch_add(1); });
+      }
+      inner.wait();
+    });
+  }
+  outer.wait();
+  check(counter.load() == 64, "all 64 nested tasks ran");
+}
+
+static void testParallelFor() {
+  std::cout << "[parallelFor: visits every index exactly once]\n";
+  TaskScheduler scheduler(4);
+  std::vector<int> hits(10007, 0);
+  OmegaCommon::parallelFor<size_t>(0, hits.size(), 64,
+                                   [&hits](size_t i) { hits[i] += 1; }, scheduler);
+  bool allOnce = true;
+  for (int h : hits) {
+    allOnce = allOnce && h == 1;
+  }
+  check(allOnce, "each of 10007 indices visited once");
+
+  int serialCalls = 0;
+  OmegaCommon::parallelFor<int>(0, 10, 64, [&serialCalls](int) { ++serialCalls; },
+                                scheduler);
+  check(serialCalls == 10, "range below grain runs inline");
+}
+
+static void testParallelReduce() {
+  std::cout << "[parallelReduce: matches serial result, fixed fold order]\n";
+  TaskScheduler scheduler(4);
+  std::vector<double> values(50000);
+  for (size_t i = 0; i < values.size(); ++i) {
+    values[i] = 1.0 / static_cast<double>(i + 1);
+  }
+  auto sumRange = [&values](size_t b, size_t e, double init) {
+    for (size_t i = b; i < e; ++i) {
+      init += values[i];
+    }
+    return init;
+  };
+  auto add = [](double a, double b) { return a + b; };
+  double first = OmegaCommon::parallelReduce<size_t>(0, values.size(), 512, 0.0,
+                                                     sumRange, add, scheduler);
+  double serial = std::accumulate(values.begin(), values.end(), 0.0);
+  check(std::abs(first - serial) < 1e-9, "parallel sum matches serial sum");
+
+  bool stable = true;
+  for (int run = 0; run < 10; ++run) {
+    double again = OmegaCommon::parallelReduce<size_t>(0, values.size(), 512, 0.0,
+                                                       sumRange, add, scheduler);
+    stable = stable && again == first;
+  }
+  check(stable, "repeated reductions are bit-identical");
+}
+
+static void testAsyncContinuations() {
+  std::cout << "[Async: scheduler.async + then() chaining]\n";
+  TaskScheduler scheduler(2);
+  auto base = scheduler.async([]() { return 20; });
+  auto chained = base.then(scheduler, [](int &v) { return v + 1; })
+                     .then(scheduler, [](int &v) { return v * 2; });
+  check(chained.get() == 42, "two continuations chained onto async()");
+
+  OmegaCommon::Promise<int> promise;
+  auto pending = promise.async();
+  auto afterSet = pending.then(scheduler, [](int &v) { return v + 5; });
+  check(!afterSet.ready(), "continuation waits for the promise");
+  promise.set(10);
+  check(afterSet.get() == 15, "continuation runs once the promise is set");
+
+  auto token = std::make_shared<int>(0);
+  {
+    OmegaCommon::Promise<int> abandoned;
+    auto never = abandoned.async().then(scheduler, [token](int &v) { return v; });
+    check(token.use_count() == 2, "then() holds its task while the source is pending");
+  }
+  check(token.use_count() == 1, "an abandoned source releases its continuation");
+}
+
+static void testPromiseState() {
+  std::cout << "[Promise: lock-free state, first set wins, ordered continuations]\n";
+  OmegaCommon::Promise<std::string> promise;
+  auto value = promise.async();
+  std::vector<int> order;
+  value.onReady([&order](std::string &) { order.push_back(1); });
+  value.onReady([&order](std::string &) { order.push_back(2); });
+  check(!value.ready() && order.empty(), "continuations wait for set()");
+  promise.set(std::string("first"));
+  promise.set(std::string("second"));
+  check(value.get() == "first", "later set() calls are ignored");
+  value.onReady([&order](std::string &) { order.push_back(3); });
+  check(order == std::vector<int>({1, 2, 3}), "continuations run in registration order");
+
+  OmegaCommon::Promise<int> crossThread;
+  auto blocked = crossThread.async();
+  std::thread setter([&crossThread]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    crossThread.set(7);
+  });
+  check(blocked.get() == 7, "get() wakes when another thread sets the value");
+  setter.join();
+}
+
+static void testWhenAllAny() {
+  std::cout << "[whenAll/whenAny: composition without blocking]\n";
+  TaskScheduler scheduler(4);
+  OmegaCommon::Vector<OmegaCommon::Async<int>> inputs;
+  for (int i = 0; i < 32; ++i) {
+    inputs.push_back(scheduler.async([i]() { return i * i; }));
+  }
+  auto all = OmegaCommon::whenAll(inputs);
+  auto &values = all.get();
+  bool inOrder = values.size() == 32;
+  for (size_t i = 0; inOrder && i < values.size(); ++i) {
+    inOrder = values[i] == static_cast<int>(i * i);
+  }
+  check(inOrder, "whenAll keeps input order");
+  check(OmegaCommon::whenAll(OmegaCommon::Vector<OmegaCommon::Async<int>>{}).ready(),
+        "whenAll of nothing is ready immediately");
+
+  OmegaCommon::Promise<int> slow;
+  OmegaCommon::Promise<int> fast;
+  auto any = OmegaCommon::whenAny<int>({slow.async(), fast.async()});
+  check(!any.ready(), "whenAny waits for the first input");
+  fast.set(9);
+  check(any.get().first == 1 && any.get().second == 9, "whenAny reports the first ready input");
+  slow.set(1);
+  check(any.get().first == 1, "later inputs do not overwrite the winner");
+}
+
+static void testWorkerFarm() {
+  std::cout << "[WorkerFarm: jobs run on the pool]\n";
+  std::atomic<int> sum{0};
+  {
+    OmegaCommon::WorkerFarm farm;
+    for (int i = 1; i <= 100; ++i) {
+      farm.scheduleJob([&sum](int v) { sum.fetch_add(v); }, i);
+    }
+  }
+  check(sum.load() == 5050, "destructor waited for every job");
+}
+
+int main() {
+  testTaskGroup();
+  testNestedGroups();
+  testParallelFor();
+  testParallelReduce();
+  testAsyncContinuations();
+  testPromiseState();
+  testWhenAllAny();
+  testWorkerFarm();
+
+  if (g_failures == 0) {
+    std::cout << "\nTaskSchedulerTest: ALL CHECKS PASSED\n";
+    return 0;
+  }
+  std::cerr << "\nTaskSchedulerTest: " << g_failures << " CHECK(S) FAILED\n";
+  return 1;
+}
@@ -0,0 +1,162 @@
+// TextBufferTest — verification for the shared, cached text analysis in
+// unicode.h. Covers paragraph splitting on mandatory breaks (LF, CRLF,
+// U+2029), agreement of cached line breaks and BiDi runs with the per-call
+// BreakIterator / BidiParagraph wrappers, the UTF-8 path reporting byte
+// offsets (including RTL paragraphs mapped back from UTF-16), the
+// TextAnalysisCache hit / LRU eviction contract, and concurrent first
+// queries against one buffer.
+
+#include "omega-common/unicode.h"
+
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using OmegaCommon::BidiParagraph;
+using OmegaCommon::BreakIterator;
+using OmegaCommon::TextAnalysisCache;
+using OmegaCommon::TextBuffer;
+using OmegaCommon::UniString;
+
+static int g_failures = 0;
+
+static void check(bool cond, const char *what) {
+  if (cond) {
+    std::cout << "  ok: " << what << "\n";
+  } else {
+    std::cerr << "  FAIL: " << what << "\n";
+    ++g_failures;
+  }
+}
+
+static void testParagraphs() {
+  std::cout << "[paragraphs split on mandatory breaks]\n";
+  auto buffer = TextBuffer::fromUTF16(UniString::fromUTF8("one\r\ntwo\n\nthree\xE2\x80\xA9" "four"));
+  const auto &paras = buffer.paragraphs();
+  check(paras.size() == 5, "five paragraphs");
+  if (paras.size() != 5) return;
+  check(paras[0].start == 0 && paras[0].end == 3 && paras[0].next == 5, "CRLF is trimmed from the first");
+  check(paras[1].start == 5 && paras[1].end == 8, "second paragraph text is 'two'");
+  check(paras[2].end == paras[2].start && paras[2].runs.empty(), "blank line has no runs");
+  check(paras[3].end - paras[3].start == 5, "U+2029 is trimmed");
+  check(paras[4].next == buffer.length(), "last paragraph runs to the end");
+  check(paras[0].runs.size() == 1 && !paras[0].runs[0].rightToLeft, "Latin paragraph is one LTR run");
+}
+
+static void testMatchesIterators() {
+  std::cout << "[cached analysis agrees with BreakIterator / BidiParagraph]\n";
+  auto text = UniString::fromUTF8("The quick brown fox jumps over the lazy dog");
+  auto buffer = TextBuffer::fromUTF16(text);
+
+  std::vector<std::int32_t> expected;
+  BreakIterator it(BreakIterator::Type::Line, text);
+  (void)it.first();
+  std::int32_t pos;
+  while ((pos = it.next()) != BreakIterator::DONE) {
+    expected.push_back(pos);
+  }
+  const auto &lines = buffer.lineBoundaries();
+  bool same = lines.size() == expected.size();
+  for (std::size_t i = 0; same && i < lines.size(); ++i) {
+    same = lines[i].offset == expected[i] && !lines[i].mandatory;
+  }
+  check(same, "line break opportunities match");
+  check(!buffer.wordBoundaries().empty() && buffer.wordBoundaries().back() == text.length(),
+        "word boundaries end at the text length");
+
+  // "abc " + Hebrew alef-bet-gimel + " def": three visual runs.
+  auto mixed = UniString::fromUTF8("abc \xD7\x90\xD7\x91\xD7\x92 def");
+  BidiParagraph bidi(mixed);
+  auto mixedBuffer = TextBuffer::fromUTF16(mixed);
+  const auto &paras = mixedBuffer.paragraphs();
+  bool runsMatch = paras.size() == 1 && static_cast<std::int32_t>(paras[0].runs.size()) == bidi.runCount();
+  for (std::int32_t r = 0; runsMatch && r < bidi.runCount(); ++r) {
+    auto a = paras[0].runs[static_cast<std::size_t>(r)];
+    auto b = bidi.getVisualRun(r);
+    runsMatch = a.logicalStart == b.logicalStart && a.length == b.length && a.rightToLeft == b.rightToLeft;
+  }
+  check(runsMatch && bidi.runCount() == 3, "mixed-direction runs match BidiParagraph");
+}
+
+static void testUtf8() {
+  std::cout << "[UTF-8 buffers report byte offsets]\n";
+  const std::string utf8 = "h\xC3\xA9llo w\xC3\xB6rld\nabc \xD7\x90\xD7\x91 x";
+  auto buffer = TextBuffer::fromUTF8(utf8);
+  check(buffer.encoding() == TextBuffer::Encoding::UTF8, "keeps UTF-8 encoding");
+  check(buffer.utf16Data() == nullptr && buffer.length() == static_cast<std::int32_t>(utf8.size()),
+        "length is in bytes; no UTF-16 copy exposed");
+
+  const auto &lines = buffer.lineBoundaries();
+  check(lines.size() >= 2 && lines[0].offset == 7 && !lines[0].mandatory, "soft break after 'h\xC3\xA9llo ' is byte 7");
+  check(lines.size() >= 2 && lines[1].offset == 14 && lines[1].mandatory, "newline break at byte 14");
+
+  const auto &paras = buffer.paragraphs();
+  check(paras.size() == 2 && paras[0].end == 13, "first paragraph ends before the newline byte");
+  if (paras.size() == 2) {
+    const auto &runs = paras[1].runs;
+    // "abc " (4 bytes) | alef bet (4 bytes) | " x" (2 bytes)
+    check(runs.size() == 3, "second paragraph has three runs");
+    check(runs.size() == 3 && runs[1].rightToLeft && runs[1].logicalStart == 4 && runs[1].length == 4,
+          "RTL run is mapped back to bytes");
+  }
+}
+
+static void testCache() {
+  std::cout << "[TextAnalysisCache]\n";
+  TextAnalysisCache cache(2);
+  auto a = cache.lookup(UniString::fromUTF8("alpha"));
+  auto again = cache.lookup(UniString::fromUTF8("alpha"));
+  check(std::addressof(a.paragraphs()) == std::addressof(again.paragraphs()), "equal text shares one analysis");
+  check(cache.lookup(OmegaCommon::StrRef("alpha")).encoding() == TextBuffer::Encoding::UTF8,
+        "UTF-8 lookups are a separate entry");
+  check(cache.size() == 2, "two entries held");
+
+  (void)cache.lookup(UniString::fromUTF8("beta"));
+  check(cache.size() == 2, "capacity bounds the cache");
+  auto reloaded = cache.lookup(UniString::fromUTF8("alpha"));
+  check(std::addressof(reloaded.paragraphs()) != std::addressof(a.paragraphs()), "least-recently-used entry was evicted");
+  check(a.paragraphs().size() == 1, "evicted buffers stay valid for existing holders");
+
+  cache.clear();
+  check(cache.size() == 0, "clear empties the cache");
+}
+
+static void testConcurrentFirstQuery() {
+  std::cout << "[concurrent first queries]\n";
+  std::string text;
+  for (int i = 0; i < 200; ++i) {
+    text += "line " + std::to_string(i) + " \xD7\x90\xD7\x91\n";
+  }
+  auto buffer = TextBuffer::fromUTF8(text);
+  std::atomic<int> wrong{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&]() {
+      const auto &paras = buffer.paragraphs();
+      if (paras.size() != 200 || paras[199].runs.size() != 2) {
+        wrong.fetch_add(1);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  check(wrong.load() == 0, "every thread sees the same analysis");
+}
+
+int main() {
+  testParagraphs();
+  testMatchesIterators();
+  testUtf8();
+  testCache();
+  testConcurrentFirstQuery();
+
+  if (g_failures == 0) {
+    std::cout << "\nTextBufferTest: ALL CHECKS PASSED\n";
+    return 0;
+  }
+  std::cerr << "\nTextBufferTest: " << g_failures << " CHECK(S) FAILED\n";
+  return 1;
+}
@@ -2,6 +2,7 @@
 #include "GEPipeline.h"
 #include "GERenderTarget.h"
 #include "GETexture.h"
+#include <omega-common/multithread.h>
 #include <vector>
 #include <cstdint>
 
@@ -298,6 +299,13 @@ _NAMESPACE_BEGIN_
         /// GPU, and returns its GPU execution time. Synchronous counterpart of
         /// the @ref commitToGPU(const GECommitCompletionHandler&) overload.
         virtual GECommitCompletionInfo commitToGPUAndWaitTimed();
+
+        /// @brief Commits the enqueued batch and returns an Async fulfilled
+        /// with its @ref GECommitCompletionInfo. Does not block.
+        /// @paragraph Lets GPU completion compose with other work (e.g. a
+        /// readback chained with Async::then, or several queues joined with
+        /// whenAll) instead of parking a thread per commit.
+        OmegaCommon::Async<GECommitCompletionInfo> commitToGPUAsync();
     protected:
         /// @brief Backend-neutral helper for the
         /// @ref commitToGPU(const GECommitCompletionHandler&) overload. Wraps
@@ -160,6 +160,12 @@ _NAMESPACE_BEGIN_
     /// `geMeshRepackToGPULayout` before upload. Never hand it to the GPU.
     OMEGAGTE_EXPORT size_t geMeshTightStrideFor(uint32_t attributes);
 
+    /// @brief Byte offset of each present attribute within one GPU-layout
+    /// vertex, in `GEMeshVertexAttribute` order — the companion to
+    /// `geMeshStrideFor` for code that writes vertices by hand (e.g.
+    /// `OmegaTriangulationEngineContext::triangulatePacked`).
+    OMEGAGTE_EXPORT OmegaCommon::Vector<size_t> geMeshMemberOffsetsFor(uint32_t attributes);
+
     /// @brief Re-lay a tightly-packed vertex stream into the GPU's buffer
     /// layout, inserting whatever padding the backend's standard requires.
     ///
@@ -203,6 +209,21 @@ _NAMESPACE_BEGIN_
         SharedHandle<GETexture> diffuseTexture = nullptr,
         unsigned diffuseSlot = 0);
 
+    /// @brief Build a GEMesh from packed triangulation output.
+    /// `packed` is already in the GPU layout and already indexed, so nothing
+    /// is converted or deduplicated: the mesh gets `packed.attributes`,
+    /// Triangle topology and a `UInt32` index buffer. The bytes still go
+    /// through a `GEBufferWriter` one field and one index at a time, since
+    /// GEBuffer has no backend-neutral block copy. To write straight into
+    /// mapped memory instead, use `triangulatePackedInto` on a mapping of
+    /// your own buffers.
+    /// @returns A populated GEMesh, or null on error.
+    OMEGAGTE_EXPORT SharedHandle<GEMesh> buildMeshFromPackedTriangulation(
+        OmegaGraphicsEngine *engine,
+        const TEPackedMesh &packed,
+        SharedHandle<GETexture> diffuseTexture = nullptr,
+        unsigned diffuseSlot = 0);
+
 _NAMESPACE_END_
 
 #endif
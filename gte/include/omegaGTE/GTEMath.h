@@ -2,6 +2,7 @@
 #define OMEGAGTE_GTEMATH_H
 
 #include "GTEBase.h"
+#include "GTEMathSIMD.h"
 #include <cmath>
 #include <array>
 
@@ -244,6 +245,10 @@ _NAMESPACE_BEGIN_
     /// `(row=j, col=i)` stored in `m[i][j]`, so quaternion-rotation
     /// matrices line up with the conventional textbook formulas without
     /// an implicit transpose.
+    ///
+    /// **Float fast paths.** For `Ty = float` the arithmetic operators run on
+    /// the kernels in GTEMathSIMD.h (SSE/NEON, scalar elsewhere). The kernels
+    /// use unaligned loads, so every matrix keeps its packed layout.
     template<class Ty,unsigned column,unsigned row>
    class Matrix {
    public:
@@ -336,6 +341,8 @@ _NAMESPACE_BEGIN_
     private:
         std::array<std::array<Ty,row>,column> _data;
 
+        static constexpr bool simd_float = std::is_same<Ty,float>::value;
+
         inline void alloc_matrix_mem(Ty * dest){
 //            dest = new row_pointer [column];
 //            column_pointer _data_it = dest;
@@ -497,6 +504,10 @@ _NAMESPACE_BEGIN_
 
        Matrix operator+(const Matrix& other) const {
            auto r = Create();
+           if constexpr(simd_float){
+               SIMD::add(data(), other.data(), r.data(), column * row);
+               return r;
+           }
            for(unsigned i = 0; i < column; i++)
                for(unsigned j = 0; j < row; j++)
                    r._data[i][j] = _data[i][j] + other._data[i][j];
@@ -504,6 +515,10 @@ _NAMESPACE_BEGIN_
        }
        Matrix operator-(const Matrix& other) const {
            auto r = Create();
+           if constexpr(simd_float){
+               SIMD::sub(data(), other.data(), r.data(), column * row);
+               return r;
+           }
            for(unsigned i = 0; i < column; i++)
                for(unsigned j = 0; j < row; j++)
                    r._data[i][j] = _data[i][j] - other._data[i][j];
@@ -518,6 +533,10 @@ _NAMESPACE_BEGIN_
        }
        Matrix operator*(Ty scalar) const {
            auto r = Create();
+           if constexpr(simd_float){
+               SIMD::scale(data(), scalar, r.data(), column * row);
+               return r;
+           }
            for(unsigned i = 0; i < column; i++)
                for(unsigned j = 0; j < row; j++)
                    r._data[i][j] = _data[i][j] * scalar;
@@ -529,6 +548,10 @@ _NAMESPACE_BEGIN_
        template<unsigned P>
        Matrix<Ty, column, P> operator*(const Matrix<Ty, row, P>& other) const {
            auto r = Matrix<Ty, column, P>::Create();
+           if constexpr(simd_float && column == 4 && row == 4 && P == 4){
+               SIMD::mul4x4(data(), other.data(), r.data());
+               return r;
+           }
            for(unsigned i = 0; i < column; i++)
                for(unsigned j = 0; j < P; j++){
                    Ty sum = 0;
@@ -540,18 +563,30 @@ _NAMESPACE_BEGIN_
        }
 
        Matrix& operator+=(const Matrix& other){
+           if constexpr(simd_float){
+               SIMD::add(data(), other.data(), data(), column * row);
+               return *this;
+           }
            for(unsigned i = 0; i < column; i++)
                for(unsigned j = 0; j < row; j++)
                    _data[i][j] += other._data[i][j];
            return *this;
        }
        Matrix& operator-=(const Matrix& other){
+           if constexpr(simd_float){
+               SIMD::sub(data(), other.data(), data(), column * row);
+               return *this;
+           }
            for(unsigned i = 0; i < column; i++)
                for(unsigned j = 0; j < row; j++)
                    _data[i][j] -= other._data[i][j];
            return *this;
        }
        Matrix& operator*=(Ty scalar){
+           if constexpr(simd_float){
+               SIMD::scale(data(), scalar, data(), column * row);
+               return *this;
+           }
            for(unsigned i = 0; i < column; i++)
                for(unsigned j = 0; j < row; j++)
                    _data[i][j] *= scalar;
@@ -922,10 +957,8 @@ _NAMESPACE_BEGIN_
     /// the divide is a no-op.
     inline GPoint3D transformPoint(const FMatrix<4,4>& m, const GPoint3D& pt){
         const float p[4] = {pt.x, pt.y, pt.z, 1.f};
-        float out[4] = {0.f, 0.f, 0.f, 0.f};
-        for(unsigned r = 0; r < 4; r++)
-            for(unsigned c = 0; c < 4; c++)
-                out[r] += m[c][r] * p[c];
+        float out[4];
+        SIMD::transform4(m.data(), p, out);
 
         const float w = out[3];
         if(w != 0.f && w != 1.f){
@@ -934,6 +967,17 @@ _NAMESPACE_BEGIN_
         return GPoint3D{out[0], out[1], out[2]};
     }
 
+    /// Batch `transformPoint`: writes `m` applied to every point of `in` into
+    /// the same position of `out` (which must be at least as long). The
+    /// results match `transformPoint` exactly; the columns of `m` are loaded
+    /// once, and on x86 CPUs with AVX two points are transformed per register.
+    OMEGAGTE_EXPORT void transformPoints(const FMatrix<4,4>& m,
+                                         OmegaCommon::Span<const GPoint3D> in,
+                                         OmegaCommon::Span<GPoint3D> out);
+
+    /// In-place `transformPoints`.
+    OMEGAGTE_EXPORT void transformPoints(const FMatrix<4,4>& m, OmegaCommon::Span<GPoint3D> points);
+
     // ==================================================================
     // Quaternion
     // ==================================================================
@@ -1009,6 +1053,11 @@ _NAMESPACE_BEGIN_
 
         /// Hamilton product. Composes rotations: (q1 * q2) applies q2 first, then q1.
         Quaternion operator*(const Quaternion& o) const {
+            if constexpr(std::is_same<Ty,float>::value){
+                Quaternion r;
+                SIMD::quatMul(&x, &o.x, &r.x);
+                return r;
+            }
             return {
                 w*o.x + x*o.w + y*o.z - z*o.y,
                 w*o.y - x*o.z + y*o.w + z*o.x,
@@ -0,0 +1,185 @@
+#ifndef OMEGAGTE_GTEMATHSIMD_H
+#define OMEGAGTE_GTEMATHSIMD_H
+
+#include "GTEBase.h"
+
+/// Vector kernels behind the float specializations in GTEMath.h.
+///
+/// x86 uses SSE (always present on x86-64), ARM uses NEON, and everything else
+/// takes the scalar loops. Define `OMEGAGTE_NO_SIMD` to force the scalar loops
+/// on any target. Each kernel performs the same multiplies and adds in the same
+/// order as its scalar loop and never fuses them, so both paths agree. All
+/// loads and stores are unaligned, so the matrices keep their packed layout
+/// and `sizeof`: FVec<4> and the structs that embed it (TEMesh vertices, GPU
+/// buffer records) are laid out exactly as without the kernels.
+
+#if !defined(OMEGAGTE_NO_SIMD)
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__)) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OMEGAGTE_SIMD_SSE 1
+#include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define OMEGAGTE_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+#endif
+
+_NAMESPACE_BEGIN_
+
+namespace SIMD {
+
+    /// r[i] = a[i] + b[i] for `n` floats.
+    inline void add(const float *a,const float *b,float *r,unsigned n){
+        unsigned i = 0;
+#if defined(OMEGAGTE_SIMD_SSE)
+        for(; i + 4 <= n; i += 4)
+            _mm_storeu_ps(r + i, _mm_add_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+#elif defined(OMEGAGTE_SIMD_NEON)
+        for(; i + 4 <= n; i += 4)
+            vst1q_f32(r + i, vaddq_f32(vld1q_f32(a + i), vld1q_f32(b + i)));
+#endif
+        for(; i < n; i++)
+            r[i] = a[i] + b[i];
+    }
+
+    /// r[i] = a[i] - b[i] for `n` floats.
+    inline void sub(const float *a,const float *b,float *r,unsigned n){
+        unsigned i = 0;
+#if defined(OMEGAGTE_SIMD_SSE)
+        for(; i + 4 <= n; i += 4)
+            _mm_storeu_ps(r + i, _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+#elif defined(OMEGAGTE_SIMD_NEON)
+        for(; i + 4 <= n; i += 4)
+            vst1q_f32(r + i, vsubq_f32(vld1q_f32(a + i), vld1q_f32(b + i)));
+#endif
+        for(; i < n; i++)
+            r[i] = a[i] - b[i];
+    }
+
+    /// r[i] = a[i] * s for `n` floats.
+    inline void scale(const float *a,float s,float *r,unsigned n){
+        unsigned i = 0;
+#if defined(OMEGAGTE_SIMD_SSE)
+        const __m128 vs = _mm_set1_ps(s);
+        for(; i + 4 <= n; i += 4)
+            _mm_storeu_ps(r + i, _mm_mul_ps(_mm_loadu_ps(a + i), vs));
+#elif defined(OMEGAGTE_SIMD_NEON)
+        const float32x4_t vs = vdupq_n_f32(s);
+        for(; i + 4 <= n; i += 4)
+            vst1q_f32(r + i, vmulq_f32(vld1q_f32(a + i), vs));
+#endif
+        for(; i < n; i++)
+            r[i] = a[i] * s;
+    }
+
+    /// Product of two 4x4 storage blocks, `r[i][j] = sum_k a[i][k] * b[k][j]`
+    /// — the same raw-storage product `Matrix::operator*` defines. Each output
+    /// block `r[i]` is a sum of the blocks `b[k]` scaled by `a[i][k]`.
+    inline void mul4x4(const float *a,const float *b,float *r){
+#if defined(OMEGAGTE_SIMD_SSE)
+        const __m128 b0 = _mm_loadu_ps(b), b1 = _mm_loadu_ps(b + 4),
+                     b2 = _mm_loadu_ps(b + 8), b3 = _mm_loadu_ps(b + 12);
+        for(unsigned i = 0; i < 4; i++){
+            const float *ai = a + i * 4;
+            __m128 sum = _mm_setzero_ps();
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(ai[0]), b0));
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(ai[1]), b1));
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(ai[2]), b2));
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(ai[3]), b3));
+            _mm_storeu_ps(r + i * 4, sum);
+        }
+#elif defined(OMEGAGTE_SIMD_NEON)
+        const float32x4_t b0 = vld1q_f32(b), b1 = vld1q_f32(b + 4),
+                          b2 = vld1q_f32(b + 8), b3 = vld1q_f32(b + 12);
+        for(unsigned i = 0; i < 4; i++){
+            const float *ai = a + i * 4;
+            float32x4_t sum = vdupq_n_f32(0.f);
+            sum = vaddq_f32(sum, vmulq_n_f32(b0, ai[0]));
+            sum = vaddq_f32(sum, vmulq_n_f32(b1, ai[1]));
+            sum = vaddq_f32(sum, vmulq_n_f32(b2, ai[2]));
+            sum = vaddq_f32(sum, vmulq_n_f32(b3, ai[3]));
+            vst1q_f32(r + i * 4, sum);
+        }
+#else
+        for(unsigned i = 0; i < 4; i++)
+            for(unsigned j = 0; j < 4; j++){
+                float sum = 0.f;
+                for(unsigned k = 0; k < 4; k++)
+                    sum += a[i * 4 + k] * b[k * 4 + j];
+                r[i * 4 + j] = sum;
+            }
+#endif
+    }
+
+    /// Column-major 4x4 `m` applied to the column vector `p`:
+    /// `out[r] = sum_c m[c][r] * p[c]`, i.e. the sum of the columns of `m`
+    /// scaled by the components of `p`.
+    inline void transform4(const float *m,const float *p,float *out){
+#if defined(OMEGAGTE_SIMD_SSE)
+        __m128 sum = _mm_setzero_ps();
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(m), _mm_set1_ps(p[0])));
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(m + 4), _mm_set1_ps(p[1])));
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(m + 8), _mm_set1_ps(p[2])));
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(m + 12), _mm_set1_ps(p[3])));
+        _mm_storeu_ps(out, sum);
+#elif defined(OMEGAGTE_SIMD_NEON)
+        float32x4_t sum = vdupq_n_f32(0.f);
+        sum = vaddq_f32(sum, vmulq_n_f32(vld1q_f32(m), p[0]));
+        sum = vaddq_f32(sum, vmulq_n_f32(vld1q_f32(m + 4), p[1]));
+        sum = vaddq_f32(sum, vmulq_n_f32(vld1q_f32(m + 8), p[2]));
+        sum = vaddq_f32(sum, vmulq_n_f32(vld1q_f32(m + 12), p[3]));
+        vst1q_f32(out, sum);
+#else
+        for(unsigned r = 0; r < 4; r++){
+            float sum = 0.f;
+            for(unsigned c = 0; c < 4; c++)
+                sum += m[c * 4 + r] * p[c];
+            out[r] = sum;
+        }
+#endif
+    }
+
+    /// Hamilton product of two (x, y, z, w) quaternions. Every lane adds the
+    /// same four terms in the order `Quaternion::operator*` writes them.
+    inline void quatMul(const float *a,const float *b,float *r){
+#if defined(OMEGAGTE_SIMD_SSE)
+        const __m128 vb = _mm_loadu_ps(b);
+        const __m128 bWZYX = _mm_shuffle_ps(vb, vb, _MM_SHUFFLE(0, 1, 2, 3));
+        const __m128 bZWXY = _mm_shuffle_ps(vb, vb, _MM_SHUFFLE(1, 0, 3, 2));
+        const __m128 bYXWZ = _mm_shuffle_ps(vb, vb, _MM_SHUFFLE(2, 3, 0, 1));
+        // Sign masks for (+ - + -), (+ + - -) and (- + + -).
+        const __m128 s1 = _mm_castsi128_ps(_mm_set_epi32(int(0x80000000), 0, int(0x80000000), 0));
+        const __m128 s2 = _mm_castsi128_ps(_mm_set_epi32(int(0x80000000), int(0x80000000), 0, 0));
+        const __m128 s3 = _mm_castsi128_ps(_mm_set_epi32(int(0x80000000), 0, 0, int(0x80000000)));
+        __m128 sum = _mm_mul_ps(_mm_set1_ps(a[3]), vb);
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(a[0]), _mm_xor_ps(bWZYX, s1)));
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(a[1]), _mm_xor_ps(bZWXY, s2)));
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(a[2]), _mm_xor_ps(bYXWZ, s3)));
+        _mm_storeu_ps(r, sum);
+#elif defined(OMEGAGTE_SIMD_NEON)
+        const float32x4_t vb = vld1q_f32(b);
+        const float32x4_t bYXWZ = vrev64q_f32(vb);
+        const float32x4_t bZWXY = vcombine_f32(vget_high_f32(vb), vget_low_f32(vb));
+        const float32x4_t bWZYX = vrev64q_f32(bZWXY);
+        const float s1v[4] = {1.f, -1.f, 1.f, -1.f};
+        const float s2v[4] = {1.f, 1.f, -1.f, -1.f};
+        const float s3v[4] = {-1.f, 1.f, 1.f, -1.f};
+        float32x4_t sum = vmulq_n_f32(vb, a[3]);
+        sum = vaddq_f32(sum, vmulq_n_f32(vmulq_f32(bWZYX, vld1q_f32(s1v)), a[0]));
+        sum = vaddq_f32(sum, vmulq_n_f32(vmulq_f32(bZWXY, vld1q_f32(s2v)), a[1]));
+        sum = vaddq_f32(sum, vmulq_n_f32(vmulq_f32(bYXWZ, vld1q_f32(s3v)), a[2]));
+        vst1q_f32(r, sum);
+#else
+        const float x = a[0], y = a[1], z = a[2], w = a[3];
+        r[0] = w*b[0] + x*b[3] + y*b[2] - z*b[1];
+        r[1] = w*b[1] - x*b[2] + y*b[3] + z*b[0];
+        r[2] = w*b[2] + x*b[1] - y*b[0] + z*b[3];
+        r[3] = w*b[3] - x*b[0] - y*b[1] - z*b[2];
+#endif
+    }
+
+}
+
+_NAMESPACE_END_
+
+#endif
@@ -2,12 +2,15 @@
 #include "GTEMath.h"
 #include <thread>
 #include <future>
+#include <map>
 #include <mutex>
 #include <optional>
+#include <tuple>
 #include <type_traits>
 #include <cstdint>
 #include "GE.h"
 #include "GETexture.h"
+#include <omega-common/multithread.h>
 
 
 #ifndef OMEGAGTE_TE_H
@@ -29,6 +32,12 @@ enum class StrokeCap : int {
     Square   ///< Extends the stroke by strokeWidth/2 as a rectangle.
 };
 
+/// @brief Which points of a filled path count as inside.
+enum class TEFillRule : int {
+    NonZero,  ///< Inside where the contours' signed winding number is non-zero (SVG `nonzero`).
+    EvenOdd   ///< Inside where a ray crosses an odd number of edges (SVG `evenodd`).
+};
+
 /**
  *
  Defines the arguments for the triangulation operations.
@@ -67,6 +76,11 @@ struct OMEGAGTE_EXPORT TETriangulationParams {
     float graphicsPath2DStrokeWidth = 1.f;
     StrokeJoin graphicsPath2DJoin = StrokeJoin::Miter;
     StrokeCap graphicsPath2DCap = StrokeCap::Butt;
+    TEFillRule graphicsPath2DFillRule = TEFillRule::NonZero;
+    /// Contours filled together with `graphicsPath2D` (holes, islands).
+    std::shared_ptr<std::vector<GVectorPath2D>> graphicsPath2DExtraContours;
+    /// Attachment that colors (or textures) the fill.
+    size_t graphicsPath2DFillAttachment = 1;
 
     friend class OmegaTriangulationEngineContext;
 public:
@@ -187,9 +201,20 @@ public:
       @param[in] fill If true, the interior is filled (uses the second attachment).
       @param[in] join Join style applied at interior vertices.
       @param[in] cap Cap style applied at the endpoints of an open path.
+      @param[in] fillRule Which regions of a self-intersecting path the fill covers.
       @returns TETriangulationParams
     */
-    static TETriangulationParams GraphicsPath2D(GVectorPath2D & path,float strokeWidth = 1.f,bool contour = false,bool fill = false,StrokeJoin join = StrokeJoin::Miter,StrokeCap cap = StrokeCap::Butt);
+    static TETriangulationParams GraphicsPath2D(GVectorPath2D & path,float strokeWidth = 1.f,bool contour = false,bool fill = false,StrokeJoin join = StrokeJoin::Miter,StrokeCap cap = StrokeCap::Butt,TEFillRule fillRule = TEFillRule::NonZero);
+    /**
+      Fill several closed 2D contours as one shape (no stroke). Holes and
+      overlapping islands are resolved by `fillRule`, so an SVG path with
+      subpaths maps onto one call. The fill uses the first attachment.
+      @param[in] contourCount The number of contours.
+      @param[in] contours An array of GVectorPath2D objects, each implicitly closed. (Ensure that it has the same length as the `contourCount`)
+      @param[in] fillRule
+      @returns TETriangulationParams
+    */
+    static TETriangulationParams GraphicsPath2DFill(unsigned contourCount,GVectorPath2D * const contours,TEFillRule fillRule = TEFillRule::NonZero);
     /**
       Triangulate 3D vector paths
       @param[in] vectorPathCount The number of vectorPathes to triangulate
@@ -243,6 +268,15 @@ public:
     /// the call argument, and the effective viewport) are all ignored.
     bool localSpace = false;
 
+    /// @brief How many viewport units one authored unit spans on screen.
+    ///
+    /// Only read when the context flattens arcs to a tolerance
+    /// (`setArcTolerance`): every radius is multiplied by it before the
+    /// segment count is chosen. The default of 1 is right for geometry
+    /// authored in viewport units; set it for local-space geometry that
+    /// `GESpace` will scale, so a shape drawn small gets few segments.
+    float screenScale = 1.f;
+
     /// @brief The front-face winding this geometry is authored for.
     ///
     /// Like `viewport`, the winding a mesh wants is a property of the geometry
@@ -316,6 +350,9 @@ struct OMEGAGTE_EXPORT TETriangulationResult {
         void scale(float w,float h,float l);
         unsigned vertexCount();
     };
+    // AttachmentData embeds FVec<4>; over-aligning the math types would pad
+    // every corner of every mesh.
+    static_assert(sizeof(TEMesh::Vertex) == 64, "TEMesh::Vertex must stay 64 bytes");
     TEMesh mesh;
     unsigned totalVertexCount();
     OMEGA_DEPRECATED("Place the result's mesh in a GESpace and use its matrix transforms; these CPU transforms bake into NDC and distort under non-square viewports.")
@@ -325,6 +362,88 @@ struct OMEGAGTE_EXPORT TETriangulationResult {
     OMEGA_DEPRECATED("Place the result's mesh in a GESpace and use its matrix transforms; these CPU transforms bake into NDC.")
     void scale(float w,float h,float l);
 };
+
+/**
+ @brief Indexed triangulation output, packed in the GPU vertex layout.
+
+ Produced by `OmegaTriangulationEngineContext::triangulatePacked`. Each vertex
+ holds only the attributes named in `attributes` (a `GEMeshVertexAttribute`
+ mask, see GEMesh.h), laid out at `geMeshStrideFor(attributes)` exactly as a
+ `buffer<T>` reads it, so `vertexData` can be copied into a vertex buffer
+ as-is. Shapes emit shared corners once and reference them from `indices`
+ directly; there is no `TEMesh::buildIndexed()` dedup pass.
+*/
+struct OMEGAGTE_EXPORT TEPackedMesh {
+    uint32_t attributes = 0;
+    /// Per-vertex stride in bytes.
+    size_t vertexStride = 0;
+    unsigned vertexCount = 0;
+    /// `vertexCount * vertexStride` bytes of vertex data. Pad bytes are zero.
+    std::vector<float> vertexData;
+    /// Triangle list, already in the requested front-face winding.
+    std::vector<uint32_t> indices;
+};
+
+/**
+ @brief Caller-owned destination for
+ `OmegaTriangulationEngineContext::triangulatePackedInto`.
+
+ Points at memory the caller has mapped (typically the CPU mapping of an
+ upload `GEBuffer`), so the vertices are written once, in place, in the GPU
+ layout of `TEPackedMesh`. Several shapes can be appended to one mapping by
+ advancing the pointers and `baseVertex` between calls.
+*/
+struct OMEGAGTE_EXPORT TEPackedMeshTarget {
+    /// Vertex region, written at `geMeshStrideFor(attributes)` spacing.
+    void *vertexData = nullptr;
+    /// Number of vertices that fit at `vertexData`.
+    unsigned vertexCapacity = 0;
+    uint32_t *indexData = nullptr;
+    /// Number of indices that fit at `indexData`.
+    unsigned indexCapacity = 0;
+    /// Added to every index written, for shapes sharing one vertex buffer.
+    uint32_t baseVertex = 0;
+
+    /// Out: vertices and indices the shape needs. Reported even when they did
+    /// not fit, so a caller can size the mapping and try again.
+    unsigned vertexCount = 0;
+    unsigned indexCount = 0;
+};
+/**
+ @brief A group of triangulations submitted together through
+ `OmegaTriangulationEngineContext::triangulateBatchAsync`.
+
+ The jobs run on the shared `OmegaCommon::TaskScheduler` pool, so a frame
+ with hundreds of shapes costs a handful of tasks rather than a thread per
+ shape. `results()` is fulfilled once every job has finished or been
+ skipped, with one slot per submitted `TETriangulationParams`, in submission
+ order. Copies of a batch refer to the same jobs.
+*/
+class OMEGAGTE_EXPORT TETriangulationBatch {
+public:
+    /// One slot per job. A slot is empty when its job was cancelled before it
+    /// started, or when triangulating it threw.
+    using Results = std::vector<std::optional<TETriangulationResult>>;
+
+    OmegaCommon::Async<Results> results() const;
+
+    /// @brief Skip every job that has not started yet.
+    ///
+    /// Jobs already running finish normally; `results()` is still fulfilled
+    /// once they have. Safe to call from any thread, any number of times.
+    void cancel();
+    bool isCancelled() const;
+
+    /// Number of jobs in the batch.
+    size_t size() const;
+private:
+    friend class OmegaTriangulationEngineContext;
+    struct State;
+    std::shared_ptr<State> state;
+    OmegaCommon::Async<Results> asyncResults;
+    TETriangulationBatch(std::shared_ptr<State> state,OmegaCommon::Async<Results> asyncResults);
+};
+
 /**
  
 */
@@ -332,10 +451,41 @@ class OMEGAGTE_EXPORT OmegaTriangulationEngineContext {
     friend class OmegaTriangulationEngine;
 protected:
     GEViewport defaultViewport;
-    std::vector<std::thread> activeThreads;
-    std::mutex activeThreadsMutex;
+    /// Every `triangulateAsync` / `triangulateBatchAsync` job still queued or
+    /// running on the shared scheduler.
+    OmegaCommon::TaskGroup pendingJobs;
+
+    /// Blocks until every queued async job has run. Jobs call the virtual
+    /// `translateCoords` / `getEffectiveViewport`, so a subclass must call
+    /// this from its own destructor, before its members go away; the base
+    /// destructor only waits again as a backstop.
+    void waitForPendingJobs();
 
     float arcStep = 0.01;
+    /// Largest distance, in viewport units, a flattened arc may stray from
+    /// the true curve. 0 keeps every arc on the fixed `arcStep`.
+    float arcTolerance = 0.f;
+
+    /// Cosines and sines of the angles an arc is flattened at, from 0 to a
+    /// sweep: `segments + 1` evenly spaced ones in tolerance mode, otherwise
+    /// steps of `arcStep` with the last one clamped to the sweep. Shared by
+    /// every shape that lands on the same LOD level.
+    struct ArcTable {
+        std::vector<float> cosines, sines;
+    };
+    /// LOD cache of `ArcTable`s keyed on (sweep, segments, fixed step), the
+    /// step being 0 in tolerance mode. Tolerance mode rounds segment counts
+    /// up to a small ladder of levels, so repeated UI shapes of similar
+    /// on-screen size reuse one table and skip the trig.
+    std::mutex arcTableMutex;
+    std::map<std::tuple<float,unsigned,float>,std::shared_ptr<const ArcTable>> arcTables;
+
+    /// Segments for an arc of `radius` authored units sweeping `sweep`
+    /// radians, at `scale` viewport units per authored unit.
+    unsigned arcSegmentsFor(float radius,float sweep,float scale) const;
+    /// Angle increment for the primitives that step an angle directly.
+    float arcStepFor(float radius,float sweep,float scale) const;
+    std::shared_ptr<const ArcTable> arcTableFor(float radius,float sweep,float scale);
 
     void translateCoordsDefaultImpl(float x, float y,float z,GEViewport * viewport, float *x_result, float *y_result,float *z_result);
     virtual void translateCoords(float x, float y,float z,GEViewport * viewport, float *x_result, float *y_result,float *z_result) = 0;
@@ -343,6 +493,10 @@ protected:
 
     inline void _triangulatePriv(const TETriangulationParams & params,GTEPolygonFrontFaceRotation frontFaceRotation, GEViewport * viewport,TETriangulationResult & result);
 
+    struct MeshEmitter;
+    bool _emitFlatPriv(const TETriangulationParams & params,GTEPolygonFrontFaceRotation frontFaceRotation, GEViewport * viewport,MeshEmitter & out);
+    void _triangulatePackedPriv(const TETriangulationParams & params,GTEPolygonFrontFaceRotation frontFaceRotation, GEViewport * viewport,MeshEmitter & out);
+
 public:
     struct GPUTriangulationExtractedParams {
         enum Type { Rect, RoundedRect, Ellipsoid, RectPrism, Path2D, Other } type = Other;
@@ -352,6 +506,8 @@ public:
         float cr, cg, cb, ca;
         bool hasColor = false;
         float strokeWidth = 1.f;
+        /// Angle increment for the ellipse kernel (`arcStepFor` its radius).
+        float arcStep = 0.01f;
         bool contour = false;
         struct Segment { float sx, sy, ex, ey; };
         std::vector<Segment> pathSegments;
@@ -385,6 +541,14 @@ public:
     void setArcStep(float newArcStep){
         arcStep = newArcStep;
     };
+    /// Flatten arcs to a screen-space tolerance instead of `arcStep`: each
+    /// ellipse, rounded-rect corner, stroke join and 3D ring gets the fewest
+    /// even steps that keep it within `tolerance` viewport units of the true
+    /// curve (see `TETriangulationParams::screenScale`). 0 restores `arcStep`.
+    // Default Value: 0 (fixed arcStep).
+    void setArcTolerance(float tolerance){
+        arcTolerance = tolerance > 0.f ? tolerance : 0.f;
+    };
     /**
      Triangulate according to the parameters and viewport.
      @param params
@@ -394,6 +558,34 @@ public:
     */
     TETriangulationResult triangulateSync(const TETriangulationParams & params, GTEPolygonFrontFaceRotation frontFaceRotation = GTEPolygonFrontFaceRotation::Clockwise,GEViewport * viewport = nullptr);
 
+    /**
+      Triangulate like `triangulateSync` (@see triangulateSync), but write
+      positions plus only the requested attributes straight into an indexed,
+      GPU-layout vertex stream instead of building a `TEMesh`. Rects, rounded
+      rects and ellipsoids emit each shared corner once; other primitives
+      are emitted one vertex per corner with sequential indices.
+     @param params
+     @param attributes `GEMeshVertexAttribute` mask. Must include Position.
+       Attributes the shape has no data for are written as zero.
+     @param frontFaceRotation
+     @param viewport
+     @returns TEPackedMesh, empty if `attributes` lacks Position.
+    */
+    TEPackedMesh triangulatePacked(const TETriangulationParams & params, uint32_t attributes, GTEPolygonFrontFaceRotation frontFaceRotation = GTEPolygonFrontFaceRotation::Clockwise,GEViewport * viewport = nullptr);
+
+    /**
+      Performs `triangulatePacked` (@see triangulatePacked) directly into
+      caller-mapped memory, with no intermediate copy.
+     @param params
+     @param attributes `GEMeshVertexAttribute` mask. Must include Position.
+     @param target Destination regions; `vertexCount` / `indexCount` are set
+       to the shape's requirements either way.
+     @param frontFaceRotation
+     @param viewport
+     @returns true if the whole shape fit into `target`.
+    */
+    bool triangulatePackedInto(const TETriangulationParams & params, uint32_t attributes, TEPackedMeshTarget & target, GTEPolygonFrontFaceRotation frontFaceRotation = GTEPolygonFrontFaceRotation::Clockwise,GEViewport * viewport = nullptr);
+
     /**
       Performs triangulation like `triangulateSync` (@see triangulateSync), 
       however it performs the computation in a compute pipeline.
@@ -406,13 +598,26 @@ public:
 
     /**
       Performs triangulation like `triangulateSync` (@see triangulateSync), 
-      however it performs the computation in a seperate thread
+      however it performs the computation on the shared worker pool
      @param params
      @param frontFaceRotation
      @param viewport
      @returns std::future<TETriangulationResult>
     */
     std::future<TETriangulationResult> triangulateAsync(const TETriangulationParams & params,GTEPolygonFrontFaceRotation frontFaceRotation = GTEPolygonFrontFaceRotation::Clockwise, GEViewport * viewport = nullptr);
+
+    /**
+      Performs `triangulateSync` (@see triangulateSync) for every entry of
+      `params` on the shared worker pool. Jobs are grouped into a few tasks
+      per worker, so submitting many small shapes stays cheap. `frontFaceRotation`
+      and `viewport` apply to every job, under the same precedence rules as
+      the single-shape calls (per-params fields win).
+     @param params
+     @param frontFaceRotation
+     @param viewport
+     @returns TETriangulationBatch whose `results()` follow the order of `params`.
+    */
+    TETriangulationBatch triangulateBatchAsync(std::vector<TETriangulationParams> params,GTEPolygonFrontFaceRotation frontFaceRotation = GTEPolygonFrontFaceRotation::Clockwise, GEViewport * viewport = nullptr);
     virtual ~OmegaTriangulationEngineContext();
 };
 
@@ -1,6 +1,5 @@
 #include "omegaGTE/GECommandQueue.h"
 #include <algorithm>
-#include <condition_variable>
 #include <memory>
 #include <mutex>
 
@@ -115,26 +114,22 @@ _NAMESPACE_BEGIN_
         }
     }
 
+    OmegaCommon::Async<GECommitCompletionInfo> GECommandQueue::commitToGPUAsync() {
+        auto promise = std::make_shared<OmegaCommon::Promise<GECommitCompletionInfo>>();
+        auto result = promise->async();
+        commitToGPU([promise](const GECommitCompletionInfo & info) {
+            promise->set(info);
+        });
+        return result;
+    }
+
     GECommitCompletionInfo GECommandQueue::commitToGPUAndWaitTimed() {
         // Backend-neutral: drive the async timing path and block until it
         // reports. Works for any backend that implements
         // commitToGPU(handler) correctly; with the base fallback above it
         // returns immediately with zero timing.
-        GECommitCompletionInfo result {};
-        std::mutex m;
-        std::condition_variable cv;
-        bool done = false;
-        commitToGPU([&result, &m, &cv, &done](const GECommitCompletionInfo & info) {
-            {
-                std::lock_guard<std::mutex> lock(m);
-                result = info;
-                done = true;
-            }
-            cv.notify_one();
-        });
-        std::unique_lock<std::mutex> lock(m);
-        cv.wait(lock, [&done]{ return done; });
-        return result;
+        auto pending = commitToGPUAsync();
+        return pending.get();
     }
 
     GECommandQueue::GECommandQueue(const GECommandQueueDesc & desc,
@@ -0,0 +1,96 @@
+#include "omegaGTE/GTEMath.h"
+
+#if defined(OMEGAGTE_SIMD_SSE)
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define OMEGAGTE_AVX
+#else
+#define OMEGAGTE_AVX __attribute__((target("avx")))
+#endif
+#endif
+
+_NAMESPACE_BEGIN_
+
+namespace {
+
+    /// Homogeneous divide and narrowing, exactly as `transformPoint` does it.
+    inline GPoint3D finishPoint(const float *out){
+        const float w = out[3];
+        if(w != 0.f && w != 1.f){
+            return GPoint3D{out[0] / w, out[1] / w, out[2] / w};
+        }
+        return GPoint3D{out[0], out[1], out[2]};
+    }
+
+    void transformEach(const float *m, const GPoint3D *in, GPoint3D *out, size_t count){
+        for(size_t i = 0; i < count; i++){
+            const float p[4] = {in[i].x, in[i].y, in[i].z, 1.f};
+            float r[4];
+            SIMD::transform4(m, p, r);
+            out[i] = finishPoint(r);
+        }
+    }
+
+#if defined(OMEGAGTE_SIMD_SSE)
+
+    bool hasAvx() {
+        static const bool supported = []() {
+#if defined(_MSC_VER) && !defined(__clang__)
+            int info[4];
+            __cpuid(info, 1);
+            const bool osxsave = (info[2] & (1 << 27)) != 0;
+            const bool avx = (info[2] & (1 << 28)) != 0;
+            return osxsave && avx && (_xgetbv(0) & 0x6) == 0x6;
+#else
+            return __builtin_cpu_supports("avx") != 0;
+#endif
+        }();
+        return supported;
+    }
+
+    /// Two points per 256-bit register: the low half carries point i, the high
+    /// half point i + 1. Lanes see the same multiplies and adds, in the same
+    /// order, as `SIMD::transform4`.
+    OMEGAGTE_AVX void transformPointsAvx(const float *m, const GPoint3D *in, GPoint3D *out, size_t count){
+        const __m256 c0 = _mm256_broadcast_ps(reinterpret_cast<const __m128 *>(m));
+        const __m256 c1 = _mm256_broadcast_ps(reinterpret_cast<const __m128 *>(m + 4));
+        const __m256 c2 = _mm256_broadcast_ps(reinterpret_cast<const __m128 *>(m + 8));
+        const __m256 c3 = _mm256_broadcast_ps(reinterpret_cast<const __m128 *>(m + 12));
+        size_t i = 0;
+        alignas(32) float r[8];
+        for(; i + 2 <= count; i += 2){
+            const GPoint3D &a = in[i], &b = in[i + 1];
+            __m256 sum = _mm256_setzero_ps();
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(c0, _mm256_setr_ps(a.x, a.x, a.x, a.x, b.x, b.x, b.x, b.x)));
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(c1, _mm256_setr_ps(a.y, a.y, a.y, a.y, b.y, b.y, b.y, b.y)));
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(c2, _mm256_setr_ps(a.z, a.z, a.z, a.z, b.z, b.z, b.z, b.z)));
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(c3, _mm256_set1_ps(1.f)));
+            _mm256_store_ps(r, sum);
+            out[i] = finishPoint(r);
+            out[i + 1] = finishPoint(r + 4);
+        }
+        transformEach(m, in + i, out + i, count - i);
+    }
+
+#endif
+
+}
+
+void transformPoints(const FMatrix<4,4>& m,
+                     OmegaCommon::Span<const GPoint3D> in,
+                     OmegaCommon::Span<GPoint3D> out){
+    assert(out.size() >= in.size() && "transformPoints output is shorter than its input");
+#if defined(OMEGAGTE_SIMD_SSE)
+    if(hasAvx()){
+        transformPointsAvx(m.data(), in.data(), out.data(), in.size());
+        return;
+    }
+#endif
+    transformEach(m.data(), in.data(), out.data(), in.size());
+}
+
+void transformPoints(const FMatrix<4,4>& m, OmegaCommon::Span<GPoint3D> points){
+    transformPoints(m, OmegaCommon::Span<const GPoint3D>(points.data(), points.size()), points);
+}
+
+_NAMESPACE_END_
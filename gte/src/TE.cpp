@@ -1,7 +1,12 @@
 #include "omegaGTE/TE.h"
 #include "omegaGTE/GTEMath.h"
+#include "omegaGTE/GEMesh.h"
+#include "common/TEPathFill.h"
 // #include "omegaGTE/GTEShaderTypes.h"
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <memory>
 #include <optional>
 #include <thread>
 #include <iostream>
@@ -211,7 +216,7 @@ TETriangulationParams TETriangulationParams::Capsule(GCapsule &capsule){
     return params;
 };
 
-TETriangulationParams TETriangulationParams::GraphicsPath2D(GVectorPath2D & path,float strokeWidth,bool contour,bool fill,StrokeJoin join,StrokeCap cap){
+TETriangulationParams TETriangulationParams::GraphicsPath2D(GVectorPath2D & path,float strokeWidth,bool contour,bool fill,StrokeJoin join,StrokeCap cap,TEFillRule fillRule){
     TETriangulationParams params;
     params.params.reset(new Data{});
     params.graphicsPath2D = std::make_shared<GVectorPath2D>(path);
@@ -220,6 +225,22 @@ TETriangulationParams TETriangulationParams::GraphicsPath2D(GVectorPath2D & path
     params.graphicsPath2DStrokeWidth = strokeWidth;
     params.graphicsPath2DJoin = join;
     params.graphicsPath2DCap = cap;
+    params.graphicsPath2DFillRule = fillRule;
+    params.type = params.params->type = TRIANGULATE_GRAPHICSPATH2D;
+    return params;
+};
+
+TETriangulationParams TETriangulationParams::GraphicsPath2DFill(unsigned contourCount,GVectorPath2D *const contours,TEFillRule fillRule){
+    assert(contourCount > 0 && contours != nullptr && "GraphicsPath2DFill needs at least one contour");
+    TETriangulationParams params;
+    params.params.reset(new Data{});
+    params.graphicsPath2D = std::make_shared<GVectorPath2D>(contours[0]);
+    params.graphicsPath2DExtraContours = std::make_shared<std::vector<GVectorPath2D>>(contours + 1,contours + contourCount);
+    params.graphicsPath2DContour = true;
+    params.graphicsPath2DFill = true;
+    params.graphicsPath2DStrokeWidth = 0.f;
+    params.graphicsPath2DFillRule = fillRule;
+    params.graphicsPath2DFillAttachment = 0;
     params.type = params.params->type = TRIANGULATE_GRAPHICSPATH2D;
     return params;
 };
@@ -439,6 +460,395 @@ GTEPolygonFrontFaceRotation OmegaTriangulationEngineContext::resolveWinding(cons
     return frontFaceRotationArg;
 }
 
+// Arc flattening. A chord of angle a on a circle of radius r strays
+// r * (1 - cos(a / 2)) from the curve, so a tolerance t allows a step of
+// 2 * acos(1 - t / r) (the same bound GPathBuilder2D::arcTo uses). Counts are
+// rounded up a ladder of levels (8, 12, 16, 24, 32, ...), each a multiple of
+// four so quarter arcs split evenly, which keeps the table cache small.
+static constexpr unsigned kMinArcSegments = 8;
+static constexpr unsigned kMaxArcSegments = 4096;
+
+static unsigned arcLODLevel(unsigned segments){
+    unsigned level = kMinArcSegments;
+    while(level < segments && level < kMaxArcSegments){
+        level = ((level & (level - 1)) == 0) ? level + level / 2 : (level / 3) * 4;
+    }
+    return std::min(level, kMaxArcSegments);
+}
+
+unsigned OmegaTriangulationEngineContext::arcSegmentsFor(float radius,float sweep,float scale) const {
+    const float twoPi = 2.f * float(PI);
+    if(arcTolerance <= 0.f){
+        const float step = arcStep > 0.f ? arcStep : 0.01f;
+        return std::max(1u, (unsigned)std::ceil(sweep / step));
+    }
+    const float screenRadius = std::fabs(radius * scale);
+    unsigned full = 0;
+    if(screenRadius > arcTolerance){
+        const float step = 2.f * std::acos(1.f - arcTolerance / screenRadius);
+        full = (step > 1e-6f) ? (unsigned)std::min(std::ceil(twoPi / step), float(kMaxArcSegments)) : kMaxArcSegments;
+    }
+    const unsigned level = arcLODLevel(full);
+    return std::max(1u, (unsigned)std::ceil(float(level) * sweep / twoPi - 1e-3f));
+}
+
+float OmegaTriangulationEngineContext::arcStepFor(float radius,float sweep,float scale) const {
+    if(arcTolerance <= 0.f){
+        return arcStep > 0.f ? arcStep : 0.01f;
+    }
+    // The callers accumulate `angle += step` and clamp the last step to the
+    // sweep; a hair of slack keeps rounding from adding a sliver step.
+    return sweep / float(arcSegmentsFor(radius, sweep, scale)) * 1.0001f;
+}
+
+std::shared_ptr<const OmegaTriangulationEngineContext::ArcTable> OmegaTriangulationEngineContext::arcTableFor(float radius,float sweep,float scale){
+    const unsigned segments = arcSegmentsFor(radius, sweep, scale);
+    // Without a tolerance the angles step by arcStep and the last step is
+    // clamped to the sweep, exactly as the shapes stepped before the tables.
+    const float fixedStep = arcTolerance <= 0.f ? arcStepFor(radius, sweep, scale) : 0.f;
+    std::lock_guard<std::mutex> lock(arcTableMutex);
+    auto & table = arcTables[std::make_tuple(sweep, segments, fixedStep)];
+    if(!table){
+        auto built = std::make_shared<ArcTable>();
+        auto push = [&](float angle){
+            built->cosines.push_back(std::cos(angle));
+            built->sines.push_back(std::sin(angle));
+        };
+        push(0.f);
+        if(fixedStep > 0.f){
+            float angle = 0.f;
+            while(angle < sweep){
+                angle = std::min(angle + fixedStep, sweep);
+                push(angle);
+            }
+        }
+        else {
+            for(unsigned k = 1;k <= segments;k++){
+                push((k == segments) ? sweep : sweep * (float(k) / float(segments)));
+            }
+        }
+        table = std::move(built);
+    }
+    return table;
+}
+
+/// Destination of `_emitFlatPriv` and `_triangulatePackedPriv`. Writes into a
+/// `TEMesh` (`triangulateSync`), into the owned vectors of a `TEPackedMesh`, or
+/// into a fixed caller region; in the last case writes past capacity are
+/// dropped but still counted, so the caller learns what the shape needs.
+struct OmegaTriangulationEngineContext::MeshEmitter {
+    /// Attribute values for one vertex. Anything a shape does not set stays
+    /// zero, matching what `buildMeshFromTriangulation` writes for a vertex
+    /// without AttachmentData.
+    struct Attributes {
+        /// Whether the TEMesh vertex carries AttachmentData at all.
+        bool attached = false;
+        float color[4] = {0.f,0.f,0.f,0.f};
+        float uv2[2] = {0.f,0.f};
+        float uv3[3] = {0.f,0.f,0.f};
+        float normal[3] = {0.f,0.f,0.f};
+    };
+    struct Vertex {
+        uint32_t index;
+        GPoint3D pt;
+    };
+
+    uint32_t attributes = 0;
+    size_t strideFloats = 0;
+    /// Float offsets of Position, UV2, UV3, Normal and Color within a vertex,
+    /// or -1 when the attribute was not requested.
+    long offsets[5] = {-1,-1,-1,-1,-1};
+    bool wantCCWWinding = false;
+
+    TETriangulationResult::TEMesh *mesh = nullptr;
+    std::vector<TETriangulationResult::TEMesh::Vertex> meshVertices;
+
+    std::vector<float> *ownedVertices = nullptr;
+    std::vector<uint32_t> *ownedIndices = nullptr;
+    float *vertexOut = nullptr;
+    unsigned vertexCapacity = 0;
+    uint32_t *indexOut = nullptr;
+    unsigned indexCapacity = 0;
+    uint32_t baseVertex = 0;
+
+    unsigned vertexCount = 0;
+    unsigned indexCount = 0;
+
+    bool init(uint32_t attrs){
+        if((attrs & GEMeshAttrPosition) == 0){
+            std::cerr << "[TE] error: packed triangulation requires the Position attribute." << std::endl;
+            return false;
+        }
+        attributes = attrs;
+        strideFloats = geMeshStrideFor(attrs) / sizeof(float);
+        const auto memberOffsets = geMeshMemberOffsetsFor(attrs);
+        const uint32_t order[5] = {GEMeshAttrPosition,GEMeshAttrUV2,GEMeshAttrUV3,GEMeshAttrNormal,GEMeshAttrColor};
+        size_t member = 0;
+        for(unsigned i = 0;i < 5;i++){
+            if(attrs & order[i]){
+                offsets[i] = long(memberOffsets[member++] / sizeof(float));
+            }
+        }
+        return true;
+    }
+
+    bool fits() const {
+        return mesh != nullptr || ownedVertices != nullptr || (vertexCount <= vertexCapacity && indexCount <= indexCapacity);
+    }
+
+    Vertex vertex(const GPoint3D & pt,const Attributes & attrs){
+        const uint32_t index = vertexCount++;
+        if(mesh != nullptr){
+            TETriangulationResult::TEMesh::Vertex vert {};
+            vert.pt = pt;
+            if(attrs.attached){
+                TETriangulationResult::AttachmentData data {FVec<4>::Create(),FVec<2>::Create(),FVec<3>::Create(),FVec<3>::Create()};
+                for(unsigned i = 0;i < 4;i++) data.color[i][0] = attrs.color[i];
+                for(unsigned i = 0;i < 2;i++) data.texture2Dcoord[i][0] = attrs.uv2[i];
+                for(unsigned i = 0;i < 3;i++) data.texture3Dcoord[i][0] = attrs.uv3[i];
+                for(unsigned i = 0;i < 3;i++) data.normal[i][0] = attrs.normal[i];
+                vert.attachment = std::move(data);
+            }
+            meshVertices.push_back(std::move(vert));
+            return Vertex{index,pt};
+        }
+        float *dst = nullptr;
+        if(ownedVertices != nullptr){
+            ownedVertices->resize(size_t(index + 1) * strideFloats,0.f);
+            dst = ownedVertices->data() + size_t(index) * strideFloats;
+        }
+        else if(vertexOut != nullptr && index < vertexCapacity){
+            dst = vertexOut + size_t(index) * strideFloats;
+            std::fill(dst,dst + strideFloats,0.f);
+        }
+        if(dst != nullptr){
+            auto put = [&](unsigned slot,const float *values,unsigned count){
+                if(offsets[slot] >= 0){
+                    std::copy(values,values + count,dst + offsets[slot]);
+                }
+            };
+            const float position[3] = {pt.x,pt.y,pt.z};
+            put(0,position,3);
+            put(1,attrs.uv2,2);
+            put(2,attrs.uv3,3);
+            put(3,attrs.normal,3);
+            put(4,attrs.color,4);
+        }
+        return Vertex{index,pt};
+    }
+
+    void triangle(uint32_t a,uint32_t b,uint32_t c){
+        if(mesh != nullptr){
+            mesh->vertexPolygons.push_back(TETriangulationResult::TEMesh::Polygon{meshVertices[a],meshVertices[b],meshVertices[c]});
+            indexCount += 3;
+            return;
+        }
+        const uint32_t corners[3] = {a,b,c};
+        for(auto corner : corners){
+            const unsigned at = indexCount++;
+            if(ownedIndices != nullptr){
+                ownedIndices->push_back(corner);
+            }
+            else if(indexOut != nullptr && at < indexCapacity){
+                indexOut[at] = baseVertex + corner;
+            }
+        }
+    }
+
+    /// Flat, +Z facing geometry: orient each triangle to the requested winding
+    /// by its signed area, so every triangle survives back-face culling.
+    void flatTriangle(const Vertex & a,const Vertex & b,const Vertex & c){
+        const float area = (b.pt.x - a.pt.x) * (c.pt.y - a.pt.y)
+                         - (b.pt.y - a.pt.y) * (c.pt.x - a.pt.x);
+        if((area > 0.f) != wantCCWWinding){
+            triangle(a.index,c.index,b.index);
+        }
+        else {
+            triangle(a.index,b.index,c.index);
+        }
+    }
+};
+
+/// Rect, RoundedRect and Ellipsoid geometry. Both `triangulateSync` and the
+/// packed outputs emit these shapes through here, so the two cannot diverge.
+/// Returns false, emitting nothing, for every other primitive.
+bool OmegaTriangulationEngineContext::_emitFlatPriv(const TETriangulationParams &params,GTEPolygonFrontFaceRotation frontFaceRotation, GEViewport * viewport,MeshEmitter & out){
+    using Attributes = MeshEmitter::Attributes;
+
+    GEViewport resolvedViewport = resolveViewport(params, viewport);
+    const bool localSpace = params.localSpace;
+    viewport = &resolvedViewport;
+    out.wantCCWWinding = (resolveWinding(params, frontFaceRotation) == GTEPolygonFrontFaceRotation::CounterClockwise);
+
+    // Same seam as `_triangulatePriv`'s mapCoords.
+    auto mapCoords = [&](float x, float y, float z, float * x_result, float * y_result, float * z_result){
+        if(localSpace){
+            *x_result = x;
+            *y_result = y;
+            if(z_result != nullptr) *z_result = z;
+            return;
+        }
+        translateCoords(x, y, z, viewport, x_result, y_result, z_result);
+    };
+
+    const TETriangulationParams::Attachment * attachment = params.attachments.empty() ? nullptr : &params.attachments.front();
+    const bool hasColor = attachment != nullptr && attachment->type == TETriangulationParams::Attachment::TypeColor;
+    const bool hasTex2D = attachment != nullptr && attachment->type == TETriangulationParams::Attachment::TypeTexture2D;
+    const bool hasTex3D = attachment != nullptr && attachment->type == TETriangulationParams::Attachment::TypeTexture3D;
+
+    Attributes colorAttrs;
+    if(hasColor){
+        colorAttrs.attached = true;
+        for(unsigned i = 0;i < 4;i++){
+            colorAttrs.color[i] = attachment->colorData.color[i][0];
+        }
+    }
+    auto uvAttrs = [](float u, float v){
+        Attributes a;
+        a.attached = true;
+        a.uv2[0] = u; a.uv2[1] = v;
+        return a;
+    };
+
+    // Two triangles over four shared corners, in the corner order and UV
+    // assignment of the TRIANGULATE_RECT case.
+    auto emitRect = [&](float x0, float y0, float x1, float y1, const Attributes * cornerAttrs){
+        auto v00 = out.vertex(GPoint3D{x0,y0,0.f}, cornerAttrs[0]);
+        auto v01 = out.vertex(GPoint3D{x0,y1,0.f}, cornerAttrs[1]);
+        auto v10 = out.vertex(GPoint3D{x1,y0,0.f}, cornerAttrs[2]);
+        auto v11 = out.vertex(GPoint3D{x1,y1,0.f}, cornerAttrs[3]);
+        out.flatTriangle(v00, v01, v10);
+        out.flatTriangle(v11, v10, v01);
+    };
+
+    switch(params.type){
+        case TETriangulationParams::TRIANGULATE_RECT : {
+            GRect &object = params.params->rect;
+            float x0,x1,y0,y1;
+            mapCoords(object.pos.x,object.pos.y,0.f,&x0,&y0,nullptr);
+            mapCoords(object.pos.x + object.w,object.pos.y + object.h,0.f,&x1,&y1,nullptr);
+            if(hasTex2D){
+                const Attributes corners[4] = {uvAttrs(0.f,1.f),uvAttrs(0.f,0.f),uvAttrs(1.f,1.f),uvAttrs(1.f,0.f)};
+                emitRect(x0,y0,x1,y1,corners);
+            }
+            else {
+                const Attributes corners[4] = {colorAttrs,colorAttrs,colorAttrs,colorAttrs};
+                emitRect(x0,y0,x1,y1,corners);
+            }
+            break;
+        }
+        case TETriangulationParams::TRIANGULATE_ROUNDEDRECT : {
+            auto & object = params.params->rounded_rect;
+            const float ox = object.pos.x;
+            const float oy = object.pos.y;
+            const float rad_x = std::fmax(0.0f,std::fmin(object.rad_x,object.w * 0.5f));
+            const float rad_y = std::fmax(0.0f,std::fmin(object.rad_y,object.h * 0.5f));
+
+            // A textured rounded rect is mapped by device position over its
+            // whole bounds; otherwise every vertex carries the fill color.
+            float dx0 = 0.f,dy0 = 0.f,dx1 = 0.f,dy1 = 0.f;
+            if(hasTex2D){
+                mapCoords(ox,oy,0.f,&dx0,&dy0,nullptr);
+                mapCoords(ox + object.w,oy + object.h,0.f,&dx1,&dy1,nullptr);
+            }
+            const float rangeX = dx1 - dx0;
+            const float rangeY = dy1 - dy0;
+            auto attrsAt = [&](float x, float y){
+                if(!hasTex2D){
+                    return colorAttrs;
+                }
+                Attributes a = uvAttrs((std::fabs(rangeX) > 1e-6f) ? ((x - dx0) / rangeX) : 0.f,
+                                       (std::fabs(rangeY) > 1e-6f) ? ((y - dy0) / rangeY) : 0.f);
+                a.normal[2] = 1.f;
+                return a;
+            };
+
+            auto appendRect = [&](const GRect & sub_rect){
+                float x0,x1,y0,y1;
+                mapCoords(sub_rect.pos.x,sub_rect.pos.y,0.f,&x0,&y0,nullptr);
+                mapCoords(sub_rect.pos.x + sub_rect.w,sub_rect.pos.y + sub_rect.h,0.f,&x1,&y1,nullptr);
+                const Attributes corners[4] = {attrsAt(x0,y0),attrsAt(x0,y1),attrsAt(x1,y0),attrsAt(x1,y1)};
+                emitRect(x0,y0,x1,y1,corners);
+            };
+
+            // A quarter-turn fan around a corner's center, clockwise from
+            // (cosStart, sinStart); consecutive slices share their rim vertex
+            // instead of repeating it.
+            const auto quarter = arcTableFor(std::max(rad_x,rad_y), float(PI) / 2.f, params.screenScale);
+            auto tessellateArc = [&](GPoint2D start, float ar_x, float ar_y, float cosStart, float sinStart){
+                if(ar_x <= 0.f || ar_y <= 0.f){
+                    return;
+                }
+                auto rimPoint = [&](size_t k){
+                    const float c = quarter->cosines[k], sn = quarter->sines[k];
+                    float x_t,y_t;
+                    mapCoords(start.x + (cosStart * c + sinStart * sn) * ar_x,
+                              start.y + (sinStart * c - cosStart * sn) * ar_y,0.f,&x_t,&y_t,nullptr);
+                    return out.vertex(GPoint3D{x_t,y_t,0.f}, attrsAt(x_t,y_t));
+                };
+                float centerX,centerY;
+                mapCoords(start.x,start.y,0.f,&centerX,&centerY,nullptr);
+                auto center = out.vertex(GPoint3D{centerX,centerY,0.f}, attrsAt(centerX,centerY));
+                auto prev = rimPoint(0);
+                for(size_t k = 1;k < quarter->cosines.size();k++){
+                    auto next = rimPoint(k);
+                    out.flatTriangle(center, prev, next);
+                    prev = next;
+                }
+            };
+
+            appendRect(GRect{GPoint2D{ox + rad_x, oy + rad_y}, object.w - (2 * rad_x), object.h - (2 * rad_y)});
+            tessellateArc(GPoint2D {ox + rad_x, oy + rad_y}, rad_x, rad_y, 0.f, -1.f);
+            appendRect(GRect{GPoint2D{ox, oy + rad_y}, rad_x, object.h - (2 * rad_y)});
+            tessellateArc(GPoint2D {ox + rad_x, oy + object.h - rad_y}, rad_x, rad_y, -1.f, 0.f);
+            appendRect(GRect{GPoint2D{ox + rad_x, oy + object.h - rad_y}, object.w - (rad_x * 2), rad_y});
+            tessellateArc(GPoint2D {ox + object.w - rad_x, oy + object.h - rad_y}, rad_x, rad_y, 0.f, 1.f);
+            appendRect(GRect{GPoint2D{ox + object.w - rad_x, oy + rad_y}, rad_x, object.h - (2 * rad_y)});
+            tessellateArc(GPoint2D {ox + object.w - rad_x, oy + rad_y}, rad_x, rad_y, 1.f, 0.f);
+            appendRect(GRect{GPoint2D{ox + rad_x, oy}, object.w - (rad_x * 2), rad_y});
+            break;
+        }
+        case TETriangulationParams::TRIANGULATE_ELLIPSOID : {
+            auto & object = params.params->ellipsoid;
+            auto attrsFor = [&](float u, float v){
+                if(!hasTex2D && !hasTex3D){
+                    return colorAttrs;
+                }
+                Attributes a;
+                a.attached = true;
+                if(hasTex2D){
+                    a.uv2[0] = u; a.uv2[1] = v;
+                }
+                else {
+                    a.uv3[0] = u; a.uv3[1] = v; a.uv3[2] = 0.5f;
+                }
+                a.normal[2] = 1.f;
+                return a;
+            };
+            auto rimPoint = [&](float cosA, float sinA){
+                float tx,ty,tz;
+                mapCoords(object.x + cosA * object.rad_x,object.y + sinA * object.rad_y,object.z,&tx,&ty,&tz);
+                return out.vertex(GPoint3D{tx,ty,tz}, attrsFor(0.5f + 0.5f * cosA, 0.5f + 0.5f * sinA));
+            };
+
+            float centerX,centerY,centerZ;
+            mapCoords(object.x,object.y,object.z,&centerX,&centerY,&centerZ);
+            auto center = out.vertex(GPoint3D{centerX,centerY,centerZ}, attrsFor(0.5f,0.5f));
+            const auto ring = arcTableFor(std::max(object.rad_x,object.rad_y), 2.f * float(PI), params.screenScale);
+            auto prev = rimPoint(1.f,0.f);
+            for(size_t k = 1;k < ring->cosines.size();k++){
+                auto next = rimPoint(ring->cosines[k],ring->sines[k]);
+                out.flatTriangle(center, prev, next);
+                prev = next;
+            }
+            break;
+        }
+        default :
+            return false;
+    }
+    return true;
+}
+
 inline void OmegaTriangulationEngineContext::_triangulatePriv(const TETriangulationParams &params,GTEPolygonFrontFaceRotation frontFaceRotation, GEViewport * viewport,TETriangulationResult & result){
     assert(params.attachments.size() <= 2 && "At most 2 attachments are allowed for each tessellation params");
 
@@ -548,302 +958,21 @@ inline void OmegaTriangulationEngineContext::_triangulatePriv(const TETriangulat
     };
 
     switch(params.type){
-        case TETriangulationParams::TRIANGULATE_RECT : {
+        case TETriangulationParams::TRIANGULATE_RECT :
             std::cout << "Tessalate GRect" << std::endl;
             std::cout << "Viewport: x:" << viewport->x << " y:" << viewport->y << " w:" << viewport->width << " h:" << viewport->height << " " << std::endl;
-            GRect &object = params.params->rect;
-
-            TETriangulationResult::TEMesh mesh {TETriangulationResult::TEMesh::TopologyTriangle};
-            TETriangulationResult::TEMesh::Polygon tri {};
-            float x0,x1,y0,y1;
-            float u,v;
-            mapCoords(object.pos.x,object.pos.y,0.f,viewport,&x0,&y0,nullptr);
-            mapCoords(object.pos.x + object.w,object.pos.y + object.h,0.f,viewport,&x1,&y1,nullptr);
-
-            std::cout << "X0:" << x0 << ", X1:" << x1 << ", Y0:" << y0 << ", Y1:" << y1 << std::endl;
-
-            tri.a.pt.x = x0;
-            tri.a.pt.y = y0;
-            tri.b.pt.x = x0;
-            tri.b.pt.y = y1;
-            tri.c.pt.x = x1;
-            tri.c.pt.y = y0;
-
-            std::optional<TETriangulationResult::AttachmentData> extra;
-
-            if(!params.attachments.empty()){
-                auto & attachment = params.attachments.front();
-                if(attachment.type == TETriangulationParams::Attachment::TypeColor){
-                    extra = std::make_optional<TETriangulationResult::AttachmentData>({attachment.colorData.color,FVec<2>::Create(),FVec<3>::Create()});
-                    tri.a.attachment = tri.b.attachment = tri.c.attachment = extra;
-                }
-                else if(attachment.type == TETriangulationParams::Attachment::TypeTexture2D){
-                    
-                    mapCoords(attachment.texture2DData.width,attachment.texture2DData.height,0, viewport,&u,&v,nullptr);
-                    auto texCoord = FVec<2>::Create();
-
-                    texCoord[0][0] = 0;
-                    texCoord[1][0] = 0;
-
-                    extra = std::make_optional<TETriangulationResult::AttachmentData>({FVec<4>::Create(),texCoord,FVec<3>::Create()});
-                    tri.b.attachment = extra;
-
-                    texCoord[1][0] = 1;
-                    extra = std::make_optional<TETriangulationResult::AttachmentData>({FVec<4>::Create(),texCoord,FVec<3>::Create()});
-                     tri.a.attachment = extra;
-
-                     texCoord[0][0] = 1;
-                      texCoord[1][0] = 1;
-                    extra = std::make_optional<TETriangulationResult::AttachmentData>({FVec<4>::Create(),texCoord,FVec<3>::Create()});
-                     tri.c.attachment = extra;
-                }
-            }
-            
-
-            mesh.vertexPolygons.push_back(tri);
-
-            tri.a.pt.x = x1;
-            tri.a.pt.y = y1;
-
-            if(!params.attachments.empty()){
-                 auto & attachment = params.attachments.front();
-                 if(attachment.type == TETriangulationParams::Attachment::TypeTexture2D){
-                     auto texCoord = FVec<2>::Create();
-                     texCoord[0][0] = 1;
-                     texCoord[1][0] = 0;
-                     extra = std::make_optional<TETriangulationResult::AttachmentData>({FVec<4>::Create(),texCoord,FVec<3>::Create()});
-                    tri.a.attachment = extra;
-                 }
-            }
-
-            // T1 was CW (Y-up NDC); the natural T2 vertex order would be CCW.
-            // Swap b/c (pt + attachment together) so both triangles share the
-            // pipeline's requested front-face winding instead of alternating.
-            std::swap(tri.b, tri.c);
-
-            mesh.vertexPolygons.push_back(tri);
-
-
-            finalizeFlat(mesh);
-
-            break;
-        }
-        case TETriangulationParams::TRIANGULATE_ROUNDEDRECT : {
-            auto & object = params.params->rounded_rect;
-            const float ox = object.pos.x;
-            const float oy = object.pos.y;
-            const float rad_x = std::fmax(0.0f,std::fmin(object.rad_x,object.w * 0.5f));
-            const float rad_y = std::fmax(0.0f,std::fmin(object.rad_y,object.h * 0.5f));
-
-            std::optional<TETriangulationResult::AttachmentData> colorAttachment;
-            if(colorAttachmentPtr != nullptr){
-                colorAttachment = std::make_optional<TETriangulationResult::AttachmentData>(
-                        TETriangulationResult::AttachmentData{colorAttachmentPtr->colorData.color,FVec<2>::Create(),FVec<3>::Create()});
-            }
-
-            // The entire rounded rect — center + 4 corner arcs + 4 edge strips —
-            // is emitted as a single mesh. See gte/docs/Limitations.rst (Driver
-            // Quirks) for why multi-mesh primitives are not allowed.
-            TETriangulationResult::TEMesh mesh {TETriangulationResult::TEMesh::TopologyTriangle};
-
-            // Tessellate a sub-rect via the regular RECT path into a scratch
-            // result, then move its polygons into our shared mesh.
-            auto appendRect = [&](const GRect & sub_rect){
-                GRect rectCopy = sub_rect;
-                auto rect_params = TETriangulationParams::Rect(rectCopy);
-                if(colorAttachment){
-                    rect_params.addAttachment(
-                            TETriangulationParams::Attachment::makeColor(colorAttachment->color));
-                }
-                TETriangulationResult subResult;
-                _triangulatePriv(rect_params, frontFaceRotation, viewport, subResult);
-                mesh.vertexPolygons.insert(
-                    mesh.vertexPolygons.end(),
-                    std::make_move_iterator(subResult.mesh.vertexPolygons.begin()),
-                    std::make_move_iterator(subResult.mesh.vertexPolygons.end()));
-            };
-
-            auto tessellateArc = [&](GPoint2D start, float ar_x, float ar_y, float angle_start, float angle_end, float _arcStep){
-                if(std::fabs(_arcStep) < 0.0001f){
-                    return;
-                }
-                float centerX,centerY;
-                mapCoords(start.x,start.y,0.f,viewport,&centerX,&centerY,nullptr);
-                GPoint3D pt_a {centerX,centerY,0.f};
-                float angle = angle_start;
-                while((_arcStep > 0.f) ? (angle < angle_end) : (angle > angle_end)){
-                    TETriangulationResult::TEMesh::Polygon p {};
-
-                    float nextAngle = angle + _arcStep;
-                    if(_arcStep > 0.f && nextAngle > angle_end){
-                        nextAngle = angle_end;
-                    }
-                    else if(_arcStep < 0.f && nextAngle < angle_end){
-                        nextAngle = angle_end;
-                    }
-
-                    auto x_f = cosf(angle) * ar_x;
-                    auto y_f = sinf(angle) * ar_y;
-
-                    x_f += start.x;
-                    y_f += start.y;
-
-                    p.a.pt = pt_a;
-                    float x_t,y_t;
-                    mapCoords(x_f,y_f,0.f,viewport,&x_t,&y_t,nullptr);
-                    p.b.pt = GPoint3D {x_t,y_t,0.f};
-
-                    x_f = cosf(nextAngle) * ar_x;
-                    y_f = sinf(nextAngle) * ar_y;
-
-                    x_f += start.x;
-                    y_f += start.y;
-
-                    mapCoords(x_f,y_f,0.f,viewport,&x_t,&y_t,nullptr);
-                    p.c.pt = GPoint3D {x_t,y_t,0.f};
-                    if(colorAttachment){
-                        p.a.attachment = p.b.attachment = p.c.attachment = colorAttachment;
-                    }
-
-                    mesh.vertexPolygons.push_back(p);
-                    angle = nextAngle;
-                }
-            };
-
-            /// Center
-            appendRect(GRect{GPoint2D{ox + rad_x, oy + rad_y},
-                             object.w - (2 * rad_x), object.h - (2 * rad_y)});
-
-            /// Bottom Left Arc
-            tessellateArc(GPoint2D {ox + rad_x, oy + rad_y}, rad_x, rad_y, float(3.f * PI) / 2.f, PI, -arcStep);
-
-            /// Left Rect
-            appendRect(GRect{GPoint2D{ox, oy + rad_y}, rad_x, object.h - (2 * rad_y)});
-
-            /// Top Left Arc
-            tessellateArc(GPoint2D {ox + rad_x, oy + object.h - rad_y}, rad_x, rad_y, PI, float(PI) / 2.f, -arcStep);
-
-            /// Top Rect
-            appendRect(GRect{GPoint2D{ox + rad_x, oy + object.h - rad_y},
-                             object.w - (rad_x * 2), rad_y});
-
-            /// Top Right Arc
-            tessellateArc(GPoint2D {ox + object.w - rad_x, oy + object.h - rad_y}, rad_x, rad_y, float(PI) / 2.f, 0, -arcStep);
-
-            /// Right Rect
-            appendRect(GRect{GPoint2D{ox + object.w - rad_x, oy + rad_y},
-                             rad_x, object.h - (2 * rad_y)});
-
-            /// Bottom Right Arc
-            tessellateArc(GPoint2D {ox + object.w - rad_x, oy + rad_y}, rad_x, rad_y, 0, -float(PI) / 2.f, -arcStep);
-
-            /// Bottom Rect
-            appendRect(GRect{GPoint2D{ox + rad_x, oy}, object.w - (rad_x * 2), rad_y});
-
-            if(textureAttachment != nullptr && textureAttachment->type == TETriangulationParams::Attachment::TypeTexture2D){
-                float dx0,dy0,dx1,dy1;
-                mapCoords(ox,oy,0.f,viewport,&dx0,&dy0,nullptr);
-                mapCoords(ox + object.w,oy + object.h,0.f,viewport,&dx1,&dy1,nullptr);
-                const float rangeX = (dx1 - dx0);
-                const float rangeY = (dy1 - dy0);
-                FVec<3> normal = makeVec3(0.f,0.f,1.f);
-                for(auto & poly : mesh.vertexPolygons){
-                    auto assign = [&](auto & vert){
-                        float u = (std::fabs(rangeX) > 1e-6f) ? ((vert.pt.x - dx0) / rangeX) : 0.f;
-                        float v = (std::fabs(rangeY) > 1e-6f) ? ((vert.pt.y - dy0) / rangeY) : 0.f;
-                        vert.attachment = std::make_optional<TETriangulationResult::AttachmentData>(
-                            makeTex2DAttachment(u,v,normal));
-                    };
-                    assign(poly.a);
-                    assign(poly.b);
-                    assign(poly.c);
-                }
-            }
-
-            if(!mesh.vertexPolygons.empty()){
-                finalizeFlat(mesh);
-            }
-
-            break;
-        }
+            [[fallthrough]];
+        case TETriangulationParams::TRIANGULATE_ROUNDEDRECT :
         case TETriangulationParams::TRIANGULATE_ELLIPSOID : {
-            auto & object = params.params->ellipsoid;
-
-            TETriangulationResult::TEMesh mesh {TETriangulationResult::TEMesh::TopologyTriangle};
-            std::optional<TETriangulationResult::AttachmentData> colorAttachment;
-            if(colorAttachmentPtr != nullptr){
-                colorAttachment = std::make_optional<TETriangulationResult::AttachmentData>(
-                        TETriangulationResult::AttachmentData{colorAttachmentPtr->colorData.color,FVec<2>::Create(),FVec<3>::Create()});
-            }
-            const bool hasTex2D = textureAttachment != nullptr && textureAttachment->type == TETriangulationParams::Attachment::TypeTexture2D;
-            const bool hasTex3D = textureAttachment != nullptr && textureAttachment->type == TETriangulationParams::Attachment::TypeTexture3D;
-            const FVec<3> planarNormal = makeVec3(0.f,0.f,1.f);
-
-            float centerX,centerY,centerZ;
-            mapCoords(object.x,object.y,object.z,viewport,&centerX,&centerY,&centerZ);
-
-            auto makePoint = [&](float angle){
-                float x = object.x + std::cos(angle) * object.rad_x;
-                float y = object.y + std::sin(angle) * object.rad_y;
-                float tx,ty,tz;
-                mapCoords(x,y,object.z,viewport,&tx,&ty,&tz);
-                return GPoint3D{tx,ty,tz};
-            };
-
-            auto attachmentForAngle = [&](float cosA, float sinA) -> std::optional<TETriangulationResult::AttachmentData> {
-                if(hasTex2D){
-                    return std::make_optional<TETriangulationResult::AttachmentData>(
-                        makeTex2DAttachment(0.5f + 0.5f * cosA, 0.5f + 0.5f * sinA, planarNormal));
-                }
-                if(hasTex3D){
-                    return std::make_optional<TETriangulationResult::AttachmentData>(
-                        makeTex3DAttachment(0.5f + 0.5f * cosA, 0.5f + 0.5f * sinA, 0.5f, planarNormal));
-                }
-                return colorAttachment;
-            };
-            auto centerAttachment = [&]() -> std::optional<TETriangulationResult::AttachmentData> {
-                if(hasTex2D){
-                    return std::make_optional<TETriangulationResult::AttachmentData>(
-                        makeTex2DAttachment(0.5f, 0.5f, planarNormal));
-                }
-                if(hasTex3D){
-                    return std::make_optional<TETriangulationResult::AttachmentData>(
-                        makeTex3DAttachment(0.5f, 0.5f, 0.5f, planarNormal));
-                }
-                return colorAttachment;
-            };
-
-            auto center = GPoint3D{centerX,centerY,centerZ};
-            const float step = arcStep > 0.f ? arcStep : 0.01f;
-            float angle = 0.f;
-            auto prev = makePoint(0.f);
-            float prevCos = 1.f, prevSin = 0.f;
-
-            while(angle < (2.f * PI)){
-                float nextAngle = angle + step;
-                if(nextAngle > (2.f * PI)){
-                    nextAngle = 2.f * PI;
-                }
-                auto next = makePoint(nextAngle);
-                float nextCos = std::cos(nextAngle);
-                float nextSin = std::sin(nextAngle);
-
-                TETriangulationResult::TEMesh::Polygon tri {};
-                tri.a.pt = center;
-                tri.b.pt = prev;
-                tri.c.pt = next;
-                tri.a.attachment = centerAttachment();
-                tri.b.attachment = attachmentForAngle(prevCos,prevSin);
-                tri.c.attachment = attachmentForAngle(nextCos,nextSin);
-                mesh.vertexPolygons.push_back(tri);
-
-                prev = next;
-                prevCos = nextCos;
-                prevSin = nextSin;
-                angle = nextAngle;
-            }
-
-            finalizeFlat(mesh);
+            // The entire shape — for a rounded rect, center + 4 corner arcs + 4
+            // edge strips — is emitted as a single mesh. See
+            // gte/docs/Limitations.rst (Driver Quirks) for why multi-mesh
+            // primitives are not allowed.
+            TETriangulationResult::TEMesh mesh;
+            MeshEmitter out;
+            out.mesh = std::addressof(mesh);
+            _emitFlatPriv(params, frontFaceRotation, viewport, out);
+            result.mesh = std::move(mesh);
             break;
         }
         case TETriangulationParams::TRIANGULATE_RECTANGULAR_PRISM : {
@@ -1013,17 +1142,19 @@ inline void OmegaTriangulationEngineContext::_triangulatePriv(const TETriangulat
             // (Driver Quirks) for why multi-mesh primitives are not allowed.
             TETriangulationResult::TEMesh mesh {TETriangulationResult::TEMesh::TopologyTriangle};
 
-            // Fill (a fan) and stroke (quads + joins + caps) are authored with
+            // Fill (sweep-line pieces) and stroke (quads + joins + caps) are authored with
             // independent winding, so this mesh is finalized through finalizeFlat,
             // which normalizes every triangle to the requested winding mode.
 
             // --- Fill ---
-            // Fan triangulation from the first vertex using the second attachment as fill color.
+            // Sweep-line tessellation of the path (plus any extra contours)
+            // under the params' fill rule; see common/TEPathFill.h.
             if(params.graphicsPath2DFill && path.size() >= 2){
                 std::optional<TETriangulationResult::AttachmentData> fillAttachment;
                 bool fillHasTex2D = false;
-                if(params.attachments.size() >= 2){
-                    auto & att = params.attachments[1];
+                const size_t fillSlot = params.graphicsPath2DFillAttachment;
+                if(params.attachments.size() > fillSlot){
+                    auto & att = params.attachments[fillSlot];
                     if(att.type == TETriangulationParams::Attachment::TypeColor){
                         fillAttachment = std::make_optional<TETriangulationResult::AttachmentData>(
                                 TETriangulationResult::AttachmentData{att.colorData.color,FVec<2>::Create(),FVec<3>::Create()});
@@ -1032,39 +1163,61 @@ inline void OmegaTriangulationEngineContext::_triangulatePriv(const TETriangulat
                     }
                 }
                 if(fillAttachment || fillHasTex2D){
-                    // Collect all points from the path in both object and device space.
-                    std::vector<GPoint2D> objPts;
-                    std::vector<GPoint3D> pts;
-                    objPts.push_back(path.firstPt());
-                    pts.push_back(toDevicePoint(path.firstPt()));
-                    for(auto it = path.begin(); it != path.end(); it.operator++()){
-                        auto seg = *it;
-                        if(seg.pt_B == nullptr) break;
-                        objPts.push_back(*seg.pt_B);
-                        pts.push_back(toDevicePoint(*seg.pt_B));
+                    // Collect every contour's points in object space; the
+                    // tessellator works there and each output corner is
+                    // mapped to device space afterwards.
+                    std::vector<std::vector<GPoint2D>> contours;
+                    auto collectContour = [&](GVectorPath2D & contourPath){
+                        std::vector<GPoint2D> pts;
+                        pts.push_back(contourPath.firstPt());
+                        for(auto it = contourPath.begin(); it != contourPath.end(); it.operator++()){
+                            auto seg = *it;
+                            if(seg.pt_B == nullptr) break;
+                            if(seg.pt_B->x == pts.back().x && seg.pt_B->y == pts.back().y) continue;
+                            pts.push_back(*seg.pt_B);
+                        }
+                        if(pts.size() > 1 && pts.back().x == pts.front().x && pts.back().y == pts.front().y){
+                            pts.pop_back();
+                        }
+                        contours.push_back(std::move(pts));
+                    };
+                    collectContour(path);
+                    if(params.graphicsPath2DExtraContours){
+                        for(auto & extra : *params.graphicsPath2DExtraContours){
+                            collectContour(extra);
+                        }
                     }
-                    float minX = objPts[0].x, maxX = objPts[0].x, minY = objPts[0].y, maxY = objPts[0].y;
-                    for(auto & p : objPts){
-                        if(p.x < minX) minX = p.x; if(p.x > maxX) maxX = p.x;
-                        if(p.y < minY) minY = p.y; if(p.y > maxY) maxY = p.y;
+
+                    float minX = contours[0][0].x, maxX = minX, minY = contours[0][0].y, maxY = minY;
+                    for(auto & contourPts : contours){
+                        for(auto & p : contourPts){
+                            minX = std::min(minX, p.x); maxX = std::max(maxX, p.x);
+                            minY = std::min(minY, p.y); maxY = std::max(maxY, p.y);
+                        }
                     }
                     const float rangeX = (maxX - minX) > 1e-6f ? (maxX - minX) : 1.f;
                     const float rangeY = (maxY - minY) > 1e-6f ? (maxY - minY) : 1.f;
-                    auto makeFillAttachment = [&](size_t idx) -> std::optional<TETriangulationResult::AttachmentData> {
+                    auto makeFillVertex = [&](const GPoint2D & objPt){
+                        TETriangulationResult::TEMesh::Vertex vert {};
+                        vert.pt = toDevicePoint(objPt);
                         if(fillHasTex2D){
-                            return std::make_optional<TETriangulationResult::AttachmentData>(
-                                makeTex2DAttachment((objPts[idx].x - minX)/rangeX, (objPts[idx].y - minY)/rangeY, pathNormal));
+                            vert.attachment = std::make_optional<TETriangulationResult::AttachmentData>(
+                                makeTex2DAttachment((objPt.x - minX)/rangeX, (objPt.y - minY)/rangeY, pathNormal));
+                        }
+                        else {
+                            vert.attachment = fillAttachment;
                         }
-                        return fillAttachment;
+                        return vert;
                     };
-                    for(size_t i = 1; i + 1 < pts.size(); ++i){
+
+                    std::vector<GPoint2D> fillTriangles;
+                    PathFill::tessellate(contours, params.graphicsPath2DFillRule, fillTriangles);
+                    mesh.vertexPolygons.reserve(mesh.vertexPolygons.size() + fillTriangles.size() / 3);
+                    for(size_t i = 0; i + 2 < fillTriangles.size(); i += 3){
                         TETriangulationResult::TEMesh::Polygon tri {};
-                        tri.a.pt = pts[0];
-                        tri.b.pt = pts[i];
-                        tri.c.pt = pts[i + 1];
-                        tri.a.attachment = makeFillAttachment(0);
-                        tri.b.attachment = makeFillAttachment(i);
-                        tri.c.attachment = makeFillAttachment(i + 1);
+                        tri.a = makeFillVertex(fillTriangles[i]);
+                        tri.b = makeFillVertex(fillTriangles[i + 1]);
+                        tri.c = makeFillVertex(fillTriangles[i + 2]);
                         mesh.vertexPolygons.push_back(tri);
                     }
                 }
@@ -1077,7 +1230,7 @@ inline void OmegaTriangulationEngineContext::_triangulatePriv(const TETriangulat
                 const StrokeJoin joinStyle = params.graphicsPath2DJoin;
                 const StrokeCap capStyle = params.graphicsPath2DCap;
                 const bool closed = params.graphicsPath2DContour;
-                const float joinStep = arcStep > 0.f ? arcStep : 0.01f;
+                const float joinStep = arcStepFor(halfStroke, 2.f * float(PI), params.screenScale);
                 const float miterLimit = 4.f;
 
                 auto strokeAttachment = [&](float u, float v) -> std::optional<TETriangulationResult::AttachmentData> {
@@ -1395,7 +1548,7 @@ inline void OmegaTriangulationEngineContext::_triangulatePriv(const TETriangulat
             GPoint3D bottomCenter {cx_bottom, cy_bottom, cz_bottom};
             GPoint3D topCenter {cx_top, cy_top, cz_top};
 
-            const float step = arcStep > 0.f ? arcStep : 0.01f;
+            const float step = arcStepFor(object.r, 2.f * float(PI), params.screenScale);
             float angle = 0.f;
 
             auto makeRimPoint = [&](float a, float baseY) -> GPoint3D {
@@ -1493,7 +1646,7 @@ inline void OmegaTriangulationEngineContext::_triangulatePriv(const TETriangulat
             mapCoords(object.x, object.y, object.z, viewport, &base_cx, &base_cy, &base_cz);
             GPoint3D baseCenter {base_cx, base_cy, base_cz};
 
-            const float step = arcStep > 0.f ? arcStep : 0.01f;
+            const float step = arcStepFor(object.r, 2.f * float(PI), params.screenScale);
             float angle = 0.f;
 
             auto makeBasePoint = [&](float a) -> GPoint3D {
@@ -1573,7 +1726,8 @@ inline void OmegaTriangulationEngineContext::_triangulatePriv(const TETriangulat
 
             const float R = object.majorRadius;
             const float r = object.minorRadius;
-            const float step = arcStep > 0.f ? arcStep : 0.01f;
+            const float thetaStep = arcStepFor(R + r, 2.f * float(PI), params.screenScale);
+            const float phiStep = arcStepFor(r, 2.f * float(PI), params.screenScale);
             const float twoPi = 2.f * float(PI);
 
             // Y-up: symmetry axis is Y, major circle lies in the XZ plane
@@ -1613,13 +1767,13 @@ inline void OmegaTriangulationEngineContext::_triangulatePriv(const TETriangulat
 
             float theta = 0.f;
             while(theta < twoPi){
-                float thetaNext = theta + step;
+                float thetaNext = theta + thetaStep;
                 if(thetaNext > twoPi) thetaNext = twoPi;
                 const float u0 = theta / twoPi, u1 = thetaNext / twoPi;
 
                 float phi = 0.f;
                 while(phi < twoPi){
-                    float phiNext = phi + step;
+                    float phiNext = phi + phiStep;
                     if(phiNext > twoPi) phiNext = twoPi;
                     const float v0 = phi / twoPi, v1 = phiNext / twoPi;
 
@@ -1666,7 +1820,7 @@ inline void OmegaTriangulationEngineContext::_triangulatePriv(const TETriangulat
             const bool hasTex3D = textureAttachment != nullptr && textureAttachment->type == TETriangulationParams::Attachment::TypeTexture3D;
 
             const float rad = object.radius;
-            const float step = arcStep > 0.f ? arcStep : 0.01f;
+            const float step = arcStepFor(rad, 2.f * float(PI), params.screenScale);
             const float twoPi = 2.f * float(PI);
             const float onePi = float(PI);
 
@@ -1769,7 +1923,7 @@ inline void OmegaTriangulationEngineContext::_triangulatePriv(const TETriangulat
             const bool hasTex3D = textureAttachment != nullptr && textureAttachment->type == TETriangulationParams::Attachment::TypeTexture3D;
 
             const float r = object.radius;
-            const float step = arcStep > 0.f ? arcStep : 0.01f;
+            const float step = arcStepFor(r, 2.f * float(PI), params.screenScale);
             const float twoPi = 2.f * float(PI);
             const float onePi = float(PI);
             const float halfPi = 0.5f * float(PI);
@@ -2073,6 +2227,7 @@ void OmegaTriangulationEngineContext::extractGPUTriangulationParams(const TETria
             out.ey = params.params->ellipsoid.y;
             out.erad_x = params.params->ellipsoid.rad_x;
             out.erad_y = params.params->ellipsoid.rad_y;
+            out.arcStep = arcStepFor(std::max(out.erad_x,out.erad_y), 2.f * float(PI), params.screenScale);
             break;
         }
         case TETriangulationParams::TRIANGULATE_RECTANGULAR_PRISM: {
@@ -2086,6 +2241,13 @@ void OmegaTriangulationEngineContext::extractGPUTriangulationParams(const TETria
             break;
         }
         case TETriangulationParams::TRIANGULATE_GRAPHICSPATH2D: {
+            // The path kernel only strokes segments. Fills (with their extra
+            // contours and fill rule) and fill-only paths run on the CPU
+            // sweep tessellator instead.
+            if (params.graphicsPath2DFill || params.graphicsPath2DStrokeWidth <= 0.f) {
+                out.type = GPUTriangulationExtractedParams::Other;
+                break;
+            }
             out.type = GPUTriangulationExtractedParams::Path2D;
             out.strokeWidth = params.graphicsPath2DStrokeWidth;
             out.contour = params.graphicsPath2DContour;
@@ -2124,14 +2286,14 @@ SharedHandle<OmegaTriangulationEngineContext> OmegaTriangulationEngine::createTE
 };
 
 std::future<TETriangulationResult> OmegaTriangulationEngineContext::triangulateAsync(const TETriangulationParams &params,GTEPolygonFrontFaceRotation frontFaceRotation, GEViewport * viewport){
-    std::promise<TETriangulationResult> prom;
-    auto fut = prom.get_future();
-    TETriangulationParams paramsCopy = params;
+    // std::promise is move-only and TaskGroup stores its jobs in a std::function.
+    auto prom = std::make_shared<std::promise<TETriangulationResult>>();
+    auto fut = prom->get_future();
     std::optional<GEViewport> viewportCopy = std::nullopt;
     if(viewport != nullptr){
         viewportCopy = *viewport;
     }
-    std::thread worker([this, promise = std::move(prom), paramsCopy, frontFaceRotation, viewportCopy]() mutable {
+    pendingJobs.run([this, prom, paramsCopy = params, frontFaceRotation, viewportCopy]() mutable {
         try{
             GEViewport _viewport = {};
             GEViewport *viewportPtr = nullptr;
@@ -2139,36 +2301,172 @@ std::future<TETriangulationResult> OmegaTriangulationEngineContext::triangulateA
                 _viewport = viewportCopy.value();
                 viewportPtr = &_viewport;
             }
-            promise.set_value_at_thread_exit(triangulateSync(paramsCopy,frontFaceRotation,viewportPtr));
+            prom->set_value(triangulateSync(paramsCopy,frontFaceRotation,viewportPtr));
         }
         catch(...){
-            promise.set_exception(std::current_exception());
+            prom->set_exception(std::current_exception());
         }
     });
-    {
-        std::lock_guard<std::mutex> lock(activeThreadsMutex);
-        activeThreads.emplace_back(std::move(worker));
-    }
     return fut;
 };
 
+struct TETriangulationBatch::State {
+    std::vector<TETriangulationParams> params;
+    GTEPolygonFrontFaceRotation frontFaceRotation;
+    std::optional<GEViewport> viewport;
+    Results results;
+    std::atomic<bool> cancelled {false};
+    std::atomic<size_t> remainingTasks {0};
+    OmegaCommon::Promise<Results> promise;
+};
+
+TETriangulationBatch::TETriangulationBatch(std::shared_ptr<State> state,OmegaCommon::Async<Results> asyncResults):
+state(std::move(state)),asyncResults(std::move(asyncResults)){
+
+};
+
+OmegaCommon::Async<TETriangulationBatch::Results> TETriangulationBatch::results() const {
+    return asyncResults;
+};
+
+void TETriangulationBatch::cancel(){
+    state->cancelled.store(true,std::memory_order_relaxed);
+};
+
+bool TETriangulationBatch::isCancelled() const {
+    return state->cancelled.load(std::memory_order_relaxed);
+};
+
+size_t TETriangulationBatch::size() const {
+    return state->params.size();
+};
+
+TETriangulationBatch OmegaTriangulationEngineContext::triangulateBatchAsync(std::vector<TETriangulationParams> params,GTEPolygonFrontFaceRotation frontFaceRotation, GEViewport * viewport){
+    auto state = std::make_shared<TETriangulationBatch::State>();
+    const size_t jobCount = params.size();
+    state->params = std::move(params);
+    state->frontFaceRotation = frontFaceRotation;
+    if(viewport != nullptr){
+        state->viewport = *viewport;
+    }
+    state->results.resize(jobCount);
+    TETriangulationBatch batch(state,state->promise.async());
+
+    if(jobCount == 0){
+        state->promise.set(TETriangulationBatch::Results{});
+        return batch;
+    }
+
+    // A few tasks per worker: enough for the scheduler to balance uneven
+    // shapes, few enough that a frame of small rects is not one task each.
+    const size_t workers = std::max<size_t>(1,OmegaCommon::TaskScheduler::shared().workerCount());
+    const size_t jobsPerTask = std::max<size_t>(1,jobCount / (workers * 4));
+    const size_t taskCount = (jobCount + jobsPerTask - 1) / jobsPerTask;
+    state->remainingTasks.store(taskCount,std::memory_order_relaxed);
+
+    for(size_t task = 0;task < taskCount;task++){
+        const size_t first = task * jobsPerTask;
+        const size_t last = std::min(jobCount,first + jobsPerTask);
+        pendingJobs.run([this,state,first,last](){
+            GEViewport _viewport = {};
+            GEViewport *viewportPtr = nullptr;
+            if(state->viewport.has_value()){
+                _viewport = state->viewport.value();
+                viewportPtr = &_viewport;
+            }
+            for(size_t idx = first;idx < last;idx++){
+                if(state->cancelled.load(std::memory_order_relaxed)){
+                    break;
+                }
+                try{
+                    state->results[idx].emplace(triangulateSync(state->params[idx],state->frontFaceRotation,viewportPtr));
+                }
+                catch(...){
+                    // Leave the slot empty; a batch has no per-job error channel.
+                }
+            }
+            if(state->remainingTasks.fetch_sub(1,std::memory_order_acq_rel) == 1){
+                state->promise.set(std::move(state->results));
+            }
+        });
+    }
+    return batch;
+};
+
 TETriangulationResult OmegaTriangulationEngineContext::triangulateSync(const TETriangulationParams &params,GTEPolygonFrontFaceRotation frontFaceRotation, GEViewport * viewport){
     TETriangulationResult res;
     _triangulatePriv(params,frontFaceRotation,viewport,res);
     return res;
 };
 
-OmegaTriangulationEngineContext::~OmegaTriangulationEngineContext(){
-    std::vector<std::thread> threads;
-    {
-        std::lock_guard<std::mutex> lock(activeThreadsMutex);
-        threads.swap(activeThreads);
+void OmegaTriangulationEngineContext::_triangulatePackedPriv(const TETriangulationParams &params,GTEPolygonFrontFaceRotation frontFaceRotation, GEViewport * viewport,MeshEmitter & out){
+    using Attributes = MeshEmitter::Attributes;
+    if(_emitFlatPriv(params, frontFaceRotation, viewport, out)){
+        return;
     }
-    for(auto &t : threads){
-        if(t.joinable()){
-            t.join();
+    // Every other primitive still goes through the TEMesh path; its corners
+    // are copied out one vertex each with sequential indices.
+    TETriangulationResult result;
+    _triangulatePriv(params, frontFaceRotation, viewport, result);
+    auto emitCorner = [&](const TETriangulationResult::TEMesh::Vertex & corner){
+        Attributes a;
+        if(corner.attachment.has_value()){
+            const auto & data = *corner.attachment;
+            a.attached = true;
+            for(unsigned i = 0;i < 4;i++) a.color[i] = data.color[i][0];
+            for(unsigned i = 0;i < 2;i++) a.uv2[i] = data.texture2Dcoord[i][0];
+            for(unsigned i = 0;i < 3;i++) a.uv3[i] = data.texture3Dcoord[i][0];
+            for(unsigned i = 0;i < 3;i++) a.normal[i] = data.normal[i][0];
         }
+        return out.vertex(corner.pt, a).index;
+    };
+    for(auto & polygon : result.mesh.vertexPolygons){
+        const uint32_t a = emitCorner(polygon.a);
+        const uint32_t b = emitCorner(polygon.b);
+        const uint32_t c = emitCorner(polygon.c);
+        out.triangle(a,b,c);
     }
+}
+
+TEPackedMesh OmegaTriangulationEngineContext::triangulatePacked(const TETriangulationParams &params,uint32_t attributes,GTEPolygonFrontFaceRotation frontFaceRotation, GEViewport * viewport){
+    TEPackedMesh mesh;
+    MeshEmitter out;
+    if(!out.init(attributes)){
+        return mesh;
+    }
+    out.ownedVertices = std::addressof(mesh.vertexData);
+    out.ownedIndices = std::addressof(mesh.indices);
+    _triangulatePackedPriv(params,frontFaceRotation,viewport,out);
+    mesh.attributes = attributes;
+    mesh.vertexStride = out.strideFloats * sizeof(float);
+    mesh.vertexCount = out.vertexCount;
+    return mesh;
+}
+
+bool OmegaTriangulationEngineContext::triangulatePackedInto(const TETriangulationParams &params,uint32_t attributes,TEPackedMeshTarget & target,GTEPolygonFrontFaceRotation frontFaceRotation, GEViewport * viewport){
+    target.vertexCount = 0;
+    target.indexCount = 0;
+    MeshEmitter out;
+    if(!out.init(attributes)){
+        return false;
+    }
+    out.vertexOut = static_cast<float *>(target.vertexData);
+    out.vertexCapacity = target.vertexData != nullptr ? target.vertexCapacity : 0;
+    out.indexOut = target.indexData;
+    out.indexCapacity = target.indexData != nullptr ? target.indexCapacity : 0;
+    out.baseVertex = target.baseVertex;
+    _triangulatePackedPriv(params,frontFaceRotation,viewport,out);
+    target.vertexCount = out.vertexCount;
+    target.indexCount = out.indexCount;
+    return out.fits();
+}
+
+void OmegaTriangulationEngineContext::waitForPendingJobs(){
+    pendingJobs.wait();
+};
+
+OmegaTriangulationEngineContext::~OmegaTriangulationEngineContext(){
+    waitForPendingJobs();
 };
 
 // The deprecated result-level wrappers forward to the deprecated TEMesh
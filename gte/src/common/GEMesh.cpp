@@ -128,6 +128,14 @@ size_t geMeshTightStrideFor(uint32_t attributes) {
     return stride;
 }
 
+OmegaCommon::Vector<size_t> geMeshMemberOffsetsFor(uint32_t attributes) {
+    const auto fields = geMeshFieldsFor(attributes);
+    if (fields.empty()) {
+        return OmegaCommon::Vector<size_t>();
+    }
+    return omegaSLStructMemberOffsets(fields, BufferDescriptor::Storage);
+}
+
 OmegaCommon::Vector<float> geMeshRepackToGPULayout(const OmegaCommon::Vector<float> & tightPacked,
                                                    uint32_t attributes,
                                                    unsigned vertexCount) {
@@ -388,4 +396,121 @@ SharedHandle<GEMesh> buildMeshFromTriangulation(
     return out;
 }
 
+SharedHandle<GEMesh> buildMeshFromPackedTriangulation(
+    OmegaGraphicsEngine *engine,
+    const TEPackedMesh &packed,
+    SharedHandle<GETexture> diffuseTexture,
+    unsigned diffuseSlot)
+{
+    if (engine == nullptr) {
+        std::cerr << "[GEMesh] error: engine is null." << std::endl;
+        return nullptr;
+    }
+    if ((packed.attributes & GEMeshAttrPosition) == 0) {
+        std::cerr << "[GEMesh] error: packed mesh has no Position attribute." << std::endl;
+        return nullptr;
+    }
+    const size_t stride = geMeshStrideFor(packed.attributes);
+    if (stride != packed.vertexStride ||
+        packed.vertexData.size() * sizeof(float) < static_cast<size_t>(packed.vertexCount) * stride) {
+        std::cerr << "[GEMesh] error: packed vertex data does not match its layout." << std::endl;
+        return nullptr;
+    }
+    if (packed.vertexCount == 0) {
+        std::cerr << "[GEMesh] warning: packed triangulation result has no vertices." << std::endl;
+    }
+
+    BufferDescriptor vbdesc;
+    vbdesc.usage = BufferDescriptor::Upload;
+    vbdesc.len = static_cast<size_t>(packed.vertexCount) * stride;
+    vbdesc.objectStride = stride;
+    vbdesc.opts = Shared;
+
+    SharedHandle<GEBuffer> vbuf = engine->makeBuffer(vbdesc);
+    if (!vbuf) {
+        std::cerr << "[GEMesh] error: makeBuffer failed (vertex buffer)." << std::endl;
+        return nullptr;
+    }
+
+    // GEBuffer has no raw block write, so the packed bytes are re-fed through
+    // the writer. It applies the same layout the packed data was produced
+    // in, so feeding it each attribute from its offset reproduces the bytes
+    // exactly.
+    const auto offsets = geMeshMemberOffsetsFor(packed.attributes);
+    const auto comps = geMeshFieldComponents(packed.attributes);
+    const size_t strideFloats = stride / sizeof(float);
+    auto vwriter = GEBufferWriter::Create();
+    vwriter->setOutputBuffer(vbuf);
+    for (unsigned v = 0; v < packed.vertexCount; ++v) {
+        const float *src = packed.vertexData.data() + static_cast<size_t>(v) * strideFloats;
+        vwriter->structBegin();
+        for (size_t f = 0; f < comps.size(); ++f) {
+            const float *field = src + offsets[f] / sizeof(float);
+            switch (comps[f]) {
+                case 2: {
+                    FVec<2> value = FVec<2>::Create();
+                    value[0][0] = field[0]; value[1][0] = field[1];
+                    vwriter->writeFloat2(value);
+                    break;
+                }
+                case 3: {
+                    FVec<3> value = FVec<3>::Create();
+                    value[0][0] = field[0]; value[1][0] = field[1]; value[2][0] = field[2];
+                    vwriter->writeFloat3(value);
+                    break;
+                }
+                default: {
+                    FVec<4> value = FVec<4>::Create();
+                    value[0][0] = field[0]; value[1][0] = field[1];
+                    value[2][0] = field[2]; value[3][0] = field[3];
+                    vwriter->writeFloat4(value);
+                    break;
+                }
+            }
+        }
+        vwriter->structEnd();
+        vwriter->sendToBuffer();
+    }
+    vwriter->flush();
+
+    const unsigned indexCount = static_cast<unsigned>(packed.indices.size());
+    BufferDescriptor ibdesc;
+    ibdesc.usage = BufferDescriptor::Upload;
+    ibdesc.len = static_cast<size_t>(indexCount) * sizeof(uint32_t);
+    ibdesc.objectStride = sizeof(uint32_t);
+    ibdesc.opts = Shared;
+
+    SharedHandle<GEBuffer> ibuf = engine->makeBuffer(ibdesc);
+    if (!ibuf) {
+        std::cerr << "[GEMesh] error: makeBuffer failed (index buffer)." << std::endl;
+        return nullptr;
+    }
+
+    auto iwriter = GEBufferWriter::Create();
+    iwriter->setOutputBuffer(ibuf);
+    for (uint32_t idx : packed.indices) {
+        iwriter->structBegin();
+        unsigned value = idx;
+        iwriter->writeUint(value);
+        iwriter->structEnd();
+        iwriter->sendToBuffer();
+    }
+    iwriter->flush();
+
+    auto out = std::make_shared<GEMesh>();
+    out->vertexBuffer = vbuf;
+    out->indexBuffer = ibuf;
+    out->vertexCount = packed.vertexCount;
+    out->indexCount = indexCount;
+    out->vertexStride = stride;
+    out->descriptor.attributes = packed.attributes;
+    out->descriptor.topology = GEMeshTopology::Triangle;
+    out->descriptor.indexType = GEMeshIndexType::UInt32;
+    out->bounds = geMeshComputeBounds(packed.vertexData.data(), packed.vertexCount, stride);
+    if (diffuseTexture) {
+        out->textureBindings[diffuseSlot] = std::move(diffuseTexture);
+    }
+    return out;
+}
+
 _NAMESPACE_END_
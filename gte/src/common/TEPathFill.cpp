@@ -0,0 +1,728 @@
+#include "TEPathFill.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <set>
+
+namespace OmegaGTE::PathFill {
+
+namespace {
+
+/// A non-horizontal contour edge, stored top (y0) to bottom (y1). `winding`
+/// is +1 when the contour ran downward along it and -1 when it ran upward.
+struct Edge {
+    float x0, y0, x1, y1;
+    int winding;
+
+    float xAt(float y) const {
+        const float t = std::clamp((y - y0) / (y1 - y0), 0.f, 1.f);
+        return x0 + (x1 - x0) * t;
+    }
+
+    float slope() const {
+        return (x1 - x0) / (y1 - y0);
+    }
+};
+
+/// A horizontal contour edge. It bounds no span, but the winding of every
+/// gap it passes over changes at its y.
+struct Flat {
+    float y, x0, x1;
+};
+
+/// A y-monotone piece still being grown between two boundary edges. The
+/// chains hold only the points where a side changes edge, so each chain
+/// segment lies on one edge.
+struct Piece {
+    std::vector<GPoint2D> left, right;
+    int leftEdge = -1, rightEdge = -1;
+};
+
+/// The active edges in left-to-right order, kept as a treap. The order is
+/// combinatorial: it changes only where the sweep inserts, removes or swaps
+/// edges, never by re-comparing x, so edges that nearly touch cannot leave it
+/// inconsistent. Subtree sizes give each node's rank, which is how the
+/// changes at one event are grouped into contiguous windows.
+class ActiveEdges {
+public:
+    static constexpr int None = -1;
+
+    size_t size() const { return sizeOf(root); }
+    int edge(int node) const { return nodes[node].edge; }
+    int winding(int node) const { return nodes[node].winding; }
+    void setWinding(int node, int winding) { nodes[node].winding = winding; }
+    void swapEdges(int a, int b) { std::swap(nodes[a].edge, nodes[b].edge); }
+
+    /// Inserts `edge` just left of `before`, or last when `before` is None.
+    int insertBefore(int before, int edge) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        int node;
+        if (!unused.empty()) {
+            node = unused.back();
+            unused.pop_back();
+        } else {
+            node = int(nodes.size());
+            nodes.emplace_back();
+        }
+        nodes[node] = Node{None, None, None, seed, 1, edge, 0};
+        if (root == None) {
+            root = node;
+            return node;
+        }
+        int parent = before == None ? root : nodes[before].left;
+        if (parent == None) {
+            nodes[before].left = node;
+            parent = before;
+        } else {
+            while (nodes[parent].right != None) {
+                parent = nodes[parent].right;
+            }
+            nodes[parent].right = node;
+        }
+        nodes[node].parent = parent;
+        for (int n = parent; n != None; n = nodes[n].parent) {
+            ++nodes[n].size;
+        }
+        while (nodes[node].parent != None && nodes[nodes[node].parent].priority < nodes[node].priority) {
+            rotateUp(node);
+        }
+        return node;
+    }
+
+    void erase(int node) {
+        while (nodes[node].left != None && nodes[node].right != None) {
+            const int l = nodes[node].left, r = nodes[node].right;
+            rotateUp(nodes[l].priority > nodes[r].priority ? l : r);
+        }
+        const int child = nodes[node].left != None ? nodes[node].left : nodes[node].right;
+        const int parent = nodes[node].parent;
+        if (child != None) {
+            nodes[child].parent = parent;
+        }
+        replaceChild(parent, node, child);
+        for (int n = parent; n != None; n = nodes[n].parent) {
+            --nodes[n].size;
+        }
+        unused.push_back(node);
+    }
+
+    int next(int node) const {
+        if (nodes[node].right != None) {
+            node = nodes[node].right;
+            while (nodes[node].left != None) {
+                node = nodes[node].left;
+            }
+            return node;
+        }
+        while (nodes[node].parent != None && nodes[nodes[node].parent].right == node) {
+            node = nodes[node].parent;
+        }
+        return nodes[node].parent;
+    }
+
+    int prev(int node) const {
+        if (nodes[node].left != None) {
+            node = nodes[node].left;
+            while (nodes[node].right != None) {
+                node = nodes[node].right;
+            }
+            return node;
+        }
+        while (nodes[node].parent != None && nodes[nodes[node].parent].left == node) {
+            node = nodes[node].parent;
+        }
+        return nodes[node].parent;
+    }
+
+    /// Position of `node` from the left; None ranks after every node.
+    size_t rank(int node) const {
+        if (node == None) {
+            return size();
+        }
+        size_t r = sizeOf(nodes[node].left);
+        for (; nodes[node].parent != None; node = nodes[node].parent) {
+            if (nodes[nodes[node].parent].right == node) {
+                r += sizeOf(nodes[nodes[node].parent].left) + 1;
+            }
+        }
+        return r;
+    }
+
+    /// The node at position `r`, or None past the end.
+    int at(size_t r) const {
+        int node = root;
+        while (node != None) {
+            const size_t leftSize = sizeOf(nodes[node].left);
+            if (r < leftSize) {
+                node = nodes[node].left;
+            } else if (r == leftSize) {
+                return node;
+            } else {
+                r -= leftSize + 1;
+                node = nodes[node].right;
+            }
+        }
+        return None;
+    }
+
+    /// The leftmost node for which `reached` holds, given that it holds for
+    /// every node to the right of one that does; None if it holds for none.
+    template<class Pred>
+    int firstWhere(Pred reached) const {
+        int found = None;
+        for (int node = root; node != None;) {
+            if (reached(nodes[node].edge)) {
+                found = node;
+                node = nodes[node].left;
+            } else {
+                node = nodes[node].right;
+            }
+        }
+        return found;
+    }
+
+private:
+    struct Node {
+        int left, right, parent;
+        unsigned priority, size;
+        int edge, winding;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<int> unused;
+    int root = None;
+    unsigned seed = 0x9e3779b9u;
+
+    size_t sizeOf(int node) const { return node == None ? 0 : nodes[node].size; }
+
+    void replaceChild(int parent, int from, int to) {
+        if (parent == None) {
+            root = to;
+        } else if (nodes[parent].left == from) {
+            nodes[parent].left = to;
+        } else {
+            nodes[parent].right = to;
+        }
+    }
+
+    void rotateUp(int node) {
+        const int parent = nodes[node].parent;
+        if (nodes[parent].left == node) {
+            nodes[parent].left = nodes[node].right;
+            if (nodes[node].right != None) {
+                nodes[nodes[node].right].parent = parent;
+            }
+            nodes[node].right = parent;
+        } else {
+            nodes[parent].right = nodes[node].left;
+            if (nodes[node].left != None) {
+                nodes[nodes[node].left].parent = parent;
+            }
+            nodes[node].left = parent;
+        }
+        replaceChild(nodes[parent].parent, parent, node);
+        nodes[node].parent = nodes[parent].parent;
+        nodes[parent].parent = node;
+        nodes[parent].size = unsigned(1 + sizeOf(nodes[parent].left) + sizeOf(nodes[parent].right));
+        nodes[node].size = unsigned(1 + sizeOf(nodes[node].left) + sizeOf(nodes[node].right));
+    }
+};
+
+bool nearlySame(float a, float b, float eps) {
+    return std::fabs(a - b) <= eps;
+}
+
+float cross(const GPoint2D & o, const GPoint2D & a, const GPoint2D & b) {
+    return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+}
+
+float lengthSquared(const GPoint2D & a, const GPoint2D & b) {
+    return (b.x - a.x) * (b.x - a.x) + (b.y - a.y) * (b.y - a.y);
+}
+
+void emitTriangle(const GPoint2D & a, const GPoint2D & b, const GPoint2D & c,
+                  float eps, std::vector<GPoint2D> & out) {
+    // Collinear chain points can pair up into slivers of zero area; dropping
+    // them leaves no gap. The test is on the triangle's height over its
+    // longest edge, so small features of a large path survive.
+    const float longest = std::sqrt(std::max({lengthSquared(a, b), lengthSquared(b, c), lengthSquared(c, a)}));
+    if (std::fabs(cross(a, b, c)) <= eps * longest) {
+        return;
+    }
+    out.push_back(a);
+    out.push_back(b);
+    out.push_back(c);
+}
+
+/// Triangulate a closed y-monotone piece with the stack algorithm: merge both
+/// chains top to bottom, then cut off every ear the sweep makes visible.
+void triangulatePiece(const Piece & piece, float eps, std::vector<GPoint2D> & out) {
+    struct Vertex {
+        GPoint2D pt;
+        bool onLeft;
+    };
+
+    const auto & L = piece.left;
+    const auto & R = piece.right;
+    const size_t rightBegin = (nearlySame(L.front().x, R.front().x, eps) && nearlySame(L.front().y, R.front().y, eps)) ? 1 : 0;
+    size_t rightEnd = R.size();
+    if (rightEnd > rightBegin && nearlySame(L.back().x, R.back().x, eps) && nearlySame(L.back().y, R.back().y, eps)) {
+        --rightEnd;
+    }
+
+    std::vector<Vertex> sorted;
+    sorted.reserve(L.size() + R.size());
+    size_t i = 0, j = rightBegin;
+    while (i < L.size() || j < rightEnd) {
+        const bool takeLeft = j >= rightEnd ||
+            (i < L.size() && (L[i].y < R[j].y || (L[i].y == R[j].y && L[i].x <= R[j].x)));
+        if (takeLeft) {
+            sorted.push_back({L[i++], true});
+        } else {
+            sorted.push_back({R[j++], false});
+        }
+    }
+    const size_t n = sorted.size();
+    if (n < 3) {
+        return;
+    }
+
+    std::vector<size_t> stack {0, 1};
+    for (size_t k = 2; k + 1 < n; ++k) {
+        if (sorted[k].onLeft != sorted[stack.back()].onLeft) {
+            // Opposite chain: everything on the stack is visible from k.
+            const size_t previous = stack.back();
+            for (size_t s = 0; s + 1 < stack.size(); ++s) {
+                emitTriangle(sorted[k].pt, sorted[stack[s]].pt, sorted[stack[s + 1]].pt, eps, out);
+            }
+            stack.assign({previous, k});
+            continue;
+        }
+        // Same chain: cut ears while the diagonal from k stays inside.
+        size_t last = stack.back();
+        stack.pop_back();
+        while (!stack.empty()) {
+            const float turn = cross(sorted[stack.back()].pt, sorted[k].pt, sorted[last].pt);
+            const bool inside = sorted[k].onLeft ? (turn > 0.f) : (turn < 0.f);
+            if (!inside) {
+                break;
+            }
+            emitTriangle(sorted[k].pt, sorted[last].pt, sorted[stack.back()].pt, eps, out);
+            last = stack.back();
+            stack.pop_back();
+        }
+        stack.push_back(last);
+        stack.push_back(k);
+    }
+    for (size_t s = 0; s + 1 < stack.size(); ++s) {
+        emitTriangle(sorted[n - 1].pt, sorted[stack[s]].pt, sorted[stack[s + 1]].pt, eps, out);
+    }
+}
+
+/// One change at the current event and the x range it covers: an edge
+/// ending or starting, two neighbours swapping at their crossing, or a flat.
+struct Change {
+    float x0, x1;
+    int edge = -1;
+    int partner = -1;
+    bool starts = false;
+};
+
+/// The sweep itself. Each event touches only the edges around its changes:
+/// they are grouped into windows of consecutive active edges, each window is
+/// re-ordered and re-wound on its own, and the spans it holds are matched
+/// against the pieces that were open over it. Crossings are found by testing
+/// the pairs of edges that become neighbours.
+class Sweep {
+public:
+    Sweep(std::vector<Edge> edgeList, std::vector<Flat> flatList, TEFillRule fillRule, float tolerance,
+          std::vector<GPoint2D> & triangles)
+        : edges(std::move(edgeList)), flats(std::move(flatList)), rule(fillRule), eps(tolerance), out(triangles),
+          nodeOf(edges.size(), ActiveEdges::None), leftPiece(edges.size(), -1) {
+        std::sort(edges.begin(), edges.end(), [](const Edge & a, const Edge & b) { return a.y0 < b.y0; });
+        std::sort(flats.begin(), flats.end(), [](const Flat & a, const Flat & b) { return a.y < b.y; });
+        byEnd.resize(edges.size());
+        for (size_t i = 0; i < edges.size(); ++i) {
+            byEnd[i] = int(i);
+            events.insert(edges[i].y0);
+            events.insert(edges[i].y1);
+        }
+        std::sort(byEnd.begin(), byEnd.end(), [&](int a, int b) { return edges[a].y1 < edges[b].y1; });
+    }
+
+    void run() {
+        float y = 0.f;
+        while (!events.empty()) {
+            y = *events.begin();
+            events.erase(events.begin());
+            processEvent(y);
+        }
+        // Every edge has ended by the last event, which closes every piece;
+        // this only guards against a piece left open by a tolerance miss.
+        for (size_t index = 0; index < pieces.size(); ++index) {
+            if (pieces[index].leftEdge >= 0) {
+                closePiece(int(index), y);
+            }
+        }
+    }
+
+private:
+    struct SpanEdges {
+        int left, right;
+    };
+
+    struct Window {
+        size_t lo, hi;
+        std::vector<size_t> changes;
+    };
+
+    std::vector<Edge> edges;
+    std::vector<Flat> flats;
+    const TEFillRule rule;
+    const float eps;
+    std::vector<GPoint2D> & out;
+
+    ActiveEdges active;
+    std::vector<int> nodeOf;
+    /// The open piece each edge bounds on its left side, or -1.
+    std::vector<int> leftPiece;
+    std::vector<Piece> pieces;
+    std::vector<int> unusedPieces;
+
+    std::set<float> events;
+    std::multimap<float, std::pair<int, int>> crossings;
+    std::vector<int> byEnd;
+    size_t nextStart = 0, nextEnd = 0, nextFlat = 0;
+
+    std::vector<Change> changes;
+    std::vector<Window> windows;
+    std::vector<int> oldPieces, kept, starting, order;
+    std::vector<SpanEdges> spans;
+    std::vector<bool> continued;
+
+    bool inside(int winding) const {
+        return rule == TEFillRule::EvenOdd ? (winding & 1) != 0 : winding != 0;
+    }
+
+    float xAt(int edge, float y) const {
+        return edges[edge].xAt(y);
+    }
+
+    void processEvent(float y) {
+        changes.clear();
+        while (nextEnd < byEnd.size() && edges[byEnd[nextEnd]].y1 <= y) {
+            const int e = byEnd[nextEnd++];
+            changes.push_back(Change{edges[e].x1, edges[e].x1, e});
+        }
+        const auto due = crossings.equal_range(y);
+        for (auto it = due.first; it != due.second; ++it) {
+            const int a = it->second.first, b = it->second.second;
+            // Pairs that stopped being neighbours since are stale.
+            if (nodeOf[a] != ActiveEdges::None && nodeOf[b] != ActiveEdges::None &&
+                active.next(nodeOf[a]) == nodeOf[b]) {
+                const float x = 0.5f * (xAt(a, y) + xAt(b, y));
+                changes.push_back(Change{x, x, a, b});
+            }
+        }
+        crossings.erase(due.first, due.second);
+        while (nextStart < edges.size() && edges[nextStart].y0 <= y) {
+            const int e = int(nextStart++);
+            changes.push_back(Change{edges[e].x0, edges[e].x0, e, -1, true});
+        }
+        while (nextFlat < flats.size() && flats[nextFlat].y <= y) {
+            if (flats[nextFlat].y == y) {
+                changes.push_back(Change{flats[nextFlat].x0, flats[nextFlat].x1});
+            }
+            ++nextFlat;
+        }
+        if (changes.empty()) {
+            return;
+        }
+
+        // Each change covers the active edges within eps of its x range, plus
+        // the edges it names. Overlapping or touching ranges form one window,
+        // so windows are separated by at least one edge the event leaves
+        // alone, and the winding just right of that edge is unchanged.
+        windows.clear();
+        for (size_t c = 0; c < changes.size(); ++c) {
+            const Change & change = changes[c];
+            size_t lo = active.rank(active.firstWhere([&](int e) { return xAt(e, y) >= change.x0 - eps; }));
+            size_t hi = active.rank(active.firstWhere([&](int e) { return xAt(e, y) > change.x1 + eps; }));
+            if (!change.starts && change.edge >= 0) {
+                const size_t r = active.rank(nodeOf[change.edge]);
+                lo = std::min(lo, r);
+                hi = std::max(hi, r + (change.partner >= 0 ? 2 : 1));
+            }
+            windows.push_back(Window{lo, hi, {c}});
+        }
+        std::sort(windows.begin(), windows.end(), [](const Window & a, const Window & b) { return a.lo < b.lo; });
+        size_t merged = 0;
+        for (size_t w = 1; w < windows.size(); ++w) {
+            if (windows[w].lo <= windows[merged].hi) {
+                windows[merged].hi = std::max(windows[merged].hi, windows[w].hi);
+                windows[merged].changes.insert(windows[merged].changes.end(), windows[w].changes.begin(),
+                                               windows[w].changes.end());
+            } else if (++merged != w) {
+                windows[merged] = std::move(windows[w]);
+            }
+        }
+        windows.resize(merged + 1);
+
+        // Resolve every window's bounding edges before any window changes the
+        // ranks; the bounding edges themselves are never touched.
+        std::vector<std::pair<int, int>> bounds;
+        bounds.reserve(windows.size());
+        for (const auto & window : windows) {
+            bounds.emplace_back(window.lo > 0 ? active.at(window.lo - 1) : ActiveEdges::None, active.at(window.hi));
+        }
+        for (size_t w = 0; w < windows.size(); ++w) {
+            processWindow(bounds[w].first, bounds[w].second, windows[w].changes, y);
+        }
+    }
+
+    /// Rebuild the active edges strictly between `before` and `after` (None
+    /// for either end of the list) for the event at `y`.
+    void processWindow(int before, int after, const std::vector<size_t> & windowChanges, float y) {
+        // The open pieces over the window, left to right. When the gap right
+        // of `before` is filled, the first one starts at or left of it.
+        oldPieces.clear();
+        int enclosingLeft = -1, enclosingRight = -1;
+        if (before != ActiveEdges::None && inside(active.winding(before))) {
+            int node = before;
+            while (node != ActiveEdges::None && leftPiece[active.edge(node)] < 0) {
+                node = active.prev(node);
+            }
+            if (node != ActiveEdges::None) {
+                oldPieces.push_back(leftPiece[active.edge(node)]);
+                enclosingLeft = pieces[oldPieces.back()].leftEdge;
+            }
+        }
+        const int first = before == ActiveEdges::None ? active.at(0) : active.next(before);
+        int lastWinding = before == ActiveEdges::None ? 0 : active.winding(before);
+        for (int node = first; node != after; node = active.next(node)) {
+            if (leftPiece[active.edge(node)] >= 0) {
+                oldPieces.push_back(leftPiece[active.edge(node)]);
+            }
+            lastWinding = active.winding(node);
+        }
+        // Likewise the last one ends at or right of `after` when the gap left
+        // of it is filled; the event cannot change that gap's winding.
+        if (inside(lastWinding) && !oldPieces.empty()) {
+            enclosingRight = pieces[oldPieces.back()].rightEdge;
+        }
+
+        // Swap crossing pairs, drop ended edges, and merge in the new ones by
+        // where they start, breaking ties by the direction they leave in.
+        for (size_t c : windowChanges) {
+            const Change & change = changes[c];
+            if (change.partner >= 0) {
+                const int a = nodeOf[change.edge], b = nodeOf[change.partner];
+                if (active.next(a) == b) {
+                    active.swapEdges(a, b);
+                    std::swap(nodeOf[change.edge], nodeOf[change.partner]);
+                }
+            }
+        }
+        kept.clear();
+        for (int node = first; node != after;) {
+            const int following = active.next(node);
+            const int e = active.edge(node);
+            if (edges[e].y1 > y) {
+                kept.push_back(e);
+            }
+            nodeOf[e] = ActiveEdges::None;
+            active.erase(node);
+            node = following;
+        }
+        starting.clear();
+        for (size_t c : windowChanges) {
+            if (changes[c].starts) {
+                starting.push_back(changes[c].edge);
+            }
+        }
+        std::sort(starting.begin(), starting.end(), [&](int a, int b) {
+            return edges[a].x0 != edges[b].x0 ? edges[a].x0 < edges[b].x0 : edges[a].slope() < edges[b].slope();
+        });
+        order.clear();
+        for (size_t i = 0, j = 0; i < kept.size() || j < starting.size();) {
+            bool takeStarting = j < starting.size();
+            if (takeStarting && i < kept.size()) {
+                const float x = xAt(kept[i], y), start = edges[starting[j]].x0;
+                takeStarting = x > start + eps || (x >= start - eps && edges[kept[i]].slope() > edges[starting[j]].slope());
+            }
+            order.push_back(takeStarting ? starting[j++] : kept[i++]);
+        }
+
+        int winding = before == ActiveEdges::None ? 0 : active.winding(before);
+        for (int e : order) {
+            nodeOf[e] = active.insertBefore(after, e);
+            winding += edges[e].winding;
+            active.setWinding(nodeOf[e], winding);
+        }
+
+        // The spans the window now holds.
+        spans.clear();
+        bool filledGap = enclosingLeft >= 0;
+        int spanLeft = enclosingLeft;
+        for (int e : order) {
+            const bool nowFilled = inside(active.winding(nodeOf[e]));
+            if (!filledGap && nowFilled) {
+                spanLeft = e;
+            } else if (filledGap && !nowFilled) {
+                spans.push_back(SpanEdges{spanLeft, e});
+            }
+            filledGap = nowFilled;
+        }
+        if (filledGap && enclosingRight >= 0) {
+            spans.push_back(SpanEdges{spanLeft, enclosingRight});
+        }
+
+        // Continue a piece only when its span starts exactly where the piece
+        // ends; a split, merge or pinch closes it instead.
+        for (int index : oldPieces) {
+            leftPiece[pieces[index].leftEdge] = -1;
+        }
+        continued.assign(oldPieces.size(), false);
+        size_t above = 0;
+        for (const auto & span : spans) {
+            const float topLeft = xAt(span.left, y), topRight = xAt(span.right, y);
+            while (above < oldPieces.size() && (xAt(pieces[oldPieces[above]].leftEdge, y) < topLeft - eps ||
+                                                xAt(pieces[oldPieces[above]].rightEdge, y) < topRight - eps)) {
+                ++above;
+            }
+            if (above < oldPieces.size() && topRight - topLeft > eps) {
+                Piece & piece = pieces[oldPieces[above]];
+                if (nearlySame(xAt(piece.leftEdge, y), topLeft, eps) &&
+                    nearlySame(xAt(piece.rightEdge, y), topRight, eps)) {
+                    if (piece.leftEdge != span.left) {
+                        piece.left.push_back(GPoint2D{topLeft, y});
+                    }
+                    if (piece.rightEdge != span.right) {
+                        piece.right.push_back(GPoint2D{topRight, y});
+                    }
+                    piece.leftEdge = span.left;
+                    piece.rightEdge = span.right;
+                    leftPiece[span.left] = oldPieces[above];
+                    continued[above++] = true;
+                    continue;
+                }
+            }
+            int index;
+            if (!unusedPieces.empty()) {
+                index = unusedPieces.back();
+                unusedPieces.pop_back();
+            } else {
+                index = int(pieces.size());
+                pieces.emplace_back();
+            }
+            Piece & piece = pieces[index];
+            piece.left.assign(1, GPoint2D{topLeft, y});
+            piece.right.assign(1, GPoint2D{topRight, y});
+            piece.leftEdge = span.left;
+            piece.rightEdge = span.right;
+            leftPiece[span.left] = index;
+        }
+        for (size_t k = 0; k < oldPieces.size(); ++k) {
+            if (!continued[k]) {
+                closePiece(oldPieces[k], y);
+            }
+        }
+
+        // Only pairs that just became neighbours can newly cross.
+        int left = before;
+        for (int e : order) {
+            if (left != ActiveEdges::None) {
+                scheduleCrossing(active.edge(left), e, y);
+            }
+            left = nodeOf[e];
+        }
+        if (left != ActiveEdges::None && after != ActiveEdges::None) {
+            scheduleCrossing(active.edge(left), active.edge(after), y);
+        }
+    }
+
+    /// Queue the point below `y` where `left` and its right neighbour `right`
+    /// swap places, if they do before either ends. Crossings within eps of
+    /// either end are ties, not swaps.
+    void scheduleCrossing(int left, int right, float y) {
+        const float end = std::min(edges[left].y1, edges[right].y1);
+        if (end <= y) {
+            return;
+        }
+        const float gapTop = xAt(right, y) - xAt(left, y);
+        const float gapBottom = xAt(right, end) - xAt(left, end);
+        if (gapBottom >= -eps) {
+            return;
+        }
+        const float t = gapTop > 0.f ? gapTop / (gapTop - gapBottom) : 0.f;
+        const float crossing = std::max(y + (end - y) * t, std::nextafter(y, std::numeric_limits<float>::infinity()));
+        if (crossing >= end - eps) {
+            return;
+        }
+        events.insert(crossing);
+        crossings.emplace(crossing, std::make_pair(left, right));
+    }
+
+    void closePiece(int index, float y) {
+        Piece & piece = pieces[index];
+        piece.left.push_back(GPoint2D{xAt(piece.leftEdge, y), y});
+        piece.right.push_back(GPoint2D{xAt(piece.rightEdge, y), y});
+        triangulatePiece(piece, eps, out);
+        piece.left.clear();
+        piece.right.clear();
+        piece.leftEdge = piece.rightEdge = -1;
+        unusedPieces.push_back(index);
+    }
+};
+
+}  // namespace
+
+void tessellate(const std::vector<std::vector<GPoint2D>> & contours,
+                TEFillRule rule,
+                std::vector<GPoint2D> & triangles) {
+    std::vector<Edge> edges;
+    std::vector<Flat> flats;
+    float minX = 0.f, maxX = 0.f, minY = 0.f, maxY = 0.f;
+    bool haveBounds = false;
+    for (const auto & contour : contours) {
+        if (contour.size() < 3) {
+            continue;
+        }
+        for (size_t i = 0; i < contour.size(); ++i) {
+            const GPoint2D & a = contour[i];
+            const GPoint2D & b = contour[(i + 1) % contour.size()];
+            if (!haveBounds) {
+                minX = maxX = a.x;
+                minY = maxY = a.y;
+                haveBounds = true;
+            }
+            minX = std::min(minX, a.x); maxX = std::max(maxX, a.x);
+            minY = std::min(minY, a.y); maxY = std::max(maxY, a.y);
+            if (a.y == b.y) {
+                if (a.x != b.x) {
+                    flats.push_back(Flat{a.y, std::min(a.x, b.x), std::max(a.x, b.x)});
+                }
+                continue;
+            }
+            if (a.y < b.y) {
+                edges.push_back(Edge{a.x, a.y, b.x, b.y, 1});
+            } else {
+                edges.push_back(Edge{b.x, b.y, a.x, a.y, -1});
+            }
+        }
+    }
+    if (edges.size() < 2) {
+        return;
+    }
+
+    // Tolerances scale with the path so device-space and unit-space paths
+    // behave alike.
+    const float extent = std::max({maxX - minX, maxY - minY, 1e-6f});
+    Sweep(std::move(edges), std::move(flats), rule, extent * 1e-6f, triangles).run();
+}
+
+}  // namespace OmegaGTE::PathFill
@@ -0,0 +1,34 @@
+#ifndef OMEGAGTE_TEPATHFILL_H
+#define OMEGAGTE_TEPATHFILL_H
+
+#include <vector>
+
+#include "omegaGTE/TE.h"
+
+namespace OmegaGTE::PathFill {
+
+// Sweep-line fill tessellator behind TRIANGULATE_GRAPHICSPATH2D's fill.
+//
+// Every contour is treated as closed. Edges are swept top to bottom through
+// events at vertex y's and at the edge crossings found on the way, so
+// self-intersecting and overlapping contours need no pre-pass. The active
+// edges stay ordered in a balanced tree across events: an event only
+// re-orders and re-winds the edges around its own changes, and only edges
+// that become neighbours are tested for crossings. Spans that `rule` fills
+// grow y-monotone pieces, which are triangulated with the linear stack
+// algorithm when they close. Holes and multiple contours fall out of the
+// winding walk, so no contour needs a particular orientation.
+//
+// That makes a fill O((n + k) log n) for n edges and k crossings, plus the
+// filled edges passed over when an event lands inside an overlap region to
+// find the piece enclosing it.
+//
+// `triangles` receives three points per triangle, in no particular winding;
+// callers normalize winding themselves (TE does it in finalizeFlat).
+void tessellate(const std::vector<std::vector<GPoint2D>> & contours,
+                TEFillRule rule,
+                std::vector<GPoint2D> & triangles);
+
+}  // namespace OmegaGTE::PathFill
+
+#endif
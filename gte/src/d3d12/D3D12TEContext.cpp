@@ -106,7 +106,7 @@ struct D3D12TessPipelines {
 
 std::future<TETriangulationResult> d3d12GpuDispatch(
         OmegaTriangulationEngineContext::GPUTriangulationExtractedParams &ep,
-        GEViewport &vp, float ctxArcStep, D3D12TessPipelines &pip,
+        GEViewport &vp, D3D12TessPipelines &pip,
         OmegaTriangulationEngineContext *ctx,
         const TETriangulationParams &origParams,
         GTEPolygonFrontFaceRotation ff, GEViewport *origVP) {
@@ -163,7 +163,7 @@ std::future<TETriangulationResult> d3d12GpuDispatch(
         }
         case ET::Ellipsoid: {
             pso = pip.ellip.Get();
-            float step = ctxArcStep > 0 ? ctxArcStep : 0.01f;
+            float step = ep.arcStep;
             unsigned segs = (unsigned)std::ceil(2.f * M_PI / step);
             vc = segs * 3; tc = segs;
             tp = {{ep.ex,ep.ey,0,0},{vp.x,vp.y,vp.width,vp.height},{cv[0],cv[1],cv[2],cv[3]},{ep.erad_x,ep.erad_y,step,(float)segs},{localSpace,vp.nearDepth,vp.farDepth,swapFlat}};
@@ -382,12 +382,12 @@ public:
         GPUTriangulationExtractedParams ep;
         extractGPUTriangulationParams(params, ep);
         GEViewport vp = resolveViewport(params, viewport);
-        return d3d12GpuDispatch(ep, vp, arcStep, pip, this, params, direction, viewport);
+        return d3d12GpuDispatch(ep, vp, pip, this, params, direction, viewport);
     }
 
     explicit D3D12NativeRenderTargetTEContext(const SharedHandle<GED3D12NativeRenderTarget> &target)
         : target(target) {}
-    ~D3D12NativeRenderTargetTEContext() override = default;
+    ~D3D12NativeRenderTargetTEContext() override { waitForPendingJobs(); }
 };
 
 class D3D12TextureRenderTargetTEContext : public OmegaTriangulationEngineContext {
@@ -422,13 +422,13 @@ public:
         GPUTriangulationExtractedParams ep;
         extractGPUTriangulationParams(params, ep);
         GEViewport vp = resolveViewport(params, viewport);
-        return d3d12GpuDispatch(ep, vp, arcStep, pip, this, params, direction, viewport);
+        return d3d12GpuDispatch(ep, vp, pip, this, params, direction, viewport);
     }
 
     explicit D3D12TextureRenderTargetTEContext(const SharedHandle<GED3D12TextureRenderTarget> &target,
                                                 SharedHandle<GECommandQueue> queue)
         : target(target), queue(std::move(queue)) {}
-    ~D3D12TextureRenderTargetTEContext() override = default;
+    ~D3D12TextureRenderTargetTEContext() override { waitForPendingJobs(); }
 };
 
 SharedHandle<OmegaTriangulationEngineContext> CreateNativeRenderTargetTEContext(SharedHandle<GENativeRenderTarget> &renderTarget) {
@@ -77,7 +77,7 @@ struct Pipelines {
 
 std::future<TETriangulationResult> gpuDispatch(
         OmegaTriangulationEngineContext::GPUTriangulationExtractedParams &ep,
-        GEViewport &vp, float ctxArcStep, Pipelines &pip,
+        GEViewport &vp, Pipelines &pip,
         OmegaTriangulationEngineContext *ctx,
         const TETriangulationParams &origParams,
         GTEPolygonFrontFaceRotation ff, GEViewport *origVP) {
@@ -130,7 +130,7 @@ std::future<TETriangulationResult> gpuDispatch(
         }
         case ET::Ellipsoid: {
             pso = pip.ellip;
-            float step = ctxArcStep > 0 ? ctxArcStep : 0.01f;
+            float step = ep.arcStep;
             unsigned segs = (unsigned)std::ceil(2.f * M_PI / step);
             vc = segs * 3; tc = segs;
             MetalTessParams tp{{ep.ex,ep.ey,0,0},{vp.x,vp.y,vp.width,vp.height},cv,{ep.erad_x,ep.erad_y,step,(float)segs},{localSpace,vp.nearDepth,vp.farDepth,swapFlat}};
@@ -210,7 +210,7 @@ public:
         }
         GPUTriangulationExtractedParams ep; extractGPUTriangulationParams(params, ep);
         GEViewport vp = resolveViewport(params, viewport);
-        return gpuDispatch(ep, vp, arcStep, pip, this, params, ff, viewport);
+        return gpuDispatch(ep, vp, pip, this, params, ff, viewport);
     }
     GEViewport getEffectiveViewport() override {
         if(target != nullptr){
@@ -232,6 +232,7 @@ public:
         translateCoordsDefaultImpl(x,y,z,&vp,xr,yr,zr);
     }
     MetalNativeRenderTargetTEContext(SharedHandle<GEMetalNativeRenderTarget> t) : target(t) {}
+    ~MetalNativeRenderTargetTEContext() override { waitForPendingJobs(); }
 };
 
 class MetalTextureRenderTargetTEContext : public OmegaTriangulationEngineContext {
@@ -247,7 +248,7 @@ public:
         }
         GPUTriangulationExtractedParams ep; extractGPUTriangulationParams(params, ep);
         GEViewport vp = resolveViewport(params, viewport);
-        return gpuDispatch(ep, vp, arcStep, pip, this, params, ff, viewport);
+        return gpuDispatch(ep, vp, pip, this, params, ff, viewport);
     }
     GEViewport getEffectiveViewport() override {
         if(target != nullptr){
@@ -269,6 +270,7 @@ public:
     }
     MetalTextureRenderTargetTEContext(SharedHandle<GEMetalTextureRenderTarget> t,
                                        SharedHandle<GECommandQueue> q) : target(std::move(t)), queue(std::move(q)) {}
+    ~MetalTextureRenderTargetTEContext() override { waitForPendingJobs(); }
 };
 
 
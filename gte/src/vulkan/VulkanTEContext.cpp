@@ -203,7 +203,7 @@ struct VulkanTessPipelines {
 
 std::future<TETriangulationResult> vulkanGpuDispatch(
         OmegaTriangulationEngineContext::GPUTriangulationExtractedParams &ep,
-        GEViewport &vp, float ctxArcStep, VulkanTessPipelines &pip,
+        GEViewport &vp, VulkanTessPipelines &pip,
         OmegaTriangulationEngineContext *ctx,
         const TETriangulationParams &origParams,
         GTEPolygonFrontFaceRotation ff, GEViewport *origVP) {
@@ -260,7 +260,7 @@ std::future<TETriangulationResult> vulkanGpuDispatch(
         }
         case ET::Ellipsoid: {
             kernel = &pip.ellip;
-            float step = ctxArcStep > 0 ? ctxArcStep : 0.01f;
+            float step = ep.arcStep;
             unsigned segs = (unsigned)std::ceil(2.f * M_PI / step);
             vc = segs * 3; tc = segs;
             tp = {{ep.ex,ep.ey,0,0},{vp.x,vp.y,vp.width,vp.height},{cv[0],cv[1],cv[2],cv[3]},{ep.erad_x,ep.erad_y,step,(float)segs},{localSpace,vp.nearDepth,vp.farDepth,swapFlat}};
@@ -453,10 +453,11 @@ public:
         GPUTriangulationExtractedParams ep;
         extractGPUTriangulationParams(params, ep);
         GEViewport vp = resolveViewport(params, viewport);
-        return vulkanGpuDispatch(ep, vp, arcStep, pip, this, params, direction, viewport);
+        return vulkanGpuDispatch(ep, vp, pip, this, params, direction, viewport);
     }
 
     explicit VulkanNativeRenderTargetTEContext(SharedHandle<GEVulkanNativeRenderTarget> renderTarget):renderTarget(renderTarget){};
+    ~VulkanNativeRenderTargetTEContext() override { waitForPendingJobs(); }
 };
 
 class VulkanTextureRenderTargetTEContext : public OmegaTriangulationEngineContext {
@@ -507,12 +508,13 @@ public:
         GPUTriangulationExtractedParams ep;
         extractGPUTriangulationParams(params, ep);
         GEViewport vp = resolveViewport(params, viewport);
-        return vulkanGpuDispatch(ep, vp, arcStep, pip, this, params, direction, viewport);
+        return vulkanGpuDispatch(ep, vp, pip, this, params, direction, viewport);
     }
 
     explicit VulkanTextureRenderTargetTEContext(SharedHandle<GEVulkanTextureRenderTarget> renderTarget,
                                                  SharedHandle<GEVulkanCommandQueue> commandQueue):
     renderTarget(std::move(renderTarget)), commandQueue(std::move(commandQueue)) {};
+    ~VulkanTextureRenderTargetTEContext() override { waitForPendingJobs(); }
 };
 
 
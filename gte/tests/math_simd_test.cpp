@@ -0,0 +1,179 @@
+/// Backend-independent unit test for the float fast paths in GTEMath.h
+/// (GTEMathSIMD.h kernels) and the batch `transformPoints`. Pure CPU.
+///
+/// Every operator is checked against a plain loop over the storage that
+/// mirrors the generic `Matrix` code, so the vector paths are held to the
+/// scalar results. Build with `-DOMEGAGTE_NO_SIMD` to run the same checks
+/// against the scalar fallback.
+
+#include <omegaGTE/GTEMath.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using namespace OmegaGTE;
+
+namespace {
+
+/// Deterministic, sign-mixed test values.
+float value(unsigned seed) {
+    return float(int((seed * 2654435761u) >> 20) - 2048) / 97.f;
+}
+
+template<unsigned C, unsigned R>
+FMatrix<C, R> filled(unsigned seed) {
+    auto m = FMatrix<C, R>::Create();
+    for (unsigned c = 0; c < C; ++c)
+        for (unsigned r = 0; r < R; ++r)
+            m[c][r] = value(seed + c * R + r);
+    return m;
+}
+
+template<unsigned C, unsigned R, class Fn>
+bool matchesElementwise(const FMatrix<C, R> &got, Fn expected) {
+    for (unsigned c = 0; c < C; ++c)
+        for (unsigned r = 0; r < R; ++r)
+            if (got[c][r] != expected(c, r)) return false;
+    return true;
+}
+
+bool near(float a, float b) {
+    return std::fabs(a - b) <= 1e-5f * std::max(1.f, std::fabs(b));
+}
+
+/// Elementwise operators, on 4-wide shapes and on the odd ones the kernels
+/// leave to their scalar loops.
+template<unsigned C, unsigned R>
+void checkElementwise() {
+    const auto a = filled<C, R>(1), b = filled<C, R>(100);
+    assert((matchesElementwise<C, R>(a + b, [&](unsigned c, unsigned r) { return a[c][r] + b[c][r]; })));
+    assert((matchesElementwise<C, R>(a - b, [&](unsigned c, unsigned r) { return a[c][r] - b[c][r]; })));
+    assert((matchesElementwise<C, R>(a * 0.37f, [&](unsigned c, unsigned r) { return a[c][r] * 0.37f; })));
+    assert((matchesElementwise<C, R>(0.37f * a, [&](unsigned c, unsigned r) { return a[c][r] * 0.37f; })));
+
+    auto acc = a;
+    acc += b;
+    assert(acc == a + b);
+    acc -= b;
+    assert((matchesElementwise<C, R>(acc, [&](unsigned c, unsigned r) { return (a[c][r] + b[c][r]) - b[c][r]; })));
+    acc *= -2.f;
+    assert((matchesElementwise<C, R>(acc, [&](unsigned c, unsigned r) { return ((a[c][r] + b[c][r]) - b[c][r]) * -2.f; })));
+}
+
+}  // namespace
+
+int main() {
+    // --- Layout: the kernels change no type's size or alignment. -------------
+    {
+        static_assert(alignof(FMatrix<4, 4>) == alignof(float) && sizeof(FMatrix<4, 4>) == 64, "");
+        static_assert(alignof(FVec<4>) == alignof(float) && sizeof(FVec<4>) == 16, "");
+        static_assert(sizeof(FVec<3>) == 12 && "FVec<3> stays packed");
+        static_assert(sizeof(FVec<2>) == 8 && sizeof(DMatrix<4, 4>) == 128, "");
+        static_assert(alignof(FQuaternion) == alignof(float) && sizeof(FQuaternion) == 16, "");
+    }
+
+    // --- Elementwise operators. -----------------------------------------------
+    {
+        checkElementwise<4, 4>();
+        checkElementwise<4, 1>();
+        checkElementwise<3, 1>();
+        checkElementwise<3, 3>();
+        checkElementwise<2, 1>();
+
+        // A 3-vector op must not touch the float after it.
+        struct { FVec<3> v; float guard; } packed{filled<3, 1>(5), 42.f};
+        packed.v += filled<3, 1>(9);
+        packed.v *= 3.f;
+        assert(packed.guard == 42.f);
+    }
+
+    // --- 4x4 product follows the raw-storage definition of operator*. --------
+    {
+        const auto a = filled<4, 4>(7), b = filled<4, 4>(300);
+        const auto p = a * b;
+        for (unsigned i = 0; i < 4; ++i)
+            for (unsigned j = 0; j < 4; ++j) {
+                float sum = 0.f;
+                for (unsigned k = 0; k < 4; ++k) sum += a[i][k] * b[k][j];
+                assert(near(p[i][j], sum));
+            }
+
+        // And it still composes the builders in the documented order.
+        const auto euler = rotationEuler(0.3f, -1.1f, 2.f);
+        const auto composed = rotationX(0.3f) * rotationY(-1.1f) * rotationZ(2.f);
+        assert(euler == composed);
+        const auto id = FMatrix<4, 4>::Identity();
+        assert(a * id == a && id * a == a);
+    }
+
+    // --- transformPoint: column-major, with the homogeneous divide. ----------
+    {
+        const auto m = translationMatrix(3.f, -2.f, 1.f) * rotationZ(0.7f);
+        const GPoint3D pt{1.5f, -4.f, 2.25f};
+        float expect[4] = {0.f, 0.f, 0.f, 0.f};
+        const float p[4] = {pt.x, pt.y, pt.z, 1.f};
+        for (unsigned r = 0; r < 4; ++r)
+            for (unsigned c = 0; c < 4; ++c) expect[r] += m[c][r] * p[c];
+        const auto got = transformPoint(m, pt);
+        assert(near(got.x, expect[0]) && near(got.y, expect[1]) && near(got.z, expect[2]));
+
+        const auto proj = perspectiveProjection(1.f, 1.5f, 0.1f, 100.f);
+        const auto projected = transformPoint(proj, GPoint3D{2.f, 1.f, -10.f});
+        const auto clip = proj.data();
+        const float w = clip[3] * 2.f + clip[7] * 1.f + clip[11] * -10.f + clip[15];
+        assert(near(projected.x, (clip[0] * 2.f + clip[4] * 1.f + clip[8] * -10.f + clip[12]) / w));
+    }
+
+    // --- Batch transformPoints matches transformPoint exactly. ---------------
+    {
+        const auto matrices = {rotationEuler(0.4f, 1.2f, -0.5f) * translationMatrix(10.f, 20.f, -5.f),
+                               perspectiveProjection(0.9f, 1.25f, 0.5f, 50.f), FMatrix<4, 4>::Identity()};
+        for (const auto &m : matrices) {
+            for (size_t count : {size_t(0), size_t(1), size_t(2), size_t(7), size_t(1000)}) {
+                std::vector<GPoint3D> in(count), out(count);
+                for (size_t i = 0; i < count; ++i) {
+                    in[i] = GPoint3D{value(unsigned(i * 3)), value(unsigned(i * 3 + 1)), value(unsigned(i * 3 + 2))};
+                }
+                transformPoints(m, OmegaCommon::Span<const GPoint3D>(in.data(), in.size()),
+                                OmegaCommon::Span<GPoint3D>(out.data(), out.size()));
+                for (size_t i = 0; i < count; ++i) {
+                    const auto want = transformPoint(m, in[i]);
+                    assert(out[i].x == want.x && out[i].y == want.y && out[i].z == want.z);
+                }
+
+                transformPoints(m, OmegaCommon::Span<GPoint3D>(in.data(), in.size()));
+                for (size_t i = 0; i < count; ++i) {
+                    assert(in[i].x == out[i].x && in[i].y == out[i].y && in[i].z == out[i].z && "in place");
+                }
+            }
+        }
+    }
+
+    // --- Quaternions and cross products. --------------------------------------
+    {
+        const FQuaternion a = FQuaternion::fromAxisAngle(0.f, 0.6f, 0.8f, 1.3f);
+        const FQuaternion b{value(11), value(12), value(13), value(14)};
+        const auto q = a * b;
+        assert(near(q.x, a.w*b.x + a.x*b.w + a.y*b.z - a.z*b.y));
+        assert(near(q.y, a.w*b.y - a.x*b.z + a.y*b.w + a.z*b.x));
+        assert(near(q.z, a.w*b.z + a.x*b.y - a.y*b.x + a.z*b.w));
+        assert(near(q.w, a.w*b.w - a.x*b.x - a.y*b.y - a.z*b.z));
+
+        // Composition order survives: fromEuler still agrees with rotationEuler.
+        const auto fromQ = transformPoint(FQuaternion::fromEuler(0.3f, -1.1f, 2.f).toMatrix(), GPoint3D{1.f, 2.f, 3.f});
+        const auto fromM = transformPoint(rotationEuler(0.3f, -1.1f, 2.f), GPoint3D{1.f, 2.f, 3.f});
+        assert(near(fromQ.x, fromM.x) && near(fromQ.y, fromM.y) && near(fromQ.z, fromM.z));
+
+        const auto u = filled<3, 1>(20), v = filled<3, 1>(40);
+        const auto c = cross(u, v);
+        assert(near(c[0][0], u[1][0]*v[2][0] - u[2][0]*v[1][0]));
+        assert(near(c[1][0], u[2][0]*v[0][0] - u[0][0]*v[2][0]));
+        assert(near(c[2][0], u[0][0]*v[1][0] - u[1][0]*v[0][0]));
+    }
+
+    std::printf("math_simd_test: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,160 @@
+// Throughput of the GTEMath float fast paths (GTEMathSIMD.h) and the batch
+// transformPoints against the plain element loops they replaced. Not part of
+// ctest; run by hand:
+//
+//   omegagte_matrix_ops_bench [millions]
+//
+// Prints millions of operations per second for each kernel at the given
+// operation count (default 4 million).
+
+#include <omegaGTE/GTEMath.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace OmegaGTE;
+
+namespace {
+
+    volatile float sink;
+
+    template<typename Fn>
+    double millionsPerSecond(std::size_t ops, Fn && fn){
+        fn();
+        double best = 0.0;
+        for (int run = 0; run < 5; run++) {
+            const auto start = std::chrono::steady_clock::now();
+            fn();
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            best = std::max(best, ops / elapsed.count() / 1e6);
+        }
+        return best;
+    }
+
+    void report(const char * name, double kernel, double reference){
+        std::printf("%-28s %10.1f Mop/s %10.1f Mop/s %6.2fx\n", name, kernel, reference, kernel / reference);
+    }
+
+    // The element loops the generic Matrix / transformPoint code runs.
+
+    void mul4x4Loop(const float * a, const float * b, float * r){
+        for (unsigned i = 0; i < 4; i++)
+            for (unsigned j = 0; j < 4; j++) {
+                float sum = 0.f;
+                for (unsigned k = 0; k < 4; k++) sum += a[i * 4 + k] * b[k * 4 + j];
+                r[i * 4 + j] = sum;
+            }
+    }
+
+    GPoint3D transformLoop(const float * m, const GPoint3D & pt){
+        const float p[4] = {pt.x, pt.y, pt.z, 1.f};
+        float out[4] = {0.f, 0.f, 0.f, 0.f};
+        for (unsigned r = 0; r < 4; r++)
+            for (unsigned c = 0; c < 4; c++) out[r] += m[c * 4 + r] * p[c];
+        const float w = out[3];
+        if (w != 0.f && w != 1.f) {
+            out[0] /= w; out[1] /= w; out[2] /= w;
+        }
+        return GPoint3D{out[0], out[1], out[2]};
+    }
+
+}
+
+int main(int argc, char * argv[]){
+    const double millions = argc > 1 ? std::atof(argv[1]) : 4.0;
+    const auto count = static_cast<std::size_t>(std::max(1.0, millions * 1e6));
+
+    std::vector<FMatrix<4,4>> mats;
+    for (int i = 0; i < 64; i++) {
+        mats.push_back(rotationEuler(0.01f * i, 0.02f * i, -0.03f * i) * translationMatrix(float(i), 1.f, -2.f));
+    }
+    std::vector<GPoint3D> points(count), out(count);
+    for (std::size_t i = 0; i < count; i++) {
+        points[i] = GPoint3D{float(i % 1000) * 0.5f, float(i % 377) - 100.f, float(i % 91)};
+    }
+    const auto model = mats[17];
+
+    std::printf("%zu ops\n%-28s %16s %16s %7s\n", count, "kernel", "vector", "scalar", "");
+
+    const std::size_t products = count / 4;
+    report("FMatrix<4,4> * FMatrix<4,4>",
+           millionsPerSecond(products, [&]{
+               auto acc = FMatrix<4,4>::Identity();
+               for (std::size_t i = 0; i < products; i++) acc = acc * mats[i & 63];
+               sink = acc[0][0];
+           }),
+           millionsPerSecond(products, [&]{
+               auto acc = FMatrix<4,4>::Identity();
+               auto tmp = FMatrix<4,4>::Create();
+               for (std::size_t i = 0; i < products; i++) {
+                   mul4x4Loop(acc.data(), mats[i & 63].data(), tmp.data());
+                   acc = tmp;
+               }
+               sink = acc[0][0];
+           }));
+
+    report("transformPoint",
+           millionsPerSecond(count, [&]{
+               for (std::size_t i = 0; i < count; i++) out[i] = transformPoint(model, points[i]);
+               sink = out[count / 2].x;
+           }),
+           millionsPerSecond(count, [&]{
+               for (std::size_t i = 0; i < count; i++) out[i] = transformLoop(model.data(), points[i]);
+               sink = out[count / 2].x;
+           }));
+
+    report("transformPoints",
+           millionsPerSecond(count, [&]{
+               transformPoints(model, OmegaCommon::Span<const GPoint3D>(points.data(), count),
+                               OmegaCommon::Span<GPoint3D>(out.data(), count));
+               sink = out[count / 2].x;
+           }),
+           millionsPerSecond(count, [&]{
+               for (std::size_t i = 0; i < count; i++) out[i] = transformLoop(model.data(), points[i]);
+               sink = out[count / 2].x;
+           }));
+
+    report("FQuaternion * FQuaternion",
+           millionsPerSecond(count, [&]{
+               auto acc = FQuaternion::Identity();
+               const auto step = FQuaternion::fromAxisAngle(0.f, 0.6f, 0.8f, 0.001f);
+               for (std::size_t i = 0; i < count; i++) acc = acc * step;
+               sink = acc.w;
+           }),
+           millionsPerSecond(count, [&]{
+               auto acc = FQuaternion::Identity();
+               const auto o = FQuaternion::fromAxisAngle(0.f, 0.6f, 0.8f, 0.001f);
+               for (std::size_t i = 0; i < count; i++) {
+                   const FQuaternion q = acc;
+                   acc = FQuaternion{q.w*o.x + q.x*o.w + q.y*o.z - q.z*o.y,
+                                     q.w*o.y - q.x*o.z + q.y*o.w + q.z*o.x,
+                                     q.w*o.z + q.x*o.y - q.y*o.x + q.z*o.w,
+                                     q.w*o.w - q.x*o.x - q.y*o.y - q.z*o.z};
+               }
+               sink = acc.w;
+           }));
+
+    report("FVec<4> += / *=",
+           millionsPerSecond(count, [&]{
+               auto acc = FVec<4>::Create();
+               const auto step = makeColor(0.25f, -0.5f, 1.f, 2.f);
+               for (std::size_t i = 0; i < count; i++) {
+                   acc += step;
+                   acc *= 0.999f;
+               }
+               sink = acc[0][0];
+           }),
+           millionsPerSecond(count, [&]{
+               auto acc = FVec<4>::Create();
+               const auto step = makeColor(0.25f, -0.5f, 1.f, 2.f);
+               for (std::size_t i = 0; i < count; i++) {
+                   for (unsigned c = 0; c < 4; c++) acc.data()[c] = (acc.data()[c] + step.data()[c]) * 0.999f;
+               }
+               sink = acc[0][0];
+           }));
+
+    return 0;
+}
@@ -0,0 +1,193 @@
+/// Backend-independent unit test for tolerance-driven arc flattening
+/// (`setArcTolerance`, `TETriangulationParams::screenScale`) and the arc LOD
+/// table cache behind it. Pure CPU — a test subclass of the abstract
+/// `OmegaTriangulationEngineContext` supplies the two pure virtuals (mirrors
+/// te_coordspace_test.cpp) and reads the protected cache directly.
+///
+/// Checks that the fixed `arcStep` behavior is unchanged by default, that in
+/// tolerance mode the segment count follows on-screen size (small shapes get
+/// few, large ones get more) while every chord stays within the tolerance,
+/// that shapes of similar size share one cached table, and that the packed
+/// path flattens exactly like the TEMesh path.
+
+#include <omegaGTE/TE.h>
+#include <omegaGTE/GEMesh.h>
+#include <omegaGTE/GTEMath.h>
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <future>
+#include <vector>
+
+using namespace OmegaGTE;
+
+namespace {
+
+class TestTEContext : public OmegaTriangulationEngineContext {
+public:
+    ~TestTEContext() override { waitForPendingJobs(); }
+
+    GEViewport getEffectiveViewport() override { return GEViewport{0.f, 0.f, 1000.f, 1000.f, 0.f, 1.f}; }
+
+    void translateCoords(float x, float y, float z, GEViewport *viewport,
+                         float *xr, float *yr, float *zr) override {
+        GEViewport vp = viewport ? *viewport : getEffectiveViewport();
+        translateCoordsDefaultImpl(x, y, z, &vp, xr, yr, zr);
+    }
+
+    std::future<TETriangulationResult> triangulateOnGPU(
+        const TETriangulationParams &params,
+        GTEPolygonFrontFaceRotation frontFaceRotation,
+        GEViewport *viewport) override {
+        std::promise<TETriangulationResult> p;
+        p.set_value(triangulateSync(params, frontFaceRotation, viewport));
+        return p.get_future();
+    }
+
+    size_t cachedTables() {
+        std::lock_guard<std::mutex> lock(arcTableMutex);
+        return arcTables.size();
+    }
+};
+
+/// Local-space circle fan of `radius`, drawn at `scale` viewport units per unit.
+TETriangulationResult circle(TestTEContext &ctx, float radius, float scale = 1.f) {
+    GEllipsoid ellipse{0.f, 0.f, 0.f, radius, radius, 0.f};
+    auto params = TETriangulationParams::Ellipsoid(ellipse);
+    params.localSpace = true;
+    params.screenScale = scale;
+    return ctx.triangulateSync(params);
+}
+
+/// Largest distance between a fan's rim chords and the true circle.
+float maxChordError(const TETriangulationResult &fan, float radius) {
+    float worst = 0.f;
+    for (const auto &poly : fan.mesh.vertexPolygons) {
+        const float mx = 0.5f * (poly.b.pt.x + poly.c.pt.x);
+        const float my = 0.5f * (poly.b.pt.y + poly.c.pt.y);
+        worst = std::max(worst, radius - std::sqrt(mx * mx + my * my));
+    }
+    return worst;
+}
+
+}  // namespace
+
+int main() {
+    TestTEContext ctx;
+
+    // --- Default: the fixed arcStep still decides everything. -----------------
+    {
+        const size_t expected = size_t(std::ceil(2.f * float(PI) / 0.01f));
+        assert(circle(ctx, 2.f).mesh.vertexPolygons.size() == expected);
+        assert(circle(ctx, 2000.f).mesh.vertexPolygons.size() == expected && "size is ignored without a tolerance");
+
+        // The rim steps by exactly arcStep and only the last step is shortened
+        // (each slice is wound clockwise, so its new rim point is `b`).
+        ctx.setArcStep(0.5f);
+        auto coarse = circle(ctx, 100.f);
+        assert(coarse.mesh.vertexPolygons.size() == 13);
+        for (size_t k = 0; k < coarse.mesh.vertexPolygons.size(); ++k) {
+            const float angle = std::min(0.5f * float(k + 1), 2.f * float(PI));
+            assert(std::fabs(coarse.mesh.vertexPolygons[k].b.pt.x - 100.f * std::cos(angle)) < 1e-2f);
+        }
+        ctx.setArcStep(0.01f);
+    }
+
+    // --- Tolerance mode: segments follow on-screen size. ----------------------
+    {
+        const float tolerance = 0.25f;
+        ctx.setArcTolerance(tolerance);
+
+        auto icon = circle(ctx, 4.f);
+        auto button = circle(ctx, 40.f);
+        auto huge = circle(ctx, 4000.f);
+        assert(icon.mesh.vertexPolygons.size() >= 8 && "even a dot stays round");
+        assert(icon.mesh.vertexPolygons.size() < 32 && "a 4 unit circle no longer gets 629 slices");
+        assert(icon.mesh.vertexPolygons.size() < button.mesh.vertexPolygons.size());
+        assert(button.mesh.vertexPolygons.size() < huge.mesh.vertexPolygons.size());
+        for (auto r : {4.f, 40.f, 400.f, 4000.f}) {
+            assert(maxChordError(circle(ctx, r), r) <= tolerance * 1.001f && "every chord stays within tolerance");
+        }
+        assert(maxChordError(circle(ctx, 40000.f), 40000.f) < 40000.f * (1.f - std::cos(0.005f)) &&
+               "a huge circle is finer than the fixed step would make it");
+
+        // The same local-space shape drawn at a tenth of the size needs fewer.
+        assert(circle(ctx, 400.f, 0.1f).mesh.vertexPolygons.size() ==
+               circle(ctx, 40.f).mesh.vertexPolygons.size() && "screenScale scales the radius");
+        ctx.setArcTolerance(0.f);
+    }
+
+    // --- Tables are cached per LOD level, not per shape. ----------------------
+    {
+        TestTEContext fresh;
+        fresh.setArcTolerance(0.25f);
+        for (float r = 100.f; r < 104.f; r += 0.5f) {
+            circle(fresh, r);
+        }
+        assert(fresh.cachedTables() == 1 && "similar radii land on one LOD level");
+        circle(fresh, 2.f);
+        circle(fresh, 2000.f);
+        assert(fresh.cachedTables() == 3);
+    }
+
+    // --- Rounded rects and 3D rings follow the tolerance too. ----------------
+    {
+        ctx.setArcTolerance(0.25f);
+        auto rounded = [&](float radius) {
+            GRoundedRect rect{GPoint2D{0.f, 0.f}, 4.f * radius, 4.f * radius, radius, radius};
+            auto params = TETriangulationParams::RoundedRect(rect);
+            params.localSpace = true;
+            return ctx.triangulateSync(params).mesh.vertexPolygons.size();
+        };
+        assert(rounded(3.f) < rounded(300.f));
+
+        GRoundedRect rect{GPoint2D{0.f, 0.f}, 120.f, 80.f, 16.f, 16.f};
+        auto params = TETriangulationParams::RoundedRect(rect);
+        params.localSpace = true;
+        float area = 0.f;
+        for (const auto &poly : ctx.triangulateSync(params).mesh.vertexPolygons) {
+            const auto &a = poly.a.pt, &b = poly.b.pt, &c = poly.c.pt;
+            area += 0.5f * std::fabs((b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x));
+        }
+        const float exact = 120.f * 80.f - (4.f - float(PI)) * 16.f * 16.f;
+        assert(area <= exact && exact - area <= 0.25f * 2.f * float(PI) * 16.f && "corners stay within tolerance");
+
+        auto sphere = [&](float radius) {
+            GSphere s{GPoint3D{0.f, 0.f, 0.f}, radius};
+            auto p = TETriangulationParams::Sphere(s);
+            p.localSpace = true;
+            return ctx.triangulateSync(p).mesh.vertexPolygons.size();
+        };
+        assert(sphere(2.f) < sphere(200.f));
+
+        auto torus = [&](float major, float minor) {
+            GTorus t{GPoint3D{0.f, 0.f, 0.f}, major, minor};
+            auto p = TETriangulationParams::Torus(t);
+            p.localSpace = true;
+            return ctx.triangulateSync(p).mesh.vertexPolygons.size();
+        };
+        assert(torus(100.f, 2.f) < torus(100.f, 50.f) && "the tube is flattened by its own radius");
+        ctx.setArcTolerance(0.f);
+    }
+
+    // --- The packed path flattens exactly like the TEMesh path. ---------------
+    {
+        ctx.setArcTolerance(0.5f);
+        GEllipsoid ellipse{500.f, 500.f, 0.f, 120.f, 60.f, 0.f};
+        auto params = TETriangulationParams::Ellipsoid(ellipse);
+        auto reference = ctx.triangulateSync(params);
+        auto packed = ctx.triangulatePacked(params, GEMeshAttrPosition);
+        assert(packed.indices.size() == reference.mesh.vertexPolygons.size() * 3);
+        assert(packed.vertexCount == reference.mesh.vertexPolygons.size() + 2);
+
+        GRoundedRect rect{GPoint2D{100.f, 100.f}, 300.f, 200.f, 40.f, 30.f};
+        auto roundedParams = TETriangulationParams::RoundedRect(rect);
+        assert(ctx.triangulatePacked(roundedParams, GEMeshAttrPosition).indices.size() ==
+               ctx.triangulateSync(roundedParams).mesh.vertexPolygons.size() * 3);
+        ctx.setArcTolerance(0.f);
+    }
+
+    std::printf("te_arc_lod_test: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,185 @@
+/// Backend-independent unit test for pooled async triangulation:
+/// `triangulateBatchAsync` and the pool-backed `triangulateAsync`. Pure CPU —
+/// a test subclass of the abstract `OmegaTriangulationEngineContext` supplies
+/// the two pure virtuals (mirrors te_coordspace_test.cpp).
+///
+/// Checks that batch results come back in submission order and match
+/// `triangulateSync` shape for shape, that per-params viewport / winding still
+/// win inside a batch, that `cancel()` skips jobs that have not started while
+/// the batch is still delivered, and that destroying the context waits for
+/// outstanding jobs instead of leaving them running against a dead context.
+
+#include <omegaGTE/TE.h>
+#include <omegaGTE/GTEMath.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <future>
+#include <memory>
+#include <thread>
+
+using namespace OmegaGTE;
+
+namespace {
+
+constexpr float kEps = 1e-4f;
+
+bool nearlyEqual(float a, float b, float eps = kEps) {
+    return std::fabs(a - b) <= eps;
+}
+
+/// CPU-only TE context. `gateOpen` lets a test hold every job inside
+/// `translateCoords` until it has finished setting up (e.g. cancelled). Like
+/// the shipped backends, it drains its jobs before its own members go.
+class TestTEContext : public OmegaTriangulationEngineContext {
+public:
+    GEViewport effective;
+    std::atomic<bool> gateOpen{true};
+
+    explicit TestTEContext(const GEViewport &vp) : effective(vp) {}
+    ~TestTEContext() override { waitForPendingJobs(); }
+
+    GEViewport getEffectiveViewport() override { return effective; }
+
+    void translateCoords(float x, float y, float z, GEViewport *viewport,
+                         float *xr, float *yr, float *zr) override {
+        while (!gateOpen.load()) {
+            std::this_thread::yield();
+        }
+        if (viewport) {
+            translateCoordsDefaultImpl(x, y, z, viewport, xr, yr, zr);
+            return;
+        }
+        GEViewport vp = getEffectiveViewport();
+        translateCoordsDefaultImpl(x, y, z, &vp, xr, yr, zr);
+    }
+
+    std::future<TETriangulationResult> triangulateOnGPU(
+        const TETriangulationParams &params,
+        GTEPolygonFrontFaceRotation frontFaceRotation,
+        GEViewport *viewport) override {
+        std::promise<TETriangulationResult> p;
+        p.set_value(triangulateSync(params, frontFaceRotation, viewport));
+        return p.get_future();
+    }
+};
+
+bool sameMesh(const TETriangulationResult &a, const TETriangulationResult &b) {
+    if (a.mesh.vertexPolygons.size() != b.mesh.vertexPolygons.size()) return false;
+    for (size_t i = 0; i < a.mesh.vertexPolygons.size(); ++i) {
+        const auto &p = a.mesh.vertexPolygons[i];
+        const auto &q = b.mesh.vertexPolygons[i];
+        const GPoint3D ps[3] = {p.a.pt, p.b.pt, p.c.pt};
+        const GPoint3D qs[3] = {q.a.pt, q.b.pt, q.c.pt};
+        for (int k = 0; k < 3; ++k) {
+            if (!nearlyEqual(ps[k].x, qs[k].x) || !nearlyEqual(ps[k].y, qs[k].y) ||
+                !nearlyEqual(ps[k].z, qs[k].z)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/// Alternating rects and rounded rects of increasing size, so every slot's
+/// geometry is distinguishable and out-of-order delivery would show.
+std::vector<TETriangulationParams> makeShapes(size_t count) {
+    std::vector<TETriangulationParams> shapes;
+    shapes.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        const float size = 10.f + float(i);
+        if (i % 2 == 0) {
+            GRect rect{GPoint2D{float(i), 5.f}, size, size * 0.5f};
+            shapes.push_back(TETriangulationParams::Rect(rect));
+        } else {
+            GRoundedRect rounded{GPoint2D{float(i), 5.f}, size, size, 4.f, 4.f};
+            shapes.push_back(TETriangulationParams::RoundedRect(rounded));
+        }
+    }
+    return shapes;
+}
+
+}  // namespace
+
+int main() {
+    const GEViewport screen{0.f, 0.f, 800.f, 600.f, 0.f, 1.f};
+
+    // --- Results arrive in submission order and match triangulateSync. -------
+    {
+        TestTEContext ctx(screen);
+        auto shapes = makeShapes(300);
+        // Per-params winding and viewport must still win inside a batch.
+        shapes[7].frontFaceRotation = GTEPolygonFrontFaceRotation::CounterClockwise;
+        shapes[8].viewport = GEViewport{0.f, 0.f, 200.f, 100.f, 0.f, 1.f};
+
+        auto batch = ctx.triangulateBatchAsync(shapes, GTEPolygonFrontFaceRotation::Clockwise);
+        assert(batch.size() == shapes.size());
+        auto results = batch.results();
+        auto &slots = results.get();
+        assert(slots.size() == shapes.size() && "one slot per submitted shape");
+        for (size_t i = 0; i < shapes.size(); ++i) {
+            assert(slots[i].has_value() && "an uncancelled batch fills every slot");
+            auto expected = ctx.triangulateSync(shapes[i], GTEPolygonFrontFaceRotation::Clockwise);
+            assert(sameMesh(*slots[i], expected) && "slot must hold its own shape, in submission order");
+        }
+    }
+
+    // --- An empty batch is delivered immediately. ------------------------------
+    {
+        TestTEContext ctx(screen);
+        auto batch = ctx.triangulateBatchAsync({});
+        assert(batch.results().ready() && batch.results().get().empty());
+    }
+
+    // --- cancel() skips jobs that have not started; the batch still completes. -
+    {
+        TestTEContext ctx(screen);
+        ctx.gateOpen = false;
+        const unsigned workers = OmegaCommon::TaskScheduler::shared().workerCount();
+        auto shapes = makeShapes(size_t(std::max(1u, workers)) * 4 * 16);
+        auto batch = ctx.triangulateBatchAsync(shapes);
+        batch.cancel();
+        assert(batch.isCancelled());
+        ctx.gateOpen = true;
+
+        auto &slots = batch.results().get();
+        assert(slots.size() == shapes.size());
+        size_t done = 0;
+        for (const auto &slot : slots) {
+            if (slot.has_value()) {
+                assert(!slot->mesh.vertexPolygons.empty() && "a job that ran is complete");
+                ++done;
+            }
+        }
+        // At most the job each running task was inside of when cancel() landed.
+        assert(done <= workers && "cancelled jobs must not run");
+        assert(done < slots.size());
+    }
+
+    // --- Destroying the context waits for its outstanding jobs. ----------------
+    {
+        std::future<TETriangulationResult> single;
+        std::unique_ptr<TETriangulationBatch> batch;
+        {
+            TestTEContext ctx(screen);
+            ctx.gateOpen = false;
+            GRect rect{GPoint2D{0.f, 0.f}, 100.f, 50.f};
+            single = ctx.triangulateAsync(TETriangulationParams::Rect(rect));
+            batch = std::make_unique<TETriangulationBatch>(ctx.triangulateBatchAsync(makeShapes(64)));
+            // Jobs are queued or parked in the gate; ctx's destructor runs
+            // next and must block until every one of them has finished.
+            ctx.gateOpen = true;
+        }
+        assert(single.wait_for(std::chrono::seconds(0)) == std::future_status::ready &&
+               "triangulateAsync job finished before the context died");
+        assert(!single.get().mesh.vertexPolygons.empty());
+        assert(batch->results().ready() && "batch finished before the context died");
+    }
+
+    std::printf("te_batch_test: all checks passed\n");
+    return 0;
+}
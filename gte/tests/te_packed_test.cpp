@@ -0,0 +1,237 @@
+/// Backend-independent unit test for packed, indexed triangulation output:
+/// `triangulatePacked` and `triangulatePackedInto`. Pure CPU — a test
+/// subclass of the abstract `OmegaTriangulationEngineContext` supplies the two
+/// pure virtuals (mirrors te_coordspace_test.cpp).
+///
+/// Checks that the packed stream expands to exactly the triangles
+/// `triangulateSync` produces (positions, requested attributes, winding),
+/// that rects, rounded rects and ellipsoids share corners instead of
+/// repeating them, that only requested attributes occupy the vertex, and that
+/// writing into a caller region honors capacity and `baseVertex`.
+
+#include <omegaGTE/TE.h>
+#include <omegaGTE/GEMesh.h>
+#include <omegaGTE/GTEMath.h>
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <future>
+#include <vector>
+
+using namespace OmegaGTE;
+
+namespace {
+
+constexpr float kEps = 1e-5f;
+
+bool nearlyEqual(float a, float b, float eps = kEps) {
+    return std::fabs(a - b) <= eps;
+}
+
+class TestTEContext : public OmegaTriangulationEngineContext {
+public:
+    GEViewport effective;
+
+    explicit TestTEContext(const GEViewport &vp) : effective(vp) {}
+    ~TestTEContext() override { waitForPendingJobs(); }
+
+    GEViewport getEffectiveViewport() override { return effective; }
+
+    void translateCoords(float x, float y, float z, GEViewport *viewport,
+                         float *xr, float *yr, float *zr) override {
+        if (viewport) {
+            translateCoordsDefaultImpl(x, y, z, viewport, xr, yr, zr);
+            return;
+        }
+        GEViewport vp = getEffectiveViewport();
+        translateCoordsDefaultImpl(x, y, z, &vp, xr, yr, zr);
+    }
+
+    std::future<TETriangulationResult> triangulateOnGPU(
+        const TETriangulationParams &params,
+        GTEPolygonFrontFaceRotation frontFaceRotation,
+        GEViewport *viewport) override {
+        std::promise<TETriangulationResult> p;
+        p.set_value(triangulateSync(params, frontFaceRotation, viewport));
+        return p.get_future();
+    }
+};
+
+/// Float offset of `attr` inside one packed vertex.
+size_t offsetOf(uint32_t attributes, uint32_t attr) {
+    const auto offsets = geMeshMemberOffsetsFor(attributes);
+    const uint32_t order[5] = {GEMeshAttrPosition, GEMeshAttrUV2, GEMeshAttrUV3, GEMeshAttrNormal, GEMeshAttrColor};
+    size_t member = 0;
+    for (uint32_t bit : order) {
+        if (attributes & bit) {
+            if (bit == attr) return offsets[member] / sizeof(float);
+            ++member;
+        }
+    }
+    assert(false && "attribute not present");
+    return 0;
+}
+
+/// Expanding the index list must reproduce the TEMesh corner for corner.
+/// `extra` names one non-position attribute to compare as well (or 0).
+bool sameTriangles(const TEPackedMesh &packed, const TETriangulationResult &reference, uint32_t extra) {
+    const auto &polys = reference.mesh.vertexPolygons;
+    if (packed.indices.size() != polys.size() * 3) return false;
+    const size_t stride = packed.vertexStride / sizeof(float);
+    for (size_t t = 0; t < polys.size(); ++t) {
+        const TETriangulationResult::TEMesh::Vertex *corners[3] = {&polys[t].a, &polys[t].b, &polys[t].c};
+        for (int k = 0; k < 3; ++k) {
+            const uint32_t index = packed.indices[t * 3 + k];
+            if (index >= packed.vertexCount) return false;
+            const float *v = packed.vertexData.data() + index * stride;
+            const auto &pt = corners[k]->pt;
+            if (!nearlyEqual(v[0], pt.x) || !nearlyEqual(v[1], pt.y) || !nearlyEqual(v[2], pt.z)) return false;
+            if (extra == 0) continue;
+            const float *value = v + offsetOf(packed.attributes, extra);
+            const auto &att = corners[k]->attachment;
+            if (!att.has_value()) return false;
+            if (extra == GEMeshAttrColor) {
+                for (unsigned i = 0; i < 4; ++i) {
+                    if (!nearlyEqual(value[i], att->color[i][0])) return false;
+                }
+            } else if (extra == GEMeshAttrUV2) {
+                for (unsigned i = 0; i < 2; ++i) {
+                    if (!nearlyEqual(value[i], att->texture2Dcoord[i][0])) return false;
+                }
+            } else if (extra == GEMeshAttrNormal) {
+                for (unsigned i = 0; i < 3; ++i) {
+                    if (!nearlyEqual(value[i], att->normal[i][0])) return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+FVec<4> rgba(float r, float g, float b, float a) {
+    auto c = FVec<4>::Create();
+    c[0][0] = r; c[1][0] = g; c[2][0] = b; c[3][0] = a;
+    return c;
+}
+
+}  // namespace
+
+int main() {
+    const GEViewport screen{0.f, 0.f, 800.f, 600.f, 0.f, 1.f};
+    TestTEContext ctx(screen);
+    const uint32_t posColor = GEMeshAttrPosition | GEMeshAttrColor;
+
+    // --- A colored rect: four shared corners, six indices, both windings. ---
+    {
+        GRect rect{GPoint2D{40.f, 30.f}, 200.f, 100.f};
+        auto params = TETriangulationParams::Rect(rect);
+        params.addAttachment(TETriangulationParams::Attachment::makeColor(rgba(0.2f, 0.4f, 0.6f, 1.f)));
+        for (auto winding : {GTEPolygonFrontFaceRotation::Clockwise, GTEPolygonFrontFaceRotation::CounterClockwise}) {
+            auto packed = ctx.triangulatePacked(params, posColor, winding);
+            assert(packed.vertexCount == 4 && packed.indices.size() == 6 && "rect corners are shared");
+            assert(packed.vertexStride == geMeshStrideFor(posColor));
+            assert(packed.vertexData.size() * sizeof(float) == packed.vertexCount * packed.vertexStride);
+            assert(sameTriangles(packed, ctx.triangulateSync(params, winding), GEMeshAttrColor) &&
+                   "packed rect matches the TEMesh path, winding included");
+        }
+    }
+
+    // --- Position-only output carries nothing else. ---------------------------
+    {
+        GRect rect{GPoint2D{0.f, 0.f}, 10.f, 10.f};
+        auto params = TETriangulationParams::Rect(rect);
+        params.addAttachment(TETriangulationParams::Attachment::makeColor(rgba(1.f, 0.f, 0.f, 1.f)));
+        auto packed = ctx.triangulatePacked(params, GEMeshAttrPosition);
+        assert(packed.vertexStride == geMeshStrideFor(GEMeshAttrPosition));
+        assert(packed.vertexData.size() * sizeof(float) == 4 * packed.vertexStride &&
+               "unrequested attachments take no space");
+        assert(sameTriangles(packed, ctx.triangulateSync(params), 0));
+    }
+
+    // --- A rounded rect shares its fan centers and rim points. ----------------
+    {
+        GRoundedRect rounded{GPoint2D{100.f, 100.f}, 300.f, 200.f, 24.f, 16.f};
+        auto params = TETriangulationParams::RoundedRect(rounded);
+        params.addAttachment(TETriangulationParams::Attachment::makeColor(rgba(0.f, 1.f, 0.f, 0.5f)));
+        auto reference = ctx.triangulateSync(params);
+        auto packed = ctx.triangulatePacked(params, posColor);
+        assert(sameTriangles(packed, reference, GEMeshAttrColor) && "packed rounded rect matches the TEMesh path");
+        assert(packed.vertexCount * 2 < reference.mesh.vertexCount() && "shared corners at least halve the vertices");
+
+        auto textured = TETriangulationParams::RoundedRect(rounded);
+        textured.addAttachment(TETriangulationParams::Attachment::makeTexture2D(64, 64));
+        const uint32_t posUV = GEMeshAttrPosition | GEMeshAttrUV2;
+        assert(sameTriangles(ctx.triangulatePacked(textured, posUV), ctx.triangulateSync(textured), GEMeshAttrUV2) &&
+               "UVs follow device position like the TEMesh path");
+    }
+
+    // --- A textured ellipse fan: one center, one vertex per rim step. ---------
+    {
+        GEllipsoid ellipse{400.f, 300.f, 0.f, 120.f, 80.f, 0.f};
+        auto params = TETriangulationParams::Ellipsoid(ellipse);
+        params.addAttachment(TETriangulationParams::Attachment::makeTexture2D(32, 32));
+        ctx.setArcStep(0.1f);
+        auto reference = ctx.triangulateSync(params, GTEPolygonFrontFaceRotation::CounterClockwise);
+        auto packed = ctx.triangulatePacked(params, GEMeshAttrPosition | GEMeshAttrUV2,
+                                            GTEPolygonFrontFaceRotation::CounterClockwise);
+        assert(sameTriangles(packed, reference, GEMeshAttrUV2));
+        assert(packed.vertexCount == reference.mesh.vertexPolygons.size() + 2 && "center plus a closed rim");
+        ctx.setArcStep(0.01f);
+    }
+
+    // --- Other primitives fall back to one vertex per corner. -----------------
+    {
+        GRectangularPrism prism{GPoint3D{10.f, 10.f, 0.f}, 50.f, 40.f, 30.f};
+        auto params = TETriangulationParams::RectangularPrism(prism);
+        auto reference = ctx.triangulateSync(params);
+        const uint32_t posNormal = GEMeshAttrPosition | GEMeshAttrNormal;
+        auto packed = ctx.triangulatePacked(params, posNormal);
+        assert(packed.vertexCount == reference.mesh.vertexCount());
+        assert(sameTriangles(packed, reference, GEMeshAttrNormal));
+    }
+
+    // --- Writing into a caller region. ----------------------------------------
+    {
+        GRoundedRect rounded{GPoint2D{0.f, 0.f}, 80.f, 60.f, 10.f, 10.f};
+        auto params = TETriangulationParams::RoundedRect(rounded);
+        params.addAttachment(TETriangulationParams::Attachment::makeColor(rgba(1.f, 1.f, 1.f, 1.f)));
+        auto owned = ctx.triangulatePacked(params, posColor);
+        const size_t strideFloats = owned.vertexStride / sizeof(float);
+
+        TEPackedMeshTarget sizing;
+        assert(!ctx.triangulatePackedInto(params, posColor, sizing) && "an empty target cannot hold the shape");
+        assert(sizing.vertexCount == owned.vertexCount && sizing.indexCount == owned.indices.size() &&
+               "requirements are reported even when nothing fits");
+
+        std::vector<float> vertices(sizing.vertexCount * strideFloats, -1.f);
+        std::vector<uint32_t> indices(sizing.indexCount, 0);
+        TEPackedMeshTarget target;
+        target.vertexData = vertices.data();
+        target.vertexCapacity = sizing.vertexCount;
+        target.indexData = indices.data();
+        target.indexCapacity = sizing.indexCount - 1;
+        assert(!ctx.triangulatePackedInto(params, posColor, target) && "one index short does not fit");
+
+        target.indexCapacity = sizing.indexCount;
+        target.baseVertex = 7;
+        assert(ctx.triangulatePackedInto(params, posColor, target));
+        assert(vertices == owned.vertexData && "mapped vertices match the owned stream, padding zeroed");
+        for (size_t i = 0; i < indices.size(); ++i) {
+            assert(indices[i] == owned.indices[i] + 7 && "baseVertex offsets every index");
+        }
+    }
+
+    // --- Position is required. -------------------------------------------------
+    {
+        GRect rect{GPoint2D{0.f, 0.f}, 10.f, 10.f};
+        auto params = TETriangulationParams::Rect(rect);
+        auto packed = ctx.triangulatePacked(params, GEMeshAttrColor);
+        assert(packed.vertexCount == 0 && packed.indices.empty());
+        TEPackedMeshTarget target;
+        assert(!ctx.triangulatePackedInto(params, GEMeshAttrColor, target));
+    }
+
+    std::printf("te_packed_test: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,324 @@
+/// Backend-independent unit test for the GraphicsPath2D fill tessellator.
+/// Pure CPU — a test subclass of the abstract `OmegaTriangulationEngineContext`
+/// supplies the two pure virtuals (mirrors te_coordspace_test.cpp), and every
+/// shape is triangulated in local space so the output stays in path units.
+///
+/// Checks that concave paths, holes, multiple contours and self-intersecting
+/// paths are covered exactly — the fill's area equals the area the fill rule
+/// selects, and no triangle lands outside it — under both NonZero and
+/// EvenOdd, that a large path stays correct, that small features of a large
+/// path survive, and that fills are never handed to the stroke-only GPU path
+/// kernel.
+
+#include <omegaGTE/TE.h>
+#include <omegaGTE/GTEMath.h>
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <future>
+#include <vector>
+
+using namespace OmegaGTE;
+
+namespace {
+
+class TestTEContext : public OmegaTriangulationEngineContext {
+public:
+    ~TestTEContext() override { waitForPendingJobs(); }
+
+    GEViewport getEffectiveViewport() override { return GEViewport{0.f, 0.f, 100.f, 100.f, 0.f, 1.f}; }
+
+    void translateCoords(float x, float y, float z, GEViewport *viewport,
+                         float *xr, float *yr, float *zr) override {
+        GEViewport vp = viewport ? *viewport : getEffectiveViewport();
+        translateCoordsDefaultImpl(x, y, z, &vp, xr, yr, zr);
+    }
+
+    std::future<TETriangulationResult> triangulateOnGPU(
+        const TETriangulationParams &params,
+        GTEPolygonFrontFaceRotation frontFaceRotation,
+        GEViewport *viewport) override {
+        std::promise<TETriangulationResult> p;
+        p.set_value(triangulateSync(params, frontFaceRotation, viewport));
+        return p.get_future();
+    }
+};
+
+using Contour = std::vector<GPoint2D>;
+
+GVectorPath2D toPath(const Contour &pts) {
+    GVectorPath2D path(pts.front());
+    for (size_t i = 1; i < pts.size(); ++i) {
+        path.append(pts[i]);
+    }
+    return path;
+}
+
+/// Signed crossings of a rightward ray from `p`, summed over every contour.
+int windingAt(const std::vector<Contour> &contours, const GPoint2D &p) {
+    int winding = 0;
+    for (const auto &c : contours) {
+        for (size_t i = 0; i < c.size(); ++i) {
+            const GPoint2D &a = c[i];
+            const GPoint2D &b = c[(i + 1) % c.size()];
+            if ((a.y <= p.y) != (b.y <= p.y)) {
+                const float x = a.x + (p.y - a.y) * (b.x - a.x) / (b.y - a.y);
+                if (x > p.x) {
+                    winding += (b.y > a.y) ? 1 : -1;
+                }
+            }
+        }
+    }
+    return winding;
+}
+
+bool filled(const std::vector<Contour> &contours, TEFillRule rule, const GPoint2D &p) {
+    const int w = windingAt(contours, p);
+    return rule == TEFillRule::EvenOdd ? (w & 1) != 0 : w != 0;
+}
+
+/// Area the rule selects, sampled on a fine grid over [0, size]^2.
+float sampledArea(const std::vector<Contour> &contours, TEFillRule rule, float size) {
+    const int steps = 800;
+    const float cell = size / float(steps);
+    int inside = 0;
+    for (int i = 0; i < steps; ++i) {
+        for (int j = 0; j < steps; ++j) {
+            if (filled(contours, rule, GPoint2D{(float(i) + 0.5f) * cell, (float(j) + 0.5f) * cell})) {
+                ++inside;
+            }
+        }
+    }
+    return float(inside) * cell * cell;
+}
+
+struct FillStats {
+    float area = 0.f;
+    size_t triangles = 0;
+    bool centroidsInside = true;
+};
+
+FillStats measure(const TETriangulationResult &result, const std::vector<Contour> &contours, TEFillRule rule) {
+    FillStats stats;
+    for (const auto &poly : result.mesh.vertexPolygons) {
+        const auto &a = poly.a.pt, &b = poly.b.pt, &c = poly.c.pt;
+        stats.area += 0.5f * std::fabs((b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x));
+        const GPoint2D centroid{(a.x + b.x + c.x) / 3.f, (a.y + b.y + c.y) / 3.f};
+        if (!filled(contours, rule, centroid)) {
+            stats.centroidsInside = false;
+        }
+        ++stats.triangles;
+    }
+    return stats;
+}
+
+/// Area of the triangles whose centroid falls in [x0, x1] x [y0, y1].
+float areaWithin(const TETriangulationResult &result, float x0, float y0, float x1, float y1) {
+    float area = 0.f;
+    for (const auto &poly : result.mesh.vertexPolygons) {
+        const auto &a = poly.a.pt, &b = poly.b.pt, &c = poly.c.pt;
+        const float cx = (a.x + b.x + c.x) / 3.f, cy = (a.y + b.y + c.y) / 3.f;
+        if (cx >= x0 && cx <= x1 && cy >= y0 && cy <= y1) {
+            area += 0.5f * std::fabs((b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x));
+        }
+    }
+    return area;
+}
+
+TETriangulationParams::Attachment fillColor() {
+    auto c = FVec<4>::Create();
+    c[0][0] = 1.f; c[3][0] = 1.f;
+    return TETriangulationParams::Attachment::makeColor(c);
+}
+
+/// Fill-only, local-space triangulation of `contours`.
+TETriangulationResult fill(TestTEContext &ctx, const std::vector<Contour> &contours, TEFillRule rule) {
+    std::vector<GVectorPath2D> paths;
+    for (const auto &c : contours) {
+        paths.push_back(toPath(c));
+    }
+    auto params = TETriangulationParams::GraphicsPath2DFill(unsigned(paths.size()), paths.data(), rule);
+    params.addAttachment(fillColor());
+    params.localSpace = true;
+    return ctx.triangulateSync(params);
+}
+
+bool areaMatches(float area, float expected, float tolerance) {
+    return std::fabs(area - expected) <= tolerance * std::max(1.f, expected);
+}
+
+Contour square(float x, float y, float size, bool clockwise) {
+    Contour c{{x, y}, {x + size, y}, {x + size, y + size}, {x, y + size}};
+    if (clockwise) {
+        std::swap(c[1], c[3]);
+    }
+    return c;
+}
+
+}  // namespace
+
+int main() {
+    TestTEContext ctx;
+
+    // --- A concave "comb": a first-vertex fan would cover the notches. --------
+    {
+        std::vector<Contour> comb{{{0, 0}, {100, 0}, {100, 100}, {80, 100}, {80, 20}, {60, 20}, {60, 100},
+                                   {40, 100}, {40, 20}, {20, 20}, {20, 100}, {0, 100}}};
+        auto stats = measure(fill(ctx, comb, TEFillRule::NonZero), comb, TEFillRule::NonZero);
+        assert(areaMatches(stats.area, 100.f * 20.f + 3.f * 20.f * 80.f, 1e-4f) && "comb area is exact");
+        assert(stats.centroidsInside && "no triangle covers a notch");
+    }
+
+    // --- The existing GraphicsPath2D fill goes through the same tessellator. ---
+    {
+        Contour arrow{{0, 0}, {100, 50}, {0, 100}, {30, 50}};
+        auto path = toPath(arrow);
+        auto params = TETriangulationParams::GraphicsPath2D(path, 0.f, true, true);
+        params.addAttachment(fillColor());
+        params.addAttachment(fillColor());
+        params.localSpace = true;
+        auto stats = measure(ctx.triangulateSync(params), {arrow}, TEFillRule::NonZero);
+        assert(areaMatches(stats.area, 0.5f * 100.f * 100.f - 0.5f * 100.f * 30.f, 1e-4f));
+        assert(stats.centroidsInside && "concave arrow head is not over-filled");
+    }
+
+    // --- Holes and islands under both rules. -----------------------------------
+    {
+        // Hole wound opposite to the outer contour: a hole under both rules.
+        std::vector<Contour> opposite{square(0, 0, 100, false), square(25, 25, 50, true)};
+        for (auto rule : {TEFillRule::NonZero, TEFillRule::EvenOdd}) {
+            auto stats = measure(fill(ctx, opposite, rule), opposite, rule);
+            assert(areaMatches(stats.area, 10000.f - 2500.f, 1e-4f) && stats.centroidsInside);
+        }
+
+        // Same winding: NonZero fills through, EvenOdd still punches the hole.
+        std::vector<Contour> same{square(0, 0, 100, false), square(25, 25, 50, false)};
+        auto nonZero = measure(fill(ctx, same, TEFillRule::NonZero), same, TEFillRule::NonZero);
+        assert(areaMatches(nonZero.area, 10000.f, 1e-4f));
+        auto evenOdd = measure(fill(ctx, same, TEFillRule::EvenOdd), same, TEFillRule::EvenOdd);
+        assert(areaMatches(evenOdd.area, 7500.f, 1e-4f) && evenOdd.centroidsInside);
+
+        // An island inside the hole, and a disjoint contour alongside.
+        std::vector<Contour> nested{square(0, 0, 100, false), square(20, 20, 60, true),
+                                    square(40, 40, 20, false), square(150, 0, 30, true)};
+        auto stats = measure(fill(ctx, nested, TEFillRule::NonZero), nested, TEFillRule::NonZero);
+        assert(areaMatches(stats.area, 10000.f - 3600.f + 400.f + 900.f, 1e-4f) && stats.centroidsInside);
+    }
+
+    // --- Self-intersections: the pentagram's core differs between the rules. --
+    {
+        Contour star;
+        for (int k = 0; k < 5; ++k) {
+            const float angle = float(k) * 4.f * float(PI) / 5.f - float(PI) / 2.f;
+            star.push_back(GPoint2D{50.f + 48.f * std::cos(angle), 50.f + 48.f * std::sin(angle)});
+        }
+        const std::vector<Contour> contours{star};
+        const float nonZeroArea = sampledArea(contours, TEFillRule::NonZero, 100.f);
+        const float evenOddArea = sampledArea(contours, TEFillRule::EvenOdd, 100.f);
+        assert(evenOddArea < nonZeroArea * 0.9f && "the core pentagon is a hole under EvenOdd");
+
+        auto nonZero = measure(fill(ctx, contours, TEFillRule::NonZero), contours, TEFillRule::NonZero);
+        assert(areaMatches(nonZero.area, nonZeroArea, 5e-3f) && nonZero.centroidsInside);
+        auto evenOdd = measure(fill(ctx, contours, TEFillRule::EvenOdd), contours, TEFillRule::EvenOdd);
+        assert(areaMatches(evenOdd.area, evenOddArea, 5e-3f) && evenOdd.centroidsInside);
+
+        // A figure-eight: its two lobes wind in opposite directions.
+        std::vector<Contour> bowtie{{{0, 0}, {100, 100}, {100, 0}, {0, 100}}};
+        auto lobes = measure(fill(ctx, bowtie, TEFillRule::NonZero), bowtie, TEFillRule::NonZero);
+        assert(areaMatches(lobes.area, 5000.f, 1e-4f) && lobes.centroidsInside);
+
+        // Two edges start at one vertex on the same row as an unrelated
+        // crossing, and a {31/12} star crosses itself hundreds of times.
+        Contour dense;
+        for (int k = 0; k < 31; ++k) {
+            const float angle = float(k) * 24.f * float(PI) / 31.f;
+            dense.push_back(GPoint2D{50.f + 48.f * std::cos(angle), 50.f + 48.f * std::sin(angle)});
+        }
+        const std::vector<std::vector<Contour>> crossingCases{
+            {{{50, 46}, {50, 71}, {0, 93}}, {{100, 48}, {0, 78}, {100, 18}, {25, 87}}}, {dense}};
+        for (const auto &contours : crossingCases) {
+            for (auto rule : {TEFillRule::NonZero, TEFillRule::EvenOdd}) {
+                auto stats = measure(fill(ctx, contours, rule), contours, rule);
+                assert(areaMatches(stats.area, sampledArea(contours, rule, 100.f), 5e-3f) && stats.centroidsInside);
+            }
+        }
+    }
+
+    // --- A large, very concave path stays exact. -------------------------------
+    {
+        Contour gear;
+        const int teeth = 400;
+        for (int k = 0; k < teeth * 2; ++k) {
+            const float angle = float(k) * float(PI) / float(teeth);
+            const float radius = (k % 2 == 0) ? 49.f : 30.f;
+            gear.push_back(GPoint2D{50.f + radius * std::cos(angle), 50.f + radius * std::sin(angle)});
+        }
+        float shoelace = 0.f;
+        for (size_t i = 0; i < gear.size(); ++i) {
+            const auto &a = gear[i];
+            const auto &b = gear[(i + 1) % gear.size()];
+            shoelace += a.x * b.y - b.x * a.y;
+        }
+        const std::vector<Contour> contours{gear};
+        auto result = fill(ctx, contours, TEFillRule::NonZero);
+        auto stats = measure(result, contours, TEFillRule::NonZero);
+        assert(areaMatches(stats.area, std::fabs(shoelace) * 0.5f, 1e-3f) && stats.centroidsInside);
+        assert(stats.triangles <= gear.size() * 3 && "triangle count stays linear in the vertex count");
+    }
+
+    // --- Small features of a large path are not mistaken for slivers. --------
+    {
+        std::vector<Contour> island{square(0, 0, 2000, false), square(2100, 10, 2, false)};
+        auto result = fill(ctx, island, TEFillRule::NonZero);
+        assert(areaMatches(areaWithin(result, 2000.f, 0.f, 2200.f, 20.f), 4.f, 1e-4f) && "2x2 island survives");
+        assert(areaMatches(measure(result, island, TEFillRule::NonZero).area, 4000004.f, 1e-6f));
+
+        // An 8000-wide comb whose teeth are one unit wide.
+        Contour comb{{0, 0}, {8000, 0}, {8000, 10}};
+        float teethArea = 0.f;
+        for (int k = 79; k >= 0; --k) {
+            const float x = 100.f * float(k) + 50.f;
+            const float depth = 9.f + float(k % 56);
+            comb.push_back(GPoint2D{x + 1.f, 10.f});
+            comb.push_back(GPoint2D{x + 1.f, 10.f + depth});
+            comb.push_back(GPoint2D{x, 10.f + depth});
+            comb.push_back(GPoint2D{x, 10.f});
+            teethArea += depth;
+        }
+        comb.push_back(GPoint2D{0, 10});
+        auto teeth = fill(ctx, {comb}, TEFillRule::NonZero);
+        assert(areaMatches(areaWithin(teeth, 0.f, 10.f, 8000.f, 100.f), teethArea, 1e-4f) && "no tooth is dropped");
+    }
+
+    // --- Degenerate input produces nothing rather than garbage. ----------------
+    {
+        std::vector<Contour> line{{{0, 0}, {50, 50}, {100, 100}}};
+        assert(fill(ctx, line, TEFillRule::NonZero).mesh.vertexPolygons.empty());
+    }
+
+    // --- Fills never reach the stroke-only GPU path kernel. -------------------
+    {
+        using Extracted = OmegaTriangulationEngineContext::GPUTriangulationExtractedParams;
+        std::vector<Contour> contours{{{0, 0}, {100, 0}, {100, 100}, {0, 100}}, {{25, 25}, {75, 25}, {75, 75}, {25, 75}}};
+        std::vector<GVectorPath2D> paths{toPath(contours[0]), toPath(contours[1])};
+        Extracted ep;
+
+        ctx.extractGPUTriangulationParams(
+            TETriangulationParams::GraphicsPath2DFill(unsigned(paths.size()), paths.data(), TEFillRule::EvenOdd), ep);
+        assert(ep.type == Extracted::Other && "multi-contour fills fall back to the CPU");
+
+        ctx.extractGPUTriangulationParams(
+            TETriangulationParams::GraphicsPath2D(paths[0], 2.f, true, true), ep);
+        assert(ep.type == Extracted::Other && "stroke plus fill falls back to the CPU");
+
+        ctx.extractGPUTriangulationParams(TETriangulationParams::GraphicsPath2D(paths[0], 0.f, true), ep);
+        assert(ep.type == Extracted::Other && "a zero-width stroke falls back to the CPU");
+
+        ctx.extractGPUTriangulationParams(TETriangulationParams::GraphicsPath2D(paths[0], 2.f, true), ep);
+        assert(ep.type == Extracted::Path2D && ep.pathSegments.size() == 4 && "plain strokes stay on the GPU");
+    }
+
+    std::printf("te_path_fill_test: all checks passed\n");
+    return 0;
+}
@@ -130,7 +130,7 @@ namespace OmegaWTK::Composition {
     /// - Single script run; no per-cluster fallback (Phase 4).
     /// - Single font for the entire input (Phase 4).
     /// - Multi-line via *mandatory* breaks only (`\n`, U+2028,
-    ///   U+2029) — driven by `OmegaCommon::BreakIterator`. No wrap to
+    ///   U+2029) — driven by `OmegaCommon::TextAnalysisCache`. No wrap to
     ///   width (Phase 3) and no `lineLimit` (Phase 3).
     /// - Horizontal alignment: Left / Center / Right from
     ///   `TextLayoutDescriptor::Alignment`, computed per-line off
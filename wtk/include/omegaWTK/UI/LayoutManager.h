@@ -297,6 +297,12 @@ struct OMEGAWTK_EXPORT FlexOptions {
     FlexInsets      padding    {};
     FlexMainAlign   mainAlign  = FlexMainAlign::Start;
     FlexCrossAlign  crossAlign = FlexCrossAlign::Start;
+    /// Run the children's content-measure hooks (`View::measureContent`)
+    /// in parallel on the shared `OmegaCommon::TaskScheduler` during
+    /// `measure`. Only worth it for long lists of text-wrapping children;
+    /// every hook in the container must then be safe to call concurrently
+    /// with its siblings' hooks (each touches only its own View's cache).
+    bool            concurrentContentMeasure = false;
 };
 
 struct OMEGAWTK_EXPORT FlexChildSpec {
@@ -61,47 +61,6 @@ namespace OmegaWTK::Composition {
             }
         }
 
-        OmegaCommon::UniString substringUtf16(const OmegaCommon::UniString & src,
-                                              std::int32_t start, std::int32_t end){
-            const auto * buf = src.getBuffer();
-            const auto len = src.length();
-            if(buf == nullptr || start < 0 || end > len || end <= start){
-                return {};
-            }
-            // UniString stores UTF-16; reconstruct via the UTF-32
-            // factory so the public surface stays the only entry point.
-            // For Phase 2 (Latin) this is one allocation per line — a
-            // minor cost we can address in Phase 7 once the public
-            // surface gains a `substr`.
-            std::vector<OmegaCommon::Unicode32Char> utf32;
-            utf32.reserve(static_cast<std::size_t>(end - start));
-            for(std::int32_t i = start; i < end; ++i){
-                utf32.push_back(static_cast<OmegaCommon::Unicode32Char>(buf[i]));
-            }
-            return OmegaCommon::UniString::fromUTF32(utf32.data(),
-                                                    static_cast<std::int32_t>(utf32.size()));
-        }
-
-        // Trim a *trailing* mandatory-break character from a line's
-        // text. ICU's line iterator places the boundary *after* the
-        // `\n`, so the segment we're given includes it; shaping that
-        // character would produce a visible (or zero-width) glyph for
-        // the newline that the layout doesn't want.
-        std::int32_t trimTrailingMandatoryBreak(const OmegaCommon::UniString & src,
-                                                std::int32_t start, std::int32_t end){
-            const auto * buf = src.getBuffer();
-            if(buf == nullptr || end <= start) return end;
-            const auto c = buf[end - 1];
-            if(c == u'\n' || c == u'\r' || c == 0x2028 || c == 0x2029){
-                // Also strip a preceding CR in a CRLF pair.
-                if(c == u'\n' && end - 2 >= start && buf[end - 2] == u'\r'){
-                    return end - 2;
-                }
-                return end - 1;
-            }
-            return end;
-        }
-
     }
 
     namespace {
@@ -142,39 +101,18 @@ namespace OmegaWTK::Composition {
             return result;
         }
 
-        // Walk mandatory line breaks. The line iterator emits
-        // boundaries at every break *opportunity* (mandatory + soft);
-        // Phase 2's no-wrap contract only acts on mandatory ones.
-        // Soft boundaries are still walked so a Phase-3 wrap pass can
-        // reuse the same iterator without re-creating it.
-        struct Segment { std::int32_t start, end; };
-        std::vector<Segment> segments;
-        segments.reserve(4);
-        {
-            OmegaCommon::BreakIterator it(OmegaCommon::BreakIterator::Type::Line, text);
-            std::int32_t segStart = 0;
-            (void)it.first(); // Position iterator at 0.
-            std::int32_t pos;
-            while((pos = it.next()) != OmegaCommon::BreakIterator::DONE){
-                if(it.isMandatoryBreakAt(pos)){
-                    segments.push_back({segStart, pos});
-                    segStart = pos;
-                }
-            }
-            if(segStart < text.length()){
-                segments.push_back({segStart, text.length()});
-            }
-            if(segments.empty()){
-                // Either an ICU init failure (DONE iterator) or text
-                // that contains no breaks at all — treat as a single
-                // segment so the shape pass still runs.
-                segments.push_back({0, text.length()});
-            }
-        }
-
-        // Per-line shape pass (Phase 3). For each line, we run a
-        // `BidiParagraph` over the line text to split it into visual
-        // runs, then sub-segment each run by script. Each (visual run
+        // Paragraphs (the text between mandatory breaks), their BiDi
+        // runs and the soft break opportunities the wrap pass needs all
+        // come from the shared analysis cache, so laying out the same
+        // string again — every frame for a static label — does not
+        // re-run ICU. Phase 2's no-wrap contract only splits lines at
+        // mandatory breaks.
+        const OmegaCommon::TextBuffer analysis =
+            OmegaCommon::TextAnalysisCache::shared().lookup(text);
+        const auto & paragraphs = analysis.paragraphs();
+
+        // Per-line shape pass (Phase 3). For each line, we take the
+        // paragraph's cached BiDi visual runs, then sub-segment each run by script. Each (visual run
         // × script sub-run) pair becomes one shape call with the
         // appropriate direction + script tag. The output glyphs from
         // HB-RTL come back in visual order already; we just append
@@ -196,29 +134,30 @@ namespace OmegaWTK::Composition {
             // and the right per-font `GlyphAtlas` services them.
             std::vector<Core::SharedPtr<Font>> resolvedFonts;
             OmegaCommon::UniString lineText;
+            // Offset of `lineText` within the laid-out text; maps
+            // the cached break opportunities into line coordinates.
+            std::int32_t textStart = 0;
             float totalAdvance = 0.f;
             bool singleDirection = true;
             bool isRTL = false;
         };
         std::vector<ShapedLine> lines;
-        lines.reserve(segments.size());
+        lines.reserve(paragraphs.size());
 
-        for(const auto & seg : segments){
-            const std::int32_t trimmedEnd =
-                trimTrailingMandatoryBreak(text, seg.start, seg.end);
+        for(const auto & para : paragraphs){
             ShapedLine line;
-            if(trimmedEnd > seg.start){
+            line.textStart = para.start;
+            if(para.end > para.start){
                 OmegaCommon::UniString lineText =
-                    substringUtf16(text, seg.start, trimmedEnd);
+                    text.substr(para.start, para.end - para.start);
                 line.lineText = lineText;
 
-                OmegaCommon::BidiParagraph bidi(lineText);
-                const std::int32_t runs = bidi.runCount();
+                const auto runs = static_cast<std::int32_t>(para.runs.size());
                 if(runs != 1){
                     line.singleDirection = false;
                 }
                 for(std::int32_t r = 0; r < runs; ++r){
-                    auto visRun = bidi.getVisualRun(r);
+                    const auto & visRun = para.runs[static_cast<std::size_t>(r)];
                     if(visRun.length <= 0) continue;
                     if(runs == 1) line.isRTL = visRun.rightToLeft;
 
@@ -250,8 +189,7 @@ namespace OmegaWTK::Composition {
                     auto shapeScriptRun =
                         [&](const OmegaCommon::ScriptRunIterator::Run & sr){
                             ShaperInput input;
-                            input.text = substringUtf16(
-                                lineText, sr.start, sr.start + sr.length);
+                            input.text = lineText.substr(sr.start, sr.length);
                             input.font = font;
                             input.rightToLeft = visRun.rightToLeft;
                             input.script = sr.script;
@@ -334,8 +272,8 @@ namespace OmegaWTK::Composition {
                                         font, cp);
                                     if(fbFont != nullptr && end > c){
                                         ShaperInput fbInput;
-                                        fbInput.text = substringUtf16(
-                                            input.text, c, end);
+                                        fbInput.text = input.text.substr(
+                                            c, end - c);
                                         fbInput.font = fbFont;
                                         fbInput.rightToLeft = input.rightToLeft;
                                         fbInput.script = input.script;
@@ -400,7 +338,7 @@ namespace OmegaWTK::Composition {
         }
 
         // Phase 3.5: wrap pass. For each segment-level line, split into
-        // one or more wrap-lines using `BreakIterator(Line)` soft
+        // one or more wrap-lines using the cached line-break soft
         // opportunities and the per-glyph cluster offsets. Single
         // bidi-direction only — mixed-bidi lines fall through
         // unchanged (overflow), and re-shape-per-wrap-line is a
@@ -450,14 +388,16 @@ namespace OmegaWTK::Composition {
                     }
                     breaks.push_back(lineLen);
                 } else {
-                    OmegaCommon::BreakIterator it(
-                        OmegaCommon::BreakIterator::Type::Line,
-                        line.lineText);
-                    (void)it.first();
-                    std::int32_t pos;
-                    while((pos = it.next()) !=
-                          OmegaCommon::BreakIterator::DONE){
-                        breaks.push_back(pos);
+                    const auto & boundaries = analysis.lineBoundaries();
+                    auto b = std::upper_bound(
+                        boundaries.begin(), boundaries.end(), line.textStart,
+                        [](std::int32_t offset,
+                           const OmegaCommon::TextBuffer::LineBoundary & lb){
+                            return offset < lb.offset;
+                        });
+                    for(; b != boundaries.end()
+                          && b->offset < line.textStart + lineLen; ++b){
+                        breaks.push_back(b->offset - line.textStart);
                     }
                     if(breaks.back() != lineLen){
                         breaks.push_back(lineLen);
@@ -503,6 +443,7 @@ namespace OmegaWTK::Composition {
                     w.singleDirection = true;
                     w.isRTL = line.isRTL;
                     w.lineText = line.lineText; // shared (read-only past this)
+                    w.textStart = line.textStart;
                     for(std::size_t i = 0; i < line.glyphs.size(); ++i){
                         const std::int32_t c = line.clusters[i];
                         if(c >= startCluster && c < endCluster){
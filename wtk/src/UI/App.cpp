@@ -81,7 +81,7 @@ AppInst::AppInst(void *data):ptr(Native::make_native_app(data)),windowManager(st
 
     // Warm ICU's one-time lazy init on the main thread, at startup,
     // before any window paints. The cross-platform TextLayoutEngine
-    // builds an OmegaCommon::BreakIterator on its first text layout,
+    // runs OmegaCommon's cached text analysis on its first text layout,
     // and that first call is what triggers ICU's lazy global setup:
     // the default-locale cache, the line-break data load, and the
     // construction of ICU's internal std::mutex objects. Done lazily,
@@ -92,13 +92,14 @@ AppInst::AppInst(void *data):ptr(Native::make_native_app(data)),windowManager(st
     // deadlocks acquiring a low-level lock (CRT heap / loader / the
     // capture DLL's own) whose owner PIX has frozen. Forcing the init
     // here, single-threaded before the capturable render loop, leaves
-    // every per-frame BreakIterator locking an already-constructed,
+    // every per-frame analysis locking an already-constructed,
     // uncontended mutex — nothing for a capture to wedge against.
     // (Mirrors the Linux backend's FcInit() warm-up in
-    // HarfBuzzFontEngine's ctor.) A no-op temporary; Type::Line still
-    // runs Locale::getDefault() + createLineInstance() for empty text.
-    { OmegaCommon::BreakIterator warm(OmegaCommon::BreakIterator::Type::Line,
-                                      OmegaCommon::UniString{}); }
+    // HarfBuzzFontEngine's ctor.) Analyzing a single space runs
+    // Locale::getDefault() + createLineInstance() and constructs the
+    // shared TextAnalysisCache; empty text would skip ICU entirely.
+    (void)OmegaCommon::TextAnalysisCache::shared()
+        .lookup(OmegaCommon::UniString(" ")).paragraphs();
 };
 
 int AppInst::start(){
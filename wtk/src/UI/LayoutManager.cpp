@@ -1,9 +1,12 @@
 #include "omegaWTK/UI/LayoutManager.h"
 #include "ViewImpl.h"   // ViewInternal::sanitizeRect / clampAxis / kMaxViewDimension / sameRect
 
+#include <omega-common/multithread.h>
+
 #include <algorithm>
 #include <cmath>
 #include <limits>
+#include <vector>
 
 namespace OmegaWTK {
 
@@ -373,6 +376,16 @@ constexpr float kMaxFlexDimension = 8192.f;
 constexpr float kMaxFlexDimension = 16384.f;
 #endif
 
+// Below this many children the scheduler round-trip costs more than the
+// hooks it would overlap; `concurrentContentMeasure` falls back to serial.
+constexpr std::size_t kConcurrentMeasureMinChildren = 16;
+
+struct PremeasuredContent {
+    float w     = 0.f;
+    float h     = 0.f;
+    bool  valid = false;
+};
+
 inline float clampSize(float value,
                        const Core::Optional<float> & minValue,
                        const Core::Optional<float> & maxValue){
@@ -526,7 +539,39 @@ LayoutSize FlexLayout::measure(View & node, const Composition::Rect & avail){
     float crossMax = 0.f;
     std::size_t count = 0;
 
-    for(auto * child : subs){
+    const float padCrossAvail = horizontal
+        ? (options_.padding.top  + options_.padding.bottom)
+        : (options_.padding.left + options_.padding.right);
+    const float availCross = std::max(
+        0.f, (horizontal ? avail.h : avail.w) - padCrossAvail);
+
+    // Opt-in concurrent pre-pass: run every content-measure hook up front on
+    // the shared scheduler and let the serial loop below consume the results.
+    // The hooks are the expensive part (text shaping + wrapping); the rest of
+    // the loop is arithmetic and mutates `entries_`, so it stays serial.
+    std::vector<PremeasuredContent> premeasured;
+    if(options_.concurrentContentMeasure && subs.size() >= kConcurrentMeasureMinChildren){
+        premeasured.resize(subs.size());
+        OmegaCommon::parallelFor<std::size_t>(0, subs.size(), 4, [&](std::size_t idx){
+            View * child = subs.begin()[idx];
+            if(child == nullptr || !child->hasContentMeasure()){
+                return;
+            }
+            auto childRect = child->getRect();
+            float outW = horizontal ? childRect.h : childRect.w;
+            float outH = horizontal ? childRect.w : childRect.h;
+            if(horizontal){
+                child->measureContent(kMaxFlexDimension, availCross, outW, outH);
+            }
+            else {
+                child->measureContent(availCross, kMaxFlexDimension, outW, outH);
+            }
+            premeasured[idx] = PremeasuredContent{outW, outH, true};
+        });
+    }
+
+    for(std::size_t idx = 0; idx < subs.size(); ++idx){
+        View * child = subs.begin()[idx];
         if(child == nullptr){
             continue;
         }
@@ -543,12 +588,10 @@ LayoutSize FlexLayout::measure(View & node, const Composition::Rect & avail){
         // extent is the content cross of `avail` (the child stretches to it);
         // the main axis is left for this measure to fill. Only the main axis
         // is overridden — the cross is owned by stretch/alignment.
-        if(child->hasContentMeasure()){
-            const float padCross = horizontal
-                ? (options_.padding.top  + options_.padding.bottom)
-                : (options_.padding.left + options_.padding.right);
-            const float availCross = std::max(
-                0.f, (horizontal ? avail.h : avail.w) - padCross);
+        if(!premeasured.empty() && premeasured[idx].valid){
+            curMain = horizontal ? premeasured[idx].w : premeasured[idx].h;
+        }
+        else if(child->hasContentMeasure()){
             float outW = curCross;
             float outH = curMain;
             if(horizontal){
@@ -4,6 +4,10 @@
 
 #include "Fixtures.h"
 
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
 using namespace OmegaCommon::Img;
 using namespace OmegaWTKTests;
 using OmegaCommon::Result;
@@ -95,3 +99,326 @@ TEST(LoadImageFromBuffer, RejectsCorruptTiff){
     auto res = loadFromBuffer(garbage, sizeof(garbage), Format::TIFF);
     EXPECT_TRUE(res.isErr());
 }
+
+TEST(LoadImageWithOptions, CropsPngToRegion){
+    auto *bytes = const_cast<Byte *>(static_cast<const Byte *>(kPng2x2RGBA));
+    DecodeOptions options;
+    options.region = Region{1, 0, 4, 1};
+    auto res = loadFromBuffer(bytes, kPng2x2RGBASize, Format::PNG, options);
+    auto *img = valueOf(res);
+    ASSERT_NE(img, nullptr);
+    EXPECT_EQ(img->header.width, 1u);
+    EXPECT_EQ(img->header.height, 1u);
+    EXPECT_EQ(img->header.stride, 4u);
+    EXPECT_EQ(img->byteSize(), 4u);
+    EXPECT_EQ(img->data()[0], 0xFF);
+    EXPECT_EQ(img->data()[3], 0xFF);
+}
+
+TEST(LoadImageWithOptions, ReducesPngToTargetSize){
+    auto *bytes = const_cast<Byte *>(static_cast<const Byte *>(kPng2x2RGBA));
+    DecodeOptions options;
+    options.targetWidth = 1;
+    options.targetHeight = 1;
+    auto res = loadFromBuffer(bytes, kPng2x2RGBASize, Format::PNG, options);
+    auto *img = valueOf(res);
+    ASSERT_NE(img, nullptr);
+    EXPECT_EQ(img->header.width, 1u);
+    EXPECT_EQ(img->header.height, 1u);
+    EXPECT_EQ(img->data()[0], 0xFF);
+    EXPECT_EQ(img->data()[1], 0x00);
+    EXPECT_EQ(img->header.alpha_format, AlphaFormat::Straight);
+}
+
+TEST(LoadImageWithOptions, DecodesJpegAsBGRA){
+    auto *bytes = const_cast<Byte *>(static_cast<const Byte *>(kJpeg2x2));
+    DecodeOptions options;
+    options.pixelFormat = PixelFormat::BGRA8;
+    auto res = loadFromBuffer(bytes, kJpeg2x2Size, Format::JPEG, options);
+    auto *img = valueOf(res);
+    ASSERT_NE(img, nullptr);
+    EXPECT_EQ(img->header.color_format, ColorFormat::BGRA);
+    EXPECT_EQ(img->header.channels, 4);
+    EXPECT_LT(img->data()[0], 0x10);
+    EXPECT_GT(img->data()[2], 0xF0);
+}
+
+TEST(LoadImageWithOptions, DecodesTiffAsRGB){
+    auto *bytes = const_cast<Byte *>(static_cast<const Byte *>(kTiff2x2RGBA));
+    DecodeOptions options;
+    options.pixelFormat = PixelFormat::RGB8;
+    auto res = loadFromBuffer(bytes, kTiff2x2RGBASize, Format::TIFF, options);
+    auto *img = valueOf(res);
+    ASSERT_NE(img, nullptr);
+    EXPECT_EQ(img->header.color_format, ColorFormat::RGB);
+    EXPECT_EQ(img->header.channels, 3);
+    EXPECT_EQ(img->header.stride, 6u);
+    EXPECT_EQ(img->header.alpha_format, AlphaFormat::Ignore);
+    EXPECT_EQ(img->byteSize(), 12u);
+}
+
+TEST(LoadImageWithOptions, RejectsRegionOutsideImage){
+    auto *bytes = const_cast<Byte *>(static_cast<const Byte *>(kPng2x2RGBA));
+    DecodeOptions options;
+    options.region = Region{2, 0, 1, 1};
+    auto res = loadFromBuffer(bytes, kPng2x2RGBASize, Format::PNG, options);
+    EXPECT_TRUE(res.isErr());
+}
+
+TEST(IncrementalDecoder, DecodesPngFedByteByByte){
+    auto *bytes = static_cast<const Byte *>(kPng2x2RGBA);
+    auto decoder = IncrementalDecoder::create(Format::PNG);
+    unsigned headers = 0;
+    std::uint32_t rows = 0;
+    decoder->setHeaderCallback([&](const Header & header){
+        headers++;
+        EXPECT_EQ(header.width, 2u);
+        EXPECT_EQ(header.height, 2u);
+    });
+    decoder->setRowsCallback([&](const DecodeProgress & progress){
+        EXPECT_EQ(progress.firstRow, rows);
+        rows += progress.rowCount;
+    });
+    for (std::size_t i = 0; i < kPng2x2RGBASize; i++) {
+        auto res = decoder->feed(bytes + i, 1);
+        ASSERT_TRUE(res.isOk()) << res.error();
+    }
+    auto done = decoder->finish();
+    ASSERT_TRUE(done.isOk()) << done.error();
+    EXPECT_EQ(decoder->state(), IncrementalDecoder::State::Complete);
+    EXPECT_EQ(headers, 1u);
+    EXPECT_EQ(rows, 2u);
+
+    auto image = decoder->takeImage();
+    auto reference = loadFromBuffer(const_cast<Byte *>(bytes), kPng2x2RGBASize, Format::PNG);
+    auto *expected = valueOf(reference);
+    ASSERT_NE(expected, nullptr);
+    ASSERT_EQ(image.byteSize(), expected->byteSize());
+    EXPECT_EQ(std::memcmp(image.data(), expected->data(), image.byteSize()), 0);
+}
+
+TEST(IncrementalDecoder, WritesTopDownIntoCallerBuffer){
+    auto *bytes = static_cast<const Byte *>(kPng2x2RGBA);
+    DecodeOptions options;
+    options.pixelFormat = PixelFormat::BGRA8;
+    auto decoder = IncrementalDecoder::create(Format::PNG, options);
+    // Padded rows, as a GPU staging buffer might require.
+    const std::size_t stride = 16;
+    std::vector<Byte> staging(stride * 2, 0xAB);
+    decoder->setHeaderCallback([&](const Header & header){
+        EXPECT_EQ(header.color_format, ColorFormat::BGRA);
+        auto res = decoder->setDestination(staging.data(), staging.size(), stride, RowOrder::TopDown);
+        EXPECT_TRUE(res.isOk());
+    });
+    ASSERT_TRUE(decoder->feed(bytes, kPng2x2RGBASize).isOk());
+    ASSERT_TRUE(decoder->finish().isOk());
+    EXPECT_TRUE(decoder->takeImage().empty());
+    for (std::size_t row = 0; row < 2; row++) {
+        const Byte * px = staging.data() + row * stride;
+        EXPECT_EQ(px[0], 0x00);
+        EXPECT_EQ(px[2], 0xFF);
+        EXPECT_EQ(px[3], 0xFF);
+        EXPECT_EQ(px[8], 0xAB);
+    }
+}
+
+TEST(IncrementalDecoder, DecodesJpegInChunks){
+    auto *bytes = static_cast<const Byte *>(kJpeg2x2);
+    auto decoder = IncrementalDecoder::create(Format::JPEG);
+    bool sawFinal = false;
+    decoder->setRowsCallback([&](const DecodeProgress & progress){
+        sawFinal = sawFinal || progress.finalPass;
+    });
+    for (std::size_t i = 0; i < kJpeg2x2Size; i += 16) {
+        auto res = decoder->feed(bytes + i, std::min<std::size_t>(16, kJpeg2x2Size - i));
+        ASSERT_TRUE(res.isOk()) << res.error();
+    }
+    ASSERT_TRUE(decoder->finish().isOk());
+    EXPECT_TRUE(sawFinal);
+    auto image = decoder->takeImage();
+    EXPECT_EQ(image.header.width, 2u);
+    EXPECT_EQ(image.header.height, 2u);
+    ASSERT_FALSE(image.empty());
+    EXPECT_GT(image.data()[0], 0xF0);
+}
+
+TEST(IncrementalDecoder, RejectsTruncatedPng){
+    auto *bytes = static_cast<const Byte *>(kPng2x2RGBA);
+    auto decoder = IncrementalDecoder::create(Format::PNG);
+    ASSERT_TRUE(decoder->feed(bytes, kPng2x2RGBASize / 2).isOk());
+    EXPECT_TRUE(decoder->finish().isErr());
+}
+
+TEST(IncrementalDecoder, RejectsDestinationOutsideHeaderCallback){
+    auto decoder = IncrementalDecoder::create(Format::PNG);
+    Byte buffer[16];
+    EXPECT_TRUE(decoder->setDestination(buffer, sizeof(buffer), 8).isErr());
+}
+
+TEST(DecodeBatch, DecodesEveryRequestInOrder){
+    OmegaCommon::Vector<DecodeRequest> requests;
+    for (int i = 0; i < 8; i++) {
+        requests.push_back(DecodeRequest::fromBuffer(static_cast<const Byte *>(kPng2x2RGBA), kPng2x2RGBASize, Format::PNG));
+        requests.push_back(DecodeRequest::fromBuffer(static_cast<const Byte *>(kJpeg2x2), kJpeg2x2Size, Format::JPEG));
+    }
+    DecodeOptions options;
+    options.pixelFormat = PixelFormat::RGB8;
+    requests.push_back(DecodeRequest::fromBuffer(static_cast<const Byte *>(kPng2x2RGBA), kPng2x2RGBASize, Format::PNG, options));
+    requests.push_back(DecodeRequest::fromFile("does-not-exist.png"));
+
+    auto results = decodeBatch(requests);
+    ASSERT_EQ(results.size(), requests.size());
+    for (std::size_t i = 0; i < 16; i++) {
+        auto *img = valueOf(results[i].get());
+        ASSERT_NE(img, nullptr);
+        EXPECT_EQ(img->header.width, 2u);
+    }
+    auto *rgb = valueOf(results[16].get());
+    ASSERT_NE(rgb, nullptr);
+    EXPECT_EQ(rgb->header.color_format, ColorFormat::RGB);
+    EXPECT_TRUE(results[17].get().isErr());
+}
+
+namespace {
+
+    std::vector<Byte> randomBytes(std::size_t n, unsigned seed){
+        std::vector<Byte> bytes(n);
+        for (auto & b : bytes) {
+            seed = seed * 1103515245u + 12345u;
+            b = static_cast<Byte>(seed >> 16);
+        }
+        return bytes;
+    }
+
+    // Sizes that cover whole vector blocks, block + tail and tail only.
+    const std::size_t kKernelCounts[] = {0, 1, 3, 4, 7, 8, 15, 16, 17, 31, 33, 64, 100, 257};
+
+}
+
+TEST(PixelConvert, SwizzleMatchesScalar){
+    for (auto count : kKernelCounts) {
+        auto src = randomBytes(count * 4, 1);
+        std::vector<Byte> dst(count * 4);
+        swizzleRGBAToBGRA(src.data(), dst.data(), count);
+        for (std::size_t i = 0; i < count; i++) {
+            EXPECT_EQ(dst[i * 4 + 0], src[i * 4 + 2]);
+            EXPECT_EQ(dst[i * 4 + 1], src[i * 4 + 1]);
+            EXPECT_EQ(dst[i * 4 + 2], src[i * 4 + 0]);
+            EXPECT_EQ(dst[i * 4 + 3], src[i * 4 + 3]);
+        }
+        swizzleRGBAToBGRA(dst.data(), dst.data(), count);
+        EXPECT_EQ(dst, src);
+    }
+}
+
+TEST(PixelConvert, ExpandsRGBAndGray){
+    for (auto count : kKernelCounts) {
+        auto src = randomBytes(count * 3, 2);
+        std::vector<Byte> dst(count * 4);
+        expandRGBToRGBA(src.data(), dst.data(), count);
+        for (std::size_t i = 0; i < count; i++) {
+            EXPECT_EQ(std::memcmp(dst.data() + i * 4, src.data() + i * 3, 3), 0);
+            EXPECT_EQ(dst[i * 4 + 3], 0xFF);
+        }
+        expandGrayToRGBA(src.data(), dst.data(), count);
+        for (std::size_t i = 0; i < count; i++) {
+            const Byte expected[4] = {src[i], src[i], src[i], 0xFF};
+            EXPECT_EQ(std::memcmp(dst.data() + i * 4, expected, 4), 0);
+        }
+        expandGrayAlphaToRGBA(src.data(), dst.data(), count);
+        for (std::size_t i = 0; i < count; i++) {
+            const Byte expected[4] = {src[i * 2], src[i * 2], src[i * 2], src[i * 2 + 1]};
+            EXPECT_EQ(std::memcmp(dst.data() + i * 4, expected, 4), 0);
+        }
+    }
+}
+
+TEST(PixelConvert, PremultiplyRoundsEveryColourAlphaPair){
+    // All 256 x 256 colour/alpha pairs, 64K pixels.
+    std::vector<Byte> src(256 * 256 * 4);
+    for (unsigned a = 0; a < 256; a++) {
+        for (unsigned c = 0; c < 256; c++) {
+            Byte * px = src.data() + (a * 256 + c) * 4;
+            px[0] = static_cast<Byte>(c);
+            px[1] = static_cast<Byte>(255 - c);
+            px[2] = static_cast<Byte>(c ^ 0x5A);
+            px[3] = static_cast<Byte>(a);
+        }
+    }
+    std::vector<Byte> pre(src.size()), back(src.size());
+    premultiplyAlpha(src.data(), pre.data(), 256 * 256);
+    for (std::size_t i = 0; i < src.size(); i++) {
+        const unsigned a = src[i | 3];
+        const unsigned expected = (i & 3) == 3 ? a : (src[i] * a * 2 + 255) / 510;
+        ASSERT_EQ(pre[i], expected) << "byte " << i;
+    }
+
+    unpremultiplyAlpha(pre.data(), back.data(), 256 * 256);
+    for (std::size_t i = 0; i < pre.size(); i++) {
+        const unsigned a = pre[i | 3];
+        unsigned expected = 0;
+        if (a != 0) {
+            expected = (i & 3) == 3 ? a : std::min(255u, (pre[i] * 255u + a / 2) / a);
+        }
+        ASSERT_EQ(back[i], expected) << "byte " << i;
+    }
+
+    // In place, odd count.
+    std::vector<Byte> inPlace(src.begin(), src.begin() + 37 * 4);
+    premultiplyAlpha(inPlace.data(), inPlace.data(), 37);
+    EXPECT_TRUE(std::equal(inPlace.begin(), inPlace.end(), pre.begin()));
+}
+
+TEST(PixelConvert, NarrowsEvery16BitValue){
+    std::vector<std::uint16_t> src(65536 + 5);
+    for (std::size_t i = 0; i < src.size(); i++) {
+        src[i] = static_cast<std::uint16_t>(i);
+    }
+    std::vector<Byte> dst(src.size());
+    narrow16To8(src.data(), dst.data(), src.size());
+    for (std::size_t i = 0; i < src.size(); i++) {
+        ASSERT_EQ(dst[i], (src[i] * 255u + 32767u) / 65535u) << "value " << src[i];
+    }
+}
+
+TEST(PixelConvert, SrgbToLinear){
+    const Byte src[8] = {0, 128, 255, 51, 10, 188, 1, 255};
+    float dst[8];
+    srgbToLinear(src, dst, 2);
+    EXPECT_FLOAT_EQ(dst[0], 0.0f);
+    EXPECT_NEAR(dst[1], 0.2158605f, 1e-6f);
+    EXPECT_FLOAT_EQ(dst[2], 1.0f);
+    EXPECT_NEAR(dst[3], 0.2f, 1e-6f);
+    EXPECT_NEAR(dst[4], 10 / 255.0f / 12.92f, 1e-7f);
+    EXPECT_NEAR(dst[7], 1.0f, 1e-6f);
+}
+
+TEST(PixelConvert, ConvertImagePremultipliesAndSwizzles){
+    auto *bytes = const_cast<Byte *>(static_cast<const Byte *>(kPng2x2RGBA));
+    auto res = loadFromBuffer(bytes, kPng2x2RGBASize, Format::PNG);
+    auto *img = valueOf(res);
+    ASSERT_NE(img, nullptr);
+    ASSERT_EQ(img->header.color_format, ColorFormat::RGBA);
+
+    auto bgra = convertImage(*img, ColorFormat::BGRA, AlphaFormat::Premultipled);
+    auto *out = valueOf(bgra);
+    ASSERT_NE(out, nullptr);
+    EXPECT_EQ(out->header.color_format, ColorFormat::BGRA);
+    EXPECT_EQ(out->header.stride, 8u);
+    for (std::uint32_t i = 0; i < 4; i++) {
+        const Byte * in = img->data() + i * 4;
+        const Byte * px = out->data() + i * 4;
+        EXPECT_EQ(px[2], (in[0] * in[3] * 2 + 255) / 510);
+        EXPECT_EQ(px[3], in[3]);
+    }
+
+    auto rgb = convertImage(*out, ColorFormat::RGB, AlphaFormat::Straight);
+    auto *flat = valueOf(rgb);
+    ASSERT_NE(flat, nullptr);
+    EXPECT_EQ(flat->header.channels, 3);
+    EXPECT_EQ(flat->header.alpha_format, AlphaFormat::Ignore);
+    EXPECT_EQ(flat->data()[0], img->data()[0]);
+
+    BitmapImage empty;
+    EXPECT_TRUE(convertImage(empty, ColorFormat::RGBA, AlphaFormat::Straight).isErr());
+}
@@ -0,0 +1,127 @@
+// Throughput of the Img pixel conversion kernels against plain per-pixel
+// loops. Not part of ctest; run by hand:
+//
+//   PixelConvertBench [megapixels]
+//
+// Prints MPix/s for each kernel at the given image size (default 4 MPix).
+
+#include "omega-common/img.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace OmegaCommon::Img;
+
+namespace {
+
+    volatile Byte sink;
+
+    template<typename Fn>
+    double megapixelsPerSecond(std::size_t pixels, Fn && fn){
+        fn();
+        double best = 0.0;
+        for (int run = 0; run < 5; run++) {
+            const auto start = std::chrono::steady_clock::now();
+            fn();
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            best = std::max(best, pixels / elapsed.count() / 1e6);
+        }
+        return best;
+    }
+
+    void report(const char * name, double kernel, double reference){
+        std::printf("%-24s %10.1f MPix/s %10.1f MPix/s %6.2fx\n", name, kernel, reference, kernel / reference);
+    }
+
+}
+
+int main(int argc, char * argv[]){
+    const double mpix = argc > 1 ? std::atof(argv[1]) : 4.0;
+    const auto count = static_cast<std::size_t>(std::max(1.0, mpix * 1e6));
+
+    std::vector<Byte> rgba(count * 4), out(count * 4);
+    std::vector<std::uint16_t> wide(count * 4);
+    std::vector<float> linear(count * 4);
+    for (std::size_t i = 0; i < rgba.size(); i++) {
+        rgba[i] = static_cast<Byte>(i * 37 + (i >> 7));
+        wide[i] = static_cast<std::uint16_t>(i * 4099);
+    }
+
+    std::printf("%zu pixels\n%-24s %17s %17s %7s\n", count, "kernel", "vector", "scalar", "");
+
+    report("swizzleRGBAToBGRA",
+           megapixelsPerSecond(count, [&]{ swizzleRGBAToBGRA(rgba.data(), out.data(), count); }),
+           megapixelsPerSecond(count, [&]{
+               for (std::size_t i = 0; i < count * 4; i += 4) {
+                   out[i] = rgba[i + 2]; out[i + 1] = rgba[i + 1]; out[i + 2] = rgba[i]; out[i + 3] = rgba[i + 3];
+               }
+           }));
+
+    report("expandRGBToRGBA",
+           megapixelsPerSecond(count, [&]{ expandRGBToRGBA(rgba.data(), out.data(), count); }),
+           megapixelsPerSecond(count, [&]{
+               for (std::size_t i = 0; i < count; i++) {
+                   out[i * 4] = rgba[i * 3]; out[i * 4 + 1] = rgba[i * 3 + 1]; out[i * 4 + 2] = rgba[i * 3 + 2];
+                   out[i * 4 + 3] = 0xFF;
+               }
+           }));
+
+    report("premultiplyAlpha",
+           megapixelsPerSecond(count, [&]{ premultiplyAlpha(rgba.data(), out.data(), count); }),
+           megapixelsPerSecond(count, [&]{
+               for (std::size_t i = 0; i < count * 4; i += 4) {
+                   const unsigned a = rgba[i + 3];
+                   for (int c = 0; c < 3; c++) {
+                       out[i + c] = static_cast<Byte>((rgba[i + c] * a * 2 + 255) / 510);
+                   }
+                   out[i + 3] = static_cast<Byte>(a);
+               }
+           }));
+
+    report("unpremultiplyAlpha",
+           megapixelsPerSecond(count, [&]{ unpremultiplyAlpha(rgba.data(), out.data(), count); }),
+           megapixelsPerSecond(count, [&]{
+               for (std::size_t i = 0; i < count * 4; i += 4) {
+                   const unsigned a = rgba[i + 3];
+                   for (int c = 0; c < 3; c++) {
+                       out[i + c] = a == 0 ? 0 : static_cast<Byte>(std::min(255u, (rgba[i + c] * 255u + a / 2) / a));
+                   }
+                   out[i + 3] = static_cast<Byte>(a);
+               }
+           }));
+
+    report("narrow16To8 (RGBA16)",
+           megapixelsPerSecond(count, [&]{ narrow16To8(wide.data(), out.data(), count * 4); }),
+           megapixelsPerSecond(count, [&]{
+               for (std::size_t i = 0; i < count * 4; i++) {
+                   out[i] = static_cast<Byte>((wide[i] * 255u + 32767u) / 65535u);
+               }
+           }));
+
+    report("expandGrayToRGBA",
+           megapixelsPerSecond(count, [&]{ expandGrayToRGBA(rgba.data(), out.data(), count); }),
+           megapixelsPerSecond(count, [&]{
+               for (std::size_t i = 0; i < count; i++) {
+                   out[i * 4] = out[i * 4 + 1] = out[i * 4 + 2] = rgba[i];
+                   out[i * 4 + 3] = 0xFF;
+               }
+           }));
+
+    report("expandGrayAlphaToRGBA",
+           megapixelsPerSecond(count, [&]{ expandGrayAlphaToRGBA(rgba.data(), out.data(), count); }),
+           megapixelsPerSecond(count, [&]{
+               for (std::size_t i = 0; i < count; i++) {
+                   out[i * 4] = out[i * 4 + 1] = out[i * 4 + 2] = rgba[i * 2];
+                   out[i * 4 + 3] = rgba[i * 2 + 1];
+               }
+           }));
+
+    std::printf("%-24s %10.1f MPix/s\n", "srgbToLinear",
+                megapixelsPerSecond(count, [&]{ srgbToLinear(rgba.data(), linear.data(), count); }));
+
+    sink = out[count / 2];
+    return 0;
+}
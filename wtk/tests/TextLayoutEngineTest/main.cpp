@@ -569,6 +569,46 @@ namespace {
         std::printf("  [PASS] Mixed-script same-direction → per-script shape calls\n");
     }
 
+    void testSupplementaryPlaneReachesShaper(){
+        // Regression: line / run substrings are copied as UTF-16, so a
+        // surrogate pair (U+1F600) reaches the shaper intact instead of
+        // being dropped by a UTF-32 round-trip of lone surrogates.
+        auto font = makeFont();
+        auto metrics = defaultMetrics();
+        Composition::Rect rect{{0.f, 0.f}, 200.f, 50.f};
+        TextLayoutDescriptor d{TextLayoutDescriptor::LeftUpper, TextLayoutDescriptor::None};
+        MockShaper shaper;
+
+        auto text = makeUString({'a', 0x1F600u, 'b'});
+        auto r = TextLayoutEngine::layout(text, font, metrics, rect, d, shaper);
+        std::int32_t shapedUnits = 0;
+        for(auto len : shaper.callLengths) shapedUnits += len;
+        assert(shapedUnits == 4);
+        assert(r.glyphs.size() == 4);
+        std::printf("  [PASS] Surrogate pairs survive line / run substrings\n");
+    }
+
+    void testRepeatedLayoutReusesAnalysis(){
+        // Laying out the same string twice hits the shared analysis
+        // cache; the second pass adds no entry and lays out the same.
+        auto font = makeFont();
+        auto metrics = defaultMetrics();
+        Composition::Rect rect{{0.f, 0.f}, 200.f, 80.f};
+        TextLayoutDescriptor d{TextLayoutDescriptor::LeftUpper, TextLayoutDescriptor::None};
+        MockShaper first;
+        MockShaper second;
+
+        OmegaCommon::UniString text("cached one\ncached two");
+        auto r1 = TextLayoutEngine::layout(text, font, metrics, rect, d, first);
+        const auto entries = OmegaCommon::TextAnalysisCache::shared().size();
+        auto r2 = TextLayoutEngine::layout(text, font, metrics, rect, d, second);
+        assert(OmegaCommon::TextAnalysisCache::shared().size() == entries);
+        assert(r1.lineBaselines.size() == 2 && r2.lineBaselines.size() == 2);
+        assert(r1.glyphs.size() == r2.glyphs.size());
+        assert(first.callCount == second.callCount);
+        std::printf("  [PASS] Repeated layout reuses cached text analysis\n");
+    }
+
     void testPureLatinUnchanged(){
         // Regression: pure-Latin text still produces a single LTR
         // shape call after the BiDi/script segmentation passes (the
@@ -873,6 +913,8 @@ int main(){
     testPureRTLOneRun();
     testMixedLatinHebrew();
     testMixedScriptSameDirection();
+    testSupplementaryPlaneReachesShaper();
+    testRepeatedLayoutReusesAnalysis();
     testWrapByWordSplitsOnSoftBreak();
     testWrapByCharacterForcesMidWord();
     testLineLimitTruncates();